@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui serialport charts
+QT       += core gui serialport charts concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets multimedia
 
@@ -56,17 +56,35 @@ win32-g++:contains(QMAKE_HOST.arch, x86_64):{
 
 win32:LIBS += -l"ws2_32"
 
+# Instrumentation (see tracer.h) can be removed at compile time:
+# DEFINES += GNSSSTYLUS_NO_TRACING
+
+# Pseudo terminals (openpty) are used by simulated serial devices ("sim:..." as serial port)
+unix:!macx: LIBS += -lutil
+
 # for gcc 9.x (not recognized by 7.x): QMAKE_CXXFLAGS += -Wno-deprecated-copy
 
 SOURCES += \
     PostProcessing/EasyEXIF/exif.cpp \
+    PostProcessing/batchrunner.cpp \
+    PostProcessing/clockmodel.cpp \
+    PostProcessing/generatortask.cpp \
+    PostProcessing/Lidar/lidarpointtransformer.cpp \
     PostProcessing/Lidar/lidarscriptgenerator.cpp \
     PostProcessing/Lidar/pointcloudgeneratorlidar.cpp \
+    PostProcessing/Lidar/processedroundcache.cpp \
+    PostProcessing/Lidar/timeshiftcalibrator.cpp \
+    PostProcessing/Lidar/tiledpointcloudwriter.cpp \
+    PostProcessing/Lidar/voxelgridfilter.cpp \
     PostProcessing/Stylus/moviescriptgenerator.cpp \
     PostProcessing/Stylus/pointcloudgeneratorstylus.cpp \
+    PostProcessing/Stylus/roverpositiontrack.cpp \
     PostProcessing/loscriptgenerator.cpp \
+    PostProcessing/pipelinecache.cpp \
     PostProcessing/postprocessingform.cpp \
     PostProcessing/rastercameragenerator.cpp \
+    PostProcessing/tagsegmentindex.cpp \
+    PostProcessing/textlogreader.cpp \
     laserrangefinder20hzv2messagemonitorform.cpp \
     laserrangefinder20hzv2serialthread.cpp \
     Lidar/lidarchartform.cpp \
@@ -89,17 +107,42 @@ SOURCES += \
     messagemonitorform.cpp \
     relposnedform.cpp \
     essentialsform.cpp \
+    rtcmepochbundler.cpp \
+    rtcmforwarder.cpp \
+    Simulation/simulationspec.cpp \
+    Simulation/simulatedlidarsource.cpp \
+    Simulation/simulatedserialdevice.cpp \
+    Simulation/realtimeloadmonitor.cpp \
+    rtcmlatencyform.cpp \
+    rtcmlatencystatistics.cpp \
+    slidingwindowstatistics.cpp \
+    tracer.cpp \
+    tracingform.cpp \
+    videoframewriter.cpp \
+    logview.cpp \
     rightclickpushbutton.cpp
 
 HEADERS += \
     PostProcessing/EasyEXIF/exif.h \
+    PostProcessing/batchrunner.h \
+    PostProcessing/clockmodel.h \
+    PostProcessing/generatortask.h \
+    PostProcessing/Lidar/lidarpointtransformer.h \
     PostProcessing/Lidar/lidarscriptgenerator.h \
     PostProcessing/Lidar/pointcloudgeneratorlidar.h \
+    PostProcessing/Lidar/processedroundcache.h \
+    PostProcessing/Lidar/timeshiftcalibrator.h \
+    PostProcessing/Lidar/tiledpointcloudwriter.h \
+    PostProcessing/Lidar/voxelgridfilter.h \
     PostProcessing/Stylus/moviescriptgenerator.h \
     PostProcessing/Stylus/pointcloudgeneratorstylus.h \
+    PostProcessing/Stylus/roverpositiontrack.h \
     PostProcessing/loscriptgenerator.h \
+    PostProcessing/pipelinecache.h \
     PostProcessing/postprocessingform.h \
     PostProcessing/rastercameragenerator.h \
+    PostProcessing/tagsegmentindex.h \
+    PostProcessing/textlogreader.h \
     laserrangefinder20hzv2messagemonitorform.h \
     laserrangefinder20hzv2serialthread.h \
     Lidar/lidarchartform.h \
@@ -118,6 +161,20 @@ HEADERS += \
     messagemonitorform.h \
     relposnedform.h \
     essentialsform.h \
+    rtcmepochbundler.h \
+    rtcmforwarder.h \
+    Simulation/simulationspec.h \
+    Simulation/simulatedlidarsource.h \
+    Simulation/simulatedserialdevice.h \
+    Simulation/realtimeloadmonitor.h \
+    rtcmlatencyform.h \
+    rtcmlatencystatistics.h \
+    slidingwindowstatistics.h \
+    tracer.h \
+    tracingform.h \
+    videoframewriter.h \
+    logview.h \
+    ubxdecoder.h \
     rightclickpushbutton.h
 
 FORMS += \
@@ -129,6 +186,8 @@ FORMS += \
     messagemonitorform.ui \
     relposnedform.ui \
     essentialsform.ui \
+    rtcmlatencyform.ui \
+    tracingform.ui \
     Lidar/rplidarmessagemonitorform.ui
 
 # Default rules for deployment.
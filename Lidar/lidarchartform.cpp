@@ -23,6 +23,7 @@
 #include "lidarchartform.h"
 #include "ui_lidarchartform.h"
 #include "rplidarplausibilityfilter.h"
+#include "../tracer.h"
 
 LidarChartForm::LidarChartForm(QWidget *parent) :
     QWidget(parent),
@@ -286,6 +287,8 @@ void LidarChartForm::distanceRoundReceived(const QVector<RPLidarThread::Distance
 
 void LidarChartForm::updateChartData(void)
 {
+    TRACE_ZONE("LidarChartForm::updateChartData");
+
     QElapsedTimer elapsedTimer;
     elapsedTimer.start();
 
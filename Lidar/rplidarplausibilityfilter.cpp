@@ -18,6 +18,7 @@
 
 #include <QDebug>
 #include "rplidarplausibilityfilter.h"
+#include "../tracer.h"
 
 RPLidarPlausibilityFilter::RPLidarPlausibilityFilter()
 {
@@ -26,6 +27,8 @@ RPLidarPlausibilityFilter::RPLidarPlausibilityFilter()
 
 void RPLidarPlausibilityFilter::filter(const QVector<RPLidarThread::DistanceItem>& source, QVector<FilteredItem>& dest)
 {
+    TRACE_ZONE("RPLidarPlausibilityFilter::filter");
+
 /*
     qDebug() << "Angles:";
 
@@ -21,6 +21,8 @@
 #include <QElapsedTimer>
 
 #include "rplidarthread.h"
+#include "../tracer.h"
+#include "../Simulation/simulatedlidarsource.h"
 
 RPLidarThread::RPLidarThread(const QString& serialPortFileName, const unsigned int serialPortBPS, const unsigned short motorPWM, const short scanMode)
 {
@@ -35,16 +37,35 @@ RPLidarThread::RPLidarThread(const QString& serialPortFileName, const unsigned i
     qRegisterMetaType<QVector<RPLidarThread::DistanceItem>>();
 }
 
+RPLidarThread::RPLidarThread(SimulatedLidarSource* simulatedSource)
+{
+    this->simulatedSource = simulatedSource;
+    this->serialPortFileName = "Simulated";
+
+    terminateRequest = false;
+    suspended = false;
+
+    qRegisterMetaType<QVector<RPLidarThread::DistanceItem>>();
+}
+
 RPLidarThread::~RPLidarThread()
 {
     terminateRequest = true;
     this->wait(5000);
+
+    delete simulatedSource;
 }
 
 void RPLidarThread::run()
 {
     using namespace rp::standalone::rplidar;
 
+    if (simulatedSource)
+    {
+        runSimulation();
+        return;
+    }
+
     RPlidarDriver* lidarDriver = RPlidarDriver::CreateDriver();
 
     if (!lidarDriver)
@@ -228,10 +249,18 @@ void RPLidarThread::run()
                 lidarDriver->grabScanDataHq(measBuffer, count);
             }
 
-            lidarDriver->grabScanDataHq(measBuffer, count);
+            {
+                // Mostly waiting for the round to complete
+                TRACE_ZONE("RPLidarThread::grabScanDataHq");
+                lidarDriver->grabScanDataHq(measBuffer, count);
+            }
+
             timer.start();
             qint64 newUptime = timer.msecsSinceReference();
 
+            TRACE_ZONE("RPLidarThread::convert round");
+            TRACE_GAUGE("Lidar items per round", static_cast<qint64>(count));
+
             QVector<DistanceItem> distanceData;
 
             for (unsigned int i = 0; i < count; i++)
@@ -244,6 +273,7 @@ void RPLidarThread::run()
             }
 
             emit distanceRoundReceived(distanceData, prevUptime, newUptime);
+            numOfEmittedRounds.fetchAndAddRelease(1);
             prevUptime = newUptime;
         }
 
@@ -259,6 +289,64 @@ void RPLidarThread::run()
     RPlidarDriver::DisposeDriver(lidarDriver);
 }
 
+void RPLidarThread::runSimulation(void)
+{
+    emit infoMessage("Simulated lidar, speed factor: " + QString::number(simulatedSource->getParams().speedFactor) + ".");
+    emit infoMessage("Reading data...");
+
+    const double speedFactor = simulatedSource->getParams().speedFactor;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    double scheduledTime = 0;       // When the current round is "ready" (ms since timer start)
+    qint64 prevUptime = timer.msecsSinceReference();
+
+    SimulatedLidarSource::Round round;
+
+    while (!terminateRequest)
+    {
+        if (suspendIfNeeded())
+        {
+            // Rounds during suspend are not counted as dropped
+            scheduledTime = timer.elapsed();
+            prevUptime = timer.msecsSinceReference();
+        }
+
+        if (!simulatedSource->getNextRound(round))
+        {
+            emit infoMessage("End of simulated data.");
+            break;
+        }
+
+        const double roundDuration = round.duration_ms / speedFactor;
+        scheduledTime += roundDuration;
+
+        const double lateness = timer.elapsed() - scheduledTime;
+
+        if (lateness > roundDuration)
+        {
+            // Real device keeps on scanning and driver keeps only the latest round
+            // -> Rounds older than one round are lost if grabScanDataHq is not called in time.
+            numOfDroppedRounds.fetchAndAddRelease(1);
+            TRACE_COUNT("Lidar rounds dropped (simulation)", 1);
+            continue;
+        }
+        else if (lateness < 0)
+        {
+            msleep(static_cast<unsigned long>(ceil(-lateness)));
+        }
+
+        qint64 newUptime = timer.msecsSinceReference();
+
+        emit distanceRoundReceived(round.distanceItems, prevUptime, newUptime);
+        numOfEmittedRounds.fetchAndAddRelease(1);
+        prevUptime = newUptime;
+    }
+
+    emit infoMessage("Thread terminated.");
+}
+
 void RPLidarThread::suspend(void)
 {
     suspended = true;
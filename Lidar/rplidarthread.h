@@ -21,9 +21,12 @@
 
 #include <QObject>
 #include <QThread>
+#include <QAtomicInteger>
 
 #include "rplidar_sdk/include/rplidar.h"
 
+class SimulatedLidarSource;
+
 class RPLidarThread : public QThread
 {
     Q_OBJECT
@@ -38,6 +41,12 @@ public:
      * @param scanMode Value used in startScanExpress-call's scanMode-parameter or -1 (use startScan-call instead)
      */
     RPLidarThread(const QString& serialPortFileName, const unsigned int serialPortBPS, const unsigned short motorPWM = 660, const short scanMode = -1);
+
+    /**
+     * @brief Constructor for a simulated lidar (no device needed)
+     * @param simulatedSource Source of rounds (must be opened already). Thread takes the ownership
+     */
+    RPLidarThread(SimulatedLidarSource* simulatedSource);
     ~RPLidarThread() override;
 
     void run() override;            //!< Thread code
@@ -45,6 +54,9 @@ public:
     void suspend(void);             //!< Requests thread to suspend. Suspend may not be immediate
     void resume(void);              //!< Requests thread to resume (from suspend). Resuming may not be immediate.
 
+    qint64 getNumOfEmittedRounds(void) const { return numOfEmittedRounds.loadAcquire(); }    //!< Returns number of distanceRoundReceived-signals emitted
+    qint64 getNumOfDroppedRounds(void) const { return numOfDroppedRounds.loadAcquire(); }    //!< Returns number of simulated rounds dropped because the thread couldn't keep up
+
     class DistanceItem
     {
     public:
@@ -62,8 +74,13 @@ private:
     bool terminateRequest = false;
     bool suspended = false;
 
+    SimulatedLidarSource* simulatedSource = nullptr;    //!< Simulated device (nullptr = use RPlidarDriver)
+    QAtomicInteger<qint64> numOfEmittedRounds = 0;
+    QAtomicInteger<qint64> numOfDroppedRounds = 0;
+
     QString getRPLidarResultString(const u_result result);
     bool suspendIfNeeded(void);
+    void runSimulation(void);       //!< Thread code when simulatedSource is used
 
     rplidar_response_measurement_node_hq_t measBuffer[20000];
 
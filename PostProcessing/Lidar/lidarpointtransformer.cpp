@@ -0,0 +1,109 @@
+/*
+    lidarpointtransformer.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file lidarpointtransformer.cpp
+ * @brief Definition for a class that transforms lidar distance rounds into rig's coordinate system.
+ */
+
+#include <math.h>
+
+#include "lidarpointtransformer.h"
+
+namespace Lidar
+{
+
+PointTransformer::AngleTable::AngleTable()
+{
+    angles.resize(angleTableSize);
+    sines.resize(angleTableSize);
+    cosines.resize(angleTableSize);
+
+    for (int i = 0; i < angleTableSize; i++)
+    {
+        // Same calculation as in RPLidarThread
+        angles[i] = 2 * M_PI * i / 65536.;
+
+        double angle = angles[i];
+        sines[i] = sin(angle);
+        cosines[i] = cos(angle);
+    }
+}
+
+void PointTransformer::getSinCos(const float angle, double& sinValue, double& cosValue)
+{
+    static const AngleTable table;
+
+    int index = static_cast<int>(lround(angle * (angleTableSize / (2 * M_PI))));
+
+    if ((index >= 0) && (index < angleTableSize) && (table.angles[index] == angle))
+    {
+        sinValue = table.sines[index];
+        cosValue = table.cosines[index];
+    }
+    else
+    {
+        double angle_Double = angle;
+        sinValue = sin(angle_Double);
+        cosValue = cos(angle_Double);
+    }
+}
+
+PointTransformer::PointTransformer(const Eigen::Transform<double, 3, Eigen::Affine>& transform_BeforeRotation,
+                                   const Eigen::Transform<double, 3, Eigen::Affine>& transform_AfterRotation)
+{
+    linear_After = transform_AfterRotation.linear();
+    translation_After = transform_AfterRotation.translation();
+
+    laserDirection_Before = transform_BeforeRotation.linear() * Eigen::Vector3d::UnitX();
+    laserOrigin_Before = transform_BeforeRotation.translation();
+}
+
+void PointTransformer::transformRound(const QVector<RPLidarPlausibilityFilter::FilteredItem>& items)
+{
+    const int itemCount = items.count();
+
+    // Items rotated by laser rotation (BeforeRotation already applied)
+    Eigen::Matrix3Xd rotatedOrigins(3, itemCount);
+    Eigen::Matrix3Xd rotatedHits(3, itemCount);
+
+    for (int i = 0; i < itemCount; i++)
+    {
+        double sinValue, cosValue;
+        getSinCos(items[i].item.angle, sinValue, cosValue);
+
+        Eigen::Vector3d hitBeforeRotation = laserOrigin_Before + items[i].item.distance * laserDirection_Before;
+
+        // Rotation around z-axis
+        rotatedOrigins(0, i) = cosValue * laserOrigin_Before(0) - sinValue * laserOrigin_Before(1);
+        rotatedOrigins(1, i) = sinValue * laserOrigin_Before(0) + cosValue * laserOrigin_Before(1);
+        rotatedOrigins(2, i) = laserOrigin_Before(2);
+
+        rotatedHits(0, i) = cosValue * hitBeforeRotation(0) - sinValue * hitBeforeRotation(1);
+        rotatedHits(1, i) = sinValue * hitBeforeRotation(0) + cosValue * hitBeforeRotation(1);
+        rotatedHits(2, i) = hitBeforeRotation(2);
+    }
+
+    laserOrigins.noalias() = linear_After * rotatedOrigins;
+    laserOrigins.colwise() += translation_After;
+
+    laserHits.noalias() = linear_After * rotatedHits;
+    laserHits.colwise() += translation_After;
+}
+
+}; // namespace Lidar
@@ -0,0 +1,98 @@
+/*
+    lidarpointtransformer.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file lidarpointtransformer.h
+ * @brief Declaration for a class that transforms lidar distance rounds into rig's coordinate system.
+ */
+
+#ifndef LIDARPOINTTRANSFORMER_H
+#define LIDARPOINTTRANSFORMER_H
+
+#include <QVector>
+
+#include "Eigen/Geometry"
+#include "Lidar/rplidarplausibilityfilter.h"
+
+namespace Lidar
+{
+
+/**
+ * @brief Transforms lidar's distance items into rig's coordinate system (=coordinate system before LOSolver's transform)
+ *
+ * Full transform chain for a single distance item is
+ * NEDToXYZ * LoSolver * AfterRotation * LaserRotation(angle) * BeforeRotation * (distance * UnitX).
+ * Only LaserRotation and LoSolver change from item to item, so the constant
+ * parts are composed here once and a whole round is processed as 3xN-matrices.
+ * Caller then only needs to apply (interpolated) LoSolver- and NEDToXYZ-transforms per item.
+ */
+class PointTransformer
+{
+public:
+    PointTransformer(const Eigen::Transform<double, 3, Eigen::Affine>& transform_BeforeRotation,
+                     const Eigen::Transform<double, 3, Eigen::Affine>& transform_AfterRotation);   //!< Constructor
+
+    /**
+     * @brief Transforms laser origins and hit positions of all items in a round
+     * @param items Items to transform (all items transformed regardless of their filtering type)
+     *
+     * Results are available using getLaserOrigins and getLaserHits, column index = item index.
+     */
+    void transformRound(const QVector<RPLidarPlausibilityFilter::FilteredItem>& items);
+
+    const Eigen::Matrix3Xd& getLaserOrigins(void) const { return laserOrigins; }  //!< Laser origins (after AfterRotation-transform) of the last round
+    const Eigen::Matrix3Xd& getLaserHits(void) const { return laserHits; }        //!< Laser hit positions (after AfterRotation-transform) of the last round
+
+    /**
+     * @brief Returns sine and cosine of the lidar angle
+     * @param angle Angle (radians) as given by RPLidarThread
+     * @param sinValue Sine of the angle
+     * @param cosValue Cosine of the angle
+     *
+     * RPLidarThread converts angles from driver's q14-format into floats.
+     * Sines and cosines of all these angles are tabulated.
+     * Values are calculated from the float angles to keep results identical
+     * to the ones calculated directly (Eigen::AngleAxisd).
+     * Angles not found in table (=not originating from q14-value) are calculated normally.
+     */
+    static void getSinCos(const float angle, double& sinValue, double& cosValue);
+
+private:
+    Eigen::Matrix3d linear_After;           //!< Linear part of AfterRotation-transform
+    Eigen::Vector3d translation_After;      //!< Translation of AfterRotation-transform
+    Eigen::Vector3d laserDirection_Before;  //!< Unit laser vector (UnitX) transformed by the linear part of BeforeRotation-transform
+    Eigen::Vector3d laserOrigin_Before;     //!< Laser origin transformed by BeforeRotation-transform
+
+    Eigen::Matrix3Xd laserOrigins;
+    Eigen::Matrix3Xd laserHits;
+
+    static const int angleTableSize = 65536;    //!< Number of different q14-angles (full circle)
+
+    class AngleTable
+    {
+    public:
+        AngleTable();
+        QVector<float> angles;
+        QVector<double> sines;
+        QVector<double> cosines;
+    };
+};
+
+}; // namespace Lidar
+
+#endif // LIDARPOINTTRANSFORMER_H
@@ -16,53 +16,43 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
-#include <QMessageBox>
-#include <QPushButton>
+#include <QSaveFile>
 #include "lidarscriptgenerator.h"
+#include "processedroundcache.h"
 
 namespace Lidar
 {
 
 void LidarScriptGenerator::generateLidarScript(const Params& params)
 {
-    QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
-    filteredItems.reserve(10000);
+    // Without shared cache rounds are just filtered and transformed (nothing stored)
+    ProcessedRoundCache processedRoundCache_Local(0);
+    ProcessedRoundCache* processedRoundCache = params.processedRoundCache ? params.processedRoundCache : &processedRoundCache_Local;
 
-    RPLidarPlausibilityFilter plausibilityFilter;
-    plausibilityFilter.setSettings(*params.lidarFilteringSettings);
+    processedRoundCache->setSettings(*params.lidarFilteringSettings, *params.transform_BeforeRotation, *params.transform_AfterRotation);
 
-    // Map where uptimes for all equal ITOWs are the same.
-    // This makes processing later easier
-    // Uptimes here are calculated as averages from rover values (for each ITOW)
-    QMap<qint64, UBXMessage_RELPOSNED::ITOW> averagedSync;
+    // Uptimes are converted into ITOWs using a model fitted into rovers' sync data
+    ClockModel clockModel_Generated;
 
-    emit infoMessage("Generating equalized rover uptime timestamps...");
-    PostProcessingForm::generateAveragedRoverUptimeSync(params.rovers, averagedSync);
-    emit infoMessage("Equalized rover uptime timestamps created. Number of items: " + QString::number(averagedSync.size()));
-
-    QFile lidarScriptFile;
-
-    lidarScriptFile.setFileName(params.fileName);
-
-    if (lidarScriptFile.exists())
+    if (!params.clockModel)
     {
-        QMessageBox msgBox;
-        msgBox.setText("File already exists.");
-        msgBox.setInformativeText("How to proceed?");
-
-        QPushButton *overwriteButton = msgBox.addButton(tr("Overwrite"), QMessageBox::ActionRole);
-        QPushButton *cancelButton = msgBox.addButton(QMessageBox::Cancel);
+        emit infoMessage("Fitting uptime/ITOW clock model...");
+        clockModel_Generated.fit(params.rovers, params.numOfRovers);
+        emit infoMessage("Clock model fitted. Number of segments: " + QString::number(clockModel_Generated.getSegments().count()) +
+                         ", RMS residual: " + QString::number(clockModel_Generated.getRMSResidual(), 'f', 2) + " ms.");
+    }
+    else
+    {
+        emit infoMessage("Using cached clock model. Number of segments: " + QString::number(params.clockModel->getSegments().count()));
+    }
 
-        msgBox.setDefaultButton(cancelButton);
+    const ClockModel& clockModel = params.clockModel ? *params.clockModel : clockModel_Generated;
 
-        msgBox.exec();
+    // Script is written into a temporary file that replaces the existing one (if any) only when committed.
+    // Asking whether to overwrite is caller's responsibility.
+    QSaveFile lidarScriptFile;
 
-        if (msgBox.clickedButton() != overwriteButton)
-        {
-            emit infoMessage("Generating lidar script cancelled.");
-            return;
-        }
-    }
+    lidarScriptFile.setFileName(params.fileName);
 
     if (!lidarScriptFile.open(QIODevice::WriteOnly))
     {
@@ -87,129 +77,84 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
                   "Hit_X\tHit_Y\tHit_Z\n";
 
     QMap<qint64, PostProcessingForm::LidarRound>::const_iterator lidarIter = params.lidarRounds->upperBound(params.uptime_Min);
-    QMultiMap<qint64, PostProcessingForm::Tag>::const_iterator tagIter = params.tags->begin();
+
+    TagSegmentIndex tagSegmentIndex_Generated;
+
+    if (!params.tagSegmentIndex)
+    {
+        tagSegmentIndex_Generated.build(*params.tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+    }
+
+    const QVector<TagSegmentIndex::Item>& tagItems = (params.tagSegmentIndex ? *params.tagSegmentIndex : tagSegmentIndex_Generated).getItems();
+    int tagItemIndex = 0;
 
     QString objectName;
     bool objectActive = false;
     bool scanningActive = false;
-    bool ignoreBeginningAndEndingTags = false;
-    qint64 beginningUptime = -1;
-    PostProcessingForm::Tag beginningTag;
 
     unsigned int pointsWritten = 0;
 
-    while ((lidarIter.key() <= params.uptime_Max) && (lidarIter != params.lidarRounds->end()))
+    qint64 progress_FirstUptime = 0;
+    qint64 progress_LastUptime = 0;
+
+    if (lidarIter != params.lidarRounds->end())
     {
-        QString previousObjectName = objectName;
-        bool previousObjectActive = objectActive;
-        bool previousScanningActive = scanningActive;
+        progress_FirstUptime = lidarIter.key();
+        progress_LastUptime = qMax(progress_FirstUptime, qMin(params.uptime_Max, params.lidarRounds->lastKey()));
+    }
 
-        while ((tagIter.key() < lidarIter.value().startTime) && tagIter != params.tags->end())
+    while ((lidarIter.key() <= params.uptime_Max) && (lidarIter != params.lidarRounds->end()))
+    {
+        if (GeneratorTask::isCancelRequested(params.task))
         {
-            // Roll tags to the current uptime to keep track of scanning state and object name
+            // lidarScriptFile not committed -> discarded
+            emit warningMessage("Generating lidar script cancelled. File \"" + params.fileName + "\" not written.");
+            return;
+        }
 
-            QList<PostProcessingForm::Tag> tagItems = params.tags->values(tagIter.key());
+        GeneratorTask::setProgress(params.task, lidarIter.key() - progress_FirstUptime, progress_LastUptime - progress_FirstUptime);
 
-            PostProcessingForm::Tag currentTag = tagIter.value();
+        while ((tagItemIndex < tagItems.count()) && (tagItems[tagItemIndex].uptime < lidarIter.value().startTime))
+        {
+            // Roll tags to the current uptime to keep track of scanning state and object name.
+            // State changes are written once for each group of tags having the same uptime.
 
-            // Since "The items that share the same key are available from most recently to least recently inserted."
-            // (taken from QMultiMap's doc), iterate in "reverse order" here
+            const qint64 tagUptime = tagItems[tagItemIndex].uptime;
 
-            for (int i = tagItems.size() - 1; i >= 0; i--)
-            {
-                const PostProcessingForm::Tag& currentTag = tagItems[i];
+            QString previousObjectName = objectName;
+            bool previousObjectActive = objectActive;
+            bool previousScanningActive = scanningActive;
 
-                qint64 tagUptime = tagIter.key();
+            while ((tagItemIndex < tagItems.count()) && (tagItems[tagItemIndex].uptime == tagUptime))
+            {
+                const TagSegmentIndex::Item& item = tagItems[tagItemIndex++];
+                const PostProcessingForm::Tag& currentTag = item.tag;
 
-                if (!(currentTag.ident.compare(params.tagIdent_BeginNewObject)))
+                if (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT)
                 {
-                    // Tag type: new object
-
-                    if (currentTag.text.length() == 0)
-                    {
-                        // Empty name for the new object not allowed
-
-                        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                   QString::number(currentTag.sourceFileLine)+
-                                   ", uptime " + QString::number(tagUptime) +
-                                   ", iTOW " + QString::number(currentTag.iTOW) +
-                                   ": New object without a name. Ending previous object, but not beginning new. Ignoring subsequent beginning and ending tags.");
-
-                        ignoreBeginningAndEndingTags = true;
-
-                        continue;
-                    }
+                    // Empty name for the new object not allowed
 
+                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
+                               QString::number(currentTag.sourceFileLine)+
+                               ", uptime " + QString::number(tagUptime) +
+                               ", iTOW " + QString::number(currentTag.iTOW) +
+                               ": New object without a name. Ending previous object, but not beginning new. Ignoring subsequent beginning and ending tags.");
+                }
+                else if (item.type == TagSegmentIndex::ITEM_NEW_OBJECT)
+                {
                     objectName = currentTag.text;
                     objectActive = true;
-                    ignoreBeginningAndEndingTags = false;
-                    beginningUptime = -1;
                 }
-                else if ((!(currentTag.ident.compare(params.tagIdent_BeginPoints))) && (!ignoreBeginningAndEndingTags))
+                else if (item.type == TagSegmentIndex::ITEM_INVALID_TAG)
+                {
+                    emit warningMessage(TagSegmentIndex::getDiagnosticText(item));
+                }
+                else if (item.type == TagSegmentIndex::ITEM_BEGINNING)
                 {
-                    // Tag type: Begin points
-
-                    if (!objectActive)
-                    {
-                        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                   QString::number(currentTag.sourceFileLine)+
-                                   ", uptime " + QString::number(tagUptime) +
-                                   ", iTOW " + QString::number(currentTag.iTOW) +
-                                   ": Beginning tag outside object. Skipped.");
-                        continue;
-                    }
-
-                    if (beginningUptime != -1)
-                    {
-                        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                   QString::number(currentTag.sourceFileLine)+
-                                   ", uptime " + QString::number(tagUptime) +
-                                   ", iTOW " + QString::number(currentTag.iTOW) +
-                                   ": Duplicate beginning tag. Skipped.");
-                        continue;
-                    }
-
                     scanningActive = true;
-                    beginningUptime = tagUptime;
-                    beginningTag = currentTag;
                 }
-                else if ((!(currentTag.ident.compare(params.tagIdent_EndPoints)))  && (!ignoreBeginningAndEndingTags))
+                else if (item.type == TagSegmentIndex::ITEM_SEGMENT)
                 {
-                    // Tag type: end points
-
-                    if (!objectActive)
-                    {
-                        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                   QString::number(currentTag.sourceFileLine)+
-                                   ", uptime " + QString::number(tagUptime) +
-                                   ", iTOW " + QString::number(currentTag.iTOW) +
-                                   ": End tag outside object. Skipped.");
-                        continue;
-                    }
-
-                    if (beginningUptime == -1)
-                    {
-                        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                   QString::number(currentTag.sourceFileLine)+
-                                   ", uptime " + QString::number(tagUptime) +
-                                   ", iTOW " + QString::number(currentTag.iTOW) +
-                                   ": End tag without beginning tag. Skipped.");
-                        continue;
-                    }
-
-                    const PostProcessingForm::Tag& endingTag = currentTag;
-
-                    if (endingTag.sourceFile != beginningTag.sourceFile)
-                    {
-                        emit warningMessage("Starting and ending tags belong to different files. Starting tag file \"" +
-                                   beginningTag.sourceFile + "\", line " +
-                                   QString::number(beginningTag.sourceFileLine) + " ending tag file: " +
-                                   endingTag.sourceFile + "\", line " +
-                                   QString::number(endingTag.sourceFileLine) + ". Ending tag ignored.");
-                        continue;
-                    }
-
-                    beginningUptime = -1;
                     scanningActive = false;
                 }
             }
@@ -218,35 +163,35 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
             {
                 // Note: params.timeShift used here so that LOScript and this use the same timing
 
-                textStream << QString::number(tagIter.key() + params.timeShift) +  "\tOBJECTNAME\t" + objectName + "\n";
+                textStream << QString::number(tagUptime + params.timeShift) +  "\tOBJECTNAME\t" + objectName + "\n";
             }
 
             if (!previousObjectActive && objectActive)
             {
-                textStream << QString::number(tagIter.key() + params.timeShift) + "\tSTARTOBJECT\n";
+                textStream << QString::number(tagUptime + params.timeShift) + "\tSTARTOBJECT\n";
             }
 
             if (previousObjectActive && !objectActive)
             {
-                textStream << QString::number(tagIter.key() + params.timeShift) + "\tENDOBJECT\n";
+                textStream << QString::number(tagUptime + params.timeShift) + "\tENDOBJECT\n";
             }
 
             if (!previousScanningActive && scanningActive)
             {
-                textStream << QString::number(tagIter.key() + params.timeShift) + "\tSTARTSCAN\n";
+                textStream << QString::number(tagUptime + params.timeShift) + "\tSTARTSCAN\n";
             }
 
             if (previousScanningActive && !scanningActive)
             {
-                textStream << QString::number(tagIter.key() + params.timeShift) + "\tENDSCAN\n";
+                textStream << QString::number(tagUptime + params.timeShift) + "\tENDSCAN\n";
             }
-
-            tagIter++;
         }
 
         const PostProcessingForm::LidarRound& round = lidarIter.value();
 
-        plausibilityFilter.filter(round.distanceItems, filteredItems);
+        // Filtered items and constant transforms and laser rotation for the whole round at once
+        const ProcessedRoundCache::ProcessedRound& processedRound = processedRoundCache->getProcessedRound(lidarIter.key(), round);
+        const QVector<RPLidarPlausibilityFilter::FilteredItem>& filteredItems = processedRound.filteredItems;
 
         for (int i = 0; i < filteredItems.count(); i++)
         {
@@ -255,7 +200,6 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
             // Rover coordinates interpolated according to distance timestamps.
 
             qint64 itemUptime = round.startTime + (round.endTime - round.startTime) * i / lidarIter.value().distanceItems.count();
-            UBXMessage_RELPOSNED interpolated_Rovers[3];
 
             qint64 roverUptime = itemUptime + params.timeShift;
 
@@ -263,7 +207,7 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
 
             try
             {
-                params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(roverUptime, averagedSync, transform_LoSolver);
+                params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(roverUptime, clockModel, transform_LoSolver);
             }
             catch (QString& stringThrown)
             {
@@ -271,19 +215,19 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
                            QString::number(lidarIter.value().chunkIndex)+
                            ", uptime " + QString::number(lidarIter.key()) +
                            ": " + stringThrown + " Lidar script generating terminated.");
+
+                // Keep the script written so far (like before writing through a temporary file)
+                textStream.flush();
+                lidarScriptFile.commit();
                 return;
             }
 
-            Eigen::Transform<double, 3, Eigen::Affine> transform_LaserRotation;
-            transform_LaserRotation = Eigen::AngleAxisd(currentItem.item.angle, Eigen::Vector3d::UnitZ()).toRotationMatrix();
-
+            // BeforeRotation-, laser rotation- and AfterRotation-transforms already applied (see ProcessedRoundCache).
             // Lot of parentheses here to keep all calculations as matrix * vector
             // This is _much_ faster, in quick tests time was dropped from 510 s to 295 s when using parentheses in the whole lidarscript-creation)
-            Eigen::Vector3d laserOriginAfterLOSolverTransformXYZ = *params.transform_NEDToXYZ * (transform_LoSolver * (*params.transform_AfterRotation * (transform_LaserRotation * (*params.transform_BeforeRotation * Eigen::Vector3d::Zero()))));
+            Eigen::Vector3d laserOriginAfterLOSolverTransformXYZ = *params.transform_NEDToXYZ * (transform_LoSolver * processedRound.laserOrigins.col(i));
 
-            // Lot of parentheses here to keep all calculations as matrix * vector
-            // This is _much_ faster, in quick tests time was dropped from 510 s to 295 s when using parentheses in the whole lidarscript-creation)
-            Eigen::Vector3d laserHitPosAfterLOSolverTransform = transform_LoSolver * (*params.transform_AfterRotation * (transform_LaserRotation * (*params.transform_BeforeRotation * (currentItem.item.distance * Eigen::Vector3d::UnitX()))));
+            Eigen::Vector3d laserHitPosAfterLOSolverTransform = transform_LoSolver * processedRound.laserHits.col(i);
 
             Eigen::Vector3d laserHitPosAfterLOSolverTransformXYZ = *params.transform_NEDToXYZ * laserHitPosAfterLOSolverTransform;
 
@@ -364,6 +308,14 @@ void LidarScriptGenerator::generateLidarScript(const Params& params)
         lidarIter++;
     }
 
+    textStream.flush();
+
+    if (!lidarScriptFile.commit())
+    {
+        emit errorMessage("Writing lidar script file failed: " + lidarScriptFile.errorString());
+        return;
+    }
+
     emit infoMessage("Lidar script generated. Number of points: " + QString::number(pointsWritten));
 }
 
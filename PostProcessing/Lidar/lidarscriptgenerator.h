@@ -20,10 +20,15 @@
 #define LIDARSCRIPTGENERATOR_H
 
 #include "../postprocessingform.h"
+#include "../generatortask.h"
+#include "../tagsegmentindex.h"
+#include "../clockmodel.h"
 
 namespace Lidar
 {
 
+class ProcessedRoundCache;
+
 class LidarScriptGenerator : public QObject
 {
     Q_OBJECT
@@ -45,10 +50,15 @@ public:
         qint64 uptime_Max = 1e18;
 
         const QMultiMap<qint64, PostProcessingForm::Tag>* tags = nullptr;
+        const TagSegmentIndex* tagSegmentIndex = nullptr;  //!< Objects/segments of tags (built from tags if nullptr)
         const PostProcessingForm::Rover* rovers = nullptr;
+        unsigned int numOfRovers = 3;                   //!< Number of items in rovers
         const QMap<qint64, PostProcessingForm::LidarRound>* lidarRounds = nullptr;
         const RPLidarPlausibilityFilter::Settings* lidarFilteringSettings = nullptr;
         PostProcessingForm::LOInterpolator* loInterpolator = nullptr;
+        const ClockModel* clockModel = nullptr;     //!< Uptime <-> ITOW model (fitted from rovers if nullptr)
+        ProcessedRoundCache* processedRoundCache = nullptr;     //!< Filtered/transformed rounds shared between runs (rounds processed without storing if nullptr)
+        GeneratorTask* task = nullptr;                          //!< Progress reporting and cancellation (optional)
     };
 
     void generateLidarScript(const Params& params);
@@ -17,6 +17,8 @@
 */
 
 #include "pointcloudgeneratorlidar.h"
+#include "processedroundcache.h"
+#include "../../tracer.h"
 
 namespace Lidar
 {
@@ -45,249 +47,249 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
 
     bool ignoreBeginningAndEndingTags = false;
 
-    QFile* outFile = nullptr;
+    QSaveFile* outFile = nullptr;
     QTextStream* outStream = nullptr;
 
     QString objectName;
     QString baseFileName;
     int fileIndex = 0;
 
-    qint64 uptime = -1;
     PostProcessingForm::Tag beginningTag;
 
-    // Map where uptimes for all equal ITOWs are the same.
-    // This makes processing later easier
-    // Uptimes here are calculated as averages from rover values (for each ITOW)
-    QMap<qint64, UBXMessage_RELPOSNED::ITOW> averagedSync;
+    // Uptimes are converted into ITOWs using a model fitted into rovers' sync data
+    ClockModel clockModel_Generated;
 
-    emit infoMessage("Generating equalized rover uptime timestamps...");
-    PostProcessingForm::generateAveragedRoverUptimeSync(params.rovers, averagedSync);
-    emit infoMessage("Equalized rover uptime timestamps created. Number of items: " + QString::number(averagedSync.size()));
+    if (!params.clockModel)
+    {
+        emit infoMessage("Fitting uptime/ITOW clock model...");
+        clockModel_Generated.fit(params.rovers, params.numOfRovers);
+        emit infoMessage("Clock model fitted. Number of segments: " + QString::number(clockModel_Generated.getSegments().count()) +
+                         ", RMS residual: " + QString::number(clockModel_Generated.getRMSResidual(), 'f', 2) + " ms.");
+    }
+    else
+    {
+        emit infoMessage("Using cached clock model. Number of segments: " + QString::number(params.clockModel->getSegments().count()));
+    }
 
-    while (params.tags->upperBound(uptime) != params.tags->end())
+    const ClockModel& clockModel = params.clockModel ? *params.clockModel : clockModel_Generated;
+
+    TagSegmentIndex tagSegmentIndex_Generated;
+
+    if (!params.tagSegmentIndex)
     {
-        uptime = params.tags->upperBound(uptime).key();
+        tagSegmentIndex_Generated.build(*params.tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+    }
 
-        QList<PostProcessingForm::Tag> tagItems = params.tags->values(uptime);
+    const TagSegmentIndex& tagSegmentIndex = params.tagSegmentIndex ? *params.tagSegmentIndex : tagSegmentIndex_Generated;
 
-        // Since "The items that share the same key are available from most recently to least recently inserted."
-        // (taken from QMultiMap's doc), iterate in "reverse order" here
+    bool cancelled = false;
 
-        for (int i = tagItems.size() - 1; i >= 0; i--)
+    for (const TagSegmentIndex::Item& item : tagSegmentIndex.getItems())
+    {
+        if (GeneratorTask::isCancelRequested(params.task))
         {
-            const PostProcessingForm::Tag& currentTag = tagItems[i];
+            cancelled = true;
+            break;
+        }
 
-            if (!(currentTag.ident.compare(params.tagIdent_BeginNewObject)))
-            {
-                // Tag type: new object
+        const qint64 uptime = item.uptime;
+        const PostProcessingForm::Tag& currentTag = item.tag;
 
-                if (objectActive)
-                {
-                    // Object already active -> Close existing stream and file
+        reportProgress(params, uptime);
 
-                    if (outStream)
-                    {
-                        delete outStream;
-                        outStream = nullptr;
-                    }
-                    if (outFile)
-                    {
-                        emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
-                        outFile->close();
-                        delete outFile;
-                        outFile = nullptr;
-                    }
+        if ((item.type == TagSegmentIndex::ITEM_NEW_OBJECT) || (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT))
+        {
+            // Tag type: new object
 
-                    emit infoMessage("Object \"" + objectName + "\": Total points written: " + QString::number(pointsWritten));
+            if (objectActive)
+            {
+                // Object already active -> Close existing stream and file
 
-                    objectActive = false;
+                if (outStream)
+                {
+                    flushVoxelGridFilter(params, outStream, pointsWritten);
+                    finishTiledWriter(outStream, outFile);
+                    delete outStream;
+                    outStream = nullptr;
+                }
+                if (outFile)
+                {
+                    emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
+                    commitOutFile(outFile);
+                    outFile = nullptr;
                 }
 
-                objectName = currentTag.text;
+                emit infoMessage("Object \"" + objectName + "\": Total points written: " + QString::number(pointsWritten));
 
-                if (currentTag.text.length() == 0)
-                {
-                    // Empty name for the new object not allowed
+                objectActive = false;
+            }
 
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": New object without a name. Ending previous object, but not beginning new nor creating a new file. Ignoring subsequent beginning and ending tags.");
+            objectName = currentTag.text;
 
-                    ignoreBeginningAndEndingTags = true;
+            if (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT)
+            {
+                // Empty name for the new object not allowed
 
-                    continue;
-                }
+                emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
+                           QString::number(currentTag.sourceFileLine)+
+                           ", uptime " + QString::number(uptime) +
+                           ", iTOW " + QString::number(currentTag.iTOW) +
+                           ": New object without a name. Ending previous object, but not beginning new nor creating a new file. Ignoring subsequent beginning and ending tags.");
 
-                baseFileName = QDir::cleanPath(params.directory.path() + "/" + currentTag.text);
+                ignoreBeginningAndEndingTags = true;
 
-                QString fileName = baseFileName + ".xyz";
+                continue;
+            }
 
-                if (!params.separateFilesForSubScans)
-                {
-                    outFile = createNewOutFile(fileName, currentTag, uptime);
+            baseFileName = QDir::cleanPath(params.directory.path() + "/" + currentTag.text);
 
-                    if (!outFile)
-                    {
-                        ignoreBeginningAndEndingTags = true;
-                        continue;
-                    }
-                    else
-                    {
-                        outStream = new QTextStream(outFile);
-                        ignoreBeginningAndEndingTags = false;
-                    }
+            if (!params.separateFilesForSubScans)
+            {
+                outFile = createNewOutFile(params, baseFileName, currentTag, uptime);
+
+                if (!outFile)
+                {
+                    ignoreBeginningAndEndingTags = true;
+                    continue;
                 }
                 else
                 {
-                    emit infoMessage("Starting new object \"" +  currentTag.text + "\".");
+                    outStream = new QTextStream(outFile);
                     ignoreBeginningAndEndingTags = false;
                 }
-
-                objectActive = true;
-                beginningUptime = -1;
-                pointsWritten = 0;
-
-                fileIndex = 0;
             }
-            else if ((!(currentTag.ident.compare(params.tagIdent_BeginPoints))) && (!ignoreBeginningAndEndingTags))
+            else
             {
-                // Tag type: Begin points
+                emit infoMessage("Starting new object \"" +  currentTag.text + "\".");
+                ignoreBeginningAndEndingTags = false;
+            }
 
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Beginning tag outside object. Skipped.");
-                    continue;
-                }
+            objectActive = true;
+            beginningUptime = -1;
+            pointsWritten = 0;
 
-                if (beginningUptime != -1)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Duplicate beginning tag. Skipped.");
-                    continue;
-                }
+            fileIndex = 0;
+        }
+        else if (ignoreBeginningAndEndingTags)
+        {
+            // Object's file couldn't be created
+            continue;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_INVALID_TAG)
+        {
+            emit warningMessage(TagSegmentIndex::getDiagnosticText(item));
+        }
+        else if (item.type == TagSegmentIndex::ITEM_BEGINNING)
+        {
+            // Just store the beginning uptime-value and tag. Writing of the points is done in segment-branch
+            beginningUptime = uptime;
+            beginningTag = currentTag;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_SEGMENT)
+        {
+            const PostProcessingForm::Tag& endingTag = currentTag;
 
-                // Just store the beginning uptime-value and tag. Writing of the points is done in ending tag-branch
-                beginningUptime = uptime;
-                beginningTag = currentTag;
-            }
-            else if ((!(currentTag.ident.compare(params.tagIdent_EndPoints)))  && (!ignoreBeginningAndEndingTags))
+            if (params.separateFilesForSubScans)
             {
-                // Tag type: end points
+                fileIndex++;
 
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag outside object. Skipped.");
-                    continue;
-                }
+                QString fileIndexString = QString::number(fileIndex);
 
-                if (beginningUptime == -1)
+                while (fileIndexString.length() < 4)
                 {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag without beginning tag. Skipped.");
-                    continue;
+                    fileIndexString.prepend("0");
                 }
 
-                const PostProcessingForm::Tag& endingTag = currentTag;
+                outFile = createNewOutFile(params, QDir::cleanPath(baseFileName + "_" + fileIndexString), currentTag, uptime);
 
-                if (endingTag.sourceFile != beginningTag.sourceFile)
+                if (!outFile)
                 {
-                    emit warningMessage("Starting and ending tags belong to different files. Starting tag file \"" +
-                               beginningTag.sourceFile + "\", line " +
-                               QString::number(beginningTag.sourceFileLine) + " ending tag file: " +
-                               endingTag.sourceFile + "\", line " +
-                               QString::number(endingTag.sourceFileLine) + ". Ending tag ignored.");
+                    ignoreBeginningAndEndingTags = true;
                     continue;
                 }
-
-                if (params.separateFilesForSubScans)
+                else
                 {
-                    fileIndex++;
-
-                    QString fileIndexString = QString::number(fileIndex);
+                    outStream = new QTextStream(outFile);
+                    objectActive = true;
+                    ignoreBeginningAndEndingTags = false;
+                }
+            }
 
-                    while (fileIndexString.length() < 4)
-                    {
-                        fileIndexString.prepend("0");
-                    }
+            bool generatingOk = false;
+            int prevPointsWritten = pointsWritten;
+            int pointsAccepted = 0;
 
-                    QString fileName = QDir::cleanPath(baseFileName + "_" + fileIndexString + ".xyz");
+            generatingOk = generatePointCloudPointSet(params, beginningTag, endingTag, beginningUptime, uptime, clockModel, outStream, pointsWritten, pointsAccepted);
 
-                    outFile = createNewOutFile(fileName, currentTag, uptime);
+            if (GeneratorTask::isCancelRequested(params.task))
+            {
+                // Partially written file is discarded below
+                cancelled = true;
+                break;
+            }
 
-                    if (!outFile)
-                    {
-                        ignoreBeginningAndEndingTags = true;
-                        continue;
-                    }
-                    else
-                    {
-                        outStream = new QTextStream(outFile);
-                        objectActive = true;
-                        ignoreBeginningAndEndingTags = false;
-                    }
+            if (generatingOk)
+            {
+                if (pointsAccepted == 0)
+                {
+                    emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
+                               QString::number(beginningTag.sourceFileLine) +
+                               ", uptime " + QString::number(beginningUptime) +
+                               ", iTOW " + QString::number(beginningTag.iTOW) + ", ending tag line " +
+                               QString::number(endingTag.sourceFileLine) +
+                               ", uptime " + QString::number(endingTag.iTOW) +
+                               ", iTOW " + QString::number(endingTag.iTOW) +
+                               ", File \"" + endingTag.sourceFile + "\""
+                               " No points between tags.");
                 }
+            }
 
-                bool generatingOk = false;
-                int prevPointsWritten = pointsWritten;
-
-                generatingOk = generatePointCloudPointSet(params, beginningTag, endingTag, beginningUptime, uptime, averagedSync, outStream, pointsWritten);
-
-                if (generatingOk)
+            if (params.separateFilesForSubScans)
+            {
+                if (outStream)
                 {
-                    int pointsBetweenTags = pointsWritten - prevPointsWritten;
-
-                    if (pointsBetweenTags == 0)
-                    {
-                        emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
-                                   QString::number(beginningTag.sourceFileLine) +
-                                   ", uptime " + QString::number(beginningUptime) +
-                                   ", iTOW " + QString::number(beginningTag.iTOW) + ", ending tag line " +
-                                   QString::number(endingTag.sourceFileLine) +
-                                   ", uptime " + QString::number(endingTag.iTOW) +
-                                   ", iTOW " + QString::number(endingTag.iTOW) +
-                                   ", File \"" + endingTag.sourceFile + "\""
-                                   " No points between tags.");
-                    }
+                    flushVoxelGridFilter(params, outStream, pointsWritten);
+                    finishTiledWriter(outStream, outFile);
+                    delete outStream;
+                    outStream = nullptr;
                 }
-
-                if (params.separateFilesForSubScans)
+                if (outFile)
                 {
-                    if (outStream)
-                    {
-                        delete outStream;
-                        outStream = nullptr;
-                    }
-                    if (outFile)
-                    {
-                        int pointsBetweenTags = pointsWritten - prevPointsWritten;
-                        emit infoMessage("Closing file \"" + outFile->fileName() + "\". Points written: " + QString::number(pointsBetweenTags));
-                        outFile->close();
-                        delete outFile;
-                        outFile = nullptr;
-                    }
+                    int pointsBetweenTags = pointsWritten - prevPointsWritten;
+                    emit infoMessage("Closing file \"" + outFile->fileName() + "\". Points written: " + QString::number(pointsBetweenTags));
+                    commitOutFile(outFile);
+                    outFile = nullptr;
                 }
-
-                beginningUptime = -1;
             }
+
+            beginningUptime = -1;
         }
     }
 
+    if (cancelled)
+    {
+        // Files not committed are discarded (existing files are left untouched)
+        delete voxelGridFilter;
+        voxelGridFilter = nullptr;
+        delete outStream;
+
+        if (tiledWriter)
+        {
+            tiledWriter->discard();
+            delete tiledWriter;
+            tiledWriter = nullptr;
+        }
+
+        if (outFile)
+        {
+            emit warningMessage("File \"" + outFile->fileName() + "\" discarded.");
+            delete outFile;
+        }
+
+        emit warningMessage("Generating point clouds cancelled.");
+        return;
+    }
+
     if (beginningUptime != -1)
     {
         emit warningMessage("File \"" + beginningTag.sourceFile + "\", line " +
@@ -299,13 +301,14 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
 
     if (outStream)
     {
+        flushVoxelGridFilter(params, outStream, pointsWritten);
+        finishTiledWriter(outStream, outFile);
         delete outStream;
     }
     if (outFile)
     {
         emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
-        outFile->close();
-        delete outFile;
+        commitOutFile(outFile);
     }
 
     if (objectActive)
@@ -321,10 +324,13 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                                                      const PostProcessingForm::Tag& beginningTag,
                                                      const PostProcessingForm::Tag& endingTag,
                                                      const qint64 beginningUptime, const qint64 endingUptime,
-                                                     const QMap<qint64, UBXMessage_RELPOSNED::ITOW> &averagedSync,
+                                                     const ClockModel& clockModel,
                                                      QTextStream* outStream,
-                                                     int& pointsWritten)
+                                                     int& pointsWritten,
+                                                     int& pointsAccepted)
 {
+    TRACE_ZONE("PointCloudGenerator(lidar)::segment");
+
     QMap<qint64, PostProcessingForm::LidarRound>::const_iterator lidarIter = params.lidarRounds->upperBound(beginningUptime);
 
     // As lidar rounds are "mapped" according to their arriving (=end) timestamps,
@@ -336,33 +342,84 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
         lidarIter++;
     }
 
-    int pointsBetweenTags = 0;
+    // Without shared cache rounds are just filtered and transformed (nothing stored)
+    ProcessedRoundCache processedRoundCache_Local(0);
+    ProcessedRoundCache* processedRoundCache = params.processedRoundCache ? params.processedRoundCache : &processedRoundCache_Local;
 
-    QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
-    filteredItems.reserve(10000);
+    processedRoundCache->setSettings(*params.lidarFilteringSettings, *params.transform_BeforeRotation, *params.transform_AfterRotation);
 
-    RPLidarPlausibilityFilter plausibilityFilter;
+    if (params.voxelGridFiltering && !voxelGridFilter)
+    {
+        voxelGridFilter = new VoxelGridFilter(params.voxelGridFilterSettings);
+    }
 
-    plausibilityFilter.setSettings(*params.lidarFilteringSettings);
+    QVector<VoxelGridFilter::Point> pointsToWrite;
 
     while ((lidarIter != params.lidarRounds->end()) && (lidarIter.value().startTime < endingUptime))
     {
-        plausibilityFilter.filter(lidarIter.value().distanceItems, filteredItems);
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            // Caller checks the flag, too
+            return false;
+        }
 
-        // Q_ASSERT(lidarIter.value().distanceItems.count() == filteredItems.count());
+        reportProgress(params, lidarIter.key());
 
         const PostProcessingForm::LidarRound& round = lidarIter.value();
 
+        // Filtered items and constant transforms and laser rotation for the whole round at once
+        const ProcessedRoundCache::ProcessedRound& processedRound = processedRoundCache->getProcessedRound(lidarIter.key(), round);
+        const QVector<RPLidarPlausibilityFilter::FilteredItem>& filteredItems = processedRound.filteredItems;
+
+        // Q_ASSERT(lidarIter.value().distanceItems.count() == filteredItems.count());
+
+        // Early culling of points outside bounding sphere:
+        // Bounding sphere's center is transformed into rig's coordinate system using the pose at the beginning of the round.
+        // Pose changes during the round are taken into account by growing the radius with the maximum deviations
+        // (location change + rotation change * distance from rig's origin) so that culling never removes
+        // a point that would pass the exact test below. If limits can't be determined (interpolation would fail),
+        // culling is not done for this round to keep warnings/results identical.
+        bool cullingValid = false;
+        Eigen::Vector3d boundingSphereCenter_Rig;
+        double maxTranslationDeviation = 0;
+        double maxRotationDeviation = 0;
+
+        if (filteredItems.count() > 0)
+        {
+            qint64 firstRoverUptime = round.startTime + params.timeShift;
+            qint64 lastRoverUptime = round.startTime + (round.endTime - round.startTime) * (filteredItems.count() - 1) / lidarIter.value().distanceItems.count() + params.timeShift;
+            Eigen::Transform<double, 3, Eigen::Affine> transform_Reference;
+
+            cullingValid = params.loInterpolator->getLocationOrientationDeviationLimits_Uptime(firstRoverUptime, lastRoverUptime, clockModel,
+                                                                                               transform_Reference, maxTranslationDeviation, maxRotationDeviation);
+
+            if (cullingValid)
+            {
+                boundingSphereCenter_Rig = transform_Reference.linear().transpose() * (*params.boundingSphere_Center - transform_Reference.translation());
+            }
+        }
+
         for (int i = 0; i < filteredItems.count(); i++)
         {
             const RPLidarPlausibilityFilter::FilteredItem& currentItem = filteredItems[i];
 
             if (currentItem.type == RPLidarPlausibilityFilter::FilteredItem::FIT_PASSED)
             {
+                if (cullingValid)
+                {
+                    const auto laserHit_Rig = processedRound.laserHits.col(i);
+
+                    // Small constant added to cover rounding errors
+                    if ((laserHit_Rig - boundingSphereCenter_Rig).norm() >
+                            params.boundingSphere_Radius + maxTranslationDeviation + maxRotationDeviation * laserHit_Rig.norm() + 1e-6)
+                    {
+                        continue;
+                    }
+                }
+
                 // Rover coordinates interpolated according to distance timestamps.
 
                 qint64 itemUptime = round.startTime + (round.endTime - round.startTime) * i / lidarIter.value().distanceItems.count();
-                UBXMessage_RELPOSNED interpolated_Rovers[3];
 
                 qint64 roverUptime = itemUptime + params.timeShift;
 
@@ -370,10 +427,12 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
 
                 try
                 {
-                    params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(roverUptime, averagedSync, transform_LoSolver);
+                    params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(roverUptime, clockModel, transform_LoSolver);
                 }
                 catch (QString& stringThrown)
                 {
+                    writePoints(params, pointsToWrite, outStream, pointsWritten);
+
                     emit warningMessage("File \"" + lidarIter.value().fileName + "\", chunk index " +
                                QString::number(lidarIter.value().chunkIndex)+
                                ", uptime " + QString::number(lidarIter.key()) +
@@ -385,31 +444,12 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                 }
 
 
-                Eigen::Transform<double, 3, Eigen::Affine> transform_LaserRotation;
-                transform_LaserRotation = Eigen::AngleAxisd(currentItem.item.angle, Eigen::Vector3d::UnitZ()).toRotationMatrix();
-
+                // BeforeRotation-, laser rotation- and AfterRotation-transforms already applied (see ProcessedRoundCache).
                 // Lot of parentheses here to keep all calculations as matrix * vector
                 // This is _much_ faster, in quick tests time was dropped from 44 s to 24 s when using parentheses in the whole pointcloud-creation)
-                Eigen::Vector3d laserOriginAfterLOSolverTransformXYZ = *params.transform_NEDToXYZ * (transform_LoSolver * (*params.transform_AfterRotation * (transform_LaserRotation * (*params.transform_BeforeRotation * Eigen::Vector3d::Zero()))));
+                Eigen::Vector3d laserOriginAfterLOSolverTransformXYZ = *params.transform_NEDToXYZ * (transform_LoSolver * processedRound.laserOrigins.col(i));
 
-                /* "Step by step"-versions of the calculations above for possible debugging/tuning in the future:
-                Eigen::Vector3d laserOriginBeforeRotation = transform_BeforeRotation * Eigen::Vector3d::Zero();
-                Eigen::Vector3d laserOriginAfterRotation = transform_LaserRotation * laserOriginBeforeRotation;
-                Eigen::Vector3d laserOriginAfterPostRotationTransform = transform_AfterRotation * laserOriginAfterRotation;
-                Eigen::Vector3d laserOriginAfterLOSolverTransform = transform_LoSolver * laserOriginAfterPostRotationTransform;
-                Eigen::Vector3d laserOriginAfterLOSolverTransformXYZ = transform_NEDToXYZ * laserOriginAfterLOSolverTransform;
-                */
-
-                // Lot of parentheses here to keep all calculations as matrix * vector
-                // This is _much_ faster, in quick tests time was dropped from 44 s to 24 s when using parentheses in the whole pointcloud-creation)
-                Eigen::Vector3d laserHitPosAfterLOSolverTransform = transform_LoSolver * (*params.transform_AfterRotation * (transform_LaserRotation * (*params.transform_BeforeRotation * (currentItem.item.distance * Eigen::Vector3d::UnitX()))));
-
-                /* "Step by step"-versions of the calculations above for possible debugging/tuning in the future:
-                Eigen::Vector3d laserVectorBeforeRotation = transform_BeforeRotation * (currentItem.item.distance * Eigen::Vector3d::UnitX());
-                Eigen::Vector3d laserVectorAfterRotation = transform_LaserRotation * laserVectorBeforeRotation;
-                Eigen::Vector3d laserVectorAfterPostRotationTransform = transform_AfterRotation * laserVectorAfterRotation;
-                Eigen::Vector3d laserHitPosAfterLOSolverTransform = transform_LoSolver * laserVectorAfterPostRotationTransform;
-                */
+                Eigen::Vector3d laserHitPosAfterLOSolverTransform = transform_LoSolver * processedRound.laserHits.col(i);
 
                 if ((laserHitPosAfterLOSolverTransform - *params.boundingSphere_Center).norm() <= params.boundingSphere_Radius)
                 {
@@ -422,39 +462,142 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                         normal = (1. / (laserOriginAfterLOSolverTransformXYZ - laserHitPosAfterLOSolverTransformXYZ).norm()) * normal;
                     }
 
-                    QString lineOut;
-                    if (params.includeNormals)
+                    VoxelGridFilter::Point point;
+                    point.position = laserHitPosAfterLOSolverTransformXYZ;
+                    point.normal = normal;
+                    point.quality = currentItem.item.quality;
+                    point.distance = currentItem.item.distance;
+
+                    if (voxelGridFilter)
                     {
-                        lineOut = QString::number(laserHitPosAfterLOSolverTransformXYZ(0), 'f', 4) +
-                                "\t" + QString::number(laserHitPosAfterLOSolverTransformXYZ(1), 'f', 4) +
-                                "\t" + QString::number(laserHitPosAfterLOSolverTransformXYZ(2), 'f', 4) +
-                                "\t" + QString::number(normal(0), 'f', 4) +
-                                "\t" + QString::number(normal(1), 'f', 4) +
-                                "\t" + QString::number(normal(2), 'f', 4);
+                        // Points (if any) are written when voxels are removed from filter's memory
+                        voxelGridFilter->addPoint(point, pointsToWrite);
                     }
                     else
                     {
-                        lineOut = QString::number(laserHitPosAfterLOSolverTransformXYZ(0), 'f', 4) +
-                                "\t" + QString::number(laserHitPosAfterLOSolverTransformXYZ(1), 'f', 4) +
-                                "\t" + QString::number(laserHitPosAfterLOSolverTransformXYZ(2), 'f', 4);
+                        pointsToWrite.append(point);
                     }
 
-                    outStream->operator<<(lineOut + "\n");
-                    pointsWritten++;
-                    pointsBetweenTags++;
+                    pointsAccepted++;
                 }
             }
         }
 
+        writePoints(params, pointsToWrite, outStream, pointsWritten);
+        pointsToWrite.clear();
+
         lidarIter++;
     }
 
     return true;
 }
 
-QFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostProcessingForm::Tag &currentTag, const qint64 uptime)
+void PointCloudGenerator::writePoints(const Params& params, const QVector<VoxelGridFilter::Point>& points, QTextStream* outStream, int& pointsWritten)
+{
+    TRACE_ZONE("PointCloudGenerator(lidar)::writePoints");
+    TRACE_COUNT("Lidar points written", points.count());
+
+    if (tiledWriter)
+    {
+        // Possible write errors are reported when finishing
+        tiledWriter->addPoints(points);
+        pointsWritten += points.count();
+        return;
+    }
+
+    for (const VoxelGridFilter::Point& point : points)
+    {
+        QString lineOut;
+        if (params.includeNormals)
+        {
+            lineOut = QString::number(point.position(0), 'f', 4) +
+                    "\t" + QString::number(point.position(1), 'f', 4) +
+                    "\t" + QString::number(point.position(2), 'f', 4) +
+                    "\t" + QString::number(point.normal(0), 'f', 4) +
+                    "\t" + QString::number(point.normal(1), 'f', 4) +
+                    "\t" + QString::number(point.normal(2), 'f', 4);
+        }
+        else
+        {
+            lineOut = QString::number(point.position(0), 'f', 4) +
+                    "\t" + QString::number(point.position(1), 'f', 4) +
+                    "\t" + QString::number(point.position(2), 'f', 4);
+        }
+
+        outStream->operator<<(lineOut + "\n");
+        pointsWritten++;
+    }
+}
+
+void PointCloudGenerator::flushVoxelGridFilter(const Params& params, QTextStream* outStream, int& pointsWritten)
+{
+    if (!voxelGridFilter)
+    {
+        return;
+    }
+
+    QVector<VoxelGridFilter::Point> points;
+    voxelGridFilter->flush(points);
+    writePoints(params, points, outStream, pointsWritten);
+
+    emit infoMessage("Voxel grid filtering: " + QString::number(voxelGridFilter->getNumOfInputPoints()) +
+                     " points reduced to " + QString::number(voxelGridFilter->getNumOfOutputPoints()) + ".");
+
+    delete voxelGridFilter;
+    voxelGridFilter = nullptr;
+}
+
+void PointCloudGenerator::finishTiledWriter(QTextStream* outStream, QSaveFile* outFile)
 {
-    QFile* outFile = new QFile(fileName);
+    if (!tiledWriter)
+    {
+        return;
+    }
+
+    if (tiledWriter->finish(*outStream))
+    {
+        emit infoMessage("Tiled output: " + QString::number(tiledWriter->getNumOfPoints()) +
+                         " points in " + QString::number(tiledWriter->getNumOfNodes()) + " nodes.");
+    }
+    else
+    {
+        // Neither index nor tiles are left behind if some of the tiles couldn't be written
+        emit warningMessage(tiledWriter->getErrorString() + " Tiles discarded.");
+        tiledWriter->discard();
+
+        if (outFile)
+        {
+            outFile->cancelWriting();
+        }
+    }
+
+    if (tiledWriter->getNumOfSkippedPoints() != 0)
+    {
+        emit warningMessage("Tiled output: " + QString::number(tiledWriter->getNumOfSkippedPoints()) +
+                            " points outside supported coordinate range skipped.");
+    }
+
+    delete tiledWriter;
+    tiledWriter = nullptr;
+}
+
+void PointCloudGenerator::reportProgress(const Params& params, const qint64 uptime)
+{
+    if ((!params.task) || params.tags->isEmpty())
+    {
+        return;
+    }
+
+    qint64 firstUptime = params.tags->firstKey();
+    qint64 lastUptime = params.tags->lastKey();
+
+    GeneratorTask::setProgress(params.task, qBound(firstUptime, uptime, lastUptime) - firstUptime, lastUptime - firstUptime);
+}
+
+QSaveFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostProcessingForm::Tag &currentTag, const qint64 uptime)
+{
+    // Points are written into a temporary file that is renamed when the file is complete (see commitOutFile)
+    QSaveFile* outFile = new QSaveFile(fileName);
 
     if (outFile->exists())
     {
@@ -491,5 +634,49 @@ QFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostP
     return outFile;
 }
 
+QSaveFile* PointCloudGenerator::createNewOutFile(const Params& params, const QString baseFileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime)
+{
+    if (!params.tiledOutput)
+    {
+        return createNewOutFile(baseFileName + ".xyz", currentTag, uptime);
+    }
+
+    // Tiles are written into a directory next to the index file
+    QSaveFile* outFile = createNewOutFile(baseFileName + ".tiles", currentTag, uptime);
+
+    if (!outFile)
+    {
+        return outFile;
+    }
+
+    tiledWriter = new TiledPointCloudWriter(params.tiledOutputSettings, params.includeNormals);
+
+    if (!tiledWriter->open(baseFileName + "_tiles"))
+    {
+        emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
+                   QString::number(currentTag.sourceFileLine)+
+                   ", uptime " + QString::number(uptime) +
+                   ", iTOW " + QString::number(currentTag.iTOW) +
+                   ": " + tiledWriter->getErrorString() + " Ending previous object, but not beginning new. Ignoring subsequent beginning and ending tags.");
+
+        delete tiledWriter;
+        tiledWriter = nullptr;
+        delete outFile;
+        outFile = nullptr;
+    }
+
+    return outFile;
+}
+
+void PointCloudGenerator::commitOutFile(QSaveFile* outFile)
+{
+    if (!outFile->commit())
+    {
+        emit warningMessage("Writing file \"" + outFile->fileName() + "\" failed: " + outFile->errorString());
+    }
+
+    delete outFile;
+}
+
 
 }; // namespace Lidar
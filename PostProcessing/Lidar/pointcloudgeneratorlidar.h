@@ -19,12 +19,21 @@
 #ifndef POINTCLOUDGENERATORLIDAR_H
 #define POINTCLOUDGENERATORLIDAR_H
 
+#include <QSaveFile>
+
 #include "../postprocessingform.h"
+#include "../generatortask.h"
+#include "../tagsegmentindex.h"
+#include "../clockmodel.h"
+#include "voxelgridfilter.h"
+#include "tiledpointcloudwriter.h"
 
 
 namespace Lidar
 {
 
+class ProcessedRoundCache;
+
 class PointCloudGenerator : public QObject
 {
     Q_OBJECT
@@ -46,27 +55,49 @@ public:
         const Eigen::Vector3d* boundingSphere_Center;
         double boundingSphere_Radius = 1e9;
         bool separateFilesForSubScans = false;
+        bool voxelGridFiltering = false;                    //!< Downsample points of each output file using VoxelGridFilter
+        VoxelGridFilter::Settings voxelGridFilterSettings;
+        bool tiledOutput = false;                           //!< Write octree tiles (see TiledPointCloudWriter) + index file instead of xyz-files
+        TiledPointCloudWriter::Settings tiledOutputSettings;
 
         const QMultiMap<qint64, PostProcessingForm::Tag>* tags = nullptr;
+        const TagSegmentIndex* tagSegmentIndex = nullptr;  //!< Objects/segments of tags (built from tags if nullptr)
         const PostProcessingForm::Rover* rovers = nullptr;
+        unsigned int numOfRovers = 3;                   //!< Number of items in rovers
         const QMap<qint64, PostProcessingForm::LidarRound>* lidarRounds = nullptr;
         const RPLidarPlausibilityFilter::Settings* lidarFilteringSettings = nullptr;
         PostProcessingForm::LOInterpolator* loInterpolator = nullptr;
+        const ClockModel* clockModel = nullptr;     //!< Uptime <-> ITOW model (fitted from rovers if nullptr)
+        ProcessedRoundCache* processedRoundCache = nullptr;     //!< Filtered/transformed rounds shared between runs (rounds processed without storing if nullptr)
+        GeneratorTask* task = nullptr;                          //!< Progress reporting and cancellation (optional)
 
     };
 
     void generatePointClouds(const Params& params);
 
 private:
+    VoxelGridFilter* voxelGridFilter = nullptr;     //!< Filter for the current output file (if filtering enabled)
+    TiledPointCloudWriter* tiledWriter = nullptr;   //!< Writer for the current output file (if tiled output enabled)
+
     bool generatePointCloudPointSet(const Params& params,
                                     const PostProcessingForm::Tag& beginningTag,
                                     const PostProcessingForm::Tag& endingTag,
                                     const qint64 beginningUptime, const qint64 endingUptime,
-                                    const QMap<qint64, UBXMessage_RELPOSNED::ITOW> &averagedSync,
+                                    const ClockModel& clockModel,
                                     QTextStream* outStream,
-                                    int& pointsWritten);
+                                    int& pointsWritten,
+                                    int& pointsAccepted);
+
+    void writePoints(const Params& params, const QVector<VoxelGridFilter::Point>& points, QTextStream* outStream, int& pointsWritten);
+    void flushVoxelGridFilter(const Params& params, QTextStream* outStream, int& pointsWritten);  //!< Writes remaining points of voxelGridFilter and deletes it
+
+    QSaveFile* createNewOutFile(const Params& params, const QString baseFileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime); //!< Creates xyz- or index-file (+tile directory) depending on params.tiledOutput
+    void finishTiledWriter(QTextStream* outStream, QSaveFile* outFile);   //!< Writes index of tiledWriter into outStream and deletes it (outFile is not committed if writing tiles failed)
+
+    void reportProgress(const Params& params, const qint64 uptime);     //!< Reports uptime relative to the tags' range to params.task
 
-    QFile* createNewOutFile(const QString fileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime);
+    QSaveFile* createNewOutFile(const QString fileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime);
+    void commitOutFile(QSaveFile* outFile);     //!< Commits (=renames temporary file to final name) and deletes outFile
 
 signals:
     void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
@@ -0,0 +1,111 @@
+/*
+    processedroundcache.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file processedroundcache.cpp
+ * @brief Definition for a class that caches filtered and transformed lidar rounds.
+ */
+
+#include "processedroundcache.h"
+
+namespace Lidar
+{
+
+ProcessedRoundCache::ProcessedRoundCache(const int maxCachedItems) :
+    maxCachedItems(maxCachedItems),
+    pointTransformer(Eigen::Transform<double, 3, Eigen::Affine>::Identity(), Eigen::Transform<double, 3, Eigen::Affine>::Identity())
+{
+}
+
+void ProcessedRoundCache::setSettings(const RPLidarPlausibilityFilter::Settings& filteringSettings,
+                                      const Eigen::Transform<double, 3, Eigen::Affine>& transform_BeforeRotation,
+                                      const Eigen::Transform<double, 3, Eigen::Affine>& transform_AfterRotation)
+{
+    // Settings contain only floats -> raw bytes can be compared
+    QByteArray newFilteringSettingsKey(reinterpret_cast<const char*>(&filteringSettings), sizeof(filteringSettings));
+
+    if ((!settingsValid) || (newFilteringSettingsKey != filteringSettingsKey))
+    {
+        clear();
+        filteringSettingsKey = newFilteringSettingsKey;
+        plausibilityFilter.setSettings(filteringSettings);
+    }
+
+    if ((!settingsValid) ||
+            (transform_BeforeRotation.matrix() != transformMatrix_BeforeRotation) ||
+            (transform_AfterRotation.matrix() != transformMatrix_AfterRotation))
+    {
+        transformMatrix_BeforeRotation = transform_BeforeRotation.matrix();
+        transformMatrix_AfterRotation = transform_AfterRotation.matrix();
+        pointTransformer = PointTransformer(transform_BeforeRotation, transform_AfterRotation);
+        transformGeneration++;
+    }
+
+    settingsValid = true;
+}
+
+void ProcessedRoundCache::clear(void)
+{
+    processedRounds.clear();
+    cachedItems = 0;
+}
+
+const ProcessedRoundCache::ProcessedRound& ProcessedRoundCache::getProcessedRound(const qint64 roundKey, const PostProcessingForm::LidarRound& round)
+{
+    Q_ASSERT(settingsValid);
+
+    auto iter = processedRounds.find(roundKey);
+
+    if (iter != processedRounds.end())
+    {
+        hitCount++;
+
+        if (iter.value().transformGeneration != transformGeneration)
+        {
+            transformRound(iter.value());
+        }
+
+        return iter.value();
+    }
+
+    missCount++;
+
+    ProcessedRound* processedRound = &scratchRound;
+
+    if (cachedItems + round.distanceItems.count() <= maxCachedItems)
+    {
+        processedRound = &processedRounds[roundKey];
+        cachedItems += round.distanceItems.count();
+    }
+
+    plausibilityFilter.filter(round.distanceItems, processedRound->filteredItems);
+    transformRound(*processedRound);
+
+    return *processedRound;
+}
+
+void ProcessedRoundCache::transformRound(ProcessedRound& processedRound)
+{
+    pointTransformer.transformRound(processedRound.filteredItems);
+
+    processedRound.laserOrigins = pointTransformer.getLaserOrigins();
+    processedRound.laserHits = pointTransformer.getLaserHits();
+    processedRound.transformGeneration = transformGeneration;
+}
+
+}; // namespace Lidar
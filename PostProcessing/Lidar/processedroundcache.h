@@ -0,0 +1,109 @@
+/*
+    processedroundcache.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file processedroundcache.h
+ * @brief Declaration for a class that caches filtered and transformed lidar rounds.
+ */
+
+#ifndef PROCESSEDROUNDCACHE_H
+#define PROCESSEDROUNDCACHE_H
+
+#include <QHash>
+
+#include "../postprocessingform.h"
+#include "lidarpointtransformer.h"
+
+namespace Lidar
+{
+
+/**
+ * @brief Caches lidar rounds after plausibility filtering and PointTransformer
+ *
+ * Filtering and constant transforms depend only on the round itself, filtering settings
+ * and BeforeRotation/AfterRotation-transforms. Therefore the results can be reused
+ * between generator runs as long as these stay the same:
+ * - Changing filtering settings drops all cached rounds.
+ * - Changing transforms keeps filtered items but transforms them again when next requested.
+ *
+ * Lidar data itself is not tracked here, clear must be called when lidarRounds change.
+ * Rounds are cached until maxCachedItems distance items are stored,
+ * rounds after that are processed again every time (into a scratch round).
+ */
+class ProcessedRoundCache
+{
+public:
+    class ProcessedRound
+    {
+    public:
+        QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
+        Eigen::Matrix3Xd laserOrigins;      //!< See PointTransformer::getLaserOrigins
+        Eigen::Matrix3Xd laserHits;         //!< See PointTransformer::getLaserHits
+        unsigned int transformGeneration = 0;
+    };
+
+    ProcessedRoundCache(const int maxCachedItems = 2000000);   //!< Constructor
+
+    /**
+     * @brief Sets settings used for processing, drops cached results made with different settings
+     * @param filteringSettings Plausibility filter's settings
+     * @param transform_BeforeRotation See PointTransformer
+     * @param transform_AfterRotation See PointTransformer
+     */
+    void setSettings(const RPLidarPlausibilityFilter::Settings& filteringSettings,
+                     const Eigen::Transform<double, 3, Eigen::Affine>& transform_BeforeRotation,
+                     const Eigen::Transform<double, 3, Eigen::Affine>& transform_AfterRotation);
+
+    /**
+     * @brief Returns filtered and transformed round
+     * @param roundKey Key of the round in lidarRounds
+     * @param round Round
+     * @return Processed round. Reference is valid until next call of any non-const function.
+     */
+    const ProcessedRound& getProcessedRound(const qint64 roundKey, const PostProcessingForm::LidarRound& round);
+
+    void clear(void);   //!< Drops all cached rounds
+
+    int getHitCount(void) const { return hitCount; }        //!< Number of getProcessedRound-calls using cached filtering results
+    int getMissCount(void) const { return missCount; }      //!< Number of getProcessedRound-calls filtering the round
+
+private:
+    int maxCachedItems;
+    int cachedItems = 0;
+
+    int hitCount = 0;
+    int missCount = 0;
+
+    bool settingsValid = false;
+    QByteArray filteringSettingsKey;                            //!< Raw bytes of filtering settings
+    Eigen::Matrix4d transformMatrix_BeforeRotation;
+    Eigen::Matrix4d transformMatrix_AfterRotation;
+    unsigned int transformGeneration = 1;                       //!< Incremented when transforms change
+
+    RPLidarPlausibilityFilter plausibilityFilter;
+    PointTransformer pointTransformer;
+
+    QHash<qint64, ProcessedRound> processedRounds;
+    ProcessedRound scratchRound;                                //!< Used when cache is full
+
+    void transformRound(ProcessedRound& processedRound);
+};
+
+}; // namespace Lidar
+
+#endif // PROCESSEDROUNDCACHE_H
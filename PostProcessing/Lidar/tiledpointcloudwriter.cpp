@@ -0,0 +1,373 @@
+/*
+    tiledpointcloudwriter.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tiledpointcloudwriter.cpp
+ * @brief Definition for a writer creating tiled multi-resolution (octree) point clouds.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+#include "tiledpointcloudwriter.h"
+#include "../../tracer.h"
+
+namespace Lidar
+{
+
+bool TiledPointCloudWriter::NodeKey::operator==(const NodeKey& other) const
+{
+    return (tileX == other.tileX) && (tileY == other.tileY) && (tileZ == other.tileZ) &&
+            (level == other.level) && (path == other.path);
+}
+
+bool TiledPointCloudWriter::NodeKey::operator<(const NodeKey& other) const
+{
+    if (tileX != other.tileX) return tileX < other.tileX;
+    if (tileY != other.tileY) return tileY < other.tileY;
+    if (tileZ != other.tileZ) return tileZ < other.tileZ;
+    if (level != other.level) return level < other.level;
+    return path < other.path;
+}
+
+uint qHash(const TiledPointCloudWriter::NodeKey& key, uint seed)
+{
+    return qHash((static_cast<quint64>(static_cast<quint32>(key.tileX)) << 32) ^
+                 (static_cast<quint64>(static_cast<quint32>(key.tileY)) << 16) ^
+                 static_cast<quint64>(static_cast<quint32>(key.tileZ)) ^
+                 (key.path * 0x9E3779B97F4A7C15ULL) ^
+                 static_cast<quint64>(key.level), seed);
+}
+
+TiledPointCloudWriter::TiledPointCloudWriter(const Settings& settings, const bool includeNormals)
+{
+    this->settings = settings;
+    this->includeNormals = includeNormals;
+
+    this->settings.gridResolution = qBound(1, this->settings.gridResolution, 1024);
+    this->settings.maxDepth = qBound(0, this->settings.maxDepth, maxSupportedDepth);
+
+    if (this->settings.maxBufferedPoints < 1)
+    {
+        this->settings.maxBufferedPoints = 1;
+    }
+
+    qint64 numOfCells = static_cast<qint64>(this->settings.gridResolution) * this->settings.gridResolution * this->settings.gridResolution;
+    occupancyGridWords = static_cast<int>((numOfCells + 63) / 64);
+    maxNumOfOccupancyGrids = static_cast<int>(qBound(static_cast<qint64>(1),
+                                                     this->settings.maxOccupancyMemory / (occupancyGridWords * static_cast<qint64>(sizeof(quint64))),
+                                                     static_cast<qint64>(0x7FFFFFFF)));
+}
+
+bool TiledPointCloudWriter::open(const QString& directoryPath)
+{
+    QDir directory(directoryPath);
+
+    if (directory.exists())
+    {
+        errorString = "Directory \"" + directoryPath + "\" already exists.";
+        return false;
+    }
+
+    if (!directory.mkpath("."))
+    {
+        errorString = "Directory \"" + directoryPath + "\" can't be created.";
+        return false;
+    }
+
+    // Only a directory created here is removed by discard
+    this->directoryPath = directoryPath;
+
+    return true;
+}
+
+QString TiledPointCloudWriter::getNodeFileName(const NodeKey& key)
+{
+    QString fileName = "t" + QString::number(key.tileX) + "_" + QString::number(key.tileY) + "_" + QString::number(key.tileZ) + "_r";
+
+    for (int level = key.level - 1; level >= 0; level--)
+    {
+        fileName += QString::number((key.path >> (level * 3)) & 7);
+    }
+
+    return fileName + ".bin";
+}
+
+void TiledPointCloudWriter::addPoint(const VoxelGridFilter::Point& point)
+{
+    NodeKey key;
+    qint32 tileIndices[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        double tileIndex = floor(point.position(i) / settings.tileSize);
+
+        if ((!(tileIndex >= -maxTileIndex)) || (!(tileIndex < maxTileIndex)))
+        {
+            // Too far (or NaN)
+            numOfSkippedPoints++;
+            return;
+        }
+
+        tileIndices[i] = static_cast<qint32>(tileIndex);
+    }
+
+    key.tileX = tileIndices[0];
+    key.tileY = tileIndices[1];
+    key.tileZ = tileIndices[2];
+
+    Eigen::Vector3d minCorner(tileIndices[0] * settings.tileSize, tileIndices[1] * settings.tileSize, tileIndices[2] * settings.tileSize);
+    double size = settings.tileSize;
+
+    for (key.level = 0; ; key.level++)
+    {
+        QHash<NodeKey, Node>::iterator nodeIter = nodes.find(key);
+
+        if (nodeIter == nodes.end())
+        {
+            Node newNode;
+            newNode.minCorner = minCorner;
+            newNode.size = size;
+            nodeIter = nodes.insert(key, newNode);
+        }
+
+        Node& node = nodeIter.value();
+
+        bool store = (key.level >= settings.maxDepth);
+
+        if ((!store) && (!node.occupancyEvicted))
+        {
+            node.lastUsed = ++useCounter;
+
+            if (node.occupiedCells.isEmpty())
+            {
+                node.occupiedCells.fill(0, occupancyGridWords);
+                numOfOccupancyGrids++;
+
+                if (numOfOccupancyGrids > maxNumOfOccupancyGrids)
+                {
+                    // Only values are modified -> node-reference stays valid (and this node is the most recently used)
+                    evictOccupancyGrids();
+                }
+            }
+
+            quint32 cellIndex = 0;
+
+            for (int i = 0; i < 3; i++)
+            {
+                int axisIndex = static_cast<int>((point.position(i) - minCorner(i)) * settings.gridResolution / size);
+                cellIndex = cellIndex * settings.gridResolution + qBound(0, axisIndex, settings.gridResolution - 1);
+            }
+
+            quint64& word = node.occupiedCells[static_cast<int>(cellIndex / 64)];
+            const quint64 mask = 1ULL << (cellIndex % 64);
+
+            if (!(word & mask))
+            {
+                word |= mask;
+                store = true;
+            }
+        }
+
+        if (store)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                node.buffer.append(static_cast<float>(point.position(i) - minCorner(i)));
+            }
+
+            if (includeNormals)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    node.buffer.append(static_cast<float>(point.normal(i)));
+                }
+            }
+
+            node.numOfPoints++;
+            numOfPoints++;
+            numOfBufferedPoints++;
+            return;
+        }
+
+        // Cell already occupied -> Try the child containing the point
+        size /= 2;
+        int childIndex = 0;
+
+        for (int i = 0; i < 3; i++)
+        {
+            if (point.position(i) >= minCorner(i) + size)
+            {
+                minCorner(i) += size;
+                childIndex |= (4 >> i);
+            }
+        }
+
+        key.path = (key.path << 3) | childIndex;
+    }
+}
+
+void TiledPointCloudWriter::evictOccupancyGrids(void)
+{
+    // Evicting a quarter at a time keeps the cost of finding the least recently used ones small
+    QVector<QPair<quint64, Node*>> gridNodes;
+    gridNodes.reserve(numOfOccupancyGrids);
+
+    for (QHash<NodeKey, Node>::iterator iter = nodes.begin(); iter != nodes.end(); iter++)
+    {
+        if (!iter.value().occupiedCells.isEmpty())
+        {
+            gridNodes.append(qMakePair(iter.value().lastUsed, &iter.value()));
+        }
+    }
+
+    int numOfGridsToEvict = qMin(qMax(1, maxNumOfOccupancyGrids / 4), gridNodes.count() - 1);
+
+    if (numOfGridsToEvict <= 0)
+    {
+        return;
+    }
+
+    std::nth_element(gridNodes.begin(), gridNodes.begin() + numOfGridsToEvict, gridNodes.end(),
+                     [](const QPair<quint64, Node*>& a, const QPair<quint64, Node*>& b) { return a.first < b.first; });
+
+    for (int i = 0; i < numOfGridsToEvict; i++)
+    {
+        Node* node = gridNodes[i].second;
+
+        node->occupiedCells.clear();
+        node->occupiedCells.squeeze();
+        node->occupancyEvicted = true;
+    }
+
+    numOfOccupancyGrids -= numOfGridsToEvict;
+    numOfEvictedOccupancyGrids += numOfGridsToEvict;
+}
+
+bool TiledPointCloudWriter::addPoints(const QVector<VoxelGridFilter::Point>& points)
+{
+    for (const VoxelGridFilter::Point& point : points)
+    {
+        addPoint(point);
+    }
+
+    if (numOfBufferedPoints >= settings.maxBufferedPoints)
+    {
+        return flushBuffers();
+    }
+
+    return true;
+}
+
+bool TiledPointCloudWriter::flushBuffers(void)
+{
+    TRACE_ZONE("TiledPointCloudWriter::flushBuffers");
+
+    bool success = true;
+
+    for (QHash<NodeKey, Node>::iterator iter = nodes.begin(); iter != nodes.end(); iter++)
+    {
+        Node& node = iter.value();
+
+        if (node.buffer.isEmpty())
+        {
+            continue;
+        }
+
+        QByteArray bytes(node.buffer.count() * static_cast<int>(sizeof(quint32)), Qt::Uninitialized);
+
+        for (int i = 0; i < node.buffer.count(); i++)
+        {
+            quint32 value;
+            memcpy(&value, node.buffer.constData() + i, sizeof(value));
+            qToLittleEndian<quint32>(value, bytes.data() + i * sizeof(quint32));
+        }
+
+        // Files are opened only for appending to keep number of open files small
+        QFile file(directoryPath + "/" + getNodeFileName(iter.key()));
+
+        if ((!file.open(QIODevice::WriteOnly | QIODevice::Append)) ||
+                (file.write(bytes) != bytes.size()))
+        {
+            errorString = "Writing file \"" + file.fileName() + "\" failed: " + file.errorString();
+            success = false;
+        }
+
+        node.buffer.clear();
+        node.buffer.squeeze();
+    }
+
+    numOfBufferedPoints = 0;
+
+    return success;
+}
+
+bool TiledPointCloudWriter::finish(QTextStream& indexStream)
+{
+    bool success = flushBuffers();
+
+    indexStream << "// Tiled point cloud (octree). Node files contain little endian 32 bit floats:\n";
+    indexStream << "// x, y, z relative to node's minimum corner" << (includeNormals ? ", normal x, y, z" : "") << "\n";
+    indexStream << "TileSize\t" << QString::number(settings.tileSize, 'f', 4) << "\n";
+    indexStream << "GridResolution\t" << settings.gridResolution << "\n";
+    indexStream << "MaxDepth\t" << settings.maxDepth << "\n";
+    indexStream << "Normals\t" << (includeNormals ? 1 : 0) << "\n";
+    indexStream << "Points\t" << numOfPoints << "\n";
+    indexStream << "// Node\tTileX\tTileY\tTileZ\tLevel\tMinX\tMinY\tMinZ\tSize\tPoints\tFile\n";
+
+    QList<NodeKey> keys = nodes.keys();
+    std::sort(keys.begin(), keys.end());
+
+    for (const NodeKey& key : keys)
+    {
+        const Node& node = nodes[key];
+
+        indexStream << "Node" <<
+                       "\t" << key.tileX <<
+                       "\t" << key.tileY <<
+                       "\t" << key.tileZ <<
+                       "\t" << key.level <<
+                       "\t" << QString::number(node.minCorner(0), 'f', 4) <<
+                       "\t" << QString::number(node.minCorner(1), 'f', 4) <<
+                       "\t" << QString::number(node.minCorner(2), 'f', 4) <<
+                       "\t" << QString::number(node.size, 'f', 4) <<
+                       "\t" << node.numOfPoints <<
+                       "\t" << getNodeFileName(key) << "\n";
+    }
+
+    return success;
+}
+
+void TiledPointCloudWriter::discard(void)
+{
+    if (!directoryPath.isEmpty())
+    {
+        QDir(directoryPath).removeRecursively();
+    }
+
+    nodes.clear();
+    numOfOccupancyGrids = 0;
+    numOfBufferedPoints = 0;
+}
+
+}; // namespace Lidar
@@ -0,0 +1,168 @@
+/*
+    tiledpointcloudwriter.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tiledpointcloudwriter.h
+ * @brief Declaration for a writer creating tiled multi-resolution (octree) point clouds.
+ */
+
+#ifndef TILEDPOINTCLOUDWRITER_H
+#define TILEDPOINTCLOUDWRITER_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QTextStream>
+
+#include "voxelgridfilter.h"
+
+namespace Lidar
+{
+
+/**
+ * @brief Writes points into spatial tiles, each of them an octree with coarser levels of detail on top
+ *
+ * Space is divided into cubic tiles (Settings::tileSize). Every tile is the root (level 0) of an octree
+ * whose nodes hold at most one point per cell of a Settings::gridResolution^3 subsampling grid.
+ * A point is stored in the first node (from the root down) whose grid cell is still empty.
+ * Nodes at Settings::maxDepth keep all points reaching them.
+ * Coarse levels are therefore built during the same (single) pass, and any region
+ * can be loaded at the required detail by reading only the nodes needed.
+ *
+ * Points of each node are buffered and appended to the node's own binary file
+ * when more than Settings::maxBufferedPoints points are in memory.
+ *
+ * Occupied cells of a node are kept in a bitset (gridResolution^3 bits). When the bitsets
+ * exceed Settings::maxOccupancyMemory, least recently used ones are evicted (like chunks of
+ * VoxelGridFilter). Node with an evicted bitset is considered full: later points reaching it
+ * are stored deeper in the octree. Every point is still stored exactly once, only the coarse
+ * levels may become sparser where the scanner returns to an area visited long ago.
+ * Memory usage is therefore bounded by maxBufferedPoints, maxOccupancyMemory and
+ * a small fixed amount per node (number of nodes depends on the covered volume, not on the number of points).
+ *
+ * Output (directory given to open):
+ * - One file per node: "t<tileX>_<tileY>_<tileZ>_r<child indices>.bin", for example "t0_-1_2_r073.bin"
+ *   is the node reached from the tile's root through children 0, 7 and 3.
+ *   Child index = (x >= center ? 4 : 0) + (y >= center ? 2 : 0) + (z >= center ? 1 : 0).
+ * - Points are stored as little endian 32 bit floats: x, y, z relative to node's minimum corner
+ *   (followed by normal's x, y, z if normals are included).
+ *
+ * Index (written into a text stream by finish) lists the settings and all the nodes.
+ */
+class TiledPointCloudWriter
+{
+public:
+    class Settings
+    {
+    public:
+        double tileSize = 50;               //!< Size of the tiles (=octree roots) (m)
+        int gridResolution = 64;            //!< Subsampling grid cells per node side
+        int maxDepth = 6;                   //!< Deepest octree level (0 = tiles only)
+        int maxBufferedPoints = 1000000;    //!< Limit for number of points kept in memory before writing them into node files
+        qint64 maxOccupancyMemory = 128 * 1024 * 1024;  //!< Limit for memory used by occupied cell bitsets (bytes, at least one bitset is kept)
+    };
+
+    TiledPointCloudWriter(const Settings& settings, const bool includeNormals);    //!< Constructor
+
+    /**
+     * @brief Creates output directory
+     * @param directoryPath Directory for the node files (must not exist)
+     * @return True if successful (see getErrorString otherwise)
+     */
+    bool open(const QString& directoryPath);
+
+    /**
+     * @brief Adds points into the octree
+     * @param points Points to add
+     * @return False if writing node files failed (see getErrorString)
+     */
+    bool addPoints(const QVector<VoxelGridFilter::Point>& points);
+
+    /**
+     * @brief Writes remaining points into node files and index into the stream
+     * @param indexStream Stream for the index
+     * @return False if writing node files failed (see getErrorString)
+     */
+    bool finish(QTextStream& indexStream);
+
+    void discard(void);     //!< Removes output directory with all node files written so far
+
+    qint64 getNumOfPoints(void) const { return numOfPoints; }               //!< Returns number of points stored
+    qint64 getNumOfSkippedPoints(void) const { return numOfSkippedPoints; } //!< Returns number of points skipped (outside tile range or invalid)
+    int getNumOfNodes(void) const { return nodes.count(); }                 //!< Returns number of octree nodes created
+    int getNumOfOccupancyGrids(void) const { return numOfOccupancyGrids; }  //!< Returns number of occupied cell bitsets in memory
+    int getMaxNumOfOccupancyGrids(void) const { return maxNumOfOccupancyGrids; }    //!< Returns max number of occupied cell bitsets in memory (from Settings::maxOccupancyMemory)
+    qint64 getNumOfEvictedOccupancyGrids(void) const { return numOfEvictedOccupancyGrids; }    //!< Returns number of bitsets evicted so far
+    QString getErrorString(void) const { return errorString; }              //!< Returns description of the last error
+
+private:
+    class NodeKey
+    {
+    public:
+        qint32 tileX = 0;
+        qint32 tileY = 0;
+        qint32 tileZ = 0;
+        int level = 0;
+        quint64 path = 0;       //!< Child indices from the root, 3 bits per level (latest in lowest bits)
+
+        bool operator==(const NodeKey& other) const;
+        bool operator<(const NodeKey& other) const;
+    };
+
+    friend uint qHash(const NodeKey& key, uint seed);
+
+    class Node
+    {
+    public:
+        Eigen::Vector3d minCorner;
+        double size = 0;
+        QVector<quint64> occupiedCells; //!< Bitset of subsampling grid cells having a point (empty if not allocated or evicted, not used on the deepest level)
+        bool occupancyEvicted = false;  //!< Bitset evicted -> Node is considered full
+        quint64 lastUsed = 0;
+        QVector<float> buffer;          //!< Points not yet written into the file
+        qint64 numOfPoints = 0;
+    };
+
+    static const int maxTileIndex = (1 << 20);
+    static const int maxSupportedDepth = 20;    //!< Limited by NodeKey::path
+
+    Settings settings;
+    bool includeNormals;
+    QString directoryPath;
+
+    QHash<NodeKey, Node> nodes;
+    int occupancyGridWords = 1;             //!< Size of one bitset (64 bit words)
+    int numOfOccupancyGrids = 0;
+    int maxNumOfOccupancyGrids = 1;
+    qint64 numOfEvictedOccupancyGrids = 0;
+    quint64 useCounter = 0;
+    qint64 numOfBufferedPoints = 0;
+    qint64 numOfPoints = 0;
+    qint64 numOfSkippedPoints = 0;
+    QString errorString;
+
+    static QString getNodeFileName(const NodeKey& key);
+
+    void addPoint(const VoxelGridFilter::Point& point);
+    void evictOccupancyGrids(void);     //!< Evicts least recently used bitsets (quarter of the maximum amount)
+    bool flushBuffers(void);    //!< Appends buffered points into node files
+};
+
+}; // namespace Lidar
+
+#endif // TILEDPOINTCLOUDWRITER_H
@@ -0,0 +1,307 @@
+/*
+    timeshiftcalibrator.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file timeshiftcalibrator.cpp
+ * @brief Definition for a class that searches the lidar/rover time shift giving the sharpest point cloud.
+ */
+
+#include <QtConcurrent>
+#include <QHash>
+
+#include "timeshiftcalibrator.h"
+#include "processedroundcache.h"
+
+namespace Lidar
+{
+
+bool TimeShiftCalibrator::calibrate(const Params& params, int& bestTimeShift, QVector<ScoredTimeShift>& scoreCurve)
+{
+    scoreCurve.clear();
+
+    if ((params.timeShift_Min > params.timeShift_Max) || (params.coarseStep < 1) ||
+            (params.refinementDivider < 2) || (params.cellSize <= 0) || (params.maxPoints < 1))
+    {
+        emit errorMessage("Invalid time shift calibration parameters.");
+        return false;
+    }
+
+    ClockModel clockModel_Generated;
+
+    if (!params.clockModel)
+    {
+        emit infoMessage("Fitting uptime/ITOW clock model...");
+        clockModel_Generated.fit(params.rovers, params.numOfRovers);
+    }
+
+    const ClockModel& clockModel = params.clockModel ? *params.clockModel : clockModel_Generated;
+
+    QVector<RigPoint> points = collectPoints(params, clockModel);
+
+    if (points.isEmpty())
+    {
+        emit errorMessage("No lidar points between tags. Time shift can not be calibrated.");
+        return false;
+    }
+
+    emit infoMessage("Time shift calibration: " + QString::number(points.count()) + " points used for scoring.");
+
+    QMap<int, ScoredTimeShift> evaluated;
+
+    int rangeLow = params.timeShift_Min;
+    int rangeHigh = params.timeShift_Max;
+    int step = params.coarseStep;
+
+    while (true)
+    {
+        QVector<QFuture<ScoredTimeShift>> futures;
+
+        for (int timeShift = rangeLow; timeShift <= rangeHigh; timeShift += step)
+        {
+            if (!evaluated.contains(timeShift))
+            {
+                futures.append(QtConcurrent::run([&params, &points, &clockModel, timeShift]()
+                {
+                    return evaluate(params, points, clockModel, timeShift);
+                }));
+            }
+        }
+
+        // Progress is reported per pass (number of passes depends on the results)
+        for (int i = 0; i < futures.count(); i++)
+        {
+            ScoredTimeShift result = futures[i].result();
+            evaluated.insert(result.timeShift, result);
+            GeneratorTask::setProgress(params.task, i + 1, futures.count());
+        }
+
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            emit warningMessage("Time shift calibration cancelled.");
+            return false;
+        }
+
+        const ScoredTimeShift* best = nullptr;
+
+        for (const ScoredTimeShift& candidate : evaluated)
+        {
+            if (candidate.valid && ((!best) || (candidate.score < best->score)))
+            {
+                best = &candidate;
+            }
+        }
+
+        if (!best)
+        {
+            emit errorMessage("Time shift calibration: No valid candidates (interpolation failed for too many points).");
+            return false;
+        }
+
+        bestTimeShift = best->timeShift;
+
+        emit infoMessage("Time shift calibration: Step " + QString::number(step) + " ms, best time shift so far " +
+                         QString::number(bestTimeShift) + " ms (score " + QString::number(best->score, 'f', 6) + ").");
+
+        if (step == 1)
+        {
+            break;
+        }
+
+        rangeLow = qMax(params.timeShift_Min, bestTimeShift - step);
+        rangeHigh = qMin(params.timeShift_Max, bestTimeShift + step);
+        step = qMax(1, step / params.refinementDivider);
+    }
+
+    for (const ScoredTimeShift& candidate : evaluated)
+    {
+        scoreCurve.append(candidate);
+    }
+
+    return true;
+}
+
+QVector<TimeShiftCalibrator::RigPoint> TimeShiftCalibrator::collectPoints(const Params& params, const ClockModel& clockModel)
+{
+    QVector<RigPoint> points;
+
+    // Without shared cache rounds are just filtered and transformed (nothing stored)
+    ProcessedRoundCache processedRoundCache_Local(0);
+    ProcessedRoundCache* processedRoundCache = params.processedRoundCache ? params.processedRoundCache : &processedRoundCache_Local;
+
+    processedRoundCache->setSettings(*params.lidarFilteringSettings, *params.transform_BeforeRotation, *params.transform_AfterRotation);
+
+    PostProcessingForm::LOInterpolator loInterpolator = *params.loInterpolator;
+
+    qint64 beginningUptime = -1;
+    qint64 uptime = -1;
+
+    while (params.tags->upperBound(uptime) != params.tags->end())
+    {
+        uptime = params.tags->upperBound(uptime).key();
+
+        QList<PostProcessingForm::Tag> tagItems = params.tags->values(uptime);
+
+        // Items with the same key are in reverse insertion order (see PointCloudGenerator)
+        for (int tagIndex = tagItems.size() - 1; tagIndex >= 0; tagIndex--)
+        {
+            const PostProcessingForm::Tag& currentTag = tagItems[tagIndex];
+
+            if (!currentTag.ident.compare(params.tagIdent_BeginPoints))
+            {
+                beginningUptime = uptime;
+                continue;
+            }
+            else if ((currentTag.ident.compare(params.tagIdent_EndPoints)) || (beginningUptime == -1))
+            {
+                continue;
+            }
+
+            // Same round selection as in PointCloudGenerator::generatePointCloudPointSet
+            QMap<qint64, PostProcessingForm::LidarRound>::const_iterator lidarIter = params.lidarRounds->upperBound(beginningUptime);
+
+            while ((lidarIter != params.lidarRounds->end()) && (lidarIter.value().startTime < beginningUptime))
+            {
+                lidarIter++;
+            }
+
+            while ((lidarIter != params.lidarRounds->end()) && (lidarIter.value().startTime < uptime))
+            {
+                const PostProcessingForm::LidarRound& round = lidarIter.value();
+
+                const ProcessedRoundCache::ProcessedRound& processedRound = processedRoundCache->getProcessedRound(lidarIter.key(), round);
+                const QVector<RPLidarPlausibilityFilter::FilteredItem>& filteredItems = processedRound.filteredItems;
+
+                for (int i = 0; i < filteredItems.count(); i++)
+                {
+                    if (filteredItems[i].type != RPLidarPlausibilityFilter::FilteredItem::FIT_PASSED)
+                    {
+                        continue;
+                    }
+
+                    RigPoint point;
+                    point.uptime = round.startTime + (round.endTime - round.startTime) * i / round.distanceItems.count();
+                    point.position = processedRound.laserHits.col(i);
+
+                    Eigen::Transform<double, 3, Eigen::Affine> transform_LoSolver;
+
+                    try
+                    {
+                        loInterpolator.getInterpolatedLocationOrientationTransformMatrix_Uptime(point.uptime + params.timeShift_Initial, clockModel, transform_LoSolver);
+                    }
+                    catch (QString&)
+                    {
+                        continue;
+                    }
+
+                    if (((transform_LoSolver * point.position) - *params.boundingSphere_Center).norm() <= params.boundingSphere_Radius)
+                    {
+                        points.append(point);
+                    }
+                }
+
+                lidarIter++;
+            }
+
+            beginningUptime = -1;
+        }
+    }
+
+    if (points.count() > params.maxPoints)
+    {
+        // Uniform subsampling keeps points from the whole time range
+        QVector<RigPoint> subsampled;
+        subsampled.reserve(params.maxPoints);
+
+        for (int i = 0; i < params.maxPoints; i++)
+        {
+            subsampled.append(points[static_cast<int>(static_cast<qint64>(i) * points.count() / params.maxPoints)]);
+        }
+
+        points.swap(subsampled);
+    }
+
+    return points;
+}
+
+TimeShiftCalibrator::ScoredTimeShift TimeShiftCalibrator::evaluate(const Params& params, const QVector<RigPoint>& points,
+                                                                   const ClockModel& clockModel, const int timeShift)
+{
+    // Interpolator caches last used sync points -> every evaluation needs its own copy
+    PostProcessingForm::LOInterpolator loInterpolator = *params.loInterpolator;
+
+    QVector<Eigen::Vector3d> transformedPoints;
+    transformedPoints.reserve(points.count());
+
+    for (const RigPoint& point : points)
+    {
+        Eigen::Transform<double, 3, Eigen::Affine> transform_LoSolver;
+
+        try
+        {
+            loInterpolator.getInterpolatedLocationOrientationTransformMatrix_Uptime(point.uptime + timeShift, clockModel, transform_LoSolver);
+        }
+        catch (QString&)
+        {
+            continue;
+        }
+
+        transformedPoints.append(transform_LoSolver * point.position);
+    }
+
+    ScoredTimeShift result;
+
+    result.timeShift = timeShift;
+    result.numOfPoints = transformedPoints.count();
+    result.valid = (transformedPoints.count() > 0) && (transformedPoints.count() >= params.minValidPointRatio * points.count());
+    result.score = calculateVoxelEntropy(transformedPoints, params.cellSize);
+
+    return result;
+}
+
+double TimeShiftCalibrator::calculateVoxelEntropy(const QVector<Eigen::Vector3d>& points, const double cellSize)
+{
+    if (points.isEmpty())
+    {
+        return 0;
+    }
+
+    QHash<quint64, int> voxelCounts;
+    voxelCounts.reserve(points.count());
+
+    for (const Eigen::Vector3d& point : points)
+    {
+        // 21 bits per axis is enough for +-1e6 cells
+        quint64 x = static_cast<quint64>(static_cast<qint64>(floor(point(0) / cellSize)) + (1 << 20)) & 0x1FFFFF;
+        quint64 y = static_cast<quint64>(static_cast<qint64>(floor(point(1) / cellSize)) + (1 << 20)) & 0x1FFFFF;
+        quint64 z = static_cast<quint64>(static_cast<qint64>(floor(point(2) / cellSize)) + (1 << 20)) & 0x1FFFFF;
+
+        voxelCounts[(x << 42) | (y << 21) | z]++;
+    }
+
+    // Entropy = -sum(p * ln(p)) = ln(N) - sum(c * ln(c)) / N
+    double sum = 0;
+
+    for (const int count : voxelCounts)
+    {
+        sum += count * log(count);
+    }
+
+    return log(points.count()) - sum / points.count();
+}
+
+}; // namespace Lidar
@@ -0,0 +1,129 @@
+/*
+    timeshiftcalibrator.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file timeshiftcalibrator.h
+ * @brief Declaration for a class that searches the lidar/rover time shift giving the sharpest point cloud.
+ */
+
+#ifndef TIMESHIFTCALIBRATOR_H
+#define TIMESHIFTCALIBRATOR_H
+
+#include "../postprocessingform.h"
+#include "../generatortask.h"
+#include "../clockmodel.h"
+
+namespace Lidar
+{
+
+class ProcessedRoundCache;
+
+/**
+ * @brief Searches the time shift (rover uptime = lidar uptime + shift) giving the sharpest point cloud
+ *
+ * Points between beginning and ending tags are filtered and transformed into rig's
+ * coordinate system once. For every candidate time shift the points are then transformed
+ * using interpolated location/orientation and the sharpness of the resulting cloud is scored
+ * using voxel entropy (smaller = sharper, wrong time shift smears surfaces into more voxels).
+ *
+ * Search is done coarse to fine: the whole range is first evaluated using coarseStep,
+ * then the neighbourhood of the best candidate with steps divided by refinementDivider until step is 1 ms.
+ * Candidates of each pass are evaluated in parallel (each with its own copy of LOInterpolator).
+ */
+class TimeShiftCalibrator : public QObject
+{
+    Q_OBJECT
+
+public:
+    class Params
+    {
+    public:
+        const Eigen::Transform<double, 3, Eigen::Affine>* transform_BeforeRotation = nullptr;
+        const Eigen::Transform<double, 3, Eigen::Affine>* transform_AfterRotation = nullptr;
+        QString tagIdent_BeginPoints = "RMB";
+        QString tagIdent_EndPoints = "LMB";
+        const Eigen::Vector3d* boundingSphere_Center = nullptr;
+        double boundingSphere_Radius = 1e9;
+        int timeShift_Initial = 0;          //!< Time shift used when culling points outside bounding sphere (ms)
+
+        int timeShift_Min = -500;           //!< Smallest time shift evaluated (ms)
+        int timeShift_Max = 500;            //!< Largest time shift evaluated (ms)
+        int coarseStep = 50;                //!< Step of the first (coarse) pass (ms)
+        int refinementDivider = 5;          //!< Step is divided by this on every refinement pass
+        double cellSize = 0.05;             //!< Voxel size used in scoring (m)
+        int maxPoints = 50000;              //!< Points are subsampled to (at most) this count
+        double minValidPointRatio = 0.95;   //!< Candidate is rejected if interpolation fails for more points than this allows
+
+        const QMultiMap<qint64, PostProcessingForm::Tag>* tags = nullptr;
+        const PostProcessingForm::Rover* rovers = nullptr;
+        unsigned int numOfRovers = 3;                   //!< Number of items in rovers
+        const QMap<qint64, PostProcessingForm::LidarRound>* lidarRounds = nullptr;
+        const RPLidarPlausibilityFilter::Settings* lidarFilteringSettings = nullptr;
+        const PostProcessingForm::LOInterpolator* loInterpolator = nullptr;    //!< Copied for every evaluation (not modified)
+        const ClockModel* clockModel = nullptr;     //!< Uptime <-> ITOW model (fitted from rovers if nullptr)
+        ProcessedRoundCache* processedRoundCache = nullptr;     //!< Filtered/transformed rounds shared between runs (rounds processed without storing if nullptr)
+        GeneratorTask* task = nullptr;                          //!< Progress reporting and cancellation (optional)
+    };
+
+    class ScoredTimeShift
+    {
+    public:
+        int timeShift = 0;          //!< Time shift (ms)
+        double score = 0;           //!< Voxel entropy of the cloud (smaller = sharper)
+        int numOfPoints = 0;        //!< Number of points successfully transformed
+        bool valid = false;         //!< Enough points could be transformed
+    };
+
+    /**
+     * @brief Runs the search
+     * @param params Parameters
+     * @param bestTimeShift Best time shift found (ms)
+     * @param scoreCurve All evaluated time shifts (ordered by time shift)
+     * @return true if at least one valid candidate was found
+     */
+    bool calibrate(const Params& params, int& bestTimeShift, QVector<ScoredTimeShift>& scoreCurve);
+
+    /**
+     * @brief Calculates voxel entropy of the points (sum of -p * ln(p) where p = fraction of points in a voxel)
+     * @param points Points
+     * @param cellSize Voxel size
+     * @return Entropy (0 if all points in one voxel, ln(points.count()) if every point in its own voxel)
+     */
+    static double calculateVoxelEntropy(const QVector<Eigen::Vector3d>& points, const double cellSize);
+
+private:
+    class RigPoint
+    {
+    public:
+        qint64 uptime = 0;              //!< Lidar uptime of the measurement
+        Eigen::Vector3d position;       //!< Laser hit in rig's coordinate system
+    };
+
+    QVector<RigPoint> collectPoints(const Params& params, const ClockModel& clockModel);
+    static ScoredTimeShift evaluate(const Params& params, const QVector<RigPoint>& points,
+                                    const ClockModel& clockModel, const int timeShift);
+
+signals:
+    void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
+    void warningMessage(const QString&);    //!< Signal for warning message (less severe than error)
+    void errorMessage(const QString&);      //!< Signal for error message
+};
+
+}; // namespace Lidar
+
+#endif // TIMESHIFTCALIBRATOR_H
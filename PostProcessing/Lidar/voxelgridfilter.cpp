@@ -0,0 +1,206 @@
+/*
+    voxelgridfilter.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file voxelgridfilter.cpp
+ * @brief Definition for a streaming voxel grid downsampling filter for point clouds.
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "voxelgridfilter.h"
+
+namespace Lidar
+{
+
+VoxelGridFilter::VoxelGridFilter(const Settings& settings)
+{
+    this->settings = settings;
+
+    if (this->settings.maxVoxelsInMemory < 1)
+    {
+        this->settings.maxVoxelsInMemory = 1;
+    }
+}
+
+quint64 VoxelGridFilter::packIndices(const qint64 x, const qint64 y, const qint64 z)
+{
+    // 21 bits per axis
+    return (static_cast<quint64>(x - minCellIndex) << 42) |
+            (static_cast<quint64>(y - minCellIndex) << 21) |
+            static_cast<quint64>(z - minCellIndex);
+}
+
+qint64 VoxelGridFilter::floorDiv(const qint64 value, const qint64 divisor)
+{
+    return (value >= 0) ? (value / divisor) : (-((-value + divisor - 1) / divisor));
+}
+
+void VoxelGridFilter::addPoint(const Point& point, QVector<Point>& outputPoints)
+{
+    numOfInputPoints++;
+
+    qint64 cellIndices[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        double cellIndex = floor(point.position(i) / settings.cellSize);
+
+        if ((!(cellIndex >= minCellIndex)) || (!(cellIndex <= maxCellIndex)))
+        {
+            // Outside of the grid (or NaN) -> Pass through as is
+            outputPoints.append(point);
+            numOfOutputPoints++;
+            return;
+        }
+
+        cellIndices[i] = static_cast<qint64>(cellIndex);
+    }
+
+    quint64 chunkKey = packIndices(floorDiv(cellIndices[0], chunkSizeInCells),
+                                   floorDiv(cellIndices[1], chunkSizeInCells),
+                                   floorDiv(cellIndices[2], chunkSizeInCells));
+
+    quint64 voxelKey = packIndices(cellIndices[0], cellIndices[1], cellIndices[2]);
+
+    Chunk& chunk = chunks[chunkKey];
+    chunk.lastUsed = sequenceCounter;
+
+    QHash<quint64, Voxel>::iterator voxelIter = chunk.voxels.find(voxelKey);
+
+    if (voxelIter == chunk.voxels.end())
+    {
+        Voxel newVoxel;
+        newVoxel.sequenceNumber = sequenceCounter;
+        newVoxel.representative = point;
+        newVoxel.normalSum = point.normal.normalized();
+        newVoxel.normalLengthSum = point.normal.norm();
+        newVoxel.count = 1;
+
+        chunk.voxels.insert(voxelKey, newVoxel);
+        voxelCount++;
+    }
+    else
+    {
+        Voxel& voxel = voxelIter.value();
+
+        switch (settings.mode)
+        {
+        case MODE_FIRST:
+            break;
+
+        case MODE_CENTROID:
+            voxel.representative.position += point.position;
+            break;
+
+        case MODE_BEST_QUALITY:
+            if ((point.quality > voxel.representative.quality) ||
+                    ((point.quality == voxel.representative.quality) && (point.distance < voxel.representative.distance)))
+            {
+                voxel.representative = point;
+            }
+            break;
+        }
+
+        voxel.normalSum += point.normal.normalized();
+        voxel.normalLengthSum += point.normal.norm();
+        voxel.count++;
+    }
+
+    sequenceCounter++;
+
+    while (voxelCount > settings.maxVoxelsInMemory)
+    {
+        flushLeastRecentlyUsedChunk(outputPoints);
+    }
+}
+
+VoxelGridFilter::Point VoxelGridFilter::getVoxelPoint(const Voxel& voxel) const
+{
+    Point point = voxel.representative;
+
+    if (settings.mode == MODE_CENTROID)
+    {
+        point.position = voxel.representative.position / voxel.count;
+    }
+
+    point.normal = voxel.normalSum.normalized() * (voxel.normalLengthSum / voxel.count);
+
+    return point;
+}
+
+void VoxelGridFilter::outputVoxels(QVector<const Voxel*>& voxels, QVector<Point>& outputPoints)
+{
+    std::sort(voxels.begin(), voxels.end(),
+              [](const Voxel* a, const Voxel* b) { return a->sequenceNumber < b->sequenceNumber; });
+
+    for (const Voxel* voxel : voxels)
+    {
+        outputPoints.append(getVoxelPoint(*voxel));
+    }
+
+    numOfOutputPoints += voxels.count();
+}
+
+void VoxelGridFilter::flushLeastRecentlyUsedChunk(QVector<Point>& outputPoints)
+{
+    QHash<quint64, Chunk>::iterator lruIter = chunks.begin();
+
+    for (QHash<quint64, Chunk>::iterator iter = chunks.begin(); iter != chunks.end(); iter++)
+    {
+        if (iter.value().lastUsed < lruIter.value().lastUsed)
+        {
+            lruIter = iter;
+        }
+    }
+
+    QVector<const Voxel*> voxels;
+    voxels.reserve(lruIter.value().voxels.count());
+
+    for (QHash<quint64, Voxel>::const_iterator iter = lruIter.value().voxels.constBegin(); iter != lruIter.value().voxels.constEnd(); iter++)
+    {
+        voxels.append(&iter.value());
+    }
+
+    outputVoxels(voxels, outputPoints);
+
+    voxelCount -= lruIter.value().voxels.count();
+    chunks.erase(lruIter);
+}
+
+void VoxelGridFilter::flush(QVector<Point>& outputPoints)
+{
+    QVector<const Voxel*> voxels;
+    voxels.reserve(voxelCount);
+
+    for (QHash<quint64, Chunk>::const_iterator chunkIter = chunks.constBegin(); chunkIter != chunks.constEnd(); chunkIter++)
+    {
+        for (QHash<quint64, Voxel>::const_iterator iter = chunkIter.value().voxels.constBegin(); iter != chunkIter.value().voxels.constEnd(); iter++)
+        {
+            voxels.append(&iter.value());
+        }
+    }
+
+    outputVoxels(voxels, outputPoints);
+
+    chunks.clear();
+    voxelCount = 0;
+}
+
+}; // namespace Lidar
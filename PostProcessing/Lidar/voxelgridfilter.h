@@ -0,0 +1,137 @@
+/*
+    voxelgridfilter.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file voxelgridfilter.h
+ * @brief Declaration for a streaming voxel grid downsampling filter for point clouds.
+ */
+
+#ifndef VOXELGRIDFILTER_H
+#define VOXELGRIDFILTER_H
+
+#include <QHash>
+#include <QVector>
+
+#include "Eigen/Geometry"
+
+namespace Lidar
+{
+
+/**
+ * @brief Streaming voxel grid downsampling filter
+ *
+ * Space is divided into cubic cells (voxels) and only one point per voxel is output.
+ * Voxels are stored in a sparse hash grid that is further divided into spatial chunks.
+ * When the number of voxels in memory exceeds Settings::maxVoxelsInMemory,
+ * least recently used chunks are output and removed from memory.
+ * Therefore memory usage stays bounded even with very large point clouds
+ * (at the cost of possible duplicates if the scanner returns to an already flushed chunk).
+ *
+ * Normals of the points in a voxel are always averaged (direction = normalized sum of normals,
+ * length = average of normal lengths to keep "normal lengths as quality" working).
+ */
+class VoxelGridFilter
+{
+public:
+    /**
+     * @brief Which point represents the voxel
+     */
+    enum Mode
+    {
+        MODE_FIRST = 0,         //!< First point added into the voxel
+        MODE_CENTROID,          //!< Average of all points in the voxel
+        MODE_BEST_QUALITY,      //!< Point with the highest quality (shortest distance if qualities are equal)
+    };
+
+    class Settings
+    {
+    public:
+        double cellSize = 0.005;            //!< Size of the voxel (m)
+        Mode mode = MODE_CENTROID;          //!< Point selection mode
+        int maxVoxelsInMemory = 1000000;    //!< Limit for number of voxels kept in memory
+    };
+
+    class Point
+    {
+    public:
+        Eigen::Vector3d position;
+        Eigen::Vector3d normal;
+        float quality = 0;      //!< Lidar's quality value (0...1)
+        double distance = 0;    //!< Measured distance (m)
+    };
+
+    VoxelGridFilter(const Settings& settings);  //!< Constructor
+
+    /**
+     * @brief Adds point into the grid
+     * @param point Point to add
+     * @param outputPoints Points of voxels removed from memory (if any) are appended here
+     */
+    void addPoint(const Point& point, QVector<Point>& outputPoints);
+
+    /**
+     * @brief Outputs all voxels still in memory and clears the grid
+     * @param outputPoints Points are appended here (in the order their voxels were created)
+     */
+    void flush(QVector<Point>& outputPoints);
+
+    qint64 getNumOfInputPoints(void) const { return numOfInputPoints; }     //!< Returns number of points added since construction
+    qint64 getNumOfOutputPoints(void) const { return numOfOutputPoints; }   //!< Returns number of points output since construction
+
+private:
+    class Voxel
+    {
+    public:
+        quint64 sequenceNumber = 0;         //!< Used to keep output order deterministic
+        Point representative;               //!< First/best point (or sum of positions in centroid mode)
+        Eigen::Vector3d normalSum = Eigen::Vector3d::Zero();
+        double normalLengthSum = 0;
+        int count = 0;
+    };
+
+    class Chunk
+    {
+    public:
+        QHash<quint64, Voxel> voxels;
+        quint64 lastUsed = 0;
+    };
+
+    static const int chunkSizeInCells = 64;     //!< Size of the spatial chunk (cells per side)
+    static const qint64 maxCellIndex = (1 << 20) - 1;
+    static const qint64 minCellIndex = -(1 << 20);
+
+    Settings settings;
+
+    QHash<quint64, Chunk> chunks;
+    int voxelCount = 0;
+    quint64 sequenceCounter = 0;
+
+    qint64 numOfInputPoints = 0;
+    qint64 numOfOutputPoints = 0;
+
+    static quint64 packIndices(const qint64 x, const qint64 y, const qint64 z);
+    static qint64 floorDiv(const qint64 value, const qint64 divisor);
+
+    Point getVoxelPoint(const Voxel& voxel) const;
+    void outputVoxels(QVector<const Voxel*>& voxels, QVector<Point>& outputPoints);
+    void flushLeastRecentlyUsedChunk(QVector<Point>& outputPoints);
+};
+
+}; // namespace Lidar
+
+#endif // VOXELGRIDFILTER_H
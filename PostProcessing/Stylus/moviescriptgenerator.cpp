@@ -23,9 +23,7 @@
 
 #include <QObject>
 #include <QString>
-#include <QFileDialog>
-#include <QMessageBox>
-#include <QPushButton>
+#include <QSaveFile>
 #include <QTextStream>
 
 #include "moviescriptgenerator.h"
@@ -44,30 +42,12 @@ void MovieScriptGenerator::GenerateMovieScript(const Params& params)
 
     Eigen::Matrix3d transform_NoTranslation = params.transform->linear();
 
-    QFile movieScriptFile;
+    // Script is written into a temporary file that replaces the existing one (if any) only when committed.
+    // Asking whether to overwrite is caller's responsibility.
+    QSaveFile movieScriptFile;
 
     movieScriptFile.setFileName(params.fileName);
 
-    if (movieScriptFile.exists())
-    {
-        QMessageBox msgBox;
-        msgBox.setText("File already exists.");
-        msgBox.setInformativeText("How to proceed?");
-
-        QPushButton *overwriteButton = msgBox.addButton(tr("Overwrite"), QMessageBox::ActionRole);
-        QPushButton *cancelButton = msgBox.addButton(QMessageBox::Cancel);
-
-        msgBox.setDefaultButton(cancelButton);
-
-        msgBox.exec();
-
-        if (msgBox.clickedButton() != overwriteButton)
-        {
-            emit infoMessage("Movie script not created.");
-            return;
-        }
-    }
-
     if (!movieScriptFile.open(QIODevice::WriteOnly))
     {
         emit errorMessage("Can't open movie script file.");
@@ -80,478 +60,119 @@ void MovieScriptGenerator::GenerateMovieScript(const Params& params)
 
     emit infoMessage("Processing line sets...");
 
-//        QMap<qint64, Tag_New>::const_iterator currentTagIterator;
+    for (int i = 0; i < 2; i++)
+    {
+        roverTracks[i].build(params.rovers[i]);
+    }
 
-    bool objectActive = false;
+    TagSegmentIndex tagSegmentIndex_Generated;
+
+    if (!params.tagSegmentIndex)
+    {
+        tagSegmentIndex_Generated.build(*params.tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+    }
+
+    const TagSegmentIndex& tagSegmentIndex = params.tagSegmentIndex ? *params.tagSegmentIndex : tagSegmentIndex_Generated;
+
+    // Segments' lines are generated in parallel batches ahead of the item handling below.
+    // Distance may carry over from previous segments -> segments depending on it are regenerated if needed.
+    SegmentPrefetcher<SegmentResult> segmentPrefetcher(tagSegmentIndex.getSegments(),
+                [this, &params](const TagSegmentIndex::Segment& segment) { return generateLineSet(params, segment, params.initialStylusTipDistanceFromRoverA); });
 
     qint64 beginningUptime = -1;
     int pointsWritten = 0;
 
-    bool ignoreBeginningAndEndingTags = false;
-
     QString objectName = "N/A";
 
-    qint64 uptime = -1;
     PostProcessingForm::Tag beginningTag;
 
-    while (params.tags->upperBound(uptime) != params.tags->end())
+    for (const TagSegmentIndex::Item& item : tagSegmentIndex.getItems())
     {
-        uptime = params.tags->upperBound(uptime).key();
-
-        QList<PostProcessingForm::Tag> tagItems = params.tags->values(uptime);
-
-        // Since "The items that share the same key are available from most recently to least recently inserted."
-        // (taken from QMultiMap's doc), iterate in "reverse order" here
-
-        for (int i = tagItems.size() - 1; i >= 0; i--)
+        if (GeneratorTask::isCancelRequested(params.task))
         {
-            const PostProcessingForm::Tag& currentTag = tagItems[i];
+            // movieScriptFile not committed -> discarded
+            emit warningMessage("Generating movie script cancelled. File \"" + params.fileName + "\" not written.");
+            return;
+        }
 
-            if (!(currentTag.ident.compare(params.tagIdent_BeginNewObject)))
-            {
-                objectActive = false;
+        const qint64 uptime = item.uptime;
+        const PostProcessingForm::Tag& currentTag = item.tag;
 
-                if (currentTag.text.length() == 0)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": New object without a name. Ending previous object, but not beginning new nor creating a new line. Ignoring subsequent beginning and ending tags.");
+        if (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT)
+        {
+            emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
+                       QString::number(currentTag.sourceFileLine)+
+                       ", uptime " + QString::number(uptime) +
+                       ", iTOW " + QString::number(currentTag.iTOW) +
+                       ": New object without a name. Ending previous object, but not beginning new nor creating a new line. Ignoring subsequent beginning and ending tags.");
 
-                    ignoreBeginningAndEndingTags = true;
-                    objectName = "N/A";
+            objectName = "N/A";
+        }
+        else if (item.type == TagSegmentIndex::ITEM_NEW_OBJECT)
+        {
+            emit infoMessage("Object \"" + currentTag.text + "\"...");
 
-                    continue;
-                }
+            objectName = currentTag.text;
+            beginningUptime = -1;
+            pointsWritten = 0;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_INVALID_TAG)
+        {
+            emit warningMessage(TagSegmentIndex::getDiagnosticText(item));
+        }
+        else if (item.type == TagSegmentIndex::ITEM_BEGINNING)
+        {
+            beginningUptime = uptime;
+            beginningTag = currentTag;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_SEGMENT)
+        {
+            const PostProcessingForm::Tag& endingTag = currentTag;
+            const TagSegmentIndex::Segment& segment = tagSegmentIndex.getSegments()[item.segmentIndex];
 
-                emit infoMessage("Object \"" + currentTag.text + "\"...");
+            SegmentResult segmentResult = segmentPrefetcher.getResult(item.segmentIndex);
 
-                objectActive = true;
-                objectName = currentTag.text;
-                ignoreBeginningAndEndingTags = false;
-                beginningUptime = -1;
-                pointsWritten = 0;
-            }
-            else if ((!(currentTag.ident.compare(params.tagIdent_BeginPoints))) && (!ignoreBeginningAndEndingTags))
+            if (segmentResult.initialDistanceUsed &&
+                    (segmentResult.initialStylusTipDistanceFromRoverA != stylusTipDistanceFromRoverA))
             {
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Beginning tag outside object. Skipped.");
-                    continue;
-                }
-
-                if (beginningUptime != -1)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Duplicate beginning tag. Skipped.");
-                    continue;
-                }
-
-                beginningUptime = uptime;
-                beginningTag = currentTag;
+                // Prefetched with a different distance carried over from previous segments
+                segmentResult = generateLineSet(params, segment, stylusTipDistanceFromRoverA);
             }
-            else if ((!(currentTag.ident.compare(params.tagIdent_EndPoints)))  && (!ignoreBeginningAndEndingTags))
-            {
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag outside object. Skipped.");
-                    continue;
-                }
-
-                if (beginningUptime == -1)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag without beginning tag. Skipped.");
-                    continue;
-                }
-
-                const PostProcessingForm::Tag& endingTag = currentTag;
-//                const Tag_New beginningTag = tags_New[beginningUptime];
-
-                if (endingTag.sourceFile != beginningTag.sourceFile)
-                {
-                    emit warningMessage("Starting and ending tags belong to different files. Starting tag file \"" +
-                               beginningTag.sourceFile + "\", line " +
-                               QString::number(beginningTag.sourceFileLine) + " ending tag file: " +
-                               endingTag.sourceFile + "\", line " +
-                               QString::number(endingTag.sourceFileLine) + ". Ending tag ignored.");
-                    continue;
-                }
-
-                bool constDistancesOnly = true;
-
-                QMap<qint64, PostProcessingForm::DistanceItem>::const_iterator distIter = params.distances->upperBound(beginningUptime);
-
-                while ((distIter != params.distances->end()) && (distIter.key() < uptime))
-                {
-                    if (distIter.value().type == PostProcessingForm::DistanceItem::Type::MEASURED)
-                    {
-                        constDistancesOnly = false;
-                        break;
-                    }
 
-                    distIter++;
-                }
-
-                int pointsBetweenTags = 0;
-
-                if (constDistancesOnly)
-                {
-                    distIter = params.distances->upperBound(beginningUptime);
-
-                    if (distIter != params.distances->end())
-                    {
-                        if ((distIter == params.distances->begin()) ||
-                                ((--distIter).value().type != PostProcessingForm::DistanceItem::Type::CONSTANT))
-                        {
-                            emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                                       QString::number(currentTag.sourceFileLine)+
-                                       ", uptime " + QString::number(uptime) +
-                                       ", iTOW " + QString::number(currentTag.iTOW) +
-                                       ": Points between tags having only constant distances without preceeding constant distance. Skipped.");
-                            continue;
-                        }
-
-                        stylusTipDistanceFromRoverA = distIter.value().distance;
-                    }
-
-                    QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverA = params.rovers[0].relposnedMessages.upperBound(params.rovers[0].relposnedMessages.upperBound(beginningUptime).value().iTOW);
-                    QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverB = params.rovers[1].relposnedMessages.upperBound(params.rovers[1].relposnedMessages.upperBound(beginningUptime).value().iTOW);
-
-                    QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverA_EndTag = params.rovers[0].relposnedMessages.upperBound(currentTag.iTOW);
-                    QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverB_EndTag = params.rovers[1].relposnedMessages.upperBound(currentTag.iTOW);
+            if (GeneratorTask::isCancelRequested(params.task))
+            {
+                emit warningMessage("Generating movie script cancelled. File \"" + params.fileName + "\" not written.");
+                return;
+            }
 
-                    while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
-                        (relposIterator_RoverB != relposIterator_RoverB_EndTag))
-                    {
-                        while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
-                               (relposIterator_RoverB != relposIterator_RoverB_EndTag) &&
-                               (relposIterator_RoverA.key() < relposIterator_RoverB.key()))
-                        {
-                            relposIterator_RoverA++;
-                        }
-
-                        while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
-                               (relposIterator_RoverB != relposIterator_RoverB_EndTag) &&
-                               (relposIterator_RoverB.key() < relposIterator_RoverA.key()))
-                        {
-                            relposIterator_RoverB++;
-                        }
-
-                        if ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
-                            (relposIterator_RoverB != relposIterator_RoverB_EndTag))
-                        {
-                            if ((relposIterator_RoverA.key() >= params.iTOWRange_Lines_Min) &&
-                            (relposIterator_RoverA.key() <= params.iTOWRange_Lines_Max))
-                            {
-                                Eigen::Vector3d roverAPosNED(
-                                        relposIterator_RoverA.value().relPosN,
-                                        relposIterator_RoverA.value().relPosE,
-                                        relposIterator_RoverA.value().relPosD);
-
-                                Eigen::Vector3d roverBPosNED(
-                                        relposIterator_RoverB.value().relPosN,
-                                        relposIterator_RoverB.value().relPosE,
-                                        relposIterator_RoverB.value().relPosD);
-
-                                Eigen::Vector3d roverBToAVecNormalized = (roverAPosNED - roverBPosNED).normalized();
-
-                                Eigen::Vector3d stylusTipPosNED = roverAPosNED + roverBToAVecNormalized * stylusTipDistanceFromRoverA;
-                                Eigen::Vector3d stylusTipPosXYZ = *params.transform * stylusTipPosNED;
-
-                                Eigen::Vector3d stylusTipAccNED(
-                                            relposIterator_RoverA.value().accN,
-                                            relposIterator_RoverA.value().accE,
-                                            relposIterator_RoverA.value().accD);
-
-                                // Use accuracies of rover A (used for stylus tip accuracy)
-                                // Could calculate some kind of "worst case" scenario using both rovers,
-                                // but probably errors are mostly common to both of them.
-                                Eigen::Vector3d stylusTipAccXYZ = transform_NoTranslation * stylusTipAccNED;
-
-                                QString lineOut;
-
-                                if (pointsBetweenTags == 0)
-                                {
-                                    lineOut = "LStart";
-
-                                }
-                                else
-                                {
-                                    lineOut = "LCont";
-                                }
-
-                                lineOut +=
-                                        "\t" + QString::number(relposIterator_RoverA.key()) +
-                                        "\t" + QString::number(stylusTipPosXYZ(0), 'f', 4) +
-                                        "\t" + QString::number(stylusTipPosXYZ(1), 'f', 4) +
-                                        "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4) +
-                                        "\t" + QString::number(stylusTipAccXYZ(0), 'f', 4) +
-                                        "\t" + QString::number(stylusTipAccXYZ(1), 'f', 4) +
-                                        "\t" + QString::number(stylusTipAccXYZ(2), 'f', 4) +
-                                        "\t" + objectName;
-
-                                textStream << (lineOut + "\n");
-
-                                pointsWritten++;
-
-                                pointsBetweenTags++;
-                            }
-                            relposIterator_RoverA++;
-                            relposIterator_RoverB++;
-                        }
-                    }
-                } // if (constDistancesOnly)
-                else
-                {
-                    // Distances found, sync point creation to them.
-                    // Rover coordinates are interpolated according to distance timestamps.
+            for (const QString& warning : segmentResult.warnings)
+            {
+                emit warningMessage(warning);
+            }
 
-                    distIter = params.distances->upperBound(beginningUptime);
+            stylusTipDistanceFromRoverA = segmentResult.stylusTipDistanceFromRoverA;
 
-                    while ((distIter != params.distances->end()) && (distIter.key() < uptime))
-                    {
-                        if (distIter.value().type == PostProcessingForm::DistanceItem::Type::CONSTANT)
-                        {
-                            emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                       QString::number(distIter.value().sourceFileLine)+
-                                       ", uptime " + QString::number(distIter.key()) +
-                                       ": Constant distance between measured ones. Skipped.");
-                            distIter++;
-                            continue;
-                        }
-                        else if (distIter.value().type == PostProcessingForm::DistanceItem::Type::MEASURED)
-                        {
-                            // Try to find next and previous rover coordinates
-                            // for this uptime
-
-                            qint64 distanceUptime = distIter.key();
-                            // TODO: Add/subtract fine tune sync value here if needed
-
-                            QMap<qint64, PostProcessingForm::RoverSyncItem>::const_iterator roverAUptimeIter = params.rovers[0].roverSyncData.lowerBound(distanceUptime);
-                            UBXMessage_RELPOSNED interpolated_RoverA;
-
-                            if (roverAUptimeIter != params.rovers[0].roverSyncData.end())
-                            {
-                                const PostProcessingForm::RoverSyncItem upperSyncItem = roverAUptimeIter.value();
-                                PostProcessingForm::RoverSyncItem lowerSyncItem;
-                                if (roverAUptimeIter != params.rovers[0].roverSyncData.begin())
-                                {
-                                    lowerSyncItem = (--roverAUptimeIter).value();
-                                }
-                                else
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover A sync data (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                if (params.rovers[0].relposnedMessages.find(upperSyncItem.iTOW) == params.rovers[0].relposnedMessages.end())
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover A iTOW (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                if (params.rovers[0].relposnedMessages.find(lowerSyncItem.iTOW) == params.rovers[0].relposnedMessages.end())
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover A iTOW (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                qint64 timeDiff = distanceUptime - roverAUptimeIter.key();
-
-                                interpolated_RoverA = UBXMessage_RELPOSNED::interpolateCoordinates(params.rovers[0].relposnedMessages.find(lowerSyncItem.iTOW).value(),
-                                                        params.rovers[0].relposnedMessages.find(upperSyncItem.iTOW).value(), lowerSyncItem.iTOW + timeDiff);
-                            }
-                            else
-                            {
-                                emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                           QString::number(distIter.value().sourceFileLine)+
-                                           ", uptime " + QString::number(distIter.key()) +
-                                           ": Can not find corresponding rover A sync data (upper limit). Skipped.");
-                                distIter++;
-                                continue;
-                            }
-
-                            QMap<qint64, PostProcessingForm::RoverSyncItem>::const_iterator roverBUptimeIter = params.rovers[1].roverSyncData.lowerBound(distanceUptime);
-                            UBXMessage_RELPOSNED interpolated_RoverB;
-
-                            if (roverBUptimeIter != params.rovers[1].roverSyncData.end())
-                            {
-                                const PostProcessingForm::RoverSyncItem upperSyncItem = roverBUptimeIter.value();
-                                PostProcessingForm::RoverSyncItem lowerSyncItem;
-                                if (roverBUptimeIter != params.rovers[1].roverSyncData.begin())
-                                {
-                                    lowerSyncItem = (--roverBUptimeIter).value();
-                                }
-                                else
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover B sync data (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                if (params.rovers[1].relposnedMessages.find(upperSyncItem.iTOW) == params.rovers[1].relposnedMessages.end())
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover B iTOW (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                if (params.rovers[1].relposnedMessages.find(lowerSyncItem.iTOW) == params.rovers[1].relposnedMessages.end())
-                                {
-                                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                               QString::number(distIter.value().sourceFileLine)+
-                                               ", uptime " + QString::number(distIter.key()) +
-                                               ": Can not find corresponding rover B iTOW (higher limit). Skipped.");
-                                    distIter++;
-                                    continue;
-                                }
-
-                                qint64 timeDiff = distanceUptime - roverAUptimeIter.key();
-
-                                interpolated_RoverB = UBXMessage_RELPOSNED::interpolateCoordinates(params.rovers[1].relposnedMessages.find(lowerSyncItem.iTOW).value(),
-                                                        params.rovers[1].relposnedMessages.find(upperSyncItem.iTOW).value(), lowerSyncItem.iTOW + timeDiff);
-                            }
-                            else
-                            {
-                                emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                           QString::number(distIter.value().sourceFileLine)+
-                                           ", uptime " + QString::number(distIter.key()) +
-                                           ": Can not find corresponding rover B sync data (upper limit). Skipped.");
-                                distIter++;
-                                continue;
-                            }
-
-                            stylusTipDistanceFromRoverA = distIter.value().distance;
-
-                            // TODO: Refine this quick hack or at least make the distance configurable!
-                            // Skip distances that are too far away
-                            // (measurement module seems to emit "outliers" now and then)
-                            if (stylusTipDistanceFromRoverA > 2)
-                            {
-                                emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                           QString::number(distIter.value().sourceFileLine)+
-                                           ", uptime " + QString::number(distIter.key()) +
-                                           ": Distance between RoverA and tip too high (" +
-                                           QString::number(stylusTipDistanceFromRoverA) +
-                                           " m). Skipped.");
-                                distIter++;
-                                continue;
-                            }
-
-                            Eigen::Vector3d roverAPosNED(
-                                    interpolated_RoverA.relPosN,
-                                    interpolated_RoverA.relPosE,
-                                    interpolated_RoverA.relPosD);
-
-                            Eigen::Vector3d roverBPosNED(
-                                    interpolated_RoverB.relPosN,
-                                    interpolated_RoverB.relPosE,
-                                    interpolated_RoverB.relPosD);
-
-                            Eigen::Vector3d roverBToAVecNormalized = (roverAPosNED - roverBPosNED).normalized();
-
-                            Eigen::Vector3d stylusTipPosNED = roverAPosNED + roverBToAVecNormalized * stylusTipDistanceFromRoverA;
-                            Eigen::Vector3d stylusTipPosXYZ = *params.transform * stylusTipPosNED;
-
-                            Eigen::Vector3d stylusTipAccNED(
-                                        interpolated_RoverA.accN,
-                                        interpolated_RoverA.accE,
-                                        interpolated_RoverA.accD);
-
-                            // Use accuracies of rover A (used for stylus tip accuracy)
-                            // Could calculate some kind of "worst case" scenario using both rovers,
-                            // but probably errors are mostly common to both of them.
-                            Eigen::Vector3d stylusTipAccXYZ = transform_NoTranslation * stylusTipAccNED;
-
-                            QString lineOut;
-
-                            if (pointsBetweenTags == 0)
-                            {
-                                lineOut = "LStart";
-                            }
-                            else
-                            {
-                                lineOut = "LCont";
-                            }
-
-                            lineOut +=
-                                    "\t" + QString::number(interpolated_RoverA.iTOW) +
-                                    "\t" + QString::number(stylusTipPosXYZ(0), 'f', 4) +
-                                    "\t" + QString::number(stylusTipPosXYZ(1), 'f', 4) +
-                                    "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4) +
-                                    "\t" + QString::number(stylusTipAccXYZ(0), 'f', 4) +
-                                    "\t" + QString::number(stylusTipAccXYZ(1), 'f', 4) +
-                                    "\t" + QString::number(stylusTipAccXYZ(2), 'f', 4) +
-                                    "\t" + objectName;
-
-                            textStream << (lineOut + "\n");
-
-                            pointsWritten++;
-                            pointsBetweenTags++;
-                        }
-                        else
-                        {
-                            emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                       QString::number(distIter.value().sourceFileLine)+
-                                       ", uptime " + QString::number(distIter.key()) +
-                                       ": Unknown distance type between measured ones. Skipped.");
-                            distIter++;
-                            continue;
-                        }
-
-                        distIter++;
-                    }
-                }
+            if (segmentResult.skipped)
+            {
+                continue;
+            }
 
+            textStream << segmentResult.text;
+            pointsWritten += segmentResult.numOfPoints;
 
-                if (pointsBetweenTags == 0)
-                {
-                    emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
-                               QString::number(beginningTag.sourceFileLine) +
-                               ", iTOW " + QString::number(params.rovers[0].roverSyncData.upperBound(beginningUptime).value().iTOW) + ", ending tag line " +
-                               QString::number(endingTag.sourceFileLine) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ", File \"" + endingTag.sourceFile + "\""
-                               " No points between tags.");
-                }
-
-                beginningTag.iTOW = -1;
-                beginningUptime = -1;
+            if (segmentResult.numOfPoints == 0)
+            {
+                emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
+                           QString::number(beginningTag.sourceFileLine) +
+                           ", iTOW " + QString::number(params.rovers[0].roverSyncData.upperBound(beginningUptime).value().iTOW) + ", ending tag line " +
+                           QString::number(endingTag.sourceFileLine) +
+                           ", iTOW " + QString::number(currentTag.iTOW) +
+                           ", File \"" + endingTag.sourceFile + "\""
+                           " No points between tags.");
             }
+
+            beginningTag.iTOW = -1;
+            beginningUptime = -1;
         }
     }
 
@@ -596,10 +217,22 @@ void MovieScriptGenerator::GenerateMovieScript(const Params& params)
     UBXMessage_RELPOSNED::ITOW lastRoverANagITOW = -1;
     UBXMessage_RELPOSNED::ITOW lastRoverBNagITOW = -1;
 
+    UBXMessage_RELPOSNED::ITOW progress_LastITOW = qBound(startingITOW,
+                                                          qMin(params.rovers[0].relposnedMessages.lastKey(), params.rovers[1].relposnedMessages.lastKey()),
+                                                          qMax(startingITOW, iTOWRange_Script_Max));
+
     while ((iTOW <= iTOWRange_Script_Max) &&
            (params.rovers[0].relposnedMessages.upperBound(iTOW) != params.rovers[0].relposnedMessages.end()) &&
            (params.rovers[1].relposnedMessages.upperBound(iTOW) != params.rovers[1].relposnedMessages.end()))
     {
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            emit warningMessage("Generating movie script cancelled. File \"" + params.fileName + "\" not written.");
+            return;
+        }
+
+        GeneratorTask::setProgress(params.task, qMin(iTOW, progress_LastITOW) - startingITOW, progress_LastITOW - startingITOW);
+
         QString frameType;
 
         UBXMessage_RELPOSNED relposned_RoverA;
@@ -870,7 +503,332 @@ void MovieScriptGenerator::GenerateMovieScript(const Params& params)
         frameCounter++;
         iTOW = (frameCounter * 1000) / params.fps + startingITOW;
     }
+
+    textStream.flush();
+
+    if (!movieScriptFile.commit())
+    {
+        emit errorMessage("Writing movie script file failed: " + movieScriptFile.errorString());
+        return;
+    }
+
     emit infoMessage("Movie script generated.");
 }
 
+MovieScriptGenerator::SegmentResult MovieScriptGenerator::generateLineSet(const Params& params, const TagSegmentIndex::Segment& segment,
+                                                                          const double initialStylusTipDistanceFromRoverA) const
+{
+    SegmentResult result;
+
+    result.initialStylusTipDistanceFromRoverA = initialStylusTipDistanceFromRoverA;
+    result.stylusTipDistanceFromRoverA = initialStylusTipDistanceFromRoverA;
+
+    if (GeneratorTask::isCancelRequested(params.task))
+    {
+        // Result is not used
+        return result;
+    }
+
+    const PostProcessingForm::Tag& endingTag = segment.endingTag;
+    const qint64 beginningUptime = segment.beginningUptime;
+    const qint64 endingUptime = segment.endingUptime;
+    const QString& objectName = segment.objectName;
+
+    double stylusTipDistanceFromRoverA = initialStylusTipDistanceFromRoverA;
+
+    Eigen::Matrix3d transform_NoTranslation = params.transform->linear();
+
+    bool constDistancesOnly = true;
+
+    QMap<qint64, PostProcessingForm::DistanceItem>::const_iterator distIter = params.distances->upperBound(beginningUptime);
+
+    while ((distIter != params.distances->end()) && (distIter.key() < endingUptime))
+    {
+        if (distIter.value().type == PostProcessingForm::DistanceItem::Type::MEASURED)
+        {
+            constDistancesOnly = false;
+            break;
+        }
+
+        distIter++;
+    }
+
+    if (constDistancesOnly)
+    {
+        distIter = params.distances->upperBound(beginningUptime);
+
+        if (distIter != params.distances->end())
+        {
+            if ((distIter == params.distances->begin()) ||
+                    ((--distIter).value().type != PostProcessingForm::DistanceItem::Type::CONSTANT))
+            {
+                result.warnings.append("File \"" + endingTag.sourceFile + "\", line " +
+                           QString::number(endingTag.sourceFileLine)+
+                           ", uptime " + QString::number(endingUptime) +
+                           ", iTOW " + QString::number(endingTag.iTOW) +
+                           ": Points between tags having only constant distances without preceeding constant distance. Skipped.");
+                result.skipped = true;
+                return result;
+            }
+
+            stylusTipDistanceFromRoverA = distIter.value().distance;
+            result.initialDistanceUsed = false;
+        }
+
+        // Segments may be processed speculatively -> don't dereference end-iterators
+        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverA = params.rovers[0].relposnedMessages.upperBound(beginningUptime);
+        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverB = params.rovers[1].relposnedMessages.upperBound(beginningUptime);
+
+        if (relposIterator_RoverA != params.rovers[0].relposnedMessages.end())
+        {
+            relposIterator_RoverA = params.rovers[0].relposnedMessages.upperBound(relposIterator_RoverA.value().iTOW);
+        }
+
+        if (relposIterator_RoverB != params.rovers[1].relposnedMessages.end())
+        {
+            relposIterator_RoverB = params.rovers[1].relposnedMessages.upperBound(relposIterator_RoverB.value().iTOW);
+        }
+
+        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverA_EndTag = params.rovers[0].relposnedMessages.upperBound(endingTag.iTOW);
+        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterator_RoverB_EndTag = params.rovers[1].relposnedMessages.upperBound(endingTag.iTOW);
+
+        while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
+            (relposIterator_RoverB != relposIterator_RoverB_EndTag))
+        {
+            while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
+                   (relposIterator_RoverB != relposIterator_RoverB_EndTag) &&
+                   (relposIterator_RoverA.key() < relposIterator_RoverB.key()))
+            {
+                relposIterator_RoverA++;
+            }
+
+            while ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
+                   (relposIterator_RoverB != relposIterator_RoverB_EndTag) &&
+                   (relposIterator_RoverB.key() < relposIterator_RoverA.key()))
+            {
+                relposIterator_RoverB++;
+            }
+
+            if ((relposIterator_RoverA != relposIterator_RoverA_EndTag) &&
+                (relposIterator_RoverB != relposIterator_RoverB_EndTag))
+            {
+                if ((relposIterator_RoverA.key() >= params.iTOWRange_Lines_Min) &&
+                (relposIterator_RoverA.key() <= params.iTOWRange_Lines_Max))
+                {
+                    Eigen::Vector3d roverAPosNED(
+                            relposIterator_RoverA.value().relPosN,
+                            relposIterator_RoverA.value().relPosE,
+                            relposIterator_RoverA.value().relPosD);
+
+                    Eigen::Vector3d roverBPosNED(
+                            relposIterator_RoverB.value().relPosN,
+                            relposIterator_RoverB.value().relPosE,
+                            relposIterator_RoverB.value().relPosD);
+
+                    Eigen::Vector3d roverBToAVecNormalized = (roverAPosNED - roverBPosNED).normalized();
+
+                    Eigen::Vector3d stylusTipPosNED = roverAPosNED + roverBToAVecNormalized * stylusTipDistanceFromRoverA;
+                    Eigen::Vector3d stylusTipPosXYZ = *params.transform * stylusTipPosNED;
+
+                    Eigen::Vector3d stylusTipAccNED(
+                                relposIterator_RoverA.value().accN,
+                                relposIterator_RoverA.value().accE,
+                                relposIterator_RoverA.value().accD);
+
+                    // Use accuracies of rover A (used for stylus tip accuracy)
+                    // Could calculate some kind of "worst case" scenario using both rovers,
+                    // but probably errors are mostly common to both of them.
+                    Eigen::Vector3d stylusTipAccXYZ = transform_NoTranslation * stylusTipAccNED;
+
+                    QString lineOut;
+
+                    if (result.numOfPoints == 0)
+                    {
+                        lineOut = "LStart";
+
+                    }
+                    else
+                    {
+                        lineOut = "LCont";
+                    }
+
+                    lineOut +=
+                            "\t" + QString::number(relposIterator_RoverA.key()) +
+                            "\t" + QString::number(stylusTipPosXYZ(0), 'f', 4) +
+                            "\t" + QString::number(stylusTipPosXYZ(1), 'f', 4) +
+                            "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4) +
+                            "\t" + QString::number(stylusTipAccXYZ(0), 'f', 4) +
+                            "\t" + QString::number(stylusTipAccXYZ(1), 'f', 4) +
+                            "\t" + QString::number(stylusTipAccXYZ(2), 'f', 4) +
+                            "\t" + objectName;
+
+                    result.text += lineOut + "\n";
+
+                    result.numOfPoints++;
+                }
+                relposIterator_RoverA++;
+                relposIterator_RoverB++;
+            }
+        }
+    } // if (constDistancesOnly)
+    else
+    {
+        // Distances found, sync point creation to them.
+        // Rover coordinates are interpolated according to distance timestamps.
+
+        distIter = params.distances->upperBound(beginningUptime);
+
+        // Distances are sorted by uptime -> rovers' positions are found by walking their tracks forward (merge join)
+        int trackIndexes[2] = { -1, -1 };
+        const char* roverNames[2] = { "A", "B" };
+
+        while ((distIter != params.distances->end()) && (distIter.key() < endingUptime))
+        {
+            if (distIter.value().type == PostProcessingForm::DistanceItem::Type::CONSTANT)
+            {
+                result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
+                           QString::number(distIter.value().sourceFileLine)+
+                           ", uptime " + QString::number(distIter.key()) +
+                           ": Constant distance between measured ones. Skipped.");
+                distIter++;
+                continue;
+            }
+            else if (distIter.value().type == PostProcessingForm::DistanceItem::Type::MEASURED)
+            {
+                // Try to find next and previous rover coordinates
+                // for this uptime
+
+                qint64 distanceUptime = distIter.key();
+                // TODO: Add/subtract fine tune sync value here if needed
+
+                RoverPositionTrack::Position interpolated_Rovers[2];
+                qint64 roverALowerUptime = -1;
+                bool fail = false;
+
+                for (int i = 0; i < 2; i++)
+                {
+                    if (trackIndexes[i] < 0)
+                    {
+                        trackIndexes[i] = roverTracks[i].lowerBound(distanceUptime);
+                    }
+                    else
+                    {
+                        roverTracks[i].advanceToLowerBound(trackIndexes[i], distanceUptime);
+                    }
+
+                    // Time difference of both rovers is calculated from rover A's sync data
+                    RoverPositionTrack::LookupResult lookupResult =
+                            roverTracks[i].interpolate(trackIndexes[i], distanceUptime,
+                                                       (i == 0) ? -1 : roverALowerUptime,
+                                                       interpolated_Rovers[i],
+                                                       (i == 0) ? &roverALowerUptime : nullptr);
+
+                    if (lookupResult != RoverPositionTrack::LOOKUP_OK)
+                    {
+                        result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
+                                   QString::number(distIter.value().sourceFileLine)+
+                                   ", uptime " + QString::number(distIter.key()) +
+                                   ": Can not find corresponding rover " + roverNames[i] + " " +
+                                   RoverPositionTrack::getLookupResultText(lookupResult) + ". Skipped.");
+                        fail = true;
+                        break;
+                    }
+                }
+
+                if (fail)
+                {
+                    distIter++;
+                    continue;
+                }
+
+                const RoverPositionTrack::Position& interpolated_RoverA = interpolated_Rovers[0];
+                const RoverPositionTrack::Position& interpolated_RoverB = interpolated_Rovers[1];
+
+                stylusTipDistanceFromRoverA = distIter.value().distance;
+                result.initialDistanceUsed = false;
+
+                // TODO: Refine this quick hack or at least make the distance configurable!
+                // Skip distances that are too far away
+                // (measurement module seems to emit "outliers" now and then)
+                if (stylusTipDistanceFromRoverA > 2)
+                {
+                    result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
+                               QString::number(distIter.value().sourceFileLine)+
+                               ", uptime " + QString::number(distIter.key()) +
+                               ": Distance between RoverA and tip too high (" +
+                               QString::number(stylusTipDistanceFromRoverA) +
+                               " m). Skipped.");
+                    distIter++;
+                    continue;
+                }
+
+                Eigen::Vector3d roverAPosNED(
+                        interpolated_RoverA.relPosN,
+                        interpolated_RoverA.relPosE,
+                        interpolated_RoverA.relPosD);
+
+                Eigen::Vector3d roverBPosNED(
+                        interpolated_RoverB.relPosN,
+                        interpolated_RoverB.relPosE,
+                        interpolated_RoverB.relPosD);
+
+                Eigen::Vector3d roverBToAVecNormalized = (roverAPosNED - roverBPosNED).normalized();
+
+                Eigen::Vector3d stylusTipPosNED = roverAPosNED + roverBToAVecNormalized * stylusTipDistanceFromRoverA;
+                Eigen::Vector3d stylusTipPosXYZ = *params.transform * stylusTipPosNED;
+
+                Eigen::Vector3d stylusTipAccNED(
+                            interpolated_RoverA.accN,
+                            interpolated_RoverA.accE,
+                            interpolated_RoverA.accD);
+
+                // Use accuracies of rover A (used for stylus tip accuracy)
+                // Could calculate some kind of "worst case" scenario using both rovers,
+                // but probably errors are mostly common to both of them.
+                Eigen::Vector3d stylusTipAccXYZ = transform_NoTranslation * stylusTipAccNED;
+
+                QString lineOut;
+
+                if (result.numOfPoints == 0)
+                {
+                    lineOut = "LStart";
+                }
+                else
+                {
+                    lineOut = "LCont";
+                }
+
+                lineOut +=
+                        "\t" + QString::number(interpolated_RoverA.iTOW) +
+                        "\t" + QString::number(stylusTipPosXYZ(0), 'f', 4) +
+                        "\t" + QString::number(stylusTipPosXYZ(1), 'f', 4) +
+                        "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4) +
+                        "\t" + QString::number(stylusTipAccXYZ(0), 'f', 4) +
+                        "\t" + QString::number(stylusTipAccXYZ(1), 'f', 4) +
+                        "\t" + QString::number(stylusTipAccXYZ(2), 'f', 4) +
+                        "\t" + objectName;
+
+                result.text += lineOut + "\n";
+
+                result.numOfPoints++;
+            }
+            else
+            {
+                result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
+                           QString::number(distIter.value().sourceFileLine)+
+                           ", uptime " + QString::number(distIter.key()) +
+                           ": Unknown distance type between measured ones. Skipped.");
+                distIter++;
+                continue;
+            }
+
+            distIter++;
+        }
+    }
+
+    result.stylusTipDistanceFromRoverA = stylusTipDistanceFromRoverA;
+
+    return result;
+}
+
 }; // namespace Stylus
@@ -25,6 +25,9 @@
 #define MOVIESCRIPTGENERATOR_H
 
 #include "../postprocessingform.h"
+#include "../generatortask.h"
+#include "../tagsegmentindex.h"
+#include "roverpositiontrack.h"
 
 namespace Stylus
 {
@@ -58,13 +61,35 @@ public:
         double lookAtDShift = 0;
 
         const QMultiMap<qint64, PostProcessingForm::Tag>* tags = nullptr;
+        const TagSegmentIndex* tagSegmentIndex = nullptr;  //!< Objects/segments of tags (built from tags if nullptr)
         const QMap<qint64, PostProcessingForm::DistanceItem>* distances = nullptr;
         const PostProcessingForm::Rover* rovers = nullptr;
+        GeneratorTask* task = nullptr;      //!< Progress reporting and cancellation (optional)
     };
 
     void GenerateMovieScript(const Params& params);
 
 private:
+    /**
+     * @brief Lines of one segment (between beginning and ending tags)
+     */
+    class SegmentResult
+    {
+    public:
+        bool skipped = false;               //!< Segment skipped (only constant distances without preceding one), beginning tag stays active
+        QString text;                       //!< Lines to write
+        int numOfPoints = 0;                //!< Number of lines in text
+        QStringList warnings;               //!< Warnings to emit (in order)
+        double initialStylusTipDistanceFromRoverA = 0;  //!< Distance used when segment didn't set its own
+        bool initialDistanceUsed = true;    //!< Result depends on initialStylusTipDistanceFromRoverA (=distance carried over from previous segments)
+        double stylusTipDistanceFromRoverA = 0;     //!< Distance after the segment
+    };
+
+    RoverPositionTrack roverTracks[2];      //!< Positions of rovers A and B for measured distances
+
+    //! Generates lines of one segment. Doesn't emit anything and only reads params/roverTracks -> thread-safe
+    SegmentResult generateLineSet(const Params& params, const TagSegmentIndex::Segment& segment, const double initialStylusTipDistanceFromRoverA) const;
+
 
 signals:
     void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
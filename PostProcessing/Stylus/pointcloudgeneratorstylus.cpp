@@ -17,6 +17,7 @@
 */
 
 #include "pointcloudgeneratorstylus.h"
+#include "../../tracer.h"
 
 namespace Stylus
 {
@@ -38,6 +39,24 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
 
     emit infoMessage("Processing...");
 
+    for (int i = 0; i < 2; i++)
+    {
+        roverTracks[i].build(params.rovers[i]);
+    }
+
+    TagSegmentIndex tagSegmentIndex_Generated;
+
+    if (!params.tagSegmentIndex)
+    {
+        tagSegmentIndex_Generated.build(*params.tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+    }
+
+    const TagSegmentIndex& tagSegmentIndex = params.tagSegmentIndex ? *params.tagSegmentIndex : tagSegmentIndex_Generated;
+
+    // Segments' points are generated in parallel batches ahead of the item handling below
+    SegmentPrefetcher<SegmentResult> segmentPrefetcher(tagSegmentIndex.getSegments(),
+                [this, &params](const TagSegmentIndex::Segment& segment) { return generatePointCloudPointSet(params, segment); });
+
     bool objectActive = false;
 
     qint64 beginningUptime = -1;
@@ -45,238 +64,227 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
 
     bool ignoreBeginningAndEndingTags = false;
 
-    QFile* outFile = nullptr;
+    QSaveFile* outFile = nullptr;
     QTextStream* outStream = nullptr;
 
     QString objectName;
     QString baseFileName;
     int fileIndex = 0;
 
-    qint64 uptime = -1;
     PostProcessingForm::Tag beginningTag;
 
-    while (params.tags->upperBound(uptime) != params.tags->end())
+    bool cancelled = false;
+
+    for (const TagSegmentIndex::Item& item : tagSegmentIndex.getItems())
     {
-        uptime = params.tags->upperBound(uptime).key();
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            cancelled = true;
+            break;
+        }
 
-        QList<PostProcessingForm::Tag> tagItems = params.tags->values(uptime);
+        const qint64 uptime = item.uptime;
+        const PostProcessingForm::Tag& currentTag = item.tag;
 
-        // Since "The items that share the same key are available from most recently to least recently inserted."
-        // (taken from QMultiMap's doc), iterate in "reverse order" here
+        GeneratorTask::setProgress(params.task, uptime - params.tags->firstKey(), params.tags->lastKey() - params.tags->firstKey());
 
-        for (int i = tagItems.size() - 1; i >= 0; i--)
+        if ((item.type == TagSegmentIndex::ITEM_NEW_OBJECT) || (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT))
         {
-            const PostProcessingForm::Tag& currentTag = tagItems[i];
+            // Tag type: new object
 
-            if (!(currentTag.ident.compare(params.tagIdent_BeginNewObject)))
+            if (objectActive)
             {
-                // Tag type: new object
+                // Object already active -> Close existing stream and file
 
-                if (objectActive)
+                if (outStream)
+                {
+                    delete outStream;
+                    outStream = nullptr;
+                }
+                if (outFile)
                 {
-                    // Object already active -> Close existing stream and file
+                    emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
+                    commitOutFile(outFile);
+                    outFile = nullptr;
+                }
 
-                    if (outStream)
-                    {
-                        delete outStream;
-                        outStream = nullptr;
-                    }
-                    if (outFile)
-                    {
-                        emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
-                        outFile->close();
-                        delete outFile;
-                        outFile = nullptr;
-                    }
+                emit infoMessage("Object \"" + objectName + "\": Total points written: " + QString::number(pointsWritten));
 
-                    emit infoMessage("Object \"" + objectName + "\": Total points written: " + QString::number(pointsWritten));
+                objectActive = false;
+            }
 
-                    objectActive = false;
-                }
+            objectName = currentTag.text;
 
-                objectName = currentTag.text;
+            if (item.type == TagSegmentIndex::ITEM_NAMELESS_OBJECT)
+            {
+                // Empty name for the new object not allowed
 
-                if (currentTag.text.length() == 0)
-                {
-                    // Empty name for the new object not allowed
+                emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
+                           QString::number(currentTag.sourceFileLine)+
+                           ", uptime " + QString::number(uptime) +
+                           ", iTOW " + QString::number(currentTag.iTOW) +
+                           ": New object without a name. Ending previous object, but not beginning new nor creating a new file. Ignoring subsequent beginning and ending tags.");
 
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": New object without a name. Ending previous object, but not beginning new nor creating a new file. Ignoring subsequent beginning and ending tags.");
+                ignoreBeginningAndEndingTags = true;
 
-                    ignoreBeginningAndEndingTags = true;
+                continue;
+            }
 
-                    continue;
-                }
+            baseFileName = QDir::cleanPath(params.directory.path() + "/" + currentTag.text);
 
-                baseFileName = QDir::cleanPath(params.directory.path() + "/" + currentTag.text);
+            QString fileName = baseFileName + ".xyz";
 
-                QString fileName = baseFileName + ".xyz";
+            if (!params.separateFilesForSubScans)
+            {
+                outFile = createNewOutFile(fileName, currentTag, uptime);
 
-                if (!params.separateFilesForSubScans)
+                if (!outFile)
                 {
-                    outFile = createNewOutFile(fileName, currentTag, uptime);
-
-                    if (!outFile)
-                    {
-                        ignoreBeginningAndEndingTags = true;
-                        continue;
-                    }
-                    else
-                    {
-                        outStream = new QTextStream(outFile);
-                        ignoreBeginningAndEndingTags = false;
-                    }
+                    ignoreBeginningAndEndingTags = true;
+                    continue;
                 }
                 else
                 {
-                    emit infoMessage("Starting new object \"" +  currentTag.text + "\".");
+                    outStream = new QTextStream(outFile);
                     ignoreBeginningAndEndingTags = false;
                 }
-
-                objectActive = true;
-                beginningUptime = -1;
-                pointsWritten = 0;
-
-                fileIndex = 0;
             }
-            else if ((!(currentTag.ident.compare(params.tagIdent_BeginPoints))) && (!ignoreBeginningAndEndingTags))
+            else
             {
-                // Tag type: Begin points
+                emit infoMessage("Starting new object \"" +  currentTag.text + "\".");
+                ignoreBeginningAndEndingTags = false;
+            }
 
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Beginning tag outside object. Skipped.");
-                    continue;
-                }
+            objectActive = true;
+            beginningUptime = -1;
+            pointsWritten = 0;
 
-                if (beginningUptime != -1)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": Duplicate beginning tag. Skipped.");
-                    continue;
-                }
+            fileIndex = 0;
+        }
+        else if (ignoreBeginningAndEndingTags)
+        {
+            // Skipped until the next object
+            continue;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_INVALID_TAG)
+        {
+            emit warningMessage(TagSegmentIndex::getDiagnosticText(item));
+        }
+        else if (item.type == TagSegmentIndex::ITEM_BEGINNING)
+        {
+            // Just store the beginning uptime-value and tag. Writing of the points is done in ending tag-branch
+            beginningUptime = uptime;
+            beginningTag = currentTag;
+        }
+        else if (item.type == TagSegmentIndex::ITEM_SEGMENT)
+        {
+            const PostProcessingForm::Tag& endingTag = currentTag;
 
-                // Just store the beginning uptime-value and tag. Writing of the points is done in ending tag-branch
-                beginningUptime = uptime;
-                beginningTag = currentTag;
-            }
-            else if ((!(currentTag.ident.compare(params.tagIdent_EndPoints)))  && (!ignoreBeginningAndEndingTags))
+            if (params.separateFilesForSubScans)
             {
-                // Tag type: end points
+                fileIndex++;
 
-                if (!objectActive)
-                {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag outside object. Skipped.");
-                    continue;
-                }
+                QString fileIndexString = QString::number(fileIndex);
 
-                if (beginningUptime == -1)
+                while (fileIndexString.length() < 4)
                 {
-                    emit warningMessage("File \"" + currentTag.sourceFile + "\", line " +
-                               QString::number(currentTag.sourceFileLine)+
-                               ", uptime " + QString::number(uptime) +
-                               ", iTOW " + QString::number(currentTag.iTOW) +
-                               ": End tag without beginning tag. Skipped.");
-                    continue;
+                    fileIndexString.prepend("0");
                 }
 
-                const PostProcessingForm::Tag& endingTag = currentTag;
+                QString fileName = QDir::cleanPath(baseFileName + "_" + fileIndexString + ".xyz");
+
+                outFile = createNewOutFile(fileName, currentTag, uptime);
 
-                if (endingTag.sourceFile != beginningTag.sourceFile)
+                if (!outFile)
                 {
-                    emit warningMessage("Starting and ending tags belong to different files. Starting tag file \"" +
-                               beginningTag.sourceFile + "\", line " +
-                               QString::number(beginningTag.sourceFileLine) + " ending tag file: " +
-                               endingTag.sourceFile + "\", line " +
-                               QString::number(endingTag.sourceFileLine) + ". Ending tag ignored.");
+                    ignoreBeginningAndEndingTags = true;
                     continue;
                 }
-
-                if (params.separateFilesForSubScans)
+                else
                 {
-                    fileIndex++;
+                    outStream = new QTextStream(outFile);
+                    objectActive = true;
+                    ignoreBeginningAndEndingTags = false;
+                }
+            }
 
-                    QString fileIndexString = QString::number(fileIndex);
+            bool generatingOk = false;
+            int prevPointsWritten = pointsWritten;
 
-                    while (fileIndexString.length() < 4)
-                    {
-                        fileIndexString.prepend("0");
-                    }
+            const SegmentResult segmentResult = segmentPrefetcher.getResult(item.segmentIndex);
 
-                    QString fileName = QDir::cleanPath(baseFileName + "_" + fileIndexString + ".xyz");
+            for (const QString& warning : segmentResult.warnings)
+            {
+                emit warningMessage(warning);
+            }
 
-                    outFile = createNewOutFile(fileName, currentTag, uptime);
+            {
+                TRACE_ZONE("PointCloudGenerator(stylus)::write");
+                outStream->operator<<(segmentResult.text);
+            }
 
-                    if (!outFile)
-                    {
-                        ignoreBeginningAndEndingTags = true;
-                        continue;
-                    }
-                    else
-                    {
-                        outStream = new QTextStream(outFile);
-                        objectActive = true;
-                        ignoreBeginningAndEndingTags = false;
-                    }
-                }
+            TRACE_COUNT("Stylus points written", segmentResult.numOfPoints);
+            pointsWritten += segmentResult.numOfPoints;
+            generatingOk = segmentResult.ok;
 
-                bool generatingOk = false;
-                int prevPointsWritten = pointsWritten;
+            if (GeneratorTask::isCancelRequested(params.task))
+            {
+                // Partially written file is discarded below
+                cancelled = true;
+                break;
+            }
 
-                generatingOk = generatePointCloudPointSet(params, beginningTag, endingTag, beginningUptime, uptime, outStream, pointsWritten);
+            if (generatingOk)
+            {
+                int pointsBetweenTags = pointsWritten - prevPointsWritten;
 
-                if (generatingOk)
+                if (pointsBetweenTags == 0)
                 {
-                    int pointsBetweenTags = pointsWritten - prevPointsWritten;
-
-                    if (pointsBetweenTags == 0)
-                    {
-                        emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
-                                   QString::number(beginningTag.sourceFileLine) +
-                                   ", uptime " + QString::number(beginningUptime) +
-                                   ", iTOW " + QString::number(beginningTag.iTOW) + ", ending tag line " +
-                                   QString::number(endingTag.sourceFileLine) +
-                                   ", uptime " + QString::number(endingTag.iTOW) +
-                                   ", iTOW " + QString::number(endingTag.iTOW) +
-                                   ", File \"" + endingTag.sourceFile + "\""
-                                   " No points between tags.");
-                    }
+                    emit warningMessage("File \"" + beginningTag.sourceFile + "\", beginning tag line " +
+                               QString::number(beginningTag.sourceFileLine) +
+                               ", uptime " + QString::number(beginningUptime) +
+                               ", iTOW " + QString::number(beginningTag.iTOW) + ", ending tag line " +
+                               QString::number(endingTag.sourceFileLine) +
+                               ", uptime " + QString::number(endingTag.iTOW) +
+                               ", iTOW " + QString::number(endingTag.iTOW) +
+                               ", File \"" + endingTag.sourceFile + "\""
+                               " No points between tags.");
                 }
+            }
 
-                if (params.separateFilesForSubScans)
+            if (params.separateFilesForSubScans)
+            {
+                if (outStream)
                 {
-                    if (outStream)
-                    {
-                        delete outStream;
-                        outStream = nullptr;
-                    }
-                    if (outFile)
-                    {
-                        int pointsBetweenTags = pointsWritten - prevPointsWritten;
-                        emit infoMessage("Closing file \"" + outFile->fileName() + "\". Points written: " + QString::number(pointsBetweenTags));
-                        outFile->close();
-                        delete outFile;
-                        outFile = nullptr;
-                    }
+                    delete outStream;
+                    outStream = nullptr;
+                }
+                if (outFile)
+                {
+                    int pointsBetweenTags = pointsWritten - prevPointsWritten;
+                    emit infoMessage("Closing file \"" + outFile->fileName() + "\". Points written: " + QString::number(pointsBetweenTags));
+                    commitOutFile(outFile);
+                    outFile = nullptr;
                 }
-
-                beginningUptime = -1;
             }
+
+            beginningUptime = -1;
+        }
+    }
+
+    if (cancelled)
+    {
+        // Files not committed are discarded (existing files are left untouched)
+        delete outStream;
+
+        if (outFile)
+        {
+            emit warningMessage("File \"" + outFile->fileName() + "\" discarded.");
+            delete outFile;
         }
+
+        emit warningMessage("Generating point clouds cancelled.");
+        return;
     }
 
     if (beginningUptime != -1)
@@ -295,8 +303,7 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
     if (outFile)
     {
         emit infoMessage("Closing file \"" + outFile->fileName() + "\".");
-        outFile->close();
-        delete outFile;
+        commitOutFile(outFile);
     }
 
     if (objectActive)
@@ -308,13 +315,23 @@ void PointCloudGenerator::generatePointClouds(const Params& params)
 }
 
 
-bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
-                                                     const PostProcessingForm::Tag& beginningTag,
-                                                     const PostProcessingForm::Tag& endingTag,
-                                                     const qint64 beginningUptime, const qint64 endingUptime,
-                                                     QTextStream* outStream,
-                                                     int& pointsWritten)
+PointCloudGenerator::SegmentResult PointCloudGenerator::generatePointCloudPointSet(const Params& params, const TagSegmentIndex::Segment& segment) const
 {
+    TRACE_ZONE("PointCloudGenerator(stylus)::segment");
+
+    SegmentResult result;
+
+    if (GeneratorTask::isCancelRequested(params.task))
+    {
+        // Result is not used
+        return result;
+    }
+
+    const PostProcessingForm::Tag& beginningTag = segment.beginningTag;
+    const PostProcessingForm::Tag& endingTag = segment.endingTag;
+    const qint64 beginningUptime = segment.beginningUptime;
+    const qint64 endingUptime = segment.endingUptime;
+
     double stylusTipDistanceFromRoverA = params.initialStylusTipDistanceFromRoverA;
     bool includeNormals = params.includeNormals;
 
@@ -333,8 +350,6 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
         distIter++;
     }
 
-    int pointsBetweenTags = 0;
-
     if (constDistancesOnly)
     {
         distIter = params.distances->upperBound(beginningUptime);
@@ -344,13 +359,13 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
             if ((distIter == params.distances->begin()) ||
                     ((--distIter).value().type != PostProcessingForm::DistanceItem::Type::CONSTANT))
             {
-                emit warningMessage("File \"" + endingTag.sourceFile + "\", line " +
+                result.warnings.append("File \"" + endingTag.sourceFile + "\", line " +
                            QString::number(endingTag.sourceFileLine)+
                            ", uptime " + QString::number(endingUptime) +
                            ", iTOW " + QString::number(endingTag.iTOW) +
                            ": Points between tags having only constant distances without preceeding constant distance. Skipped.");
 
-                return false;
+                return result;
             }
 
             stylusTipDistanceFromRoverA = distIter.value().distance;
@@ -422,11 +437,10 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                             "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4);
                 }
 
-                outStream->operator<<(lineOut + "\n");
+                result.text += lineOut + "\n";
 
-                pointsWritten++;
+                result.numOfPoints++;
 
-                pointsBetweenTags++;
                 relposIterator_RoverA++;
                 relposIterator_RoverB++;
             }
@@ -439,11 +453,14 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
 
         distIter = params.distances->upperBound(beginningUptime);
 
+        // Distances are sorted by uptime -> rovers' positions are found by walking their tracks forward (merge join)
+        int trackIndexes[2] = { -1, -1 };
+
         while ((distIter != params.distances->end()) && (distIter.key() < endingUptime))
         {
             if (distIter.value().type == PostProcessingForm::DistanceItem::Type::CONSTANT)
             {
-                emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
+                result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
                            QString::number(distIter.value().sourceFileLine)+
                            ", uptime " + QString::number(distIter.key()) +
                            ": Constant distance between measured ones. Skipped.");
@@ -458,67 +475,29 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                 qint64 distanceUptime = distIter.key();
                 // TODO: Add/subtract fine tune sync value here if needed
 
-                UBXMessage_RELPOSNED interpolated_Rovers[2];
+                RoverPositionTrack::Position interpolated_Rovers[2];
                 bool fail = false;
 
                 for (int i = 0; i < 2; i++)
                 {
-                    QMap<qint64, PostProcessingForm::RoverSyncItem>::const_iterator roverUptimeIter = params.rovers[i].roverSyncData.lowerBound(distanceUptime);
-
-                    if (roverUptimeIter != params.rovers[i].roverSyncData.end())
+                    if (trackIndexes[i] < 0)
                     {
-                        const PostProcessingForm::RoverSyncItem upperSyncItem = roverUptimeIter.value();
-                        PostProcessingForm::RoverSyncItem lowerSyncItem;
-
-                        if (roverUptimeIter != params.rovers[i].roverSyncData.begin())
-                        {
-                            lowerSyncItem = (--roverUptimeIter).value();
-                        }
-                        else
-                        {
-                            emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                       QString::number(distIter.value().sourceFileLine)+
-                                       ", uptime " + QString::number(distIter.key()) +
-                                       ": Can not find corresponding rover" + PostProcessingForm::getRoverIdentString(i) + " sync data (higher limit). Skipped.");
-                            distIter++;
-                            fail = true;
-                            break;
-                        }
-
-                        if (params.rovers[i].relposnedMessages.find(upperSyncItem.iTOW) == params.rovers[i].relposnedMessages.end())
-                        {
-                            emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                       QString::number(distIter.value().sourceFileLine)+
-                                       ", uptime " + QString::number(distIter.key()) +
-                                       ": Can not find corresponding rover" + PostProcessingForm::getRoverIdentString(i) + " iTOW (higher limit). Skipped.");
-                            distIter++;
-                            fail = true;
-                            break;
-                        }
-
-                        if (params.rovers[i].relposnedMessages.find(lowerSyncItem.iTOW) == params.rovers[i].relposnedMessages.end())
-                        {
-                            emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
-                                       QString::number(distIter.value().sourceFileLine)+
-                                       ", uptime " + QString::number(distIter.key()) +
-                                       ": Can not find corresponding rover" + PostProcessingForm::getRoverIdentString(i) + " iTOW (higher limit). Skipped.");
-                            distIter++;
-                            fail = true;
-                            break;
-                        }
-
-                        qint64 timeDiff = distanceUptime - roverUptimeIter.key();
-
-                        interpolated_Rovers[i] = UBXMessage_RELPOSNED::interpolateCoordinates(params.rovers[i].relposnedMessages.find(lowerSyncItem.iTOW).value(),
-                                                params.rovers[i].relposnedMessages.find(upperSyncItem.iTOW).value(), lowerSyncItem.iTOW + timeDiff);
+                        trackIndexes[i] = roverTracks[i].lowerBound(distanceUptime);
                     }
                     else
                     {
-                        emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
+                        roverTracks[i].advanceToLowerBound(trackIndexes[i], distanceUptime);
+                    }
+
+                    RoverPositionTrack::LookupResult lookupResult = roverTracks[i].interpolate(trackIndexes[i], distanceUptime, -1, interpolated_Rovers[i]);
+
+                    if (lookupResult != RoverPositionTrack::LOOKUP_OK)
+                    {
+                        result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
                                    QString::number(distIter.value().sourceFileLine)+
                                    ", uptime " + QString::number(distIter.key()) +
-                                   ": Can not find corresponding rover" + PostProcessingForm::getRoverIdentString(i) + " sync data (upper limit). Skipped.");
-                        distIter++;
+                                   ": Can not find corresponding rover" + PostProcessingForm::getRoverIdentString(i) + " " +
+                                   RoverPositionTrack::getLookupResultText(lookupResult) + ". Skipped.");
                         fail = true;
                         break;
                     }
@@ -526,6 +505,7 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
 
                 if (fail)
                 {
+                    distIter++;
                     continue;
                 }
 
@@ -536,7 +516,7 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                 // (measurement module seems to emit "outliers" now and then)
                 if (stylusTipDistanceFromRoverA > 2)
                 {
-                    emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
+                    result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
                                QString::number(distIter.value().sourceFileLine)+
                                ", uptime " + QString::number(distIter.key()) +
                                ": Distance between RoverA and tip too high (" +
@@ -584,13 +564,12 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
                             "\t" + QString::number(stylusTipPosXYZ(2), 'f', 4);
                 }
 
-                outStream->operator<<(lineOut + "\n");
-                pointsWritten++;
-                pointsBetweenTags++;
+                result.text += lineOut + "\n";
+                result.numOfPoints++;
             }
             else
             {
-                emit warningMessage("File \"" + distIter.value().sourceFile + "\", line " +
+                result.warnings.append("File \"" + distIter.value().sourceFile + "\", line " +
                            QString::number(distIter.value().sourceFileLine)+
                            ", uptime " + QString::number(distIter.key()) +
                            ": Unknown distance type between measured ones. Skipped.");
@@ -602,12 +581,14 @@ bool PointCloudGenerator::generatePointCloudPointSet(const Params& params,
         }
     }
 
-    return true;
+    result.ok = true;
+    return result;
 }
 
-QFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostProcessingForm::Tag &currentTag, const qint64 uptime)
+QSaveFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostProcessingForm::Tag &currentTag, const qint64 uptime)
 {
-    QFile* outFile = new QFile(fileName);
+    // Points are written into a temporary file that is renamed when the file is complete (see commitOutFile)
+    QSaveFile* outFile = new QSaveFile(fileName);
 
     if (outFile->exists())
     {
@@ -644,4 +625,14 @@ QFile *PointCloudGenerator::createNewOutFile(const QString fileName, const PostP
     return outFile;
 }
 
+void PointCloudGenerator::commitOutFile(QSaveFile* outFile)
+{
+    if (!outFile->commit())
+    {
+        emit warningMessage("Writing file \"" + outFile->fileName() + "\" failed: " + outFile->errorString());
+    }
+
+    delete outFile;
+}
+
 }; // namespace Stylus
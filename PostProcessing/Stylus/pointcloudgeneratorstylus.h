@@ -19,7 +19,12 @@
 #ifndef POINTCLOUDGENERATORSTYLUS_H
 #define POINTCLOUDGENERATORSTYLUS_H
 
+#include <QSaveFile>
+
 #include "../postprocessingform.h"
+#include "../generatortask.h"
+#include "../tagsegmentindex.h"
+#include "roverpositiontrack.h"
 
 
 namespace Stylus
@@ -43,22 +48,35 @@ public:
         bool separateFilesForSubScans = false;
 
         const QMultiMap<qint64, PostProcessingForm::Tag>* tags = nullptr;
+        const TagSegmentIndex* tagSegmentIndex = nullptr;  //!< Objects/segments of tags (built from tags if nullptr)
         const QMap<qint64, PostProcessingForm::DistanceItem>* distances = nullptr;
         const PostProcessingForm::Rover* rovers = nullptr;
+        GeneratorTask* task = nullptr;      //!< Progress reporting and cancellation (optional)
 
     };
 
     void generatePointClouds(const Params& params);
 
 private:
-    bool generatePointCloudPointSet(const Params& params,
-                                    const PostProcessingForm::Tag& beginningTag,
-                                    const PostProcessingForm::Tag& endingTag,
-                                    const qint64 beginningUptime, const qint64 endingUptime,
-                                    QTextStream* outStream,
-                                    int& pointsWritten);
-
-    QFile* createNewOutFile(const QString fileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime);
+    /**
+     * @brief Points of one segment (between beginning and ending tags)
+     */
+    class SegmentResult
+    {
+    public:
+        bool ok = false;            //!< False if segment was skipped
+        QString text;               //!< Lines to write
+        int numOfPoints = 0;        //!< Number of lines in text
+        QStringList warnings;       //!< Warnings to emit (in order)
+    };
+
+    RoverPositionTrack roverTracks[2];      //!< Positions of rovers A and B for measured distances
+
+    //! Generates points of one segment. Doesn't emit anything and only reads params/roverTracks -> thread-safe
+    SegmentResult generatePointCloudPointSet(const Params& params, const TagSegmentIndex::Segment& segment) const;
+
+    QSaveFile* createNewOutFile(const QString fileName, const PostProcessingForm::Tag& currentTag, const qint64 uptime);
+    void commitOutFile(QSaveFile* outFile);     //!< Commits (=renames temporary file to final name) and deletes outFile
 
 public:
 
@@ -0,0 +1,156 @@
+/*
+    roverpositiontrack.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file roverpositiontrack.cpp
+ * @brief Definition for a class joining rover's sync data with its RELPOSNED-positions for stylus generators.
+ */
+
+#include <algorithm>
+
+#include "roverpositiontrack.h"
+
+namespace Stylus
+{
+
+void RoverPositionTrack::build(const PostProcessingForm::Rover& rover)
+{
+    items.clear();
+    items.reserve(rover.roverSyncData.size());
+
+    // ITOWs in sync data are normally increasing -> RELPOSNED-messages are walked forward
+    // and searched only when ITOW goes backwards.
+    QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIter = rover.relposnedMessages.constBegin();
+
+    for (auto syncIter = rover.roverSyncData.constBegin(); syncIter != rover.roverSyncData.constEnd(); syncIter++)
+    {
+        Item item;
+        item.uptime = syncIter.key();
+        item.iTOW = syncIter.value().iTOW;
+
+        if ((relposIter != rover.relposnedMessages.constBegin()) &&
+                ((relposIter == rover.relposnedMessages.constEnd()) || (relposIter.key() > item.iTOW)))
+        {
+            relposIter = rover.relposnedMessages.lowerBound(item.iTOW);
+        }
+        else
+        {
+            while ((relposIter != rover.relposnedMessages.constEnd()) && (relposIter.key() < item.iTOW))
+            {
+                relposIter++;
+            }
+        }
+
+        if ((relposIter != rover.relposnedMessages.constEnd()) && (relposIter.key() == item.iTOW))
+        {
+            const UBXMessage_RELPOSNED& relposned = relposIter.value();
+
+            item.relposnedFound = true;
+            item.relposnedITOW = relposned.iTOW;
+            item.relPosN = relposned.relPosN;
+            item.relPosE = relposned.relPosE;
+            item.relPosD = relposned.relPosD;
+            item.accN = relposned.accN;
+            item.accE = relposned.accE;
+            item.accD = relposned.accD;
+        }
+
+        items.append(item);
+    }
+}
+
+int RoverPositionTrack::lowerBound(const qint64 uptime) const
+{
+    return std::lower_bound(items.constBegin(), items.constEnd(), uptime,
+                            [](const Item& item, const qint64 uptime) { return item.uptime < uptime; }) - items.constBegin();
+}
+
+void RoverPositionTrack::advanceToLowerBound(int& index, const qint64 uptime) const
+{
+    while ((index < items.count()) && (items[index].uptime < uptime))
+    {
+        index++;
+    }
+}
+
+RoverPositionTrack::LookupResult RoverPositionTrack::interpolate(const int index, const qint64 uptime, const qint64 timeDiffReferenceUptime,
+                                                                 Position& position, qint64* lowerItemUptime) const
+{
+    if (index >= items.count())
+    {
+        return LOOKUP_NO_UPPER_SYNC;
+    }
+
+    if (index == 0)
+    {
+        return LOOKUP_NO_LOWER_SYNC;
+    }
+
+    const Item& upperItem = items[index];
+    const Item& lowerItem = items[index - 1];
+
+    if (lowerItemUptime)
+    {
+        *lowerItemUptime = lowerItem.uptime;
+    }
+
+    if (!upperItem.relposnedFound)
+    {
+        return LOOKUP_NO_UPPER_RELPOSNED;
+    }
+
+    if (!lowerItem.relposnedFound)
+    {
+        return LOOKUP_NO_LOWER_RELPOSNED;
+    }
+
+    qint64 timeDiff = uptime - ((timeDiffReferenceUptime == -1) ? lowerItem.uptime : timeDiffReferenceUptime);
+
+    // Same calculations as in UBXMessage_RELPOSNED::interpolateCoordinates
+    const UBXMessage_RELPOSNED::ITOW iTOW = lowerItem.iTOW + timeDiff;
+
+    position.iTOW = iTOW;
+    position.relPosN = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.relPosN, upperItem.relPosN, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+    position.relPosE = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.relPosE, upperItem.relPosE, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+    position.relPosD = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.relPosD, upperItem.relPosD, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+    position.accN = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.accN, upperItem.accN, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+    position.accE = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.accE, upperItem.accE, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+    position.accD = UBXMessage_RELPOSNED::interpolateDouble(lowerItem.accD, upperItem.accD, lowerItem.relposnedITOW, upperItem.relposnedITOW, iTOW);
+
+    return LOOKUP_OK;
+}
+
+QString RoverPositionTrack::getLookupResultText(const LookupResult lookupResult)
+{
+    // Texts are the same as generators used before (including "higher limit" for the lower items)
+    switch (lookupResult)
+    {
+    case LOOKUP_OK:
+        return "OK";
+    case LOOKUP_NO_UPPER_SYNC:
+        return "sync data (upper limit)";
+    case LOOKUP_NO_LOWER_SYNC:
+        return "sync data (higher limit)";
+    case LOOKUP_NO_UPPER_RELPOSNED:
+    case LOOKUP_NO_LOWER_RELPOSNED:
+    default:
+        return "iTOW (higher limit)";
+    }
+}
+
+}; // namespace Stylus
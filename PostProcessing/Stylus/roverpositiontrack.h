@@ -0,0 +1,125 @@
+/*
+    roverpositiontrack.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file roverpositiontrack.h
+ * @brief Declaration for a class joining rover's sync data with its RELPOSNED-positions for stylus generators.
+ */
+
+#ifndef ROVERPOSITIONTRACK_H
+#define ROVERPOSITIONTRACK_H
+
+#include <QVector>
+
+#include "../postprocessingform.h"
+
+namespace Stylus
+{
+
+/**
+ * @brief Rover's sync items joined with RELPOSNED-positions, in rover uptime order
+ *
+ * Stylus generators need rover's position at every measured distance's uptime.
+ * Instead of QMap-lookups (sync data + two RELPOSNED-messages) for every distance item,
+ * sync data and RELPOSNED-messages are joined once into a flat array of plain values.
+ * Positions are then found by walking the array in the same order as the (sorted) distances.
+ *
+ * Results are identical to QMap::lowerBound + QMap::find + UBXMessage_RELPOSNED::interpolateCoordinates.
+ * Read-only access (after build) is thread-safe.
+ */
+class RoverPositionTrack
+{
+public:
+    class Item
+    {
+    public:
+        qint64 uptime = 0;                          //!< Key of the sync item (rover uptime)
+        UBXMessage_RELPOSNED::ITOW iTOW = -1;       //!< ITOW of the sync item
+        bool relposnedFound = false;                //!< True if RELPOSNED-message with iTOW exists (values below valid)
+        UBXMessage_RELPOSNED::ITOW relposnedITOW = -1;  //!< ITOW-field of the RELPOSNED-message
+        double relPosN = 0;
+        double relPosE = 0;
+        double relPosD = 0;
+        double accN = 0;
+        double accE = 0;
+        double accD = 0;
+    };
+
+    /**
+     * @brief Interpolated position
+     */
+    class Position
+    {
+    public:
+        UBXMessage_RELPOSNED::ITOW iTOW = -1;
+        double relPosN = 0;
+        double relPosE = 0;
+        double relPosD = 0;
+        double accN = 0;
+        double accE = 0;
+        double accD = 0;
+    };
+
+    enum LookupResult
+    {
+        LOOKUP_OK = 0,
+        LOOKUP_NO_UPPER_SYNC,           //!< No sync item with uptime >= requested
+        LOOKUP_NO_LOWER_SYNC,           //!< No sync item before the upper one
+        LOOKUP_NO_UPPER_RELPOSNED,      //!< Upper sync item's RELPOSNED-message not found
+        LOOKUP_NO_LOWER_RELPOSNED,      //!< Lower sync item's RELPOSNED-message not found
+    };
+
+    void build(const PostProcessingForm::Rover& rover);     //!< Joins rover's sync data and RELPOSNED-messages
+
+    const QVector<Item>& getItems(void) const { return items; }
+
+    int lowerBound(const qint64 uptime) const;      //!< Index of the first item with uptime >= given uptime (number of items if none)
+
+    /**
+     * @brief Moves index forward to the first item with uptime >= given uptime
+     *
+     * Same result as lowerBound, but linear from index. Used when walking sorted uptimes.
+     * @param index Index to start from (must not be past lowerBound(uptime))
+     * @param uptime Uptime
+     */
+    void advanceToLowerBound(int& index, const qint64 uptime) const;
+
+    /**
+     * @brief Finds sync items around the uptime and interpolates position
+     *
+     * Lower and upper items are the ones before and at lowerBound(uptime), like when using roverSyncData.lowerBound.
+     * Position is interpolated at ITOW lowerItem.iTOW + (uptime - timeDiffReferenceUptime).
+     * @param index Index of the upper item (from lowerBound/advanceToLowerBound)
+     * @param uptime Uptime used to calculate interpolation ITOW
+     * @param timeDiffReferenceUptime Uptime subtracted from uptime (-1 = lower item's uptime)
+     * @param position Interpolated position (only valid if LOOKUP_OK returned)
+     * @param lowerItemUptime Uptime of the lower item (if found)
+     * @return Result of the lookup
+     */
+    LookupResult interpolate(const int index, const qint64 uptime, const qint64 timeDiffReferenceUptime,
+                             Position& position, qint64* lowerItemUptime = nullptr) const;
+
+    static QString getLookupResultText(const LookupResult lookupResult);    //!< Returns description of a failed lookup for warnings ("sync data (upper limit)" etc.)
+
+private:
+    QVector<Item> items;
+};
+
+}; // namespace Stylus
+
+#endif // ROVERPOSITIONTRACK_H
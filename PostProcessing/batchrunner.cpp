@@ -0,0 +1,296 @@
+/*
+    batchrunner.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file batchrunner.cpp
+ * @brief Definition for a class that runs post-processing from command line without user interaction.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <string.h>
+
+#include "batchrunner.h"
+#include "postprocessingform.h"
+#include "../tracer.h"
+
+BatchRunner::BatchRunner(QObject *parent) : QObject(parent)
+{
+}
+
+bool BatchRunner::isBatchModeRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--batch") == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int BatchRunner::run(const QStringList& arguments)
+{
+    QTextStream stdoutStream(stdout);
+    QTextStream stderrStream(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("GNSS-Stylus batch post-processing");
+    parser.addHelpOption();
+
+    QCommandLineOption batchOption("batch", "Run post-processing without user interface.");
+    QCommandLineOption parametersOption("parameters", "Parameter file (saved using \"Save editable fields to file\").", "file");
+    QCommandLineOption outputsOption("outputs", "Comma-separated list of outputs to generate (" + PostProcessingForm::batchOutputNames.join(", ") + ").", "outputs");
+    QCommandLineOption outputDirOption("output-dir", "Directory where outputs are written to.", "dir");
+    QCommandLineOption jobsOption("jobs", "Maximum number of sessions processed in parallel (default: number of cores).", "n");
+    QCommandLineOption traceOption("trace", "Record trace of processing and write it into file (Chrome trace JSON, single session only). Summary is written to stdout.", "file");
+
+    parser.addOption(batchOption);
+    parser.addOption(parametersOption);
+    parser.addOption(outputsOption);
+    parser.addOption(outputDirOption);
+    parser.addOption(jobsOption);
+    parser.addOption(traceOption);
+    parser.addPositionalArgument("sessions", "Base file names, log files or directories of the sessions to process.", "<session> [<session> ...]");
+
+    if (!parser.parse(arguments))
+    {
+        stderrStream << parser.errorText() << "\n";
+        return 2;
+    }
+
+    if (parser.isSet("help"))
+    {
+        stdoutStream << parser.helpText();
+        return 0;
+    }
+
+    if (!parser.isSet(parametersOption) || !parser.isSet(outputsOption) || !parser.isSet(outputDirOption) ||
+            parser.positionalArguments().isEmpty())
+    {
+        stderrStream << "Parameter file, outputs, output directory and at least one session are required.\n\n";
+        stderrStream << parser.helpText();
+        return 2;
+    }
+
+    QStringList outputs = parser.value(outputsOption).split(",", Qt::SkipEmptyParts);
+
+    for (const QString& output : outputs)
+    {
+        if (!PostProcessingForm::batchOutputNames.contains(output))
+        {
+            stderrStream << "Unknown output \"" << output << "\". Supported outputs: " << PostProcessingForm::batchOutputNames.join(", ") << "\n";
+            return 2;
+        }
+    }
+
+    QStringList sessions;
+
+    for (const QString& sessionArgument : parser.positionalArguments())
+    {
+        sessions.append(getSessionBaseFileNames(sessionArgument));
+    }
+
+    sessions.removeDuplicates();
+
+    if (sessions.isEmpty())
+    {
+        stderrStream << "No sessions found.\n";
+        return 2;
+    }
+
+    if (sessions.count() == 1)
+    {
+        if (parser.isSet(traceOption))
+        {
+            Tracer::clear();
+            Tracer::setEnabled(true);
+        }
+
+        PostProcessingForm postProcessingForm;
+
+        int returnValue = postProcessingForm.runBatch(parser.value(parametersOption), sessions[0], outputs, QDir(parser.value(outputDirOption)));
+
+        if (parser.isSet(traceOption))
+        {
+            Tracer::setEnabled(false);
+
+            QFile traceFile(parser.value(traceOption));
+
+            if (traceFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+            {
+                QTextStream traceStream(&traceFile);
+                Tracer::writeChromeTrace(traceStream);
+            }
+            else
+            {
+                stderrStream << "Can't open trace file \"" << parser.value(traceOption) << "\".\n";
+            }
+
+            Tracer::writeSummary(stdoutStream);
+        }
+
+        return returnValue;
+    }
+
+    if (parser.isSet(traceOption))
+    {
+        stderrStream << "Tracing is supported only when processing a single session.\n";
+        return 2;
+    }
+
+    maxRunningProcesses = QThread::idealThreadCount();
+
+    if (parser.isSet(jobsOption))
+    {
+        bool convOk;
+        maxRunningProcesses = parser.value(jobsOption).toInt(&convOk);
+
+        if (!convOk || (maxRunningProcesses < 1))
+        {
+            stderrStream << "Invalid number of jobs.\n";
+            return 2;
+        }
+    }
+
+    parameters_ChildProcess << "--batch"
+                            << "--parameters" << parser.value(parametersOption)
+                            << "--outputs" << outputs.join(",")
+                            << "--output-dir" << parser.value(outputDirOption);
+
+    pendingSessions = sessions;
+    numOfFailedSessions = 0;
+
+    stdoutStream << "Processing " << sessions.count() << " sessions, max " << maxRunningProcesses << " in parallel.\n";
+    stdoutStream.flush();
+
+    startPendingProcesses();
+    eventLoop.exec();
+
+    stdoutStream << "Batch processing finished. Sessions processed: " << sessions.count() << ", failed: " << numOfFailedSessions << "\n";
+
+    return (numOfFailedSessions == 0) ? 0 : 1;
+}
+
+QStringList BatchRunner::getSessionBaseFileNames(const QString& sessionArgument)
+{
+    static const QString sessionFileEndings[] =
+    {
+        "_RoverA_RELPOSNED.ubx",
+        "_RoverB_RELPOSNED.ubx",
+        "_RoverC_RELPOSNED.ubx",
+        "_tags.tags",
+        ".distances",
+        ".lidar",
+        ".sync",
+        ".PPParameters",
+    };
+
+    QStringList baseFileNames;
+    QFileInfo fileInfo(sessionArgument);
+
+    if (fileInfo.isDir())
+    {
+        // Every session has at least rover A's RELPOSNED-data
+        QDir dir(sessionArgument);
+        QStringList fileNames = dir.entryList(QStringList("*" + sessionFileEndings[0]), QDir::Files, QDir::Name);
+
+        for (const QString& fileName : fileNames)
+        {
+            QString baseFileName = dir.filePath(fileName);
+            baseFileName.chop(sessionFileEndings[0].length());
+            baseFileNames.append(baseFileName);
+        }
+
+        return baseFileNames;
+    }
+
+    for (unsigned int i = 0; i < sizeof(sessionFileEndings) / sizeof(sessionFileEndings[0]); i++)
+    {
+        if (sessionArgument.endsWith(sessionFileEndings[i], Qt::CaseInsensitive))
+        {
+            QString baseFileName = sessionArgument;
+            baseFileName.chop(sessionFileEndings[i].length());
+            baseFileNames.append(baseFileName);
+            return baseFileNames;
+        }
+    }
+
+    baseFileNames.append(sessionArgument);
+    return baseFileNames;
+}
+
+void BatchRunner::startPendingProcesses(void)
+{
+    while ((runningProcesses.count() < maxRunningProcesses) && !pendingSessions.isEmpty())
+    {
+        QString session = pendingSessions.takeFirst();
+
+        QProcess* process = new QProcess(this);
+
+        // Child processes write their log lines (prefixed with session name) directly to our stdout/stderr
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->setProperty("session", session);
+
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, &BatchRunner::processFinished);
+
+        runningProcesses.append(process);
+        process->start(QCoreApplication::applicationFilePath(), QStringList(parameters_ChildProcess) << session);
+
+        if (!process->waitForStarted())
+        {
+            // finished-signal is not emitted if process never started
+            QTextStream stderrStream(stderr);
+            stderrStream << "Session \"" << session << "\" failed (can't start process: " << process->errorString() << ").\n";
+            numOfFailedSessions++;
+
+            runningProcesses.removeAll(process);
+            process->deleteLater();
+        }
+    }
+
+    if (runningProcesses.isEmpty())
+    {
+        eventLoop.quit();
+    }
+}
+
+void BatchRunner::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess* process = qobject_cast<QProcess*>(sender());
+
+    if ((exitStatus != QProcess::NormalExit) || (exitCode != 0))
+    {
+        QTextStream stderrStream(stderr);
+        stderrStream << "Session \"" << process->property("session").toString() << "\" failed (exit code " << exitCode << ").\n";
+        numOfFailedSessions++;
+    }
+
+    runningProcesses.removeAll(process);
+    process->deleteLater();
+
+    startPendingProcesses();
+}
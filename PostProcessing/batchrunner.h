@@ -0,0 +1,77 @@
+/*
+    batchrunner.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file batchrunner.h
+ * @brief Declaration for a class that runs post-processing from command line without user interaction.
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QProcess>
+#include <QList>
+#include <QEventLoop>
+
+/**
+ * @brief Class that runs post-processing for one or more logging sessions from command line.
+ *
+ * Usage: GNSS-Stylus --batch --parameters <file.PPParameters> --outputs <output1,output2,...>
+ * --output-dir <dir> [--jobs <n>] <session> [<session> ...]
+ *
+ * Session can be a base file name (like "path/20210101_120000"), any log file of the session
+ * (like "path/20210101_120000_RoverA_RELPOSNED.ubx") or a directory (all sessions found in it).
+ *
+ * Single session is processed in this process using PostProcessingForm::runBatch.
+ * Multiple sessions are processed in parallel child processes (one session per process),
+ * at most QThread::idealThreadCount() (or --jobs) at a time.
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchRunner(QObject *parent = nullptr);   //!< Constructor
+
+    static bool isBatchModeRequested(int argc, char *argv[]);  //!< Returns true if "--batch" is found from command line arguments
+
+    /**
+     * @brief Runs batch processing
+     * @param arguments Command line arguments (QCoreApplication::arguments())
+     * @return Exit code (0 = all sessions processed without errors, 1 = errors in processing, 2 = invalid arguments)
+     */
+    int run(const QStringList& arguments);
+
+private slots:
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    QStringList parameters_ChildProcess;    //!< Arguments passed to child processes (in addition to session)
+    QStringList pendingSessions;            //!< Sessions not yet started
+    QList<QProcess*> runningProcesses;
+    int maxRunningProcesses = 1;
+    int numOfFailedSessions = 0;
+    QEventLoop eventLoop;
+
+    QStringList getSessionBaseFileNames(const QString& sessionArgument);
+    void startPendingProcesses(void);
+};
+
+#endif // BATCHRUNNER_H
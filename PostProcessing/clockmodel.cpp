@@ -0,0 +1,391 @@
+/*
+    clockmodel.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file clockmodel.cpp
+ * @brief Definition for a piecewise-linear model between uptime and ITOW.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "clockmodel.h"
+
+/**
+ * @brief Incremental least squares line (uptime as a function of ITOW) for the segment being fitted
+ *
+ * Uses running means and co-moments relative to the first point to keep
+ * the numbers small (uptimes and ITOWs as such are too big for squaring in doubles).
+ */
+class ClockModel::SegmentFitter
+{
+public:
+    int numOfPoints = 0;
+    UBXMessage_RELPOSNED::ITOW firstITOW = -1;
+    UBXMessage_RELPOSNED::ITOW lastITOW = -1;
+
+    void add(const SyncPoint& point)
+    {
+        if (numOfPoints == 0)
+        {
+            firstITOW = point.iTOW;
+            firstUptime = point.uptime;
+        }
+
+        lastITOW = point.iTOW;
+
+        double x = point.iTOW - firstITOW;
+        double y = point.uptime - firstUptime;
+
+        numOfPoints++;
+
+        double dx = x - meanX;
+        meanX += dx / numOfPoints;
+        meanY += (y - meanY) / numOfPoints;
+        cxx += dx * (x - meanX);
+        cxy += dx * (y - meanY);
+    }
+
+    double getSlope(const int minSlopeSpan) const
+    {
+        if ((lastITOW - firstITOW < minSlopeSpan) || (cxx <= 0) || (cxy <= 0))
+        {
+            return 1;
+        }
+
+        return cxy / cxx;
+    }
+
+    double getUptime(const double iTOW, const int minSlopeSpan) const
+    {
+        return firstUptime + meanY + getSlope(minSlopeSpan) * ((iTOW - firstITOW) - meanX);
+    }
+
+private:
+    double firstUptime = 0;
+    double meanX = 0;
+    double meanY = 0;
+    double cxx = 0;
+    double cxy = 0;
+};
+
+ClockModel::ClockModel(const Settings& settings)
+{
+    this->settings = settings;
+}
+
+void ClockModel::clear(void)
+{
+    segments.clear();
+    segmentsByUptime.clear();
+}
+
+void ClockModel::fit(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers, const unsigned int minNumOfRovers)
+{
+    const unsigned int requiredNumOfRovers = qMax(1u, qMin(numOfRovers, minNumOfRovers));
+
+    // ITOWs are joined by walking all rovers' reverse sync-data in parallel (N-way merge),
+    // so the cost is linear in the number of rovers and sync items. Nothing is stored.
+    fitPoints([rovers, numOfRovers, requiredNumOfRovers](const std::function<void(const SyncPoint&)>& handlePoint)
+    {
+        QVector<QMap<UBXMessage_RELPOSNED::ITOW, qint64>::const_iterator> iTOWIterators(numOfRovers);
+
+        for (unsigned int i = 0; i < numOfRovers; i++)
+        {
+            iTOWIterators[i] = rovers[i].reverseSync.begin();
+        }
+
+        while (1)
+        {
+            // Lowest ITOW not yet handled
+            UBXMessage_RELPOSNED::ITOW currentITOW = -1;
+
+            for (unsigned int i = 0; i < numOfRovers; i++)
+            {
+                if ((iTOWIterators[i] != rovers[i].reverseSync.end()) &&
+                        ((currentITOW < 0) || (iTOWIterators[i].key() < currentITOW)))
+                {
+                    currentITOW = iTOWIterators[i].key();
+                }
+            }
+
+            if (currentITOW < 0)
+            {
+                break;
+            }
+
+            qint64 uptimeSum = 0;
+            unsigned int numberOfRoversWithSameITOW = 0;
+
+            for (unsigned int i = 0; i < numOfRovers; i++)
+            {
+                if ((iTOWIterators[i] != rovers[i].reverseSync.end()) &&
+                        (iTOWIterators[i].key() == currentITOW))
+                {
+                    uptimeSum += iTOWIterators[i].value();
+                    numberOfRoversWithSameITOW++;
+                    iTOWIterators[i]++;
+                }
+            }
+
+            if (numberOfRoversWithSameITOW >= requiredNumOfRovers)
+            {
+                SyncPoint point;
+                point.uptime = double(uptimeSum) / numberOfRoversWithSameITOW;
+                point.iTOW = currentITOW;
+                handlePoint(point);
+            }
+        }
+    });
+}
+
+void ClockModel::fit(const QVector<SyncPoint>& syncPoints)
+{
+    fitPoints([&syncPoints](const std::function<void(const SyncPoint&)>& handlePoint)
+    {
+        for (const SyncPoint& point : syncPoints)
+        {
+            handlePoint(point);
+        }
+    });
+}
+
+template <class ForEachSyncPoint> void ClockModel::fitPoints(const ForEachSyncPoint& forEachSyncPoint)
+{
+    clear();
+
+    // First pass: Find segments
+
+    SegmentFitter fitter;
+    QVector<SyncPoint> pendingPoints;
+
+    auto closeSegment = [this, &fitter]()
+    {
+        if (fitter.numOfPoints >= qMax(1, settings.minSegmentPoints))
+        {
+            Segment segment;
+            segment.firstITOW = fitter.firstITOW;
+            segment.lastITOW = fitter.lastITOW;
+            segment.slope = fitter.getSlope(settings.minSlopeSpan);
+            segment.offset = fitter.getUptime(fitter.firstITOW, settings.minSlopeSpan);
+            segment.lastUptime = segment.getUptime(segment.lastITOW);
+            segments.append(segment);
+        }
+
+        fitter = SegmentFitter();
+    };
+
+    std::function<void(const SyncPoint&)> addPoint = [this, &fitter, &pendingPoints, &closeSegment, &addPoint](const SyncPoint& point)
+    {
+        if ((fitter.numOfPoints == 0) ||
+                (fabs(point.uptime - fitter.getUptime(point.iTOW, settings.minSlopeSpan)) <= settings.maxResidual))
+        {
+            // Deviating points before this (if any) were outliers
+            fitter.add(point);
+            pendingPoints.clear();
+            return;
+        }
+
+        pendingPoints.append(point);
+
+        if (pendingPoints.count() >= qMax(1, settings.breakConfirmCount))
+        {
+            // Clock jumped -> Start a new segment from the deviating points.
+            // First of them is always accepted -> no further recursion.
+            closeSegment();
+
+            QVector<SyncPoint> restartPoints = pendingPoints;
+            pendingPoints.clear();
+
+            for (const SyncPoint& restartPoint : restartPoints)
+            {
+                addPoint(restartPoint);
+            }
+        }
+    };
+
+    forEachSyncPoint(addPoint);
+    closeSegment();
+
+    // Second pass: Residual statistics against the final lines.
+    // Points and segments are both in ITOW order.
+
+    QVector<double> sumsOfSquares(segments.count(), 0);
+    int segmentIndex = 0;
+
+    forEachSyncPoint([this, &sumsOfSquares, &segmentIndex](const SyncPoint& point)
+    {
+        while ((segmentIndex < segments.count()) && (point.iTOW > segments[segmentIndex].lastITOW))
+        {
+            segmentIndex++;
+        }
+
+        if ((segmentIndex >= segments.count()) || (point.iTOW < segments[segmentIndex].firstITOW))
+        {
+            // Dropped (between segments)
+            return;
+        }
+
+        Segment& segment = segments[segmentIndex];
+        double residual = point.uptime - segment.getUptime(point.iTOW);
+
+        if (fabs(residual) <= settings.maxResidual)
+        {
+            segment.numOfPoints++;
+            sumsOfSquares[segmentIndex] += residual * residual;
+            segment.maxAbsResidual = std::max(segment.maxAbsResidual, fabs(residual));
+        }
+        else
+        {
+            segment.numOfOutliers++;
+        }
+    });
+
+    for (int i = 0; i < segments.count(); i++)
+    {
+        if (segments[i].numOfPoints > 0)
+        {
+            segments[i].rmsResidual = sqrt(sumsOfSquares[i] / segments[i].numOfPoints);
+        }
+    }
+
+    segmentsByUptime.resize(segments.count());
+
+    for (int i = 0; i < segments.count(); i++)
+    {
+        segmentsByUptime[i] = i;
+    }
+
+    std::stable_sort(segmentsByUptime.begin(), segmentsByUptime.end(), [this](const int a, const int b)
+    {
+        return segments[a].offset < segments[b].offset;
+    });
+}
+
+int ClockModel::getSegmentIndex_Uptime(const double uptime) const
+{
+    if (segments.isEmpty())
+    {
+        return -1;
+    }
+
+    // First segment (in uptime order) beginning after uptime
+    auto nextIter = std::upper_bound(segmentsByUptime.begin(), segmentsByUptime.end(), uptime, [this](const double value, const int index)
+    {
+        return value < segments[index].offset;
+    });
+
+    if (nextIter == segmentsByUptime.begin())
+    {
+        return *nextIter;
+    }
+
+    int index = *(nextIter - 1);
+
+    if ((nextIter != segmentsByUptime.end()) && (uptime > segments[index].lastUptime) &&
+            (segments[*nextIter].offset - uptime < uptime - segments[index].lastUptime))
+    {
+        // In a gap, closer to the next segment
+        return *nextIter;
+    }
+
+    return index;
+}
+
+int ClockModel::getSegmentIndex_ITOW(const double iTOW) const
+{
+    if (segments.isEmpty())
+    {
+        return -1;
+    }
+
+    // First segment beginning after iTOW
+    auto nextIter = std::upper_bound(segments.begin(), segments.end(), iTOW, [](const double value, const Segment& segment)
+    {
+        return value < segment.firstITOW;
+    });
+
+    if (nextIter == segments.begin())
+    {
+        return 0;
+    }
+
+    int index = int(nextIter - segments.begin()) - 1;
+
+    if ((nextIter != segments.end()) && (iTOW > segments[index].lastITOW) &&
+            (nextIter->firstITOW - iTOW < iTOW - segments[index].lastITOW))
+    {
+        // In a gap, closer to the next segment
+        return index + 1;
+    }
+
+    return index;
+}
+
+double ClockModel::getITOW(const double uptime) const
+{
+    Q_ASSERT(!segments.isEmpty());
+
+    return segments[getSegmentIndex_Uptime(uptime)].getITOW(uptime);
+}
+
+double ClockModel::getUptime(const double iTOW) const
+{
+    Q_ASSERT(!segments.isEmpty());
+
+    return segments[getSegmentIndex_ITOW(iTOW)].getUptime(iTOW);
+}
+
+int ClockModel::getNumOfPoints(void) const
+{
+    int numOfPoints = 0;
+
+    for (const Segment& segment : segments)
+    {
+        numOfPoints += segment.numOfPoints;
+    }
+
+    return numOfPoints;
+}
+
+int ClockModel::getNumOfOutliers(void) const
+{
+    int numOfOutliers = 0;
+
+    for (const Segment& segment : segments)
+    {
+        numOfOutliers += segment.numOfOutliers;
+    }
+
+    return numOfOutliers;
+}
+
+double ClockModel::getRMSResidual(void) const
+{
+    double sumOfSquares = 0;
+    int numOfPoints = 0;
+
+    for (const Segment& segment : segments)
+    {
+        sumOfSquares += segment.rmsResidual * segment.rmsResidual * segment.numOfPoints;
+        numOfPoints += segment.numOfPoints;
+    }
+
+    return (numOfPoints > 0) ? sqrt(sumOfSquares / numOfPoints) : 0;
+}
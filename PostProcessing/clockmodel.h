@@ -0,0 +1,139 @@
+/*
+    clockmodel.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file clockmodel.h
+ * @brief Declaration for a piecewise-linear model between uptime and ITOW.
+ */
+
+#ifndef CLOCKMODEL_H
+#define CLOCKMODEL_H
+
+#include <QVector>
+
+#include "postprocessingform.h"
+
+/**
+ * @brief Piecewise-linear model between (averaged) rover uptimes and ITOWs
+ *
+ * Both clocks run at (nearly) the same rate, so instead of keeping a map item
+ * for every ITOW, sync data is fitted into linear segments (uptime = offset + slope * (ITOW - firstITOW)).
+ * Uptimes are the ones where the serial data was received, so they contain noise from buffering/batching.
+ * ITOWs are considered exact. Fitting therefore smooths out the noise.
+ *
+ * Fitting (sync points in ITOW order):
+ * - Point is accepted into the current segment if its residual (against the
+ *   least squares line of points accepted so far) is at most Settings::maxResidual.
+ *   Slope is fixed to 1 until the segment is long enough for a reliable estimate.
+ * - Deviating points are kept pending. If the next point fits again, they are outliers.
+ *   If Settings::breakConfirmCount consecutive points deviate, the segment is closed
+ *   and a new one started from the pending points (clock jump, restart etc.).
+ * - Segments with less than Settings::minSegmentPoints points are dropped.
+ * - Residual statistics are calculated against the final lines in a second pass.
+ *
+ * Memory usage depends only on the number of segments. Conversions find the segment
+ * using binary search over segments (constant time regarding the number of sync points)
+ * and don't change the model -> conversions are thread-safe.
+ */
+class ClockModel
+{
+public:
+    class Settings
+    {
+    public:
+        double maxResidual = 25;        //!< Max difference (ms) between a point's uptime and the line to accept it into the segment
+        int breakConfirmCount = 8;      //!< Number of consecutive deviating points starting a new segment
+        int minSegmentPoints = 3;       //!< Segments having less points are dropped
+        int minSlopeSpan = 10000;       //!< Segments (or beginnings of them) shorter than this (ITOW ms) use nominal slope (1)
+    };
+
+    class SyncPoint
+    {
+    public:
+        double uptime = 0;                          //!< Uptime (ms, may be an average)
+        UBXMessage_RELPOSNED::ITOW iTOW = -1;       //!< ITOW (ms)
+    };
+
+    class Segment
+    {
+    public:
+        UBXMessage_RELPOSNED::ITOW firstITOW = -1;  //!< First ITOW in segment
+        UBXMessage_RELPOSNED::ITOW lastITOW = -1;   //!< Last ITOW in segment
+        double offset = 0;                          //!< Uptime (ms) at firstITOW
+        double slope = 1;                           //!< Uptime ms per ITOW ms (1 + drift)
+        double lastUptime = 0;                      //!< Uptime (modelled) at lastITOW
+
+        int numOfPoints = 0;                        //!< Number of points within maxResidual
+        int numOfOutliers = 0;                      //!< Number of points in ITOW-range not within maxResidual
+        double rmsResidual = 0;                     //!< RMS of the residuals (ms) of the points within maxResidual
+        double maxAbsResidual = 0;                  //!< Max absolute residual (ms) of the points within maxResidual
+
+        double getUptime(const double iTOW) const { return offset + slope * (iTOW - firstITOW); }    //!< Uptime at iTOW
+        double getITOW(const double uptime) const { return firstITOW + (uptime - offset) / slope; }  //!< ITOW at uptime
+    };
+
+    ClockModel(void) {}                             //!< Constructor (default settings)
+    ClockModel(const Settings& settings);           //!< Constructor
+
+    /**
+     * @brief Fits the model into rovers' sync data
+     *
+     * Uptimes are averaged over rovers having sync data for the same ITOW (N-way merge of reverseSync-maps).
+     * @param rovers Rovers
+     * @param numOfRovers Number of rovers
+     * @param minNumOfRovers ITOWs with sync data for less rovers than this are left out (limited to numOfRovers)
+     */
+    void fit(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers,
+             const unsigned int minNumOfRovers = LOSolver::minNumOfPoints);
+
+    void fit(const QVector<SyncPoint>& syncPoints);     //!< Fits the model into sync points (in ITOW order)
+
+    void clear(void);                                   //!< Removes all segments
+
+    bool isEmpty(void) const { return segments.isEmpty(); }                 //!< Returns true if there are no segments
+    const QVector<Segment>& getSegments(void) const { return segments; }    //!< Returns segments in ITOW order
+
+    /**
+     * @brief Returns the segment used for uptime conversions
+     *
+     * The last segment beginning at or before uptime (or the next one if it's closer).
+     * @param uptime Uptime (ms)
+     * @return Index of the segment or -1 if model is empty
+     */
+    int getSegmentIndex_Uptime(const double uptime) const;
+
+    int getSegmentIndex_ITOW(const double iTOW) const;      //!< Same as getSegmentIndex_Uptime, but for ITOW conversions
+
+    double getITOW(const double uptime) const;      //!< Returns ITOW (ms) at uptime (extrapolated outside segments). Model must not be empty
+    double getUptime(const double iTOW) const;      //!< Returns uptime (ms) at ITOW (extrapolated outside segments). Model must not be empty
+
+    int getNumOfPoints(void) const;                 //!< Returns total number of points within maxResidual
+    int getNumOfOutliers(void) const;               //!< Returns total number of outliers
+    double getRMSResidual(void) const;              //!< Returns RMS of the residuals (ms) over all segments
+
+private:
+    class SegmentFitter;
+
+    Settings settings;
+    QVector<Segment> segments;          //!< In ITOW order
+    QVector<int> segmentsByUptime;      //!< Segment indices in uptime order
+
+    template <class ForEachSyncPoint> void fitPoints(const ForEachSyncPoint& forEachSyncPoint);
+};
+
+#endif // CLOCKMODEL_H
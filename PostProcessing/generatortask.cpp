@@ -0,0 +1,142 @@
+/*
+    generatortask.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file generatortask.cpp
+ * @brief Definition for a class that runs a generator in a worker thread.
+ */
+
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QEventLoop>
+
+#include "generatortask.h"
+
+GeneratorTask::GeneratorTask(QObject* parent) : QObject(parent)
+{
+    flushTimer.setInterval(flushInterval);
+    connect(&flushTimer, &QTimer::timeout, this, &GeneratorTask::flush);
+}
+
+bool GeneratorTask::run(const std::function<void(void)>& work)
+{
+    Q_ASSERT(!running);
+
+    running = true;
+    cancelRequested.storeRelease(0);
+    progress_Processed.storeRelease(0);
+    progress_Total.storeRelease(0);
+    lastEmittedProgress_Processed = -1;
+    lastEmittedProgress_Total = -1;
+
+    QEventLoop eventLoop;
+    QFutureWatcher<void> futureWatcher;
+
+    // Finished-signal is delivered through the event loop -> can't be missed even if work finishes before exec
+    connect(&futureWatcher, &QFutureWatcher<void>::finished, &eventLoop, &QEventLoop::quit);
+
+    flushTimer.start();
+    futureWatcher.setFuture(QtConcurrent::run(work));
+    eventLoop.exec();
+    flushTimer.stop();
+
+    if (!futureWatcher.isFinished())
+    {
+        // Event loop was exited from outside (QCoreApplication::exit exits all loops) -> stop the worker before returning
+        requestCancel();
+        futureWatcher.waitForFinished();
+    }
+
+    flush();
+
+    running = false;
+
+    return !isCancelRequested();
+}
+
+void GeneratorTask::setProgress(const qint64 processed, const qint64 total)
+{
+    progress_Total.storeRelease(total);
+    progress_Processed.storeRelease(processed);
+}
+
+void GeneratorTask::requestCancel(void)
+{
+    cancelRequested.storeRelease(1);
+}
+
+void GeneratorTask::addInfoMessage(const QString& message)
+{
+    addMessage(MESSAGETYPE_INFO, message);
+}
+
+void GeneratorTask::addWarningMessage(const QString& message)
+{
+    addMessage(MESSAGETYPE_WARNING, message);
+}
+
+void GeneratorTask::addErrorMessage(const QString& message)
+{
+    addMessage(MESSAGETYPE_ERROR, message);
+}
+
+void GeneratorTask::addMessage(const MessageType type, const QString& message)
+{
+    Message newMessage;
+    newMessage.type = type;
+    newMessage.text = message;
+
+    QMutexLocker locker(&messageMutex);
+    pendingMessages.append(newMessage);
+}
+
+void GeneratorTask::flush(void)
+{
+    QVector<Message> messages;
+
+    {
+        QMutexLocker locker(&messageMutex);
+        messages.swap(pendingMessages);
+    }
+
+    for (const Message& message : messages)
+    {
+        switch (message.type)
+        {
+        case MESSAGETYPE_INFO:
+            emit infoMessage(message.text);
+            break;
+        case MESSAGETYPE_WARNING:
+            emit warningMessage(message.text);
+            break;
+        case MESSAGETYPE_ERROR:
+            emit errorMessage(message.text);
+            break;
+        }
+    }
+
+    qint64 processed = progress_Processed.loadAcquire();
+    qint64 total = progress_Total.loadAcquire();
+
+    if ((processed != lastEmittedProgress_Processed) || (total != lastEmittedProgress_Total))
+    {
+        lastEmittedProgress_Processed = processed;
+        lastEmittedProgress_Total = total;
+        emit progressChanged(processed, total);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+    generatortask.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file generatortask.h
+ * @brief Declaration for a class that runs a generator in a worker thread.
+ */
+
+#ifndef GENERATORTASK_H
+#define GENERATORTASK_H
+
+#include <functional>
+
+#include <QObject>
+#include <QMutex>
+#include <QTimer>
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+/**
+ * @brief Runs a generator in a worker thread while caller's event loop keeps running
+ *
+ * Generators connect their info/warning/error-signals to add*Message-slots using
+ * Qt::DirectConnection. Messages are collected (thread-safely) and re-emitted in
+ * the caller's thread in batches every flushInterval ms, so that thousands of warnings
+ * don't flood the event queue.
+ *
+ * Generators report progress using setProgress and check isCancelRequested
+ * (once per round/segment) to stop early.
+ * Static helpers accept nullptr so that generators work without a task, too.
+ */
+class GeneratorTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GeneratorTask(QObject* parent = nullptr);  //!< Constructor
+
+    /**
+     * @brief Runs work in a worker thread and returns when it has finished
+     * @param work Function to run. Must not touch any widgets.
+     * @return false if cancel was requested during the run
+     *
+     * Events of the calling thread are processed while waiting (using a local event loop).
+     */
+    bool run(const std::function<void(void)>& work);
+
+    bool isRunning(void) const { return running; }     //!< Returns true while run is executing
+
+    void setProgress(const qint64 processed, const qint64 total);   //!< Sets progress (thread-safe)
+    bool isCancelRequested(void) const { return cancelRequested.loadAcquire() != 0; }  //!< Returns true if cancel was requested (thread-safe)
+
+    static void setProgress(GeneratorTask* task, const qint64 processed, const qint64 total) { if (task) task->setProgress(processed, total); }  //!< Sets progress if task is not nullptr
+    static bool isCancelRequested(const GeneratorTask* task) { return task && task->isCancelRequested(); }   //!< Returns true if task is not nullptr and cancel was requested
+
+    const int flushInterval = 100;      //!< Interval for emitting collected messages and progress (ms)
+
+public slots:
+    void requestCancel(void);                           //!< Requests worker to stop (thread-safe)
+
+    void addInfoMessage(const QString& message);        //!< Collects info message (thread-safe)
+    void addWarningMessage(const QString& message);     //!< Collects warning message (thread-safe)
+    void addErrorMessage(const QString& message);       //!< Collects error message (thread-safe)
+
+signals:
+    void infoMessage(const QString&);       //!< Collected info message (emitted in caller's thread)
+    void warningMessage(const QString&);    //!< Collected warning message (emitted in caller's thread)
+    void errorMessage(const QString&);      //!< Collected error message (emitted in caller's thread)
+
+    void progressChanged(const qint64 processed, const qint64 total);  //!< Emitted in caller's thread when progress has changed
+
+private:
+    enum MessageType
+    {
+        MESSAGETYPE_INFO = 0,
+        MESSAGETYPE_WARNING,
+        MESSAGETYPE_ERROR,
+    };
+
+    class Message
+    {
+    public:
+        MessageType type = MESSAGETYPE_INFO;
+        QString text;
+    };
+
+    QMutex messageMutex;
+    QVector<Message> pendingMessages;   //!< Protected by messageMutex
+
+    QAtomicInt cancelRequested;
+    QAtomicInteger<qint64> progress_Processed;
+    QAtomicInteger<qint64> progress_Total;
+    qint64 lastEmittedProgress_Processed = -1;
+    qint64 lastEmittedProgress_Total = -1;
+
+    bool running = false;
+    QTimer flushTimer;
+
+    void addMessage(const MessageType type, const QString& message);
+    void flush(void);   //!< Emits collected messages and changed progress
+};
+
+#endif // GENERATORTASK_H
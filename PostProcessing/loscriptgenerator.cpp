@@ -16,38 +16,19 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
-#include <QMessageBox>
-#include <QPushButton>
+#include <QSaveFile>
 
 #include "loscriptgenerator.h"
 
 
 void LOScriptGenerator::generateScript(const Params& params)
 {
-    QFile loScriptFile;
+    // Script is written into a temporary file that replaces the existing one (if any) only when committed.
+    // Asking whether to overwrite is caller's responsibility.
+    QSaveFile loScriptFile;
 
     loScriptFile.setFileName(params.fileName);
 
-    if (loScriptFile.exists())
-    {
-        QMessageBox msgBox;
-        msgBox.setText("File already exists.");
-        msgBox.setInformativeText("How to proceed?");
-
-        QPushButton *overwriteButton = msgBox.addButton(tr("Overwrite"), QMessageBox::ActionRole);
-        QPushButton *cancelButton = msgBox.addButton(QMessageBox::Cancel);
-
-        msgBox.setDefaultButton(cancelButton);
-
-        msgBox.exec();
-
-        if (msgBox.clickedButton() != overwriteButton)
-        {
-            emit infoMessage("Generating of location/orientation script cancelled.");
-            return;
-        }
-    }
-
     Eigen::Transform<double, 3, Eigen::Affine> transform_XYZToNED_NoTranslation;
     transform_XYZToNED_NoTranslation = (*params.transform_NEDToXYZ).linear().transpose();
 
@@ -88,13 +69,32 @@ void LOScriptGenerator::generateScript(const Params& params)
 
     unsigned int itemCount = 0;
 
+    // Number of rovers that must have data for the same ITOW
+    const unsigned int minNumOfRovers = qMin(params.numOfRovers, (unsigned int)LOSolver::minNumOfPoints);
+
     UBXMessage_RELPOSNED::ITOW iTOWMismatchStart = -1;
     unsigned int iTOWMismatchCount = 0;
 
     unsigned int warningCount = 0;
 
+    UBXMessage_RELPOSNED::ITOW progress_LastITOW = params.iTOWRange_Script_Min;
+
+    if (!params.rovers[0].relposnedMessages.isEmpty())
+    {
+        progress_LastITOW = qBound(params.iTOWRange_Script_Min, params.rovers[0].relposnedMessages.lastKey(), params.iTOWRange_Script_Max);
+    }
+
     while (currentITOW <= params.iTOWRange_Script_Max)
     {
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            // loScriptFile not committed -> discarded
+            emit warningMessage("Generating of location/orientation script cancelled. File \"" + params.fileName + "\" not written.");
+            return;
+        }
+
+        GeneratorTask::setProgress(params.task, qMin(currentITOW, progress_LastITOW) - params.iTOWRange_Script_Min, progress_LastITOW - params.iTOWRange_Script_Min);
+
         if (warningCount >= 1000)
         {
             emit errorMessage("Maximum number of warnings (1000) reached. "
@@ -104,49 +104,39 @@ void LOScriptGenerator::generateScript(const Params& params)
             break;
         }
 
-        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator relposIterators[3];
-
-        relposIterators[0] = params.rovers[0].relposnedMessages.lowerBound(currentITOW);
-        relposIterators[1] = params.rovers[1].relposnedMessages.lowerBound(currentITOW);
-        relposIterators[2] = params.rovers[2].relposnedMessages.lowerBound(currentITOW);
+        // Lowest next ITOW of all rovers and the number of rovers having it.
+        // Rovers without data for it are left out as long as enough of them remain.
 
-        bool endOfData = false;
+        UBXMessage_RELPOSNED::ITOW lowestNextRoverITOW = -1;
+        unsigned int numOfRoversWithData = 0;
 
-        for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int i = 0; i < params.numOfRovers; i++)
         {
-            if (relposIterators[i] == params.rovers[i].relposnedMessages.end())
+            auto relposIterator = params.rovers[i].relposnedMessages.lowerBound(currentITOW);
+
+            if (relposIterator == params.rovers[i].relposnedMessages.end())
             {
-                // No more data
-                endOfData = true;
+                continue;
             }
-        }
 
-        if (endOfData)
-        {
-            break;
-        }
-
-        UBXMessage_RELPOSNED::ITOW lowestNextRoverITOW = 1e9;
+            numOfRoversWithData++;
 
-        for (unsigned int i = 0; i < 3; i++)
-        {
-            if (relposIterators[i].value().iTOW < lowestNextRoverITOW)
+            if ((lowestNextRoverITOW < 0) || (relposIterator.value().iTOW < lowestNextRoverITOW))
             {
-                lowestNextRoverITOW = relposIterators[i].value().iTOW;
+                lowestNextRoverITOW = relposIterator.value().iTOW;
             }
         }
 
-        bool roverITOWSInSync = true;
-
-        for (unsigned int i = 0; i < 3; i++)
+        if (numOfRoversWithData < minNumOfRovers)
         {
-            if (relposIterators[i].value().iTOW != lowestNextRoverITOW)
-            {
-                roverITOWSInSync = false;
-            }
+            // No more data
+            break;
         }
 
-        if (!roverITOWSInSync)
+        QVector<Eigen::Vector3d> points;
+        QVector<bool> pointValidity;
+
+        if (PostProcessingForm::LOInterpolator::getRoverPoints(params.rovers, params.numOfRovers, lowestNextRoverITOW, points, pointValidity) < int(minNumOfRovers))
         {
             if (iTOWMismatchCount == 0)
             {
@@ -173,14 +163,7 @@ void LOScriptGenerator::generateScript(const Params& params)
             warningCount++;
         }
 
-        Eigen::Vector3d points[3];
-
-        for (unsigned int i = 0; i < 3; i++)
-        {
-            points[i] = Eigen::Vector3d(relposIterators[i].value().relPosN, relposIterators[i].value().relPosE, relposIterators[i].value().relPosD);
-        }
-
-        if (!params.loSolver->setPoints(points))
+        if (!params.loSolver->setPoints(points, pointValidity))
         {
             emit warningMessage("Error setting points. ITOW: \"" +
                        QString::number(lowestNextRoverITOW) +
@@ -211,13 +194,20 @@ void LOScriptGenerator::generateScript(const Params& params)
         if (params.timeStampFormat == Params::TimeStampFormat::TSF_UPTIME)
         {
             qint64 timeSum = 0;
+            qint64 numOfTimes = 0;
             bool fail = false;
 
-            for (int i = 0; i < 3; i++)
+            for (unsigned int i = 0; i < params.numOfRovers; i++)
             {
+                if (!pointValidity[i])
+                {
+                    continue;
+                }
+
                 if (params.rovers[i].reverseSync.find(lowestNextRoverITOW) != params.rovers[i].reverseSync.end())
                 {
                     timeSum += params.rovers[i].reverseSync.find(lowestNextRoverITOW).value();
+                    numOfTimes++;
                 }
                 else
                 {
@@ -234,7 +224,10 @@ void LOScriptGenerator::generateScript(const Params& params)
                 warningCount++;
             }
 
-            timeSum /= 3;
+            if (numOfTimes != 0)
+            {
+                timeSum /= numOfTimes;
+            }
 
             timeString = QString::number(timeSum);
         }
@@ -280,5 +273,13 @@ void LOScriptGenerator::generateScript(const Params& params)
         warningCount++;
     }
 
+    textStream.flush();
+
+    if (!loScriptFile.commit())
+    {
+        emit errorMessage("Writing location/orientation script file failed: " + loScriptFile.errorString());
+        return;
+    }
+
     emit infoMessage("Location/orientation script generated. Number of rows: " + QString::number(itemCount));
 }
@@ -22,6 +22,7 @@
 #include <QObject>
 
 #include "postprocessingform.h"
+#include "generatortask.h"
 
 class LOScriptGenerator : public QObject
 {
@@ -49,6 +50,9 @@ public:
         LOSolver* loSolver;
 
         const PostProcessingForm::Rover* rovers = nullptr;
+
+        unsigned int numOfRovers = 3;                   //!< Number of items in rovers
+        GeneratorTask* task = nullptr;      //!< Progress reporting and cancellation (optional)
     };
 
     void generateScript(const Params& params);
@@ -0,0 +1,178 @@
+/*
+    pipelinecache.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file pipelinecache.cpp
+ * @brief Definition for a class that keeps intermediate post-processing results between generator runs.
+ */
+
+#include <QtConcurrent>
+
+#include "pipelinecache.h"
+
+void PipelineCache::invalidateRoverData(void)
+{
+    clockModelValid = false;
+    clockModel.clear();
+
+    poseTableValid = false;
+    poseTable.clear();
+}
+
+void PipelineCache::invalidateLidarData(void)
+{
+    processedRoundCache.clear();
+}
+
+void PipelineCache::invalidateTagData(void)
+{
+    tagSegmentIndexValid = false;
+    tagSegmentIndex = TagSegmentIndex();
+}
+
+void PipelineCache::clear(void)
+{
+    invalidateRoverData();
+    invalidateLidarData();
+    invalidateTagData();
+}
+
+const ClockModel& PipelineCache::getClockModel(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers)
+{
+    if (!clockModelValid)
+    {
+        clockModel.fit(rovers, numOfRovers);
+        clockModelValid = true;
+    }
+
+    return clockModel;
+}
+
+const TagSegmentIndex& PipelineCache::getTagSegmentIndex(const QMultiMap<qint64, PostProcessingForm::Tag>& tags,
+                                                         const QString& tagIdent_BeginNewObject,
+                                                         const QString& tagIdent_BeginPoints,
+                                                         const QString& tagIdent_EndPoints)
+{
+    if ((!tagSegmentIndexValid) || (!tagSegmentIndex.isBuiltWith(tagIdent_BeginNewObject, tagIdent_BeginPoints, tagIdent_EndPoints)))
+    {
+        tagSegmentIndex.build(tags, tagIdent_BeginNewObject, tagIdent_BeginPoints, tagIdent_EndPoints);
+        tagSegmentIndexValid = true;
+    }
+
+    return tagSegmentIndex;
+}
+
+const QMap<UBXMessage_RELPOSNED::ITOW, PostProcessingForm::LOInterpolator::Pose>& PipelineCache::getPoseTable(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers, const LOSolver& loSolver)
+{
+    QVector<Eigen::Vector3d> refPoints;
+    loSolver.getReferencePoints(refPoints);
+
+    QByteArray newPoseTableKey;
+
+    newPoseTableKey.append(reinterpret_cast<const char*>(&numOfRovers), sizeof(numOfRovers));
+
+    for (const Eigen::Vector3d& refPoint : refPoints)
+    {
+        newPoseTableKey.append(reinterpret_cast<const char*>(refPoint.data()), 3 * sizeof(double));
+    }
+
+    if (poseTableValid && (newPoseTableKey == poseTableKey))
+    {
+        return poseTable;
+    }
+
+    // Points of all epochs in one array (numOfRovers points per epoch) for LOSolver::solveBatch
+    QVector<UBXMessage_RELPOSNED::ITOW> iTOWs;
+    QVector<Eigen::Vector3d> points;
+    QVector<bool> validity;
+
+    QVector<Eigen::Vector3d> epochPoints;
+    QVector<bool> epochValidity;
+
+    const unsigned int minNumOfRovers = qMin(numOfRovers, (unsigned int)LOSolver::minNumOfPoints);
+
+    // Same ITOWs LOInterpolator interpolates between without table
+    // (epochs without enough valid points fail in solveBatch the same way as when solved by LOInterpolator)
+    UBXMessage_RELPOSNED::ITOW iTOW = PostProcessingForm::LOInterpolator::findNextCommonITOW(rovers, numOfRovers, minNumOfRovers, 0);
+
+    while (iTOW >= 0)
+    {
+        // Same lookup as in LOInterpolator
+        PostProcessingForm::LOInterpolator::getRoverPoints(rovers, numOfRovers, iTOW, epochPoints, epochValidity);
+
+        iTOWs.append(iTOW);
+        points.append(epochPoints);
+        validity.append(epochValidity);
+
+        iTOW = PostProcessingForm::LOInterpolator::findNextCommonITOW(rovers, numOfRovers, minNumOfRovers, iTOW + 1);
+    }
+
+    const int numOfEpochs = iTOWs.count();
+
+    QVector<Eigen::Transform<double, 3, Eigen::Affine>> transforms(numOfEpochs);
+    QVector<LOSolver::ErrorCode> errorCodes(numOfEpochs);
+
+    // Epochs are solved in chunks to keep per-task overhead small.
+    // solveBatch doesn't change the solver's state so the same solver can be used in all threads.
+    const int epochsPerChunk = 1024;
+
+    QVector<int> chunkStartEpochs;
+
+    for (int epoch = 0; epoch < numOfEpochs; epoch += epochsPerChunk)
+    {
+        chunkStartEpochs.append(epoch);
+    }
+
+    QtConcurrent::blockingMap(chunkStartEpochs, [&](const int& firstEpoch)
+    {
+        loSolver.solveBatch(points, validity, firstEpoch, qMin(epochsPerChunk, numOfEpochs - firstEpoch),
+                            transforms, errorCodes);
+    });
+
+    poseTable.clear();
+
+    for (int epoch = 0; epoch < numOfEpochs; epoch++)
+    {
+        PostProcessingForm::LOInterpolator::Pose pose;
+
+        switch (errorCodes[epoch])
+        {
+        case LOSolver::ERROR_NONE:
+            pose.location = transforms[epoch].translation();
+            pose.orientation = transforms[epoch].linear();
+            break;
+
+        case LOSolver::ERROR_NOT_ENOUGH_POINTS:
+            pose.status = PostProcessingForm::LOInterpolator::Pose::STATUS_ERROR_SETPOINTS;
+            pose.errorCode = errorCodes[epoch];
+            break;
+
+        default:
+            pose.status = PostProcessingForm::LOInterpolator::Pose::STATUS_ERROR_TRANSFORMMATRIX;
+            pose.errorCode = errorCodes[epoch];
+            break;
+        }
+
+        poseTable.insert(iTOWs[epoch], pose);
+    }
+
+    poseTableKey = newPoseTableKey;
+    poseTableValid = true;
+
+    return poseTable;
+}
@@ -0,0 +1,103 @@
+/*
+    pipelinecache.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file pipelinecache.h
+ * @brief Declaration for a class that keeps intermediate post-processing results between generator runs.
+ */
+
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include "postprocessingform.h"
+#include "Lidar/processedroundcache.h"
+#include "tagsegmentindex.h"
+#include "clockmodel.h"
+
+/**
+ * @brief Keeps intermediate post-processing results between generator runs
+ *
+ * Stages cached:
+ * - Clock model between rover uptimes and ITOWs (depends on rover data)
+ * - Pose table: LOSolver's location/orientation at every ITOW having RELPOSNED-data for enough rovers
+ *   (depends on rover data and LOSolver's reference points)
+ * - Tag/segment index (depends on tags and tag identifiers)
+ * - Filtered and transformed lidar rounds (depends on lidar data, filtering settings
+ *   and lidar transforms, see Lidar::ProcessedRoundCache)
+ *
+ * Changes in settings are detected here by comparing the inputs, changes in loaded data
+ * must be told using invalidateRoverData/invalidateLidarData/invalidateTagData.
+ * Outputs of generators are not cached (they are always written again).
+ */
+class PipelineCache
+{
+public:
+    void invalidateRoverData(void);     //!< Drops results depending on rovers' RELPOSNED- or sync-data
+    void invalidateLidarData(void);     //!< Drops results depending on lidar rounds
+    void invalidateTagData(void);       //!< Drops results depending on tags
+    void clear(void);                   //!< Drops everything
+
+    /**
+     * @brief Returns clock model fitted into rovers' sync data (see ClockModel::fit)
+     * @param rovers Rovers (must be the same every time unless invalidateRoverData is called)
+     * @param numOfRovers Number of rovers
+     * @return Clock model. Reference is valid until rover data is invalidated.
+     */
+    const ClockModel& getClockModel(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers);
+
+    /**
+     * @brief Returns poses at every ITOW having RELPOSNED-data for enough rovers (see PostProcessingForm::LOInterpolator::poseTable)
+     *
+     * Epochs are solved in parallel chunks using LOSolver::solveBatch.
+     * @param rovers Rovers (must be the same every time unless invalidateRoverData is called)
+     * @param numOfRovers Number of rovers (same as the number of loSolver's reference points)
+     * @param loSolver Solver with reference points set
+     * @return Pose table. Reference is valid until rover data is invalidated or table is requested with different reference points.
+     */
+    const QMap<UBXMessage_RELPOSNED::ITOW, PostProcessingForm::LOInterpolator::Pose>& getPoseTable(const PostProcessingForm::Rover* rovers, const unsigned int numOfRovers, const LOSolver& loSolver);
+
+    /**
+     * @brief Returns tags interpreted as objects/segments (see TagSegmentIndex)
+     * @param tags Tags (must be the same every time unless invalidateTagData is called)
+     * @param tagIdent_BeginNewObject Identifier of "new object"-tags
+     * @param tagIdent_BeginPoints Identifier of beginning tags
+     * @param tagIdent_EndPoints Identifier of ending tags
+     * @return Index. Reference is valid until tag data is invalidated or index is requested with different identifiers.
+     */
+    const TagSegmentIndex& getTagSegmentIndex(const QMultiMap<qint64, PostProcessingForm::Tag>& tags,
+                                              const QString& tagIdent_BeginNewObject,
+                                              const QString& tagIdent_BeginPoints,
+                                              const QString& tagIdent_EndPoints);
+
+    Lidar::ProcessedRoundCache* getProcessedRoundCache(void) { return &processedRoundCache; }   //!< Filtered/transformed lidar rounds (see Lidar::ProcessedRoundCache)
+
+private:
+    bool clockModelValid = false;
+    ClockModel clockModel;
+
+    bool poseTableValid = false;
+    QByteArray poseTableKey;            //!< Number of rovers and raw bytes of LOSolver's reference points used for poseTable
+    QMap<UBXMessage_RELPOSNED::ITOW, PostProcessingForm::LOInterpolator::Pose> poseTable;
+
+    bool tagSegmentIndexValid = false;
+    TagSegmentIndex tagSegmentIndex;
+
+    Lidar::ProcessedRoundCache processedRoundCache;
+};
+
+#endif // PIPELINECACHE_H
@@ -17,6 +17,7 @@
 */
 
 #include <memory>
+#include <algorithm>
 #include <math.h>
 
 #include <QTime>
@@ -31,7 +32,13 @@
 #include "Lidar/pointcloudgeneratorlidar.h"
 #include "loscriptgenerator.h"
 #include "Lidar/lidarscriptgenerator.h"
+#include "Lidar/timeshiftcalibrator.h"
 #include "rastercameragenerator.h"
+#include "pipelinecache.h"
+#include "clockmodel.h"
+#include "textlogreader.h"
+#include "generatortask.h"
+#include "../tracer.h"
 
 struct
 {
@@ -84,6 +91,8 @@ void PostProcessingForm::loadParametersFromQSettings(QSettings& settings)
     ui->doubleSpinBox_StylusTipDistanceFromRoverA_Correction->setValue(settings.value("PostProcessing_StylusTipDistanceFromRoverA_Correction", ui->doubleSpinBox_StylusTipDistanceFromRoverA_Correction->value()).toDouble());
 
     ui->spinBox_Lidar_TimeShift->setValue(settings.value("PostProcessing_Lidar_TimeShift", ui->spinBox_Lidar_TimeShift->value()).toInt());
+    ui->spinBox_Lidar_TimeShiftCalibration_Range->setValue(settings.value("PostProcessing_Lidar_TimeShiftCalibration_Range", ui->spinBox_Lidar_TimeShiftCalibration_Range->value()).toInt());
+    ui->doubleSpinBox_Lidar_TimeShiftCalibration_CellSize->setValue(settings.value("PostProcessing_Lidar_TimeShiftCalibration_CellSize", ui->doubleSpinBox_Lidar_TimeShiftCalibration_CellSize->value()).toDouble());
 
     ui->doubleSpinBox_Lidar_Filtering_StartAngle->setValue(settings.value("PostProcessing_Lidar_Filtering_StartAngle", ui->doubleSpinBox_Lidar_Filtering_StartAngle->value()).toDouble());
     ui->doubleSpinBox_Lidar_Filtering_EndAngle->setValue(settings.value("PostProcessing_Lidar_Filtering_EndAngle", ui->doubleSpinBox_Lidar_Filtering_EndAngle->value()).toDouble());
@@ -99,7 +108,9 @@ void PostProcessingForm::loadParametersFromQSettings(QSettings& settings)
     ui->doubleSpinBox_Lidar_BoundingSphere_Center_D->setValue(settings.value("PostProcessing_Lidar_BoundingSphere_Center_D", ui->doubleSpinBox_Lidar_BoundingSphere_Center_D->value()).toDouble());
     ui->doubleSpinBox_Lidar_BoundingSphere_Radius->setValue(settings.value("PostProcessing_Lidar_BoundingSphere_Radius", ui->doubleSpinBox_Lidar_BoundingSphere_Radius->value()).toDouble());
 
-    for (int row = 0; row < 3; row++)
+    ui->spinBox_NumOfAntennas_LOSolver->setValue(settings.value("PostProcessing_NumOfAntennas", ui->spinBox_NumOfAntennas_LOSolver->value()).toInt());
+
+    for (int row = 0; row < ui->tableWidget_AntennaLocations_LOSolver->rowCount(); row++)
     {
         for (int column = 0; column < 3; column++)
         {
@@ -168,6 +179,13 @@ void PostProcessingForm::loadParametersFromQSettings(QSettings& settings)
     ui->checkBox_Lidar_PointCloud_IncludeNormals->setChecked(settings.value("PostProcessing_Lidar_PointCloud_IncludeNormals", ui->checkBox_Lidar_PointCloud_IncludeNormals->isChecked()).toBool());
     ui->checkBox_Lidar_PointCloud_NormalLengthsAsQuality->setChecked(settings.value("PostProcessing_Lidar_PointCloud_NormalLengthAsQuality", ui->checkBox_Lidar_PointCloud_NormalLengthsAsQuality->isChecked()).toBool());
     ui->checkBox_Lidar_PointCloud_SeparateOutputFilesForSubScans->setChecked(settings.value("PostProcessing_Lidar_PointCloud_SeparateOutputFilesForSubScans", ui->checkBox_Lidar_PointCloud_SeparateOutputFilesForSubScans->isChecked()).toBool());
+    ui->checkBox_Lidar_PointCloud_VoxelGridFiltering->setChecked(settings.value("PostProcessing_Lidar_PointCloud_VoxelGridFiltering", ui->checkBox_Lidar_PointCloud_VoxelGridFiltering->isChecked()).toBool());
+    ui->doubleSpinBox_Lidar_PointCloud_VoxelGrid_CellSize->setValue(settings.value("PostProcessing_Lidar_PointCloud_VoxelGrid_CellSize", ui->doubleSpinBox_Lidar_PointCloud_VoxelGrid_CellSize->value()).toDouble());
+    ui->comboBox_Lidar_PointCloud_VoxelGrid_Mode->setCurrentIndex(settings.value("PostProcessing_Lidar_PointCloud_VoxelGrid_Mode", ui->comboBox_Lidar_PointCloud_VoxelGrid_Mode->currentIndex()).toInt());
+    ui->checkBox_Lidar_PointCloud_TiledOutput->setChecked(settings.value("PostProcessing_Lidar_PointCloud_TiledOutput", ui->checkBox_Lidar_PointCloud_TiledOutput->isChecked()).toBool());
+    ui->doubleSpinBox_Lidar_PointCloud_Tiled_TileSize->setValue(settings.value("PostProcessing_Lidar_PointCloud_Tiled_TileSize", ui->doubleSpinBox_Lidar_PointCloud_Tiled_TileSize->value()).toDouble());
+    ui->spinBox_Lidar_PointCloud_Tiled_MaxDepth->setValue(settings.value("PostProcessing_Lidar_PointCloud_Tiled_MaxDepth", ui->spinBox_Lidar_PointCloud_Tiled_MaxDepth->value()).toInt());
+    ui->spinBox_Lidar_PointCloud_Tiled_GridResolution->setValue(settings.value("PostProcessing_Lidar_PointCloud_Tiled_GridResolution", ui->spinBox_Lidar_PointCloud_Tiled_GridResolution->value()).toInt());
 
 
     ui->lineEdit_Lidar_Script_UptimeRange_Min->setText(settings.value("PostProcessing_Lidar_Script_Uptime_Min", ui->lineEdit_Lidar_Script_UptimeRange_Min->text()).toString());
@@ -185,11 +203,33 @@ PostProcessingForm::PostProcessingForm(QWidget *parent) :
 {
     ui->setupUi(this);
 
+    pipelineCache = new PipelineCache();
+
+    // valueChanged is not emitted if the loaded value equals the default -> set explicitly
+    setNumOfRovers(ui->spinBox_NumOfAntennas_LOSolver->value());
+
+    generatorTask = new GeneratorTask(this);
+
+    connect(generatorTask, &GeneratorTask::infoMessage, this, &PostProcessingForm::on_infoMessage);
+    connect(generatorTask, &GeneratorTask::warningMessage, this, &PostProcessingForm::on_warningMessage);
+    connect(generatorTask, &GeneratorTask::errorMessage, this, &PostProcessingForm::on_errorMessage);
+    connect(generatorTask, &GeneratorTask::progressChanged, this, &PostProcessingForm::generatorTask_ProgressChanged);
+
     QSettings settings;
 
     loadParametersFromQSettings(settings);
 
+    // Categories in the same order as LogCategory
+    ui->logView_Log->addCategory("Info");
+    ui->logView_Log->addCategory("Warnings");
+    ui->logView_Log->addCategory("Errors");
+
+    connect(ui->logView_Log, &LogView::countersChanged, this, &PostProcessingForm::logView_CountersChanged);
+
     ui->spinBox_MaxLogLines->setValue(settings.value("PostProcessing_MaxLogLines", ui->spinBox_MaxLogLines->value()).toInt());
+    ui->logView_Log->getModel()->setMaxLines(ui->spinBox_MaxLogLines->value());
+
+    logEventProcessingTimer.start();
 }
 
 
@@ -209,6 +249,8 @@ void PostProcessingForm::saveParametersToQSettings(QSettings& settings)
     settings.setValue("PostProcessing_StylusTipDistanceFromRoverA_Correction", ui->doubleSpinBox_StylusTipDistanceFromRoverA_Correction->value());
 
     settings.setValue("PostProcessing_Lidar_TimeShift", ui->spinBox_Lidar_TimeShift->value());
+    settings.setValue("PostProcessing_Lidar_TimeShiftCalibration_Range", ui->spinBox_Lidar_TimeShiftCalibration_Range->value());
+    settings.setValue("PostProcessing_Lidar_TimeShiftCalibration_CellSize", ui->doubleSpinBox_Lidar_TimeShiftCalibration_CellSize->value());
 
     settings.setValue("PostProcessing_Lidar_Filtering_StartAngle", ui->doubleSpinBox_Lidar_Filtering_StartAngle->value());
     settings.setValue("PostProcessing_Lidar_Filtering_EndAngle", ui->doubleSpinBox_Lidar_Filtering_EndAngle->value());
@@ -224,7 +266,9 @@ void PostProcessingForm::saveParametersToQSettings(QSettings& settings)
     settings.setValue("PostProcessing_Lidar_BoundingSphere_Center_D", ui->doubleSpinBox_Lidar_BoundingSphere_Center_D->value());
     settings.setValue("PostProcessing_Lidar_BoundingSphere_Radius", ui->doubleSpinBox_Lidar_BoundingSphere_Radius->value());
 
-    for (int row = 0; row < 3; row++)
+    settings.setValue("PostProcessing_NumOfAntennas", ui->spinBox_NumOfAntennas_LOSolver->value());
+
+    for (int row = 0; row < ui->tableWidget_AntennaLocations_LOSolver->rowCount(); row++)
     {
         for (int column = 0; column < 3; column++)
         {
@@ -290,6 +334,13 @@ void PostProcessingForm::saveParametersToQSettings(QSettings& settings)
     settings.setValue("PostProcessing_Lidar_PointCloud_IncludeNormals", ui->checkBox_Lidar_PointCloud_IncludeNormals->checkState() == Qt::Checked);
     settings.setValue("PostProcessing_Lidar_PointCloud_NormalLengthAsQuality", ui->checkBox_Lidar_PointCloud_NormalLengthsAsQuality->checkState() == Qt::Checked);
     settings.setValue("PostProcessing_Lidar_PointCloud_SeparateOutputFilesForSubScans", ui->checkBox_Lidar_PointCloud_SeparateOutputFilesForSubScans->checkState() == Qt::Checked);
+    settings.setValue("PostProcessing_Lidar_PointCloud_VoxelGridFiltering", ui->checkBox_Lidar_PointCloud_VoxelGridFiltering->checkState() == Qt::Checked);
+    settings.setValue("PostProcessing_Lidar_PointCloud_VoxelGrid_CellSize", ui->doubleSpinBox_Lidar_PointCloud_VoxelGrid_CellSize->value());
+    settings.setValue("PostProcessing_Lidar_PointCloud_VoxelGrid_Mode", ui->comboBox_Lidar_PointCloud_VoxelGrid_Mode->currentIndex());
+    settings.setValue("PostProcessing_Lidar_PointCloud_TiledOutput", ui->checkBox_Lidar_PointCloud_TiledOutput->checkState() == Qt::Checked);
+    settings.setValue("PostProcessing_Lidar_PointCloud_Tiled_TileSize", ui->doubleSpinBox_Lidar_PointCloud_Tiled_TileSize->value());
+    settings.setValue("PostProcessing_Lidar_PointCloud_Tiled_MaxDepth", ui->spinBox_Lidar_PointCloud_Tiled_MaxDepth->value());
+    settings.setValue("PostProcessing_Lidar_PointCloud_Tiled_GridResolution", ui->spinBox_Lidar_PointCloud_Tiled_GridResolution->value());
 
 
     settings.setValue("PostProcessing_Lidar_Script_Uptime_Min", ui->lineEdit_Lidar_Script_UptimeRange_Min->text());
@@ -302,6 +353,14 @@ void PostProcessingForm::saveParametersToQSettings(QSettings& settings)
 
 PostProcessingForm::~PostProcessingForm()
 {
+    if (batchMode)
+    {
+        // Parameters used in batch mode come from a file -> don't let them overwrite the interactive settings
+        delete pipelineCache;
+        delete ui;
+        return;
+    }
+
     QSettings settings;
 
     saveParametersToQSettings(settings);
@@ -330,6 +389,7 @@ PostProcessingForm::~PostProcessingForm()
     settings.setValue("PostProcessing_Directory_Dialog_RasterCameraScript_Load", fileDialog_RasterCameraScript_Load.directory().path());
     settings.setValue("PostProcessing_Directory_Dialog_RasterCameraScript_Save", fileDialog_RasterCameraScript_Save.directory().path());
 
+    delete pipelineCache;
     delete ui;
 }
 
@@ -550,33 +610,86 @@ void PostProcessingForm::showEvent(QShowEvent* event)
 
 void PostProcessingForm::addLogLine(const QString& line)
 {
-    QTime currentTime = QTime::currentTime();
+    LogCategory category = LOGCATEGORY_INFO;
+
+    if (line.startsWith("Error"))
+    {
+        errorCount++;
+        category = LOGCATEGORY_ERROR;
+    }
+    else if (line.startsWith("Warning"))
+    {
+        category = LOGCATEGORY_WARNING;
+    }
+
+    ui->logView_Log->addLine(line, category);
+
+    if (batchMode)
+    {
+        QString timeString = QTime::currentTime().toString("hh:mm:ss:zzz");
+
+        QTextStream stdoutStream(stdout);
+        stdoutStream << timeString << ": " << batchSessionName << ": " << line << "\n";
+    }
+
+    // Generators may log thousands of lines -> don't process events for every line.
+    // Log view itself is updated in batches (see LogView::flushInterval).
+    if (!logEventProcessingTimer.isValid() || (logEventProcessingTimer.elapsed() >= 20))
+    {
+        QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        logEventProcessingTimer.start();
+    }
+}
+
+void PostProcessingForm::on_spinBox_MaxLogLines_valueChanged(int arg1)
+{
+    ui->logView_Log->getModel()->setMaxLines(arg1);
+}
+
+void PostProcessingForm::on_checkBox_PauseLog_stateChanged(int arg1)
+{
+    ui->logView_Log->setPaused(arg1 == Qt::Checked);
+}
+
+void PostProcessingForm::on_lineEdit_LogFilter_textChanged(const QString& arg1)
+{
+    ui->logView_Log->getModel()->setFilterText(arg1);
+}
 
-    QString timeString = currentTime.toString("hh:mm:ss:zzz");
+void PostProcessingForm::logView_CountersChanged(void)
+{
+    const LogModel* model = ui->logView_Log->getModel();
+
+    QString counters;
+
+    for (int i = 0; i < model->getNumOfCategories(); i++)
+    {
+        counters += model->getCategoryName(i) + ": " + QString::number(model->getCategoryCount(i)) + ", ";
+    }
 
-    ui->plainTextEdit_Log->setMaximumBlockCount(ui->spinBox_MaxLogLines->value());
-//    ui->plainTextEdit_Log->setCenterOnScroll(ui->checkBox_PagedScroll->isChecked());
-    ui->plainTextEdit_Log->setWordWrapMode(QTextOption::NoWrap);
-    ui->plainTextEdit_Log->appendPlainText(timeString + ": " + line);
+    counters += "dropped: " + QString::number(model->getNumOfDroppedLines());
 
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    ui->label_LogCounters->setText(counters);
 }
 
 void PostProcessingForm::on_pushButton_ClearRELPOSNEDData_RoverA_clicked()
 {
     rovers[0].relposnedMessages.clear();
+    pipelineCache->invalidateRoverData();
     addLogLine("Rover A RELPOSNED-data cleared.");
 }
 
 void PostProcessingForm::on_pushButton_ClearRELPOSNEDData_RoverB_clicked()
 {
     rovers[1].relposnedMessages.clear();
+    pipelineCache->invalidateRoverData();
     addLogLine("Rover B RELPOSNED-data cleared.");
 }
 
 void PostProcessingForm::on_pushButton_ClearRELPOSNEDData_RoverC_clicked()
 {
     rovers[2].relposnedMessages.clear();
+    pipelineCache->invalidateRoverData();
     addLogLine("Rover C RELPOSNED-data cleared.");
 }
 
@@ -584,12 +697,13 @@ void PostProcessingForm::on_pushButton_ClearRELPOSNEDData_RoverC_clicked()
 void PostProcessingForm::on_pushButton_ClearTagData_clicked()
 {
     tags.clear();
+    pipelineCache->invalidateTagData();
     addLogLine("Tag data cleared.");
 }
 
 void PostProcessingForm::addRELPOSNEDData_Rover(const unsigned int roverId)
 {
-    if (roverId < sizeof(rovers) / sizeof(rovers[0]))
+    if (roverId < (unsigned int)rovers.count())
     {
         if (fileDialog_UBX.exec())
         {
@@ -608,7 +722,7 @@ void PostProcessingForm::addRELPOSNEDData_Rover(const unsigned int roverId)
 
 void PostProcessingForm::addRELPOSNEDData_Rover(const QStringList fileNames, const unsigned int roverId)
 {
-    if (roverId < sizeof(rovers) / sizeof(rovers[0]))
+    if (roverId < (unsigned int)rovers.count())
     {
         addLogLine("Reading files into rover " + getRoverIdentString(roverId) + " relposned-data...");
 
@@ -617,6 +731,7 @@ void PostProcessingForm::addRELPOSNEDData_Rover(const QStringList fileNames, con
         addRELPOSNEDFileData(fileNames);
 
         currentRELPOSNEDReadingData.relposnedMessages = nullptr;
+        pipelineCache->invalidateRoverData();
     }
 }
 
@@ -929,7 +1044,7 @@ void PostProcessingForm::ubloxProcessor_unidentifiedDataReceived(const QByteArra
 
 void PostProcessingForm::on_pushButton_ClearAll_clicked()
 {
-    ui->plainTextEdit_Log->clear();
+    ui->logView_Log->getModel()->clear();
 }
 
 void PostProcessingForm::addTagData(const QStringList& fileNames)
@@ -941,15 +1056,12 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
         QFileInfo fileInfo(fileName);
         addLogLine("Opening file \"" + fileInfo.fileName() + "\"...");
 
-        QFile tagFile;
-        tagFile.setFileName(fileName);
-        if (tagFile.open(QIODevice::ReadOnly))
+        TextLogReader tagFile;
+        if (tagFile.open(fileName))
         {
             int numberOfTags = 0;
 
-            QTextStream textStream(&tagFile);
-
-            int64_t fileLength = tagFile.size();
+            int64_t fileLength = tagFile.getFileSize();
 
             if (fileLength > 0x7FFFFFFFLL)
             {
@@ -958,7 +1070,7 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
                 continue;
             }
 
-            QString headerLine = textStream.readLine();
+            QString headerLine = tagFile.readLine().toString();
 
             bool uptimeColumnExists;
 
@@ -983,49 +1095,35 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
             int firstDuplicateTagLine = 0;
             int lastDuplicateTagLine = 0;
 
-            while (!textStream.atEnd())
+            // Tags have only a few different identifiers -> Share the strings
+            TextLogReader::StringPool tagIdents;
+            TextLogReader::Field subItems[TextLogReader::maxNumOfFields];
+
+            while (!tagFile.atEnd())
             {
                 lineNumber++;
 
-                QString lineRead = textStream.readLine();
-
-                QString line;
+                TextLogReader::Field line = tagFile.readLine();
 
-                bool initialWhitespace = true;
-                for (int i = 0; i < lineRead.length(); i++)
+                while ((line.length > 0) && ((line.data[0] == ' ') || (line.data[0] == '\t')))
                 {
-                    if (initialWhitespace)
-                    {
-                        if ((lineRead[i] != ' ') && (lineRead[i] != '\t'))
-                        {
-                            initialWhitespace = false;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
-
-                    if ((i < lineRead.length() - 1) && (lineRead[i] == '/') && (lineRead[i + 1] == '/'))
-                    {
-                        // Rest of the line is comment -> skip it
-                        break;
-                    }
-                    else
-                    {
-                        line += lineRead[i];
-                    }
+                    // Skip initial whitespace
+                    line.data++;
+                    line.length--;
                 }
 
-                if (line.length() == 0)
+                // Rest of the line after "//" is comment -> skip it
+                line = line.left(line.indexOf("//"));
+
+                if (line.isEmpty())
                 {
                     continue;
                 }
 
-                QStringList subItems = line.split("\t");
+                int subItemCount = TextLogReader::split(line, subItems);
 
-                if ((subItems.count() < 4) ||
-                        ((subItems.count() < 5) && uptimeColumnExists))
+                if ((subItemCount < 4) ||
+                        ((subItemCount < 5) && uptimeColumnExists))
                 {
                     discardedLines++;
                     addLogLine("Warning: Line " + QString::number(lineNumber) + ": Not enough tab-separated items. Line skipped.");
@@ -1044,7 +1142,7 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
                     continue;
                 }
 
-                if (subItems[2].length() == 0)
+                if (subItems[2].isEmpty())
                 {
                     discardedLines++;
                     addLogLine("Warning: Line " + QString::number(lineNumber) + ": Empty tag. Line skipped.");
@@ -1073,8 +1171,8 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
 
                 newTag.sourceFile = fileName;
                 newTag.sourceFileLine = lineNumber;
-                newTag.ident = subItems[2];
-                newTag.text = subItems[3];
+                newTag.ident = tagIdents.get(subItems[2]);
+                newTag.text = subItems[3].toString();
 
                 if (tags.find(uptime) != tags.end())
                 {
@@ -1136,6 +1234,7 @@ void PostProcessingForm::addTagData(const QStringList& fileNames)
             addLogLine("Error: Can not open file \"" + fileInfo.fileName() + "\". Skipped.");
         }
     }
+    pipelineCache->invalidateTagData();
     addLogLine("Files read.");
 }
 
@@ -1158,22 +1257,31 @@ void PostProcessingForm::on_pushButton_AddTagData_clicked()
 }
 
 void PostProcessingForm::on_pushButton_Stylus_GeneratePointClouds_clicked()
+{
+    if (fileDialog_PointCloud.exec())
+    {
+        fileDialog_PointCloud.setDirectory(fileDialog_PointCloud.directory());
+
+        generatePointClouds_Stylus(fileDialog_PointCloud.directory());
+    }
+}
+
+bool PostProcessingForm::generatePointClouds_Stylus(const QDir& directory)
 {
     Eigen::Transform<double, 3, Eigen::Affine> transform_NEDToXYZ;
 
     if (!generateTransformationMatrix(transform_NEDToXYZ))
     {
-        return;
+        return false;
     }
 
-    if (fileDialog_PointCloud.exec())
-    {
-        fileDialog_PointCloud.setDirectory(fileDialog_PointCloud.directory());
+    int errorCountBefore = errorCount;
 
+    {
         Stylus::PointCloudGenerator::Params params;
 
         params.transform_NEDToXYZ = &transform_NEDToXYZ;
-        params.directory = fileDialog_PointCloud.directory();
+        params.directory = directory;
         params.tagIdent_BeginNewObject = ui->lineEdit_TagIndicatingBeginningOfNewObject->text();
         params.tagIdent_BeginPoints = ui->lineEdit_TagIndicatingBeginningOfObjectPoints->text();
         params.tagIdent_EndPoints = ui->lineEdit_TagIndicatingEndOfObjectPoints->text();
@@ -1182,22 +1290,23 @@ void PostProcessingForm::on_pushButton_Stylus_GeneratePointClouds_clicked()
         params.separateFilesForSubScans = ui->checkBox_Stylus_PointCloud_SeparateOutputFilesForSubScans->isChecked();
 
         params.tags = &tags;
+        params.tagSegmentIndex = &pipelineCache->getTagSegmentIndex(tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
         params.distances = &distances;
-        params.rovers = rovers;
+        params.rovers = rovers.constData();
 
         Stylus::PointCloudGenerator pointCloudGenerator;
 
-        connect(&pointCloudGenerator, &Stylus::PointCloudGenerator::infoMessage,
-                         this, &PostProcessingForm::on_infoMessage);
-
-        connect(&pointCloudGenerator, &Stylus::PointCloudGenerator::warningMessage,
-                         this, &PostProcessingForm::on_warningMessage);
+        connectToGeneratorTask(&pointCloudGenerator);
 
-        connect(&pointCloudGenerator, &Stylus::PointCloudGenerator::errorMessage,
-                         this, &PostProcessingForm::on_errorMessage);
+        params.task = generatorTask;
 
-        pointCloudGenerator.generatePointClouds(params);
+        runGeneratorTask([&]()
+        {
+            pointCloudGenerator.generatePointClouds(params);
+        });
     }
+
+    return errorCount == errorCountBefore;
 }
 
 
@@ -1276,7 +1385,7 @@ void PostProcessingForm::handleReplay(bool firstRound)
         stopReplayRequest = false;
     } else if ((nextUptime_ms >= 0) && (lastReplayedUptime_ms <= lastUptimeToReplay))
     {
-        for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+        for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
         {
             if (rovers[i].roverSyncData.find(nextUptime_ms) != rovers[i].roverSyncData.end())
             {
@@ -1472,7 +1581,7 @@ qint64 PostProcessingForm::getFirstUptime()
 {
     qint64 firstUptime = std::numeric_limits<qint64>::max();
 
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
     {
         if ((!rovers[i].roverSyncData.isEmpty()) && (rovers[i].roverSyncData.firstKey() < firstUptime))
         {
@@ -1507,7 +1616,7 @@ qint64 PostProcessingForm::getLastUptime()
 {
     qint64 lastUptime = -1;
 
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
     {
         if ((!rovers[i].roverSyncData.isEmpty()) && (rovers[i].roverSyncData.lastKey() > lastUptime))
         {
@@ -1537,7 +1646,7 @@ qint64 PostProcessingForm::getNextUptime(const qint64 uptime)
 {
     qint64 nextUptime = std::numeric_limits<qint64>::max();
 
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
     {
         if ((!rovers[i].roverSyncData.empty()) && (rovers[i].roverSyncData.upperBound(uptime) != rovers[i].roverSyncData.end()) &&
                 (rovers[i].roverSyncData.upperBound(uptime).key() < nextUptime))
@@ -1603,13 +1712,6 @@ void PostProcessingForm::on_pushButton_ContinueReplay_clicked()
 
 void PostProcessingForm::on_pushButton_Stylus_Movie_GenerateScript_clicked()
 {
-    Eigen::Transform<double, 3, Eigen::Affine> transform;
-
-    if (!generateTransformationMatrix(transform))
-    {
-        return;
-    }
-
     if (fileDialog_Stylus_MovieScript.exec())
     {
         QStringList fileNameList = fileDialog_Stylus_MovieScript.selectedFiles();
@@ -1625,9 +1727,31 @@ void PostProcessingForm::on_pushButton_Stylus_Movie_GenerateScript_clicked()
             return;
         }
 
+        if (!confirmOverwrite(fileNameList[0]))
+        {
+            addLogLine("Movie script not created.");
+            return;
+        }
+
+        generateMovieScript_Stylus(fileNameList[0]);
+    }
+}
+
+bool PostProcessingForm::generateMovieScript_Stylus(const QString& fileName)
+{
+    Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+    if (!generateTransformationMatrix(transform))
+    {
+        return false;
+    }
+
+    int errorCountBefore = errorCount;
+
+    {
         Stylus::MovieScriptGenerator::Params params;
 
-        params.fileName = fileNameList[0];
+        params.fileName = fileName;
         params.transform = &transform;
         params.tagIdent_BeginNewObject = ui->lineEdit_TagIndicatingBeginningOfNewObject->text();
         params.tagIdent_BeginPoints = ui->lineEdit_TagIndicatingBeginningOfObjectPoints->text();
@@ -1647,23 +1771,24 @@ void PostProcessingForm::on_pushButton_Stylus_Movie_GenerateScript_clicked()
         params.lookAtDShift = ui->doubleSpinBox_Stylus_Movie_LookAt_D->value();
 
         params.tags = &tags;
+        params.tagSegmentIndex = &pipelineCache->getTagSegmentIndex(tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
         params.distances = &distances;
-        params.rovers = rovers;
+        params.rovers = rovers.constData();
 
         Stylus::MovieScriptGenerator movieScriptGenerator;
 
-        connect(&movieScriptGenerator, &Stylus::MovieScriptGenerator::infoMessage,
-                         this, &PostProcessingForm::on_infoMessage);
+        connectToGeneratorTask(&movieScriptGenerator);
 
-        connect(&movieScriptGenerator, &Stylus::MovieScriptGenerator::warningMessage,
-                         this, &PostProcessingForm::on_warningMessage);
+        params.task = generatorTask;
 
-        connect(&movieScriptGenerator, &Stylus::MovieScriptGenerator::errorMessage,
-                         this, &PostProcessingForm::on_errorMessage);
-
-        movieScriptGenerator.GenerateMovieScript(params);
+        runGeneratorTask([&]()
+        {
+            movieScriptGenerator.GenerateMovieScript(params);
+        });
     }
     addLogLine("Movie script generated.");
+
+    return errorCount == errorCountBefore;
 }
 
 void PostProcessingForm::on_pushButton_ClearDistanceData_clicked()
@@ -1683,15 +1808,12 @@ void PostProcessingForm::addDistanceData(const QStringList& fileNames)
         QFileInfo fileInfo(fileName);
         addLogLine("Opening file \"" + fileInfo.fileName() + "\"...");
 
-        QFile distanceFile;
-        distanceFile.setFileName(fileName);
-        if (distanceFile.open(QIODevice::ReadOnly))
+        TextLogReader distanceFile;
+        if (distanceFile.open(fileName))
         {
             int numberOfDistances = 0;
 
-            QTextStream textStream(&distanceFile);
-
-            int64_t fileLength = distanceFile.size();
+            int64_t fileLength = distanceFile.getFileSize();
 
             if (fileLength > 0x7FFFFFFFLL)
             {
@@ -1700,7 +1822,7 @@ void PostProcessingForm::addDistanceData(const QStringList& fileNames)
                 continue;
             }
 
-            QString headerLine = textStream.readLine();
+            QString headerLine = distanceFile.readLine().toString();
 
             if (headerLine.compare("Time\tDistance\tType\tUptime(Start)\tFrame time", Qt::CaseInsensitive))
             {
@@ -1715,15 +1837,13 @@ void PostProcessingForm::addDistanceData(const QStringList& fileNames)
             int firstDuplicateUptimeLine = 0;
             int lastDuplicateUptimeLine = 0;
 
-            while (!textStream.atEnd())
+            TextLogReader::Field subItems[TextLogReader::maxNumOfFields];
+
+            while (!distanceFile.atEnd())
             {
                 lineNumber++;
 
-                QString line = textStream.readLine();
-
-                QStringList subItems = line.split("\t");
-
-                if (subItems.count() < 5)
+                if (TextLogReader::split(distanceFile.readLine(), subItems) < 5)
                 {
                     discardedLines++;
                     addLogLine("Warning: Line " + QString::number(lineNumber) + ": Not enough tab-separated items. Line skipped.");
@@ -1742,11 +1862,11 @@ void PostProcessingForm::addDistanceData(const QStringList& fileNames)
                     continue;
                 }
 
-                if (!subItems[2].compare("constant", Qt::CaseInsensitive))
+                if (subItems[2].equals("constant", Qt::CaseInsensitive))
                 {
                     newDistanceItem.type = DistanceItem::Type::CONSTANT;
                 }
-                else if (!subItems[2].compare("measured", Qt::CaseInsensitive))
+                else if (subItems[2].equals("measured", Qt::CaseInsensitive))
                 {
                     newDistanceItem.type = DistanceItem::Type::MEASURED;
                     newDistanceItem.distance += distanceCorrection;
@@ -1849,17 +1969,19 @@ void PostProcessingForm::on_pushButton_AddDistanceData_clicked()
 
 void PostProcessingForm::on_pushButton_ClearSyncData_clicked()
 {
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
     {
         rovers[i].roverSyncData.clear();
         rovers[i].reverseSync.clear();
     }
 
+    pipelineCache->invalidateRoverData();
     addLogLine("Sync data cleared.");
 }
 
 void PostProcessingForm::addSyncData(const QStringList& fileNames)
 {
+    pipelineCache->invalidateRoverData();
     addLogLine("Reading sync data...");
 
     for (const auto& fileName : fileNames)
@@ -1867,15 +1989,12 @@ void PostProcessingForm::addSyncData(const QStringList& fileNames)
         QFileInfo fileInfo(fileName);
         addLogLine("Opening file \"" + fileInfo.fileName() + "\"...");
 
-        QFile syncFile;
-        syncFile.setFileName(fileName);
-        if (syncFile.open(QIODevice::ReadOnly))
+        TextLogReader syncFile;
+        if (syncFile.open(fileName))
         {
             int numberOfSyncItems = 0;
 
-            QTextStream textStream(&syncFile);
-
-            int64_t fileLength = syncFile.size();
+            int64_t fileLength = syncFile.getFileSize();
 
             if (fileLength > 0x7FFFFFFFLL)
             {
@@ -1884,7 +2003,7 @@ void PostProcessingForm::addSyncData(const QStringList& fileNames)
                 continue;
             }
 
-            QString headerLine = textStream.readLine();
+            QString headerLine = syncFile.readLine().toString();
 
             if (headerLine.compare("Time\tSource\tType\tiTOW\tUptime(Start)\tFrame time", Qt::CaseInsensitive))
             {
@@ -1901,15 +2020,13 @@ void PostProcessingForm::addSyncData(const QStringList& fileNames)
 
             unsigned int expectedITOWAlignment = ui->spinBox_ExpectedITOWAlignment->value();
 
-            while (!textStream.atEnd())
+            TextLogReader::Field subItems[TextLogReader::maxNumOfFields];
+
+            while (!syncFile.atEnd())
             {
                 lineNumber++;
 
-                QString line = textStream.readLine();
-
-                QStringList subItems = line.split("\t");
-
-                if (subItems.count() < 6)
+                if (TextLogReader::split(syncFile.readLine(), subItems) < 6)
                 {
                     discardedLines++;
                     addLogLine("Warning: Line " + QString::number(lineNumber) + ": Not enough tab-separated items. Line skipped.");
@@ -1921,29 +2038,30 @@ void PostProcessingForm::addSyncData(const QStringList& fileNames)
                 QMap<qint64, RoverSyncItem>* roverContainer = nullptr;
                 QMap<UBXMessage_RELPOSNED::ITOW, qint64>* reverseContainer = nullptr;
 
-                if (!subItems[1].compare("rover a", Qt::CaseInsensitive))
-                {
-                    roverContainer = &rovers[0].roverSyncData;
-                    reverseContainer = &rovers[0].reverseSync;
-                }
-                else if (!subItems[1].compare("rover b", Qt::CaseInsensitive))
+                // Source is "Rover X" where X is a letter (A = first rover)
+                TextLogReader::Field source = subItems[1].trimmed();
+                int roverId = -1;
+
+                if ((source.length == 7) && source.left(6).equals("rover ", Qt::CaseInsensitive))
                 {
-                    roverContainer = &rovers[1].roverSyncData;
-                    reverseContainer = &rovers[1].reverseSync;
+                    char roverLetter = source.data[6];
+                    roverId = ((roverLetter >= 'A') && (roverLetter <= 'Z')) ? (roverLetter - 'A') : (roverLetter - 'a');
                 }
-                else if (!subItems[1].compare("rover c", Qt::CaseInsensitive))
+
+                if ((roverId >= 0) && (roverId < rovers.count()))
                 {
-                    roverContainer = &rovers[2].roverSyncData;
-                    reverseContainer = &rovers[2].reverseSync;
+                    roverContainer = &rovers[roverId].roverSyncData;
+                    reverseContainer = &rovers[roverId].reverseSync;
                 }
                 else
                 {
                     discardedLines++;
-                    addLogLine("Warning: Line " + QString::number(lineNumber) + ": Source not either \"rover a\", \"rover b\" nor \"rover c\". Line skipped");
+                    addLogLine("Warning: Line " + QString::number(lineNumber) + ": Source not any of \"rover a\"...\"rover " +
+                               getRoverIdentString(rovers.count() - 1).toLower() + "\". Line skipped");
                     continue;
                 }
 
-                if (!subItems[2].compare("RELPOSNED", Qt::CaseInsensitive))
+                if (subItems[2].equals("RELPOSNED", Qt::CaseInsensitive))
                 {
                     newSyncItem.messageType = RoverSyncItem::MSGTYPE_UBX_RELPOSNED;
                 }
@@ -2098,17 +2216,18 @@ void PostProcessingForm::on_pushButton_AddSyncData_clicked()
 
 void PostProcessingForm::on_pushButton_GenerateSyncDataBasedOnITOWS_clicked()
 {
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    for (unsigned int i = 0; i < (unsigned int)rovers.count(); i++)
     {
         rovers[i].roverSyncData.clear();
         rovers[i].reverseSync.clear();
     }
 
+    pipelineCache->invalidateRoverData();
     addLogLine("Previous sync data cleared.");
 
     int itemCount = 0;
 
-    unsigned int numofRovers = sizeof(rovers) / sizeof(rovers[0]);
+    unsigned int numofRovers = (unsigned int)rovers.count();
 
     for (unsigned int roverId = 0; roverId < numofRovers; roverId++)
     {
@@ -2260,64 +2379,66 @@ void PostProcessingForm::addAllData(const bool includeParameters)
             }
         }
 
-        QStringList fileNames;
+        addAllData(baseFileNames, includeParameters);
+    }
+}
+
+void PostProcessingForm::addAllData(const QStringList& baseFileNames, const bool includeParameters)
+{
+    QStringList fileNames;
+
+    if (includeParameters)
+    {
+        fileNames = getAppendedFileNames(baseFileNames, ".PPParameters");
 
-        if (includeParameters)
+        if (fileNames.count() == 0)
+        {
+            addLogLine("Warning: No file(s) selected. Parameters not read.");
+        }
+        else
         {
-            fileNames = getAppendedFileNames(baseFileNames, ".PPParameters");
+            QString fileName = fileNames[0];
 
-            if (fileNames.count() == 0)
+            if (fileNames.count() != 1)
             {
-                addLogLine("Warning: No file(s) selected. Parameters not read.");
+                addLogLine("Warning: Multiple files selected. Parameters read only using the first one ("""+
+                           fileName + """)");
             }
-            else
-            {
-                QString fileName = fileNames[0];
-
-                if (fileNames.count() != 1)
-                {
-                    addLogLine("Warning: Multiple files selected. Parameters read only using the first one ("""+
-                               fileName + """)");
-                }
 
-                QFileInfo fileInfo(fileName);
-                addLogLine("Opening file \"" + fileInfo.fileName() + "\"...");
+            QFileInfo fileInfo(fileName);
+            addLogLine("Opening file \"" + fileInfo.fileName() + "\"...");
 
-                if (QFile::exists(fileName))
-                {
-                    QSettings settings(fileName, QSettings::IniFormat);
+            if (QFile::exists(fileName))
+            {
+                QSettings settings(fileName, QSettings::IniFormat);
 
-                    loadParametersFromQSettings(settings);
-                    addLogLine("Parameters (found from the file) read.");
-                }
-                else
-                {
-                    addLogLine("Error: Can't open file \"" + fileInfo.fileName() + "\".");
-                }
+                loadParametersFromQSettings(settings);
+                addLogLine("Parameters (found from the file) read.");
+            }
+            else
+            {
+                addLogLine("Error: Can't open file \"" + fileInfo.fileName() + "\".");
             }
         }
+    }
 
-        fileNames = getAppendedFileNames(baseFileNames, "_RoverA_RELPOSNED.ubx");
-        addRELPOSNEDData_Rover(fileNames, 0);
-
-        fileNames = getAppendedFileNames(baseFileNames, "_RoverB_RELPOSNED.ubx");
-        addRELPOSNEDData_Rover(fileNames, 1);
-
-        fileNames = getAppendedFileNames(baseFileNames, "_RoverC_RELPOSNED.ubx");
-        addRELPOSNEDData_Rover(fileNames, 2);
+    for (unsigned int roverId = 0; roverId < (unsigned int)rovers.count(); roverId++)
+    {
+        fileNames = getAppendedFileNames(baseFileNames, "_Rover" + getRoverIdentString(roverId) + "_RELPOSNED.ubx");
+        addRELPOSNEDData_Rover(fileNames, roverId);
+    }
 
-        fileNames = getAppendedFileNames(baseFileNames, "_tags.tags");
-        addTagData(fileNames);
+    fileNames = getAppendedFileNames(baseFileNames, "_tags.tags");
+    addTagData(fileNames);
 
-        fileNames = getAppendedFileNames(baseFileNames, ".distances");
-        addDistanceData(fileNames);
+    fileNames = getAppendedFileNames(baseFileNames, ".distances");
+    addDistanceData(fileNames);
 
-        fileNames = getAppendedFileNames(baseFileNames, ".lidar");
-        addLidarData(fileNames);
+    fileNames = getAppendedFileNames(baseFileNames, ".lidar");
+    addLidarData(fileNames);
 
-        fileNames = getAppendedFileNames(baseFileNames, ".sync");
-        addSyncData(fileNames);
-    }
+    fileNames = getAppendedFileNames(baseFileNames, ".sync");
+    addSyncData(fileNames);
 }
 
 void PostProcessingForm::on_pushButton_AddAll_clicked()
@@ -2596,15 +2717,30 @@ void PostProcessingForm::loadAntennaLocations(const QString fileName)
             return;
         }
 
-        QString coordItems[3][3];
+        QVector<QStringList> coordItems;
 
-        for (int roverIndex = 0; roverIndex < 3; roverIndex++)
+        while (!textStream.atEnd())
         {
+            int roverIndex = coordItems.count();
+
             QString dataLine = textStream.readLine();
 
+            if (dataLine.isEmpty())
+            {
+                continue;
+            }
+
             QStringList dataLineItems = dataLine.split("\t");
 
-            if (dataLineItems.count() != (1 + 3))
+            if (roverIndex >= maxNumOfRovers)
+            {
+                addLogLine("Error: File \"" + fileInfo.fileName() + "\" has more than " + QString::number(maxNumOfRovers) +
+                           " antenna locations. Data not read.");
+
+                antennaLocationsFile.close();
+                return;
+            }
+            else if (dataLineItems.count() != (1 + 3))
             {
                 addLogLine("Error: File's \"" + fileInfo.fileName() + "\" line " + QString::number(roverIndex + 1) +
                            " doesn't have correct number of items (4). Data not read.");
@@ -2624,14 +2760,20 @@ void PostProcessingForm::loadAntennaLocations(const QString fileName)
                     return;
                 }
 
-                for (int i = 0; i < 3; i++)
-                {
-                    coordItems[roverIndex][i] = dataLineItems[i + 1];
-                }
+                coordItems.append(dataLineItems.mid(1));
             }
         }
 
-        for (int roverIndex = 0; roverIndex < 3; roverIndex++)
+        if (coordItems.count() < LOSolver::minNumOfPoints)
+        {
+            addLogLine("Error: File \"" + fileInfo.fileName() + "\" has less than " + QString::number(LOSolver::minNumOfPoints) +
+                       " antenna locations. Data not read.");
+            return;
+        }
+
+        ui->spinBox_NumOfAntennas_LOSolver->setValue(coordItems.count());
+
+        for (int roverIndex = 0; roverIndex < coordItems.count(); roverIndex++)
         {
             for (int coordIndex = 0; coordIndex < 3; coordIndex++)
             {
@@ -2713,7 +2855,7 @@ void PostProcessingForm::on_pushButton_SaveAntennaLocations_clicked()
 
         textStream << getAntennaLocationsFileHeaderLine() << "\n";
 
-        for (int roverIndex = 0; roverIndex < 3; roverIndex++)
+        for (int roverIndex = 0; roverIndex < ui->tableWidget_AntennaLocations_LOSolver->rowCount(); roverIndex++)
         {
             QString expectedRoverIdent = "Rover " + getRoverIdentString(roverIndex);
 
@@ -2731,9 +2873,9 @@ void PostProcessingForm::on_pushButton_SaveAntennaLocations_clicked()
 
 bool PostProcessingForm::updateLOSolverReferencePointLocations(LOSolver& loSolver)
 {
-    Eigen::Vector3d antennaLocations[3];
+    QVector<Eigen::Vector3d> antennaLocations(ui->tableWidget_AntennaLocations_LOSolver->rowCount());
 
-    for (int roverIndex = 0; roverIndex < 3; roverIndex++)
+    for (int roverIndex = 0; roverIndex < antennaLocations.count(); roverIndex++)
     {
         bool ok;
         for (int valueIndex = 0; valueIndex < 3; valueIndex++)
@@ -2781,20 +2923,72 @@ void PostProcessingForm::on_pushButton_ValidateAntennaLocations_clicked()
     msgBox.exec();
 }
 
+void PostProcessingForm::setNumOfRovers(const int numOfRovers)
+{
+    int oldNumOfRows = ui->tableWidget_AntennaLocations_LOSolver->rowCount();
+
+    rovers.resize(numOfRovers);
+    ui->tableWidget_AntennaLocations_LOSolver->setRowCount(numOfRovers);
+
+    for (int row = oldNumOfRows; row < numOfRovers; row++)
+    {
+        ui->tableWidget_AntennaLocations_LOSolver->setVerticalHeaderItem(row, new QTableWidgetItem("Rover " + getRoverIdentString(row)));
+
+        for (int column = 0; column < 3; column++)
+        {
+            ui->tableWidget_AntennaLocations_LOSolver->setItem(row, column, new QTableWidgetItem("0"));
+        }
+    }
+
+    pipelineCache->invalidateRoverData();
+}
+
+void PostProcessingForm::on_spinBox_NumOfAntennas_LOSolver_valueChanged(int numOfAntennas)
+{
+    setNumOfRovers(numOfAntennas);
+}
+
 void PostProcessingForm::on_pushButton_LOSolver_GenerateScript_clicked()
+{
+    if (fileDialog_LOSolver_Script.exec())
+    {
+        QStringList fileNameList = fileDialog_LOSolver_Script.selectedFiles();
+
+        if (fileNameList.size() != 0)
+        {
+            fileDialog_LOSolver_Script.setDirectory(QFileInfo(fileNameList[0]).path());
+        }
+
+        if (fileNameList.length() != 1)
+        {
+            addLogLine("Location/orientation script: Multiple file selection not supported. Script not created.");
+            return;
+        }
+
+        if (!confirmOverwrite(fileNameList[0]))
+        {
+            addLogLine("Generating of location/orientation script cancelled.");
+            return;
+        }
+
+        generateScript_LOSolver(fileNameList[0]);
+    }
+}
+
+bool PostProcessingForm::generateScript_LOSolver(const QString& fileName)
 {
     Eigen::Transform<double, 3, Eigen::Affine> transform_NEDToXYZ;
 
     if (!generateTransformationMatrix(transform_NEDToXYZ))
     {
-        return;
+        return false;
     }
 
     LOSolver loSolver;
 
     if (!updateLOSolverReferencePointLocations(loSolver))
     {
-        return;
+        return false;
     }
 
     TransformMatrixGenerator matrixGenerator;
@@ -2828,24 +3022,12 @@ void PostProcessingForm::on_pushButton_LOSolver_GenerateScript_clicked()
         ui->plainTextEdit_LOSolver_TransformMatrixScript->setTextCursor(cursor);
         ui->plainTextEdit_LOSolver_TransformMatrixScript->setFocus();
 
-        return;
+        return false;
     }
 
-    if (fileDialog_LOSolver_Script.exec())
-    {
-        QStringList fileNameList = fileDialog_LOSolver_Script.selectedFiles();
-
-        if (fileNameList.size() != 0)
-        {
-            fileDialog_LOSolver_Script.setDirectory(QFileInfo(fileNameList[0]).path());
-        }
-
-        if (fileNameList.length() != 1)
-        {
-            addLogLine("Location/orientation script: Multiple file selection not supported. Script not created.");
-            return;
-        }
+    int errorCountBefore = errorCount;
 
+    {
         LOScriptGenerator::Params params;
 
         params.transform_NEDToXYZ = &transform_NEDToXYZ;
@@ -2853,29 +3035,31 @@ void PostProcessingForm::on_pushButton_LOSolver_GenerateScript_clicked()
         params.iTOWRange_Script_Min = ui->spinBox_LOSolver_Movie_ITOW_Script_Min->value();
         params.iTOWRange_Script_Max = ui->spinBox_LOSolver_Movie_ITOW_Script_Max->value();
 
-        params.fileName = fileNameList[0];
+        params.fileName = fileName;
         params.timeStampFormat = ui->comboBox_LOSolver_Movie_TimeStamps->currentIndex() == 1 ? LOScriptGenerator::Params::TimeStampFormat::TSF_UPTIME : LOScriptGenerator::Params::TimeStampFormat::TSF_ITOW;
         params.loSolver = &loSolver;
 
-        params.rovers = rovers;
+        params.rovers = rovers.constData();
+        params.numOfRovers = rovers.count();
 
         LOScriptGenerator loScriptGenerator;
 
-        connect(&loScriptGenerator, &LOScriptGenerator::infoMessage,
-                         this, &PostProcessingForm::on_infoMessage);
+        connectToGeneratorTask(&loScriptGenerator);
 
-        connect(&loScriptGenerator, &LOScriptGenerator::warningMessage,
-                         this, &PostProcessingForm::on_warningMessage);
+        params.task = generatorTask;
 
-        connect(&loScriptGenerator, &LOScriptGenerator::errorMessage,
-                         this, &PostProcessingForm::on_errorMessage);
-
-        loScriptGenerator.generateScript(params);
+        runGeneratorTask([&]()
+        {
+            loScriptGenerator.generateScript(params);
+        });
     }
+
+    return errorCount == errorCountBefore;
 }
 
 void PostProcessingForm::addLidarData(const QStringList& fileNames)
 {
+    pipelineCache->invalidateLidarData();
     addLogLine("Reading lidar data...");
 
     for (const auto& fileName : fileNames)
@@ -3064,11 +3248,22 @@ void PostProcessingForm::on_pushButton_AddLidarData_clicked()
 void PostProcessingForm::on_pushButton_ClearLidarData_clicked()
 {
     lidarRounds.clear();
+    pipelineCache->invalidateLidarData();
     addLogLine("Lidar data cleared.");
 }
 
 
 void PostProcessingForm::on_pushButton_Lidar_GeneratePointClouds_clicked()
+{
+    if (fileDialog_PointCloud.exec())
+    {
+        fileDialog_PointCloud.setDirectory(fileDialog_PointCloud.directory());
+
+        generatePointClouds_Lidar(fileDialog_PointCloud.directory());
+    }
+}
+
+bool PostProcessingForm::generatePointClouds_Lidar(const QDir& directory)
 {
     Eigen::Transform<double, 3, Eigen::Affine> transform_NEDToXYZ;
     Eigen::Transform<double, 3, Eigen::Affine> transform_Lidar_Generated_BeforeRotation;
@@ -3077,39 +3272,47 @@ void PostProcessingForm::on_pushButton_Lidar_GeneratePointClouds_clicked()
 
     if (!generateTransformationMatrix(transform_NEDToXYZ))
     {
-        return;
+        return false;
     }
 
     RPLidarPlausibilityFilter::Settings lidarFilteringSettings;
 
     if (!generateLidarTransformMatrices(transform_Lidar_Generated_BeforeRotation, transform_LidarGenerated_AfterRotation))
     {
-        return;
+        return false;
     }
 
     if (!updateLOSolverReferencePointLocations(loInterpolator_Lidar.loSolver))
     {
-        return;
+        return false;
     }
 
+    loInterpolator_Lidar.poseTable = &pipelineCache->getPoseTable(rovers.constData(), rovers.count(), loInterpolator_Lidar.loSolver);
+
     getLidarFilteringSettings(lidarFilteringSettings);
 
-    if (fileDialog_PointCloud.exec())
-    {
-        fileDialog_PointCloud.setDirectory(fileDialog_PointCloud.directory());
+    int errorCountBefore = errorCount;
 
+    {
         Lidar::PointCloudGenerator::Params params;
 
         params.transform_NEDToXYZ = &transform_NEDToXYZ;
         params.transform_AfterRotation = &transform_LidarGenerated_AfterRotation;
         params.transform_BeforeRotation = &transform_Lidar_Generated_BeforeRotation;
-        params.directory = fileDialog_PointCloud.directory();
+        params.directory = directory;
         params.tagIdent_BeginNewObject = ui->lineEdit_TagIndicatingBeginningOfNewObject->text();
         params.tagIdent_BeginPoints = ui->lineEdit_TagIndicatingBeginningOfObjectPoints->text();
         params.tagIdent_EndPoints = ui->lineEdit_TagIndicatingEndOfObjectPoints->text();
         params.includeNormals = ui->checkBox_Lidar_PointCloud_IncludeNormals->isChecked();
         params.normalLengthsAsQuality = ui->checkBox_Lidar_PointCloud_NormalLengthsAsQuality->isChecked();
         params.separateFilesForSubScans = ui->checkBox_Lidar_PointCloud_SeparateOutputFilesForSubScans->isChecked();
+        params.voxelGridFiltering = ui->checkBox_Lidar_PointCloud_VoxelGridFiltering->isChecked();
+        params.voxelGridFilterSettings.cellSize = ui->doubleSpinBox_Lidar_PointCloud_VoxelGrid_CellSize->value();
+        params.voxelGridFilterSettings.mode = static_cast<Lidar::VoxelGridFilter::Mode>(ui->comboBox_Lidar_PointCloud_VoxelGrid_Mode->currentIndex());
+        params.tiledOutput = ui->checkBox_Lidar_PointCloud_TiledOutput->isChecked();
+        params.tiledOutputSettings.tileSize = ui->doubleSpinBox_Lidar_PointCloud_Tiled_TileSize->value();
+        params.tiledOutputSettings.maxDepth = ui->spinBox_Lidar_PointCloud_Tiled_MaxDepth->value();
+        params.tiledOutputSettings.gridResolution = ui->spinBox_Lidar_PointCloud_Tiled_GridResolution->value();
         params.timeShift = ui->spinBox_Lidar_TimeShift->value();
 
         Eigen::Vector3d boundingSphere_Center = Eigen::Vector3d(ui->doubleSpinBox_Lidar_BoundingSphere_Center_N->value(),
@@ -3120,26 +3323,142 @@ void PostProcessingForm::on_pushButton_Lidar_GeneratePointClouds_clicked()
         params.boundingSphere_Radius = ui->doubleSpinBox_Lidar_BoundingSphere_Radius->value();
 
         params.tags = &tags;
-        params.rovers = rovers;
+        params.tagSegmentIndex = &pipelineCache->getTagSegmentIndex(tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+        params.rovers = rovers.constData();
+        params.numOfRovers = rovers.count();
         params.lidarRounds = &lidarRounds;
         params.lidarFilteringSettings = &lidarFilteringSettings;
         params.loInterpolator = &loInterpolator_Lidar;
+        params.clockModel = &pipelineCache->getClockModel(rovers.constData(), rovers.count());
+        params.processedRoundCache = pipelineCache->getProcessedRoundCache();
 
         Lidar::PointCloudGenerator pointCloudGenerator;
 
-        connect(&pointCloudGenerator, &Lidar::PointCloudGenerator::infoMessage,
-                         this, &PostProcessingForm::on_infoMessage);
+        connectToGeneratorTask(&pointCloudGenerator);
 
-        connect(&pointCloudGenerator, &Lidar::PointCloudGenerator::warningMessage,
-                         this, &PostProcessingForm::on_warningMessage);
+        params.task = generatorTask;
 
-        connect(&pointCloudGenerator, &Lidar::PointCloudGenerator::errorMessage,
-                         this, &PostProcessingForm::on_errorMessage);
-
-        pointCloudGenerator.generatePointClouds(params);
+        runGeneratorTask([&]()
+        {
+            pointCloudGenerator.generatePointClouds(params);
+        });
     }
+
+    return errorCount == errorCountBefore;
+}
+
+
+void PostProcessingForm::on_pushButton_Lidar_CalibrateTimeShift_clicked()
+{
+    calibrateTimeShift_Lidar(QString());
 }
 
+bool PostProcessingForm::calibrateTimeShift_Lidar(const QString& csvFileName)
+{
+    Eigen::Transform<double, 3, Eigen::Affine> transform_Lidar_Generated_BeforeRotation;
+    Eigen::Transform<double, 3, Eigen::Affine> transform_LidarGenerated_AfterRotation;
+    LOInterpolator loInterpolator_Lidar(this);
+
+    RPLidarPlausibilityFilter::Settings lidarFilteringSettings;
+
+    if (!generateLidarTransformMatrices(transform_Lidar_Generated_BeforeRotation, transform_LidarGenerated_AfterRotation))
+    {
+        return false;
+    }
+
+    if (!updateLOSolverReferencePointLocations(loInterpolator_Lidar.loSolver))
+    {
+        return false;
+    }
+
+    loInterpolator_Lidar.poseTable = &pipelineCache->getPoseTable(rovers.constData(), rovers.count(), loInterpolator_Lidar.loSolver);
+
+    getLidarFilteringSettings(lidarFilteringSettings);
+
+    Lidar::TimeShiftCalibrator::Params params;
+
+    params.transform_BeforeRotation = &transform_Lidar_Generated_BeforeRotation;
+    params.transform_AfterRotation = &transform_LidarGenerated_AfterRotation;
+    params.tagIdent_BeginPoints = ui->lineEdit_TagIndicatingBeginningOfObjectPoints->text();
+    params.tagIdent_EndPoints = ui->lineEdit_TagIndicatingEndOfObjectPoints->text();
+
+    Eigen::Vector3d boundingSphere_Center = Eigen::Vector3d(ui->doubleSpinBox_Lidar_BoundingSphere_Center_N->value(),
+                    ui->doubleSpinBox_Lidar_BoundingSphere_Center_E->value(),
+                    ui->doubleSpinBox_Lidar_BoundingSphere_Center_D->value());
+
+    params.boundingSphere_Center = &boundingSphere_Center;
+    params.boundingSphere_Radius = ui->doubleSpinBox_Lidar_BoundingSphere_Radius->value();
+
+    params.timeShift_Initial = ui->spinBox_Lidar_TimeShift->value();
+    params.timeShift_Min = params.timeShift_Initial - ui->spinBox_Lidar_TimeShiftCalibration_Range->value();
+    params.timeShift_Max = params.timeShift_Initial + ui->spinBox_Lidar_TimeShiftCalibration_Range->value();
+    params.coarseStep = qMax(1, ui->spinBox_Lidar_TimeShiftCalibration_Range->value() / 10);
+    params.cellSize = ui->doubleSpinBox_Lidar_TimeShiftCalibration_CellSize->value();
+
+    params.tags = &tags;
+    params.rovers = rovers.constData();
+    params.numOfRovers = rovers.count();
+    params.lidarRounds = &lidarRounds;
+    params.lidarFilteringSettings = &lidarFilteringSettings;
+    params.loInterpolator = &loInterpolator_Lidar;
+    params.clockModel = &pipelineCache->getClockModel(rovers.constData(), rovers.count());
+    params.processedRoundCache = pipelineCache->getProcessedRoundCache();
+
+    Lidar::TimeShiftCalibrator calibrator;
+
+    connectToGeneratorTask(&calibrator);
+
+    addLogLine("Calibrating lidar time shift (range " + QString::number(params.timeShift_Min) + "..." + QString::number(params.timeShift_Max) + " ms)...");
+
+    int bestTimeShift = 0;
+    QVector<Lidar::TimeShiftCalibrator::ScoredTimeShift> scoreCurve;
+
+    bool calibrationOk = false;
+
+    params.task = generatorTask;
+
+    runGeneratorTask([&]()
+    {
+        calibrationOk = calibrator.calibrate(params, bestTimeShift, scoreCurve);
+    });
+
+    if (!calibrationOk)
+    {
+        return false;
+    }
+
+    QString csv = "TimeShift,Score,Points,Valid\n";
+
+    for (const Lidar::TimeShiftCalibrator::ScoredTimeShift& scoredTimeShift : scoreCurve)
+    {
+        addLogLine("Time shift " + QString::number(scoredTimeShift.timeShift) + " ms: score " +
+                   (scoredTimeShift.valid ? QString::number(scoredTimeShift.score, 'f', 6) : QString("invalid")) +
+                   " (" + QString::number(scoredTimeShift.numOfPoints) + " points)");
+
+        csv += QString::number(scoredTimeShift.timeShift) + "," + QString::number(scoredTimeShift.score, 'f', 6) + "," +
+                QString::number(scoredTimeShift.numOfPoints) + "," + (scoredTimeShift.valid ? "1" : "0") + "\n";
+    }
+
+    if (!csvFileName.isEmpty())
+    {
+        QFile csvFile(csvFileName);
+
+        if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        {
+            addLogLine("Error: Can't open file \"" + csvFileName + "\".");
+            return false;
+        }
+
+        QTextStream textStream(&csvFile);
+        textStream << csv;
+    }
+
+    addLogLine("Best lidar time shift: " + QString::number(bestTimeShift) + " ms (was " + QString::number(ui->spinBox_Lidar_TimeShift->value()) + " ms).");
+
+    ui->spinBox_Lidar_TimeShift->setValue(bestTimeShift);
+
+    return true;
+}
 
 void PostProcessingForm::getLidarFilteringSettings(RPLidarPlausibilityFilter::Settings& lidarFilteringSettings)
 {
@@ -3165,104 +3484,108 @@ PostProcessingForm::LOInterpolator::LOInterpolator(PostProcessingForm* owner)
 }
 
 void PostProcessingForm::LOInterpolator::getInterpolatedLocationOrientationTransformMatrix_Uptime(
-        const qint64 uptime, const QMap<qint64, UBXMessage_RELPOSNED::ITOW>& averagedRoverUptimeSync,
+        const qint64 uptime, const ClockModel& clockModel,
         Eigen::Transform<double, 3, Eigen::Affine>& transform,
         const unsigned int maxInterpolationTimeRange)
 {
-    UBXMessage_RELPOSNED roverRELPOSNEDS_Low[3];
-    UBXMessage_RELPOSNED roverRELPOSNEDS_High[3];
-    const Rover* crovers = owner->rovers;
+    if (clockModel.isEmpty())
+    {
+        throw QString("Can not find corresponding rover uptime sync data (clock model empty).");
+    }
+
+    interpolateAtModelITOW(clockModel.getITOW(uptime), transform, maxInterpolationTimeRange);
+}
 
-    if ((uptime < roverUptimeLimit_Low) || (uptime >= roverUptimeLimit_High))
+UBXMessage_RELPOSNED::ITOW PostProcessingForm::LOInterpolator::findNextInterpolationITOW(const UBXMessage_RELPOSNED::ITOW iTOW) const
+{
+    if (poseTable)
     {
-        // "Cache miss" -> Find new limiting values
+        auto poseIter = poseTable->lowerBound(iTOW);
+        return (poseIter != poseTable->end()) ? poseIter.key() : -1;
+    }
 
-        auto roverUptimeIter = averagedRoverUptimeSync.upperBound(uptime);
+    const unsigned int numOfRovers = owner->rovers.count();
 
-        if (roverUptimeIter == averagedRoverUptimeSync.end())
-        {
-            roverUptimeLimit_Low = -1;
-            roverUptimeLimit_High = -1;
-            throw QString("Can not find corresponding rover uptime-averaged sync data (higher limit).");
-        }
+    return findNextCommonITOW(owner->rovers.constData(), numOfRovers, qMin(numOfRovers, (unsigned int)LOSolver::minNumOfPoints), iTOW);
+}
 
-        if (roverUptimeIter == averagedRoverUptimeSync.begin())
-        {
-            roverUptimeLimit_Low = -1;
-            roverUptimeLimit_High = -1;
-            throw QString("Can not find corresponding rover uptime-averaged sync data (lower limit).");
-        }
+UBXMessage_RELPOSNED::ITOW PostProcessingForm::LOInterpolator::findPreviousInterpolationITOW(const UBXMessage_RELPOSNED::ITOW iTOW) const
+{
+    if (poseTable)
+    {
+        auto poseIter = poseTable->lowerBound(iTOW);
+        return (poseIter != poseTable->begin()) ? (poseIter - 1).key() : -1;
+    }
 
-        roverUptimeLimit_High = roverUptimeIter.key();
-        UBXMessage_RELPOSNED::ITOW roverITOWLimit_High = roverUptimeIter.value();
-        roverUptimeIter--;
-        roverUptimeLimit_Low = roverUptimeIter.key();
-        UBXMessage_RELPOSNED::ITOW roverITOWLimit_Low = roverUptimeIter.value();
+    const unsigned int numOfRovers = owner->rovers.count();
 
-        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator roverRELPOSNEDS_High[3];
-        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator roverRELPOSNEDS_Low[3];
+    return findPreviousCommonITOW(owner->rovers.constData(), numOfRovers, qMin(numOfRovers, (unsigned int)LOSolver::minNumOfPoints), iTOW);
+}
 
-        for (int i = 0; i < 3; i++)
-        {
-            roverRELPOSNEDS_Low[i] = crovers[i].relposnedMessages.lowerBound(roverITOWLimit_Low);
-            roverRELPOSNEDS_High[i] = crovers[i].relposnedMessages.lowerBound(roverITOWLimit_High);
-            Q_ASSERT(roverRELPOSNEDS_Low[i].key() == roverITOWLimit_Low);
-            Q_ASSERT(roverRELPOSNEDS_High[i].key() == roverITOWLimit_High);
-        }
+void PostProcessingForm::LOInterpolator::interpolateAtModelITOW(const double iTOW, Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                                                                const unsigned int maxInterpolationTimeRange)
+{
+    TRACE_ZONE("LOInterpolator::interpolate");
 
-        Eigen::Vector3d points_Low[3] =
-        {
-            { roverRELPOSNEDS_Low[0]->relPosN, roverRELPOSNEDS_Low[0]->relPosE, roverRELPOSNEDS_Low[0]->relPosD },
-            { roverRELPOSNEDS_Low[1]->relPosN, roverRELPOSNEDS_Low[1]->relPosE, roverRELPOSNEDS_Low[1]->relPosD },
-            { roverRELPOSNEDS_Low[2]->relPosN, roverRELPOSNEDS_Low[2]->relPosE, roverRELPOSNEDS_Low[2]->relPosD },
-        };
+    if ((iTOW < roverUptimeLimit_Low) || (iTOW >= roverUptimeLimit_High))
+    {
+        // "Cache miss" -> Find new limiting values (low <= iTOW < high)
 
-        if (!loSolver.setPoints(points_Low))
+        UBXMessage_RELPOSNED::ITOW iTOWAfterFloor = UBXMessage_RELPOSNED::ITOW(floor(iTOW)) + 1;
+
+        UBXMessage_RELPOSNED::ITOW newITOWLimit_High = findNextInterpolationITOW(iTOWAfterFloor);
+
+        if (newITOWLimit_High < 0)
         {
-            throw QString("LOSolver.setPoints (low limit) failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            roverUptimeLimit_Low = -1;
+            roverUptimeLimit_High = -1;
+            throw QString("Can not find corresponding rover sync data (higher limit).");
         }
 
-        Eigen::Transform<double, 3, Eigen::Affine> transform_Low;
+        UBXMessage_RELPOSNED::ITOW newITOWLimit_Low = findPreviousInterpolationITOW(iTOWAfterFloor);
 
-        if (!loSolver.getTransformMatrix(transform_Low))
+        if (newITOWLimit_Low < 0)
         {
-            throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            roverUptimeLimit_Low = -1;
+            roverUptimeLimit_High = -1;
+            throw QString("Can not find corresponding rover sync data (lower limit).");
         }
 
-        roverUptimeBasedLocation_Low = transform_Low.translation();
-        roverUptimeBasedOrientation_Low = transform_Low.linear();
+        roverUptimeLimit_Low = newITOWLimit_Low;
+        roverUptimeLimit_High = newITOWLimit_High;
 
-        Eigen::Vector3d points_High[3] =
-        {
-            { roverRELPOSNEDS_High[0]->relPosN, roverRELPOSNEDS_High[0]->relPosE, roverRELPOSNEDS_High[0]->relPosD },
-            { roverRELPOSNEDS_High[1]->relPosN, roverRELPOSNEDS_High[1]->relPosE, roverRELPOSNEDS_High[1]->relPosD },
-            { roverRELPOSNEDS_High[2]->relPosN, roverRELPOSNEDS_High[2]->relPosE, roverRELPOSNEDS_High[2]->relPosD },
-        };
+        QMap<UBXMessage_RELPOSNED::ITOW, Pose>::const_iterator poseIter_Low;
+        QMap<UBXMessage_RELPOSNED::ITOW, Pose>::const_iterator poseIter_High;
 
-        if (!loSolver.setPoints(points_High))
+        if (poseTable &&
+                ((poseIter_Low = poseTable->find(roverUptimeLimit_Low)) != poseTable->end()) &&
+                ((poseIter_High = poseTable->find(roverUptimeLimit_High)) != poseTable->end()))
         {
-            throw QString("LOSolver.setPoints (high limit) failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
-        }
+            // Poses already solved -> Just check them (in the same order as when solving here)
 
-        Eigen::Transform<double, 3, Eigen::Affine> transform_High;
+            throwIfPoseNotValid(poseIter_Low.value(), "low");
+            roverUptimeBasedLocation_Low = poseIter_Low.value().location;
+            roverUptimeBasedOrientation_Low = poseIter_Low.value().orientation;
 
-        if (!loSolver.getTransformMatrix(transform_High))
+            throwIfPoseNotValid(poseIter_High.value(), "high");
+            roverUptimeBasedLocation_High = poseIter_High.value().location;
+            roverUptimeBasedOrientation_High = poseIter_High.value().orientation;
+        }
+        else
         {
-            throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            solvePose(roverUptimeLimit_Low, "low", roverUptimeBasedLocation_Low, roverUptimeBasedOrientation_Low);
+            solvePose(roverUptimeLimit_High, "high", roverUptimeBasedLocation_High, roverUptimeBasedOrientation_High);
         }
-
-        roverUptimeBasedLocation_High = transform_High.translation();
-        roverUptimeBasedOrientation_High = transform_High.linear();
     }
 
-    if (roverUptimeLimit_High - roverUptimeLimit_Low > maxInterpolationTimeRange)
+    if (roverUptimeLimit_High - roverUptimeLimit_Low > int(maxInterpolationTimeRange))
     {
         throw("Maximum allowed time (" + QString::number(maxInterpolationTimeRange) +
                 "ms) for interpolation exceeded. (Interpolation time: " +
                 QString::number(roverUptimeLimit_High - roverUptimeLimit_Low) + ").");
     }
 
-    double fraction = double(uptime - roverUptimeLimit_Low) / (roverUptimeLimit_High - roverUptimeLimit_Low);
+    double fraction = (iTOW - roverUptimeLimit_Low) / (roverUptimeLimit_High - roverUptimeLimit_Low);
 
     Q_ASSERT(fraction >= 0);
     Q_ASSERT(fraction <= 1);
@@ -3274,161 +3597,284 @@ void PostProcessingForm::LOInterpolator::getInterpolatedLocationOrientationTrans
     transform.translation() = interpolatedCoords;
 }
 
-void PostProcessingForm::LOInterpolator::getInterpolatedLocationOrientationTransformMatrix_ITOW(
-        const UBXMessage_RELPOSNED::ITOW iTOW,
-        Eigen::Transform<double, 3, Eigen::Affine>& transform,
-        const unsigned int maxInterpolationTimeRange)
+void PostProcessingForm::LOInterpolator::throwIfPoseNotValid(const Pose& pose, const QString& limitName)
 {
-    const Rover* crovers = owner->rovers;
+    // Same messages as when solving the poses in getInterpolatedLocationOrientationTransformMatrix_Uptime
 
-    if ((iTOW < roverITOWLimit_Low) || (iTOW >= roverITOWLimit_High))
+    if (pose.status == Pose::STATUS_ERROR_SETPOINTS)
+    {
+        throw QString("LOSolver.setPoints (" + limitName + " limit) failed. Error code: " + QString::number(pose.errorCode) + ".");
+    }
+    else if (pose.status == Pose::STATUS_ERROR_TRANSFORMMATRIX)
     {
-        // "Cache miss" -> Find new limiting values
+        throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(pose.errorCode) + ".");
+    }
+}
 
-        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator roverRELPOSNEDS_Low[3];
-        QMap<UBXMessage_RELPOSNED::ITOW, UBXMessage_RELPOSNED>::const_iterator roverRELPOSNEDS_High[3];
+void PostProcessingForm::LOInterpolator::solvePose(const UBXMessage_RELPOSNED::ITOW iTOW, const QString& limitName,
+                                                   Eigen::Vector3d& location, Eigen::Quaterniond& orientation)
+{
+    QVector<Eigen::Vector3d> points;
+    QVector<bool> validity;
 
-        for (int i = 0; i < 3; i++)
-        {
-            roverRELPOSNEDS_Low[i] = crovers[i].relposnedMessages.lowerBound(iTOW);
-            roverRELPOSNEDS_High[i] = crovers[i].relposnedMessages.lowerBound(iTOW);
-        }
+    getRoverPoints(owner->rovers.constData(), owner->rovers.count(), iTOW, points, validity);
 
-        bool iTOWMatch = false;
+    if (!loSolver.setPoints(points, validity))
+    {
+        throw QString("LOSolver.setPoints (" + limitName + " limit) failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+    }
 
-        // Find next ITOW-value found for all rovers
-        while (!iTOWMatch)
-        {
-            // Highest ITOW found from rovers' data is the lowest possible common one
-            UBXMessage_RELPOSNED::ITOW highestITOW = -1;
+    Eigen::Transform<double, 3, Eigen::Affine> transform;
 
-            for (int i = 0; i < 3; i++)
-            {
-                if (roverRELPOSNEDS_High[i] == crovers[i].relposnedMessages.end())
-                {
-                    roverITOWLimit_Low = -1;
-                    roverITOWLimit_High = -1;
-                    throw QString("Can not find higher limit interpolation value for rover" + owner->getRoverIdentString(i) +
-                                  ", ITOW: " + QString::number(iTOW));
-                }
+    if (!loSolver.getTransformMatrix(transform))
+    {
+        throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+    }
 
-                if (roverRELPOSNEDS_High[i].key() > highestITOW)
-                {
-                    highestITOW = roverRELPOSNEDS_High[i].key();
-                }
-            }
+    location = transform.translation();
+    orientation = transform.linear();
+}
 
-            iTOWMatch = true;
+int PostProcessingForm::LOInterpolator::getRoverPoints(const Rover* rovers, const unsigned int numOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW,
+                                                       QVector<Eigen::Vector3d>& points, QVector<bool>& validity)
+{
+    points.resize(numOfRovers);
+    validity.fill(false, numOfRovers);
 
-            for (int i = 0; i < 3; i++)
+    int numOfFound = 0;
+    int numOfFixed = 0;
+
+    for (unsigned int i = 0; i < numOfRovers; i++)
+    {
+        auto relposnedIter = rovers[i].relposnedMessages.constFind(iTOW);
+
+        if (relposnedIter != rovers[i].relposnedMessages.constEnd())
+        {
+            points[i] = Eigen::Vector3d(relposnedIter->relPosN, relposnedIter->relPosE, relposnedIter->relPosD);
+            validity[i] = true;
+            numOfFound++;
+            numOfFixed += (relposnedIter->flag_carrSoln == UBXMessage_RELPOSNED::FIXED) ? 1 : 0;
+        }
+    }
+
+    if ((numOfFixed >= LOSolver::minNumOfPoints) && (numOfFixed < numOfFound))
+    {
+        // Enough antennas with a fixed solution -> leave the others out
+
+        for (unsigned int i = 0; i < numOfRovers; i++)
+        {
+            if (validity[i] && (rovers[i].relposnedMessages.constFind(iTOW)->flag_carrSoln != UBXMessage_RELPOSNED::FIXED))
             {
-                if (roverRELPOSNEDS_High[i].key() != highestITOW)
-                {
-                    // Try to find item matching the highest ITOW
-                    // Or jump to the next higher if match not found
-                    roverRELPOSNEDS_High[i] = crovers[i].relposnedMessages.lowerBound(highestITOW);
-                    iTOWMatch = false;
-                }
+                validity[i] = false;
             }
         }
 
-        roverITOWLimit_High = roverRELPOSNEDS_High[0].key();
+        return numOfFixed;
+    }
+
+    return numOfFound;
+}
+
+UBXMessage_RELPOSNED::ITOW PostProcessingForm::LOInterpolator::findNextCommonITOW(const Rover* rovers, const unsigned int numOfRovers,
+                                                                                  const unsigned int minNumOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW)
+{
+    UBXMessage_RELPOSNED::ITOW candidate = iTOW;
+
+    while (1)
+    {
+        // Lowest ITOW >= candidate in rovers' data and the number of rovers having it
+        UBXMessage_RELPOSNED::ITOW lowestITOW = -1;
+        unsigned int count = 0;
 
-        for (int i = 0; i < 3; i++)
+        for (unsigned int i = 0; i < numOfRovers; i++)
         {
-            // Jump to the messages preceeding the ITOW (if possible)
-            if (roverRELPOSNEDS_Low[i] == crovers[i].relposnedMessages.begin())
+            auto relposnedIter = rovers[i].relposnedMessages.lowerBound(candidate);
+
+            if (relposnedIter == rovers[i].relposnedMessages.end())
             {
-                roverITOWLimit_Low = -1;
-                roverITOWLimit_High = -1;
-                throw QString("Can not find lower limit interpolation value for rover" + owner->getRoverIdentString(i) +
-                              ", ITOW: " + QString::number(iTOW));
+                continue;
+            }
+
+            if ((lowestITOW < 0) || (relposnedIter.key() < lowestITOW))
+            {
+                lowestITOW = relposnedIter.key();
+                count = 1;
+            }
+            else if (relposnedIter.key() == lowestITOW)
+            {
+                count++;
             }
+        }
 
-            roverRELPOSNEDS_Low[i]--;
+        if ((lowestITOW < 0) || (count >= minNumOfRovers))
+        {
+            return lowestITOW;
         }
 
-        iTOWMatch = false;
+        candidate = lowestITOW + 1;
+    }
+}
+
+UBXMessage_RELPOSNED::ITOW PostProcessingForm::LOInterpolator::findPreviousCommonITOW(const Rover* rovers, const unsigned int numOfRovers,
+                                                                                      const unsigned int minNumOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW)
+{
+    UBXMessage_RELPOSNED::ITOW candidate = iTOW;
+
+    while (1)
+    {
+        // Highest ITOW < candidate in rovers' data and the number of rovers having it
+        UBXMessage_RELPOSNED::ITOW highestITOW = -1;
+        unsigned int count = 0;
 
-        while (!iTOWMatch)
+        for (unsigned int i = 0; i < numOfRovers; i++)
         {
-            UBXMessage_RELPOSNED::ITOW lowestITOW = 2e9;
+            auto relposnedIter = rovers[i].relposnedMessages.lowerBound(candidate);
 
-            for (int i = 0; i < 3; i++)
+            if (relposnedIter == rovers[i].relposnedMessages.begin())
             {
-                if (roverRELPOSNEDS_Low[i].key() < lowestITOW)
-                {
-                    lowestITOW = roverRELPOSNEDS_Low[i].key();
-                }
+                continue;
             }
 
-            iTOWMatch = true;
+            relposnedIter--;
 
-            for (int i = 0; i < 3; i++)
+            if (relposnedIter.key() > highestITOW)
             {
-                roverRELPOSNEDS_Low[i] = crovers[i].relposnedMessages.lowerBound(lowestITOW);
-
-                if ((roverRELPOSNEDS_Low[i] == crovers[i].relposnedMessages.end()) || (roverRELPOSNEDS_Low[i].key() != lowestITOW))
-                {
-                    if ((roverRELPOSNEDS_Low[i] == crovers[i].relposnedMessages.end()) || (roverRELPOSNEDS_Low[i] == crovers[i].relposnedMessages.begin()))
-                    {
-                        roverITOWLimit_Low = -1;
-                        roverITOWLimit_High = -1;
-                        throw QString("Can not find lower limit interpolation value for rover" + owner->getRoverIdentString(i) +
-                                      ", ITOW: " + QString::number(iTOW));
-                    }
-
-                    roverRELPOSNEDS_Low[i]--;
-                    iTOWMatch = false;
-                }
+                highestITOW = relposnedIter.key();
+                count = 1;
+            }
+            else if (relposnedIter.key() == highestITOW)
+            {
+                count++;
             }
         }
 
-        roverITOWLimit_Low = roverRELPOSNEDS_Low[0].key();
+        if ((highestITOW < 0) || (count >= minNumOfRovers))
+        {
+            return highestITOW;
+        }
+
+        candidate = highestITOW;
+    }
+}
 
-        Eigen::Vector3d points_Low[3] =
+bool PostProcessingForm::LOInterpolator::getLocationOrientationDeviationLimits_Uptime(
+        const qint64 uptimeStart, const qint64 uptimeEnd,
+        const ClockModel& clockModel,
+        Eigen::Transform<double, 3, Eigen::Affine>& referenceTransform,
+        double& maxTranslationDeviation, double& maxRotationDeviation,
+        const unsigned int maxInterpolationTimeRange)
+{
+    // Interpolation is linear (location) / slerp (orientation) between ITOWs used for interpolation.
+    // Therefore it's enough to check the range's end points and all those ITOWs between them:
+    // Translation deviation is maximal at some of these points.
+    // Rotation deviation inside a segment is limited by (triangle inequality)
+    // deviation at segment's beginning + rotation over the whole segment.
+
+    if (clockModel.isEmpty() ||
+            (clockModel.getSegmentIndex_Uptime(uptimeStart) != clockModel.getSegmentIndex_Uptime(uptimeEnd)))
+    {
+        // Conversion from uptime to ITOW may not be monotonic in range
+        return false;
+    }
+
+    const double iTOWStart = clockModel.getITOW(uptimeStart);
+    const double iTOWEnd = clockModel.getITOW(uptimeEnd);
+
+    QVector<double> iTOWs;
+    iTOWs.append(iTOWStart);
+
+    UBXMessage_RELPOSNED::ITOW interpolationITOW = findNextInterpolationITOW(UBXMessage_RELPOSNED::ITOW(floor(iTOWStart)) + 1);
+
+    while ((interpolationITOW >= 0) && (interpolationITOW < iTOWEnd))
+    {
+        iTOWs.append(interpolationITOW);
+        interpolationITOW = findNextInterpolationITOW(interpolationITOW + 1);
+    }
+
+    if (iTOWEnd > iTOWStart)
+    {
+        iTOWs.append(iTOWEnd);
+    }
+
+    maxTranslationDeviation = 0;
+    maxRotationDeviation = 0;
+
+    Eigen::Transform<double, 3, Eigen::Affine> previousTransform;
+    double previousRotationDeviation = 0;
+
+    for (int i = 0; i < iTOWs.count(); i++)
+    {
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+        try
+        {
+            interpolateAtModelITOW(iTOWs[i], transform, maxInterpolationTimeRange);
+        }
+        catch (QString&)
         {
-            { roverRELPOSNEDS_Low[0]->relPosN, roverRELPOSNEDS_Low[0]->relPosE, roverRELPOSNEDS_Low[0]->relPosD },
-            { roverRELPOSNEDS_Low[1]->relPosN, roverRELPOSNEDS_Low[1]->relPosE, roverRELPOSNEDS_Low[1]->relPosD },
-            { roverRELPOSNEDS_Low[2]->relPosN, roverRELPOSNEDS_Low[2]->relPosE, roverRELPOSNEDS_Low[2]->relPosD },
-        };
+            return false;
+        }
 
-        if (!loSolver.setPoints(points_Low))
+        if (i == 0)
         {
-            throw QString("LOSolver.setPoints (low limit) failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            referenceTransform = transform;
         }
+        else
+        {
+            double translationDeviation = (transform.translation() - referenceTransform.translation()).norm();
+            double rotationDeviation = Eigen::Quaterniond(referenceTransform.linear()).angularDistance(Eigen::Quaterniond(transform.linear()));
+            double segmentRotation = Eigen::Quaterniond(previousTransform.linear()).angularDistance(Eigen::Quaterniond(transform.linear()));
 
-        Eigen::Transform<double, 3, Eigen::Affine> transform_Low;
+            maxTranslationDeviation = std::max(maxTranslationDeviation, translationDeviation);
+            maxRotationDeviation = std::max(maxRotationDeviation, previousRotationDeviation + segmentRotation);
 
-        if (!loSolver.getTransformMatrix(transform_Low))
-        {
-            throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            previousRotationDeviation = rotationDeviation;
         }
 
-        roverITOWBasedLocation_Low = transform_Low.translation();
-        roverITOWBasedOrientation_Low = transform_Low.linear();
+        previousTransform = transform;
+    }
 
-        Eigen::Vector3d points_High[3] =
-        {
-            { roverRELPOSNEDS_High[0]->relPosN, roverRELPOSNEDS_High[0]->relPosE, roverRELPOSNEDS_High[0]->relPosD },
-            { roverRELPOSNEDS_High[1]->relPosN, roverRELPOSNEDS_High[1]->relPosE, roverRELPOSNEDS_High[1]->relPosD },
-            { roverRELPOSNEDS_High[2]->relPosN, roverRELPOSNEDS_High[2]->relPosE, roverRELPOSNEDS_High[2]->relPosD },
-        };
+    return true;
+}
+
+void PostProcessingForm::LOInterpolator::getInterpolatedLocationOrientationTransformMatrix_ITOW(
+        const UBXMessage_RELPOSNED::ITOW iTOW,
+        Eigen::Transform<double, 3, Eigen::Affine>& transform,
+        const unsigned int maxInterpolationTimeRange)
+{
+    const Rover* crovers = owner->rovers.constData();
+    const unsigned int numOfRovers = owner->rovers.count();
+    const unsigned int minNumOfRovers = qMin(numOfRovers, (unsigned int)LOSolver::minNumOfPoints);
+
+    if ((iTOW < roverITOWLimit_Low) || (iTOW >= roverITOWLimit_High))
+    {
+        // "Cache miss" -> Find new limiting values (ITOWs found for enough rovers)
+
+        UBXMessage_RELPOSNED::ITOW newITOWLimit_High = findNextCommonITOW(crovers, numOfRovers, minNumOfRovers, iTOW);
 
-        if (!loSolver.setPoints(points_High))
+        if (newITOWLimit_High < 0)
         {
-            throw QString("LOSolver.setPoints (high limit) failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            roverITOWLimit_Low = -1;
+            roverITOWLimit_High = -1;
+            throw QString("Can not find higher limit interpolation value for at least " + QString::number(minNumOfRovers) +
+                          " rovers, ITOW: " + QString::number(iTOW));
         }
 
-        Eigen::Transform<double, 3, Eigen::Affine> transform_High;
+        UBXMessage_RELPOSNED::ITOW newITOWLimit_Low = findPreviousCommonITOW(crovers, numOfRovers, minNumOfRovers, iTOW);
 
-        if (!loSolver.getTransformMatrix(transform_High))
+        if (newITOWLimit_Low < 0)
         {
-            throw QString("LOSolver.getTransformMatrix failed. Error code: " + QString::number(loSolver.getLastError()) + ".");
+            roverITOWLimit_Low = -1;
+            roverITOWLimit_High = -1;
+            throw QString("Can not find lower limit interpolation value for at least " + QString::number(minNumOfRovers) +
+                          " rovers, ITOW: " + QString::number(iTOW));
         }
 
-        roverITOWBasedLocation_High = transform_High.translation();
-        roverITOWBasedOrientation_High = transform_High.linear();
+        roverITOWLimit_Low = newITOWLimit_Low;
+        roverITOWLimit_High = newITOWLimit_High;
+
+        solvePose(roverITOWLimit_Low, "low", roverITOWBasedLocation_Low, roverITOWBasedOrientation_Low);
+        solvePose(roverITOWLimit_High, "high", roverITOWBasedLocation_High, roverITOWBasedOrientation_High);
     }
 
     if (roverITOWLimit_High - roverITOWLimit_Low > int(maxInterpolationTimeRange))
@@ -3499,6 +3945,33 @@ bool PostProcessingForm::generateLidarTransformMatrices(Eigen::Transform<double,
 
 
 void PostProcessingForm::on_pushButton_Lidar_GenerateScript_clicked()
+{
+    if (fileDialog_Lidar_Script.exec())
+    {
+        QStringList fileNameList = fileDialog_Lidar_Script.selectedFiles();
+
+        if (fileNameList.size() != 0)
+        {
+            fileDialog_Lidar_Script.setDirectory(QFileInfo(fileNameList[0]).path());
+        }
+
+        if (fileNameList.length() != 1)
+        {
+            addLogLine("Lidar script: Multiple file selection not supported. Script not created.");
+            return;
+        }
+
+        if (!confirmOverwrite(fileNameList[0]))
+        {
+            addLogLine("Generating lidar script cancelled.");
+            return;
+        }
+
+        generateScript_Lidar(fileNameList[0]);
+    }
+}
+
+bool PostProcessingForm::generateScript_Lidar(const QString& fileName)
 {
     Eigen::Transform<double, 3, Eigen::Affine> transform_NEDToXYZ;
     Eigen::Transform<double, 3, Eigen::Affine> transform_Lidar_Generated_BeforeRotation;
@@ -3507,44 +3980,34 @@ void PostProcessingForm::on_pushButton_Lidar_GenerateScript_clicked()
 
     if (!generateTransformationMatrix(transform_NEDToXYZ))
     {
-        return;
+        return false;
     }
 
     RPLidarPlausibilityFilter::Settings lidarFilteringSettings;
 
     if (!generateLidarTransformMatrices(transform_Lidar_Generated_BeforeRotation, transform_LidarGenerated_AfterRotation))
     {
-        return;
+        return false;
     }
 
     if (!updateLOSolverReferencePointLocations(loInterpolator_Lidar.loSolver))
     {
-        return;
+        return false;
     }
 
-    getLidarFilteringSettings(lidarFilteringSettings);
-
-    if (fileDialog_Lidar_Script.exec())
-    {
-        QStringList fileNameList = fileDialog_Lidar_Script.selectedFiles();
+    loInterpolator_Lidar.poseTable = &pipelineCache->getPoseTable(rovers.constData(), rovers.count(), loInterpolator_Lidar.loSolver);
 
-        if (fileNameList.size() != 0)
-        {
-            fileDialog_Lidar_Script.setDirectory(QFileInfo(fileNameList[0]).path());
-        }
+    getLidarFilteringSettings(lidarFilteringSettings);
 
-        if (fileNameList.length() != 1)
-        {
-            addLogLine("Lidar script: Multiple file selection not supported. Script not created.");
-            return;
-        }
+    int errorCountBefore = errorCount;
 
+    {
         Lidar::LidarScriptGenerator::Params params;
 
         params.transform_NEDToXYZ = &transform_NEDToXYZ;
         params.transform_AfterRotation = &transform_LidarGenerated_AfterRotation;
         params.transform_BeforeRotation = &transform_Lidar_Generated_BeforeRotation;
-        params.fileName = fileNameList[0];
+        params.fileName = fileName;
         params.tagIdent_BeginNewObject = ui->lineEdit_TagIndicatingBeginningOfNewObject->text();
         params.tagIdent_BeginPoints = ui->lineEdit_TagIndicatingBeginningOfObjectPoints->text();
         params.tagIdent_EndPoints = ui->lineEdit_TagIndicatingEndOfObjectPoints->text();
@@ -3563,7 +4026,7 @@ void PostProcessingForm::on_pushButton_Lidar_GenerateScript_clicked()
         {
             addLogLine("Invalid uptime range, min.");
             ui->lineEdit_Uptime_Min->setFocus();
-            return;
+            return false;
         }
 
         params.uptime_Max = ui->lineEdit_Lidar_Script_UptimeRange_Max->text().toLongLong(&convOk);
@@ -3571,28 +4034,32 @@ void PostProcessingForm::on_pushButton_Lidar_GenerateScript_clicked()
         {
             addLogLine("Invalid uptime range, max.");
             ui->lineEdit_Uptime_Max->setFocus();
-            return;
+            return false;
         }
 
         params.tags = &tags;
-        params.rovers = rovers;
+        params.tagSegmentIndex = &pipelineCache->getTagSegmentIndex(tags, params.tagIdent_BeginNewObject, params.tagIdent_BeginPoints, params.tagIdent_EndPoints);
+        params.rovers = rovers.constData();
+        params.numOfRovers = rovers.count();
         params.lidarRounds = &lidarRounds;
         params.lidarFilteringSettings = &lidarFilteringSettings;
         params.loInterpolator = &loInterpolator_Lidar;
+        params.clockModel = &pipelineCache->getClockModel(rovers.constData(), rovers.count());
+        params.processedRoundCache = pipelineCache->getProcessedRoundCache();
 
         Lidar::LidarScriptGenerator lidarScriptGenerator;
 
-        connect(&lidarScriptGenerator, &Lidar::LidarScriptGenerator::infoMessage,
-                         this, &PostProcessingForm::on_infoMessage);
-
-        connect(&lidarScriptGenerator, &Lidar::LidarScriptGenerator::warningMessage,
-                         this, &PostProcessingForm::on_warningMessage);
+        connectToGeneratorTask(&lidarScriptGenerator);
 
-        connect(&lidarScriptGenerator, &Lidar::LidarScriptGenerator::errorMessage,
-                         this, &PostProcessingForm::on_errorMessage);
+        params.task = generatorTask;
 
-        lidarScriptGenerator.generateLidarScript(params);
+        runGeneratorTask([&]()
+        {
+            lidarScriptGenerator.generateLidarScript(params);
+        });
     }
+
+    return errorCount == errorCountBefore;
 }
 
 bool PostProcessingForm::loadOperations(QPlainTextEdit* plainTextEdit)
@@ -3650,6 +4117,85 @@ void PostProcessingForm::on_errorMessage(const QString& errorString)
     addLogLine("Error: " + errorString);
 }
 
+bool PostProcessingForm::runGeneratorTask(const std::function<void(void)>& work)
+{
+    // Worker reads rovers, tags, lidar rounds etc. directly -> nothing that could change them may be used during the run
+    ui->tabWidget_Lidar->setEnabled(false);
+    ui->pushButton_LoadEditableFieldsFromFile->setEnabled(false);
+    ui->pushButton_SaveEditableFieldsToFile->setEnabled(false);
+
+    ui->progressBar_Generator->setValue(0);
+    ui->pushButton_CancelGenerator->setEnabled(true);
+
+    bool completed = generatorTask->run(work);
+
+    ui->pushButton_CancelGenerator->setEnabled(false);
+
+    ui->tabWidget_Lidar->setEnabled(true);
+    ui->pushButton_LoadEditableFieldsFromFile->setEnabled(true);
+    ui->pushButton_SaveEditableFieldsToFile->setEnabled(true);
+
+    if (!completed)
+    {
+        addLogLine("Error: Cancelled by user.");
+    }
+
+    return completed;
+}
+
+template <typename Generator>
+void PostProcessingForm::connectToGeneratorTask(const Generator* generator)
+{
+    connect(generator, &Generator::infoMessage,
+            generatorTask, &GeneratorTask::addInfoMessage, Qt::DirectConnection);
+
+    connect(generator, &Generator::warningMessage,
+            generatorTask, &GeneratorTask::addWarningMessage, Qt::DirectConnection);
+
+    connect(generator, &Generator::errorMessage,
+            generatorTask, &GeneratorTask::addErrorMessage, Qt::DirectConnection);
+}
+
+void PostProcessingForm::generatorTask_ProgressChanged(const qint64 processed, const qint64 total)
+{
+    int value = 0;
+
+    if (total > 0)
+    {
+        value = int((qBound(qint64(0), processed, total) * ui->progressBar_Generator->maximum()) / total);
+    }
+
+    ui->progressBar_Generator->setValue(value);
+}
+
+void PostProcessingForm::on_pushButton_CancelGenerator_clicked()
+{
+    generatorTask->requestCancel();
+    ui->pushButton_CancelGenerator->setEnabled(false);
+    addLogLine("Cancelling...");
+}
+
+bool PostProcessingForm::confirmOverwrite(const QString& fileName)
+{
+    if (!QFile::exists(fileName))
+    {
+        return true;
+    }
+
+    QMessageBox msgBox;
+    msgBox.setText("File already exists.");
+    msgBox.setInformativeText("How to proceed?");
+
+    QPushButton *overwriteButton = msgBox.addButton(tr("Overwrite"), QMessageBox::ActionRole);
+    QPushButton *cancelButton = msgBox.addButton(QMessageBox::Cancel);
+
+    msgBox.setDefaultButton(cancelButton);
+
+    msgBox.exec();
+
+    return msgBox.clickedButton() == overwriteButton;
+}
+
 bool PostProcessingForm::saveOperations(QPlainTextEdit* plainTextEdit)
 {
     if (fileDialog_Operations_Save.exec())
@@ -3850,20 +4396,37 @@ void PostProcessingForm::on_pushButton_SaveEditableFieldsToFile_clicked()
 }
 
 void PostProcessingForm::on_pushButton_RasterCameras_Script_Process_clicked()
+{
+    QString rasterCameraString;
+
+    if (generateRasterCameras(rasterCameraString))
+    {
+        QStringList lines = rasterCameraString.split("\n");
+
+        for (int i = 0; i < lines.size(); i++)
+        {
+            ui->logView_Log->addLine(lines[i]);
+        }
+    }
+}
+
+bool PostProcessingForm::generateRasterCameras(QString& rasterCameraString)
 {
     Eigen::Transform<double, 3, Eigen::Affine> transform_NEDToXYZ;
     LOInterpolator loInterpolator(this);
 
     if (!generateTransformationMatrix(transform_NEDToXYZ))
     {
-        return;
+        return false;
     }
 
     if (!updateLOSolverReferencePointLocations(loInterpolator.loSolver))
     {
-        return;
+        return false;
     }
 
+    loInterpolator.poseTable = &pipelineCache->getPoseTable(rovers.constData(), rovers.count(), loInterpolator.loSolver);
+
     TransformMatrixGenerator matrixGenerator;
 
     Eigen::Transform<double, 3, Eigen::Affine> transform_Generated;
@@ -3895,7 +4458,7 @@ void PostProcessingForm::on_pushButton_RasterCameras_Script_Process_clicked()
         ui->plainTextEdit_RasterCameras_TransformMatrixScript->setTextCursor(cursor);
         ui->plainTextEdit_RasterCameras_TransformMatrixScript->setFocus();
 
-        return;
+        return false;
     }
 
     RasterCameraGenerator::Params params;
@@ -3905,27 +4468,37 @@ void PostProcessingForm::on_pushButton_RasterCameras_Script_Process_clicked()
     QStringList lines = ui->plainTextEdit_RasterCameras_CameraScript->document()->toPlainText().split("\n");
     params.lines = &lines;
 
-    params.rovers = rovers;
+    params.rovers = rovers.constData();
+    params.numOfRovers = rovers.count();
     params.loInterpolator = &loInterpolator;
+    params.clockModel = &pipelineCache->getClockModel(rovers.constData(), rovers.count());
 
     RasterCameraGenerator rasterCameraGenerator;
 
-    connect(&rasterCameraGenerator, &RasterCameraGenerator::infoMessage,
-                     this, &PostProcessingForm::on_infoMessage);
+    connectToGeneratorTask(&rasterCameraGenerator);
 
-    connect(&rasterCameraGenerator, &RasterCameraGenerator::warningMessage,
-                     this, &PostProcessingForm::on_warningMessage);
+    int errorCountBefore = errorCount;
 
-    connect(&rasterCameraGenerator, &RasterCameraGenerator::errorMessage,
-                     this, &PostProcessingForm::on_errorMessage);
+    // Issue can't be handled in the worker thread (cursor is moved to it) -> passed here
+    bool issueThrown = false;
+    RasterCameraGenerator::Issue issue;
 
-    try
+    params.task = generatorTask;
+
+    runGeneratorTask([&]()
     {
-        QString rasterCameraString = rasterCameraGenerator.generate(params);
+        try
+        {
+            rasterCameraString = rasterCameraGenerator.generate(params);
+        }
+        catch (RasterCameraGenerator::Issue& issueCaught)
+        {
+            issue = issueCaught;
+            issueThrown = true;
+        }
+    });
 
-        ui->plainTextEdit_Log->appendPlainText(rasterCameraString);
-    }
-    catch (RasterCameraGenerator::Issue& issue)
+    if (issueThrown)
     {
         addLogLine("Generating raster cameras failed. Error: " + issue.text +
                    " Row: " + QString::number(issue.item.lineNumber + 1) + ", column: " + QString::number(issue.item.firstCol + 1));
@@ -3946,8 +4519,10 @@ void PostProcessingForm::on_pushButton_RasterCameras_Script_Process_clicked()
         ui->plainTextEdit_RasterCameras_CameraScript->setTextCursor(cursor);
         ui->plainTextEdit_RasterCameras_CameraScript->setFocus();
 
-        return;
+        return false;
     }
+
+    return errorCount == errorCountBefore;
 }
 
 
@@ -4056,76 +4631,117 @@ void PostProcessingForm::on_pushButton_RasterCameras_Script_Save_clicked()
     }
 }
 
-void PostProcessingForm::generateAveragedRoverUptimeSync(const Rover* rovers, QMap<qint64, UBXMessage_RELPOSNED::ITOW>& averagedRoverUptimeSync, unsigned int numOfAveragedRovers)
+const QStringList PostProcessingForm::batchOutputNames =
 {
-    // Create a map where uptimes for all equal ITOWs are the same.
-    // This makes processing (like interpolating locations/orientations) easier.
-    // Uptimes here are calculated as averages from rover values (for each ITOW)
-
-    averagedRoverUptimeSync.clear();
+    "stylus-pointclouds",
+    "stylus-moviescript",
+    "lo-script",
+    "lidar-pointclouds",
+    "lidar-script",
+    "lidar-timeshift",
+    "raster-cameras",
+};
 
-    Q_ASSERT(numOfAveragedRovers <= 3);
+int PostProcessingForm::runBatch(const QString& parametersFileName, const QString& baseFileName, const QStringList& outputs, const QDir& outputDirectory)
+{
+    batchMode = true;
+    batchSessionName = QFileInfo(baseFileName).fileName();
+    errorCount = 0;
 
-    for (unsigned int i = 0; i < numOfAveragedRovers; i++)
+    if (!QFile::exists(parametersFileName))
     {
-        if (rovers[i].roverSyncData.isEmpty())
-        {
-            // Nothing to do
-            return;
-        }
+        addLogLine("Error: Can't open parameter file \"" + parametersFileName + "\".");
+        return 1;
     }
 
-    qint64 currentITOW = rovers[0].reverseSync.firstKey();
+    QSettings settings(parametersFileName, QSettings::IniFormat);
+    loadParametersFromQSettings(settings);
+    addLogLine("Parameters read from file \"" + QFileInfo(parametersFileName).fileName() + "\".");
 
-    QMap<UBXMessage_RELPOSNED::ITOW, qint64>::const_iterator iTOWIterators[3];
+    addAllData(QStringList(baseFileName), false);
 
-    while (1)
+    if (!outputDirectory.exists() && !outputDirectory.mkpath("."))
     {
-        for (unsigned int i = 0; i < numOfAveragedRovers; i++)
-        {
-            iTOWIterators[i] = rovers[i].reverseSync.lowerBound(currentITOW);
-        }
-
-        bool dataLeft = false;
+        addLogLine("Error: Can't create output directory \"" + outputDirectory.path() + "\".");
+        return 1;
+    }
 
-        for (unsigned int i = 0; i < numOfAveragedRovers; i++)
-        {
-            if (iTOWIterators[i] != rovers[i].reverseSync.end())
-            {
-                dataLeft = true;
-                break;
-            }
-        }
+    bool allSucceeded = (errorCount == 0);
 
-        if (!dataLeft)
-        {
-            break;
-        }
+    for (const QString& output : outputs)
+    {
+        addLogLine("Generating output \"" + output + "\"...");
 
-        qint64 uptimeSum = 0;
-        unsigned int numberOfRoverRELPOSNEDsWithSameITOW = 0;
+        bool succeeded = false;
 
-        for (unsigned int i = 0; i < numOfAveragedRovers; i++)
+        if ((output == "stylus-pointclouds") || (output == "lidar-pointclouds"))
         {
-            if ((iTOWIterators[i] != rovers[i].reverseSync.end()) &&
-                    (iTOWIterators[i].key() == currentITOW))
+            // Point cloud generators create multiple files -> separate directory per session to prevent name collisions
+            QDir pointCloudDirectory(outputDirectory.filePath(batchSessionName + "_" + output));
+
+            if (!pointCloudDirectory.mkpath("."))
             {
-                uptimeSum += iTOWIterators[i].value();
-                numberOfRoverRELPOSNEDsWithSameITOW++;
+                addLogLine("Error: Can't create directory \"" + pointCloudDirectory.path() + "\".");
+            }
+            else if (output == "stylus-pointclouds")
+            {
+                succeeded = generatePointClouds_Stylus(pointCloudDirectory);
             }
             else
             {
-                // Only allow rovers A, AB or ABC (not AC, BC etc)
-                break;
+                succeeded = generatePointClouds_Lidar(pointCloudDirectory);
             }
         }
+        else if (output == "stylus-moviescript")
+        {
+            succeeded = generateMovieScript_Stylus(outputDirectory.filePath(batchSessionName + ".MovieScript"));
+        }
+        else if (output == "lo-script")
+        {
+            succeeded = generateScript_LOSolver(outputDirectory.filePath(batchSessionName + ".LOScript"));
+        }
+        else if (output == "lidar-script")
+        {
+            succeeded = generateScript_Lidar(outputDirectory.filePath(batchSessionName + ".LidarScript"));
+        }
+        else if (output == "lidar-timeshift")
+        {
+            // Calibrated time shift is also used by subsequent lidar outputs
+            succeeded = calibrateTimeShift_Lidar(outputDirectory.filePath(batchSessionName + "_TimeShiftCalibration.csv"));
+        }
+        else if (output == "raster-cameras")
+        {
+            QString rasterCameraString;
+
+            if (generateRasterCameras(rasterCameraString))
+            {
+                QFile rasterCameraFile(outputDirectory.filePath(batchSessionName + ".RasterCameras"));
 
-        if (numberOfRoverRELPOSNEDsWithSameITOW >= numOfAveragedRovers)
+                if (rasterCameraFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+                {
+                    QTextStream textStream(&rasterCameraFile);
+                    textStream << rasterCameraString;
+                    succeeded = true;
+                }
+                else
+                {
+                    addLogLine("Error: Can't open file \"" + rasterCameraFile.fileName() + "\".");
+                }
+            }
+        }
+        else
         {
-            averagedRoverUptimeSync[uptimeSum / numberOfRoverRELPOSNEDsWithSameITOW] = currentITOW;
+            addLogLine("Error: Unknown output \"" + output + "\".");
         }
 
-        currentITOW++;
+        if (!succeeded)
+        {
+            addLogLine("Error: Generating output \"" + output + "\" failed.");
+            allSucceeded = false;
+        }
     }
-}
 
+    addLogLine(allSucceeded ? "Batch processing finished." : "Error: Batch processing finished with errors.");
+
+    return allSucceeded ? 0 : 1;
+}
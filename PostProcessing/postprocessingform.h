@@ -24,6 +24,8 @@
 #ifndef POSTPROCESSINGFORM_H
 #define POSTPROCESSINGFORM_H
 
+#include <functional>
+
 #include <QTime>
 #include <QWidget>
 #include <QMap>
@@ -46,6 +48,10 @@ namespace Ui {
 class PostProcessingForm;
 }
 
+class PipelineCache;
+class ClockModel;
+class GeneratorTask;
+
 /**
  * @brief Declaration for a form that allows post-processing based on the logged data.
  *
@@ -129,10 +135,70 @@ public:
     class LOInterpolator
     {
     public:
+        /**
+         * @brief Location/orientation solved at one (averaged) sync point
+         */
+        class Pose
+        {
+        public:
+            enum Status
+            {
+                STATUS_VALID = 0,
+                STATUS_ERROR_SETPOINTS,         //!< LOSolver::setPoints failed
+                STATUS_ERROR_TRANSFORMMATRIX,   //!< LOSolver::getTransformMatrix failed
+            };
+
+            Status status = STATUS_VALID;
+            LOSolver::ErrorCode errorCode = LOSolver::ERROR_NONE;  //!< LOSolver's error code if status is not valid
+            Eigen::Vector3d location;
+            Eigen::Quaterniond orientation;
+        };
+
         LOInterpolator(PostProcessingForm* owner);
 
+        /**
+         * @brief Collects rovers' RELPOSNED-coordinates at one ITOW for LOSolver
+         *
+         * Rovers without a RELPOSNED-message at the ITOW are marked invalid. If at least
+         * LOSolver::minNumOfPoints rovers have a fixed carrier phase solution, rovers with a floating
+         * (or no) solution are also marked invalid. Cost is linear in the number of rovers.
+         * @param rovers Rovers
+         * @param numOfRovers Number of rovers
+         * @param iTOW ITOW
+         * @param points Coordinates (numOfRovers items)
+         * @param validity Validity of the coordinates (numOfRovers items)
+         * @return Number of valid coordinates
+         */
+        static int getRoverPoints(const Rover* rovers, const unsigned int numOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW,
+                                  QVector<Eigen::Vector3d>& points, QVector<bool>& validity);
+
+        /**
+         * @brief Returns the first ITOW (>= iTOW) having RELPOSNED-data for at least minNumOfRovers rovers (N-way join)
+         * @return ITOW or -1 if not found
+         */
+        static UBXMessage_RELPOSNED::ITOW findNextCommonITOW(const Rover* rovers, const unsigned int numOfRovers,
+                                                             const unsigned int minNumOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW);
+
+        /**
+         * @brief Returns the last ITOW (< iTOW) having RELPOSNED-data for at least minNumOfRovers rovers (N-way join)
+         * @return ITOW or -1 if not found
+         */
+        static UBXMessage_RELPOSNED::ITOW findPreviousCommonITOW(const Rover* rovers, const unsigned int numOfRovers,
+                                                                 const unsigned int minNumOfRovers, const UBXMessage_RELPOSNED::ITOW iTOW);
+
+        /**
+         * @brief Interpolates location/orientation at uptime
+         *
+         * Uptime is converted into ITOW using clockModel and interpolated between
+         * the closest ITOWs having RELPOSNED-data for enough rovers (or poses in poseTable if set).
+         * @param uptime Uptime
+         * @param clockModel Uptime <-> ITOW model (see ClockModel)
+         * @param transform Interpolated transform
+         * @param maxInterpolationTimeRange Max time (ms) between ITOWs used for interpolation
+         * Throws QString if interpolation fails.
+         */
         void getInterpolatedLocationOrientationTransformMatrix_Uptime(
-                const qint64 uptime, const QMap<qint64, UBXMessage_RELPOSNED::ITOW>& averagedRoverUptimeSync,
+                const qint64 uptime, const ClockModel& clockModel,
                 Eigen::Transform<double, 3, Eigen::Affine>& transform,
                 const unsigned int maxInterpolationTimeRange = 500);
 
@@ -141,13 +207,51 @@ public:
                 Eigen::Transform<double, 3, Eigen::Affine>& transform,
                 const unsigned int maxInterpolationTimeRange = 500);
 
+        /**
+         * @brief Returns conservative limits for location/orientation changes in a time range
+         * @param uptimeStart First uptime in range
+         * @param uptimeEnd Last uptime in range
+         * @param clockModel See getInterpolatedLocationOrientationTransformMatrix_Uptime
+         * @param referenceTransform Transform (interpolated) at uptimeStart
+         * @param maxTranslationDeviation Maximum distance between referenceTransform's translation and any interpolated translation in range
+         * @param maxRotationDeviation Upper limit (radians) for rotation angle between referenceTransform's orientation and any interpolated orientation in range
+         * @param maxInterpolationTimeRange See getInterpolatedLocationOrientationTransformMatrix_Uptime
+         * @return true if getInterpolatedLocationOrientationTransformMatrix_Uptime succeeds for all uptimes in range (and limits are therefore valid).
+         *         Ranges crossing clock model's segments are not supported (false returned).
+         */
+        bool getLocationOrientationDeviationLimits_Uptime(
+                const qint64 uptimeStart, const qint64 uptimeEnd,
+                const ClockModel& clockModel,
+                Eigen::Transform<double, 3, Eigen::Affine>& referenceTransform,
+                double& maxTranslationDeviation, double& maxRotationDeviation,
+                const unsigned int maxInterpolationTimeRange = 500);
+
         LOSolver loSolver;  // This must be initialized by user of this class before using the interpolation function!
 
+        /**
+         * @brief Poses solved beforehand for every ITOW having RELPOSNED-data for enough rovers (see PipelineCache::getPoseTable)
+         *
+         * If set, getInterpolatedLocationOrientationTransformMatrix_Uptime uses these instead
+         * of solving the poses with loSolver (results are identical).
+         */
+        const QMap<UBXMessage_RELPOSNED::ITOW, Pose>* poseTable = nullptr;
+
     private:
         PostProcessingForm* owner = nullptr;
 
-        qint64 roverUptimeLimit_Low = -1;
-        qint64 roverUptimeLimit_High = -1;
+        static void throwIfPoseNotValid(const Pose& pose, const QString& limitName);   //!< Throws the same message as solving the pose would have
+
+        //! Solves pose from rovers' coordinates at iTOW using loSolver. Throws QString if solving fails
+        void solvePose(const UBXMessage_RELPOSNED::ITOW iTOW, const QString& limitName, Eigen::Vector3d& location, Eigen::Quaterniond& orientation);
+
+        //! Interpolates at (fractional) ITOW converted from uptime. Throws QString if interpolation fails
+        void interpolateAtModelITOW(const double iTOW, Eigen::Transform<double, 3, Eigen::Affine>& transform, const unsigned int maxInterpolationTimeRange);
+
+        UBXMessage_RELPOSNED::ITOW findNextInterpolationITOW(const UBXMessage_RELPOSNED::ITOW iTOW) const;       //!< First ITOW >= iTOW in poseTable or rovers' data (-1 if not found)
+        UBXMessage_RELPOSNED::ITOW findPreviousInterpolationITOW(const UBXMessage_RELPOSNED::ITOW iTOW) const;   //!< Last ITOW < iTOW in poseTable or rovers' data (-1 if not found)
+
+        UBXMessage_RELPOSNED::ITOW roverUptimeLimit_Low = -1;       //!< ITOW of the lower limit for uptime-based interpolation
+        UBXMessage_RELPOSNED::ITOW roverUptimeLimit_High = -1;      //!< ITOW of the higher limit for uptime-based interpolation
         Eigen::Vector3d roverUptimeBasedLocation_Low;
         Eigen::Vector3d roverUptimeBasedLocation_High;
         Eigen::Quaterniond roverUptimeBasedOrientation_Low;
@@ -166,7 +270,23 @@ public:
     ~PostProcessingForm();
 
     static QString getRoverIdentString(const unsigned int roverId);
-    static void generateAveragedRoverUptimeSync(const Rover* rovers, QMap<qint64, UBXMessage_RELPOSNED::ITOW> &averagedRoverUptimeSync, unsigned int numOfAveragedRovers = 3);
+
+    static const int maxNumOfRovers = 6;    //!< Max number of rovers (=antennas) in post processing
+
+    static const QStringList batchOutputNames;  //!< Names of the outputs runBatch can generate
+
+    /**
+     * @brief Processes one logging session without any user interaction (used in command line batch mode).
+     *
+     * Form doesn't need to be shown. Log lines are also written to stdout and
+     * parameters are not saved to application's settings when form is destroyed.
+     * @param parametersFileName Parameter file (.PPParameters, as saved by "Save editable fields to file")
+     * @param baseFileName Base file name of the session (file name without suffixes like "_RoverA_RELPOSNED.ubx")
+     * @param outputs Outputs to generate (see batchOutputNames)
+     * @param outputDirectory Directory where outputs are written to
+     * @return 0 if all outputs generated without errors, 1 otherwise
+     */
+    int runBatch(const QString& parametersFileName, const QString& baseFileName, const QStringList& outputs, const QDir& outputDirectory);
 
 protected:
     void showEvent(QShowEvent* event);  //!< Initializes some things that can't be initialized in constructor
@@ -185,6 +305,18 @@ private slots:
 
     void on_pushButton_ClearAll_clicked();
 
+    void on_spinBox_MaxLogLines_valueChanged(int arg1);
+
+    void on_checkBox_PauseLog_stateChanged(int arg1);
+
+    void on_lineEdit_LogFilter_textChanged(const QString& arg1);
+
+    void logView_CountersChanged(void);
+
+    void generatorTask_ProgressChanged(const qint64 processed, const qint64 total);
+
+    void on_pushButton_CancelGenerator_clicked();
+
     void on_pushButton_AddRELPOSNEDData_RoverB_clicked();
 
     void on_pushButton_AddTagData_clicked();
@@ -244,6 +376,8 @@ private slots:
 
     void on_pushButton_ValidateAntennaLocations_clicked();
 
+    void on_spinBox_NumOfAntennas_LOSolver_valueChanged(int numOfAntennas);
+
     void on_pushButton_LOSolver_GenerateScript_clicked();
 
     void on_pushButton_AddLidarData_clicked();
@@ -254,6 +388,8 @@ private slots:
 
     void on_pushButton_Lidar_GenerateScript_clicked();
 
+    void on_pushButton_Lidar_CalibrateTimeShift_clicked();
+
     void on_pushButton_Lidar_OperationsBeforeRotation_Load_clicked();
 
     void on_pushButton_Lidar_OperationsBeforeRotation_Save_clicked();
@@ -326,10 +462,13 @@ private:
 
     QMap<qint64, DistanceItem> distances;
 
-    Rover rovers[3];
+    QVector<Rover> rovers;      //!< Rovers (number set by the antenna count in location/orientation solver settings)
 
     QMap<qint64, LidarRound> lidarRounds;
 
+    PipelineCache* pipelineCache = nullptr;     //!< Intermediate results shared between generator runs
+    GeneratorTask* generatorTask = nullptr;     //!< Runs generators in a worker thread (see runGeneratorTask)
+
     bool onShowInitializationsDone = false;
     QFileDialog fileDialog_UBX;
     QFileDialog fileDialog_Tags;
@@ -376,6 +515,7 @@ private:
     void addSyncData(const QStringList& fileNames);
     void addLidarData(const QStringList& fileNames);
     void addAllData(const bool includeParameters);
+    void addAllData(const QStringList& baseFileNames, const bool includeParameters);
 
     void loadTransformation(const QString fileName);
 
@@ -391,6 +531,8 @@ private:
 
     bool updateLOSolverReferencePointLocations(LOSolver& loSolver);
 
+    void setNumOfRovers(const int numOfRovers);     //!< Resizes rovers and antenna locations table (data of removed rovers is dropped)
+
     void syncLogFileDialogDirectories(const QString dir, const bool savesetting);
 
     void getLidarFilteringSettings(RPLidarPlausibilityFilter::Settings& lidarFilteringSettings);
@@ -404,6 +546,46 @@ private:
     void saveParametersToQSettings(QSettings& settings);
     void loadParametersFromQSettings(QSettings& settings);
 
+    bool generatePointClouds_Stylus(const QDir& directory);
+    bool generateMovieScript_Stylus(const QString& fileName);
+    bool generateScript_LOSolver(const QString& fileName);
+    bool generatePointClouds_Lidar(const QDir& directory);
+    bool generateScript_Lidar(const QString& fileName);
+    bool calibrateTimeShift_Lidar(const QString& csvFileName);  //!< Searches the sharpest lidar time shift, sets it to spinBox_Lidar_TimeShift and writes score curve to csvFileName (if not empty)
+    bool generateRasterCameras(QString& rasterCameraString);
+
+    /**
+     * @brief Runs work (generator) in a worker thread using generatorTask
+     * @param work Function to run. Must not touch any widgets (read all parameters from UI before).
+     * @return false if cancelled (error is logged)
+     *
+     * Controls that could change the data used by the generator are disabled during the run.
+     * Generator's signals must be connected to generatorTask (see connectToGeneratorTask).
+     */
+    bool runGeneratorTask(const std::function<void(void)>& work);
+
+    /**
+     * @brief Connects generator's info/warning/errorMessage-signals to generatorTask's add*Message-slots (Qt::DirectConnection)
+     * @param generator Generator (connections are removed when it is destroyed)
+     */
+    template <typename Generator>
+    void connectToGeneratorTask(const Generator* generator);
+
+    bool confirmOverwrite(const QString& fileName);     //!< Asks user whether to overwrite an existing file (returns true if file doesn't exist)
+
+    bool batchMode = false;     //!< true when running without user interaction (see runBatch)
+    QString batchSessionName;   //!< Session name added to log lines written to stdout in batch mode
+    int errorCount = 0;         //!< Number of error lines logged (generators' success is checked by comparing this)
+
+    enum LogCategory
+    {
+        LOGCATEGORY_INFO = 0,
+        LOGCATEGORY_WARNING,
+        LOGCATEGORY_ERROR,
+    };
+
+    QElapsedTimer logEventProcessingTimer;  //!< Limits event processing done in addLogLine
+
 signals:
     void replayData_Rover(const UBXMessage&, const unsigned int roverId);  //!< New data for rover
 
@@ -17,6 +17,10 @@
 */
 
 #include <QDebug>
+#include <QtConcurrent>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QTextStream>
 
 #include "rastercameragenerator.h"
 #include "EasyEXIF/exif.h"
@@ -299,17 +303,108 @@ QDateTime RasterCameraGenerator::readEXIFDateTimeFromString(QString dateTimeStri
     }
 }
 
-QDateTime RasterCameraGenerator::readEXIFDateTimeFromFile(const QString fileName)
+QDateTime RasterCameraGenerator::readEXIFDateTimeFromFile(const QString& fileName)
 {
+    // Only JPEG-markers are walked through until the EXIF (APP1) segment is found.
+    // This way only a few kilobytes (instead of whole image) needs to be read per file.
+    QDateTime dateTime;
+
     QFile file(fileName);
-    file.open(QIODevice::ReadOnly | QIODevice::ExistingOnly);
 
-    QByteArray fileData = file.readAll();
+    if (!file.open(QIODevice::ReadOnly | QIODevice::ExistingOnly))
+    {
+        return dateTime;
+    }
 
-    easyexif::EXIFInfo exifInfo;
-    exifInfo.parseFrom((unsigned char*)fileData.data(), fileData.size());
+    QByteArray soi = file.read(2);
 
-    QDateTime dateTime;
+    if ((soi.size() != 2) || ((unsigned char)soi[0] != 0xFF) || ((unsigned char)soi[1] != 0xD8))
+    {
+        return dateTime;
+    }
+
+    QByteArray exifSegment;
+
+    while (!file.atEnd())
+    {
+        QByteArray marker = file.read(2);
+
+        if ((marker.size() != 2) || ((unsigned char)marker[0] != 0xFF))
+        {
+            return dateTime;
+        }
+
+        unsigned char markerType = (unsigned char)marker[1];
+
+        // Fill bytes
+        while (markerType == 0xFF)
+        {
+            char nextByte;
+
+            if (!file.getChar(&nextByte))
+            {
+                return dateTime;
+            }
+
+            markerType = (unsigned char)nextByte;
+        }
+
+        if ((markerType == 0xDA) || (markerType == 0xD9))
+        {
+            // Start of scan / end of image -> no EXIF-data in headers
+            return dateTime;
+        }
+
+        if (((markerType >= 0xD0) && (markerType <= 0xD7)) || (markerType == 0x01))
+        {
+            // Markers without length
+            continue;
+        }
+
+        QByteArray lengthBytes = file.read(2);
+
+        if (lengthBytes.size() != 2)
+        {
+            return dateTime;
+        }
+
+        int segmentLength = (((unsigned char)lengthBytes[0]) << 8) | ((unsigned char)lengthBytes[1]);
+
+        if (segmentLength < 2)
+        {
+            return dateTime;
+        }
+
+        if (markerType == 0xE1)
+        {
+            QByteArray segment = file.read(segmentLength - 2);
+
+            if (segment.size() != segmentLength - 2)
+            {
+                return dateTime;
+            }
+
+            if (segment.startsWith(QByteArray("Exif\0\0", 6)))
+            {
+                exifSegment = segment;
+                break;
+            }
+
+            // Other APP1-segments (like XMP) are skipped
+        }
+        else if (!file.seek(file.pos() + segmentLength - 2))
+        {
+            return dateTime;
+        }
+    }
+
+    if (exifSegment.isEmpty())
+    {
+        return dateTime;
+    }
+
+    easyexif::EXIFInfo exifInfo;
+    exifInfo.parseFromEXIFSegment((unsigned char*)exifSegment.data(), exifSegment.size());
 
     // Prefer "Original" date&time
     // (There was some info somewhere that this may not be available, so fall back to others if necessary)
@@ -329,6 +424,187 @@ QDateTime RasterCameraGenerator::readEXIFDateTimeFromFile(const QString fileName
     return dateTime;
 }
 
+QString RasterCameraGenerator::getEXIFTimeCacheFileName(const QDir& dir)
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+    if (cacheDir.isEmpty())
+    {
+        return QString();
+    }
+
+    QByteArray pathHash = QCryptographicHash::hash(dir.absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return cacheDir + "/EXIFTimes_" + QString::fromLatin1(pathHash) + ".txt";
+}
+
+QMap<QString, RasterCameraGenerator::EXIFTimeCacheItem> RasterCameraGenerator::loadEXIFTimeCache(const QDir& dir)
+{
+    QMap<QString, EXIFTimeCacheItem> cache;
+
+    QString cacheFileName = getEXIFTimeCacheFileName(dir);
+
+    if (cacheFileName.isEmpty())
+    {
+        return cache;
+    }
+
+    QFile cacheFile(cacheFileName);
+
+    if (!cacheFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return cache;
+    }
+
+    QTextStream cacheStream(&cacheFile);
+
+    // Format (one line per file): file name<TAB>file size<TAB>last modified (ms since epoch)<TAB>EXIF date/time (ISO)
+    while (!cacheStream.atEnd())
+    {
+        QStringList fields = cacheStream.readLine().split('\t');
+
+        if (fields.size() != 4)
+        {
+            continue;
+        }
+
+        EXIFTimeCacheItem item;
+        bool sizeOk, modifiedOk;
+
+        item.fileSize = fields[1].toLongLong(&sizeOk);
+        item.lastModified = fields[2].toLongLong(&modifiedOk);
+        item.dateTime = QDateTime::fromString(fields[3], Qt::ISODate);
+
+        if (sizeOk && modifiedOk && item.dateTime.isValid())
+        {
+            cache.insert(fields[0], item);
+        }
+    }
+
+    return cache;
+}
+
+void RasterCameraGenerator::saveEXIFTimeCache(const QDir& dir, const QMap<QString, EXIFTimeCacheItem>& cache)
+{
+    QString cacheFileName = getEXIFTimeCacheFileName(dir);
+
+    if (cacheFileName.isEmpty() || !QDir().mkpath(QFileInfo(cacheFileName).path()))
+    {
+        return;
+    }
+
+    QFile cacheFile(cacheFileName);
+
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        // Cache is only an optimization -> failing to write it is not an error
+        return;
+    }
+
+    QTextStream cacheStream(&cacheFile);
+
+    QMap<QString, EXIFTimeCacheItem>::const_iterator iter = cache.constBegin();
+
+    while (iter != cache.constEnd())
+    {
+        cacheStream << iter.key() << "\t" << iter.value().fileSize << "\t" <<
+                       iter.value().lastModified << "\t" << iter.value().dateTime.toString(Qt::ISODate) << "\n";
+        iter++;
+    }
+}
+
+QVector<RasterCameraGenerator::OutputFormatSegment> RasterCameraGenerator::compileOutputFormatString(const QString& formatString)
+{
+    static const struct
+    {
+        const char* placeholder;
+        OutputFormatSegment::Type type;
+    } placeholders[] =
+    {
+        { "%{TRANSLATION_X}", OutputFormatSegment::ST_TRANSLATION_X },
+        { "%{TRANSLATION_Y}", OutputFormatSegment::ST_TRANSLATION_Y },
+        { "%{TRANSLATION_Z}", OutputFormatSegment::ST_TRANSLATION_Z },
+        { "%{LINEAR_11}", OutputFormatSegment::ST_LINEAR_11 },
+        { "%{LINEAR_12}", OutputFormatSegment::ST_LINEAR_12 },
+        { "%{LINEAR_13}", OutputFormatSegment::ST_LINEAR_13 },
+        { "%{LINEAR_21}", OutputFormatSegment::ST_LINEAR_21 },
+        { "%{LINEAR_22}", OutputFormatSegment::ST_LINEAR_22 },
+        { "%{LINEAR_23}", OutputFormatSegment::ST_LINEAR_23 },
+        { "%{LINEAR_31}", OutputFormatSegment::ST_LINEAR_31 },
+        { "%{LINEAR_32}", OutputFormatSegment::ST_LINEAR_32 },
+        { "%{LINEAR_33}", OutputFormatSegment::ST_LINEAR_33 },
+        { "%{TRANSLATION_NEGATED_X}", OutputFormatSegment::ST_TRANSLATION_NEGATED_X },
+        { "%{TRANSLATION_NEGATED_Y}", OutputFormatSegment::ST_TRANSLATION_NEGATED_Y },
+        { "%{TRANSLATION_NEGATED_Z}", OutputFormatSegment::ST_TRANSLATION_NEGATED_Z },
+        { "%{LINEAR_NEGATED_11}", OutputFormatSegment::ST_LINEAR_NEGATED_11 },
+        { "%{LINEAR_NEGATED_12}", OutputFormatSegment::ST_LINEAR_NEGATED_12 },
+        { "%{LINEAR_NEGATED_13}", OutputFormatSegment::ST_LINEAR_NEGATED_13 },
+        { "%{LINEAR_NEGATED_21}", OutputFormatSegment::ST_LINEAR_NEGATED_21 },
+        { "%{LINEAR_NEGATED_22}", OutputFormatSegment::ST_LINEAR_NEGATED_22 },
+        { "%{LINEAR_NEGATED_23}", OutputFormatSegment::ST_LINEAR_NEGATED_23 },
+        { "%{LINEAR_NEGATED_31}", OutputFormatSegment::ST_LINEAR_NEGATED_31 },
+        { "%{LINEAR_NEGATED_32}", OutputFormatSegment::ST_LINEAR_NEGATED_32 },
+        { "%{LINEAR_NEGATED_33}", OutputFormatSegment::ST_LINEAR_NEGATED_33 },
+        { "%{BASEPATH}", OutputFormatSegment::ST_BASEPATH },
+        { "%{RELATIVEPATH}", OutputFormatSegment::ST_RELATIVEPATH },
+        { "%{FULLPATH}", OutputFormatSegment::ST_FULLPATH },
+        { "%{FULLFILEPATH}", OutputFormatSegment::ST_FULLFILEPATH },
+        { "%{FILENAME}", OutputFormatSegment::ST_FILENAME },
+    };
+
+    QVector<OutputFormatSegment> segments;
+    OutputFormatSegment literalSegment;
+
+    int i = 0;
+
+    while (i < formatString.length())
+    {
+        bool placeholderFound = false;
+
+        int placeholderEnd = -1;
+
+        if ((formatString.at(i) == '%') && ((placeholderEnd = formatString.indexOf('}', i)) != -1))
+        {
+            QString candidate = formatString.mid(i, placeholderEnd - i + 1);
+
+            for (unsigned int p = 0; p < sizeof(placeholders) / sizeof(placeholders[0]); p++)
+            {
+                QLatin1String placeholder(placeholders[p].placeholder);
+
+                if (candidate == placeholder)
+                {
+                    if (!literalSegment.literal.isEmpty())
+                    {
+                        segments.append(literalSegment);
+                        literalSegment.literal.clear();
+                    }
+
+                    OutputFormatSegment placeholderSegment;
+                    placeholderSegment.type = placeholders[p].type;
+                    segments.append(placeholderSegment);
+
+                    i += placeholder.size();
+                    placeholderFound = true;
+                    break;
+                }
+            }
+        }
+
+        if (!placeholderFound)
+        {
+            literalSegment.literal += formatString.at(i);
+            i++;
+        }
+    }
+
+    if (!literalSegment.literal.isEmpty())
+    {
+        segments.append(literalSegment);
+    }
+
+    return segments;
+}
+
 void RasterCameraGenerator::genericStringCmd(const QVector<Item>& command, QString& string)
 {
     checkArgumentCount(command, 1, 2);
@@ -532,21 +808,95 @@ void RasterCameraGenerator::cmd_ProcessStills(const QVector<Item>& command, cons
 
     QStringList fileList = dir.entryList();
 
-    // Map where uptimes for all equal ITOWs are the same.
-    // This makes processing later easier
-    // Uptimes here are calculated as averages from rover values (for each ITOW)
-    QMap<qint64, UBXMessage_RELPOSNED::ITOW> averagedSync;
+    // Uptimes are converted into ITOWs using a model fitted into rovers' sync data
+    ClockModel clockModel_Generated;
+
+    if (!params.clockModel)
+    {
+        emit infoMessage("Fitting uptime/ITOW clock model...");
+        clockModel_Generated.fit(params.rovers, params.numOfRovers);
+        emit infoMessage("Clock model fitted. Number of segments: " + QString::number(clockModel_Generated.getSegments().count()) +
+                         ", RMS residual: " + QString::number(clockModel_Generated.getRMSResidual(), 'f', 2) + " ms.");
+    }
+    else
+    {
+        emit infoMessage("Using cached clock model. Number of segments: " + QString::number(params.clockModel->getSegments().count()));
+    }
+
+    const ClockModel& clockModel = params.clockModel ? *params.clockModel : clockModel_Generated;
+
+    // Read EXIF date/times for all files before processing.
+    // Files not found in cache (or changed after caching) are read in parallel.
+    QMap<QString, EXIFTimeCacheItem> exifTimeCache = loadEXIFTimeCache(dir);
+    QVector<QDateTime> imageDateTimes(fileList.size());
+    QStringList uncachedFileNames;
+    QVector<int> uncachedFileIndices;
+    QVector<QFileInfo> fileInfos(fileList.size());
+
+    for (int i = 0; i < fileList.size(); i++)
+    {
+        fileInfos[i] = QFileInfo(fullPath(fileList[i]));
+
+        QMap<QString, EXIFTimeCacheItem>::const_iterator cacheIter = exifTimeCache.constFind(fileList[i]);
+
+        if ((cacheIter != exifTimeCache.constEnd()) &&
+                (cacheIter.value().fileSize == fileInfos[i].size()) &&
+                (cacheIter.value().lastModified == fileInfos[i].lastModified().toMSecsSinceEpoch()))
+        {
+            imageDateTimes[i] = cacheIter.value().dateTime;
+        }
+        else
+        {
+            uncachedFileNames.append(fullPath(fileList[i]));
+            uncachedFileIndices.append(i);
+        }
+    }
+
+    if (!uncachedFileNames.isEmpty())
+    {
+        emit infoMessage("Reading EXIF date/times from " + QString::number(uncachedFileNames.size()) +
+                         " files (" + QString::number(fileList.size() - uncachedFileNames.size()) + " found in cache)...");
+
+        QList<QDateTime> readDateTimes = QtConcurrent::blockingMapped(uncachedFileNames, &RasterCameraGenerator::readEXIFDateTimeFromFile);
 
-    emit infoMessage("Generating equalized rover uptime timestamps...");
-    PostProcessingForm::generateAveragedRoverUptimeSync(params.rovers, averagedSync);
-    emit infoMessage("Equalized rover uptime timestamps created. Number of items: " + QString::number(averagedSync.size()));
+        for (int i = 0; i < readDateTimes.size(); i++)
+        {
+            int fileIndex = uncachedFileIndices[i];
+
+            imageDateTimes[fileIndex] = readDateTimes[i];
+
+            if (readDateTimes[i].isValid())
+            {
+                EXIFTimeCacheItem cacheItem;
+                cacheItem.fileSize = fileInfos[fileIndex].size();
+                cacheItem.lastModified = fileInfos[fileIndex].lastModified().toMSecsSinceEpoch();
+                cacheItem.dateTime = readDateTimes[i];
+
+                exifTimeCache.insert(fileList[fileIndex], cacheItem);
+            }
+        }
+
+        saveEXIFTimeCache(dir, exifTimeCache);
+    }
+
+    const QVector<OutputFormatSegment> outputFormatSegments = compileOutputFormatString(rasterItemOutputFormatString);
 
     for (int i = 0; i < fileList.size(); i++)
     {
+        if (GeneratorTask::isCancelRequested(params.task))
+        {
+            Issue error;
+            error.text = "Processing stills cancelled.";
+            error.item = command.at(0);
+            throw error;
+        }
+
+        GeneratorTask::setProgress(params.task, i, fileList.size());
+
         QString fileName = fullPath(fileList[i]);
 
         emit infoMessage("Processing file \"" + fileName + "\"...");
-        QDateTime imageDateTime = readEXIFDateTimeFromFile(fileName);
+        QDateTime imageDateTime = imageDateTimes[i];
 
         if (!imageDateTime.isValid())
         {
@@ -571,7 +921,7 @@ void RasterCameraGenerator::cmd_ProcessStills(const QVector<Item>& command, cons
 
             try
             {
-                params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(imageUptime, averagedSync, transform_LoSolver);
+                params.loInterpolator->getInterpolatedLocationOrientationTransformMatrix_Uptime(imageUptime, clockModel, transform_LoSolver);
             }
             catch (QString& stringThrown)
             {
@@ -604,50 +954,81 @@ void RasterCameraGenerator::cmd_ProcessStills(const QVector<Item>& command, cons
 
         Eigen::Transform<double, 3, Eigen::Affine> finalMatrix = *params.transform_NEDToXYZ * transform_LoSolver * *params.transform_Generated * transform_XYZToNED_NoTranslation;
 
-        QString fileString = rasterItemOutputFormatString;
-
         const int originDecimals = 4;
         const int unitVectorDecimals = 6;
 
-        fileString.replace("%{TRANSLATION_X}", QString::number(finalMatrix(0,3), 'f', originDecimals));
-        fileString.replace("%{TRANSLATION_Y}", QString::number(finalMatrix(1,3), 'f', originDecimals));
-        fileString.replace("%{TRANSLATION_Z}", QString::number(finalMatrix(2,3), 'f', originDecimals));
+        for (const OutputFormatSegment& segment : outputFormatSegments)
+        {
+            switch (segment.type)
+            {
+            case OutputFormatSegment::ST_LITERAL:
+                outString += segment.literal;
+                break;
 
-        fileString.replace("%{LINEAR_11}", QString::number(finalMatrix(0,0), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_12}", QString::number(finalMatrix(1,0), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_13}", QString::number(finalMatrix(2,0), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_TRANSLATION_X:
+            case OutputFormatSegment::ST_TRANSLATION_Y:
+            case OutputFormatSegment::ST_TRANSLATION_Z:
+                outString += QString::number(finalMatrix(segment.type - OutputFormatSegment::ST_TRANSLATION_X, 3), 'f', originDecimals);
+                break;
 
-        fileString.replace("%{LINEAR_21}", QString::number(finalMatrix(0,1), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_22}", QString::number(finalMatrix(1,1), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_23}", QString::number(finalMatrix(2,1), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_TRANSLATION_NEGATED_X:
+            case OutputFormatSegment::ST_TRANSLATION_NEGATED_Y:
+            case OutputFormatSegment::ST_TRANSLATION_NEGATED_Z:
+                outString += QString::number(-finalMatrix(segment.type - OutputFormatSegment::ST_TRANSLATION_NEGATED_X, 3), 'f', originDecimals);
+                break;
 
-        fileString.replace("%{LINEAR_31}", QString::number(finalMatrix(0,2), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_32}", QString::number(finalMatrix(1,2), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_33}", QString::number(finalMatrix(2,2), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_LINEAR_11:
+            case OutputFormatSegment::ST_LINEAR_12:
+            case OutputFormatSegment::ST_LINEAR_13:
+            case OutputFormatSegment::ST_LINEAR_21:
+            case OutputFormatSegment::ST_LINEAR_22:
+            case OutputFormatSegment::ST_LINEAR_23:
+            case OutputFormatSegment::ST_LINEAR_31:
+            case OutputFormatSegment::ST_LINEAR_32:
+            case OutputFormatSegment::ST_LINEAR_33:
+            {
+                // LINEAR_ij = finalMatrix(j-1, i-1)
+                int index = segment.type - OutputFormatSegment::ST_LINEAR_11;
+                outString += QString::number(finalMatrix(index % 3, index / 3), 'f', unitVectorDecimals);
+                break;
+            }
 
-        fileString.replace("%{TRANSLATION_NEGATED_X}", QString::number(-finalMatrix(0,3), 'f', originDecimals));
-        fileString.replace("%{TRANSLATION_NEGATED_Y}", QString::number(-finalMatrix(1,3), 'f', originDecimals));
-        fileString.replace("%{TRANSLATION_NEGATED_Z}", QString::number(-finalMatrix(2,3), 'f', originDecimals));
+            case OutputFormatSegment::ST_LINEAR_NEGATED_11:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_12:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_13:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_21:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_22:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_23:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_31:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_32:
+            case OutputFormatSegment::ST_LINEAR_NEGATED_33:
+            {
+                int index = segment.type - OutputFormatSegment::ST_LINEAR_NEGATED_11;
+                outString += QString::number(-finalMatrix(index % 3, index / 3), 'f', unitVectorDecimals);
+                break;
+            }
 
-        fileString.replace("%{LINEAR_NEGATED_11}", QString::number(-finalMatrix(0,0), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_12}", QString::number(-finalMatrix(1,0), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_13}", QString::number(-finalMatrix(2,0), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_BASEPATH:
+                outString += baseDir.path();
+                break;
 
-        fileString.replace("%{LINEAR_NEGATED_21}", QString::number(-finalMatrix(0,1), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_22}", QString::number(-finalMatrix(1,1), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_23}", QString::number(-finalMatrix(2,1), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_RELATIVEPATH:
+                outString += relativeDir.path();
+                break;
 
-        fileString.replace("%{LINEAR_NEGATED_31}", QString::number(-finalMatrix(0,2), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_32}", QString::number(-finalMatrix(1,2), 'f', unitVectorDecimals));
-        fileString.replace("%{LINEAR_NEGATED_33}", QString::number(-finalMatrix(2,2), 'f', unitVectorDecimals));
+            case OutputFormatSegment::ST_FULLPATH:
+                outString += fullPath();
+                break;
 
-        fileString.replace("%{BASEPATH}", baseDir.path());
-        fileString.replace("%{RELATIVEPATH}", relativeDir.path());
-        fileString.replace("%{FULLPATH}", fullPath());
-        fileString.replace("%{FULLFILEPATH}", fileName);
-        fileString.replace("%{FILENAME}", fileList[i]);
+            case OutputFormatSegment::ST_FULLFILEPATH:
+                outString += fileName;
+                break;
 
-        outString += fileString;
+            case OutputFormatSegment::ST_FILENAME:
+                outString += fileList[i];
+                break;
+            }
+        }
     }
 }
 
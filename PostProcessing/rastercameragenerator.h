@@ -21,8 +21,11 @@
 
 #include <QStringList>
 #include <QDir>
+#include <QMap>
 
 #include "postprocessingform.h"
+#include "generatortask.h"
+#include "clockmodel.h"
 
 class RasterCameraGenerator : public QObject
 {
@@ -36,7 +39,11 @@ public:
         Eigen::Transform<double, 3, Eigen::Affine>* transform_Generated = nullptr;
 
         const PostProcessingForm::Rover* rovers = nullptr;
+
+        unsigned int numOfRovers = 3;                   //!< Number of items in rovers
         PostProcessingForm::LOInterpolator* loInterpolator = nullptr;
+        const ClockModel* clockModel = nullptr;     //!< Uptime <-> ITOW model (fitted from rovers if nullptr)
+        GeneratorTask* task = nullptr;      //!< Progress reporting and cancellation (optional)
     };
 
     class Item
@@ -65,6 +72,63 @@ public:
 
 private:
 
+    /**
+     * @brief Part of "pre-compiled" raster item output format string
+     *
+     * Format string is split into literal texts and placeholders (like %{TRANSLATION_X})
+     * once per cmd_ProcessStills instead of replacing every placeholder separately for every image.
+     */
+    class OutputFormatSegment
+    {
+    public:
+        enum Type
+        {
+            ST_LITERAL = 0,
+            ST_TRANSLATION_X,
+            ST_TRANSLATION_Y,
+            ST_TRANSLATION_Z,
+            ST_LINEAR_11,
+            ST_LINEAR_12,
+            ST_LINEAR_13,
+            ST_LINEAR_21,
+            ST_LINEAR_22,
+            ST_LINEAR_23,
+            ST_LINEAR_31,
+            ST_LINEAR_32,
+            ST_LINEAR_33,
+            ST_TRANSLATION_NEGATED_X,
+            ST_TRANSLATION_NEGATED_Y,
+            ST_TRANSLATION_NEGATED_Z,
+            ST_LINEAR_NEGATED_11,
+            ST_LINEAR_NEGATED_12,
+            ST_LINEAR_NEGATED_13,
+            ST_LINEAR_NEGATED_21,
+            ST_LINEAR_NEGATED_22,
+            ST_LINEAR_NEGATED_23,
+            ST_LINEAR_NEGATED_31,
+            ST_LINEAR_NEGATED_32,
+            ST_LINEAR_NEGATED_33,
+            ST_BASEPATH,
+            ST_RELATIVEPATH,
+            ST_FULLPATH,
+            ST_FULLFILEPATH,
+            ST_FILENAME,
+        } type = ST_LITERAL;
+
+        QString literal;    //!< Text for ST_LITERAL
+    };
+
+    /**
+     * @brief Cached EXIF date/time of an image file (see loadEXIFTimeCache)
+     */
+    class EXIFTimeCacheItem
+    {
+    public:
+        qint64 fileSize = -1;
+        qint64 lastModified = -1;   //!< ms since epoch
+        QDateTime dateTime;
+    };
+
     QString rasterItemOutputFormatString;
 
     QDir baseDir;
@@ -86,8 +150,14 @@ private:
     void genericPathCmd(const QVector<Item>& command, QDir& dir, QString pathTitle);
     void genericStringCmd(const QVector<Item>& command, QString& string);
 
-    QDateTime readEXIFDateTimeFromString(QString dateTimeString);
-    QDateTime readEXIFDateTimeFromFile(const QString fileName);
+    static QDateTime readEXIFDateTimeFromString(QString dateTimeString);
+    static QDateTime readEXIFDateTimeFromFile(const QString& fileName);    //!< Thread safe, reads only JPEG-headers up to EXIF (APP1) segment
+
+    static QVector<OutputFormatSegment> compileOutputFormatString(const QString& formatString);
+
+    static QString getEXIFTimeCacheFileName(const QDir& dir);
+    static QMap<QString, EXIFTimeCacheItem> loadEXIFTimeCache(const QDir& dir);
+    static void saveEXIFTimeCache(const QDir& dir, const QMap<QString, EXIFTimeCacheItem>& cache);
 
     void cmd_WriteOutputString(const QVector<Item>& command);
     void cmd_RasterItemOutputFormatString(const QVector<Item>& command);
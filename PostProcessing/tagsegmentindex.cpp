@@ -0,0 +1,202 @@
+/*
+    tagsegmentindex.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tagsegmentindex.cpp
+ * @brief Definitions for an index of objects/segments (beginning-ending tag pairs) shared by post-processing generators.
+ */
+
+#include "tagsegmentindex.h"
+
+void TagSegmentIndex::build(const QMultiMap<qint64, PostProcessingForm::Tag>& tags,
+                            const QString& tagIdent_BeginNewObject,
+                            const QString& tagIdent_BeginPoints,
+                            const QString& tagIdent_EndPoints)
+{
+    items.clear();
+    segments.clear();
+
+    builtIdent_BeginNewObject = tagIdent_BeginNewObject;
+    builtIdent_BeginPoints = tagIdent_BeginPoints;
+    builtIdent_EndPoints = tagIdent_EndPoints;
+
+    bool objectActive = false;
+    bool ignoreBeginningAndEndingTags = false;
+    QString objectName;
+    qint64 beginningUptime = -1;
+    PostProcessingForm::Tag beginningTag;
+
+    QMultiMap<qint64, PostProcessingForm::Tag>::const_iterator groupBegin = tags.constBegin();
+
+    while (groupBegin != tags.constEnd())
+    {
+        QMultiMap<qint64, PostProcessingForm::Tag>::const_iterator groupEnd = groupBegin;
+
+        while ((groupEnd != tags.constEnd()) && (groupEnd.key() == groupBegin.key()))
+        {
+            groupEnd++;
+        }
+
+        // "The items that share the same key are available from most recently to least recently inserted."
+        // (taken from QMultiMap's doc) -> iterate tags with the same uptime in "reverse order" (=file order)
+        QMultiMap<qint64, PostProcessingForm::Tag>::const_iterator tagIter = groupEnd;
+
+        do
+        {
+            tagIter--;
+
+            const qint64 uptime = tagIter.key();
+            const PostProcessingForm::Tag& currentTag = tagIter.value();
+
+            Item item;
+            item.uptime = uptime;
+            item.tag = currentTag;
+
+            if (!(currentTag.ident.compare(tagIdent_BeginNewObject)))
+            {
+                objectActive = false;
+
+                if (currentTag.text.length() == 0)
+                {
+                    ignoreBeginningAndEndingTags = true;
+                    objectName.clear();
+
+                    item.type = ITEM_NAMELESS_OBJECT;
+                    items.append(item);
+                    continue;
+                }
+
+                objectActive = true;
+                ignoreBeginningAndEndingTags = false;
+                objectName = currentTag.text;
+                beginningUptime = -1;
+
+                item.type = ITEM_NEW_OBJECT;
+                item.objectName = objectName;
+                items.append(item);
+            }
+            else if ((!(currentTag.ident.compare(tagIdent_BeginPoints))) && (!ignoreBeginningAndEndingTags))
+            {
+                item.objectName = objectName;
+
+                if (!objectActive)
+                {
+                    item.diagnostic = DIAG_BEGINNING_OUTSIDE_OBJECT;
+                }
+                else if (beginningUptime != -1)
+                {
+                    item.diagnostic = DIAG_DUPLICATE_BEGINNING;
+                }
+                else
+                {
+                    beginningUptime = uptime;
+                    beginningTag = currentTag;
+
+                    item.type = ITEM_BEGINNING;
+                }
+
+                items.append(item);
+            }
+            else if ((!(currentTag.ident.compare(tagIdent_EndPoints))) && (!ignoreBeginningAndEndingTags))
+            {
+                item.objectName = objectName;
+
+                if (!objectActive)
+                {
+                    item.diagnostic = DIAG_END_OUTSIDE_OBJECT;
+                }
+                else if (beginningUptime == -1)
+                {
+                    item.diagnostic = DIAG_END_WITHOUT_BEGINNING;
+                }
+                else
+                {
+                    item.beginningTag = beginningTag;
+                    item.beginningUptime = beginningUptime;
+
+                    if (currentTag.sourceFile != beginningTag.sourceFile)
+                    {
+                        item.diagnostic = DIAG_DIFFERENT_FILES;
+                    }
+                    else
+                    {
+                        Segment segment;
+                        segment.objectName = objectName;
+                        segment.beginningTag = beginningTag;
+                        segment.endingTag = currentTag;
+                        segment.beginningUptime = beginningUptime;
+                        segment.endingUptime = uptime;
+
+                        item.type = ITEM_SEGMENT;
+                        item.segmentIndex = segments.count();
+                        segments.append(segment);
+
+                        beginningUptime = -1;
+                    }
+                }
+
+                items.append(item);
+            }
+        } while (tagIter != groupBegin);
+
+        groupBegin = groupEnd;
+    }
+}
+
+bool TagSegmentIndex::isBuiltWith(const QString& tagIdent_BeginNewObject, const QString& tagIdent_BeginPoints, const QString& tagIdent_EndPoints) const
+{
+    return (tagIdent_BeginNewObject == builtIdent_BeginNewObject) &&
+            (tagIdent_BeginPoints == builtIdent_BeginPoints) &&
+            (tagIdent_EndPoints == builtIdent_EndPoints);
+}
+
+QString TagSegmentIndex::getDiagnosticText(const Item& item)
+{
+    const PostProcessingForm::Tag& tag = item.tag;
+
+    QString tagLocation = "File \"" + tag.sourceFile + "\", line " +
+            QString::number(tag.sourceFileLine)+
+            ", uptime " + QString::number(item.uptime) +
+            ", iTOW " + QString::number(tag.iTOW) + ": ";
+
+    switch (item.diagnostic)
+    {
+    case DIAG_BEGINNING_OUTSIDE_OBJECT:
+        return tagLocation + "Beginning tag outside object. Skipped.";
+
+    case DIAG_DUPLICATE_BEGINNING:
+        return tagLocation + "Duplicate beginning tag. Skipped.";
+
+    case DIAG_END_OUTSIDE_OBJECT:
+        return tagLocation + "End tag outside object. Skipped.";
+
+    case DIAG_END_WITHOUT_BEGINNING:
+        return tagLocation + "End tag without beginning tag. Skipped.";
+
+    case DIAG_DIFFERENT_FILES:
+        return "Starting and ending tags belong to different files. Starting tag file \"" +
+                item.beginningTag.sourceFile + "\", line " +
+                QString::number(item.beginningTag.sourceFileLine) + " ending tag file: " +
+                tag.sourceFile + "\", line " +
+                QString::number(tag.sourceFileLine) + ". Ending tag ignored.";
+
+    case DIAG_NONE:
+    default:
+        return tagLocation + "OK.";
+    }
+}
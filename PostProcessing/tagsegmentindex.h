@@ -0,0 +1,195 @@
+/*
+    tagsegmentindex.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tagsegmentindex.h
+ * @brief Declarations for an index of objects/segments (beginning-ending tag pairs) shared by post-processing generators.
+ */
+
+#ifndef TAGSEGMENTINDEX_H
+#define TAGSEGMENTINDEX_H
+
+#include <functional>
+
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
+
+#include "postprocessingform.h"
+
+/**
+ * @brief Tags (new object/beginning/ending) interpreted once into a flat list of validated items
+ *
+ * Generators used to walk the tag map themselves, each with its own copy of the same
+ * new object/beginning/ending state machine. Here the state machine is run once
+ * (in the same order: uptime order, items with equal uptimes in reverse (=file) order)
+ * and generators just iterate the items. Tags with other identifiers are left out.
+ *
+ * Rules:
+ * - New object with a name begins a new object (and forgets unfinished beginning tag).
+ * - New object without a name ends the current object. Beginning and ending tags are
+ *   ignored (no items) until the next named object.
+ * - Beginning tag is valid inside an object if there's no unfinished beginning tag.
+ * - Ending tag forms a segment with the unfinished beginning tag if they are in the same file.
+ * - Invalid beginning/ending tags are listed with a diagnostic.
+ */
+class TagSegmentIndex
+{
+public:
+    enum ItemType
+    {
+        ITEM_NEW_OBJECT = 0,        //!< "New object"-tag with a name
+        ITEM_NAMELESS_OBJECT,       //!< "New object"-tag without a name
+        ITEM_BEGINNING,             //!< Valid beginning tag
+        ITEM_SEGMENT,               //!< Valid ending tag (segment from beginning tag to this)
+        ITEM_INVALID_TAG,           //!< Skipped beginning/ending tag (see diagnostic)
+    };
+
+    enum Diagnostic
+    {
+        DIAG_NONE = 0,
+        DIAG_BEGINNING_OUTSIDE_OBJECT,
+        DIAG_DUPLICATE_BEGINNING,
+        DIAG_END_OUTSIDE_OBJECT,
+        DIAG_END_WITHOUT_BEGINNING,
+        DIAG_DIFFERENT_FILES,       //!< Beginning and ending tags in different files (ending tag ignored, beginning still valid)
+    };
+
+    /**
+     * @brief Points between beginning and ending tags (for example RMB -> LMB)
+     */
+    class Segment
+    {
+    public:
+        QString objectName;
+        PostProcessingForm::Tag beginningTag;
+        PostProcessingForm::Tag endingTag;
+        qint64 beginningUptime = -1;
+        qint64 endingUptime = -1;
+    };
+
+    class Item
+    {
+    public:
+        ItemType type = ITEM_INVALID_TAG;
+        Diagnostic diagnostic = DIAG_NONE;
+        qint64 uptime = -1;                     //!< Uptime of the tag
+        PostProcessingForm::Tag tag;            //!< The tag itself
+        PostProcessingForm::Tag beginningTag;   //!< Unfinished beginning tag (ITEM_SEGMENT and DIAG_DIFFERENT_FILES)
+        qint64 beginningUptime = -1;            //!< Uptime of beginningTag
+        QString objectName;                     //!< Name of the current object (empty if none)
+        int segmentIndex = -1;                  //!< Index in getSegments() (ITEM_SEGMENT)
+    };
+
+    /**
+     * @brief Builds the index
+     * @param tags Tags
+     * @param tagIdent_BeginNewObject Identifier of "new object"-tags
+     * @param tagIdent_BeginPoints Identifier of beginning tags
+     * @param tagIdent_EndPoints Identifier of ending tags
+     */
+    void build(const QMultiMap<qint64, PostProcessingForm::Tag>& tags,
+               const QString& tagIdent_BeginNewObject,
+               const QString& tagIdent_BeginPoints,
+               const QString& tagIdent_EndPoints);
+
+    const QVector<Item>& getItems(void) const { return items; }         //!< Returns items in tag order
+    const QVector<Segment>& getSegments(void) const { return segments; }  //!< Returns segments in tag order
+
+    //! Returns true if built using the same identifiers
+    bool isBuiltWith(const QString& tagIdent_BeginNewObject, const QString& tagIdent_BeginPoints, const QString& tagIdent_EndPoints) const;
+
+    static QString getDiagnosticText(const Item& item);     //!< Returns warning text for ITEM_INVALID_TAG (same texts generators used before)
+
+private:
+    QVector<Item> items;
+    QVector<Segment> segments;
+
+    QString builtIdent_BeginNewObject;
+    QString builtIdent_BeginPoints;
+    QString builtIdent_EndPoints;
+};
+
+/**
+ * @brief Processes segments in parallel batches ahead of a generator's (sequential) item handling
+ *
+ * Generators handle items in order, but instead of processing points of a segment
+ * when its ending tag is found, they request the result from here. The segment and the following
+ * batchSize - 1 segments are processed in parallel (if not already done).
+ * Results are therefore identical to processing segments one by one
+ * (segments a generator skips are just processed in vain).
+ *
+ * Process-function must be thread-safe (only read shared data) and not emit signals.
+ */
+template <class Result>
+class SegmentPrefetcher
+{
+public:
+    /**
+     * @brief Constructor
+     * @param segments Segments (from TagSegmentIndex::getSegments)
+     * @param process Function processing one segment
+     * @param batchSize Number of segments processed at once (0 = 4 per thread)
+     */
+    SegmentPrefetcher(const QVector<TagSegmentIndex::Segment>& segments, const std::function<Result(const TagSegmentIndex::Segment&)>& process, const int batchSize = 0) :
+        segments(segments), process(process)
+    {
+        this->batchSize = (batchSize > 0) ? batchSize : qMax(1, QThread::idealThreadCount() * 4);
+    }
+
+    /**
+     * @brief Returns result of the segment
+     * @param segmentIndex Index of the segment (TagSegmentIndex::Item::segmentIndex)
+     * @return Result (same as process(segments[segmentIndex]))
+     */
+    Result getResult(const int segmentIndex)
+    {
+        if ((segmentIndex < batchFirstIndex) || (segmentIndex >= batchFirstIndex + batchResults.count()))
+        {
+            batchFirstIndex = segmentIndex;
+            int numOfSegments = qMin(batchSize, segments.count() - segmentIndex);
+
+            batchResults.clear();
+            batchResults.resize(numOfSegments);
+
+            QVector<int> indexes(numOfSegments);
+
+            for (int i = 0; i < numOfSegments; i++)
+            {
+                indexes[i] = i;
+            }
+
+            QtConcurrent::blockingMap(indexes, [this](const int& i)
+            {
+                batchResults[i] = process(segments[batchFirstIndex + i]);
+            });
+        }
+
+        return batchResults[segmentIndex - batchFirstIndex];
+    }
+
+private:
+    const QVector<TagSegmentIndex::Segment> segments;
+    std::function<Result(const TagSegmentIndex::Segment&)> process;
+    int batchSize;
+
+    int batchFirstIndex = 0;
+    QVector<Result> batchResults;
+};
+
+#endif // TAGSEGMENTINDEX_H
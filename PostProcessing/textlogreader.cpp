@@ -0,0 +1,345 @@
+/*
+    textlogreader.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file textlogreader.cpp
+ * @brief Definition for a reader/tokenizer of tab-separated text logs (.Tags, .Distances, .Sync).
+ */
+
+#include <charconv>
+#include <string.h>
+
+#include "textlogreader.h"
+
+namespace
+{
+    bool isWhitespace(const char character)
+    {
+        return (character == ' ') || (character == '\t') || (character == '\r') ||
+                (character == '\n') || (character == '\v') || (character == '\f');
+    }
+
+    char toLowerAscii(const char character)
+    {
+        return ((character >= 'A') && (character <= 'Z')) ? static_cast<char>(character - 'A' + 'a') : character;
+    }
+
+    /**
+     * @brief Returns trimmed field without leading '+' (not accepted by std::from_chars)
+     */
+    TextLogReader::Field getNumberPart(const TextLogReader::Field& field)
+    {
+        TextLogReader::Field number = field.trimmed();
+
+        if ((number.length > 1) && (number.data[0] == '+') && (number.data[1] != '-'))
+        {
+            number.data++;
+            number.length--;
+        }
+
+        return number;
+    }
+
+    template <typename T>
+    T toInteger(const TextLogReader::Field& field, bool* ok)
+    {
+        TextLogReader::Field number = getNumberPart(field);
+        T value = 0;
+
+        std::from_chars_result result = std::from_chars(number.data, number.data + number.length, value);
+
+        bool valid = (number.length > 0) && (result.ec == std::errc()) && (result.ptr == number.data + number.length);
+
+        if (ok)
+        {
+            *ok = valid;
+        }
+
+        return valid ? value : 0;
+    }
+}
+
+TextLogReader::Field TextLogReader::Field::trimmed(void) const
+{
+    Field result = *this;
+
+    while ((result.length > 0) && isWhitespace(result.data[0]))
+    {
+        result.data++;
+        result.length--;
+    }
+
+    while ((result.length > 0) && isWhitespace(result.data[result.length - 1]))
+    {
+        result.length--;
+    }
+
+    return result;
+}
+
+TextLogReader::Field TextLogReader::Field::left(const int n) const
+{
+    if ((n < 0) || (n > length))
+    {
+        return *this;
+    }
+
+    return Field(data, n);
+}
+
+int TextLogReader::Field::indexOf(const char* string) const
+{
+    const int stringLength = static_cast<int>(strlen(string));
+
+    if (stringLength == 0)
+    {
+        return 0;
+    }
+
+    const char* searchPos = data;
+    const char* end = data + length;
+
+    while (end - searchPos >= stringLength)
+    {
+        const char* candidate = static_cast<const char*>(memchr(searchPos, string[0], static_cast<size_t>(end - searchPos - stringLength + 1)));
+
+        if (!candidate)
+        {
+            break;
+        }
+
+        if (!memcmp(candidate, string, static_cast<size_t>(stringLength)))
+        {
+            return static_cast<int>(candidate - data);
+        }
+
+        searchPos = candidate + 1;
+    }
+
+    return -1;
+}
+
+bool TextLogReader::Field::equals(const char* string, const Qt::CaseSensitivity cs) const
+{
+    if (static_cast<int>(strlen(string)) != length)
+    {
+        return false;
+    }
+    else if (length == 0)
+    {
+        return true;
+    }
+
+    if (cs == Qt::CaseSensitive)
+    {
+        return !memcmp(data, string, static_cast<size_t>(length));
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        if (toLowerAscii(data[i]) != toLowerAscii(string[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int TextLogReader::Field::toInt(bool* ok) const
+{
+    return toInteger<int>(*this, ok);
+}
+
+qint64 TextLogReader::Field::toLongLong(bool* ok) const
+{
+    return toInteger<qint64>(*this, ok);
+}
+
+double TextLogReader::Field::toDouble(bool* ok) const
+{
+#if defined(__cpp_lib_to_chars)
+    Field number = getNumberPart(*this);
+    double value = 0;
+
+    std::from_chars_result result = std::from_chars(number.data, number.data + number.length, value);
+
+    bool valid = (number.length > 0) && (result.ec == std::errc()) && (result.ptr == number.data + number.length);
+
+    if (ok)
+    {
+        *ok = valid;
+    }
+
+    return valid ? value : 0;
+#else
+    // Standard library without floating point std::from_chars (gcc < 11).
+    // QByteArray::toDouble is locale independent (unlike strtod) but needs a null-terminated copy.
+    return QByteArray(data, length).toDouble(ok);
+#endif
+}
+
+QString TextLogReader::Field::toString(void) const
+{
+    if (length == 0)
+    {
+        return QString();
+    }
+
+    return QString::fromUtf8(data, length);
+}
+
+int TextLogReader::split(const Field& line, Field (&fields)[maxNumOfFields])
+{
+    int numOfItems = 0;
+    const char* itemStart = line.data;
+    const char* end = line.data + line.length;
+
+    while (true)
+    {
+        const char* tab = (itemStart < end) ? static_cast<const char*>(memchr(itemStart, '\t', static_cast<size_t>(end - itemStart))) : nullptr;
+        const char* itemEnd = tab ? tab : end;
+
+        if (numOfItems < maxNumOfFields)
+        {
+            fields[numOfItems] = Field(itemStart, static_cast<int>(itemEnd - itemStart));
+        }
+
+        numOfItems++;
+
+        if (!tab)
+        {
+            break;
+        }
+
+        itemStart = tab + 1;
+    }
+
+    return numOfItems;
+}
+
+QString TextLogReader::StringPool::get(const Field& field)
+{
+    // fromRawData doesn't copy -> no allocation if the string is already in the pool
+    QHash<QByteArray, QString>::const_iterator iter = strings.constFind(QByteArray::fromRawData(field.data, field.length));
+
+    if (iter != strings.constEnd())
+    {
+        return iter.value();
+    }
+
+    QString string = field.toString();
+    strings.insert(QByteArray(field.data, field.length), string);
+
+    return string;
+}
+
+TextLogReader::~TextLogReader()
+{
+    close();
+}
+
+bool TextLogReader::open(const QString& fileName)
+{
+    close();
+
+    file.setFileName(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    fileSize = file.size();
+
+    if (fileSize > 0)
+    {
+        mappedData = file.map(0, fileSize);
+    }
+
+    if (mappedData)
+    {
+        fileData = reinterpret_cast<const char*>(mappedData);
+    }
+    else
+    {
+        // Empty or not mappable (for example a pipe)
+        fileContents = file.readAll();
+        fileData = fileContents.constData();
+        fileSize = fileContents.size();
+    }
+
+    if ((fileSize >= 3) && (!memcmp(fileData, "\xEF\xBB\xBF", 3)))
+    {
+        // Byte order mark
+        position = 3;
+    }
+
+    return true;
+}
+
+void TextLogReader::close(void)
+{
+    if (mappedData)
+    {
+        file.unmap(mappedData);
+        mappedData = nullptr;
+    }
+
+    if (file.isOpen())
+    {
+        file.close();
+    }
+
+    fileContents.clear();
+    fileData = nullptr;
+    fileSize = 0;
+    position = 0;
+}
+
+TextLogReader::Field TextLogReader::readLine(void)
+{
+    if (atEnd())
+    {
+        return Field();
+    }
+
+    const char* lineStart = fileData + position;
+    const qint64 bytesLeft = fileSize - position;
+    const char* newLine = static_cast<const char*>(memchr(lineStart, '\n', static_cast<size_t>(bytesLeft)));
+
+    qint64 lineLength;
+
+    if (newLine)
+    {
+        lineLength = newLine - lineStart;
+        position += lineLength + 1;
+    }
+    else
+    {
+        lineLength = bytesLeft;
+        position = fileSize;
+    }
+
+    if ((lineLength > 0) && (lineStart[lineLength - 1] == '\r'))
+    {
+        lineLength--;
+    }
+
+    return Field(lineStart, static_cast<int>(lineLength));
+}
@@ -0,0 +1,119 @@
+/*
+    textlogreader.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file textlogreader.h
+ * @brief Declaration for a reader/tokenizer of tab-separated text logs (.Tags, .Distances, .Sync).
+ */
+
+#ifndef TEXTLOGREADER_H
+#define TEXTLOGREADER_H
+
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+/**
+ * @brief Reads tab-separated text logs line by line without allocations
+ *
+ * File is memory-mapped (or read into memory if mapping is not possible) and
+ * lines/fields are returned as Fields pointing into it. Fields are valid until the file is closed.
+ * Conversions accept the same input as QString's (surrounding whitespace and leading '+' allowed).
+ *
+ * Lines end with "\n" or "\r\n". UTF-8 byte order mark at the beginning of the file is skipped.
+ */
+class TextLogReader
+{
+public:
+    /**
+     * @brief Part of a line (or the whole line), not null-terminated
+     */
+    class Field
+    {
+    public:
+        const char* data = nullptr;
+        int length = 0;
+
+        Field() = default;
+        Field(const char* data, const int length) : data(data), length(length) {}
+
+        bool isEmpty(void) const { return length == 0; }
+        Field trimmed(void) const;                      //!< Returns field without surrounding whitespace
+        Field left(const int n) const;                  //!< Returns first n characters (whole field if n < 0 or n > length)
+        int indexOf(const char* string) const;          //!< Returns index of the first occurrence of string or -1 if not found
+
+        bool equals(const char* string, const Qt::CaseSensitivity cs = Qt::CaseSensitive) const;    //!< Compares to (ASCII) string
+
+        int toInt(bool* ok) const;                      //!< Converts to int, ok set to false (and 0 returned) if not a valid integer
+        qint64 toLongLong(bool* ok) const;              //!< Converts to 64-bit int, ok set to false (and 0 returned) if not a valid integer
+        double toDouble(bool* ok) const;                //!< Converts to double, ok set to false (and 0 returned) if not a valid number
+
+        QString toString(void) const;                   //!< Returns field as (UTF-8 decoded) string
+    };
+
+    static const int maxNumOfFields = 16;               //!< Max number of fields stored by split
+
+    /**
+     * @brief Splits line into tab-separated fields
+     * @param line Line to split
+     * @param fields Fields (first maxNumOfFields)
+     * @return Number of tab-separated items in the line (may be more than maxNumOfFields). Empty line has one (empty) item.
+     */
+    static int split(const Field& line, Field (&fields)[maxNumOfFields]);
+
+    /**
+     * @brief Pool of strings sharing the same data
+     *
+     * Used for values repeating a lot (like tag identifiers) so that
+     * a new string doesn't need to be allocated for every line.
+     */
+    class StringPool
+    {
+    public:
+        QString get(const Field& field);                //!< Returns string for the field (added to pool if not there yet)
+        void clear(void) { strings.clear(); }
+
+    private:
+        QHash<QByteArray, QString> strings;
+    };
+
+    TextLogReader() = default;
+    ~TextLogReader();
+
+    TextLogReader(const TextLogReader&) = delete;
+    TextLogReader& operator=(const TextLogReader&) = delete;
+
+    bool open(const QString& fileName);                 //!< Opens (and maps) file, returns false if opening failed
+    void close(void);
+
+    qint64 getFileSize(void) const { return fileSize; }
+    bool atEnd(void) const { return position >= fileSize; }
+
+    Field readLine(void);                               //!< Returns next line without line ending (empty if at end)
+
+private:
+    QFile file;
+    QByteArray fileContents;                            //!< Used if file couldn't be mapped
+    const char* fileData = nullptr;
+    uchar* mappedData = nullptr;
+    qint64 fileSize = 0;
+    qint64 position = 0;
+};
+
+#endif // TEXTLOGREADER_H
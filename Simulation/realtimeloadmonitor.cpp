@@ -0,0 +1,170 @@
+/*
+    realtimeloadmonitor.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file realtimeloadmonitor.cpp
+ * @brief Definition for a class monitoring load of the realtime chain (GUI-thread latency, queued signals, dropped data).
+ */
+
+#include "realtimeloadmonitor.h"
+
+RealtimeLoadMonitor::RealtimeLoadMonitor(QObject* parent, const int heartbeatInterval_ms) :
+    QObject(parent)
+{
+    heartbeatInterval = heartbeatInterval_ms;
+
+    heartbeatTimer.setTimerType(Qt::PreciseTimer);
+    heartbeatTimer.setInterval(heartbeatInterval);
+
+    connect(&heartbeatTimer, &QTimer::timeout,
+            this, &RealtimeLoadMonitor::heartbeat);
+
+    elapsedTimer.start();
+    heartbeatElapsedTimer.start();
+    heartbeatTimer.start();
+}
+
+RealtimeLoadMonitor::~RealtimeLoadMonitor()
+{
+    for (Channel* channel : channels)
+    {
+        for (const QMetaObject::Connection& connection : channel->connections)
+        {
+            disconnect(connection);
+        }
+    }
+
+    qDeleteAll(channels);
+    qDeleteAll(removedChannels);
+}
+
+int RealtimeLoadMonitor::addChannel(const QString& name, const std::function<qint64(void)>& dropCounter)
+{
+    Channel* channel = new Channel();
+
+    channel->name = name;
+    channel->dropCounter = dropCounter;
+
+    if (dropCounter)
+    {
+        channel->dropCountAtClear = dropCounter();
+    }
+
+    channels.append(channel);
+
+    return channels.count() - 1;
+}
+
+void RealtimeLoadMonitor::removeChannels(const QString& name)
+{
+    for (int i = channels.count() - 1; i >= 0; i--)
+    {
+        if (channels[i]->name == name)
+        {
+            for (const QMetaObject::Connection& connection : channels[i]->connections)
+            {
+                disconnect(connection);
+            }
+
+            // Queued calls may still be pending -> Channel can't be deleted yet
+            removedChannels.append(channels.takeAt(i));
+        }
+    }
+}
+
+void RealtimeLoadMonitor::clear(void)
+{
+    for (Channel* channel : channels)
+    {
+        channel->emittedAtClear = channel->numOfEmitted.loadAcquire();
+        channel->handledAtClear = channel->numOfHandled;
+        channel->maxQueueDepth = 0;
+
+        if (channel->dropCounter)
+        {
+            channel->dropCountAtClear = channel->dropCounter();
+        }
+    }
+
+    guiLatency.clear();
+    elapsedTimer.start();
+    heartbeatElapsedTimer.start();
+}
+
+void RealtimeLoadMonitor::itemHandled(Channel* channel)
+{
+    channel->numOfHandled++;
+
+    // This one is handled -> Queue depth before handling it
+    qint64 queueDepth = channel->numOfEmitted.loadAcquire() - channel->numOfHandled + 1;
+
+    if (queueDepth > channel->maxQueueDepth)
+    {
+        channel->maxQueueDepth = queueDepth;
+    }
+}
+
+void RealtimeLoadMonitor::heartbeat(void)
+{
+    guiLatency.addValue(heartbeatElapsedTimer.restart() - heartbeatInterval);
+}
+
+QVector<RealtimeLoadMonitor::ChannelStatistics> RealtimeLoadMonitor::getChannelStatistics(void)
+{
+    QVector<ChannelStatistics> statistics;
+
+    for (const Channel* channel : channels)
+    {
+        ChannelStatistics channelStatistics;
+
+        channelStatistics.name = channel->name;
+        channelStatistics.numOfEmitted = channel->numOfEmitted.loadAcquire() - channel->emittedAtClear;
+        channelStatistics.numOfHandled = channel->numOfHandled - channel->handledAtClear;
+        channelStatistics.maxQueueDepth = channel->maxQueueDepth;
+
+        if (channel->dropCounter)
+        {
+            channelStatistics.numOfDropped = channel->dropCounter() - channel->dropCountAtClear;
+        }
+
+        statistics.append(channelStatistics);
+    }
+
+    return statistics;
+}
+
+QString RealtimeLoadMonitor::getReport(void)
+{
+    QString report;
+
+    report += "Load test report, elapsed time: " + QString::number(getElapsed() / 1000.0, 'f', 1) + " s\n";
+    report += "GUI-thread latency (ms): mean " + QString::number(guiLatency.getMean(), 'f', 2) +
+            ", 99 % " + QString::number(guiLatency.getPercentile(99)) +
+            ", max " + QString::number(guiLatency.getMax()) + "\n";
+
+    for (const ChannelStatistics& channel : getChannelStatistics())
+    {
+        report += channel.name + ": emitted " + QString::number(channel.numOfEmitted) +
+                ", handled " + QString::number(channel.numOfHandled) +
+                ", queued now " + QString::number(channel.numOfEmitted - channel.numOfHandled) +
+                ", max queued " + QString::number(channel.maxQueueDepth) +
+                ", dropped " + QString::number(channel.numOfDropped) + "\n";
+    }
+
+    return report;
+}
@@ -0,0 +1,131 @@
+/*
+    realtimeloadmonitor.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file realtimeloadmonitor.h
+ * @brief Declaration for a class monitoring load of the realtime chain (GUI-thread latency, queued signals, dropped data).
+ */
+
+#ifndef REALTIMELOADMONITOR_H
+#define REALTIMELOADMONITOR_H
+
+#include <functional>
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QAtomicInteger>
+
+#include "../rtcmlatencystatistics.h"
+
+/**
+ * @brief Monitors load of the realtime chain (load test mode)
+ *
+ * Lives in the GUI-thread and measures:
+ * - GUI-thread latency: How late a precise heartbeat timer fires (=how long the event loop was blocked).
+ * - Queue growth for each channel: Signals emitted by worker threads but not yet handled in the GUI-thread.
+ *   Emitting is counted by a direct connection (in the worker thread) and handling by a queued connection
+ *   to this object. Queued events are handled in order, so this follows the real receivers' queue.
+ * - Dropped data for each channel: Given by a function (for example RPLidarThread::getNumOfDroppedRounds).
+ */
+class RealtimeLoadMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent
+     * @param heartbeatInterval_ms Interval of the heartbeat timer measuring GUI-thread latency
+     */
+    RealtimeLoadMonitor(QObject* parent = nullptr, const int heartbeatInterval_ms = 10);
+    ~RealtimeLoadMonitor() override;
+
+    class ChannelStatistics
+    {
+    public:
+        QString name;
+        qint64 numOfEmitted = 0;        //!< Signals emitted
+        qint64 numOfHandled = 0;        //!< Signals handled in GUI-thread
+        qint64 maxQueueDepth = 0;       //!< Max. number of signals emitted but not handled
+        qint64 numOfDropped = 0;        //!< Dropped items (from dropCounter)
+    };
+
+    /**
+     * @brief Adds a channel for a signal
+     * @param name Name of the channel (used in the report)
+     * @param sender Sender (worker thread)
+     * @param signal Signal
+     * @param dropCounter Function returning number of dropped items so far (optional)
+     * @return Index of the channel
+     */
+    template <typename Sender, typename Signal>
+    int addChannel(const QString& name, const Sender* sender, Signal signal, const std::function<qint64(void)>& dropCounter = nullptr)
+    {
+        int channelIndex = addChannel(name, dropCounter);
+        Channel* channel = channels[channelIndex];
+
+        // Generic lambdas ignore signal's arguments
+        channel->connections.append(connect(sender, signal, this, [channel](auto&&...) { channel->numOfEmitted.fetchAndAddOrdered(1); }, Qt::DirectConnection));
+        channel->connections.append(connect(sender, signal, this, [this, channel](auto&&...) { itemHandled(channel); }, Qt::QueuedConnection));
+
+        return channelIndex;
+    }
+
+    int addChannel(const QString& name, const std::function<qint64(void)>& dropCounter = nullptr);     //!< Adds a channel without a signal (only drops counted)
+    void removeChannels(const QString& name);   //!< Removes channel(s) (and disconnects signals) with given name
+
+    void clear(void);                           //!< Clears statistics (channels are kept)
+
+    QVector<ChannelStatistics> getChannelStatistics(void);      //!< Returns statistics of all channels
+    const LatencyHistogram& getGUILatency(void) const { return guiLatency; }    //!< Returns GUI-thread latencies (ms)
+    qint64 getElapsed(void) const { return elapsedTimer.elapsed(); }             //!< Returns time (ms) since creation or clear
+
+    QString getReport(void);                    //!< Returns report as multi-line text
+
+private:
+    class Channel
+    {
+    public:
+        QString name;
+        QAtomicInteger<qint64> numOfEmitted = 0;
+        qint64 numOfHandled = 0;
+        qint64 maxQueueDepth = 0;
+        std::function<qint64(void)> dropCounter;
+        QVector<QMetaObject::Connection> connections;
+        qint64 emittedAtClear = 0;
+        qint64 handledAtClear = 0;
+        qint64 dropCountAtClear = 0;
+    };
+
+    QVector<Channel*> channels;
+    QVector<Channel*> removedChannels;  //!< Deleted in destructor (queued calls may be pending)
+    QTimer heartbeatTimer;
+    QElapsedTimer heartbeatElapsedTimer;
+    QElapsedTimer elapsedTimer;
+    int heartbeatInterval = 10;
+    LatencyHistogram guiLatency;
+
+    void itemHandled(Channel* channel);
+
+private slots:
+    void heartbeat(void);
+};
+
+#endif // REALTIMELOADMONITOR_H
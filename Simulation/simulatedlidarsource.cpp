@@ -0,0 +1,213 @@
+/*
+    simulatedlidarsource.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulatedlidarsource.cpp
+ * @brief Definition for an in-process source of simulated lidar rounds (replaces RPlidarDriver in RPLidarThread).
+ */
+
+#include <math.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+
+#include "simulatedlidarsource.h"
+#include "simulationspec.h"
+
+bool SimulatedLidarSource::Params::parse(const QString& spec, QString& errorString)
+{
+    SimulationSpec simulationSpec;
+
+    if (!simulationSpec.parse(spec, errorString))
+    {
+        return false;
+    }
+
+    QString optionError;
+
+    speedFactor = simulationSpec.getSpeedFactor(optionError);
+
+    if (simulationSpec.isSynthetic())
+    {
+        mode = MODE_SYNTHETIC;
+        scanRate = simulationSpec.getNumber("hz", 10, 1, 100, optionError);
+        itemsPerRound = static_cast<int>(simulationSpec.getNumber("items", 360, 1, 20000, optionError));
+        roomSize = simulationSpec.getNumber("room", 8, 0.5, 100, optionError);
+        numOfRounds = static_cast<qint64>(simulationSpec.getNumber("rounds", 0, 0, 1e12, optionError));
+    }
+    else
+    {
+        mode = MODE_RECORDED;
+        fileName = simulationSpec.source;
+        loop = simulationSpec.getNumber("loop", 0, 0, 1, optionError) != 0;
+    }
+
+    if (!optionError.isEmpty())
+    {
+        errorString = optionError;
+        return false;
+    }
+
+    return true;
+}
+
+SimulatedLidarSource::SimulatedLidarSource(const Params& params) :
+    randomGenerator(1)
+{
+    this->params = params;
+}
+
+bool SimulatedLidarSource::open(QString& errorString)
+{
+    recordedRounds.clear();
+    nextRecordedRoundIndex = 0;
+    numOfSyntheticRoundsGenerated = 0;
+
+    if (params.mode == MODE_SYNTHETIC)
+    {
+        return true;
+    }
+
+    QFile lidarFile(params.fileName);
+
+    if (!lidarFile.open(QIODevice::ReadOnly))
+    {
+        errorString = "Can not open file \"" + params.fileName + "\".";
+        return false;
+    }
+
+    // Same format PostProcessingForm reads (chunks of type 1 = one round).
+    // Invalid chunks are just skipped here, PostProcessingForm can be used to find out what's wrong with the file.
+    QDataStream dataStream(&lidarFile);
+    dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    const qint64 fileLength = lidarFile.size();
+    qint64 previousEndTime = -1;
+
+    while (fileLength - lidarFile.pos() >= static_cast<qint64>(2 * sizeof(unsigned int)))
+    {
+        unsigned int dataType;
+        unsigned int dataChunkLength;
+
+        dataStream >> dataType >> dataChunkLength;
+
+        if (lidarFile.pos() + dataChunkLength > fileLength)
+        {
+            break;
+        }
+
+        unsigned int numOfItems = 0;
+        qint64 startTime;
+        qint64 endTime;
+
+        if (dataType == 1)
+        {
+            dataStream >> numOfItems;
+        }
+
+        if ((dataType != 1) || (dataChunkLength != sizeof(numOfItems) + sizeof(startTime) + sizeof(endTime) + numOfItems * 3 * sizeof(float)))
+        {
+            dataStream.skipRawData(static_cast<int>(dataChunkLength - ((dataType == 1) ? sizeof(numOfItems) : 0)));
+            continue;
+        }
+
+        dataStream >> startTime >> endTime;
+
+        Round newRound;
+        newRound.distanceItems.resize(static_cast<int>(numOfItems));
+
+        for (unsigned int i = 0; i < numOfItems; i++)
+        {
+            RPLidarThread::DistanceItem& item = newRound.distanceItems[static_cast<int>(i)];
+            dataStream >> item.distance >> item.angle >> item.quality;
+        }
+
+        // Duration = time between rounds' end times (start time of a round is the end time of the previous one when logged by RPLidarThread)
+        newRound.duration_ms = (previousEndTime >= 0) ? (endTime - previousEndTime) : (endTime - startTime);
+
+        if (newRound.duration_ms <= 0)
+        {
+            newRound.duration_ms = 1;
+        }
+
+        previousEndTime = endTime;
+        recordedRounds.append(newRound);
+    }
+
+    if (recordedRounds.isEmpty())
+    {
+        errorString = "No lidar rounds in file \"" + params.fileName + "\".";
+        return false;
+    }
+
+    return true;
+}
+
+bool SimulatedLidarSource::getNextRound(Round& round)
+{
+    if (params.mode == MODE_SYNTHETIC)
+    {
+        if ((params.numOfRounds != 0) && (numOfSyntheticRoundsGenerated >= params.numOfRounds))
+        {
+            return false;
+        }
+
+        // Rounds of the real device don't start at the same angle every time
+        round.distanceItems = createSyntheticRound(params.itemsPerRound, params.roomSize, randomGenerator.bounded(2 * M_PI / params.itemsPerRound));
+
+        for (RPLidarThread::DistanceItem& item : round.distanceItems)
+        {
+            item.distance += static_cast<float>(randomGenerator.bounded(0.004) - 0.002);
+        }
+
+        round.duration_ms = 1000. / params.scanRate;
+        numOfSyntheticRoundsGenerated++;
+        return true;
+    }
+
+    if (nextRecordedRoundIndex >= recordedRounds.count())
+    {
+        if ((!params.loop) || recordedRounds.isEmpty())
+        {
+            return false;
+        }
+
+        nextRecordedRoundIndex = 0;
+    }
+
+    round = recordedRounds[nextRecordedRoundIndex++];
+    return true;
+}
+
+QVector<RPLidarThread::DistanceItem> SimulatedLidarSource::createSyntheticRound(const int itemsPerRound, const double roomSize, const double angleOffset)
+{
+    QVector<RPLidarThread::DistanceItem> items(itemsPerRound);
+
+    for (int i = 0; i < itemsPerRound; i++)
+    {
+        double angle = fmod(angleOffset + 2 * M_PI * i / itemsPerRound, 2 * M_PI);
+
+        // Distance to the nearest wall in the direction of the angle
+        items[i].angle = static_cast<float>(angle);
+        items[i].distance = static_cast<float>((roomSize / 2) / fmax(fabs(cos(angle)), fabs(sin(angle))));
+        items[i].quality = 0.8f;
+    }
+
+    return items;
+}
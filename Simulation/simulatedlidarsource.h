@@ -0,0 +1,103 @@
+/*
+    simulatedlidarsource.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulatedlidarsource.h
+ * @brief Declaration for an in-process source of simulated lidar rounds (replaces RPlidarDriver in RPLidarThread).
+ */
+
+#ifndef SIMULATEDLIDARSOURCE_H
+#define SIMULATEDLIDARSOURCE_H
+
+#include <QVector>
+#include <QRandomGenerator>
+
+#include "rplidarthread.h"
+
+/**
+ * @brief Source of simulated lidar rounds
+ *
+ * Rounds are either synthetic (lidar in the middle of a square room) or read from a
+ * recorded lidar file (.lidar, format written by EssentialsForm). RPLidarThread
+ * paces the rounds (duration / speedFactor) and emits them just like rounds from the device.
+ *
+ * Options (see SimulationSpec) for spec "sim:synthetic,...":
+ * - hz: Scan rate (rounds per second, 1...100, default 10)
+ * - items: Distance items per round (1...20000, default 360)
+ * - room: Side length of the room (m, 0.5...100, default 8)
+ * - rounds: Number of rounds (0 = unlimited, default)
+ *
+ * Options for spec "sim:<file.lidar>,...":
+ * - loop: Start over after the last round (0/1, default 0)
+ */
+class SimulatedLidarSource
+{
+public:
+    enum Mode
+    {
+        MODE_SYNTHETIC = 0,         //!< Rounds are generated
+        MODE_RECORDED,              //!< Rounds read from a recorded lidar file
+    };
+
+    class Params
+    {
+    public:
+        Mode mode = MODE_SYNTHETIC;
+        QString fileName;           //!< Recorded lidar file (MODE_RECORDED)
+        double speedFactor = 1;     //!< Playback speed (1...SimulationSpec::maxSpeedFactor)
+        double scanRate = 10;       //!< Rounds per second (MODE_SYNTHETIC)
+        int itemsPerRound = 360;    //!< Distance items per round (MODE_SYNTHETIC)
+        double roomSize = 8;        //!< Side length (m) of the square room scanned (MODE_SYNTHETIC)
+        qint64 numOfRounds = 0;     //!< Number of rounds (MODE_SYNTHETIC, 0 = unlimited)
+        bool loop = false;          //!< Start over after the last round (MODE_RECORDED)
+
+        /**
+         * @brief Parses parameters from simulation spec
+         * @param spec Spec ("sim:...", see SimulationSpec)
+         * @param errorString Description of the error (if any)
+         * @return true if parsed successfully
+         */
+        bool parse(const QString& spec, QString& errorString);
+    };
+
+    class Round
+    {
+    public:
+        QVector<RPLidarThread::DistanceItem> distanceItems;
+        double duration_ms = 0;     //!< Duration of the round (device time, not scaled by speedFactor)
+    };
+
+    SimulatedLidarSource(const Params& params);     //!< Constructor
+
+    bool open(QString& errorString);                //!< Prepares the source (reads recorded file). Returns false on error
+    bool getNextRound(Round& round);                //!< Returns next round. Returns false when there are no more rounds
+
+    const Params& getParams(void) const { return params; }  //!< Returns parameters
+    int getNumOfRecordedRounds(void) const { return recordedRounds.count(); }   //!< Returns number of rounds read from file
+
+    static QVector<RPLidarThread::DistanceItem> createSyntheticRound(const int itemsPerRound, const double roomSize, const double angleOffset = 0);  //!< Returns distances to walls of a square room (lidar in the middle)
+
+private:
+    Params params;
+    QVector<Round> recordedRounds;
+    int nextRecordedRoundIndex = 0;
+    qint64 numOfSyntheticRoundsGenerated = 0;
+    QRandomGenerator randomGenerator;
+};
+
+#endif // SIMULATEDLIDARSOURCE_H
@@ -0,0 +1,525 @@
+/*
+    simulatedserialdevice.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulatedserialdevice.cpp
+ * @brief Definition for a simulated serial device (u-blox rover, laser range finder) behind a pseudo terminal.
+ */
+
+#include <math.h>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtEndian>
+#include <QtMath>
+
+#include "simulatedserialdevice.h"
+#include "simulationspec.h"
+
+#if defined(Q_OS_LINUX)
+#include <pty.h>
+#define PTY_SUPPORTED
+#elif defined(Q_OS_MACOS)
+#include <util.h>
+#define PTY_SUPPORTED
+#endif
+
+#ifdef PTY_SUPPORTED
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#endif
+
+static const qint64 msecsInWeek = 7LL * 24 * 60 * 60 * 1000;
+
+SimulatedSerialDevice::SimulatedSerialDevice(const QVector<Frame>& frames, const double speedFactor, const bool absoluteTiming)
+{
+    this->frames = frames;
+    this->speedFactor = speedFactor;
+    this->absoluteTiming = absoluteTiming;
+}
+
+SimulatedSerialDevice::~SimulatedSerialDevice()
+{
+    terminateRequest = true;
+    this->wait(5000);
+
+#ifdef PTY_SUPPORTED
+    if (masterFd >= 0)
+    {
+        close(masterFd);
+    }
+
+    if (slaveFd >= 0)
+    {
+        close(slaveFd);
+    }
+#endif
+}
+
+SimulatedSerialDevice* SimulatedSerialDevice::createFromSpec(const QString& spec, const DeviceType deviceType, const unsigned int roverIndex, QString& errorString)
+{
+    SimulationSpec simulationSpec;
+
+    if (!simulationSpec.parse(spec, errorString))
+    {
+        return nullptr;
+    }
+
+    QString optionError;
+    double speedFactor = simulationSpec.getSpeedFactor(optionError);
+
+    QVector<Frame> frames;
+    bool absoluteTiming = false;
+
+    if (deviceType == DEVICE_UBLOX_ROVER)
+    {
+        if (simulationSpec.isSynthetic())
+        {
+            double rate = simulationSpec.getNumber("hz", 8, 1, 100, optionError);
+            double duration = simulationSpec.getNumber("duration", 3600, 1, 86400, optionError);
+            double radius = simulationSpec.getNumber("radius", 10, 0.1, 1000, optionError);
+            double velocity = simulationSpec.getNumber("velocity", 0.5, 0, 100, optionError);
+
+            if (!optionError.isEmpty())
+            {
+                errorString = optionError;
+                return nullptr;
+            }
+
+            frames = createFrames_SyntheticRELPOSNED(roverIndex, static_cast<qint64>(QDateTime::currentMSecsSinceEpoch() * speedFactor),
+                                                     qRound(1000 / rate), static_cast<qint64>(duration * 1000), radius, velocity);
+            absoluteTiming = true;
+        }
+        else if (!loadFrames_UBX(simulationSpec.source, frames, errorString))
+        {
+            return nullptr;
+        }
+    }
+    else
+    {
+        if (!simulationSpec.isSynthetic())
+        {
+            errorString = "Only synthetic data is supported for laser range finder.";
+            return nullptr;
+        }
+
+        double rate = simulationSpec.getNumber("hz", 20, 1, 100, optionError);
+        double duration = simulationSpec.getNumber("duration", 3600, 1, 86400, optionError);
+
+        if (!optionError.isEmpty())
+        {
+            errorString = optionError;
+            return nullptr;
+        }
+
+        frames = createFrames_SyntheticLaserRangeFinder20HzV2(qRound(1000 / rate), static_cast<qint64>(duration * 1000));
+    }
+
+    if (!optionError.isEmpty())
+    {
+        errorString = optionError;
+        return nullptr;
+    }
+
+    return new SimulatedSerialDevice(frames, speedFactor, absoluteTiming);
+}
+
+bool SimulatedSerialDevice::openPseudoTerminal(QString& errorString)
+{
+#ifdef PTY_SUPPORTED
+    char name[256];
+
+    if (openpty(&masterFd, &slaveFd, name, nullptr, nullptr) != 0)
+    {
+        masterFd = -1;
+        slaveFd = -1;
+        errorString = "Can't create pseudo terminal.";
+        return false;
+    }
+
+    struct termios settings;
+    tcgetattr(masterFd, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(masterFd, TCSANOW, &settings);
+
+    // Writes must not block: Data not fitting into the buffer is dropped (and counted)
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+    portName = QString::fromLocal8Bit(name);
+    return true;
+#else
+    errorString = "Pseudo terminals are not supported on this platform.";
+    return false;
+#endif
+}
+
+void SimulatedSerialDevice::run()
+{
+    if (masterFd < 0)
+    {
+        emit errorMessage("Pseudo terminal not open. Can't do anything.");
+        return;
+    }
+
+    if (frames.isEmpty())
+    {
+        emit warningMessage("No data to send.");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const qint64 firstFrameTime = frames.first().time_ms;
+
+    auto getDeviceTime = [&]()
+    {
+        if (absoluteTiming)
+        {
+            return QDateTime::currentMSecsSinceEpoch() * speedFactor;
+        }
+        else
+        {
+            return firstFrameTime + timer.nsecsElapsed() * 1e-6 * speedFactor;
+        }
+    };
+
+    int frameIndex = 0;
+
+    if (absoluteTiming)
+    {
+        double deviceTime = getDeviceTime();
+
+        while ((frameIndex < frames.count()) && (frames[frameIndex].time_ms < deviceTime))
+        {
+            frameIndex++;
+        }
+    }
+
+    emit infoMessage("Simulated device \"" + portName + "\" running, speed factor: " + QString::number(speedFactor) + ".");
+
+    while ((!terminateRequest) && (frameIndex < frames.count()))
+    {
+        double deviceTime = getDeviceTime();
+
+        while ((frameIndex < frames.count()) && (frames[frameIndex].time_ms <= deviceTime))
+        {
+            const Frame& frame = frames[frameIndex++];
+
+#ifdef PTY_SUPPORTED
+            ssize_t written = write(masterFd, frame.data.constData(), static_cast<size_t>(frame.data.length()));
+#else
+            qint64 written = -1;
+#endif
+            qint64 bytesWritten = (written > 0) ? written : 0;
+
+            QMutexLocker locker(&statisticsMutex);
+
+            statistics.numOfBytesWritten += bytesWritten;
+
+            if (bytesWritten < frame.data.length())
+            {
+                statistics.numOfFramesDropped++;
+                statistics.numOfBytesDropped += frame.data.length() - bytesWritten;
+            }
+            else
+            {
+                statistics.numOfFramesWritten++;
+            }
+
+            qint64 lag = static_cast<qint64>((deviceTime - frame.time_ms) / speedFactor);
+
+            if (lag > statistics.maxLag_ms)
+            {
+                statistics.maxLag_ms = lag;
+            }
+        }
+
+        if (frameIndex < frames.count())
+        {
+            // Wake up at least every 100 ms to check for termination
+            double waitTime = (frames[frameIndex].time_ms - getDeviceTime()) / speedFactor;
+            msleep(static_cast<unsigned long>(qBound(0., ceil(waitTime), 100.)));
+        }
+    }
+
+    emit infoMessage("End of simulated data.");
+}
+
+void SimulatedSerialDevice::requestTerminate(void)
+{
+    terminateRequest = true;
+}
+
+SimulatedSerialDevice::Statistics SimulatedSerialDevice::getStatistics(void)
+{
+    QMutexLocker locker(&statisticsMutex);
+    return statistics;
+}
+
+QByteArray SimulatedSerialDevice::createUBXFrame(const unsigned char messageClass, const unsigned char messageId, const QByteArray& payload)
+{
+    QByteArray frame;
+
+    frame.append(static_cast<char>(0xB5));
+    frame.append(static_cast<char>(0x62));
+    frame.append(static_cast<char>(messageClass));
+    frame.append(static_cast<char>(messageId));
+    frame.append(static_cast<char>(payload.length() & 0xFF));
+    frame.append(static_cast<char>(payload.length() >> 8));
+    frame.append(payload);
+
+    unsigned char checksumA = 0;
+    unsigned char checksumB = 0;
+
+    for (int i = 2; i < frame.length(); i++)
+    {
+        checksumA += static_cast<unsigned char>(frame[i]);
+        checksumB += checksumA;
+    }
+
+    frame.append(static_cast<char>(checksumA));
+    frame.append(static_cast<char>(checksumB));
+
+    return frame;
+}
+
+QByteArray SimulatedSerialDevice::createRELPOSNEDFrame(const int iTOW, const Eigen::Vector3d& relPos)
+{
+    // UBX-NAV-RELPOSNED, version 1 (see UBXDecoder::Layout_NAV_RELPOSNED for offsets)
+    QByteArray payload(64, 0);
+    char* data = payload.data();
+
+    data[0] = 1;
+    qToLittleEndian<quint32>(static_cast<quint32>(iTOW), data + 4);
+
+    // Values are split to cm + 0.1 mm parts
+    auto setValue = [data](const int offset_cm, const int offset_hp, const double value)
+    {
+        qint64 tenthsOfMm = qRound64(value * 1e4);
+        qint32 cm = static_cast<qint32>(tenthsOfMm / 100);
+        qToLittleEndian<qint32>(cm, data + offset_cm);
+        data[offset_hp] = static_cast<char>(tenthsOfMm - static_cast<qint64>(cm) * 100);
+    };
+
+    setValue(8, 32, relPos(0));
+    setValue(12, 33, relPos(1));
+    setValue(16, 34, relPos(2));
+    setValue(20, 35, relPos.norm());
+
+    double heading = qRadiansToDegrees(atan2(relPos(1), relPos(0)));
+
+    if (heading < 0)
+    {
+        heading += 360;
+    }
+
+    qToLittleEndian<qint32>(static_cast<qint32>(heading * 1e5), data + 24);
+
+    qToLittleEndian<quint32>(100, data + 36);   // accN
+    qToLittleEndian<quint32>(100, data + 40);   // accE
+    qToLittleEndian<quint32>(150, data + 44);   // accD
+    qToLittleEndian<quint32>(100, data + 48);   // accLength
+    qToLittleEndian<quint32>(1000, data + 52);  // accHeading
+
+    // gnssFixOK, diffSoln, relPosValid, carrSoln = FIXED, relPosHeadingValid
+    qToLittleEndian<quint32>((1 << 0) | (1 << 1) | (1 << 2) | (2 << 3) | (1 << 8), data + 60);
+
+    return createUBXFrame(0x01, 0x3C, payload);
+}
+
+QByteArray SimulatedSerialDevice::createLaserRangeFinder20HzV2Frame(const double distance)
+{
+    QByteArray frame;
+
+    frame.append(static_cast<char>(0x80));
+    frame.append(static_cast<char>(0x06));
+    frame.append(static_cast<char>(0x83));
+    frame.append(QString::asprintf("%08.4f", qBound(0., distance, 999.9999)).toLatin1());
+
+    // Checksum: Sum of all bytes before it, inverted, plus 1
+    unsigned char checksum = 0;
+
+    for (int i = 0; i < frame.length(); i++)
+    {
+        checksum += static_cast<unsigned char>(frame[i]);
+    }
+
+    checksum = ~checksum;
+    checksum++;
+
+    frame.append(static_cast<char>(checksum));
+
+    return frame;
+}
+
+Eigen::Vector3d SimulatedSerialDevice::getAntennaLocation(const unsigned int roverIndex)
+{
+    switch (roverIndex)
+    {
+    case 0:
+        return Eigen::Vector3d(0, -1, 0);
+    case 1:
+        return Eigen::Vector3d(0, 1, 0);
+    case 2:
+        return Eigen::Vector3d(1, 0, 0);
+    default:
+    {
+        double angle = roverIndex * 2 * M_PI / 7;
+        return Eigen::Vector3d(cos(angle), sin(angle), 0);
+    }
+    }
+}
+
+QVector<SimulatedSerialDevice::Frame> SimulatedSerialDevice::createFrames_SyntheticRELPOSNED(const unsigned int roverIndex, const qint64 startTime, const int interval_ms, const qint64 duration_ms,
+                                                                                              const double radius, const double velocity)
+{
+    QVector<Frame> frames;
+
+    const qint64 firstTime = ((startTime + interval_ms - 1) / interval_ms) * interval_ms;
+    const Eigen::Vector3d antennaLocation = getAntennaLocation(roverIndex);
+
+    frames.reserve(static_cast<int>(duration_ms / interval_ms) + 1);
+
+    for (qint64 time = firstTime; time < firstTime + duration_ms; time += interval_ms)
+    {
+        // Position is a function of the device time only -> rovers agree regardless of when they were started
+        double angle = fmod(velocity * (time % msecsInWeek) / 1000. / radius, 2 * M_PI);
+
+        Eigen::Vector3d rigLocation(radius * cos(angle), radius * sin(angle), 0);
+        Eigen::Matrix3d rotation = Eigen::AngleAxisd(angle + M_PI / 2, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+        Frame frame;
+        frame.time_ms = time;
+        frame.data = createRELPOSNEDFrame(static_cast<int>(time % msecsInWeek), rigLocation + rotation * antennaLocation);
+        frames.append(frame);
+    }
+
+    return frames;
+}
+
+QVector<SimulatedSerialDevice::Frame> SimulatedSerialDevice::createFrames_SyntheticLaserRangeFinder20HzV2(const int interval_ms, const qint64 duration_ms)
+{
+    QVector<Frame> frames;
+
+    frames.reserve(static_cast<int>(duration_ms / interval_ms) + 1);
+
+    for (qint64 time = 0; time < duration_ms; time += interval_ms)
+    {
+        Frame frame;
+        frame.time_ms = time;
+        frame.data = createLaserRangeFinder20HzV2Frame(1 + 0.5 * sin(2 * M_PI * time / 10000.));
+        frames.append(frame);
+    }
+
+    return frames;
+}
+
+bool SimulatedSerialDevice::loadFrames_UBX(const QString& fileName, QVector<Frame>& frames, QString& errorString)
+{
+    frames.clear();
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString = "Can not open file \"" + fileName + "\".";
+        return false;
+    }
+
+    const QByteArray fileData = file.readAll();
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(fileData.constData());
+    const int length = fileData.length();
+
+    QByteArray pendingData;             // Messages waiting for the next RELPOSNED-message
+    qint64 weekOffset = 0;
+    qint64 previousITOW = -1;
+    int index = 0;
+
+    while (index + 8 <= length)
+    {
+        if ((data[index] != 0xB5) || (data[index + 1] != 0x62))
+        {
+            index++;
+            continue;
+        }
+
+        const int payloadLength = data[index + 4] | (data[index + 5] << 8);
+        const int frameLength = payloadLength + 8;
+
+        if (index + frameLength > length)
+        {
+            break;
+        }
+
+        unsigned char checksumA = 0;
+        unsigned char checksumB = 0;
+
+        for (int i = index + 2; i < index + frameLength - 2; i++)
+        {
+            checksumA += data[i];
+            checksumB += checksumA;
+        }
+
+        if ((checksumA != data[index + frameLength - 2]) || (checksumB != data[index + frameLength - 1]))
+        {
+            // Not a valid frame -> Resync from the next byte
+            index++;
+            continue;
+        }
+
+        pendingData.append(fileData.mid(index, frameLength));
+
+        if ((data[index + 2] == 0x01) && (data[index + 3] == 0x3C) && (payloadLength >= 8))
+        {
+            // RELPOSNED: ITOW at payload offset 4 (same in versions 0 and 1)
+            qint64 iTOW = qFromLittleEndian<quint32>(data + index + 6 + 4);
+
+            if ((previousITOW >= 0) && (iTOW + weekOffset < previousITOW - msecsInWeek / 2))
+            {
+                weekOffset += msecsInWeek;
+            }
+
+            previousITOW = iTOW + weekOffset;
+
+            Frame frame;
+            frame.time_ms = previousITOW;
+            frame.data = pendingData;
+            frames.append(frame);
+
+            pendingData.clear();
+        }
+
+        index += frameLength;
+    }
+
+    if ((!pendingData.isEmpty()) && (!frames.isEmpty()))
+    {
+        frames.last().data.append(pendingData);
+    }
+
+    if (frames.isEmpty())
+    {
+        errorString = "No RELPOSNED-messages in file \"" + fileName + "\".";
+        return false;
+    }
+
+    return true;
+}
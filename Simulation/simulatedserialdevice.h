@@ -0,0 +1,173 @@
+/*
+    simulatedserialdevice.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulatedserialdevice.h
+ * @brief Declaration for a simulated serial device (u-blox rover, laser range finder) behind a pseudo terminal.
+ */
+
+#ifndef SIMULATEDSERIALDEVICE_H
+#define SIMULATEDSERIALDEVICE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+
+#include "Eigen/Geometry"
+
+/**
+ * @brief Simulated serial device
+ *
+ * Creates a pseudo terminal pair and writes timed frames into its master side.
+ * Realtime classes (SerialThread, LaserRangeFinder20HzV2SerialThread) open the slave side
+ * (getPortName) like any serial port, so they are tested as such.
+ *
+ * If the reader doesn't keep up and the pseudo terminal's buffer fills, data that
+ * can't be written is dropped (like an UART overrun) and counted in the statistics.
+ *
+ * Timing:
+ * - Frame times are in milliseconds of "device time". Device time runs speedFactor times faster than real time.
+ * - Relative timing (recorded logs): Device time starts from the first frame's time when the thread is started.
+ * - Absolute timing (synthetic GNSS-data): Device time = QDateTime::currentMSecsSinceEpoch() * speedFactor.
+ *   Frames already in the past when started are skipped (not counted as dropped).
+ *   Synthetic rovers started at different times therefore still send the same ITOWs at the same time.
+ *
+ * Pseudo terminals are supported on Linux and macOS only.
+ *
+ * Options (see SimulationSpec) for rovers, "sim:synthetic,...":
+ * - hz: RELPOSNED-rate (1...100, default 8)
+ * - duration: Length of data (s, 1...86400, default 3600)
+ * - radius: Radius of circle rig moves along (m, 0.1...1000, default 10)
+ * - velocity: Velocity of the rig (m/s, 0...100, default 0.5)
+ *
+ * Options for rovers, "sim:<file.ubx>,...": Only common ones. UBX-file is played back timed by RELPOSNED-messages' ITOWs.
+ *
+ * Options for laser range finder, "sim:synthetic,...":
+ * - hz: Measurement rate (1...100, default 20)
+ * - duration: Length of data (s, 1...86400, default 3600)
+ */
+class SimulatedSerialDevice : public QThread
+{
+    Q_OBJECT
+
+public:
+    class Frame
+    {
+    public:
+        qint64 time_ms = 0;         //!< Device time (see class description)
+        QByteArray data;
+    };
+
+    class Statistics
+    {
+    public:
+        qint64 numOfFramesWritten = 0;
+        qint64 numOfBytesWritten = 0;
+        qint64 numOfFramesDropped = 0;      //!< Frames (partially) dropped because pseudo terminal's buffer was full
+        qint64 numOfBytesDropped = 0;
+        qint64 maxLag_ms = 0;               //!< Max delay (real time) between frame's scheduled and actual write time
+    };
+
+    enum DeviceType
+    {
+        DEVICE_UBLOX_ROVER = 0,             //!< RELPOSNED-messages (roverIndex selects antenna)
+        DEVICE_LASERRANGEFINDER20HZV2,      //!< Distances in "V2" 20 Hz laser range finder's format
+    };
+
+    /**
+     * @brief Constructor
+     * @param frames Frames in time order
+     * @param speedFactor Playback speed (1...SimulationSpec::maxSpeedFactor)
+     * @param absoluteTiming See class description
+     */
+    SimulatedSerialDevice(const QVector<Frame>& frames, const double speedFactor = 1, const bool absoluteTiming = false);
+    ~SimulatedSerialDevice() override;
+
+    /**
+     * @brief Creates device from simulation spec
+     * @param spec Spec ("sim:...", see SimulationSpec)
+     * @param deviceType Type of the device
+     * @param roverIndex Index of the rover (antenna) for synthetic RELPOSNED-messages
+     * @param errorString Description of the error (if any)
+     * @return Device (not opened) or nullptr in case of error
+     */
+    static SimulatedSerialDevice* createFromSpec(const QString& spec, const DeviceType deviceType, const unsigned int roverIndex, QString& errorString);
+
+    bool openPseudoTerminal(QString& errorString);      //!< Creates pseudo terminal pair. Must be called before start
+    QString getPortName(void) const { return portName; }    //!< Returns name of the pseudo terminal's slave side (to be opened as a serial port)
+
+    void run() override;            //!< Thread code
+    void requestTerminate(void);    //!< Requests thread to terminate
+
+    Statistics getStatistics(void);     //!< Returns statistics (thread safe)
+    int getNumOfFrames(void) const { return frames.count(); }   //!< Returns total number of frames
+
+    static QByteArray createUBXFrame(const unsigned char messageClass, const unsigned char messageId, const QByteArray& payload);   //!< Creates UBX-frame (with checksum)
+    static QByteArray createRELPOSNEDFrame(const int iTOW, const Eigen::Vector3d& relPos);      //!< Creates UBX-NAV-RELPOSNED-frame
+    static QByteArray createLaserRangeFinder20HzV2Frame(const double distance);                  //!< Creates distance frame (0.1 mm resolution)
+
+    static Eigen::Vector3d getAntennaLocation(const unsigned int roverIndex);   //!< Antenna location in rig's body frame (NED). Rovers 0...2 as PostProcessingForm's defaults, others on a unit circle
+
+    /**
+     * @brief Creates RELPOSNED-frames of a rig moving along a circle (absolute timing)
+     * @param roverIndex Index of the rover (antenna)
+     * @param startTime Device time of the first frame (rounded up to interval)
+     * @param interval_ms Interval of frames
+     * @param duration_ms Length of data
+     * @param radius Radius of the circle (m)
+     * @param velocity Velocity of the rig (m/s)
+     * @return Frames
+     */
+    static QVector<Frame> createFrames_SyntheticRELPOSNED(const unsigned int roverIndex, const qint64 startTime, const int interval_ms, const qint64 duration_ms,
+                                                          const double radius = 10, const double velocity = 0.5);
+
+    static QVector<Frame> createFrames_SyntheticLaserRangeFinder20HzV2(const int interval_ms, const qint64 duration_ms);   //!< Creates distance frames (relative timing)
+
+    /**
+     * @brief Reads frames from a recorded UBX-file (relative timing)
+     *
+     * All UBX-messages are played back. Frame times are taken from RELPOSNED-messages' ITOWs,
+     * other messages are sent together with the next RELPOSNED-message.
+     * @param fileName File name
+     * @param frames Frames
+     * @param errorString Description of the error (if any)
+     * @return true if successful
+     */
+    static bool loadFrames_UBX(const QString& fileName, QVector<Frame>& frames, QString& errorString);
+
+private:
+    QVector<Frame> frames;
+    double speedFactor = 1;
+    bool absoluteTiming = false;
+
+    int masterFd = -1;
+    int slaveFd = -1;           //!< Kept open so the pseudo terminal doesn't hang up between openings of the slave side
+    QString portName;
+
+    volatile bool terminateRequest = false;
+
+    QMutex statisticsMutex;
+    Statistics statistics;
+
+signals:
+    void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
+    void warningMessage(const QString&);    //!< Signal for warning message (less severe than error)
+    void errorMessage(const QString&);      //!< Signal for error message
+};
+
+#endif // SIMULATEDSERIALDEVICE_H
@@ -0,0 +1,98 @@
+/*
+    simulationspec.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulationspec.cpp
+ * @brief Definition for a parser of simulated device specifications ("sim:..." in place of a serial port name).
+ */
+
+#include <QStringList>
+
+#include "simulationspec.h"
+
+const QString SimulationSpec::prefix = "sim:";
+const double SimulationSpec::maxSpeedFactor = 50;
+
+bool SimulationSpec::isSimulationSpec(const QString& portName)
+{
+    return portName.trimmed().startsWith(prefix, Qt::CaseInsensitive);
+}
+
+bool SimulationSpec::parse(const QString& spec, QString& errorString)
+{
+    source.clear();
+    options.clear();
+
+    QString trimmed = spec.trimmed();
+
+    if (!trimmed.startsWith(prefix, Qt::CaseInsensitive))
+    {
+        errorString = "Simulation spec must begin with \"" + prefix + "\".";
+        return false;
+    }
+
+    QStringList parts = trimmed.mid(prefix.length()).split(',');
+
+    source = parts.takeFirst().trimmed();
+
+    if (source.isEmpty())
+    {
+        errorString = "Simulation source missing (\"synthetic\" or file name).";
+        return false;
+    }
+
+    for (const QString& part : parts)
+    {
+        int separatorIndex = part.indexOf('=');
+
+        if (separatorIndex <= 0)
+        {
+            errorString = "Invalid option \"" + part + "\" (expected <option>=<value>).";
+            return false;
+        }
+
+        options[part.left(separatorIndex).trimmed().toLower()] = part.mid(separatorIndex + 1).trimmed();
+    }
+
+    return true;
+}
+
+double SimulationSpec::getNumber(const QString& key, const double defaultValue, const double minValue, const double maxValue, QString& errorString) const
+{
+    if (!options.contains(key))
+    {
+        return defaultValue;
+    }
+
+    bool ok = false;
+    double value = options[key].toDouble(&ok);
+
+    if ((!ok) || (value < minValue) || (value > maxValue))
+    {
+        errorString = "Invalid value for option \"" + key + "\": \"" + options[key] +
+                "\" (allowed range: " + QString::number(minValue) + "..." + QString::number(maxValue) + ").";
+        return defaultValue;
+    }
+
+    return value;
+}
+
+double SimulationSpec::getSpeedFactor(QString& errorString) const
+{
+    return getNumber("speed", 1, 1, maxSpeedFactor, errorString);
+}
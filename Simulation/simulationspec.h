@@ -0,0 +1,77 @@
+/*
+    simulationspec.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file simulationspec.h
+ * @brief Declaration for a parser of simulated device specifications ("sim:..." in place of a serial port name).
+ */
+
+#ifndef SIMULATIONSPEC_H
+#define SIMULATIONSPEC_H
+
+#include <QString>
+#include <QMap>
+
+/**
+ * @brief Simulated device specification
+ *
+ * Simulated devices are selected by writing a specification instead of a serial port name:
+ * "sim:<source>[,<option>=<value>...]", where source is either "synthetic" or a name of a recorded log file.
+ * For example "sim:synthetic,speed=10,hz=20" or "sim:/home/user/session_RoverA.ubx,speed=5".
+ *
+ * Common options:
+ * - speed: Playback speed (1...50, default 1).
+ *
+ * Other options depend on the device (see SimulatedLidarSource and SimulatedSerialDevice).
+ */
+class SimulationSpec
+{
+public:
+    static const QString prefix;            //!< "sim:"
+    static const double maxSpeedFactor;     //!< Max value for option "speed"
+
+    static bool isSimulationSpec(const QString& portName);  //!< Returns true if portName is a simulation spec (starts with prefix)
+
+    /**
+     * @brief Parses specification
+     * @param spec Specification ("sim:...")
+     * @param errorString Description of the error (if any)
+     * @return true if parsed successfully
+     */
+    bool parse(const QString& spec, QString& errorString);
+
+    QString source;                     //!< "synthetic" or file name
+    QMap<QString, QString> options;     //!< Options (key -> value)
+
+    bool isSynthetic(void) const { return source == "synthetic"; }  //!< Returns true if source is synthetic
+
+    /**
+     * @brief Returns option as a number
+     * @param key Option
+     * @param defaultValue Value returned if option is not given
+     * @param minValue Minimum accepted value
+     * @param maxValue Maximum accepted value
+     * @param errorString Set if value is not a number or outside limits (not touched otherwise)
+     * @return Value of the option (defaultValue in case of error)
+     */
+    double getNumber(const QString& key, const double defaultValue, const double minValue, const double maxValue, QString& errorString) const;
+
+    double getSpeedFactor(QString& errorString) const;      //!< Returns option "speed" (1...maxSpeedFactor)
+};
+
+#endif // SIMULATIONSPEC_H
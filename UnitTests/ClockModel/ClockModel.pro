@@ -0,0 +1,23 @@
+QT += testlib
+QT += widgets
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+# Widgets are needed only for PostProcessingForm's (Rover-class) headers.
+# On a server without display run with "-platform offscreen".
+
+INCLUDEPATH += ../.. ../../Eigen ../../Lidar
+
+SOURCES +=  tst_clockmodel.cpp \
+    ../Common/roverfixture.cpp \
+    ../../PostProcessing/clockmodel.cpp \
+    ../../gnssmessage.cpp
+
+HEADERS += \
+    ../Common/roverfixture.h \
+    ../../PostProcessing/clockmodel.h \
+    ../../gnssmessage.h \
+    ../../ubxdecoder.h
@@ -0,0 +1,157 @@
+/*
+    tst_clockmodel.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+
+#include "../Common/roverfixture.h"
+#include "../../PostProcessing/clockmodel.h"
+
+class ClockModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_ClockModel();
+    void test_ClockModel_NumOfRovers();
+};
+
+void ClockModelTest::test_ClockModel()
+{
+    // Uptime clock running 50 ppm fast with +-5 ms jitter, one outlier (buffering)
+    // and a restart (uptime jumping back) after 500 measurements
+    const int interval = 100;
+    const int numOfMeasurements = 1000;
+    const int restartIndex = 500;
+    const int outlierIndex = 200;
+    const double slope = 1.00005;
+
+    QVector<ClockModel::SyncPoint> syncPoints;
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        ClockModel::SyncPoint point;
+        point.iTOW = RoverFixture::firstITOW + i * interval;
+
+        double modelUptime;
+
+        if (i < restartIndex)
+        {
+            modelUptime = RoverFixture::firstUptime + slope * (i * interval);
+        }
+        else
+        {
+            modelUptime = 1000 + slope * ((i - restartIndex) * interval);
+        }
+
+        point.uptime = modelUptime + ((i % 3) - 1) * 5;
+
+        if (i == outlierIndex)
+        {
+            point.uptime += 200;
+        }
+
+        syncPoints.append(point);
+    }
+
+    ClockModel clockModel;
+    QVERIFY(clockModel.isEmpty());
+
+    clockModel.fit(syncPoints);
+
+    QCOMPARE(clockModel.getSegments().count(), 2);
+    QCOMPARE(clockModel.getNumOfOutliers(), 1);
+    QCOMPARE(clockModel.getNumOfPoints(), numOfMeasurements - 1);
+    QVERIFY(clockModel.getRMSResidual() < 5);
+
+    const ClockModel::Segment& firstSegment = clockModel.getSegments()[0];
+    const ClockModel::Segment& secondSegment = clockModel.getSegments()[1];
+
+    QCOMPARE(firstSegment.firstITOW, RoverFixture::firstITOW);
+    QCOMPARE(firstSegment.lastITOW, RoverFixture::firstITOW + (restartIndex - 1) * interval);
+    QCOMPARE(secondSegment.firstITOW, RoverFixture::firstITOW + restartIndex * interval);
+    QVERIFY(fabs(firstSegment.slope - slope) < 1e-5);
+    QVERIFY(firstSegment.maxAbsResidual <= 6);
+
+    // Both directions, both segments
+    for (int i = 0; i < numOfMeasurements; i += 7)
+    {
+        UBXMessage_RELPOSNED::ITOW iTOW = RoverFixture::firstITOW + i * interval;
+        double modelUptime = (i < restartIndex) ?
+                    (RoverFixture::firstUptime + slope * (i * interval)) :
+                    (1000 + slope * ((i - restartIndex) * interval));
+
+        QVERIFY(fabs(clockModel.getUptime(iTOW) - modelUptime) < 2);
+        QVERIFY(fabs(clockModel.getITOW(modelUptime) - iTOW) < 2);
+    }
+
+    // Outside segments -> extrapolated from the nearest one
+    QVERIFY(fabs(clockModel.getITOW(RoverFixture::firstUptime - 1000) - (RoverFixture::firstITOW - 1000)) < 2);
+
+    clockModel.clear();
+    QVERIFY(clockModel.isEmpty());
+    QCOMPARE(clockModel.getSegmentIndex_Uptime(0), -1);
+}
+
+void ClockModelTest::test_ClockModel_NumOfRovers()
+{
+    // Four rovers, rover 3 missing every other ITOW and rovers 2 and 3 missing every tenth
+    const int numOfMeasurements = 100;
+    const int interval = 100;
+
+    PostProcessingForm::Rover rovers[4];
+
+    for (unsigned int roverIndex = 0; roverIndex < 4; roverIndex++)
+    {
+        RoverFixture::fillRoverSyncData(rovers[roverIndex], numOfMeasurements, interval,
+                                        [roverIndex](const int i, UBXMessage_RELPOSNED::ITOW&, qint64& uptime)
+        {
+            uptime += roverIndex * 4;
+
+            return !(((roverIndex == 3) && (i % 2 == 1)) ||
+                     ((roverIndex >= 2) && (i % 10 == 5)));
+        });
+    }
+
+    ClockModel clockModel;
+
+    // ITOWs with only two rovers are left out, others averaged over rovers having them
+    clockModel.fit(rovers, 4);
+
+    QCOMPARE(clockModel.getSegments().count(), 1);
+    QCOMPARE(clockModel.getNumOfPoints() + clockModel.getNumOfOutliers(), numOfMeasurements - numOfMeasurements / 10);
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        UBXMessage_RELPOSNED::ITOW iTOW = RoverFixture::firstITOW + i * interval;
+        double averagedUptime = RoverFixture::firstUptime + i * interval + ((i % 2 == 1) ? 4 : 6);
+
+        // Averages alternate between +4 and +6 -> line in the middle
+        QVERIFY(fabs(clockModel.getUptime(iTOW) - averagedUptime) < 2);
+        QVERIFY(fabs(clockModel.getITOW(averagedUptime) - iTOW) < 2);
+    }
+
+    // Three rovers -> all of them needed (original behavior)
+    clockModel.fit(rovers, 3);
+    QCOMPARE(clockModel.getNumOfPoints() + clockModel.getNumOfOutliers(), numOfMeasurements - numOfMeasurements / 10);
+    QVERIFY(fabs(clockModel.getUptime(RoverFixture::firstITOW) - (RoverFixture::firstUptime + 4)) < 1e-6);
+}
+
+QTEST_MAIN(ClockModelTest)
+
+#include "tst_clockmodel.moc"
@@ -0,0 +1,47 @@
+/*
+    roverfixture.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file roverfixture.cpp
+ * @brief Definition for rover data fixtures shared by post-processing unit tests and benchmarks.
+ */
+
+#include "roverfixture.h"
+
+void RoverFixture::fillRoverSyncData(PostProcessingForm::Rover& rover, const int numOfMeasurements, const int interval,
+                                     const std::function<bool(const int i, UBXMessage_RELPOSNED::ITOW& iTOW, qint64& uptime)>& adjust)
+{
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        UBXMessage_RELPOSNED::ITOW iTOW = firstITOW + i * interval;
+        qint64 uptime = firstUptime + i * interval;
+
+        if (adjust && (!adjust(i, iTOW, uptime)))
+        {
+            continue;
+        }
+
+        PostProcessingForm::RoverSyncItem syncItem;
+        syncItem.messageType = PostProcessingForm::RoverSyncItem::MSGTYPE_UBX_RELPOSNED;
+        syncItem.iTOW = iTOW;
+        syncItem.frameTime = uptime;
+
+        rover.roverSyncData[uptime] = syncItem;
+        rover.reverseSync[iTOW] = uptime;
+    }
+}
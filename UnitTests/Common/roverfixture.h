@@ -0,0 +1,51 @@
+/*
+    roverfixture.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file roverfixture.h
+ * @brief Declaration for rover data fixtures shared by post-processing unit tests and benchmarks.
+ */
+
+#ifndef ROVERFIXTURE_H
+#define ROVERFIXTURE_H
+
+#include <functional>
+
+#include "../../PostProcessing/postprocessingform.h"
+
+/**
+ * @brief Fills PostProcessingForm::Rover-objects with regular, hand-made data
+ */
+class RoverFixture
+{
+public:
+    static const int firstITOW = 100000000;         //!< iTOW of the first measurement
+    static const qint64 firstUptime = 1000000;      //!< Uptime of the first measurement
+
+    /**
+     * @brief Fills rover's sync data (roverSyncData and reverseSync) with RELPOSNED-items at regular intervals
+     * @param rover Rover to fill
+     * @param numOfMeasurements Number of measurements (i = 0...numOfMeasurements - 1)
+     * @param interval Interval of the measurements (ms). Measurement i has iTOW firstITOW + i * interval and uptime firstUptime + i * interval.
+     * @param adjust Function that can modify iTOW and uptime of measurement i (for example to add jitter). Returning false skips the measurement (optional).
+     */
+    static void fillRoverSyncData(PostProcessingForm::Rover& rover, const int numOfMeasurements, const int interval,
+                                  const std::function<bool(const int i, UBXMessage_RELPOSNED::ITOW& iTOW, qint64& uptime)>& adjust = nullptr);
+};
+
+#endif // ROVERFIXTURE_H
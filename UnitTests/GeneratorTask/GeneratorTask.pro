@@ -0,0 +1,14 @@
+QT += testlib
+QT += concurrent
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+SOURCES +=  tst_generatortask.cpp \
+    ../../PostProcessing/generatortask.cpp
+
+HEADERS += \
+    ../../PostProcessing/generatortask.h
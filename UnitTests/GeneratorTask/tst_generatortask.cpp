@@ -0,0 +1,110 @@
+/*
+    tst_generatortask.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "../../PostProcessing/generatortask.h"
+
+class GeneratorTaskTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_GeneratorTask();
+};
+
+void GeneratorTaskTest::test_GeneratorTask()
+{
+    GeneratorTask task;
+
+    QStringList messages;
+    qint64 lastProcessed = -1;
+    qint64 lastTotal = -1;
+
+    connect(&task, &GeneratorTask::infoMessage, [&](const QString& message) { messages.append("I:" + message); });
+    connect(&task, &GeneratorTask::warningMessage, [&](const QString& message) { messages.append("W:" + message); });
+    connect(&task, &GeneratorTask::errorMessage, [&](const QString& message) { messages.append("E:" + message); });
+    connect(&task, &GeneratorTask::progressChanged, [&](const qint64 processed, const qint64 total)
+    {
+        lastProcessed = processed;
+        lastTotal = total;
+    });
+
+    // Messages from the worker are delivered in the caller's thread in the original order
+    QThread* callerThread = QThread::currentThread();
+    QThread* workerThread = nullptr;
+
+    QVERIFY(task.run([&]()
+    {
+        workerThread = QThread::currentThread();
+
+        for (int i = 0; i < 1000; i++)
+        {
+            task.addInfoMessage(QString::number(i));
+            task.setProgress(i + 1, 1000);
+        }
+
+        task.addWarningMessage("w");
+        task.addErrorMessage("e");
+    }));
+
+    QVERIFY(workerThread != callerThread);
+    QCOMPARE(messages.count(), 1002);
+    QCOMPARE(messages[0], QString("I:0"));
+    QCOMPARE(messages[999], QString("I:999"));
+    QCOMPARE(messages[1000], QString("W:w"));
+    QCOMPARE(messages[1001], QString("E:e"));
+    QCOMPARE(lastProcessed, qint64(1000));
+    QCOMPARE(lastTotal, qint64(1000));
+    QVERIFY(!task.isRunning());
+
+    // Cancel requested while running -> worker sees the flag and run returns false
+    QTimer::singleShot(10, &task, &GeneratorTask::requestCancel);
+
+    bool cancelSeen = false;
+
+    QVERIFY(!task.run([&]()
+    {
+        QElapsedTimer timeoutTimer;
+        timeoutTimer.start();
+
+        while (!GeneratorTask::isCancelRequested(&task) && (timeoutTimer.elapsed() < 10000))
+        {
+            QThread::msleep(1);
+        }
+
+        cancelSeen = GeneratorTask::isCancelRequested(&task);
+    }));
+
+    QVERIFY(cancelSeen);
+
+    // Cancel flag is reset for the next run
+    QVERIFY(task.run([]() {}));
+
+    // Static helpers work without a task
+    GeneratorTask::setProgress(nullptr, 1, 2);
+    QVERIFY(!GeneratorTask::isCancelRequested(nullptr));
+}
+
+QTEST_MAIN(GeneratorTaskTest)
+
+#include "tst_generatortask.moc"
@@ -0,0 +1,109 @@
+/*
+    tst_losolver.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "../../losolver.h"
+
+class LOSolverTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_LOSolver_NumOfPoints();
+};
+
+void LOSolverTest::test_LOSolver_NumOfPoints()
+{
+    // Reference points: triangle (default antenna locations) + additional antennas out of its plane
+    const QVector<Eigen::Vector3d> allRefPoints =
+    {
+        Eigen::Vector3d(0, -1, 0),
+        Eigen::Vector3d(0, 1, 0),
+        Eigen::Vector3d(1, 0, 0),
+        Eigen::Vector3d(0.3, -0.4, -0.5),
+        Eigen::Vector3d(-0.6, 0.2, 0.1),
+    };
+
+    Eigen::Transform<double, 3, Eigen::Affine> expectedTransform;
+    expectedTransform.setIdentity();
+    expectedTransform.translate(Eigen::Vector3d(12.3, -4.5, 0.6));
+    expectedTransform.rotate(Eigen::AngleAxisd(0.7, Eigen::Vector3d(0.2, 0.3, 1).normalized()));
+
+    for (int numOfPoints = LOSolver::minNumOfPoints; numOfPoints <= allRefPoints.count(); numOfPoints++)
+    {
+        const QVector<Eigen::Vector3d> refPoints = allRefPoints.mid(0, numOfPoints);
+
+        LOSolver loSolver;
+        QVERIFY(loSolver.setReferencePoints(refPoints));
+        QCOMPARE(loSolver.getNumOfReferencePoints(), numOfPoints);
+
+        QVector<Eigen::Vector3d> points;
+
+        for (const Eigen::Vector3d& refPoint : refPoints)
+        {
+            points.append(expectedTransform * refPoint);
+        }
+
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+        QVERIFY(loSolver.setPoints(points));
+        QVERIFY(loSolver.getTransformMatrix(transform));
+        QVERIFY((transform.linear() - expectedTransform.linear()).norm() < 1e-9);
+        QVERIFY((transform.translation() - expectedTransform.translation()).norm() < 1e-9);
+
+        // One antenna missing -> solvable only if enough others remain
+        QVector<bool> validity(numOfPoints, true);
+        validity[1] = false;
+
+        if (numOfPoints > LOSolver::minNumOfPoints)
+        {
+            QVERIFY(loSolver.setPoints(points, validity));
+            QVERIFY(loSolver.getTransformMatrix(transform));
+            QVERIFY((transform.linear() - expectedTransform.linear()).norm() < 1e-9);
+            QVERIFY((transform.translation() - expectedTransform.translation()).norm() < 1e-9);
+        }
+        else
+        {
+            QVERIFY(!loSolver.setPoints(points, validity));
+            QCOMPARE(loSolver.getLastError(), LOSolver::ERROR_NOT_ENOUGH_POINTS);
+        }
+
+        // Batch gives the same results (second epoch with the missing antenna)
+        QVector<Eigen::Vector3d> batchPoints = points + points;
+        QVector<bool> batchValidity = QVector<bool>(numOfPoints, true) + validity;
+        QVector<Eigen::Transform<double, 3, Eigen::Affine>> batchTransforms(2);
+        QVector<LOSolver::ErrorCode> batchErrorCodes(2);
+
+        loSolver.solveBatch(batchPoints, batchValidity, 0, 2, batchTransforms, batchErrorCodes);
+
+        QCOMPARE(batchErrorCodes[0], LOSolver::ERROR_NONE);
+        QVERIFY((batchTransforms[0].linear() - expectedTransform.linear()).norm() < 1e-9);
+        QCOMPARE(batchErrorCodes[1], numOfPoints > LOSolver::minNumOfPoints ? LOSolver::ERROR_NONE : LOSolver::ERROR_NOT_ENOUGH_POINTS);
+    }
+
+    // Collinear reference points
+    LOSolver loSolver;
+    QVERIFY(!loSolver.setReferencePoints(QVector<Eigen::Vector3d>({ Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 0, 0),
+                                                                    Eigen::Vector3d(2, 0, 0), Eigen::Vector3d(3, 0, 0) })));
+}
+
+QTEST_MAIN(LOSolverTest)
+
+#include "tst_losolver.moc"
@@ -0,0 +1,15 @@
+QT += testlib
+QT += widgets
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+# On a server without display run with "-platform offscreen".
+
+SOURCES +=  tst_logmodel.cpp \
+    ../../logview.cpp
+
+HEADERS += \
+    ../../logview.h
@@ -0,0 +1,89 @@
+/*
+    tst_logmodel.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+
+#include "../../logview.h"
+
+class LogModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_LogModel();
+};
+
+void LogModelTest::test_LogModel()
+{
+    LogModel model;
+
+    int info = model.addCategory("Info");
+    int warning = model.addCategory("Warnings");
+
+    model.setMaxLines(100);
+
+    for (int i = 0; i < 250; i++)
+    {
+        model.addLine("Line " + QString::number(i), (i % 5 == 0) ? warning : info);
+    }
+
+    // Nothing shown before flushing
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.hasPendingLines());
+
+    QVERIFY(model.flushPending());
+
+    // Ring buffer keeps the newest lines
+    QCOMPARE(model.rowCount(), 100);
+    QVERIFY(model.getRowText(0).endsWith(": Line 150"));
+    QVERIFY(model.getRowText(99).endsWith(": Line 249"));
+    QCOMPARE(model.getCategoryCount(info), static_cast<quint64>(200));
+    QCOMPARE(model.getCategoryCount(warning), static_cast<quint64>(50));
+    QCOMPARE(model.getNumOfDroppedLines(), static_cast<quint64>(150));
+
+    // Category filtering
+    model.setCategoryVisible(info, false);
+    QCOMPARE(model.rowCount(), 20);
+    QVERIFY(model.getRowText(0).endsWith(": Line 150"));
+    model.setCategoryVisible(info, true);
+
+    // Text filtering (case insensitive)
+    model.setFilterText("LINE 24");
+    QCOMPARE(model.rowCount(), 10);
+    model.setFilterText("");
+
+    // Paused -> lines are collected and counted but rows don't change
+    model.setPaused(true);
+    model.addLine("Paused line", warning);
+    QVERIFY(!model.flushPending());
+    QCOMPARE(model.rowCount(), 100);
+    QCOMPARE(model.getCategoryCount(warning), static_cast<quint64>(51));
+
+    model.setPaused(false);
+    QVERIFY(model.flushPending());
+    QCOMPARE(model.rowCount(), 100);
+    QVERIFY(model.getRowText(99).endsWith(": Paused line"));
+
+    model.clear();
+    QCOMPARE(model.rowCount(), 0);
+}
+
+QTEST_MAIN(LogModelTest)
+
+#include "tst_logmodel.moc"
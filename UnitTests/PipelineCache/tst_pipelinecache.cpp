@@ -0,0 +1,303 @@
+/*
+    tst_pipelinecache.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+#include <QRandomGenerator>
+#include <QtMath>
+
+#include "../Common/roverfixture.h"
+#include "../../losolver.h"
+#include "../../Lidar/rplidarplausibilityfilter.h"
+#include "../../PostProcessing/Lidar/lidarpointtransformer.h"
+#include "../../PostProcessing/Lidar/processedroundcache.h"
+#include "../../PostProcessing/pipelinecache.h"
+#include "../../PostProcessing/clockmodel.h"
+
+class PipelineCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static const Eigen::Vector3d antennaLocations[3];
+
+    static QVector<QVector<RPLidarThread::DistanceItem>> createLidarRounds(const int numOfRounds, const int itemsPerRound);
+
+private slots:
+    void test_PipelineCache_PoseTable();
+    void test_PipelineCache_ProcessedRounds();
+};
+
+// Same as PostProcessingForm's defaults
+const Eigen::Vector3d PipelineCacheTest::antennaLocations[3] =
+{
+    Eigen::Vector3d(0, -1, 0),
+    Eigen::Vector3d(0, 1, 0),
+    Eigen::Vector3d(1, 0, 0),
+};
+
+QVector<QVector<RPLidarThread::DistanceItem>> PipelineCacheTest::createLidarRounds(const int numOfRounds, const int itemsPerRound)
+{
+    QVector<QVector<RPLidarThread::DistanceItem>> rounds;
+    QRandomGenerator randomGenerator(1);
+
+    for (int roundIndex = 0; roundIndex < numOfRounds; roundIndex++)
+    {
+        QVector<RPLidarThread::DistanceItem> round(itemsPerRound);
+
+        for (int i = 0; i < itemsPerRound; i++)
+        {
+            // "Room" with walls 4 m away + noise, every 50th item is an outlier
+            round[i].angle = static_cast<float>(2 * M_PI * i / itemsPerRound);
+            round[i].distance = static_cast<float>(4. / qMax(fabs(cos(round[i].angle)), fabs(sin(round[i].angle))) + (randomGenerator.bounded(2.) - 1) * 0.01);
+            round[i].quality = 0.8f;
+
+            if ((i % 50) == 0)
+            {
+                round[i].distance *= 0.3f;
+                round[i].quality = 0.1f;
+            }
+        }
+
+        rounds.append(round);
+    }
+
+    return rounds;
+}
+
+void PipelineCacheTest::test_PipelineCache_PoseTable()
+{
+    // Rig moving north and turning, antennas A and B at the same location in one epoch (-> LOSolver fails)
+    const int numOfMeasurements = 100;
+    const int interval = 100;
+    const UBXMessage_RELPOSNED::ITOW invalidITOW = RoverFixture::firstITOW + 50 * interval;
+
+    PostProcessingForm::Rover rovers[3];
+
+    for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+    {
+        RoverFixture::fillRoverSyncData(rovers[roverIndex], numOfMeasurements, interval);
+    }
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        UBXMessage_RELPOSNED::ITOW iTOW = RoverFixture::firstITOW + i * interval;
+
+        Eigen::Transform<double, 3, Eigen::Affine> rigTransform;
+        rigTransform.setIdentity();
+        rigTransform.translate(Eigen::Vector3d(i * 0.1, 0, 0));
+        rigTransform.rotate(Eigen::AngleAxisd(i * 0.01, Eigen::Vector3d::UnitZ()));
+
+        for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+        {
+            Eigen::Vector3d antennaLocation = rigTransform * antennaLocations[(iTOW == invalidITOW) && (roverIndex == 0) ? 1 : roverIndex];
+
+            UBXMessage_RELPOSNED relposned;
+            relposned.iTOW = iTOW;
+            relposned.relPosN = antennaLocation(0);
+            relposned.relPosE = antennaLocation(1);
+            relposned.relPosD = antennaLocation(2);
+            rovers[roverIndex].relposnedMessages[iTOW] = relposned;
+        }
+    }
+
+    LOSolver loSolver;
+    QVERIFY(loSolver.setReferencePoints(antennaLocations));
+
+    PipelineCache pipelineCache;
+
+    const ClockModel& clockModel = pipelineCache.getClockModel(rovers, 3);
+    QCOMPARE(clockModel.getSegments().count(), 1);
+    QCOMPARE(clockModel.getNumOfPoints(), numOfMeasurements);
+    QCOMPARE(&pipelineCache.getClockModel(rovers, 3), &clockModel);
+
+    const QMap<UBXMessage_RELPOSNED::ITOW, PostProcessingForm::LOInterpolator::Pose>& poseTable = pipelineCache.getPoseTable(rovers, 3, loSolver);
+    QCOMPARE(poseTable.count(), numOfMeasurements);
+
+    // Poses must be identical to the ones solved directly (as LOInterpolator does without table)
+    for (const UBXMessage_RELPOSNED::ITOW iTOW : rovers[0].relposnedMessages.keys())
+    {
+        Eigen::Vector3d points[3];
+
+        for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+        {
+            const UBXMessage_RELPOSNED& relposned = rovers[roverIndex].relposnedMessages[iTOW];
+            points[roverIndex] = Eigen::Vector3d(relposned.relPosN, relposned.relPosE, relposned.relPosD);
+        }
+
+        const PostProcessingForm::LOInterpolator::Pose& pose = poseTable[iTOW];
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+        QVERIFY(loSolver.setPoints(points));
+
+        if (iTOW == invalidITOW)
+        {
+            QVERIFY(!loSolver.getTransformMatrix(transform));
+            QCOMPARE(pose.status, PostProcessingForm::LOInterpolator::Pose::STATUS_ERROR_TRANSFORMMATRIX);
+            QCOMPARE(pose.errorCode, loSolver.getLastError());
+        }
+        else
+        {
+            QVERIFY(loSolver.getTransformMatrix(transform));
+            QCOMPARE(pose.status, PostProcessingForm::LOInterpolator::Pose::STATUS_VALID);
+
+            Eigen::Vector3d location = transform.translation();
+            Eigen::Quaterniond orientation(transform.linear());
+
+            QVERIFY(pose.location == location);
+            QVERIFY(pose.orientation.coeffs() == orientation.coeffs());
+        }
+    }
+
+    // Same reference points -> same table, no recalculation
+    QCOMPARE(&pipelineCache.getPoseTable(rovers, 3, loSolver), &poseTable);
+
+    // Interpolation using table only (form has no rover data)
+    PostProcessingForm postProcessingForm;
+    PostProcessingForm::LOInterpolator loInterpolator(&postProcessingForm);
+    loInterpolator.loSolver = loSolver;
+    loInterpolator.poseTable = &poseTable;
+
+    Eigen::Transform<double, 3, Eigen::Affine> transform;
+    loInterpolator.getInterpolatedLocationOrientationTransformMatrix_Uptime(RoverFixture::firstUptime + 10 * interval + interval / 2, clockModel, transform);
+    QVERIFY((transform.translation() - Eigen::Vector3d(1.05, 0, 0)).norm() < 1e-6);
+
+    // Error must be the same as when solving failed
+    QString errorThrown;
+
+    try
+    {
+        loInterpolator.getInterpolatedLocationOrientationTransformMatrix_Uptime(RoverFixture::firstUptime + 50 * interval + interval / 2, clockModel, transform);
+    }
+    catch (QString& error)
+    {
+        errorThrown = error;
+    }
+
+    QCOMPARE(errorThrown, "LOSolver.getTransformMatrix failed. Error code: " + QString::number(LOSolver::ERROR_INVALID_POINTS) + ".");
+
+    // Changing rover data invalidates everything
+    rovers[0].relposnedMessages.clear();
+    pipelineCache.invalidateRoverData();
+    QCOMPARE(pipelineCache.getPoseTable(rovers, 3, loSolver).count(), 0);
+}
+
+void PipelineCacheTest::test_PipelineCache_ProcessedRounds()
+{
+    QVector<QVector<RPLidarThread::DistanceItem>> rounds = createLidarRounds(50, 360);
+    QVERIFY(!rounds.isEmpty());
+
+    QMap<qint64, PostProcessingForm::LidarRound> lidarRounds;
+
+    for (int i = 0; i < rounds.count(); i++)
+    {
+        PostProcessingForm::LidarRound round;
+        round.startTime = RoverFixture::firstUptime + i * 100;
+        round.endTime = round.startTime + 100;
+        round.distanceItems = rounds[i];
+        lidarRounds[round.endTime] = round;
+    }
+
+    RPLidarPlausibilityFilter::Settings settings;
+    settings.qualityLimit_PreFiltering = 0.5;
+    settings.distanceLimit_Near = 0.5;
+
+    Eigen::Transform<double, 3, Eigen::Affine> transform_BeforeRotation;
+    transform_BeforeRotation.setIdentity();
+    transform_BeforeRotation.translate(Eigen::Vector3d(0.01, -0.02, 0.03));
+
+    Eigen::Transform<double, 3, Eigen::Affine> transform_AfterRotation;
+    transform_AfterRotation.setIdentity();
+    transform_AfterRotation.rotate(Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitX()));
+
+    Lidar::ProcessedRoundCache processedRoundCache;
+
+    auto verifyRounds = [&]()
+    {
+        RPLidarPlausibilityFilter filter(settings);
+        Lidar::PointTransformer pointTransformer(transform_BeforeRotation, transform_AfterRotation);
+        QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
+
+        for (auto iter = lidarRounds.begin(); iter != lidarRounds.end(); iter++)
+        {
+            const Lidar::ProcessedRoundCache::ProcessedRound& processedRound = processedRoundCache.getProcessedRound(iter.key(), iter.value());
+
+            filter.filter(iter.value().distanceItems, filteredItems);
+            pointTransformer.transformRound(filteredItems);
+
+            if (processedRound.filteredItems.count() != filteredItems.count())
+            {
+                return false;
+            }
+
+            for (int i = 0; i < filteredItems.count(); i++)
+            {
+                if (processedRound.filteredItems[i].type != filteredItems[i].type)
+                {
+                    return false;
+                }
+            }
+
+            if ((processedRound.laserOrigins != pointTransformer.getLaserOrigins()) ||
+                    (processedRound.laserHits != pointTransformer.getLaserHits()))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    processedRoundCache.setSettings(settings, transform_BeforeRotation, transform_AfterRotation);
+    QVERIFY(verifyRounds());
+    QCOMPARE(processedRoundCache.getMissCount(), lidarRounds.count());
+
+    // Second run uses cached rounds
+    QVERIFY(verifyRounds());
+    QCOMPARE(processedRoundCache.getHitCount(), lidarRounds.count());
+
+    // Transform changed -> filtered items still valid, but transformed again
+    transform_AfterRotation.translate(Eigen::Vector3d(0.2, 0.1, -0.5));
+    processedRoundCache.setSettings(settings, transform_BeforeRotation, transform_AfterRotation);
+    QVERIFY(verifyRounds());
+    QCOMPARE(processedRoundCache.getHitCount(), 2 * lidarRounds.count());
+
+    // Filtering settings changed -> everything filtered again
+    settings.relativeSlopeLimit = 0.5;
+    processedRoundCache.setSettings(settings, transform_BeforeRotation, transform_AfterRotation);
+    QVERIFY(verifyRounds());
+    QCOMPARE(processedRoundCache.getMissCount(), 2 * lidarRounds.count());
+
+    // Cache without room works as a plain filter/transformer
+    Lidar::ProcessedRoundCache uncached(0);
+    uncached.setSettings(settings, transform_BeforeRotation, transform_AfterRotation);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (auto iter = lidarRounds.begin(); iter != lidarRounds.end(); iter++)
+        {
+            uncached.getProcessedRound(iter.key(), iter.value());
+        }
+    }
+
+    QCOMPARE(uncached.getHitCount(), 0);
+}
+
+QTEST_MAIN(PipelineCacheTest)
+
+#include "tst_pipelinecache.moc"
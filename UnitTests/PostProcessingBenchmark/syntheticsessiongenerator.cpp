@@ -0,0 +1,421 @@
+/*
+    syntheticsessiongenerator.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file syntheticsessiongenerator.cpp
+ * @brief Definition for a class that generates deterministic, synthetic logging sessions for benchmarks.
+ */
+
+#include <QFile>
+#include <QTextStream>
+#include <QDataStream>
+#include <QSettings>
+#include <QTime>
+#include <QtMath>
+#include <string.h>
+
+#include "syntheticsessiongenerator.h"
+
+const Eigen::Vector3d SyntheticSessionGenerator::antennaLocations[3] =
+{
+    Eigen::Vector3d(0, -1, 0),
+    Eigen::Vector3d(0, 1, 0),
+    Eigen::Vector3d(1, 0, 0),
+};
+
+bool SyntheticSessionGenerator::generate(const Params& params)
+{
+    statistics = Statistics();
+
+    return writeRELPOSNEDAndSyncFiles(params) &&
+            writeTagAndDistanceFiles(params) &&
+            writeLidarFile(params) &&
+            writeParameterFile(params);
+}
+
+QByteArray SyntheticSessionGenerator::createRELPOSNEDMessage(const int iTOW, const Eigen::Vector3d& relPos)
+{
+#pragma pack(push, 1)
+    // Same layout as UBXDecoder::Layout_NAV_RELPOSNED
+    struct
+    {
+        unsigned char version;
+        unsigned char reserved1;
+        unsigned short refStationId;
+        unsigned int iTOW;
+        int relPosN;
+        int relPosE;
+        int relPosD;
+        int relPosLength;
+        int relPosHeading;
+        unsigned char reserved2[4];
+        signed char relPosHPN;
+        signed char relPosHPE;
+        signed char relPosHPD;
+        signed char relPosHPLength;
+        unsigned int accN;
+        unsigned int accE;
+        unsigned int accD;
+        unsigned int accLength;
+        unsigned int accHeading;
+        unsigned char reserved3[4];
+        unsigned int flags;
+    } payload;
+#pragma pack(pop)
+
+    static_assert(sizeof(payload) == 64, "RELPOSNED payload must be 64 bytes");
+
+    memset(&payload, 0, sizeof(payload));
+
+    payload.version = 1;
+    payload.iTOW = static_cast<unsigned int>(iTOW);
+
+    // Split values to cm + 0.1 mm parts
+    auto split = [](const double value, int& cm, signed char& hp)
+    {
+        qint64 tenthsOfMm = qRound64(value * 1e4);
+        cm = static_cast<int>(tenthsOfMm / 100);
+        hp = static_cast<signed char>(tenthsOfMm - static_cast<qint64>(cm) * 100);
+    };
+
+    split(relPos(0), payload.relPosN, payload.relPosHPN);
+    split(relPos(1), payload.relPosE, payload.relPosHPE);
+    split(relPos(2), payload.relPosD, payload.relPosHPD);
+    split(relPos.norm(), payload.relPosLength, payload.relPosHPLength);
+
+    double heading = qRadiansToDegrees(atan2(relPos(1), relPos(0)));
+    if (heading < 0)
+    {
+        heading += 360;
+    }
+    payload.relPosHeading = static_cast<int>(heading * 1e5);
+
+    payload.accN = 100;
+    payload.accE = 100;
+    payload.accD = 150;
+    payload.accLength = 100;
+    payload.accHeading = 1000;
+
+    // gnssFixOK, diffSoln, relPosValid, carrSoln = FIXED, relPosHeadingValid
+    payload.flags = (1 << 0) | (1 << 1) | (1 << 2) | (2 << 3) | (1 << 8);
+
+    QByteArray message;
+
+    message.append(static_cast<char>(0xB5));
+    message.append(static_cast<char>(0x62));
+    message.append(static_cast<char>(0x01));  // Class
+    message.append(static_cast<char>(0x3C));  // Id
+    message.append(static_cast<char>(sizeof(payload) & 0xFF));
+    message.append(static_cast<char>(sizeof(payload) >> 8));
+    message.append(reinterpret_cast<const char*>(&payload), sizeof(payload));
+
+    unsigned char checksumA = 0;
+    unsigned char checksumB = 0;
+
+    for (int i = 2; i < message.length(); i++)
+    {
+        checksumA += static_cast<unsigned char>(message[i]);
+        checksumB += checksumA;
+    }
+
+    message.append(static_cast<char>(checksumA));
+    message.append(static_cast<char>(checksumB));
+
+    return message;
+}
+
+void SyntheticSessionGenerator::getRigPose(const Params& params, const double time_s, Eigen::Vector3d& location, double& heading)
+{
+    double travelled = time_s * params.speed;
+
+    switch (params.motionPath)
+    {
+    case PATH_CIRCLE:
+    {
+        double angle = travelled / params.pathSize;
+        location = Eigen::Vector3d(params.pathSize * cos(angle), params.pathSize * sin(angle), -1);
+        heading = angle + M_PI / 2;
+        break;
+    }
+
+    case PATH_LAWNMOWER:
+    {
+        // Lines parallel to north-axis, 1 m apart
+        const double lineSpacing = 1;
+        double cycleLength = params.pathSize + lineSpacing;
+        int lineIndex = static_cast<int>(travelled / cycleLength);
+        double inCycle = travelled - lineIndex * cycleLength;
+        double lineStartE = lineIndex * lineSpacing;
+
+        if (inCycle < params.pathSize)
+        {
+            bool northward = (lineIndex % 2) == 0;
+            location = Eigen::Vector3d(northward ? inCycle : params.pathSize - inCycle, lineStartE, -1);
+            heading = northward ? 0 : M_PI;
+        }
+        else
+        {
+            location = Eigen::Vector3d((lineIndex % 2) == 0 ? params.pathSize : 0, lineStartE + (inCycle - params.pathSize), -1);
+            heading = M_PI / 2;
+        }
+        break;
+    }
+
+    case PATH_STATIC:
+    default:
+        location = Eigen::Vector3d(0, 0, -1);
+        heading = 0;
+        break;
+    }
+}
+
+bool SyntheticSessionGenerator::writeRELPOSNEDAndSyncFiles(const Params& params)
+{
+    static const char* const roverIdents[] = { "A", "B", "C" };
+
+    QFile roverFiles[3];
+
+    for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+    {
+        roverFiles[roverIndex].setFileName(params.baseFileName + "_Rover" + roverIdents[roverIndex] + "_RELPOSNED.ubx");
+
+        if (!roverFiles[roverIndex].open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+    }
+
+    QFile syncFile(params.baseFileName + ".sync");
+
+    if (!syncFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+
+    QTextStream syncStream(&syncFile);
+    syncStream << "Time\tSource\tType\tiTOW\tUptime(Start)\tFrame time\n";
+
+    randomGenerator.seed(params.seed);
+
+    int numOfMeasurements = params.duration_s * 1000 / params.measurementInterval_ms;
+
+    for (int measurementIndex = 0; measurementIndex < numOfMeasurements; measurementIndex++)
+    {
+        int iTOW = firstITOW + measurementIndex * params.measurementInterval_ms;
+        qint64 uptime = firstUptime + static_cast<qint64>(measurementIndex) * params.measurementInterval_ms;
+
+        Eigen::Vector3d rigLocation;
+        double heading;
+
+        getRigPose(params, measurementIndex * params.measurementInterval_ms / 1000., rigLocation, heading);
+
+        Eigen::Matrix3d rotation = Eigen::AngleAxisd(heading, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+        QString timeString = QTime(0, 0).addMSecs(static_cast<int>(uptime % 86400000)).toString("hh:mm:ss:zzz");
+
+        for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+        {
+            Eigen::Vector3d noise(randomGenerator.bounded(2.) - 1, randomGenerator.bounded(2.) - 1, randomGenerator.bounded(2.) - 1);
+            Eigen::Vector3d antennaLocation = rigLocation + rotation * antennaLocations[roverIndex] + noise * params.positionNoise;
+
+            QByteArray message = createRELPOSNEDMessage(iTOW, antennaLocation);
+
+            roverFiles[roverIndex].write(message);
+            statistics.numOfBytes += message.length();
+            statistics.numOfRELPOSNEDMessages++;
+
+            // Serial transfer latency varies a bit between rovers
+            qint64 roverUptime = uptime + 20 + roverIndex * 2 + randomGenerator.bounded(5);
+
+            syncStream << timeString << "\tRover " << roverIdents[roverIndex] << "\tRELPOSNED\t" <<
+                          QString::number(iTOW) << "\t" << QString::number(roverUptime) << "\t" << "8" << "\n";
+        }
+    }
+
+    syncStream.flush();
+    statistics.numOfBytes += syncFile.size();
+
+    return true;
+}
+
+bool SyntheticSessionGenerator::writeTagAndDistanceFiles(const Params& params)
+{
+    QFile tagFile(params.baseFileName + "_tags.tags");
+    QFile distanceFile(params.baseFileName + ".distances");
+
+    if (!tagFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ||
+            !distanceFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+
+    QTextStream tagStream(&tagFile);
+    QTextStream distanceStream(&distanceFile);
+
+    tagStream << "Time\tiTOW\tTag\tText\tUptime\n";
+    distanceStream << "Time\tDistance\tType\tUptime(Start)\tFrame time\n";
+
+    randomGenerator.seed(params.seed + 1);
+
+    auto writeTag = [&](const qint64 time_ms, const QString& ident, const QString& text)
+    {
+        int iTOW = firstITOW + static_cast<int>(time_ms - time_ms % params.measurementInterval_ms);
+        qint64 uptime = firstUptime + time_ms;
+
+        tagStream << QTime(0, 0).addMSecs(static_cast<int>(uptime % 86400000)).toString("hh:mm:ss:zzz") << "\t" <<
+                     QString::number(iTOW) << "\t" << ident << "\t" << text << "\t" << QString::number(uptime) << "\n";
+
+        statistics.numOfTags++;
+    };
+
+    int objectIndex = 0;
+    const qint64 sessionLength_ms = static_cast<qint64>(params.duration_s) * 1000;
+    const qint64 objectInterval_ms = static_cast<qint64>(params.objectInterval_s) * 1000;
+
+    for (qint64 objectStart_ms = 1000; objectStart_ms + objectInterval_ms <= sessionLength_ms; objectStart_ms += objectInterval_ms)
+    {
+        writeTag(objectStart_ms, "New object", "Object_" + QString::number(objectIndex++));
+
+        // Points evenly distributed over the object's time span, LMB and RMB 1/3 of "point interval" apart
+        qint64 pointInterval_ms = (objectInterval_ms - 2000) / params.pointsPerObject;
+
+        for (int pointIndex = 0; pointIndex < params.pointsPerObject; pointIndex++)
+        {
+            qint64 pointStart_ms = objectStart_ms + 1000 + pointIndex * pointInterval_ms;
+
+            writeTag(pointStart_ms, "LMB", "");
+            writeTag(pointStart_ms + pointInterval_ms / 3, "RMB", "");
+        }
+    }
+
+    // Distances from laser range finder at 20 Hz
+    for (qint64 time_ms = 0; time_ms < sessionLength_ms; time_ms += 50)
+    {
+        qint64 uptime = firstUptime + time_ms;
+        double distance = 1.5 + 0.1 * sin(time_ms / 10000.) + (randomGenerator.bounded(2.) - 1) * 0.002;
+
+        distanceStream << QTime(0, 0).addMSecs(static_cast<int>(uptime % 86400000)).toString("hh:mm:ss:zzz") << "\t" <<
+                          QString::number(distance, 'g', 4) << "\tmeasured\t" <<
+                          QString::number(uptime) << "\t" << "10" << "\n";
+
+        statistics.numOfDistances++;
+    }
+
+    tagStream.flush();
+    distanceStream.flush();
+    statistics.numOfBytes += tagFile.size() + distanceFile.size();
+
+    return true;
+}
+
+bool SyntheticSessionGenerator::writeLidarFile(const Params& params)
+{
+    QFile lidarFile(params.baseFileName + ".lidar");
+
+    if (!lidarFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    if (params.lidarRoundInterval_ms <= 0)
+    {
+        return true;
+    }
+
+    QDataStream dataStream(&lidarFile);
+    dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    randomGenerator.seed(params.seed + 2);
+
+    const qint64 sessionLength_ms = static_cast<qint64>(params.duration_s) * 1000;
+
+    for (qint64 time_ms = 0; time_ms + params.lidarRoundInterval_ms <= sessionLength_ms; time_ms += params.lidarRoundInterval_ms)
+    {
+        // Same chunk format as EssentialsForm uses
+        unsigned int dataType = 1;
+        unsigned int numOfItems = static_cast<unsigned int>(params.lidarItemsPerRound);
+        qint64 startTime = firstUptime + time_ms;
+        qint64 endTime = startTime + params.lidarRoundInterval_ms - 1;
+        unsigned int dataChunkLength = sizeof(numOfItems) + sizeof(startTime) + sizeof(endTime) + numOfItems * 3 * sizeof(float);
+
+        dataStream << dataType << dataChunkLength;
+        dataStream << numOfItems << startTime << endTime;
+
+        for (unsigned int i = 0; i < numOfItems; i++)
+        {
+            float angle = static_cast<float>(2 * M_PI * i / numOfItems);
+
+            // "Room" with walls 4 m away + noise, every 50th item is an outlier
+            float distance = static_cast<float>(4. / qMax(fabs(cos(angle)), fabs(sin(angle))) + (randomGenerator.bounded(2.) - 1) * 0.01);
+            float quality = 0.8f;
+
+            if ((i % 50) == 0)
+            {
+                distance *= 0.3f;
+                quality = 0.1f;
+            }
+
+            dataStream << distance << angle << quality;
+        }
+
+        statistics.numOfLidarRounds++;
+        statistics.numOfLidarItems += numOfItems;
+    }
+
+    statistics.numOfBytes += lidarFile.size();
+
+    return true;
+}
+
+bool SyntheticSessionGenerator::writeParameterFile(const Params& params)
+{
+    QString fileName = params.baseFileName + ".PPParameters";
+
+    QFile::remove(fileName);
+
+    QSettings settings(fileName, QSettings::IniFormat);
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            settings.setValue("PostProcessing_AntennaLocations_Row" + QString::number(row) + "_Column" + QString::number(column),
+                              QString::number(antennaLocations[row](column)));
+        }
+    }
+
+    int lastITOW = firstITOW + (params.duration_s * 1000 / params.measurementInterval_ms - 1) * params.measurementInterval_ms;
+
+    settings.setValue("PostProcessing_ExpectedITOWAlignment", params.measurementInterval_ms);
+    settings.setValue("PostProcessing_TagIndicatingBeginningOfNewObject", "New object");
+    settings.setValue("PostProcessing_TagIndicatingBeginningOfObjectPoints", "LMB");
+    settings.setValue("PostProcessing_TagIndicatingEndOfObjectPoints", "RMB");
+
+    settings.setValue("PostProcessing_Stylus_Movie_ITOW_Points_Min", firstITOW);
+    settings.setValue("PostProcessing_Stylus_Movie_ITOW_Points_Max", lastITOW);
+    settings.setValue("PostProcessing_Stylus_Movie_ITOW_Script_Min", firstITOW);
+    settings.setValue("PostProcessing_Stylus_Movie_ITOW_Script_Max", lastITOW);
+    settings.setValue("PostProcessing_LOSolver_Movie_ITOW_Script_Min", firstITOW);
+    settings.setValue("PostProcessing_LOSolver_Movie_ITOW_Script_Max", lastITOW);
+    settings.setValue("PostProcessing_Lidar_Script_Uptime_Min", QString::number(firstUptime));
+    settings.setValue("PostProcessing_Lidar_Script_Uptime_Max", QString::number(firstUptime + static_cast<qint64>(params.duration_s) * 1000));
+
+    settings.sync();
+
+    return settings.status() == QSettings::NoError;
+}
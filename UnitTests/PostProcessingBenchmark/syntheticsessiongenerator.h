@@ -0,0 +1,101 @@
+/*
+    syntheticsessiongenerator.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file syntheticsessiongenerator.h
+ * @brief Declaration for a class that generates deterministic, synthetic logging sessions for benchmarks.
+ */
+
+#ifndef SYNTHETICSESSIONGENERATOR_H
+#define SYNTHETICSESSIONGENERATOR_H
+
+#include <QString>
+#include <QByteArray>
+#include <QRandomGenerator>
+
+#include "Eigen/Geometry"
+
+/**
+ * @brief Generates log files of a synthetic logging session in the same formats EssentialsForm writes them.
+ *
+ * Files generated (base file name + suffix):
+ * _RoverA_RELPOSNED.ubx, _RoverB_RELPOSNED.ubx, _RoverC_RELPOSNED.ubx, .sync, _tags.tags, .distances, .lidar and .PPParameters.
+ *
+ * Stylus/lidar rig has antennas in the same (body frame, NED) locations as PostProcessingForm's defaults
+ * (A = 0,-1,0; B = 0,1,0; C = 1,0,0) and is moved along the selected path, always heading along the path.
+ * All "noise" is generated using a seeded QRandomGenerator so output is identical for the same Params.
+ */
+class SyntheticSessionGenerator
+{
+public:
+    enum MotionPath
+    {
+        PATH_STATIC = 0,        //!< Rig doesn't move (only noise)
+        PATH_CIRCLE,            //!< Circle around origin
+        PATH_LAWNMOWER,         //!< Back and forth lines ("lawnmower" pattern)
+    };
+
+    class Params
+    {
+    public:
+        QString baseFileName;               //!< Path + beginning of file names
+        int duration_s = 600;               //!< Duration of the session
+        int measurementInterval_ms = 125;   //!< Interval of RELPOSNED-messages (125 ms = 8 Hz)
+        MotionPath motionPath = PATH_CIRCLE;
+        double pathSize = 10;               //!< Radius of the circle / length of lawnmower lines (m)
+        double speed = 0.5;                 //!< Speed along the path (m/s)
+        double positionNoise = 0.005;       //!< Max. noise added to antenna positions (m)
+        int objectInterval_s = 60;          //!< Interval of "New object"-tags
+        int pointsPerObject = 20;           //!< Number of LMB/RMB-tag pairs per object
+        int lidarRoundInterval_ms = 100;    //!< Interval of lidar rounds (0 = no lidar data)
+        int lidarItemsPerRound = 360;       //!< Number of distance items per lidar round
+        quint32 seed = 1;                   //!< Seed for random generator
+    };
+
+    class Statistics
+    {
+    public:
+        qint64 numOfRELPOSNEDMessages = 0;  //!< Total for all rovers
+        qint64 numOfTags = 0;
+        qint64 numOfDistances = 0;
+        qint64 numOfLidarRounds = 0;
+        qint64 numOfLidarItems = 0;
+        qint64 numOfBytes = 0;              //!< Total size of generated files
+    };
+
+    static const int firstITOW = 100000000;         //!< iTOW of the first measurement
+    static const qint64 firstUptime = 1000000;      //!< Uptime of the first measurement
+
+    bool generate(const Params& params);                            //!< Generates all files. Returns false if some file can't be written.
+    const Statistics& getStatistics(void) const { return statistics; }
+
+    static QByteArray createRELPOSNEDMessage(const int iTOW, const Eigen::Vector3d& relPos);      //!< Creates UBX-RELPOSNED-frame (with checksum)
+    static void getRigPose(const Params& params, const double time_s, Eigen::Vector3d& location, double& heading);  //!< Location (NED) and heading (radians) of the rig at given time
+    static const Eigen::Vector3d antennaLocations[3];               //!< Antenna locations in rig's body frame (NED)
+
+private:
+    QRandomGenerator randomGenerator;
+    Statistics statistics;
+
+    bool writeRELPOSNEDAndSyncFiles(const Params& params);
+    bool writeTagAndDistanceFiles(const Params& params);
+    bool writeLidarFile(const Params& params);
+    bool writeParameterFile(const Params& params);
+};
+
+#endif // SYNTHETICSESSIONGENERATOR_H
@@ -0,0 +1,907 @@
+/*
+    tst_postprocessingbenchmark.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+#include <QTemporaryDir>
+
+// Benchmarks for post-processing using a synthetic session (see SyntheticSessionGenerator).
+// Length and motion path of the session can be changed using environment variables:
+// GNSSSTYLUS_BENCHMARK_DURATION (seconds, default 600) and
+// GNSSSTYLUS_BENCHMARK_PATH ("circle" (default), "lawnmower" or "static").
+// Throughput and peak memory (resident set size) are reported as qInfo-lines.
+// Unit tests not needing the synthetic session belong to their own targets (see UnitTests-directory).
+
+#if defined(Q_OS_LINUX)
+#include <QFile>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "syntheticsessiongenerator.h"
+#include "../Common/roverfixture.h"
+#include "../../ubloxdatastreamprocessor.h"
+#include "../../losolver.h"
+#include "../../Lidar/rplidarplausibilityfilter.h"
+#include "../../PostProcessing/postprocessingform.h"
+#include "../../PostProcessing/Lidar/lidarpointtransformer.h"
+#include "../../PostProcessing/clockmodel.h"
+#include "../../ubxdecoder.h"
+
+class PostProcessingBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    PostProcessingBenchmark();
+    ~PostProcessingBenchmark();
+
+private:
+    QTemporaryDir tempDir;
+    SyntheticSessionGenerator::Params sessionParams;
+    SyntheticSessionGenerator::Statistics sessionStatistics;
+
+    static qint64 getPeakRSS(void);
+    static void reportThroughput(const QString& what, const qint64 items, const QString& unit, const qint64 elapsed_ns);
+    QVector<QVector<RPLidarThread::DistanceItem>> readLidarRounds(void);
+    QVector<UBXMessage> readRELPOSNEDMessages(void);
+    static UBXMessage createUBXMessage(const unsigned char messageClass, const unsigned char messageId, const QByteArray& payload);
+    static UBXMessage_RELPOSNED decodeRELPOSNED_HandWritten(const UBXMessage& ubxMessage);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmark_UBloxDataStreamProcessor();
+    void benchmark_RPLidarPlausibilityFilter();
+    void benchmark_LidarPointTransformer();
+    void benchmark_LOSolver();
+    void benchmark_ClockModelFit();
+    void benchmark_LoadSession();
+    void benchmark_LOInterpolator();
+    void test_LOInterpolatorDeviationLimits();
+    void benchmark_Generators_data();
+    void benchmark_Generators();
+    void benchmark_AddLogLine();
+    void test_UBXDecoder();
+    void benchmark_DecodeRELPOSNED_data();
+    void benchmark_DecodeRELPOSNED();
+};
+
+PostProcessingBenchmark::PostProcessingBenchmark()
+{
+
+}
+
+PostProcessingBenchmark::~PostProcessingBenchmark()
+{
+
+}
+
+qint64 PostProcessingBenchmark::getPeakRSS(void)
+{
+#if defined(Q_OS_LINUX)
+    QFile statusFile("/proc/self/status");
+
+    if (statusFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream textStream(&statusFile);
+        QString line;
+
+        while (textStream.readLineInto(&line))
+        {
+            if (line.startsWith("VmHWM:"))
+            {
+                // "VmHWM:     12345 kB"
+                return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+            }
+        }
+    }
+    return -1;
+#elif defined(Q_OS_MACOS)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;     // bytes on macOS
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#else
+    return -1;
+#endif
+}
+
+void PostProcessingBenchmark::reportThroughput(const QString& what, const qint64 items, const QString& unit, const qint64 elapsed_ns)
+{
+    double seconds = elapsed_ns / 1e9;
+
+    qInfo("%s: %lld %s in %.3f s -> %.0f %s/s, peak RSS %.1f MB",
+          qPrintable(what), items, qPrintable(unit), seconds,
+          (seconds > 0) ? items / seconds : 0., qPrintable(unit),
+          getPeakRSS() / (1024. * 1024.));
+}
+
+QVector<QVector<RPLidarThread::DistanceItem>> PostProcessingBenchmark::readLidarRounds(void)
+{
+    QVector<QVector<RPLidarThread::DistanceItem>> rounds;
+
+    QFile lidarFile(sessionParams.baseFileName + ".lidar");
+
+    if (!lidarFile.open(QIODevice::ReadOnly))
+    {
+        return rounds;
+    }
+
+    QDataStream dataStream(&lidarFile);
+    dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    while (!dataStream.atEnd())
+    {
+        unsigned int dataType;
+        unsigned int dataChunkLength;
+        unsigned int numOfItems;
+        qint64 startTime;
+        qint64 endTime;
+
+        dataStream >> dataType >> dataChunkLength >> numOfItems >> startTime >> endTime;
+
+        QVector<RPLidarThread::DistanceItem> round(static_cast<int>(numOfItems));
+
+        for (unsigned int i = 0; i < numOfItems; i++)
+        {
+            dataStream >> round[static_cast<int>(i)].distance >> round[static_cast<int>(i)].angle >> round[static_cast<int>(i)].quality;
+        }
+
+        rounds.append(round);
+    }
+
+    return rounds;
+}
+
+void PostProcessingBenchmark::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+
+    sessionParams.baseFileName = tempDir.filePath("synthetic");
+    sessionParams.duration_s = qEnvironmentVariableIntValue("GNSSSTYLUS_BENCHMARK_DURATION");
+
+    if (sessionParams.duration_s <= 0)
+    {
+        sessionParams.duration_s = 600;
+    }
+
+    QString path = qEnvironmentVariable("GNSSSTYLUS_BENCHMARK_PATH", "circle");
+
+    if (path == "lawnmower")
+    {
+        sessionParams.motionPath = SyntheticSessionGenerator::PATH_LAWNMOWER;
+    }
+    else if (path == "static")
+    {
+        sessionParams.motionPath = SyntheticSessionGenerator::PATH_STATIC;
+    }
+    else
+    {
+        sessionParams.motionPath = SyntheticSessionGenerator::PATH_CIRCLE;
+    }
+
+    SyntheticSessionGenerator generator;
+    QElapsedTimer timer;
+    timer.start();
+
+    QVERIFY(generator.generate(sessionParams));
+
+    sessionStatistics = generator.getStatistics();
+
+    qInfo("Synthetic session: %d s, %lld RELPOSNED-messages, %lld tags, %lld distances, %lld lidar rounds (%lld items), %.1f MB",
+          sessionParams.duration_s, sessionStatistics.numOfRELPOSNEDMessages, sessionStatistics.numOfTags,
+          sessionStatistics.numOfDistances, sessionStatistics.numOfLidarRounds, sessionStatistics.numOfLidarItems,
+          sessionStatistics.numOfBytes / (1024. * 1024.));
+
+    reportThroughput("Session generation", sessionStatistics.numOfBytes, "bytes", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::cleanupTestCase()
+{
+
+}
+
+void PostProcessingBenchmark::benchmark_UBloxDataStreamProcessor()
+{
+    QFile ubxFile(sessionParams.baseFileName + "_RoverA_RELPOSNED.ubx");
+    QVERIFY(ubxFile.open(QIODevice::ReadOnly));
+    QByteArray ubxData = ubxFile.readAll();
+
+    qint64 numOfMessages = 0;
+    qint64 numOfBytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        UBloxDataStreamProcessor processor;
+
+        connect(&processor, &UBloxDataStreamProcessor::ubxMessageReceived,
+                this, [&](const UBXMessage&)
+                {
+                    numOfMessages++;
+                });
+
+        // Byte-by-byte, same way as PostProcessingForm reads the files
+        for (int i = 0; i < ubxData.length(); i++)
+        {
+            processor.process(ubxData[i], 0);
+        }
+
+        numOfBytes += ubxData.length();
+    }
+
+    reportThroughput("UBloxDataStreamProcessor", numOfBytes, "bytes", timer.nsecsElapsed());
+    reportThroughput("UBloxDataStreamProcessor", numOfMessages, "messages", timer.nsecsElapsed());
+
+    QVERIFY(numOfMessages > 0);
+}
+
+void PostProcessingBenchmark::benchmark_RPLidarPlausibilityFilter()
+{
+    QVector<QVector<RPLidarThread::DistanceItem>> rounds = readLidarRounds();
+    QCOMPARE(rounds.count(), static_cast<int>(sessionStatistics.numOfLidarRounds));
+
+    RPLidarPlausibilityFilter filter;
+    RPLidarPlausibilityFilter::Settings settings;
+    settings.qualityLimit_PreFiltering = 0.5;
+    settings.distanceLimit_Near = 0.5;
+    settings.relativeSlopeLimit = 0.5;
+    filter.setSettings(settings);
+
+    QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
+    qint64 numOfItems = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        for (const auto& round : rounds)
+        {
+            filter.filter(round, filteredItems);
+            numOfItems += round.count();
+        }
+    }
+
+    reportThroughput("RPLidarPlausibilityFilter", numOfItems, "items", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::benchmark_LidarPointTransformer()
+{
+    QVector<QVector<RPLidarThread::DistanceItem>> rounds = readLidarRounds();
+    QVERIFY(!rounds.isEmpty());
+
+    Eigen::Transform<double, 3, Eigen::Affine> transform_BeforeRotation;
+    transform_BeforeRotation.setIdentity();
+    transform_BeforeRotation.translate(Eigen::Vector3d(0.01, -0.02, 0.03));
+    transform_BeforeRotation.rotate(Eigen::AngleAxisd(0.1, Eigen::Vector3d::UnitY()));
+
+    Eigen::Transform<double, 3, Eigen::Affine> transform_AfterRotation;
+    transform_AfterRotation.setIdentity();
+    transform_AfterRotation.translate(Eigen::Vector3d(0.2, 0.1, -0.5));
+    transform_AfterRotation.rotate(Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitX()));
+
+    Lidar::PointTransformer pointTransformer(transform_BeforeRotation, transform_AfterRotation);
+
+    QVector<RPLidarPlausibilityFilter::FilteredItem> filteredItems;
+    RPLidarPlausibilityFilter filter;
+    filter.setSettings(RPLidarPlausibilityFilter::Settings());
+
+    // Table angles (as converted by RPLidarThread) must give identical results to direct calculation
+    for (int q14 = 0; q14 < 65536; q14 += 997)
+    {
+        float angle = 2 * M_PI * q14 / 65536.;
+        double sinValue, cosValue;
+        Lidar::PointTransformer::getSinCos(angle, sinValue, cosValue);
+        QCOMPARE(sinValue, sin(double(angle)));
+        QCOMPARE(cosValue, cos(double(angle)));
+    }
+
+    // Results must match the original (unfactored) transform chain
+    for (const auto& round : rounds)
+    {
+        filter.filter(round, filteredItems);
+        pointTransformer.transformRound(filteredItems);
+
+        for (int i = 0; i < filteredItems.count(); i++)
+        {
+            const RPLidarThread::DistanceItem& item = filteredItems[i].item;
+
+            Eigen::Transform<double, 3, Eigen::Affine> transform_LaserRotation;
+            transform_LaserRotation = Eigen::AngleAxisd(item.angle, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+            Eigen::Vector3d origin = transform_AfterRotation * (transform_LaserRotation * (transform_BeforeRotation * Eigen::Vector3d::Zero()));
+            Eigen::Vector3d hit = transform_AfterRotation * (transform_LaserRotation * (transform_BeforeRotation * (item.distance * Eigen::Vector3d::UnitX())));
+
+            QVERIFY((origin - pointTransformer.getLaserOrigins().col(i)).norm() < 1e-9);
+            QVERIFY((hit - pointTransformer.getLaserHits().col(i)).norm() < 1e-9);
+        }
+    }
+
+    qint64 numOfItems = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        for (const auto& round : rounds)
+        {
+            filter.filter(round, filteredItems);
+            pointTransformer.transformRound(filteredItems);
+            numOfItems += round.count();
+        }
+    }
+
+    reportThroughput("LidarPointTransformer", numOfItems, "items", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::benchmark_LOSolver()
+{
+    LOSolver loSolver;
+    QVERIFY(loSolver.setReferencePoints(SyntheticSessionGenerator::antennaLocations));
+
+    int numOfMeasurements = sessionParams.duration_s * 1000 / sessionParams.measurementInterval_ms;
+
+    QVector<Eigen::Vector3d> points;
+    points.reserve(numOfMeasurements * 3);
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        Eigen::Vector3d location;
+        double heading;
+        SyntheticSessionGenerator::getRigPose(sessionParams, i * sessionParams.measurementInterval_ms / 1000., location, heading);
+
+        Eigen::Matrix3d rotation = Eigen::AngleAxisd(heading, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+        for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+        {
+            points.append(location + rotation * SyntheticSessionGenerator::antennaLocations[roverIndex]);
+        }
+    }
+
+    qint64 numOfSolved = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+        for (int i = 0; i < numOfMeasurements; i++)
+        {
+            if (loSolver.setPoints(&points[i * 3]) && loSolver.getTransformMatrix(transform))
+            {
+                numOfSolved++;
+            }
+        }
+    }
+
+    reportThroughput("LOSolver", numOfSolved, "solutions", timer.nsecsElapsed());
+
+    QVERIFY(numOfSolved > 0);
+}
+
+void PostProcessingBenchmark::benchmark_ClockModelFit()
+{
+    PostProcessingForm::Rover rovers[3];
+
+    int numOfMeasurements = sessionParams.duration_s * 1000 / sessionParams.measurementInterval_ms;
+
+    for (unsigned int roverIndex = 0; roverIndex < 3; roverIndex++)
+    {
+        RoverFixture::fillRoverSyncData(rovers[roverIndex], numOfMeasurements, sessionParams.measurementInterval_ms,
+                                        [roverIndex](const int, UBXMessage_RELPOSNED::ITOW&, qint64& uptime)
+        {
+            uptime += 20 + roverIndex * 2;
+            return true;
+        });
+    }
+
+    ClockModel clockModel;
+    qint64 numOfItems = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        clockModel.fit(rovers, 3);
+        numOfItems += numOfMeasurements;
+    }
+
+    reportThroughput("ClockModel::fit", numOfItems, "iTOWs", timer.nsecsElapsed());
+
+    QCOMPARE(clockModel.getSegments().count(), 1);
+    QCOMPARE(clockModel.getNumOfPoints(), numOfMeasurements);
+
+    // Conversions (binary search over segments)
+    numOfItems = 0;
+    timer.restart();
+    double checkSum = 0;
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < numOfMeasurements; i++)
+        {
+            checkSum += clockModel.getITOW(RoverFixture::firstUptime + i * sessionParams.measurementInterval_ms + 22);
+        }
+
+        numOfItems += numOfMeasurements;
+    }
+
+    reportThroughput("ClockModel::getITOW", numOfItems, "conversions", timer.nsecsElapsed());
+
+    QVERIFY(checkSum != 0);
+}
+
+void PostProcessingBenchmark::benchmark_LoadSession()
+{
+    qint64 numOfBytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        PostProcessingForm postProcessingForm;
+
+        // No outputs -> only reads files
+        QCOMPARE(postProcessingForm.runBatch(sessionParams.baseFileName + ".PPParameters", sessionParams.baseFileName,
+                                             QStringList(), QDir(tempDir.filePath("output"))), 0);
+
+        numOfBytes += sessionStatistics.numOfBytes;
+    }
+
+    reportThroughput("Loading session", numOfBytes, "bytes", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::benchmark_LOInterpolator()
+{
+    PostProcessingForm postProcessingForm;
+
+    QCOMPARE(postProcessingForm.runBatch(sessionParams.baseFileName + ".PPParameters", sessionParams.baseFileName,
+                                         QStringList(), QDir(tempDir.filePath("output"))), 0);
+
+    PostProcessingForm::LOInterpolator loInterpolator(&postProcessingForm);
+    QVERIFY(loInterpolator.loSolver.setReferencePoints(SyntheticSessionGenerator::antennaLocations));
+
+    int numOfMeasurements = sessionParams.duration_s * 1000 / sessionParams.measurementInterval_ms;
+    qint64 numOfInterpolations = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        Eigen::Transform<double, 3, Eigen::Affine> transform;
+
+        // 4 interpolated values between every measurement
+        for (int i = 0; i < (numOfMeasurements - 1) * 4; i++)
+        {
+            UBXMessage_RELPOSNED::ITOW iTOW = SyntheticSessionGenerator::firstITOW + i * sessionParams.measurementInterval_ms / 4;
+
+            try
+            {
+                loInterpolator.getInterpolatedLocationOrientationTransformMatrix_ITOW(iTOW, transform);
+                numOfInterpolations++;
+            }
+            catch (QString& error)
+            {
+                QFAIL(qPrintable(error));
+            }
+        }
+    }
+
+    reportThroughput("LOInterpolator", numOfInterpolations, "interpolations", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::test_LOInterpolatorDeviationLimits()
+{
+    if (sessionParams.duration_s < 10)
+    {
+        QSKIP("Session too short for this test.");
+    }
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    PostProcessingForm postProcessingForm;
+    QCOMPARE(postProcessingForm.runBatch(sessionParams.baseFileName + ".PPParameters", sessionParams.baseFileName,
+                                         QStringList(), QDir(tempDir.filePath("output"))), 0);
+
+    PostProcessingForm::LOInterpolator loInterpolator(&postProcessingForm);
+    QVERIFY(loInterpolator.loSolver.setReferencePoints(SyntheticSessionGenerator::antennaLocations));
+
+    // Only mapping between uptimes and ITOWs matters here, not the exact uptimes
+    QVector<ClockModel::SyncPoint> syncPoints;
+    int numOfMeasurements = sessionParams.duration_s * 1000 / sessionParams.measurementInterval_ms;
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        ClockModel::SyncPoint point;
+        point.uptime = SyntheticSessionGenerator::firstUptime + i * sessionParams.measurementInterval_ms;
+        point.iTOW = SyntheticSessionGenerator::firstITOW + i * sessionParams.measurementInterval_ms;
+        syncPoints.append(point);
+    }
+
+    ClockModel clockModel;
+    clockModel.fit(syncPoints);
+
+    // Ranges of ~one lidar round with different alignments to sync points
+    for (int rangeIndex = 0; rangeIndex < 50; rangeIndex++)
+    {
+        qint64 uptimeStart = SyntheticSessionGenerator::firstUptime + 1000 + rangeIndex * 137;
+        qint64 uptimeEnd = uptimeStart + 150;
+
+        Eigen::Transform<double, 3, Eigen::Affine> referenceTransform;
+        double maxTranslationDeviation, maxRotationDeviation;
+
+        QVERIFY(loInterpolator.getLocationOrientationDeviationLimits_Uptime(uptimeStart, uptimeEnd, clockModel,
+                                                                           referenceTransform, maxTranslationDeviation, maxRotationDeviation));
+
+        for (qint64 uptime = uptimeStart; uptime <= uptimeEnd; uptime++)
+        {
+            Eigen::Transform<double, 3, Eigen::Affine> transform;
+            loInterpolator.getInterpolatedLocationOrientationTransformMatrix_Uptime(uptime, clockModel, transform);
+
+            QVERIFY((transform.translation() - referenceTransform.translation()).norm() <= maxTranslationDeviation + 1e-9);
+            QVERIFY(Eigen::Quaterniond(transform.linear()).angularDistance(Eigen::Quaterniond(referenceTransform.linear())) <= maxRotationDeviation + 1e-9);
+        }
+    }
+
+    // Range outside sync data -> limits not valid
+    Eigen::Transform<double, 3, Eigen::Affine> referenceTransform;
+    double maxTranslationDeviation, maxRotationDeviation;
+
+    QVERIFY(!loInterpolator.getLocationOrientationDeviationLimits_Uptime(SyntheticSessionGenerator::firstUptime - 1000, SyntheticSessionGenerator::firstUptime + 100, clockModel,
+                                                                        referenceTransform, maxTranslationDeviation, maxRotationDeviation));
+}
+
+void PostProcessingBenchmark::benchmark_Generators_data()
+{
+    QTest::addColumn<QString>("output");
+
+    for (const QString& output : PostProcessingForm::batchOutputNames)
+    {
+        QTest::newRow(qPrintable(output)) << output;
+    }
+}
+
+void PostProcessingBenchmark::benchmark_Generators()
+{
+    QFETCH(QString, output);
+
+    if (output == "raster-cameras")
+    {
+        QSKIP("Raster camera generation needs reference images which the synthetic session doesn't have.");
+    }
+
+    qint64 numOfBytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        PostProcessingForm postProcessingForm;
+
+        QCOMPARE(postProcessingForm.runBatch(sessionParams.baseFileName + ".PPParameters", sessionParams.baseFileName,
+                                             QStringList(output), QDir(tempDir.filePath("output"))), 0);
+
+        numOfBytes += sessionStatistics.numOfBytes;
+    }
+
+    // Includes loading of the session (see benchmark_LoadSession)
+    reportThroughput("Loading + " + output, numOfBytes, "bytes", timer.nsecsElapsed());
+}
+
+void PostProcessingBenchmark::benchmark_AddLogLine()
+{
+    // Generators may log a warning for every problematic item
+    const int numOfLines = 100000;
+
+    PostProcessingForm postProcessingForm;
+
+    qint64 linesAdded = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < numOfLines; i++)
+        {
+            postProcessingForm.addLogLine("Warning: Benchmark line " + QString::number(i));
+        }
+
+        linesAdded += numOfLines;
+    }
+
+    reportThroughput("PostProcessingForm::addLogLine", linesAdded, "lines", timer.nsecsElapsed());
+}
+
+QVector<UBXMessage> PostProcessingBenchmark::readRELPOSNEDMessages(void)
+{
+    QVector<UBXMessage> messages;
+
+    QFile ubxFile(sessionParams.baseFileName + "_RoverA_RELPOSNED.ubx");
+    if (!ubxFile.open(QIODevice::ReadOnly))
+    {
+        return messages;
+    }
+
+    UBloxDataStreamProcessor processor;
+
+    connect(&processor, &UBloxDataStreamProcessor::ubxMessageReceived,
+            this, [&](const UBXMessage& message)
+            {
+                messages.append(message);
+            });
+
+    processor.process(ubxFile.readAll(), 0, 0);
+
+    return messages;
+}
+
+UBXMessage PostProcessingBenchmark::createUBXMessage(const unsigned char messageClass, const unsigned char messageId, const QByteArray& payload)
+{
+    QByteArray frame;
+
+    frame.append(static_cast<char>(0xB5));
+    frame.append(static_cast<char>(0x62));
+    frame.append(static_cast<char>(messageClass));
+    frame.append(static_cast<char>(messageId));
+    frame.append(static_cast<char>(payload.length() & 0xFF));
+    frame.append(static_cast<char>(payload.length() >> 8));
+    frame.append(payload);
+
+    unsigned char ck_a = 0;
+    unsigned char ck_b = 0;
+
+    for (int i = 2; i < frame.length(); i++)
+    {
+        ck_a += static_cast<unsigned char>(frame.at(i));
+        ck_b += ck_a;
+    }
+
+    frame.append(static_cast<char>(ck_a));
+    frame.append(static_cast<char>(ck_b));
+
+    return UBXMessage(frame);
+}
+
+UBXMessage_RELPOSNED PostProcessingBenchmark::decodeRELPOSNED_HandWritten(const UBXMessage& ubxMessage)
+{
+    // Hand-written decoding used before UBXDecoder (kept as a reference for correctness and speed)
+
+#pragma pack(push, 1)
+    typedef struct
+    {
+        unsigned char version;
+        unsigned char reserved1;
+        unsigned short refStationId;
+        unsigned int iTOW;
+        int relPosN;
+        int relPosE;
+        int relPosD;
+        int relPosLength;
+        int relPosHeading;
+        unsigned char reserved2[4];
+        signed char relPosHPN;
+        signed char relPosHPE;
+        signed char relPosHPD;
+        signed char relPosHPLength;
+        unsigned int accN;
+        unsigned int accE;
+        unsigned int accD;
+        unsigned int accLength;
+        unsigned int accHeading;
+        unsigned char reserved3[4];
+        unsigned int flags;
+    } UBXRawData_RELPOSNED;
+#pragma pack(pop)
+
+    UBXMessage_RELPOSNED retval;
+
+    const UBXRawData_RELPOSNED* rawRELPOSNED = reinterpret_cast<const UBXRawData_RELPOSNED*>(&ubxMessage.rawMessage.constData()[6]);
+
+    retval.version = rawRELPOSNED->version;
+    retval.refStationId = rawRELPOSNED->refStationId;
+    retval.iTOW = static_cast<UBXMessage_RELPOSNED::ITOW>(rawRELPOSNED->iTOW);
+
+    retval.relPosN = rawRELPOSNED->relPosN / 100. + rawRELPOSNED->relPosHPN / 10e3;
+    retval.relPosE = rawRELPOSNED->relPosE / 100. + rawRELPOSNED->relPosHPE / 10e3;
+    retval.relPosD = rawRELPOSNED->relPosD / 100. + rawRELPOSNED->relPosHPD / 10e3;
+
+    retval.relPosLength = rawRELPOSNED->relPosLength / 100. + rawRELPOSNED->relPosHPLength / 10e3;
+    retval.relPosHeading = rawRELPOSNED->relPosHeading / 1e5;
+
+    retval.accN = rawRELPOSNED->accN / 10e3;
+    retval.accE = rawRELPOSNED->accE / 10e3;
+    retval.accD = rawRELPOSNED->accD / 10e3;
+
+    retval.accLength = rawRELPOSNED->accLength / 10e3;
+    retval.accHeading = rawRELPOSNED->accHeading / 1e5;
+    retval.flags = rawRELPOSNED->flags;
+
+    retval.flag_gnssFixOK = retval.flags & (1 << 0);
+    retval.flag_diffSoln = retval.flags & (1 << 1);
+    retval.flag_relPosValid = retval.flags & (1 << 2);
+    retval.flag_carrSoln = static_cast<UBXMessage_RELPOSNED::UBXRawData_RELPOSNED_CarrierPhaseSolutionStatus>((retval.flags >> 3) & 3);
+    retval.flag_isMoving = retval.flags & (1 << 5);
+    retval.flag_refPosMiss = retval.flags & (1 << 6);
+    retval.flag_refObsMiss = retval.flags & (1 << 7);
+    retval.flag_relPosHeadingValid = retval.flags & (1 << 8);
+
+    return retval;
+}
+
+void PostProcessingBenchmark::test_UBXDecoder()
+{
+    // RELPOSNED: results must be identical to the hand-written decoding
+
+    QVector<UBXMessage> messages = readRELPOSNEDMessages();
+    QVERIFY(!messages.isEmpty());
+
+    for (const UBXMessage& message : messages)
+    {
+        UBXMessage_RELPOSNED decoded(message);
+        UBXMessage_RELPOSNED reference = decodeRELPOSNED_HandWritten(message);
+
+        QCOMPARE(decoded.messageDataStatus, UBXMessage::STATUS_VALID);
+        QCOMPARE(decoded.version, reference.version);
+        QCOMPARE(decoded.refStationId, reference.refStationId);
+        QCOMPARE(decoded.iTOW, reference.iTOW);
+        QVERIFY(decoded.relPosN == reference.relPosN);
+        QVERIFY(decoded.relPosE == reference.relPosE);
+        QVERIFY(decoded.relPosD == reference.relPosD);
+        QVERIFY(decoded.relPosLength == reference.relPosLength);
+        QVERIFY(decoded.relPosHeading == reference.relPosHeading);
+        QVERIFY(decoded.accN == reference.accN);
+        QVERIFY(decoded.accE == reference.accE);
+        QVERIFY(decoded.accD == reference.accD);
+        QVERIFY(decoded.accLength == reference.accLength);
+        QVERIFY(decoded.accHeading == reference.accHeading);
+        QCOMPARE(decoded.flags, reference.flags);
+        QCOMPARE(decoded.flag_gnssFixOK, reference.flag_gnssFixOK);
+        QCOMPARE(decoded.flag_diffSoln, reference.flag_diffSoln);
+        QCOMPARE(decoded.flag_relPosValid, reference.flag_relPosValid);
+        QCOMPARE(decoded.flag_carrSoln, reference.flag_carrSoln);
+        QCOMPARE(decoded.flag_isMoving, reference.flag_isMoving);
+        QCOMPARE(decoded.flag_refPosMiss, reference.flag_refPosMiss);
+        QCOMPARE(decoded.flag_refObsMiss, reference.flag_refObsMiss);
+        QCOMPARE(decoded.flag_relPosHeadingValid, reference.flag_relPosHeadingValid);
+    }
+
+    auto putValue = [](QByteArray& payload, const int offset, const auto value)
+    {
+        memcpy(payload.data() + offset, &value, sizeof(value));
+    };
+
+    // NAV-PVT
+
+    QByteArray pvtPayload(92, 0);
+    putValue(pvtPayload, 0, static_cast<unsigned int>(123456789));
+    putValue(pvtPayload, 4, static_cast<unsigned short>(2021));
+    putValue(pvtPayload, 6, static_cast<unsigned char>(6));
+    putValue(pvtPayload, 10, static_cast<unsigned char>(59));
+    putValue(pvtPayload, 20, static_cast<unsigned char>(3));
+    putValue(pvtPayload, 21, static_cast<unsigned char>((1 << 0) | (1 << 1) | (2 << 6)));
+    putValue(pvtPayload, 23, static_cast<unsigned char>(31));
+    putValue(pvtPayload, 24, static_cast<int>(254567890));
+    putValue(pvtPayload, 28, static_cast<int>(-604567890));
+    putValue(pvtPayload, 32, static_cast<int>(123456));
+    putValue(pvtPayload, 40, static_cast<unsigned int>(14));
+    putValue(pvtPayload, 56, static_cast<int>(-250));
+    putValue(pvtPayload, 64, static_cast<int>(18000000));
+    putValue(pvtPayload, 76, static_cast<unsigned short>(123));
+    putValue(pvtPayload, 88, static_cast<short>(-512));
+
+    UBXDecoder::NAV_PVT pvt;
+    QCOMPARE(UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_PVT>(createUBXMessage(0x01, 0x07, pvtPayload), pvt), UBXMessage::STATUS_VALID);
+
+    QCOMPARE(pvt.iTOW, 123456789);
+    QCOMPARE(pvt.year, static_cast<unsigned short>(2021));
+    QCOMPARE(pvt.month, static_cast<unsigned char>(6));
+    QCOMPARE(pvt.sec, static_cast<unsigned char>(59));
+    QCOMPARE(pvt.fixType, static_cast<unsigned char>(3));
+    QCOMPARE(pvt.numSV, static_cast<unsigned char>(31));
+    QCOMPARE(pvt.lon, 25.456789);
+    QCOMPARE(pvt.lat, -60.456789);
+    QCOMPARE(pvt.height, 123.456);
+    QCOMPARE(pvt.hAcc, 0.014);
+    QCOMPARE(pvt.velD, -0.25);
+    QCOMPARE(pvt.headMot, 180.0);
+    QCOMPARE(pvt.pDOP, 1.23);
+    QCOMPARE(pvt.magDec, -5.12);
+    QCOMPARE(pvt.flag_gnssFixOK, true);
+    QCOMPARE(pvt.flag_diffSoln, true);
+    QCOMPARE(pvt.flag_carrSoln, UBXMessage_RELPOSNED::FIXED);
+
+    // NAV-HPPOSLLH
+
+    QByteArray hpposllhPayload(36, 0);
+    putValue(hpposllhPayload, 4, static_cast<unsigned int>(123456789));
+    putValue(hpposllhPayload, 8, static_cast<int>(254567890));
+    putValue(hpposllhPayload, 24, static_cast<signed char>(-12));
+    putValue(hpposllhPayload, 16, static_cast<int>(123456));
+    putValue(hpposllhPayload, 26, static_cast<signed char>(7));
+    putValue(hpposllhPayload, 28, static_cast<unsigned int>(85));
+
+    UBXDecoder::NAV_HPPOSLLH hpposllh;
+    QCOMPARE(UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_HPPOSLLH>(createUBXMessage(0x01, 0x14, hpposllhPayload), hpposllh), UBXMessage::STATUS_VALID);
+
+    QCOMPARE(hpposllh.iTOW, 123456789);
+    QCOMPARE(hpposllh.flag_invalidLlh, false);
+    QCOMPARE(hpposllh.lon, 25.456789 - 12e-9);
+    QCOMPARE(hpposllh.height, 123.4567);
+    QCOMPARE(hpposllh.hAcc, 0.0085);
+
+    // Mismatches
+
+    QCOMPARE(UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_PVT>(createUBXMessage(0x02, 0x07, pvtPayload), pvt), UBXMessage::STATUS_ERROR_CAST_CLASS);
+    QCOMPARE(UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_PVT>(createUBXMessage(0x01, 0x14, pvtPayload), pvt), UBXMessage::STATUS_ERROR_CAST_ID);
+    QCOMPARE(UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_HPPOSLLH>(createUBXMessage(0x01, 0x14, pvtPayload), hpposllh), UBXMessage::STATUS_ERROR_LENGTH);
+    QCOMPARE(UBXMessage_RELPOSNED(createUBXMessage(0x01, 0x07, pvtPayload)).messageDataStatus, UBXMessage::STATUS_ERROR_CAST_ID);
+}
+
+void PostProcessingBenchmark::benchmark_DecodeRELPOSNED_data()
+{
+    QTest::addColumn<bool>("handWritten");
+
+    QTest::newRow("Hand-written") << true;
+    QTest::newRow("UBXDecoder") << false;
+}
+
+void PostProcessingBenchmark::benchmark_DecodeRELPOSNED()
+{
+    QFETCH(bool, handWritten);
+
+    QVector<UBXMessage> messages = readRELPOSNEDMessages();
+    QVERIFY(!messages.isEmpty());
+
+    qint64 numOfMessages = 0;
+    double checkSum = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        for (const UBXMessage& message : messages)
+        {
+            if (handWritten)
+            {
+                checkSum += decodeRELPOSNED_HandWritten(message).relPosN;
+            }
+            else
+            {
+                checkSum += UBXMessage_RELPOSNED(message).relPosN;
+            }
+        }
+
+        numOfMessages += messages.size();
+    }
+
+    reportThroughput(QString("RELPOSNED decoding (") + (handWritten ? "hand-written" : "UBXDecoder") + ")", numOfMessages, "messages", timer.nsecsElapsed());
+
+    QVERIFY(!qIsNaN(checkSum));     // Result used -> decoding can not be optimized away
+}
+
+QTEST_MAIN(PostProcessingBenchmark)
+
+#include "tst_postprocessingbenchmark.moc"
@@ -0,0 +1,33 @@
+QT += testlib
+QT += serialport
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+# Pseudo terminals (openpty) are used to loop data through real SerialThreads
+unix:!macx: LIBS += -lutil
+win32:LIBS += -l"ws2_32"
+
+SOURCES +=  tst_rtcmloopback.cpp \
+    ../../serialthread.cpp \
+    ../../ubloxdatastreamprocessor.cpp \
+    ../../gnssmessage.cpp \
+    ../../rtcmlatencystatistics.cpp \
+    ../../rtcmepochbundler.cpp \
+    ../../rtcmforwarder.cpp \
+    ../../ntripthread.cpp \
+    ../../tracer.cpp
+
+HEADERS += \
+    ../../serialthread.h \
+    ../../ubloxdatastreamprocessor.h \
+    ../../gnssmessage.h \
+    ../../ubxdecoder.h \
+    ../../rtcmlatencystatistics.h \
+    ../../rtcmepochbundler.h \
+    ../../rtcmforwarder.h \
+    ../../ntripthread.h \
+    ../../tracer.h
@@ -0,0 +1,575 @@
+/*
+    tst_rtcmloopback.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+
+// Loopback of RTCM-data through two pseudo terminals:
+// Test writes RTCM-messages into "base" pty's master side -> base SerialThread -> UBloxDataStreamProcessor
+// -> rover SerialThread's send queue -> rover pty's master side where test reads them back.
+
+#if defined(Q_OS_LINUX)
+#include <pty.h>
+#define PTY_SUPPORTED
+#elif defined(Q_OS_MACOS)
+#include <util.h>
+#define PTY_SUPPORTED
+#endif
+
+#ifdef PTY_SUPPORTED
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#endif
+
+#include "../../serialthread.h"
+#include "../../ubloxdatastreamprocessor.h"
+#include "../../rtcmlatencystatistics.h"
+#include "../../rtcmforwarder.h"
+
+class RTCMLoopback : public QObject
+{
+    Q_OBJECT
+
+public:
+    RTCMLoopback();
+    ~RTCMLoopback();
+
+private:
+    int masterFd_Base = -1;
+    int slaveFd_Base = -1;
+    QString slaveName_Base;
+
+    int masterFd_Rover = -1;
+    int slaveFd_Rover = -1;
+    QString slaveName_Rover;
+
+    static QByteArray createRTCMMessage(const unsigned short messageType, const int payloadLength, const unsigned char fill);
+    static RTCMMessage createMSMMessage(const unsigned short messageType, const quint32 epochTime, const bool multipleMessage, const qint64 messageStartTime = 0);
+    static bool openPseudoTerminal(int& masterFd, int& slaveFd, QString& slaveName);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void test_Histogram();
+    void test_Loopback();
+    void test_ForwarderWithBlockedEventLoop();
+    void test_EpochBundler_ParseSettings();
+    void test_EpochBundler_Bundling();
+    void test_EpochBundler_Filtering();
+};
+
+RTCMLoopback::RTCMLoopback()
+{
+
+}
+
+RTCMLoopback::~RTCMLoopback()
+{
+
+}
+
+QByteArray RTCMLoopback::createRTCMMessage(const unsigned short messageType, const int payloadLength, const unsigned char fill)
+{
+    QByteArray message;
+
+    message.append(static_cast<char>(0xD3));
+    message.append(static_cast<char>((payloadLength >> 8) & 0x03));
+    message.append(static_cast<char>(payloadLength & 0xFF));
+
+    for (int i = 0; i < payloadLength; i++)
+    {
+        message.append(static_cast<char>(fill));
+    }
+
+    // Message type = first 12 bits of payload
+    message[3] = static_cast<char>(messageType >> 4);
+    message[4] = static_cast<char>(((messageType & 0x0F) << 4) | (fill & 0x0F));
+
+    // CRC is not checked by UBloxDataStreamProcessor (yet)
+    message.append(3, 0);
+
+    return message;
+}
+
+RTCMMessage RTCMLoopback::createMSMMessage(const unsigned short messageType, const quint32 epochTime, const bool multipleMessage, const qint64 messageStartTime)
+{
+    QByteArray message = createRTCMMessage(messageType, 10, 0);
+
+    // Epoch time = payload bits 24...53, multiple message bit = payload bit 54 (payload starts at byte 3)
+    auto setBits = [&](const int firstBit, const int numOfBits, const quint32 value)
+    {
+        for (int i = 0; i < numOfBits; i++)
+        {
+            int bit = 3 * 8 + firstBit + i;
+            char mask = static_cast<char>(0x80 >> (bit % 8));
+
+            if ((value >> (numOfBits - 1 - i)) & 1)
+            {
+                message[bit / 8] = static_cast<char>(message[bit / 8] | mask);
+            }
+            else
+            {
+                message[bit / 8] = static_cast<char>(message[bit / 8] & ~mask);
+            }
+        }
+    };
+
+    setBits(24, 30, epochTime);
+    setBits(54, 1, multipleMessage ? 1 : 0);
+
+    return RTCMMessage(message, messageStartTime, messageStartTime);
+}
+
+bool RTCMLoopback::openPseudoTerminal(int& masterFd, int& slaveFd, QString& slaveName)
+{
+#ifdef PTY_SUPPORTED
+    char name[256];
+
+    if (openpty(&masterFd, &slaveFd, name, nullptr, nullptr) != 0)
+    {
+        return false;
+    }
+
+    struct termios settings;
+    tcgetattr(masterFd, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(masterFd, TCSANOW, &settings);
+
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+    slaveName = QString::fromLocal8Bit(name);
+    return true;
+#else
+    Q_UNUSED(masterFd);
+    Q_UNUSED(slaveFd);
+    Q_UNUSED(slaveName);
+    return false;
+#endif
+}
+
+void RTCMLoopback::initTestCase()
+{
+    qRegisterMetaType<SerialThread::DataReceivedEmitReason>();
+}
+
+void RTCMLoopback::cleanupTestCase()
+{
+#ifdef PTY_SUPPORTED
+    int fds[] = { masterFd_Base, slaveFd_Base, masterFd_Rover, slaveFd_Rover };
+
+    for (unsigned int i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (fds[i] >= 0)
+        {
+            close(fds[i]);
+        }
+    }
+#endif
+}
+
+void RTCMLoopback::test_Histogram()
+{
+    LatencyHistogram histogram(100);
+
+    QCOMPARE(histogram.getPercentile(50), static_cast<qint64>(-1));
+
+    for (int i = 1; i <= 100; i++)
+    {
+        histogram.addValue(i);
+    }
+
+    QCOMPARE(histogram.getCount(), static_cast<qint64>(100));
+    QCOMPARE(histogram.getMin(), static_cast<qint64>(1));
+    QCOMPARE(histogram.getMax(), static_cast<qint64>(100));
+    QCOMPARE(histogram.getPercentile(50), static_cast<qint64>(50));
+    QCOMPARE(histogram.getPercentile(99), static_cast<qint64>(99));
+
+    // 100 is in overflow bin -> max returned
+    QCOMPARE(histogram.getPercentile(100), static_cast<qint64>(100));
+    QCOMPARE(histogram.getMean(), 50.5);
+
+    histogram.addValue(-5);
+    QCOMPARE(histogram.getMin(), static_cast<qint64>(0));
+}
+
+void RTCMLoopback::test_Loopback()
+{
+#ifndef PTY_SUPPORTED
+    QSKIP("Pseudo terminals not supported on this platform.");
+#else
+    if (!openPseudoTerminal(masterFd_Base, slaveFd_Base, slaveName_Base) ||
+            !openPseudoTerminal(masterFd_Rover, slaveFd_Rover, slaveName_Rover))
+    {
+        QSKIP("Can't open pseudo terminals.");
+    }
+
+    RTCMLatencyStatistics statistics;
+    UBloxDataStreamProcessor processor;
+
+    // Same parameters as used in MainWindow
+    SerialThread serialThread_Base(slaveName_Base, 20, 1, 115200);
+    SerialThread serialThread_Rover(slaveName_Rover, 20, 1, 115200);
+
+    connect(&serialThread_Base, &SerialThread::dataReceived,
+            this, [&](const QByteArray& data, qint64 firstCharTime, qint64 lastCharTime, const SerialThread::DataReceivedEmitReason&)
+            {
+                processor.process(data, firstCharTime, lastCharTime);
+            });
+
+    connect(&processor, &UBloxDataStreamProcessor::rtcmMessageReceived,
+            this, [&](const RTCMMessage& message)
+            {
+                QElapsedTimer dispatchTimer;
+                dispatchTimer.start();
+                qint64 dispatchTime = dispatchTimer.msecsSinceReference();
+
+                quint64 sequenceNumber = statistics.messageDispatched(message, RTCMLatencyStatistics::SOURCE_SERIAL, dispatchTime);
+                int queueDepth = serialThread_Rover.addToSendQueue(message.rawMessage, sequenceNumber);
+                statistics.messageEnqueued(sequenceNumber, 0, dispatchTime, queueDepth);
+            });
+
+    connect(&serialThread_Rover, &SerialThread::queuedDataWritten,
+            this, [&](const quint64 sequenceNumber, const qint64 enqueueTime, const qint64 writeTime, const int queueDepth)
+            {
+                statistics.messageWritten(sequenceNumber, 0, enqueueTime, writeTime, queueDepth);
+            });
+
+    QSignalSpy baseInfoSpy(&serialThread_Base, &SerialThread::infoMessage);
+    QSignalSpy roverInfoSpy(&serialThread_Rover, &SerialThread::infoMessage);
+
+    serialThread_Base.start();
+    serialThread_Rover.start();
+
+    // Send queue is flushed when entering main loop -> wait for it
+    QTRY_VERIFY_WITH_TIMEOUT(baseInfoSpy.contains(QVariantList() << "Entering main loop."), 5000);
+    QTRY_VERIFY_WITH_TIMEOUT(roverInfoSpy.contains(QVariantList() << "Entering main loop."), 5000);
+
+    const int numOfMessages = 20;
+    QByteArray sentData;
+
+    for (int i = 0; i < numOfMessages; i++)
+    {
+        QByteArray message = createRTCMMessage(1074 + (i % 4) * 10, 20 + i * 5, static_cast<unsigned char>(i));
+        sentData.append(message);
+
+        QCOMPARE(write(masterFd_Base, message.constData(), static_cast<size_t>(message.length())), static_cast<ssize_t>(message.length()));
+
+        // Interval long enough for serial timeout to occur between messages
+        QTest::qWait(50);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(statistics.getHistogram(RTCMLatencyStatistics::STAGE_TOTAL, 0).getCount(), static_cast<qint64>(numOfMessages), 5000);
+
+    QByteArray receivedData;
+
+    auto readRoverData = [&]()
+    {
+        char buffer[256];
+        ssize_t bytesRead;
+
+        while ((bytesRead = read(masterFd_Rover, buffer, sizeof(buffer))) > 0)
+        {
+            receivedData.append(buffer, static_cast<int>(bytesRead));
+        }
+
+        return receivedData.length() >= sentData.length();
+    };
+
+    QTRY_VERIFY_WITH_TIMEOUT(readRoverData(), 5000);
+
+    QCOMPARE(receivedData, sentData);
+
+    QCOMPARE(statistics.getNumOfMessages(), static_cast<quint64>(numOfMessages));
+    QCOMPARE(statistics.getNumOfLostRecords(), static_cast<quint64>(0));
+
+    for (int stage = 0; stage < RTCMLatencyStatistics::STAGE_COUNT; stage++)
+    {
+        const LatencyHistogram& histogram = statistics.getHistogram(static_cast<RTCMLatencyStatistics::Stage>(stage), 0);
+
+        QCOMPARE(histogram.getCount(), static_cast<qint64>(numOfMessages));
+        QVERIFY(histogram.getPercentile(50) >= 0);
+        QVERIFY(histogram.getPercentile(50) <= histogram.getPercentile(99));
+        QVERIFY(histogram.getPercentile(99) <= histogram.getMax());
+    }
+
+    // Rover's queue is drained only after serial silence timeout (20 ms) -> queue latency should reflect that
+    QVERIFY(statistics.getHistogram(RTCMLatencyStatistics::STAGE_QUEUE, 0).getMax() < 1000);
+
+    QString csv;
+    QTextStream csvStream(&csv);
+    statistics.writeRecordsCSV(csvStream);
+    csvStream.flush();
+
+    // Header + one line per message
+    QCOMPARE(csv.count('\n'), numOfMessages + 1);
+
+    serialThread_Base.requestTerminate();
+    serialThread_Rover.requestTerminate();
+    serialThread_Base.wait(5000);
+    serialThread_Rover.wait(5000);
+#endif
+}
+
+void RTCMLoopback::test_ForwarderWithBlockedEventLoop()
+{
+#ifndef PTY_SUPPORTED
+    QSKIP("Pseudo terminals not supported on this platform.");
+#else
+    int masterFd_ForwarderBase = -1;
+    int slaveFd_ForwarderBase = -1;
+    QString slaveName_ForwarderBase;
+
+    int masterFd_ForwarderRover = -1;
+    int slaveFd_ForwarderRover = -1;
+    QString slaveName_ForwarderRover;
+
+    if (!openPseudoTerminal(masterFd_ForwarderBase, slaveFd_ForwarderBase, slaveName_ForwarderBase) ||
+            !openPseudoTerminal(masterFd_ForwarderRover, slaveFd_ForwarderRover, slaveName_ForwarderRover))
+    {
+        QSKIP("Can't open pseudo terminals.");
+    }
+
+    // Same parameters as used in MainWindow
+    SerialThread serialThread_Base(slaveName_ForwarderBase, 20, 256, 115200);
+    SerialThread serialThread_Rover(slaveName_ForwarderRover, 20, 1, 115200);
+
+    RTCMForwarder forwarder;
+    forwarder.connectSerialThreadSlots_Base(&serialThread_Base);
+    forwarder.setRoverSerialThread(0, &serialThread_Rover);
+
+    QSignalSpy countSpy(&forwarder, &RTCMForwarder::messageCountsChanged);
+    QSignalSpy baseInfoSpy(&serialThread_Base, &SerialThread::infoMessage);
+    QSignalSpy roverInfoSpy(&serialThread_Rover, &SerialThread::infoMessage);
+
+    serialThread_Base.start();
+    serialThread_Rover.start();
+
+    QTRY_VERIFY_WITH_TIMEOUT(baseInfoSpy.contains(QVariantList() << "Entering main loop."), 5000);
+    QTRY_VERIFY_WITH_TIMEOUT(roverInfoSpy.contains(QVariantList() << "Entering main loop."), 5000);
+
+    QTRY_COMPARE_WITH_TIMEOUT(countSpy.count(), 1, 5000);    // Initial counts
+    countSpy.clear();
+
+    const int numOfMessages = 20;
+    QByteArray sentData;
+
+    for (int i = 0; i < numOfMessages; i++)
+    {
+        sentData.append(createRTCMMessage(1074 + (i % 4) * 10, 20 + i * 5, static_cast<unsigned char>(i)));
+    }
+
+    QCOMPARE(write(masterFd_ForwarderBase, sentData.constData(), static_cast<size_t>(sentData.length())), static_cast<ssize_t>(sentData.length()));
+
+    // Event loop of this ("GUI"-)thread is not run while waiting -> messages must still reach the rover
+    QByteArray receivedData;
+    QElapsedTimer blockTimer;
+    blockTimer.start();
+
+    while ((receivedData.length() < sentData.length()) && (blockTimer.elapsed() < 5000))
+    {
+        char buffer[256];
+        ssize_t bytesRead;
+
+        while ((bytesRead = read(masterFd_ForwarderRover, buffer, sizeof(buffer))) > 0)
+        {
+            receivedData.append(buffer, static_cast<int>(bytesRead));
+        }
+
+        QThread::msleep(10);
+    }
+
+    QCOMPARE(receivedData, sentData);
+    QCOMPARE(forwarder.getMessageCount(RTCMLatencyStatistics::SOURCE_SERIAL), numOfMessages);
+    QCOMPARE(countSpy.count(), 0);
+
+    // Counts reach GUI-thread once its event loop runs again
+    QTRY_VERIFY_WITH_TIMEOUT(countSpy.count() >= 1, 5000);
+    QCOMPARE(countSpy.last().at(0).toInt(), numOfMessages);
+    QCOMPARE(countSpy.last().at(1).toInt(), 0);
+
+    serialThread_Base.requestTerminate();
+    serialThread_Base.wait(5000);
+    forwarder.disconnectSerialThreadSlots_Base(&serialThread_Base);
+
+    forwarder.setRoverSerialThread(0, nullptr);
+    serialThread_Rover.requestTerminate();
+    serialThread_Rover.wait(5000);
+
+    int fds[] = { masterFd_ForwarderBase, slaveFd_ForwarderBase, masterFd_ForwarderRover, slaveFd_ForwarderRover };
+
+    for (unsigned int i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        close(fds[i]);
+    }
+#endif
+}
+
+void RTCMLoopback::test_EpochBundler_ParseSettings()
+{
+    RTCMEpochBundler::Settings settings;
+    QString errorString;
+
+    QVERIFY(RTCMEpochBundler::parseSettings("1074-1077, !1075 1005@10000\tnobundle", settings, errorString));
+
+    QCOMPARE(settings.bundleEpochs, false);
+    QCOMPARE(settings.allowedTypes, QSet<unsigned short>({ 1074, 1075, 1076, 1077 }));
+    QCOMPARE(settings.deniedTypes, QSet<unsigned short>({ 1075 }));
+    QCOMPARE(settings.minIntervals.value(1005, -1), 10000);
+
+    // Invalid items -> settings not modified
+    QVERIFY(!RTCMEpochBundler::parseSettings("1074 10x4", settings, errorString));
+    QVERIFY(!RTCMEpochBundler::parseSettings("1077-1074", settings, errorString));
+    QVERIFY(!RTCMEpochBundler::parseSettings("!1005@1000", settings, errorString));
+    QVERIFY(!RTCMEpochBundler::parseSettings("5000", settings, errorString));
+    QCOMPARE(settings.bundleEpochs, false);
+
+    QVERIFY(RTCMEpochBundler::parseSettings("", settings, errorString));
+    QCOMPARE(settings.bundleEpochs, true);
+    QVERIFY(settings.allowedTypes.isEmpty());
+    QVERIFY(settings.deniedTypes.isEmpty());
+    QVERIFY(settings.minIntervals.isEmpty());
+
+    QVERIFY(RTCMEpochBundler::isMSM(1077));
+    QVERIFY(RTCMEpochBundler::isMSM(1131));
+    QVERIFY(!RTCMEpochBundler::isMSM(1005));
+    QVERIFY(!RTCMEpochBundler::isMSM(1230));
+    QVERIFY(!RTCMEpochBundler::isMSM(1080));
+}
+
+void RTCMLoopback::test_EpochBundler_Bundling()
+{
+    RTCMEpochBundler bundler;
+    QVector<RTCMEpochBundler::Output> outputs;
+
+    quint32 epochTime = 0;
+    bool multipleMessage = false;
+    QVERIFY(RTCMEpochBundler::getMSMEpochInfo(createMSMMessage(1074, 123456789, true).rawMessage, epochTime, multipleMessage));
+    QCOMPARE(epochTime, static_cast<quint32>(123456789));
+    QCOMPARE(multipleMessage, true);
+
+    // Non-MSM outside of an epoch -> sent as such
+    RTCMMessage message_1005(createRTCMMessage(1005, 19, 0), 90, 90);
+    bundler.addMessage(message_1005, 1, 100, outputs);
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1005.rawMessage);
+    QCOMPARE(outputs[0].epochStartTime, static_cast<qint64>(-1));
+    outputs.clear();
+
+    // GLONASS has different epoch time format -> different times don't close the epoch
+    RTCMMessage message_1074 = createMSMMessage(1074, 1000, true, 100);
+    RTCMMessage message_1230(createRTCMMessage(1230, 10, 0), 110, 110);
+    RTCMMessage message_1084 = createMSMMessage(1084, 777777, true, 120);
+    RTCMMessage message_1094 = createMSMMessage(1094, 1000, false, 130);
+
+    bundler.addMessage(message_1074, 2, 105, outputs);
+    bundler.addMessage(message_1230, 3, 115, outputs);
+    bundler.addMessage(message_1084, 4, 125, outputs);
+    QCOMPARE(outputs.size(), 0);
+
+    bundler.addMessage(message_1094, 5, 135, outputs);
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1074.rawMessage + message_1230.rawMessage + message_1084.rawMessage + message_1094.rawMessage);
+    QCOMPARE(outputs[0].sequenceNumbers, QVector<quint64>({ 2, 3, 4, 5 }));
+    QCOMPARE(outputs[0].epochStartTime, static_cast<qint64>(100));
+    outputs.clear();
+
+    // Last message of the epoch lost -> closed by next epoch of the same constellation
+    RTCMMessage message_1074_Epoch1 = createMSMMessage(1074, 2000, true, 1000);
+    RTCMMessage message_1074_Epoch2 = createMSMMessage(1074, 3000, true, 2000);
+
+    bundler.addMessage(message_1074_Epoch1, 6, 1000, outputs);
+    bundler.addMessage(message_1074_Epoch2, 7, 2000, outputs);
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1074_Epoch1.rawMessage);
+    outputs.clear();
+
+    // ...or by age
+    bundler.flushIfOlderThan(2400, 500, outputs);
+    QCOMPARE(outputs.size(), 0);
+    bundler.flushIfOlderThan(2600, 500, outputs);
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1074_Epoch2.rawMessage);
+    QCOMPARE(outputs[0].epochStartTime, static_cast<qint64>(2000));
+    outputs.clear();
+
+    // Bundling disabled
+    RTCMEpochBundler::Settings settings;
+    settings.bundleEpochs = false;
+    bundler.setSettings(settings);
+
+    bundler.addMessage(message_1074, 8, 3000, outputs);
+    bundler.addMessage(message_1094, 9, 3010, outputs);
+    QCOMPARE(outputs.size(), 2);
+}
+
+void RTCMLoopback::test_EpochBundler_Filtering()
+{
+    RTCMEpochBundler bundler;
+    QVector<RTCMEpochBundler::Output> outputs;
+    RTCMEpochBundler::Settings settings;
+    QString errorString;
+
+    QVERIFY(RTCMEpochBundler::parseSettings("1074-1077 1094 !1094 1005@1000", settings, errorString));
+    bundler.setSettings(settings);
+
+    // Denied message closes the epoch even if it's not forwarded
+    RTCMMessage message_1074 = createMSMMessage(1074, 1000, true, 100);
+    RTCMMessage message_1084 = createMSMMessage(1084, 1000, true, 110);
+    RTCMMessage message_1094 = createMSMMessage(1094, 1000, false, 120);
+
+    bundler.addMessage(message_1074, 1, 100, outputs);
+    bundler.addMessage(message_1084, 2, 110, outputs);
+    bundler.addMessage(message_1094, 3, 120, outputs);
+
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1074.rawMessage);
+    QCOMPARE(outputs[0].sequenceNumbers, QVector<quint64>({ 1 }));
+    outputs.clear();
+
+    // Rate limit with 10 % tolerance
+    RTCMMessage message_1005(createRTCMMessage(1005, 19, 0));
+    const qint64 times[] = { 1000, 1500, 1950, 2500, 2900 };
+    const int expectedOutputs[] = { 1, 1, 2, 2, 3 };
+
+    for (unsigned int i = 0; i < sizeof(times) / sizeof(times[0]); i++)
+    {
+        bundler.addMessage(message_1005, 10 + i, times[i], outputs);
+        QCOMPARE(outputs.size(), expectedOutputs[i]);
+    }
+
+    QCOMPARE(outputs[0].data, message_1005.rawMessage);
+    outputs.clear();
+
+    // Types neither allowed nor rate limited are not forwarded
+    RTCMMessage message_1230(createRTCMMessage(1230, 10, 0));
+    bundler.addMessage(message_1230, 20, 3000, outputs);
+    QCOMPARE(outputs.size(), 0);
+
+    // Rate limit alone doesn't restrict other types
+    QVERIFY(RTCMEpochBundler::parseSettings("1005@1000", settings, errorString));
+    bundler.setSettings(settings);
+
+    bundler.addMessage(message_1230, 21, 3100, outputs);
+    QCOMPARE(outputs.size(), 1);
+    QCOMPARE(outputs[0].data, message_1230.rawMessage);
+}
+
+QTEST_MAIN(RTCMLoopback)
+
+#include "tst_rtcmloopback.moc"
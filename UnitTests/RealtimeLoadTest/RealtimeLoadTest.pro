@@ -0,0 +1,44 @@
+QT += testlib
+QT += serialport
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../Eigen ../../Lidar
+
+# Pseudo terminals (openpty) are used by simulated serial devices
+unix:!macx: LIBS += -lutil
+win32:LIBS += -l"ws2_32"
+
+SOURCES +=  tst_realtimeloadtest.cpp \
+    ../../serialthread.cpp \
+    ../../ubloxdatastreamprocessor.cpp \
+    ../../gnssmessage.cpp \
+    ../../rtcmlatencystatistics.cpp \
+    ../../laserrangefinder20hzv2serialthread.cpp \
+    ../../Lidar/rplidar_sdk/src/arch/rplidarplatforms.cpp \
+    ../../Lidar/rplidar_sdk/src/hal/thread.cpp \
+    ../../Lidar/rplidar_sdk/src/rplidar_driver.cpp \
+    ../../Lidar/rplidarthread.cpp \
+    ../../Simulation/simulationspec.cpp \
+    ../../Simulation/simulatedlidarsource.cpp \
+    ../../Simulation/simulatedserialdevice.cpp \
+    ../../Simulation/realtimeloadmonitor.cpp \
+    ../../tracer.cpp
+
+HEADERS += \
+    ../../serialthread.h \
+    ../../ubloxdatastreamprocessor.h \
+    ../../gnssmessage.h \
+    ../../ubxdecoder.h \
+    ../../rtcmlatencystatistics.h \
+    ../../laserrangefinder20hzv2serialthread.h \
+    ../../Lidar/rplidarthread.h \
+    ../../Simulation/simulationspec.h \
+    ../../Simulation/simulatedlidarsource.h \
+    ../../Simulation/simulatedserialdevice.h \
+    ../../Simulation/realtimeloadmonitor.h \
+    ../../tracer.h
@@ -0,0 +1,485 @@
+/*
+    tst_realtimeloadtest.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+// Simulated devices and a load test of the realtime chain:
+// Simulated rovers and laser range finder write into pseudo terminals read by real SerialThreads,
+// simulated lidar rounds are emitted by a real RPLidarThread. RealtimeLoadMonitor measures
+// queue growth, dropped data and event loop latency.
+//
+// Load test can be scaled by environment variables (defaults in parentheses):
+// GNSSSTYLUS_LOADTEST_ROVERS (3), GNSSSTYLUS_LOADTEST_RATE_HZ (8, RELPOSNED-rate),
+// GNSSSTYLUS_LOADTEST_LIDAR_HZ (10), GNSSSTYLUS_LOADTEST_SPEED (1) and GNSSSTYLUS_LOADTEST_DURATION (5 s).
+
+#include "../../serialthread.h"
+#include "../../ubloxdatastreamprocessor.h"
+#include "../../laserrangefinder20hzv2serialthread.h"
+#include "../../Lidar/rplidarthread.h"
+#include "../../Simulation/simulationspec.h"
+#include "../../Simulation/simulatedlidarsource.h"
+#include "../../Simulation/simulatedserialdevice.h"
+#include "../../Simulation/realtimeloadmonitor.h"
+
+class RealtimeLoadTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    RealtimeLoadTest();
+    ~RealtimeLoadTest();
+
+private:
+    static int getEnvironmentValue(const char* name, const int defaultValue);
+    static bool writeLidarFile(const QString& fileName, const int numOfRounds, const int itemsPerRound, const qint64 roundInterval_ms);
+
+private slots:
+    void initTestCase();
+    void test_SimulationSpec();
+    void test_SyntheticLidarSource();
+    void test_RecordedLidarSource();
+    void test_Frames();
+    void test_LoadTest();
+};
+
+RealtimeLoadTest::RealtimeLoadTest()
+{
+
+}
+
+RealtimeLoadTest::~RealtimeLoadTest()
+{
+
+}
+
+int RealtimeLoadTest::getEnvironmentValue(const char* name, const int defaultValue)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+
+    return (ok && (value > 0)) ? value : defaultValue;
+}
+
+bool RealtimeLoadTest::writeLidarFile(const QString& fileName, const int numOfRounds, const int itemsPerRound, const qint64 roundInterval_ms)
+{
+    QFile lidarFile(fileName);
+
+    if (!lidarFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    // Same format as EssentialsForm writes
+    QDataStream dataStream(&lidarFile);
+    dataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    QVector<RPLidarThread::DistanceItem> items = SimulatedLidarSource::createSyntheticRound(itemsPerRound, 4, 0);
+    qint64 endTime = 1000;
+
+    for (int round = 0; round < numOfRounds; round++)
+    {
+        unsigned int numOfItems = static_cast<unsigned int>(items.count());
+
+        dataStream << static_cast<unsigned int>(1);
+        dataStream << static_cast<unsigned int>(sizeof(numOfItems) + 2 * sizeof(qint64) + numOfItems * 3 * sizeof(float));
+        dataStream << numOfItems << (endTime - roundInterval_ms) << endTime;
+
+        for (const RPLidarThread::DistanceItem& item : items)
+        {
+            dataStream << item.distance << item.angle << item.quality;
+        }
+
+        endTime += roundInterval_ms;
+    }
+
+    return dataStream.status() == QDataStream::Ok;
+}
+
+void RealtimeLoadTest::initTestCase()
+{
+    qRegisterMetaType<SerialThread::DataReceivedEmitReason>();
+    qRegisterMetaType<QVector<RPLidarThread::DistanceItem>>();
+}
+
+void RealtimeLoadTest::test_SimulationSpec()
+{
+    QVERIFY(SimulationSpec::isSimulationSpec("sim:synthetic"));
+    QVERIFY(!SimulationSpec::isSimulationSpec("/dev/ttyACM0"));
+
+    SimulationSpec spec;
+    QString errorString;
+
+    QVERIFY(spec.parse("sim:synthetic,Speed=10,hz=20", errorString));
+    QVERIFY(spec.isSynthetic());
+    QCOMPARE(spec.getSpeedFactor(errorString), 10.);
+    QCOMPARE(spec.getNumber("hz", 8, 1, 100, errorString), 20.);
+    QCOMPARE(spec.getNumber("radius", 10, 0.1, 1000, errorString), 10.);
+    QVERIFY(errorString.isEmpty());
+
+    QVERIFY(spec.parse("sim:/tmp/session_RoverA.ubx", errorString));
+    QVERIFY(!spec.isSynthetic());
+    QCOMPARE(spec.source, QString("/tmp/session_RoverA.ubx"));
+    QCOMPARE(spec.getSpeedFactor(errorString), 1.);
+
+    // Out of range / not a number
+    QVERIFY(spec.parse("sim:synthetic,speed=1000", errorString));
+    errorString = "";
+    spec.getSpeedFactor(errorString);
+    QVERIFY(!errorString.isEmpty());
+
+    QVERIFY(spec.parse("sim:synthetic,hz=fast", errorString));
+    errorString = "";
+    spec.getNumber("hz", 8, 1, 100, errorString);
+    QVERIFY(!errorString.isEmpty());
+
+    // Malformed options
+    QVERIFY(!spec.parse("sim:synthetic,speed", errorString));
+    QVERIFY(!spec.parse("sim:", errorString));
+
+    SimulatedLidarSource::Params lidarParams;
+    QVERIFY(!lidarParams.parse("sim:synthetic,hz=0", errorString));
+}
+
+void RealtimeLoadTest::test_SyntheticLidarSource()
+{
+    SimulatedLidarSource::Params params;
+    QString errorString;
+
+    QVERIFY(params.parse("sim:synthetic,hz=20,items=720,room=4,rounds=3,speed=5", errorString));
+    QCOMPARE(params.mode, SimulatedLidarSource::MODE_SYNTHETIC);
+    QCOMPARE(params.speedFactor, 5.);
+
+    SimulatedLidarSource source(params);
+    QVERIFY(source.open(errorString));
+
+    SimulatedLidarSource::Round round;
+    int numOfRounds = 0;
+
+    while (source.getNextRound(round))
+    {
+        numOfRounds++;
+
+        QCOMPARE(round.distanceItems.count(), 720);
+        QCOMPARE(round.duration_ms, 50.);
+
+        for (const RPLidarThread::DistanceItem& item : round.distanceItems)
+        {
+            // Walls of a 4 m room: 2...2.83 m (+noise)
+            QVERIFY(item.distance > 1.99f);
+            QVERIFY(item.distance < 2.84f);
+            QVERIFY(item.angle >= 0);
+            QVERIFY(item.angle < static_cast<float>(2 * M_PI));
+        }
+    }
+
+    QCOMPARE(numOfRounds, 3);
+}
+
+void RealtimeLoadTest::test_RecordedLidarSource()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString fileName = tempDir.filePath("test.lidar");
+    QVERIFY(writeLidarFile(fileName, 5, 100, 100));
+
+    SimulatedLidarSource::Params params;
+    QString errorString;
+
+    QVERIFY(params.parse("sim:" + fileName + ",loop=1", errorString));
+    QCOMPARE(params.mode, SimulatedLidarSource::MODE_RECORDED);
+    QVERIFY(params.loop);
+
+    SimulatedLidarSource source(params);
+    QVERIFY2(source.open(errorString), qPrintable(errorString));
+    QCOMPARE(source.getNumOfRecordedRounds(), 5);
+
+    SimulatedLidarSource::Round round;
+
+    // Looping -> more rounds than in the file
+    for (int i = 0; i < 12; i++)
+    {
+        QVERIFY(source.getNextRound(round));
+        QCOMPARE(round.distanceItems.count(), 100);
+        QCOMPARE(round.duration_ms, 100.);
+    }
+
+    params.loop = false;
+    SimulatedLidarSource nonLoopingSource(params);
+    QVERIFY(nonLoopingSource.open(errorString));
+
+    int numOfRounds = 0;
+
+    while (nonLoopingSource.getNextRound(round))
+    {
+        numOfRounds++;
+    }
+
+    QCOMPARE(numOfRounds, 5);
+
+    SimulatedLidarSource::Params missingFileParams;
+    QVERIFY(missingFileParams.parse("sim:" + tempDir.filePath("missing.lidar"), errorString));
+    SimulatedLidarSource missingFileSource(missingFileParams);
+    QVERIFY(!missingFileSource.open(errorString));
+}
+
+void RealtimeLoadTest::test_Frames()
+{
+    // RELPOSNED-frames must be accepted by the same processor the rovers use
+    QVector<SimulatedSerialDevice::Frame> frames = SimulatedSerialDevice::createFrames_SyntheticRELPOSNED(1, 1005, 125, 1000);
+
+    QCOMPARE(frames.count(), 8);
+    QCOMPARE(frames[0].time_ms, static_cast<qint64>(1125));
+
+    UBloxDataStreamProcessor processor;
+    QVector<UBXMessage_RELPOSNED> relposneds;
+
+    connect(&processor, &UBloxDataStreamProcessor::ubxMessageReceived,
+            this, [&](const UBXMessage& message)
+            {
+                relposneds.append(UBXMessage_RELPOSNED(message));
+            });
+
+    for (const SimulatedSerialDevice::Frame& frame : frames)
+    {
+        processor.process(frame.data, frame.time_ms, frame.time_ms);
+    }
+
+    QCOMPARE(relposneds.count(), frames.count());
+
+    for (int i = 0; i < relposneds.count(); i++)
+    {
+        const UBXMessage_RELPOSNED& relposned = relposneds[i];
+
+        QCOMPARE(relposned.messageDataStatus, UBXMessage::STATUS_VALID);
+        QCOMPARE(static_cast<qint64>(relposned.iTOW), frames[i].time_ms);
+        QVERIFY(relposned.flag_relPosValid);
+
+        // Antenna is 1 m from the rig's center (radius 10 m) -> Distance from the base 9...11 m
+        double distance = sqrt(relposned.relPosN * relposned.relPosN + relposned.relPosE * relposned.relPosE + relposned.relPosD * relposned.relPosD);
+        QVERIFY(distance >= 9 - 1e-3);
+        QVERIFY(distance <= 11 + 1e-3);
+    }
+
+    // Laser range finder frame: 3 header bytes, "001.2346", checksum
+    QByteArray laserFrame = SimulatedSerialDevice::createLaserRangeFinder20HzV2Frame(1.23456);
+
+    QCOMPARE(laserFrame.length(), 12);
+    QCOMPARE(laserFrame.mid(3, 8), QByteArray("001.2346"));
+
+    unsigned char sum = 0;
+
+    for (int i = 0; i < laserFrame.length(); i++)
+    {
+        sum += static_cast<unsigned char>(laserFrame[i]);
+    }
+
+    QCOMPARE(sum, static_cast<unsigned char>(0));
+}
+
+void RealtimeLoadTest::test_LoadTest()
+{
+    const int numOfRovers = getEnvironmentValue("GNSSSTYLUS_LOADTEST_ROVERS", 3);
+    const int roverRate = getEnvironmentValue("GNSSSTYLUS_LOADTEST_RATE_HZ", 8);
+    const int lidarRate = getEnvironmentValue("GNSSSTYLUS_LOADTEST_LIDAR_HZ", 10);
+    const int speed = getEnvironmentValue("GNSSSTYLUS_LOADTEST_SPEED", 1);
+    const int duration_s = getEnvironmentValue("GNSSSTYLUS_LOADTEST_DURATION", 5);
+
+    const QString speedOption = ",speed=" + QString::number(speed);
+    QString errorString;
+
+    RealtimeLoadMonitor monitor;
+
+    QVector<SimulatedSerialDevice*> roverDevices;
+    QVector<SerialThread*> roverThreads;
+    QVector<UBloxDataStreamProcessor*> roverProcessors;
+    QVector<int> relposnedCounts(numOfRovers, 0);
+
+    for (int i = 0; i < numOfRovers; i++)
+    {
+        SimulatedSerialDevice* device = SimulatedSerialDevice::createFromSpec("sim:synthetic,hz=" + QString::number(roverRate) + speedOption,
+                                                                              SimulatedSerialDevice::DEVICE_UBLOX_ROVER, static_cast<unsigned int>(i), errorString);
+        QVERIFY2(device, qPrintable(errorString));
+
+        if (!device->openPseudoTerminal(errorString))
+        {
+            delete device;
+            qDeleteAll(roverThreads);
+            qDeleteAll(roverDevices);
+            qDeleteAll(roverProcessors);
+            QSKIP(qPrintable(errorString));
+        }
+
+        roverDevices.append(device);
+
+        // Same parameters as used in MainWindow
+        SerialThread* serialThread = new SerialThread(device->getPortName(), 20, 1, 115200);
+        UBloxDataStreamProcessor* processor = new UBloxDataStreamProcessor();
+
+        roverThreads.append(serialThread);
+        roverProcessors.append(processor);
+
+        connect(serialThread, &SerialThread::dataReceived,
+                this, [processor](const QByteArray& data, qint64 firstCharTime, qint64 lastCharTime, const SerialThread::DataReceivedEmitReason&)
+                {
+                    processor->process(data, firstCharTime, lastCharTime);
+                });
+
+        connect(processor, &UBloxDataStreamProcessor::ubxMessageReceived,
+                this, [&relposnedCounts, i](const UBXMessage& message)
+                {
+                    if (UBXMessage_RELPOSNED(message).messageDataStatus == UBXMessage::STATUS_VALID)
+                    {
+                        relposnedCounts[i]++;
+                    }
+                });
+
+        monitor.addChannel("Rover " + QString::number(i) + " data", serialThread, &SerialThread::dataReceived,
+                           [device]() { return device->getStatistics().numOfFramesDropped; });
+    }
+
+    SimulatedSerialDevice* laserDevice = SimulatedSerialDevice::createFromSpec("sim:synthetic" + speedOption,
+                                                                              SimulatedSerialDevice::DEVICE_LASERRANGEFINDER20HZV2, 0, errorString);
+    QVERIFY2(laserDevice, qPrintable(errorString));
+    QVERIFY2(laserDevice->openPseudoTerminal(errorString), qPrintable(errorString));
+
+    LaserRangeFinder20HzV2SerialThread laserThread(laserDevice->getPortName(), 0, LaserRangeFinder20HzV2SerialThread::RESOLUTION_01mm);
+    int numOfDistances = 0;
+
+    connect(&laserThread, &LaserRangeFinder20HzV2SerialThread::distanceReceived,
+            this, [&numOfDistances](const double& distance, qint64, qint64)
+            {
+                if ((distance >= 0.5) && (distance <= 1.5))
+                {
+                    numOfDistances++;
+                }
+            });
+
+    monitor.addChannel("Laser distances", &laserThread, &LaserRangeFinder20HzV2SerialThread::distanceReceived,
+                       [laserDevice]() { return laserDevice->getStatistics().numOfFramesDropped; });
+
+    SimulatedLidarSource::Params lidarParams;
+    QVERIFY2(lidarParams.parse("sim:synthetic,hz=" + QString::number(lidarRate) + speedOption, errorString), qPrintable(errorString));
+
+    SimulatedLidarSource* lidarSource = new SimulatedLidarSource(lidarParams);
+    QVERIFY(lidarSource->open(errorString));
+
+    RPLidarThread lidarThread(lidarSource);
+    int numOfLidarRounds = 0;
+
+    connect(&lidarThread, &RPLidarThread::distanceRoundReceived,
+            this, [&numOfLidarRounds](const QVector<RPLidarThread::DistanceItem>&, qint64, qint64)
+            {
+                numOfLidarRounds++;
+            });
+
+    monitor.addChannel("Lidar rounds", &lidarThread, &RPLidarThread::distanceRoundReceived,
+                       [&lidarThread]() { return lidarThread.getNumOfDroppedRounds(); });
+
+    for (SimulatedSerialDevice* device : roverDevices)
+    {
+        device->start();
+    }
+
+    laserDevice->start();
+
+    for (SerialThread* serialThread : roverThreads)
+    {
+        serialThread->start();
+    }
+
+    laserThread.start();
+    lidarThread.start();
+
+    monitor.clear();
+    QTest::qWait(duration_s * 1000);
+
+    for (SimulatedSerialDevice* device : roverDevices)
+    {
+        device->requestTerminate();
+    }
+
+    laserDevice->requestTerminate();
+    lidarThread.requestTerminate();
+
+    for (SimulatedSerialDevice* device : roverDevices)
+    {
+        device->wait(5000);
+    }
+
+    laserDevice->wait(5000);
+    lidarThread.wait(5000);
+
+    // Let the GUI-thread drain queued signals
+    QTRY_VERIFY_WITH_TIMEOUT([&]()
+    {
+        for (const RealtimeLoadMonitor::ChannelStatistics& channel : monitor.getChannelStatistics())
+        {
+            if (channel.numOfHandled < channel.numOfEmitted)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }(), 10000);
+
+    qInfo().noquote() << monitor.getReport();
+
+    for (SerialThread* serialThread : roverThreads)
+    {
+        serialThread->requestTerminate();
+    }
+
+    laserThread.requestTerminate();
+
+    for (SerialThread* serialThread : roverThreads)
+    {
+        serialThread->wait(5000);
+    }
+
+    laserThread.wait(5000);
+
+    // Data must have flowed through every chain
+    for (int i = 0; i < numOfRovers; i++)
+    {
+        QVERIFY2(relposnedCounts[i] > 0, qPrintable("No RELPOSNED-messages from rover " + QString::number(i)));
+    }
+
+    QVERIFY(numOfDistances > 0);
+    QVERIFY(numOfLidarRounds > 0);
+    QCOMPARE(static_cast<qint64>(numOfLidarRounds), lidarThread.getNumOfEmittedRounds());
+
+    for (const RealtimeLoadMonitor::ChannelStatistics& channel : monitor.getChannelStatistics())
+    {
+        QVERIFY(channel.maxQueueDepth >= 1);
+    }
+
+    QVERIFY(monitor.getGUILatency().getCount() > 0);
+
+    qDeleteAll(roverThreads);
+    qDeleteAll(roverProcessors);
+    qDeleteAll(roverDevices);
+    delete laserDevice;
+}
+
+QTEST_MAIN(RealtimeLoadTest)
+
+#include "tst_realtimeloadtest.moc"
@@ -0,0 +1,129 @@
+/*
+    tst_roverpositiontrack.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+
+#include "../Common/roverfixture.h"
+#include "../../PostProcessing/Stylus/roverpositiontrack.h"
+
+class RoverPositionTrackTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_RoverPositionTrack();
+};
+
+void RoverPositionTrackTest::test_RoverPositionTrack()
+{
+    // Rover with a missing RELPOSNED-message and ITOW going backwards once in sync data
+    const int numOfMeasurements = 50;
+    const int interval = 100;
+
+    PostProcessingForm::Rover rover;
+
+    RoverFixture::fillRoverSyncData(rover, numOfMeasurements, interval,
+                                    [](const int i, UBXMessage_RELPOSNED::ITOW& iTOW, qint64& uptime)
+    {
+        uptime += i % 3;
+
+        if (i == 30)
+        {
+            iTOW = RoverFixture::firstITOW + 10 * interval;
+        }
+
+        return true;
+    });
+
+    for (int i = 0; i < numOfMeasurements; i++)
+    {
+        if (i != 20)
+        {
+            UBXMessage_RELPOSNED relposned;
+            relposned.iTOW = RoverFixture::firstITOW + i * interval;
+            relposned.relPosN = i * 0.1;
+            relposned.relPosE = -i * 0.2;
+            relposned.relPosD = i * 0.05;
+            relposned.accN = 0.01 + i * 0.001;
+            relposned.accE = 0.02;
+            relposned.accD = 0.03;
+            rover.relposnedMessages[relposned.iTOW] = relposned;
+        }
+    }
+
+    Stylus::RoverPositionTrack track;
+    track.build(rover);
+
+    QCOMPARE(track.getItems().count(), rover.roverSyncData.count());
+
+    int walkingIndex = 0;
+
+    for (qint64 uptime = RoverFixture::firstUptime - interval;
+         uptime < RoverFixture::firstUptime + (numOfMeasurements + 1) * interval; uptime += 7)
+    {
+        int index = track.lowerBound(uptime);
+        track.advanceToLowerBound(walkingIndex, uptime);
+        QCOMPARE(walkingIndex, index);
+
+        Stylus::RoverPositionTrack::Position position;
+        Stylus::RoverPositionTrack::LookupResult result = track.interpolate(index, uptime, -1, position);
+
+        // Reference: QMap-lookups as generators did them before
+        QMap<qint64, PostProcessingForm::RoverSyncItem>::const_iterator uptimeIter = rover.roverSyncData.lowerBound(uptime);
+
+        if (uptimeIter == rover.roverSyncData.end())
+        {
+            QCOMPARE(result, Stylus::RoverPositionTrack::LOOKUP_NO_UPPER_SYNC);
+            continue;
+        }
+
+        if (uptimeIter == rover.roverSyncData.begin())
+        {
+            QCOMPARE(result, Stylus::RoverPositionTrack::LOOKUP_NO_LOWER_SYNC);
+            continue;
+        }
+
+        const PostProcessingForm::RoverSyncItem upperSyncItem = uptimeIter.value();
+        const PostProcessingForm::RoverSyncItem lowerSyncItem = (--uptimeIter).value();
+
+        if ((!rover.relposnedMessages.contains(upperSyncItem.iTOW)) || (!rover.relposnedMessages.contains(lowerSyncItem.iTOW)))
+        {
+            QVERIFY(result != Stylus::RoverPositionTrack::LOOKUP_OK);
+            continue;
+        }
+
+        QCOMPARE(result, Stylus::RoverPositionTrack::LOOKUP_OK);
+
+        UBXMessage_RELPOSNED reference = UBXMessage_RELPOSNED::interpolateCoordinates(rover.relposnedMessages[lowerSyncItem.iTOW],
+                rover.relposnedMessages[upperSyncItem.iTOW], lowerSyncItem.iTOW + (uptime - uptimeIter.key()));
+
+        // Same calculations -> exactly the same values
+        QCOMPARE(position.iTOW, reference.iTOW);
+        QVERIFY(position.relPosN == reference.relPosN);
+        QVERIFY(position.relPosE == reference.relPosE);
+        QVERIFY(position.relPosD == reference.relPosD);
+        QVERIFY(position.accN == reference.accN);
+        QVERIFY(position.accE == reference.accE);
+        QVERIFY(position.accD == reference.accD);
+    }
+}
+
+QTEST_MAIN(RoverPositionTrackTest)
+
+#include "tst_roverpositiontrack.moc"
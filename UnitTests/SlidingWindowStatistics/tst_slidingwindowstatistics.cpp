@@ -0,0 +1,107 @@
+/*
+    tst_slidingwindowstatistics.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QRandomGenerator>
+
+#include "../../slidingwindowstatistics.h"
+
+class SlidingWindowStatisticsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_Statistics();
+};
+
+void SlidingWindowStatisticsTest::test_Statistics()
+{
+    // Compare against brute force calculation over the same window
+    const qint64 windowLengths[] = { 1, 10, 250, 5000 };
+
+    SlidingWindowStatistics statistics(2, windowLengths[0], 10000, 1000);
+    QRandomGenerator randomGenerator(1);
+
+    QVector<qint64> times;
+    QVector<double> values[2];
+
+    qint64 time = 0;
+
+    for (int i = 0; i < 4000; i++)
+    {
+        if (i % 1000 == 0)
+        {
+            statistics.setWindowLength(windowLengths[i / 1000]);
+        }
+
+        time += randomGenerator.bounded(0, 20);
+
+        const double sample[2] = { randomGenerator.generateDouble() * 10 - 5, static_cast<double>(randomGenerator.bounded(-3, 4)) };
+
+        statistics.addSample(time, sample);
+
+        times.append(time);
+        values[0].append(sample[0]);
+        values[1].append(sample[1]);
+
+        int count = 0;
+
+        for (int axis = 0; axis < 2; axis++)
+        {
+            double min = qInf();
+            double max = -qInf();
+            double sum = 0;
+            count = 0;
+
+            // Storage is limited to 1000 samples
+            for (int j = times.size() - 1; (j >= 0) && (j > times.size() - 1 - 1000) && ((time - times[j]) < statistics.getWindowLength()); j--)
+            {
+                min = qMin(min, values[axis][j]);
+                max = qMax(max, values[axis][j]);
+                sum += values[axis][j];
+                count++;
+            }
+
+            double mean = sum / count;
+            double variance = 0;
+
+            for (int j = times.size() - 1; j > times.size() - 1 - count; j--)
+            {
+                variance += (values[axis][j] - mean) * (values[axis][j] - mean);
+            }
+            variance /= count;
+
+            QCOMPARE(statistics.getCount(), count);
+            QCOMPARE(statistics.getMin(axis), min);
+            QCOMPARE(statistics.getMax(axis), max);
+            QVERIFY(qAbs(statistics.getMean(axis) - mean) < 1e-9);
+            QVERIFY(qAbs(statistics.getVariance(axis) - variance) < 1e-9);
+        }
+    }
+
+    // Going back in time clears samples
+    const double sample[2] = { 1, 2 };
+    statistics.addSample(time - 1, sample);
+    QCOMPARE(statistics.getCount(), 1);
+    QCOMPARE(statistics.getRangeNorm(), 0.0);
+}
+
+QTEST_MAIN(SlidingWindowStatisticsTest)
+
+#include "tst_slidingwindowstatistics.moc"
@@ -0,0 +1,18 @@
+QT += testlib
+QT += widgets concurrent
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+# Widgets are needed only for PostProcessingForm's (Tag-class) headers.
+# On a server without display run with "-platform offscreen".
+
+INCLUDEPATH += ../.. ../../Eigen ../../Lidar
+
+SOURCES +=  tst_tagsegmentindex.cpp \
+    ../../PostProcessing/tagsegmentindex.cpp
+
+HEADERS += \
+    ../../PostProcessing/tagsegmentindex.h
@@ -0,0 +1,131 @@
+/*
+    tst_tagsegmentindex.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+
+#include "../../PostProcessing/tagsegmentindex.h"
+
+class TagSegmentIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_TagSegmentIndex();
+};
+
+void TagSegmentIndexTest::test_TagSegmentIndex()
+{
+    QMultiMap<qint64, PostProcessingForm::Tag> tags;
+
+    auto addTag = [&tags](const qint64 uptime, const QString& ident, const QString& text, const QString& sourceFile)
+    {
+        PostProcessingForm::Tag tag;
+        tag.ident = ident;
+        tag.text = text;
+        tag.sourceFile = sourceFile;
+        tag.sourceFileLine = tags.count() + 1;
+        tag.iTOW = uptime;
+        tags.insert(uptime, tag);
+    };
+
+    addTag(100, "RMB", "", "a");        // Outside object
+    addTag(200, "New object", "Obj1", "a");
+    addTag(300, "RMB", "", "a");
+    addTag(400, "LMB", "", "a");        // Segment 0
+    addTag(500, "RMB", "", "a");
+    addTag(600, "LMB", "", "b");        // Different file
+    addTag(700, "LMB", "", "a");        // Segment 1
+    addTag(800, "New object", "", "a"); // Nameless -> following ignored
+    addTag(900, "RMB", "", "a");
+    addTag(1000, "LMB", "", "a");
+    addTag(1100, "New object", "Obj2", "a");
+    addTag(1200, "RMB", "", "a");
+    addTag(1300, "LMB", "", "a");       // Segment 2 (same uptime, file order)
+    addTag(1300, "RMB", "", "a");
+    addTag(1400, "Other", "", "a");     // Not in index
+    addTag(1500, "LMB", "", "a");       // Segment 3
+    addTag(1600, "LMB", "", "a");       // Without beginning
+
+    TagSegmentIndex index;
+    index.build(tags, "New object", "RMB", "LMB");
+
+    QVERIFY(index.isBuiltWith("New object", "RMB", "LMB"));
+    QVERIFY(!index.isBuiltWith("New object", "LMB", "RMB"));
+
+    const QVector<TagSegmentIndex::Item>& items = index.getItems();
+
+    QCOMPARE(items.count(), 14);
+
+    QCOMPARE(items[0].type, TagSegmentIndex::ITEM_INVALID_TAG);
+    QCOMPARE(items[0].diagnostic, TagSegmentIndex::DIAG_BEGINNING_OUTSIDE_OBJECT);
+    QCOMPARE(TagSegmentIndex::getDiagnosticText(items[0]), QString("File \"a\", line 1, uptime 100, iTOW 100: Beginning tag outside object. Skipped."));
+    QCOMPARE(items[1].type, TagSegmentIndex::ITEM_NEW_OBJECT);
+    QCOMPARE(items[1].objectName, QString("Obj1"));
+    QCOMPARE(items[2].type, TagSegmentIndex::ITEM_BEGINNING);
+    QCOMPARE(items[3].type, TagSegmentIndex::ITEM_SEGMENT);
+    QCOMPARE(items[3].segmentIndex, 0);
+    QCOMPARE(items[4].type, TagSegmentIndex::ITEM_BEGINNING);
+    QCOMPARE(items[5].type, TagSegmentIndex::ITEM_INVALID_TAG);
+    QCOMPARE(items[5].diagnostic, TagSegmentIndex::DIAG_DIFFERENT_FILES);
+    QCOMPARE(items[5].beginningUptime, qint64(500));
+    QCOMPARE(items[6].type, TagSegmentIndex::ITEM_SEGMENT);
+    QCOMPARE(items[6].segmentIndex, 1);
+    QCOMPARE(items[7].type, TagSegmentIndex::ITEM_NAMELESS_OBJECT);
+    QCOMPARE(items[8].type, TagSegmentIndex::ITEM_NEW_OBJECT);
+    QCOMPARE(items[8].uptime, qint64(1100));
+    QCOMPARE(items[9].type, TagSegmentIndex::ITEM_BEGINNING);
+    QCOMPARE(items[10].type, TagSegmentIndex::ITEM_SEGMENT);
+    QCOMPARE(items[10].tag.ident, QString("LMB"));
+    QCOMPARE(items[11].type, TagSegmentIndex::ITEM_BEGINNING);
+    QCOMPARE(items[11].uptime, qint64(1300));
+    QCOMPARE(items[12].type, TagSegmentIndex::ITEM_SEGMENT);
+    QCOMPARE(items[13].type, TagSegmentIndex::ITEM_INVALID_TAG);
+    QCOMPARE(items[13].diagnostic, TagSegmentIndex::DIAG_END_WITHOUT_BEGINNING);
+
+    const QVector<TagSegmentIndex::Segment>& segments = index.getSegments();
+
+    QCOMPARE(segments.count(), 4);
+    QCOMPARE(segments[0].beginningUptime, qint64(300));
+    QCOMPARE(segments[0].endingUptime, qint64(400));
+    QCOMPARE(segments[0].objectName, QString("Obj1"));
+    QCOMPARE(segments[1].beginningUptime, qint64(500));
+    QCOMPARE(segments[1].endingUptime, qint64(700));
+    QCOMPARE(segments[2].beginningUptime, qint64(1200));
+    QCOMPARE(segments[2].endingUptime, qint64(1300));
+    QCOMPARE(segments[2].objectName, QString("Obj2"));
+    QCOMPARE(segments[3].beginningUptime, qint64(1300));
+    QCOMPARE(segments[3].endingUptime, qint64(1500));
+
+    // Prefetched results equal direct ones, also when requested out of order
+    SegmentPrefetcher<qint64> prefetcher(segments, [](const TagSegmentIndex::Segment& segment)
+    {
+        return segment.endingUptime - segment.beginningUptime;
+    }, 2);
+
+    for (int i = 0; i < segments.count(); i++)
+    {
+        QCOMPARE(prefetcher.getResult(i), segments[i].endingUptime - segments[i].beginningUptime);
+    }
+
+    QCOMPARE(prefetcher.getResult(0), qint64(100));
+}
+
+QTEST_MAIN(TagSegmentIndexTest)
+
+#include "tst_tagsegmentindex.moc"
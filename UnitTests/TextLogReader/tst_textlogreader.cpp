@@ -0,0 +1,109 @@
+/*
+    tst_textlogreader.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include "../../PostProcessing/textlogreader.h"
+
+class TextLogReaderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_TextLogReader();
+};
+
+void TextLogReaderTest::test_TextLogReader()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QString fileName = tempDir.filePath("test.Sync");
+
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("\xEF\xBB\xBFTime\tSource\r\n"
+                   "  \tRover A\t+12\t-7\t 3.5e2 \t// comment\n"
+                   "\n"
+                   "rover b\t2147483648\tx1\t1e999\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\n"
+                   "Last");
+    }
+
+    TextLogReader reader;
+    QVERIFY(!reader.open(tempDir.filePath("nonexistent")));
+    QVERIFY(reader.open(fileName));
+
+    QCOMPARE(reader.readLine().toString(), QString("Time\tSource"));
+
+    TextLogReader::Field fields[TextLogReader::maxNumOfFields];
+    TextLogReader::Field line = reader.readLine();
+
+    QCOMPARE(line.indexOf("//"), 26);
+    QCOMPARE(line.left(line.indexOf("/x")).length, line.length);
+
+    QCOMPARE(TextLogReader::split(line.left(line.indexOf("//")), fields), 6);
+    QCOMPARE(fields[1].toString(), QString("Rover A"));
+    QVERIFY(fields[1].equals("rover a", Qt::CaseInsensitive));
+    QVERIFY(!fields[1].equals("rover a"));
+    QVERIFY(!fields[1].equals("rover", Qt::CaseInsensitive));
+
+    bool ok;
+    QCOMPARE(fields[2].toInt(&ok), 12);
+    QVERIFY(ok);
+    QCOMPARE(fields[3].toLongLong(&ok), -7ll);
+    QVERIFY(ok);
+    QCOMPARE(fields[4].toDouble(&ok), 350.0);
+    QVERIFY(ok);
+    fields[1].toInt(&ok);
+    QVERIFY(!ok);
+    QVERIFY(fields[5].isEmpty());
+
+    // Empty line has one empty item
+    QCOMPARE(TextLogReader::split(reader.readLine(), fields), 1);
+    QVERIFY(fields[0].isEmpty());
+
+    // Items beyond maxNumOfFields are counted but not stored
+    QCOMPARE(TextLogReader::split(reader.readLine(), fields), 22);
+    QCOMPARE(fields[0].trimmed().toString(), QString("rover b"));
+    QCOMPARE(fields[1].toInt(&ok), 0);
+    QVERIFY(!ok);
+    QCOMPARE(fields[1].toLongLong(&ok), 2147483648ll);
+    QVERIFY(ok);
+    fields[2].toLongLong(&ok);
+    QVERIFY(!ok);
+    fields[3].toDouble(&ok);
+    QVERIFY(!ok);
+
+    QVERIFY(!reader.atEnd());
+    QCOMPARE(reader.readLine().toString(), QString("Last"));
+    QVERIFY(reader.atEnd());
+    QVERIFY(reader.readLine().isEmpty());
+
+    TextLogReader::StringPool pool;
+    const char identData[] = "RMBRMB";
+    QString ident = pool.get(TextLogReader::Field(identData, 3));
+    QCOMPARE(ident, QString("RMB"));
+    QCOMPARE(pool.get(TextLogReader::Field(identData + 3, 3)).constData(), ident.constData());
+}
+
+QTEST_MAIN(TextLogReaderTest)
+
+#include "tst_textlogreader.moc"
@@ -0,0 +1,18 @@
+QT += testlib
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+INCLUDEPATH += ../.. ../../Eigen
+
+SOURCES +=  tst_tiledpointcloudwriter.cpp \
+    ../../PostProcessing/Lidar/tiledpointcloudwriter.cpp \
+    ../../tracer.cpp
+
+HEADERS += \
+    ../../PostProcessing/Lidar/tiledpointcloudwriter.h \
+    ../../PostProcessing/Lidar/voxelgridfilter.h \
+    ../../tracer.h
@@ -0,0 +1,170 @@
+/*
+    tst_tiledpointcloudwriter.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include "../../PostProcessing/Lidar/tiledpointcloudwriter.h"
+
+class TiledPointCloudWriterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_TiledPointCloudWriter();
+};
+
+void TiledPointCloudWriterTest::test_TiledPointCloudWriter()
+{
+    Lidar::TiledPointCloudWriter::Settings settings;
+    settings.tileSize = 1;
+    settings.gridResolution = 4;
+    settings.maxDepth = 3;
+    settings.maxBufferedPoints = 1000;     // Forces several appends per node file
+    settings.maxOccupancyMemory = 8 * 8;   // 8 bitsets (4^3 bits each) -> Forces evictions
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QString directoryPath = tempDir.filePath("tiled");
+
+    Lidar::TiledPointCloudWriter writer(settings, true);
+    QVERIFY(writer.open(directoryPath));
+
+    // Dense grid of points in two tiles + one point out of range
+    QVector<Lidar::VoxelGridFilter::Point> inputPoints;
+
+    for (int x = 0; x < 40; x++)
+    {
+        for (int y = 0; y < 20; y++)
+        {
+            for (int z = 0; z < 20; z++)
+            {
+                Lidar::VoxelGridFilter::Point point;
+                point.position = Eigen::Vector3d(x * 0.05 + 0.001, y * 0.05 + 0.002, -z * 0.05 - 0.003);
+                point.normal = Eigen::Vector3d(0, 0, 1);
+                inputPoints.append(point);
+            }
+        }
+    }
+
+    QCOMPARE(writer.getMaxNumOfOccupancyGrids(), 8);
+
+    for (int i = 0; i < inputPoints.count(); i += 1000)
+    {
+        QVERIFY(writer.addPoints(inputPoints.mid(i, 1000)));
+        QVERIFY(writer.getNumOfOccupancyGrids() <= writer.getMaxNumOfOccupancyGrids());
+    }
+
+    QVERIFY(writer.getNumOfEvictedOccupancyGrids() > 0);
+
+    Lidar::VoxelGridFilter::Point farPoint;
+    farPoint.position = Eigen::Vector3d(1e10, 0, 0);
+    QVERIFY(writer.addPoints(QVector<Lidar::VoxelGridFilter::Point>() << farPoint));
+
+    QString index;
+    QTextStream indexStream(&index);
+    QVERIFY(writer.finish(indexStream));
+    indexStream.flush();
+
+    QCOMPARE(writer.getNumOfPoints(), static_cast<qint64>(inputPoints.count()));
+    QCOMPARE(writer.getNumOfSkippedPoints(), static_cast<qint64>(1));
+
+    // Read all the nodes back: every point must be found exactly once, coarse levels subsampled
+    QVector<Eigen::Vector3d> readPoints;
+    int numOfNodes = 0;
+
+    for (const QString& line : index.split('\n'))
+    {
+        if (!line.startsWith("Node\t"))
+        {
+            continue;
+        }
+
+        QStringList fields = line.split('\t');
+        QCOMPARE(fields.count(), 11);
+
+        int level = fields[4].toInt();
+        Eigen::Vector3d minCorner(fields[5].toDouble(), fields[6].toDouble(), fields[7].toDouble());
+        qint64 numOfPoints = fields[9].toLongLong();
+
+        if (level < settings.maxDepth)
+        {
+            QVERIFY(numOfPoints <= settings.gridResolution * settings.gridResolution * settings.gridResolution);
+        }
+
+        QFile nodeFile(directoryPath + "/" + fields[10]);
+        QVERIFY(nodeFile.open(QIODevice::ReadOnly));
+        QByteArray bytes = nodeFile.readAll();
+        QCOMPARE(static_cast<qint64>(bytes.size()), numOfPoints * 6 * 4);
+
+        for (qint64 i = 0; i < numOfPoints; i++)
+        {
+            float values[6];
+
+            for (int j = 0; j < 6; j++)
+            {
+                quint32 value = qFromLittleEndian<quint32>(bytes.constData() + (i * 6 + j) * 4);
+                memcpy(&values[j], &value, sizeof(float));
+            }
+
+            QCOMPARE(values[5], 1.f);
+            readPoints.append(minCorner + Eigen::Vector3d(values[0], values[1], values[2]));
+        }
+
+        numOfNodes++;
+    }
+
+    QCOMPARE(numOfNodes, writer.getNumOfNodes());
+    QCOMPARE(readPoints.count(), inputPoints.count());
+
+    auto lessThan = [](const Eigen::Vector3d& a, const Eigen::Vector3d& b)
+    {
+        return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+    };
+
+    QVector<Eigen::Vector3d> expectedPoints;
+
+    for (const auto& point : inputPoints)
+    {
+        expectedPoints.append(point.position);
+    }
+
+    std::sort(expectedPoints.begin(), expectedPoints.end(), lessThan);
+    std::sort(readPoints.begin(), readPoints.end(), lessThan);
+
+    for (int i = 0; i < readPoints.count(); i++)
+    {
+        QVERIFY((readPoints[i] - expectedPoints[i]).norm() < 1e-5);
+    }
+
+    // Existing directory is not used (nor removed)
+    Lidar::TiledPointCloudWriter writer2(settings, false);
+    QVERIFY(!writer2.open(directoryPath));
+    writer2.discard();
+    QVERIFY(QDir(directoryPath).exists());
+
+    writer.discard();
+    QVERIFY(!QDir(directoryPath).exists());
+}
+
+QTEST_MAIN(TiledPointCloudWriterTest)
+
+#include "tst_tiledpointcloudwriter.moc"
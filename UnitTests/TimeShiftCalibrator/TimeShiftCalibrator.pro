@@ -0,0 +1,83 @@
+QT += testlib
+QT += widgets serialport concurrent
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+# TimeShiftCalibrator depends on PostProcessingForm (and therefore on most of post-processing).
+# On a server without display run with "-platform offscreen".
+
+INCLUDEPATH += ../.. ../../Eigen ../../Lidar
+
+SOURCES +=  tst_timeshiftcalibrator.cpp \
+    ../../PostProcessing/EasyEXIF/exif.cpp \
+    ../../PostProcessing/clockmodel.cpp \
+    ../../PostProcessing/generatortask.cpp \
+    ../../PostProcessing/Lidar/lidarpointtransformer.cpp \
+    ../../PostProcessing/Lidar/lidarscriptgenerator.cpp \
+    ../../PostProcessing/Lidar/pointcloudgeneratorlidar.cpp \
+    ../../PostProcessing/Lidar/processedroundcache.cpp \
+    ../../PostProcessing/Lidar/timeshiftcalibrator.cpp \
+    ../../PostProcessing/Lidar/tiledpointcloudwriter.cpp \
+    ../../PostProcessing/Lidar/voxelgridfilter.cpp \
+    ../../PostProcessing/Stylus/moviescriptgenerator.cpp \
+    ../../PostProcessing/Stylus/pointcloudgeneratorstylus.cpp \
+    ../../PostProcessing/Stylus/roverpositiontrack.cpp \
+    ../../PostProcessing/loscriptgenerator.cpp \
+    ../../PostProcessing/pipelinecache.cpp \
+    ../../PostProcessing/postprocessingform.cpp \
+    ../../PostProcessing/rastercameragenerator.cpp \
+    ../../PostProcessing/tagsegmentindex.cpp \
+    ../../PostProcessing/textlogreader.cpp \
+    ../../Lidar/rplidar_sdk/src/arch/rplidarplatforms.cpp \
+    ../../Lidar/rplidar_sdk/src/hal/thread.cpp \
+    ../../Lidar/rplidar_sdk/src/rplidar_driver.cpp \
+    ../../Lidar/rplidarplausibilityfilter.cpp \
+    ../../Lidar/rplidarthread.cpp \
+    ../../Simulation/simulationspec.cpp \
+    ../../Simulation/simulatedlidarsource.cpp \
+    ../../gnssmessage.cpp \
+    ../../logview.cpp \
+    ../../losolver.cpp \
+    ../../tracer.cpp \
+    ../../transformmatrixgenerator.cpp \
+    ../../ubloxdatastreamprocessor.cpp
+
+HEADERS += \
+    ../../PostProcessing/EasyEXIF/exif.h \
+    ../../PostProcessing/clockmodel.h \
+    ../../PostProcessing/generatortask.h \
+    ../../PostProcessing/Lidar/lidarpointtransformer.h \
+    ../../PostProcessing/Lidar/lidarscriptgenerator.h \
+    ../../PostProcessing/Lidar/pointcloudgeneratorlidar.h \
+    ../../PostProcessing/Lidar/processedroundcache.h \
+    ../../PostProcessing/Lidar/timeshiftcalibrator.h \
+    ../../PostProcessing/Lidar/tiledpointcloudwriter.h \
+    ../../PostProcessing/Lidar/voxelgridfilter.h \
+    ../../PostProcessing/Stylus/moviescriptgenerator.h \
+    ../../PostProcessing/Stylus/pointcloudgeneratorstylus.h \
+    ../../PostProcessing/Stylus/roverpositiontrack.h \
+    ../../PostProcessing/loscriptgenerator.h \
+    ../../PostProcessing/pipelinecache.h \
+    ../../PostProcessing/postprocessingform.h \
+    ../../PostProcessing/rastercameragenerator.h \
+    ../../PostProcessing/tagsegmentindex.h \
+    ../../PostProcessing/textlogreader.h \
+    ../../Lidar/rplidarplausibilityfilter.h \
+    ../../Lidar/rplidarthread.h \
+    ../../Simulation/simulationspec.h \
+    ../../Simulation/simulatedlidarsource.h \
+    ../../gnssmessage.h \
+    ../../logview.h \
+    ../../ubxdecoder.h \
+    ../../losolver.h \
+    ../../tracer.h \
+    ../../transformmatrixgenerator.h \
+    ../../ubloxdatastreamprocessor.h
+
+FORMS += \
+    ../../PostProcessing/postprocessingform.ui
+
+win32:LIBS += -l"ws2_32"
@@ -0,0 +1,69 @@
+/*
+    tst_timeshiftcalibrator.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QApplication>
+#include <QRandomGenerator>
+
+#include "../../PostProcessing/Lidar/timeshiftcalibrator.h"
+
+class TimeShiftCalibratorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_TimeShiftCalibratorScore();
+};
+
+void TimeShiftCalibratorTest::test_TimeShiftCalibratorScore()
+{
+    QCOMPARE(Lidar::TimeShiftCalibrator::calculateVoxelEntropy(QVector<Eigen::Vector3d>(), 0.1), 0.);
+
+    // All points in one voxel -> zero entropy, every point in its own voxel -> ln(N)
+    QVector<Eigen::Vector3d> points(100, Eigen::Vector3d(0.05, 0.05, 0.05));
+    QCOMPARE(Lidar::TimeShiftCalibrator::calculateVoxelEntropy(points, 0.1) + 1, 1.);
+
+    for (int i = 0; i < points.count(); i++)
+    {
+        points[i] = Eigen::Vector3d(i * 0.1 + 0.05, 0.05, 0.05);
+    }
+
+    QCOMPARE(Lidar::TimeShiftCalibrator::calculateVoxelEntropy(points, 0.1), log(100.));
+
+    // Plane (z = 0) is sharper than the same plane smeared in z-direction
+    QVector<Eigen::Vector3d> sharpPlane;
+    QVector<Eigen::Vector3d> smearedPlane;
+    QRandomGenerator randomGenerator(1);
+
+    for (int x = 0; x < 50; x++)
+    {
+        for (int y = 0; y < 50; y++)
+        {
+            Eigen::Vector3d point(x * 0.02, y * 0.02, 0.01);
+            sharpPlane.append(point);
+            smearedPlane.append(point + Eigen::Vector3d(0, 0, (randomGenerator.bounded(2.) - 1) * 0.2));
+        }
+    }
+
+    QVERIFY(Lidar::TimeShiftCalibrator::calculateVoxelEntropy(sharpPlane, 0.05) <
+            Lidar::TimeShiftCalibrator::calculateVoxelEntropy(smearedPlane, 0.05));
+}
+
+QTEST_MAIN(TimeShiftCalibratorTest)
+
+#include "tst_timeshiftcalibrator.moc"
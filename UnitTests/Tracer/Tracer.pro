@@ -0,0 +1,13 @@
+QT += testlib
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+SOURCES +=  tst_tracer.cpp \
+    ../../tracer.cpp
+
+HEADERS += \
+    ../../tracer.h
@@ -0,0 +1,204 @@
+/*
+    tst_tracer.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+#include <QThread>
+
+#include "../../tracer.h"
+
+class TracerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_Tracer();
+};
+
+void TracerTest::test_Tracer()
+{
+    if (!Tracer::isCompiledIn())
+    {
+        QSKIP("Tracing disabled at compile time.");
+    }
+
+    Tracer::clear();
+    Tracer::setEnabled(false);
+
+    {
+        TRACE_ZONE("Test zone (disabled)");
+    }
+
+    QCOMPARE(Tracer::getNumOfEvents(), static_cast<qint64>(0));
+
+    Tracer::setEnabled(true);
+
+    // Zones from several threads, 100 zones each
+    const int numOfThreads = 4;
+    QVector<QThread*> threads;
+
+    for (int i = 0; i < numOfThreads; i++)
+    {
+        QThread* thread = QThread::create([]()
+        {
+            for (int j = 0; j < 100; j++)
+            {
+                TRACE_ZONE("Test zone");
+                TRACE_COUNT("Test counter", 2);
+                QThread::usleep(10);
+            }
+        });
+
+        thread->setObjectName("Test thread");
+        threads.append(thread);
+        thread->start();
+    }
+
+    for (QThread* thread : threads)
+    {
+        QVERIFY(thread->wait(10000));
+    }
+
+    qDeleteAll(threads);
+
+    {
+        TRACE_ZONE("Test zone (GUI)");
+        TRACE_GAUGE("Test gauge", 5);
+        TRACE_GAUGE("Test gauge", 3);
+        QThread::msleep(2);
+    }
+
+    Tracer::setEnabled(false);
+
+    // 2 events per iteration in threads, 1 zone and 2 gauge events in GUI-thread
+    QCOMPARE(Tracer::getNumOfEvents(), static_cast<qint64>(numOfThreads * 100 * 2 + 3));
+    QCOMPARE(Tracer::getNumOfDroppedEvents(), static_cast<qint64>(0));
+
+    QVector<Tracer::ZoneStatistics> zones = Tracer::getZoneStatistics();
+    QCOMPARE(zones.count(), 2);
+
+    for (const Tracer::ZoneStatistics& zone : zones)
+    {
+        QVERIFY(zone.p50_ns > 0);
+        QVERIFY(zone.p50_ns <= zone.p99_ns);
+        QVERIFY(zone.p99_ns <= zone.max_ns);
+        QVERIFY(zone.max_ns <= zone.total_ns);
+
+        if (zone.name == "Test zone")
+        {
+            QCOMPARE(zone.count, static_cast<qint64>(numOfThreads * 100));
+        }
+        else
+        {
+            QCOMPARE(zone.name, QString("Test zone (GUI)"));
+            QCOMPARE(zone.count, static_cast<qint64>(1));
+            QVERIFY(zone.max_ns >= 2000000);
+        }
+    }
+
+    bool counterFound = false;
+    bool gaugeFound = false;
+
+    for (const Tracer::Counter* counter : Tracer::getCounters())
+    {
+        if (QString(counter->getName()) == "Test counter")
+        {
+            QCOMPARE(counter->getValue(), static_cast<qint64>(numOfThreads * 100 * 2));
+            counterFound = true;
+        }
+        else if (QString(counter->getName()) == "Test gauge")
+        {
+            QCOMPARE(counter->getValue(), static_cast<qint64>(3));
+            QCOMPARE(counter->getMaxValue(), static_cast<qint64>(5));
+            gaugeFound = true;
+        }
+    }
+
+    QVERIFY(counterFound);
+    QVERIFY(gaugeFound);
+
+    // Chrome trace must be valid JSON with thread names and all events
+    QString trace;
+    QTextStream traceStream(&trace);
+    Tracer::writeChromeTrace(traceStream);
+    traceStream.flush();
+
+    QJsonParseError parseError;
+    QJsonDocument traceDocument = QJsonDocument::fromJson(trace.toUtf8(), &parseError);
+    QVERIFY2(parseError.error == QJsonParseError::NoError, qPrintable(parseError.errorString()));
+
+    int numOfZoneEvents = 0;
+    int numOfCounterEvents = 0;
+    int numOfThreadNames = 0;
+
+    for (const QJsonValue& value : traceDocument.object()["traceEvents"].toArray())
+    {
+        QJsonObject event = value.toObject();
+        QString phase = event["ph"].toString();
+
+        if (phase == "X")
+        {
+            numOfZoneEvents++;
+            QVERIFY(event["dur"].toDouble() >= 0);
+        }
+        else if (phase == "C")
+        {
+            numOfCounterEvents++;
+        }
+        else if ((phase == "M") && (event["name"].toString() == "thread_name"))
+        {
+            numOfThreadNames++;
+            QVERIFY(event["args"].toObject()["name"].toString().startsWith("Test thread") ||
+                    event["args"].toObject()["name"].toString().startsWith("GUI-thread"));
+        }
+    }
+
+    QCOMPARE(numOfZoneEvents, numOfThreads * 100 + 1);
+    QCOMPARE(numOfCounterEvents, numOfThreads * 100 + 2);
+    QCOMPARE(numOfThreadNames, numOfThreads + 1);
+
+    QString summary;
+    QTextStream summaryStream(&summary);
+    Tracer::writeSummary(summaryStream);
+    summaryStream.flush();
+    QVERIFY(summary.contains("Test zone (GUI)"));
+
+    // Events over the limit are dropped (limit is rounded down to whole buffer chunks)
+    Tracer::clear();
+    QCOMPARE(Tracer::getNumOfEvents(), static_cast<qint64>(0));
+
+    Tracer::setMaxNumOfEvents(1);
+    Tracer::setEnabled(true);
+
+    for (int i = 0; i < 10; i++)
+    {
+        TRACE_ZONE("Test zone (dropped)");
+    }
+
+    Tracer::setEnabled(false);
+    Tracer::setMaxNumOfEvents(2000000);
+
+    QCOMPARE(Tracer::getNumOfEvents(), static_cast<qint64>(0));
+    QCOMPARE(Tracer::getNumOfDroppedEvents(), static_cast<qint64>(10));
+
+    Tracer::clear();
+}
+
+QTEST_MAIN(TracerTest)
+
+#include "tst_tracer.moc"
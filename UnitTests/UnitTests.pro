@@ -5,4 +5,5 @@ CONFIG += qt warn_on depend_includepath testcase
 TEMPLATE = app
 
 SOURCES +=  tst_lidarfiltering.cpp \
-    ../Lidar/rplidarplausibilityfilter.cpp
+    ../Lidar/rplidarplausibilityfilter.cpp \
+    ../tracer.cpp
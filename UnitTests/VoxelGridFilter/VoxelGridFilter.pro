@@ -0,0 +1,15 @@
+QT += testlib
+QT -= gui
+CONFIG += qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+CONFIG += c++17
+
+TEMPLATE = app
+
+INCLUDEPATH += ../.. ../../Eigen
+
+SOURCES +=  tst_voxelgridfilter.cpp \
+    ../../PostProcessing/Lidar/voxelgridfilter.cpp
+
+HEADERS += \
+    ../../PostProcessing/Lidar/voxelgridfilter.h
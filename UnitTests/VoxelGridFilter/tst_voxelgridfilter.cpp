@@ -0,0 +1,109 @@
+/*
+    tst_voxelgridfilter.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "../../PostProcessing/Lidar/voxelgridfilter.h"
+
+class VoxelGridFilterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_VoxelGridFilter();
+};
+
+void VoxelGridFilterTest::test_VoxelGridFilter()
+{
+    Lidar::VoxelGridFilter::Settings settings;
+    settings.cellSize = 0.1;
+
+    // 10 points in two voxels, the second one with a better quality
+    QVector<Lidar::VoxelGridFilter::Point> inputPoints;
+
+    for (int i = 0; i < 10; i++)
+    {
+        Lidar::VoxelGridFilter::Point point;
+        point.position = Eigen::Vector3d((i < 5 ? 0.01 : 0.51) + i * 0.001, 0.02, -0.03);
+        point.normal = Eigen::Vector3d(0, 0, (i % 2) ? 1 : 2);
+        point.quality = (i == 3) ? 1 : 0.5;
+        point.distance = 1;
+        inputPoints.append(point);
+    }
+
+    for (int mode = Lidar::VoxelGridFilter::MODE_FIRST; mode <= Lidar::VoxelGridFilter::MODE_BEST_QUALITY; mode++)
+    {
+        settings.mode = static_cast<Lidar::VoxelGridFilter::Mode>(mode);
+        Lidar::VoxelGridFilter filter(settings);
+        QVector<Lidar::VoxelGridFilter::Point> outputPoints;
+
+        for (const auto& point : inputPoints)
+        {
+            filter.addPoint(point, outputPoints);
+        }
+
+        QVERIFY(outputPoints.isEmpty());
+        filter.flush(outputPoints);
+
+        QCOMPARE(outputPoints.count(), 2);
+        QCOMPARE(filter.getNumOfInputPoints(), static_cast<qint64>(10));
+        QCOMPARE(filter.getNumOfOutputPoints(), static_cast<qint64>(2));
+
+        // Order of voxel creation is kept
+        QVERIFY(outputPoints[0].position(0) < outputPoints[1].position(0));
+
+        // Normals: direction averaged, lengths averaged (1 and 2 -> 1.4 or 1.6 depending on the count)
+        QVERIFY((outputPoints[0].normal - Eigen::Vector3d(0, 0, 1.6)).norm() < 1e-9);
+
+        switch (settings.mode)
+        {
+        case Lidar::VoxelGridFilter::MODE_FIRST:
+            QVERIFY((outputPoints[0].position - inputPoints[0].position).norm() < 1e-9);
+            break;
+        case Lidar::VoxelGridFilter::MODE_CENTROID:
+            QVERIFY((outputPoints[0].position - Eigen::Vector3d(0.012, 0.02, -0.03)).norm() < 1e-9);
+            break;
+        case Lidar::VoxelGridFilter::MODE_BEST_QUALITY:
+            QVERIFY((outputPoints[0].position - inputPoints[3].position).norm() < 1e-9);
+            break;
+        }
+    }
+
+    // Memory limit: points in a long line (one voxel each, many chunks) must be output while adding
+    settings.cellSize = 0.01;
+    settings.maxVoxelsInMemory = 1000;
+    Lidar::VoxelGridFilter filter(settings);
+    QVector<Lidar::VoxelGridFilter::Point> outputPoints;
+
+    for (int i = 0; i < 100000; i++)
+    {
+        Lidar::VoxelGridFilter::Point point;
+        point.position = Eigen::Vector3d(i * 0.01 + 0.005, 0, 0);
+        point.normal = Eigen::Vector3d::UnitZ();
+        filter.addPoint(point, outputPoints);
+        QVERIFY(filter.getNumOfInputPoints() - filter.getNumOfOutputPoints() <= settings.maxVoxelsInMemory);
+    }
+
+    filter.flush(outputPoints);
+    QCOMPARE(outputPoints.count(), 100000);
+}
+
+QTEST_MAIN(VoxelGridFilterTest)
+
+#include "tst_voxelgridfilter.moc"
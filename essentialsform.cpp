@@ -30,6 +30,7 @@
 #include <math.h>
 
 #include "essentialsform.h"
+#include "tracer.h"
 #include "ui_essentialsform.h"
 #include "Eigen/Geometry"
 
@@ -45,9 +46,18 @@ EssentialsForm::EssentialsForm(QWidget *parent) :
 
     ui->lineEdit_LoggingDirectory->setText(settings.value("LoggingDirectory", "").toString());
     ui->lineEdit_LoggingFileNamePrefix->setText(settings.value("LoggingFileNamePrefix", "ublox").toString());
+    ui->lineEdit_VideoFrameDirectory->setText(settings.value("VideoFrameDirectory", "").toString());
 
     ui->spinBox_NumberOfRovers->setValue(settings.value("NumberOfRovers").toInt());
     ui->spinBox_FluctuationHistoryLength->setValue(settings.value("FluctuationHistoryLength").toInt());
+
+    // valueChanged is not emitted if the loaded value equals the default -> set window lengths explicitly
+    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    {
+        rovers[i].locationStatistics.setWindowLength(ui->spinBox_FluctuationHistoryLength->value());
+    }
+    locationStatistics_StylusTip.setWindowLength(ui->spinBox_FluctuationHistoryLength->value());
+
     ui->horizontalScrollBar_Volume_MouseButtonTagging->setValue(settings.value("Volume_MouseButtonTagging").toInt());
     ui->horizontalScrollBar_Volume_DistanceReceived->setValue(settings.value("Volume_DistanceReceived").toInt());
 
@@ -119,12 +129,17 @@ EssentialsForm::EssentialsForm(QWidget *parent) :
 
     connect(&sideBarUpdateTimer, &QTimer::timeout, this, &EssentialsForm::on_sideBarUpdateTimerTimeout);
     sideBarUpdateTimer.start(10);
+
+    connect(&uiUpdateTimer, &QTimer::timeout, this, &EssentialsForm::on_uiUpdateTimerTimeout);
+    uiUpdateTimer.start(uiUpdateInterval);
+    uiUpdateCostPeriodTimer.start();
 }
 
 EssentialsForm::~EssentialsForm()
 {
     QSettings settings;
     settings.setValue("LoggingDirectory", ui->lineEdit_LoggingDirectory->text());
+    settings.setValue("VideoFrameDirectory", ui->lineEdit_VideoFrameDirectory->text());
     settings.setValue("LoggingFileNamePrefix", ui->lineEdit_LoggingFileNamePrefix->text());
 
     settings.setValue("NumberOfRovers", ui->spinBox_NumberOfRovers->value());
@@ -446,14 +461,12 @@ void EssentialsForm::ubxMessageReceived_Rover(const UBXMessage& ubxMessage, cons
         if (relposned.messageDataStatus == UBXMessage::STATUS_VALID)
         {
             // "Casting" generic UBX-message to RELPOSNED was successful
-            rovers[roverId].locationHistory.append(relposned);
+            rovers[roverId].lastRELPOSNED = relposned;
+            rovers[roverId].relposnedReceived = true;
 
-            while (rovers[roverId].locationHistory.size() > maxLocationHistoryLength)
-            {
-                rovers[roverId].locationHistory.removeFirst();
-            }
-
-            rovers[roverId].distanceBetweenFarthestCoordinates = calcDistanceBetweenFarthestCoordinates(rovers[roverId].locationHistory, ui->spinBox_FluctuationHistoryLength->value());
+            const double coordinates[3] = { relposned.relPosN, relposned.relPosE, relposned.relPosD };
+            rovers[roverId].locationStatistics.addSample(relposned.messageStartTime, coordinates);
+            rovers[roverId].distanceBetweenFarthestCoordinates = rovers[roverId].locationStatistics.getRangeNorm();
 
             while ((!rovers[roverId].messageQueue_RELPOSNED.isEmpty()) && (rovers[roverId].messageQueue_RELPOSNED.head().iTOW > relposned.iTOW))
             {
@@ -812,6 +825,8 @@ void EssentialsForm::addMouseButtonTag(const QString& tagtext, QSoundEffect& sou
 
 void EssentialsForm::handleRELPOSNEDQueues(void)
 {
+    TRACE_ZONE("EssentialsForm::RELPOSNED sync");
+
     int numOfRovers = ui->spinBox_NumberOfRovers->value();
 
     bool matchingiTOWFound = false;
@@ -905,10 +920,7 @@ void EssentialsForm::handleRELPOSNEDQueues(void)
 
     if (matchingiTOWFound)
     {
-        ui->label_iTOW_BIG->setNum(lastMatchingRELPOSNEDiTOW);
-        updateSideBar();
-
-        double worstAccuracy = 0;
+        worstAccuracy = 0;
 
         for (int i = 0; i < numOfRovers; i++)
         {
@@ -922,17 +934,6 @@ void EssentialsForm::handleRELPOSNEDQueues(void)
             }
         }
 
-        int worstAccuracyInt = static_cast<int>(worstAccuracy * 1000);
-
-        ui->label_WorstAccuracy->setText(QString::number(worstAccuracyInt) + " mm");
-
-        if (worstAccuracyInt > ui->progressBar_Accuracy->maximum())
-        {
-            worstAccuracyInt = ui->progressBar_Accuracy->maximum();
-        }
-
-        ui->progressBar_Accuracy->setValue(static_cast<int>(worstAccuracyInt));
-
         double distN = rovers[0].lastMatchingRoverRELPOSNED.relPosN - rovers[1].lastMatchingRoverRELPOSNED.relPosN;
         double distE = rovers[0].lastMatchingRoverRELPOSNED.relPosE - rovers[1].lastMatchingRoverRELPOSNED.relPosE;
         double distD = rovers[0].lastMatchingRoverRELPOSNED.relPosD - rovers[1].lastMatchingRoverRELPOSNED.relPosD;
@@ -1008,136 +1009,90 @@ double EssentialsForm::NEDPoint::getDistanceTo(const NEDPoint &other)
 }
 
 
-double EssentialsForm::calcDistanceBetweenFarthestCoordinates(const QList<NEDPoint>& locationHistory, qint64 time_ms)
+void EssentialsForm::showEvent(QShowEvent* event)
 {
-    if (locationHistory.length() >= 2)
-    {
-        double highN = -1e12;
-        double highE = -1e12;
-        double highD = -1e12;
-
-        double lowN = 1e12;
-        double lowE = 1e12;
-        double lowD = 1e12;
-
-        QList<NEDPoint>::const_iterator iter = locationHistory.end() - 1;
+    QWidget::showEvent(event);
 
-        qint64 lastUpTime = iter->uptime;
+    updateTreeItems();
+}
 
-        do
-        {
-            if (iter->n < lowN)
-            {
-                lowN = iter->n;
-            }
-            if (iter->e < lowE)
-            {
-                lowE = iter->e;
-            }
-            if (iter->d < lowD)
-            {
-                lowD = iter->d;
-            }
+void EssentialsForm::updateTreeItems(void)
+{
+    // Refreshing is done in on_uiUpdateTimerTimeout so that data received
+    // at high rates doesn't cause repeated reformatting of all items.
+    uiUpdatePending = true;
+}
 
-            if (iter->n > highN)
-            {
-                highN = iter->n;
-            }
-            if (iter->e > highE)
-            {
-                highE = iter->e;
-            }
-            if (iter->d > highD)
-            {
-                highD = iter->d;
-            }
-            iter--;
-        } while ((iter != locationHistory.begin()) && ((lastUpTime - iter->uptime) < time_ms));
+void EssentialsForm::on_uiUpdateTimerTimeout()
+{
+    if (video_WriteFrames && isVisible())
+    {
+        updateVideoFrameStatus();
+    }
 
-        double diffN = highN - lowN;
-        double diffE = highE - lowE;
-        double diffD = highD - lowD;
+    if (uiUpdatePending && isVisible())
+    {
+        QElapsedTimer costTimer;
+        costTimer.start();
 
-        double distanceHighLow = sqrt(diffN * diffN + diffE * diffE + diffD * diffD);
+        refreshTreeItems();
+        uiUpdatePending = false;
 
-        return distanceHighLow;
-    }
-    else
-    {
-        return 0;
+        addUIUpdateCost(costTimer.nsecsElapsed());
     }
 }
 
-
-double EssentialsForm::calcDistanceBetweenFarthestCoordinates(const QList<UBXMessage_RELPOSNED>& locationHistory, qint64 time_ms)
+void EssentialsForm::flushUIUpdates(void)
 {
-    if (locationHistory.length() >= 2)
+    if (uiUpdatePending)
     {
-        double highN = -1e12;
-        double highE = -1e12;
-        double highD = -1e12;
+        QElapsedTimer costTimer;
+        costTimer.start();
 
-        double lowN = 1e12;
-        double lowE = 1e12;
-        double lowD = 1e12;
+        refreshTreeItems();
+        uiUpdatePending = false;
 
-        QList<UBXMessage_RELPOSNED>::const_iterator iter = locationHistory.end() - 1;
-
-        qint64 lastUpTime = iter->messageStartTime;
-
-        do
-        {
-            if (iter->relPosN < lowN)
-            {
-                lowN = iter->relPosN;
-            }
-            if (iter->relPosE < lowE)
-            {
-                lowE = iter->relPosE;
-            }
-            if (iter->relPosD < lowD)
-            {
-                lowD = iter->relPosD;
-            }
+        addUIUpdateCost(costTimer.nsecsElapsed());
+    }
 
-            if (iter->relPosN > highN)
-            {
-                highN = iter->relPosN;
-            }
-            if (iter->relPosE > highE)
-            {
-                highE = iter->relPosE;
-            }
-            if (iter->relPosD > highD)
-            {
-                highD = iter->relPosD;
-            }
+    updateSideBar();
+}
 
-            iter--;
-        } while ((iter != locationHistory.begin()) && ((lastUpTime - iter->messageStartTime) < time_ms));
+void EssentialsForm::addUIUpdateCost(const qint64 cost_ns)
+{
+    uiUpdateCost_ns_Period += cost_ns;
+    uiUpdateCount_Period++;
 
-        double diffN = highN - lowN;
-        double diffE = highE - lowE;
-        double diffD = highD - lowD;
+    qint64 periodLength = uiUpdateCostPeriodTimer.elapsed();
 
-        double distanceHighLow = sqrt(diffN * diffN + diffE * diffE + diffD * diffD);
+    if (periodLength >= 1000)
+    {
+        uiUpdatesPerSecond = uiUpdateCount_Period * 1000. / periodLength;
+        uiUpdateCostPerSecond_ms = uiUpdateCost_ns_Period / 1e3 / periodLength;
 
-        return distanceHighLow;
+        uiUpdateCost_ns_Period = 0;
+        uiUpdateCount_Period = 0;
+        uiUpdateCostPeriodTimer.start();
     }
-    else
+}
+
+void EssentialsForm::setTreeItemText(QTreeWidgetItem* item, const int column, const QString& text)
+{
+    if (item->text(column) != text)
     {
-        return 0;
+        item->setText(column, text);
     }
 }
 
-void EssentialsForm::showEvent(QShowEvent* event)
+void EssentialsForm::setTreeItemBackground(QTreeWidgetItem* item, const int column, const QBrush& brush)
 {
-    QWidget::showEvent(event);
-
-    updateTreeItems();
+    if (item->background(column) != brush)
+    {
+        item->setBackground(column, brush);
+    }
 }
 
-void EssentialsForm::updateTreeItems(void)
+void EssentialsForm::refreshTreeItems(void)
 {
     if (!treeItemsCreated)
     {
@@ -1227,31 +1182,50 @@ void EssentialsForm::updateTreeItems(void)
         treeItem_LidarRoundFrequency_LOSolver = new QTreeWidgetItem(ui->treeWidget_LOSolver);
         treeItem_LidarRoundFrequency_LOSolver->setText(0, "Lidar data frequency");
 
+        treeItem_UIUpdateCost_Stylus = new QTreeWidgetItem(ui->treeWidget_Stylus);
+        treeItem_UIUpdateCost_Stylus->setText(0, "UI updates");
+
         treeItemsCreated = true;
     }
 
+    if (lastMatchingRELPOSNEDiTOW != -1)
+    {
+        ui->label_iTOW_BIG->setNum(lastMatchingRELPOSNEDiTOW);
+
+        int worstAccuracyInt = static_cast<int>(worstAccuracy * 1000);
+
+        ui->label_WorstAccuracy->setText(QString::number(worstAccuracyInt) + " mm");
+
+        if (worstAccuracyInt > ui->progressBar_Accuracy->maximum())
+        {
+            worstAccuracyInt = ui->progressBar_Accuracy->maximum();
+        }
+
+        ui->progressBar_Accuracy->setValue(static_cast<int>(worstAccuracyInt));
+    }
+
 /*
-    treeItem_DistanceBetweenFarthestCoordinates_RoverA->setText(1, QString::number(distanceBetweenFarthestCoordinates_RoverA, 'f', 3));
-    treeItem_DistanceBetweenFarthestCoordinates_RoverB->setText(1, QString::number(distanceBetweenFarthestCoordinates_RoverB, 'f', 3));
-    treeItem_DistanceBetweenFarthestCoordinates_StylusTip->setText(1, QString::number(distanceBetweenFarthestCoordinates_StylusTip, 'f', 3));
+    setTreeItemText(treeItem_DistanceBetweenFarthestCoordinates_RoverA, 1, QString::number(distanceBetweenFarthestCoordinates_RoverA, 'f', 3));
+    setTreeItemText(treeItem_DistanceBetweenFarthestCoordinates_RoverB, 1, QString::number(distanceBetweenFarthestCoordinates_RoverB, 'f', 3));
+    setTreeItemText(treeItem_DistanceBetweenFarthestCoordinates_StylusTip, 1, QString::number(distanceBetweenFarthestCoordinates_StylusTip, 'f', 3));
 */
-    treeItem_DistanceBetweenRovers_Stylus->setText(1, QString::number(distanceBetweenRovers, 'f', 3));
+    setTreeItemText(treeItem_DistanceBetweenRovers_Stylus, 1, QString::number(distanceBetweenRovers, 'f', 3));
 
-    treeItem_NED_StylusTip->setText(1, QString::number(lastStylusTipLocation.n, 'f', 3) + ", " + QString::number(lastStylusTipLocation.e, 'f', 3) + ", " + QString::number(lastStylusTipLocation.d, 'f', 3));
-    treeItem_AccNED_StylusTip->setText(1, QString::number(lastStylusTipLocation.accN, 'f', 3) + ", " + QString::number(lastStylusTipLocation.accE, 'f', 3) + ", " + QString::number(lastStylusTipLocation.accD, 'f', 3));
+    setTreeItemText(treeItem_NED_StylusTip, 1, QString::number(lastStylusTipLocation.n, 'f', 3) + ", " + QString::number(lastStylusTipLocation.e, 'f', 3) + ", " + QString::number(lastStylusTipLocation.d, 'f', 3));
+    setTreeItemText(treeItem_AccNED_StylusTip, 1, QString::number(lastStylusTipLocation.accN, 'f', 3) + ", " + QString::number(lastStylusTipLocation.accE, 'f', 3) + ", " + QString::number(lastStylusTipLocation.accD, 'f', 3));
 
     const QBrush brush_Valid = QBrush(QColor(128,255,128));
     const QBrush brush_Invalid = QBrush(QColor(255,128,128));
 
     if (lastStylusTipLocation.valid)
     {
-        treeItem_NED_StylusTip->setBackground(1, brush_Valid);
-        treeItem_AccNED_StylusTip->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_NED_StylusTip, 1, brush_Valid);
+        setTreeItemBackground(treeItem_AccNED_StylusTip, 1, brush_Valid);
     }
     else
     {
-        treeItem_NED_StylusTip->setBackground(1, brush_Invalid);
-        treeItem_AccNED_StylusTip->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_NED_StylusTip, 1, brush_Invalid);
+        setTreeItemBackground(treeItem_AccNED_StylusTip, 1, brush_Invalid);
     }
 
     const QBrush solutionBrushes[4] =
@@ -1284,105 +1258,105 @@ void EssentialsForm::updateTreeItems(void)
 
     for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
     {
-        if (rovers[i].locationHistory.isEmpty())
+        if (!rovers[i].relposnedReceived)
         {
             for (unsigned int ii = 0; ii < sizeof(roverItems[i].treeItem_ITOW) / sizeof(roverItems[i].treeItem_ITOW[0]); ii++)
             {
                 if (roverItems[i].treeItem_ITOW[ii])
                 {
-                    roverItems[i].treeItem_ITOW[ii]->setText(1, "N/A");
+                    setTreeItemText(roverItems[i].treeItem_ITOW[ii], 1, "N/A");
                 }
             }
             for (unsigned int ii = 0; ii < sizeof(roverItems[i].treeItem_SolutionStatus) / sizeof(roverItems[i].treeItem_SolutionStatus[0]); ii++)
             {
                 if (roverItems[i].treeItem_SolutionStatus[ii])
                 {
-                    roverItems[i].treeItem_SolutionStatus[ii]->setText(1, "N/A");
-                    roverItems[i].treeItem_SolutionStatus[ii]->setBackground(1, solutionBrushes[UBXMessage_RELPOSNED::UNDEFINED]);
+                    setTreeItemText(roverItems[i].treeItem_SolutionStatus[ii], 1, "N/A");
+                    setTreeItemBackground(roverItems[i].treeItem_SolutionStatus[ii], 1, solutionBrushes[UBXMessage_RELPOSNED::UNDEFINED]);
                 }
             }
         }
         else
         {
-            UBXMessage_RELPOSNED relposned = rovers[i].locationHistory.last();
+            UBXMessage_RELPOSNED relposned = rovers[i].lastRELPOSNED;
 
             for (unsigned int ii = 0; ii < sizeof(roverItems[i].treeItem_ITOW) / sizeof(roverItems[i].treeItem_ITOW[0]); ii++)
             {
                 if (roverItems[i].treeItem_ITOW[ii])
                 {
-                    roverItems[i].treeItem_ITOW[ii]->setText(1, QString::number(relposned.iTOW));
+                    setTreeItemText(roverItems[i].treeItem_ITOW[ii], 1, QString::number(relposned.iTOW));
                 }
             }
             for (unsigned int ii = 0; ii < sizeof(roverItems[i].treeItem_SolutionStatus) / sizeof(roverItems[i].treeItem_SolutionStatus[0]); ii++)
             {
                 if (roverItems[i].treeItem_SolutionStatus[ii])
                 {
-                    roverItems[i].treeItem_SolutionStatus[ii]->setText(1, relposned.getCarrSolnString());
-                    roverItems[i].treeItem_SolutionStatus[ii]->setBackground(1, solutionBrushes[relposned.flag_carrSoln % 4]);
+                    setTreeItemText(roverItems[i].treeItem_SolutionStatus[ii], 1, relposned.getCarrSolnString());
+                    setTreeItemBackground(roverItems[i].treeItem_SolutionStatus[ii], 1, solutionBrushes[relposned.flag_carrSoln % 4]);
                 }
             }
         }
     }
 
-    treeItem_NED_LMB_StylusTip->setText(1, QString::number(stylusTipLocation_LMB.n, 'f', 3) + ", " + QString::number(stylusTipLocation_LMB.e, 'f', 3) + ", " + QString::number(stylusTipLocation_LMB.d, 'f', 3));
+    setTreeItemText(treeItem_NED_LMB_StylusTip, 1, QString::number(stylusTipLocation_LMB.n, 'f', 3) + ", " + QString::number(stylusTipLocation_LMB.e, 'f', 3) + ", " + QString::number(stylusTipLocation_LMB.d, 'f', 3));
 
     if (stylusTipLocation_LMB.valid)
     {
-        treeItem_NED_LMB_StylusTip->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_NED_LMB_StylusTip, 1, brush_Valid);
     }
     else
     {
-        treeItem_NED_LMB_StylusTip->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_NED_LMB_StylusTip, 1, brush_Invalid);
     }
 
-    treeItem_NED_RMB_StylusTip->setText(1, QString::number(stylusTipLocation_RMB.n, 'f', 3) + ", " + QString::number(stylusTipLocation_RMB.e, 'f', 3) + ", " + QString::number(stylusTipLocation_RMB.d, 'f', 3));
+    setTreeItemText(treeItem_NED_RMB_StylusTip, 1, QString::number(stylusTipLocation_RMB.n, 'f', 3) + ", " + QString::number(stylusTipLocation_RMB.e, 'f', 3) + ", " + QString::number(stylusTipLocation_RMB.d, 'f', 3));
 
     if (stylusTipLocation_RMB.valid)
     {
-        treeItem_NED_RMB_StylusTip->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_NED_RMB_StylusTip, 1, brush_Valid);
     }
     else
     {
-        treeItem_NED_RMB_StylusTip->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_NED_RMB_StylusTip, 1, brush_Invalid);
     }
 
     double distanceTipToLMB = lastStylusTipLocation.getDistanceTo(stylusTipLocation_LMB);
 
-    treeItem_Distance_StylusTipToLMB->setText(1, QString::number(distanceTipToLMB, 'f', 3));
+    setTreeItemText(treeItem_Distance_StylusTipToLMB, 1, QString::number(distanceTipToLMB, 'f', 3));
 
     if ((stylusTipLocation_LMB.valid) && (lastStylusTipLocation.valid))
     {
-        treeItem_Distance_StylusTipToLMB->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_Distance_StylusTipToLMB, 1, brush_Valid);
     }
     else
     {
-        treeItem_Distance_StylusTipToLMB->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_Distance_StylusTipToLMB, 1, brush_Invalid);
     }
 
     double distanceTipToRMB = lastStylusTipLocation.getDistanceTo(stylusTipLocation_RMB);
 
-    treeItem_Distance_StylusTipToRMB->setText(1, QString::number(distanceTipToRMB, 'f', 3));
+    setTreeItemText(treeItem_Distance_StylusTipToRMB, 1, QString::number(distanceTipToRMB, 'f', 3));
 
     if ((stylusTipLocation_RMB.valid) && (lastStylusTipLocation.valid))
     {
-        treeItem_Distance_StylusTipToRMB->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_Distance_StylusTipToRMB, 1, brush_Valid);
     }
     else
     {
-        treeItem_Distance_StylusTipToRMB->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_Distance_StylusTipToRMB, 1, brush_Invalid);
     }
 
     double distanceLMBToRMB = stylusTipLocation_LMB.getDistanceTo(stylusTipLocation_RMB);
 
-    treeItem_Distance_StylusTip_LMBToRMB->setText(1, QString::number(distanceLMBToRMB, 'f', 3));
+    setTreeItemText(treeItem_Distance_StylusTip_LMBToRMB, 1, QString::number(distanceLMBToRMB, 'f', 3));
 
     if ((stylusTipLocation_LMB.valid) && (stylusTipLocation_RMB.valid))
     {
-        treeItem_Distance_StylusTip_LMBToRMB->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_Distance_StylusTip_LMBToRMB, 1, brush_Valid);
     }
     else
     {
-        treeItem_Distance_StylusTip_LMBToRMB->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_Distance_StylusTip_LMBToRMB, 1, brush_Invalid);
     }
 
     bool roverAToTipDistanceValid = true;
@@ -1396,138 +1370,92 @@ void EssentialsForm::updateTreeItems(void)
         roverAToTipDistanceValid = false;
     }
 
-    treeItem_Distance_RoverAToStylusTip->setText(1, QString::number(lastValidDistanceItem.distance, 'f', 3));
+    setTreeItemText(treeItem_Distance_RoverAToStylusTip, 1, QString::number(lastValidDistanceItem.distance, 'f', 3));
 
     if (roverAToTipDistanceValid)
     {
-        treeItem_Distance_RoverAToStylusTip->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_Distance_RoverAToStylusTip, 1, brush_Valid);
     }
     else
     {
-        treeItem_Distance_RoverAToStylusTip->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_Distance_RoverAToStylusTip, 1, brush_Invalid);
     }
 
     if (loSolverLocationOrientation.valid)
     {
-        treeItem_NED_LOSolver->setText(1, QString::number(loSolverLocationOrientation.n, 'f', 3) + ", " + QString::number(loSolverLocationOrientation.e, 'f', 3) + ", " + QString::number(loSolverLocationOrientation.d, 'f', 3));
+        setTreeItemText(treeItem_NED_LOSolver, 1, QString::number(loSolverLocationOrientation.n, 'f', 3) + ", " + QString::number(loSolverLocationOrientation.e, 'f', 3) + ", " + QString::number(loSolverLocationOrientation.d, 'f', 3));
 
         if (loSolverLocationOrientation.heading > 0)
         {
-            treeItem_Heading_LOSolver->setText(1, QString::number(fmod((loSolverLocationOrientation.heading * 360 / (2. * M_PI) + 360), 360), 'f', 3));
+            setTreeItemText(treeItem_Heading_LOSolver, 1, QString::number(fmod((loSolverLocationOrientation.heading * 360 / (2. * M_PI) + 360), 360), 'f', 3));
         }
         else
         {
-            treeItem_Heading_LOSolver->setText(1, QString::number(fmod((loSolverLocationOrientation.heading * 360 / (2. * M_PI) + 360), 360), 'f', 3) + " (" +
-                                               QString::number(loSolverLocationOrientation.heading * 360 / (2. * M_PI), 'f', 3) + ")");
+            setTreeItemText(treeItem_Heading_LOSolver, 1, QString::number(fmod((loSolverLocationOrientation.heading * 360 / (2. * M_PI) + 360), 360), 'f', 3) + " (" +
+                            QString::number(loSolverLocationOrientation.heading * 360 / (2. * M_PI), 'f', 3) + ")");
         }
 
-        treeItem_Pitch_LOSolver->setText(1, QString::number(loSolverLocationOrientation.pitch * 360 / (2. * M_PI), 'f', 3));
-        treeItem_Roll_LOSolver->setText(1, QString::number(loSolverLocationOrientation.roll * 360 / (2. * M_PI), 'f', 3));
+        setTreeItemText(treeItem_Pitch_LOSolver, 1, QString::number(loSolverLocationOrientation.pitch * 360 / (2. * M_PI), 'f', 3));
+        setTreeItemText(treeItem_Roll_LOSolver, 1, QString::number(loSolverLocationOrientation.roll * 360 / (2. * M_PI), 'f', 3));
 
-        treeItem_NED_LOSolver->setBackground(1, brush_Valid);
-        treeItem_Heading_LOSolver->setBackground(1, brush_Valid);
-        treeItem_Pitch_LOSolver->setBackground(1, brush_Valid);
-        treeItem_Roll_LOSolver->setBackground(1, brush_Valid);
+        setTreeItemBackground(treeItem_NED_LOSolver, 1, brush_Valid);
+        setTreeItemBackground(treeItem_Heading_LOSolver, 1, brush_Valid);
+        setTreeItemBackground(treeItem_Pitch_LOSolver, 1, brush_Valid);
+        setTreeItemBackground(treeItem_Roll_LOSolver, 1, brush_Valid);
     }
     else
     {
-        treeItem_NED_LOSolver->setText(1, "N/A");
-        treeItem_Heading_LOSolver->setText(1, "N/A");
-        treeItem_Pitch_LOSolver->setText(1, "N/A");
-        treeItem_Roll_LOSolver->setText(1, "N/A");
+        setTreeItemText(treeItem_NED_LOSolver, 1, "N/A");
+        setTreeItemText(treeItem_Heading_LOSolver, 1, "N/A");
+        setTreeItemText(treeItem_Pitch_LOSolver, 1, "N/A");
+        setTreeItemText(treeItem_Roll_LOSolver, 1, "N/A");
 
-        treeItem_NED_LOSolver->setBackground(1, brush_Invalid);
-        treeItem_Heading_LOSolver->setBackground(1, brush_Invalid);
-        treeItem_Pitch_LOSolver->setBackground(1, brush_Invalid);
-        treeItem_Roll_LOSolver->setBackground(1, brush_Invalid);
+        setTreeItemBackground(treeItem_NED_LOSolver, 1, brush_Invalid);
+        setTreeItemBackground(treeItem_Heading_LOSolver, 1, brush_Invalid);
+        setTreeItemBackground(treeItem_Pitch_LOSolver, 1, brush_Invalid);
+        setTreeItemBackground(treeItem_Roll_LOSolver, 1, brush_Invalid);
     }
 
     if (lidarTimeout)
     {
-        treeItem_LidarRoundFrequency_LOSolver->setText(1, "0");
-        treeItem_LidarRoundFrequency_LOSolver->setBackground(1, brush_Invalid);
+        setTreeItemText(treeItem_LidarRoundFrequency_LOSolver, 1, "0");
+        setTreeItemBackground(treeItem_LidarRoundFrequency_LOSolver, 1, brush_Invalid);
     }
     else
     {
-        treeItem_LidarRoundFrequency_LOSolver->setText(1, QString::number(lidarRoundFrequency, 'f', 1));
-        treeItem_LidarRoundFrequency_LOSolver->setBackground(1, brush_Valid);
+        setTreeItemText(treeItem_LidarRoundFrequency_LOSolver, 1, QString::number(lidarRoundFrequency, 'f', 1));
+        setTreeItemBackground(treeItem_LidarRoundFrequency_LOSolver, 1, brush_Valid);
     }
-}
 
-
-
-void EssentialsForm::on_spinBox_FluctuationHistoryLength_valueChanged(int)
-{
-    updateTreeItems();
+    setTreeItemText(treeItem_UIUpdateCost_Stylus, 1, QString::number(uiUpdatesPerSecond, 'f', 1) + " /s, " +
+                    QString::number(uiUpdateCostPerSecond_ms, 'f', 1) + " ms/s");
 }
 
-#if 0
-void EssentialsForm::handleVideoFrameRecording(void)
+void EssentialsForm::on_spinBox_FluctuationHistoryLength_valueChanged(int value)
 {
-    if ((video_FileNameBeginning.length() != 0) && (lastMatchingRELPOSNEDiTOW != -1) && (
-                (video_LastWrittenFrameITOW == -1) ||
-                (lastMatchingRELPOSNEDiTOW - video_LastWrittenFrameITOW >= 100))
-            )
+    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
     {
-        // This block is really ugly. Sorry!
-        // Just want to make video "recording" possible quickly...
-
-        if (!video_FrameBuffer)
-        {
-            // Framebuffer is defined in class-level so that the same frame can be output several
-            // times in the case of RELPOSNED "frame drops".
-            video_FrameBuffer = new QPixmap(this->size());  // Will not be explicitly deleted, but who cares?
-        }
-
-        if (video_LastWrittenFrameITOW != -1)
-        {
-            // Write previous frame as many times as "frame drops" happened to keep video in sync
-
-            while ((video_LastWrittenFrameITOW + 100) < lastMatchingRELPOSNEDiTOW)
-            {
-                video_FrameCounter++;
-                QString fileName = video_FileNameBeginning + "_" + QString("%1").arg(video_FrameCounter, 5, 10, QChar('0')) + + ".png";
-                video_FrameBuffer->save(fileName);
-
-                video_LastWrittenFrameITOW += 100;
-            }
-        }
-
-        repaint();  // To be sure that rover data shown in window is in sync (does render force repaint?)
-        render(video_FrameBuffer);
+        rovers[i].locationStatistics.setWindowLength(value);
+        rovers[i].distanceBetweenFarthestCoordinates = rovers[i].locationStatistics.getRangeNorm();
+    }
 
-        video_FrameCounter++;
-        QString fileName = video_FileNameBeginning + "_" + QString("%1").arg(video_FrameCounter, 5, 10, QChar('0')) + + ".png";
-        video_FrameBuffer->save(fileName);
+    locationStatistics_StylusTip.setWindowLength(value);
+    distanceBetweenFarthestCoordinates_StylusTip = locationStatistics_StylusTip.getRangeNorm();
 
-        if (video_LastWrittenFrameITOW != -1)
-        {
-            // Keep frames synced to 100 ms interval even when incoming data is not (should not happen, though)
-            video_LastWrittenFrameITOW += 100;
-        }
-        else
-        {
-            video_LastWrittenFrameITOW = lastMatchingRELPOSNEDiTOW - (lastMatchingRELPOSNEDiTOW % 100);
-        }
-    }
+    updateTreeItems();
 }
-#endif
 
 void EssentialsForm::handleVideoFrameRecording(qint64 uptime)
 {
-    if (video_FileNameBeginning.length() && video_WriteFrames)
+    if (video_Directory.length() && video_WriteFrames)
     {
         // This block is really ugly. Sorry!
         // Just want to make video "recording" possible quickly...
 
         bool startNewClip = false;
 
-        if (!video_FrameBuffer)
+        if (video_FrameBuffer.isNull())
         {
-            // Framebuffer is defined in class-level so that the same frame can be output several
-            // times in the case of RELPOSNED "frame drops".
-            video_FrameBuffer = new QPixmap(this->size());  // Will not be explicitly deleted, but who cares?
-
             startNewClip = true;
         }
         else if (uptime < video_LastWrittenFrameUptime)
@@ -1542,15 +1470,17 @@ void EssentialsForm::handleVideoFrameRecording(qint64 uptime)
             startNewClip = true;
         }
 
+        // Encoding is done in worker threads. Frames that need to be written
+        // several times (to keep video in sync) are encoded only once.
+        QStringList fileNames;
+
         if (startNewClip)
         {
             video_ClipIndex++;
             video_FrameCounter = 1;
 
-            repaint();  // To be sure that rover data shown in window is in sync (does render force repaint?)
-            render(video_FrameBuffer);
-            QString fileName = video_FileNameBeginning + QString::number(video_ClipIndex) + "_" + QString("%1").arg(video_FrameCounter, 5, 10, QChar('0')) + + ".png";
-            video_FrameBuffer->save(fileName);
+            fileNames.append(getVideoFrameFileName());
+
             video_LastWrittenFrameUptime = uptime;
             video_ClipBaseTime = uptime;
             video_ClipDoubleTimer = 0;
@@ -1559,27 +1489,76 @@ void EssentialsForm::handleVideoFrameRecording(qint64 uptime)
         {
             qint64 msecTimeDiff = uptime - video_ClipBaseTime;
 
-            bool renderFrame = true;
-
             while (video_ClipDoubleTimer <= msecTimeDiff)
             {
-                if (renderFrame)
-                {
-                    repaint();  // To be sure that rover data shown in window is in sync (does render force repaint?)
-                    render(video_FrameBuffer);
-                    renderFrame = false;
-                }
-
                 video_FrameCounter++;
-                QString fileName = video_FileNameBeginning + QString::number(video_ClipIndex) + "_" + QString("%1").arg(video_FrameCounter, 5, 10, QChar('0')) + + ".png";
-                video_FrameBuffer->save(fileName);
+                fileNames.append(getVideoFrameFileName());
                 video_ClipDoubleTimer += (1000. / video_FPS);
             }
             video_LastWrittenFrameUptime = uptime;
         }
+
+        if (!fileNames.isEmpty())
+        {
+            flushUIUpdates();
+            repaint();  // To be sure that rover data shown in window is in sync (does render force repaint?)
+
+            video_FrameBuffer = QImage(size(), QImage::Format_RGB32);
+            render(&video_FrameBuffer);
+
+            videoFrameWriter.addFrame(video_FrameBuffer, fileNames);
+        }
     }
 }
 
+QString EssentialsForm::getVideoFrameFileName(void)
+{
+    return QDir(video_Directory).filePath("Video" + QString::number(video_ClipIndex) + "_" + QString("%1").arg(video_FrameCounter, 5, 10, QChar('0')) + ".png");
+}
+
+void EssentialsForm::on_checkBox_WriteVideoFrames_stateChanged(int arg1)
+{
+    if (arg1 == Qt::Checked)
+    {
+        video_Directory = ui->lineEdit_VideoFrameDirectory->text();
+
+        if ((video_Directory.length() == 0) || !QDir().mkpath(video_Directory))
+        {
+            QMessageBox msgBox;
+            msgBox.setText("Can't create video frame directory \"" + video_Directory + "\".");
+            msgBox.exec();
+
+            ui->checkBox_WriteVideoFrames->setChecked(false);
+            return;
+        }
+
+        // Start a new clip
+        video_FrameBuffer = QImage();
+        videoFrameWriter.resetCounters();
+        video_WriteFrames = true;
+        ui->lineEdit_VideoFrameDirectory->setEnabled(false);
+    }
+    else
+    {
+        video_WriteFrames = false;
+        ui->lineEdit_VideoFrameDirectory->setEnabled(true);
+    }
+
+    updateVideoFrameStatus();
+}
+
+void EssentialsForm::updateVideoFrameStatus(void)
+{
+    QString status = "Written: " + QString::number(videoFrameWriter.getNumOfEncodedFrames()) +
+            ", pending: " + QString::number(videoFrameWriter.getNumOfPendingFrames()) +
+            ", dropped: " + QString::number(videoFrameWriter.getNumOfDroppedFrames()) +
+            ", failed: " + QString::number(videoFrameWriter.getNumOfFailedWrites());
+
+    if (ui->label_VideoFrameStatus->text() != status)
+    {
+        ui->label_VideoFrameStatus->setText(status);
+    }
+}
 
 void EssentialsForm::on_distanceReceived(const EssentialsForm::DistanceItem& distanceItem)
 {
@@ -1754,15 +1733,10 @@ void EssentialsForm::updateTipData(void)
 
     lastStylusTipLocation = stylusTipLocation;
 
-    locationHistory_StylusTip.append(stylusTipLocation);
-
-    while (locationHistory_StylusTip.size() > maxLocationHistoryLength)
-    {
-        locationHistory_StylusTip.removeFirst();
-    }
+    const double coordinates[3] = { stylusTipLocation.n, stylusTipLocation.e, stylusTipLocation.d };
+    locationStatistics_StylusTip.addSample(stylusTipLocation.uptime, coordinates);
 
-    distanceBetweenFarthestCoordinates_StylusTip =
-            calcDistanceBetweenFarthestCoordinates(locationHistory_StylusTip, ui->spinBox_FluctuationHistoryLength->value());
+    distanceBetweenFarthestCoordinates_StylusTip = locationStatistics_StylusTip.getRangeNorm();
 }
 
 
@@ -2024,6 +1998,8 @@ void EssentialsForm::disconnectRPLidarThreadSlots(RPLidarThread* rpLidarThread)
 
 void EssentialsForm::distanceRoundReceived(const QVector<RPLidarThread::DistanceItem>& data, qint64 startTime, qint64 endTime)
 {
+    TRACE_ZONE("EssentialsForm::lidar round");
+
     (void) data;
 
     int timeDiff = endTime - startTime;
@@ -2033,13 +2009,15 @@ void EssentialsForm::distanceRoundReceived(const QVector<RPLidarThread::Distance
         lidarTimeout = false;
         lidarTimeoutTimer.start(1000);
 
-        lidarRoundFrequency = 1000. / timeDiff;
+        lidarRoundFrequencyStatistics.addSample(endTime, 1000. / timeDiff);
+        lidarRoundFrequency = lidarRoundFrequencyStatistics.getMean(0);
     }
     else
     {
         // Indicate strange times as timeout
         lidarTimeout = true;
         lidarTimeoutTimer.stop();
+        lidarRoundFrequencyStatistics.clear();
         lidarRoundFrequency = 0;
     }
 
@@ -2077,16 +2055,23 @@ void EssentialsForm::distanceRoundReceived(const QVector<RPLidarThread::Distance
 void EssentialsForm::on_lidarTimeoutTimerTimeout()
 {
     lidarTimeout = true;
+    lidarRoundFrequencyStatistics.clear();
     updateTreeItems();
 }
 
 void EssentialsForm::on_sideBarUpdateTimerTimeout()
 {
-    updateSideBar();
+    if (isVisible())
+    {
+        updateSideBar();
+    }
 }
 
 void EssentialsForm::updateSideBar(void)
 {
+    QElapsedTimer costTimer;
+    costTimer.start();
+
     QElapsedTimer uptimeTimer;
     uptimeTimer.start();
     qint64 uptime = uptimeTimer.msecsSinceReference();
@@ -2134,7 +2119,12 @@ void EssentialsForm::updateSideBar(void)
         }
     }
 
-    ui->label_Side->setText(sideString);
+    if (ui->label_Side->text() != sideString)
+    {
+        ui->label_Side->setText(sideString);
+    }
+
+    addUIUpdateCost(costTimer.nsecsElapsed());
 }
 
 
@@ -39,6 +39,8 @@
 #include "laserrangefinder20hzv2serialthread.h"
 #include "losolver.h"
 #include "Lidar/rplidarthread.h"
+#include "slidingwindowstatistics.h"
+#include "videoframewriter.h"
 
 namespace Ui {
 class EssentialsForm;
@@ -93,6 +95,9 @@ public:
     void connectRPLidarThreadSlots(RPLidarThread* rpLidarThread); //!< Connects slots from LaserRangeFinder20HzV2SerialThread
     void disconnectRPLidarThreadSlots(RPLidarThread* rpLidarThread); //!< Disconnects slots from SerialThread
 
+    double getUIUpdatesPerSecond(void) const { return uiUpdatesPerSecond; }             //!< Returns number of UI refreshes (tree items/labels/side bar) during last second
+    double getUIUpdateCostPerSecond_ms(void) const { return uiUpdateCostPerSecond_ms; } //!< Returns time spent in UI refreshes during last second (ms)
+
 public slots:
     void on_distanceReceived(const EssentialsForm::DistanceItem& item);
     void on_measuredDistanceReceived(const double& distance, qint64 frameStartTime, qint64 frameEndTime);
@@ -139,6 +144,10 @@ private slots:
 
     void on_sideBarUpdateTimerTimeout();
 
+    void on_uiUpdateTimerTimeout();
+
+    void on_checkBox_WriteVideoFrames_stateChanged(int arg1);
+
 protected:
     void showEvent(QShowEvent* event);  //!< To initialize some things
 
@@ -159,7 +168,9 @@ private:
 
         UBXMessage_RELPOSNED lastMatchingRoverRELPOSNED;   //!< Last RELPOSNED-message with a matching iTOW with other rovers
 
-        QList<UBXMessage_RELPOSNED> locationHistory;         //!< Used to calculate fluctuation of rover's locations
+        UBXMessage_RELPOSNED lastRELPOSNED;                  //!< Last valid RELPOSNED-message received
+        bool relposnedReceived = false;                      //!< Any valid RELPOSNED-message received (lastRELPOSNED valid)
+        SlidingWindowStatistics locationStatistics = SlidingWindowStatistics(3);    //!< Used to calculate fluctuation of rover's locations (N, E, D)
         double distanceBetweenFarthestCoordinates = nan("");     //!< Distance calculated between min/max coordinate values for all NED-axes during spinBox_FluctuationHistoryLength
     };
 
@@ -245,9 +256,7 @@ private:
     QSoundEffect soundEffect_MBError;   //!< Sound effect for mouse button tagging (Error)
     QSoundEffect soundEffect_Distance;  //!< Sound effect for new distance
 
-    const int maxLocationHistoryLength = 6000;                  //!< Maximum number of location history items to keep (used to calculate fluctuations)
-
-    QList<NEDPoint> locationHistory_StylusTip;                  //!< Used to calculate fluctuation of stylus tip's location
+    SlidingWindowStatistics locationStatistics_StylusTip = SlidingWindowStatistics(3);  //!< Used to calculate fluctuation of stylus tip's location (N, E, D)
     NEDPoint lastStylusTipLocation;
 
     double distanceBetweenFarthestCoordinates_StylusTip = nan("");  //!< Distance calculated between min/max coordinate values for all NED-axes during spinBox_FluctuationHistoryLength (stylus tip)
@@ -298,12 +307,16 @@ private:
 
     QTreeWidgetItem *treeItem_LidarRoundFrequency_LOSolver;
 
+    QTreeWidgetItem *treeItem_UIUpdateCost_Stylus;
+
 
     void handleRELPOSNEDQueues(void);   //!< Handles also syncing of rover RELPOSNED-messages
     void closeAllLogFiles(void);
-    double calcDistanceBetweenFarthestCoordinates(const QList<NEDPoint>& locationHistory, qint64 time_ms); //!< Calculates distance between min/max coordinate values for all NED-axes of last n milliseconds
-    double calcDistanceBetweenFarthestCoordinates(const QList<UBXMessage_RELPOSNED>& locationHistory, qint64 time_ms); //!< Calculates distance between min/max coordinate values for all NED-axes of last n milliseconds
-    void updateTreeItems(void);
+    void updateTreeItems(void);         //!< Marks tree items/labels to be refreshed on next uiUpdateTimer-timeout
+    void refreshTreeItems(void);        //!< Refreshes tree items/labels (only changed cells are touched)
+    void flushUIUpdates(void);          //!< Refreshes pending UI changes immediately (used before rendering video frames)
+    static void setTreeItemText(QTreeWidgetItem* item, const int column, const QString& text);        //!< Sets text if changed
+    static void setTreeItemBackground(QTreeWidgetItem* item, const int column, const QBrush& brush);  //!< Sets background if changed
     void addMouseButtonTag(const QString& tagtext, QSoundEffect& soundEffect, qint64 uptime = -1);  //!< Adds mouse button tag to log file and plays soundEffect if successful
     void addTextTag(qint64 uptime = -1);
     void addDistanceLogItem(const DistanceItem& item);    //!< Adds distance to log file
@@ -317,10 +330,13 @@ private:
 
     // Settings for video frame writing (ugly I know, but this is just to make video "recording" possible)
     bool video_WriteFrames = false;
-    QString video_FileNameBeginning = "D:\\GNSSStylusData\\Videos\\EssentialFrames\\Video";
+    QString video_Directory;            //!< Directory for video frames (set from lineEdit_VideoFrameDirectory)
     int video_FrameCounter = 0;
-    QPixmap* video_FrameBuffer = nullptr;
+    QImage video_FrameBuffer;           //!< Last rendered frame (null if new clip needs to be started)
+    VideoFrameWriter videoFrameWriter;  //!< Encodes and writes frames in worker threads
     void handleVideoFrameRecording(qint64 uptime);
+    QString getVideoFrameFileName(void);
+    void updateVideoFrameStatus(void);
     qint64 video_LastWrittenFrameUptime = 0;
     int video_ClipIndex = 0;
     double video_FPS = 30;
@@ -340,11 +356,25 @@ private:
     LocationOrientation loSolverLocationOrientation;
 
     float lidarRoundFrequency = 0;
+    SlidingWindowStatistics lidarRoundFrequencyStatistics = SlidingWindowStatistics(1, 1000);   //!< Used to average lidar round frequency over 1 s
     bool lidarTimeout = true;   //!< Lidar is in timeout (no rounds received in 1s?)
     QTimer lidarTimeoutTimer;
 
     QTimer sideBarUpdateTimer;
 
+    QTimer uiUpdateTimer;               //!< Timer for refreshing tree items/labels at fixed rate (updates requested between timeouts are coalesced)
+    const int uiUpdateInterval = 40;    //!< Interval for uiUpdateTimer (ms)
+    bool uiUpdatePending = false;       //!< Tree items/labels need to be refreshed
+
+    double worstAccuracy = 0;           //!< Worst accuracy of last matching RELPOSNED-messages (m)
+
+    QElapsedTimer uiUpdateCostPeriodTimer;      //!< Started at the beginning of each UI update cost measurement period (1 s)
+    qint64 uiUpdateCost_ns_Period = 0;          //!< Time spent in UI refreshes during current period (ns)
+    int uiUpdateCount_Period = 0;               //!< Number of UI refreshes during current period
+    double uiUpdatesPerSecond = 0;              //!< Number of UI refreshes during last period (per second)
+    double uiUpdateCostPerSecond_ms = 0;        //!< Time spent in UI refreshes during last period (ms per second)
+    void addUIUpdateCost(const qint64 cost_ns); //!< Adds UI refresh to cost counters
+
 };
 
 #endif // ESSENTIALSFORM_H
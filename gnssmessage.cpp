@@ -25,6 +25,7 @@
  */
 
 #include "gnssmessage.h"
+#include "ubxdecoder.h"
 
 GNSSMessage::GNSSMessage()
 {
@@ -125,82 +126,11 @@ UBXMessage_RELPOSNED::UBXMessage_RELPOSNED()
 
 UBXMessage_RELPOSNED::UBXMessage_RELPOSNED(const UBXMessage &ubxMessage) : UBXMessage(ubxMessage)
 {
+    initRELPOSNEDFields();
+
     if (messageDataStatus == STATUS_VALID)
     {
-        if (messageClass != 0x01)
-        {
-            messageDataStatus = STATUS_ERROR_CAST_CLASS;
-        }
-        else if (messageId != 0x3c)
-        {
-            messageDataStatus = STATUS_ERROR_CAST_ID;
-        }
-        else if (payloadLength != 64)
-        {
-            messageDataStatus = STATUS_ERROR_LENGTH;
-        }
-        else
-        {
-            // Use packed, "memory-mapped" source data in conversion to prevent byte-counting
-
-#pragma pack(push, 1)
-            //RELPOSNED-message as it is in the frame (packed)
-            typedef struct
-            {
-                unsigned char version;          // Message version (0x01 for this version).
-                unsigned char reserved1;        // Reserved.
-                unsigned short refStationId;    // Reference Station ID. Must be in the range 0..4095.
-                unsigned int iTOW;              // GPS time of week of the navigation epoch (ms).
-                int relPosN;                    // North component of relative position vector (cm).
-                int relPosE;                    // East component of relative position vector (cm).
-                int relPosD;                    // Down component of relative position vector (cm).
-                int relPosLength;               // Length of the relative position vector (cm).
-                int relPosHeading;              // Heading of the relative position vector (1e-5 deg).
-                unsigned char reserved2[4];     // Reserved.
-                signed char relPosHPN;          // High-precision North component of relative position vector (0.1 mm).
-                signed char relPosHPE;          // High-precision East component of relative position vector (0.1 mm).
-                signed char relPosHPD;          // High-precision Down component of relative position vector (0.1 mm).
-                signed char relPosHPLength;     // High-precision component of the length of the relative position vector (0.1 mm).
-                unsigned int accN;              // Accuracy of relative position North component (0.1 mm).
-                unsigned int accE;              // Accuracy of relative position East component (0.1 mm).
-                unsigned int accD;              // Accuracy of relative position Down component (0.1 mm).
-                unsigned int accLength;         // Accuracy of length of the relative position vector (0.1 mm).
-                unsigned int accHeading;        // Accuracy of heading of the relative position vector (0.1 mm).
-                unsigned char reserved3[4];     // Reserved.
-                unsigned int flags;             // Flags.
-            } UBXRawData_RELPOSNED;
-#pragma pack(pop)
-
-            UBXRawData_RELPOSNED* rawRELPOSNED = reinterpret_cast<UBXRawData_RELPOSNED*>(&rawMessage.data()[6]);
-
-            version = rawRELPOSNED->version;
-            refStationId = rawRELPOSNED->refStationId;
-            iTOW = static_cast<ITOW>(rawRELPOSNED->iTOW);
-
-            relPosN = rawRELPOSNED->relPosN / 100. + rawRELPOSNED->relPosHPN / 10e3;
-            relPosE = rawRELPOSNED->relPosE / 100. + rawRELPOSNED->relPosHPE / 10e3;
-            relPosD = rawRELPOSNED->relPosD / 100. + rawRELPOSNED->relPosHPD / 10e3;
-
-            relPosLength = rawRELPOSNED->relPosLength / 100. + rawRELPOSNED->relPosHPLength / 10e3;
-            relPosHeading = rawRELPOSNED->relPosHeading / 1e5;
-
-            accN = rawRELPOSNED->accN / 10e3;
-            accE = rawRELPOSNED->accE / 10e3;
-            accD = rawRELPOSNED->accD / 10e3;
-
-            accLength = rawRELPOSNED->accLength / 10e3;
-            accHeading = rawRELPOSNED->accHeading / 1e5;
-            flags = rawRELPOSNED->flags;
-
-            flag_gnssFixOK = flags & (1 << 0);
-            flag_diffSoln = flags & (1 << 1);
-            flag_relPosValid = flags & (1 << 2);
-            flag_carrSoln = static_cast<UBXRawData_RELPOSNED_CarrierPhaseSolutionStatus>((flags >> 3) & 3);
-            flag_isMoving = flags & (1 << 5);
-            flag_refPosMiss = flags & (1 << 6);
-            flag_refObsMiss = flags & (1 << 7);
-            flag_relPosHeadingValid = flags & (1 << 8);
-        }
+        messageDataStatus = UBXDecoder::decodeMessage<UBXDecoder::Layout_NAV_RELPOSNED>(ubxMessage, *this);
     }
 }
 
@@ -0,0 +1,309 @@
+/*
+    logview.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file logview.cpp
+ * @brief Definitions for a bounded log line store and a list view showing it.
+ */
+
+#include <algorithm>
+
+#include <QTime>
+#include <QScrollBar>
+#include <QApplication>
+#include <QClipboard>
+
+#include "logview.h"
+
+LogModel::LogModel(QObject* parent) : QAbstractListModel(parent)
+{
+}
+
+int LogModel::addCategory(const QString& name)
+{
+    Category category;
+    category.name = name;
+    categories.append(category);
+
+    return categories.size() - 1;
+}
+
+void LogModel::setCategoryVisible(const int category, const bool visible)
+{
+    if (categories[category].visible != visible)
+    {
+        categories[category].visible = visible;
+        rebuildRows();
+    }
+}
+
+void LogModel::addLine(const QString& line, const int category)
+{
+    Entry entry;
+
+    entry.time_ms = QTime::currentTime().msecsSinceStartOfDay();
+    entry.category = category;
+    entry.text = line;
+
+    categories[category].count++;
+
+    pendingEntries.push_back(entry);
+
+    while (pendingEntries.size() > static_cast<size_t>(maxLines))
+    {
+        pendingEntries.pop_front();
+        droppedLines++;
+    }
+}
+
+bool LogModel::flushPending(void)
+{
+    if (paused || pendingEntries.empty())
+    {
+        return false;
+    }
+
+    QVector<quint64> newRows;
+
+    while (!pendingEntries.empty())
+    {
+        quint64 index = firstEntryIndex + entries.size();
+
+        entries.push_back(pendingEntries.front());
+        pendingEntries.pop_front();
+
+        if (isShown(entries.back()))
+        {
+            newRows.append(index);
+        }
+    }
+
+    if (!newRows.isEmpty())
+    {
+        int firstRow = static_cast<int>(rows.size());
+
+        beginInsertRows(QModelIndex(), firstRow, firstRow + newRows.size() - 1);
+        rows.insert(rows.end(), newRows.begin(), newRows.end());
+        endInsertRows();
+    }
+
+    trimEntries();
+
+    return !newRows.isEmpty();
+}
+
+void LogModel::setMaxLines(const int maxLines)
+{
+    this->maxLines = maxLines;
+
+    while (pendingEntries.size() > static_cast<size_t>(maxLines))
+    {
+        pendingEntries.pop_front();
+        droppedLines++;
+    }
+
+    trimEntries();
+}
+
+void LogModel::setPaused(const bool paused)
+{
+    this->paused = paused;
+}
+
+void LogModel::setFilterText(const QString& filterText)
+{
+    if (this->filterText != filterText)
+    {
+        this->filterText = filterText;
+        rebuildRows();
+    }
+}
+
+void LogModel::clear(void)
+{
+    beginResetModel();
+
+    firstEntryIndex += entries.size();
+    entries.clear();
+    pendingEntries.clear();
+    rows.clear();
+
+    endResetModel();
+}
+
+void LogModel::clearCounters(void)
+{
+    for (int i = 0; i < categories.size(); i++)
+    {
+        categories[i].count = 0;
+    }
+
+    droppedLines = 0;
+}
+
+QString LogModel::getRowText(const int row) const
+{
+    const Entry& entry = entries[rows[row] - firstEntryIndex];
+
+    return QTime::fromMSecsSinceStartOfDay(entry.time_ms).toString("hh:mm:ss:zzz") + ": " + entry.text;
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return static_cast<int>(rows.size());
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+    if ((role != Qt::DisplayRole) || (!index.isValid()) || (index.row() >= static_cast<int>(rows.size())))
+    {
+        return QVariant();
+    }
+
+    return getRowText(index.row());
+}
+
+bool LogModel::isShown(const Entry& entry) const
+{
+    return categories[entry.category].visible &&
+            (filterText.isEmpty() || entry.text.contains(filterText, Qt::CaseInsensitive));
+}
+
+void LogModel::rebuildRows(void)
+{
+    beginResetModel();
+
+    rows.clear();
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (isShown(entries[i]))
+        {
+            rows.push_back(firstEntryIndex + i);
+        }
+    }
+
+    endResetModel();
+}
+
+void LogModel::trimEntries(void)
+{
+    if (entries.size() <= static_cast<size_t>(maxLines))
+    {
+        return;
+    }
+
+    while (entries.size() > static_cast<size_t>(maxLines))
+    {
+        entries.pop_front();
+        firstEntryIndex++;
+        droppedLines++;
+    }
+
+    // Rows are in the same order as entries -> removed ones are at the beginning
+    auto firstKeptRow = std::lower_bound(rows.begin(), rows.end(), firstEntryIndex);
+    int numOfRemovedRows = static_cast<int>(firstKeptRow - rows.begin());
+
+    if (numOfRemovedRows > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, numOfRemovedRows - 1);
+        rows.erase(rows.begin(), firstKeptRow);
+        endRemoveRows();
+    }
+}
+
+LogView::LogView(QWidget* parent) : QListView(parent)
+{
+    setModel(&model);
+    setUniformItemSizes(true);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    flushTimer.setSingleShot(true);
+    connect(&flushTimer, &QTimer::timeout, this, &LogView::flush);
+}
+
+void LogView::addLine(const QString& line, const int category)
+{
+    model.addLine(line, category);
+
+    if (!flushTimer.isActive())
+    {
+        flushTimer.start(flushInterval);
+    }
+}
+
+void LogView::flush(void)
+{
+    flushTimer.stop();
+
+    bool followNewLines = (verticalScrollBar()->value() == verticalScrollBar()->maximum());
+
+    if (model.flushPending() && followNewLines)
+    {
+        scrollToBottom();
+    }
+
+    emit countersChanged();
+}
+
+void LogView::setPaused(const bool paused)
+{
+    model.setPaused(paused);
+    flush();
+}
+
+QString LogView::getText(void) const
+{
+    QStringList lines;
+
+    for (int row = 0; row < model.rowCount(); row++)
+    {
+        lines.append(model.getRowText(row));
+    }
+
+    return lines.join("\n");
+}
+
+void LogView::keyPressEvent(QKeyEvent* event)
+{
+    if (event->matches(QKeySequence::Copy))
+    {
+        QModelIndexList selectedRows = selectionModel()->selectedRows();
+
+        std::sort(selectedRows.begin(), selectedRows.end(),
+                  [](const QModelIndex& a, const QModelIndex& b) { return a.row() < b.row(); });
+
+        QStringList lines;
+
+        for (int i = 0; i < selectedRows.size(); i++)
+        {
+            lines.append(model.getRowText(selectedRows[i].row()));
+        }
+
+        QApplication::clipboard()->setText(lines.join("\n"));
+        return;
+    }
+
+    QListView::keyPressEvent(event);
+}
@@ -0,0 +1,155 @@
+/*
+    logview.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file logview.h
+ * @brief Declarations for a bounded log line store and a list view showing it.
+ */
+
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <deque>
+
+#include <QAbstractListModel>
+#include <QListView>
+#include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include <QKeyEvent>
+
+/**
+ * @brief Bounded (ring buffer) store of log lines with categories.
+ *
+ * Lines are first collected into a pending list and moved into the model
+ * in batches (flushPending) so that views are updated once per batch.
+ * Only lines whose category is visible and that contain the filter text are
+ * exposed as rows. Timestamps are formatted only when a row is shown.
+ *
+ * When paused, lines are still collected and counted but the rows don't change.
+ */
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogModel(QObject* parent = nullptr);       //!< Constructor
+
+    int addCategory(const QString& name);               //!< Adds a new category and returns its id
+    int getNumOfCategories(void) const { return categories.size(); }                    //!< Returns number of categories
+    QString getCategoryName(const int category) const { return categories[category].name; }        //!< Returns category's name
+    quint64 getCategoryCount(const int category) const { return categories[category].count; }      //!< Returns number of lines added to category (including dropped lines)
+    void setCategoryVisible(const int category, const bool visible);                    //!< Sets category's visibility (filtering)
+    bool isCategoryVisible(const int category) const { return categories[category].visible; }      //!< Returns true if category is visible
+
+    void addLine(const QString& line, const int category = 0);  //!< Adds line to pending lines (not shown until flushPending)
+    bool flushPending(void);                            //!< Moves pending lines to the store and updates rows. Returns true if rows were added
+
+    void setMaxLines(const int maxLines);               //!< Sets maximum number of lines stored (oldest are dropped)
+    int getMaxLines(void) const { return maxLines; }    //!< Returns maximum number of lines stored
+
+    void setPaused(const bool paused);                  //!< Pauses/resumes updating of rows (collecting continues, pending lines are moved on next flushPending)
+    bool isPaused(void) const { return paused; }        //!< Returns true if paused
+
+    void setFilterText(const QString& filterText);      //!< Shows only lines containing filterText (case insensitive). Empty = all
+    QString getFilterText(void) const { return filterText; }    //!< Returns filter text
+
+    quint64 getNumOfDroppedLines(void) const { return droppedLines; }   //!< Returns number of lines dropped because of maxLines
+    bool hasPendingLines(void) const { return !pendingEntries.empty(); }   //!< Returns true if there are lines waiting for flushPending
+
+    void clear(void);                                   //!< Removes all lines (counters are kept)
+    void clearCounters(void);                           //!< Resets per-category and dropped line counters
+
+    QString getRowText(const int row) const;            //!< Returns text shown on a row (including timestamp)
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    class Entry
+    {
+    public:
+        int time_ms = 0;                //!< Milliseconds since start of day (QTime::currentTime())
+        int category = 0;
+        QString text;
+    };
+
+    class Category
+    {
+    public:
+        QString name;
+        quint64 count = 0;
+        bool visible = true;
+    };
+
+    QVector<Category> categories;
+
+    std::deque<Entry> entries;          //!< Stored lines (oldest first)
+    quint64 firstEntryIndex = 0;        //!< Running index of entries.front()
+    std::deque<Entry> pendingEntries;   //!< Lines not yet moved to entries
+    std::deque<quint64> rows;           //!< Running indices of entries shown as rows
+
+    int maxLines = 1000;
+    bool paused = false;
+    QString filterText;
+    quint64 droppedLines = 0;
+
+    bool isShown(const Entry& entry) const;
+    void rebuildRows(void);
+    void trimEntries(void);
+};
+
+/**
+ * @brief List view showing lines of a LogModel.
+ *
+ * Only visible rows are rendered (uniform item sizes), so the cost of adding
+ * lines doesn't grow with the number of stored lines. Pending lines are
+ * flushed to the view at most every flushInterval ms.
+ * If the view is scrolled to the bottom it follows new lines.
+ * Selected lines can be copied with Ctrl+C.
+ */
+class LogView : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit LogView(QWidget* parent = nullptr);        //!< Constructor
+
+    LogModel* getModel(void) { return &model; }         //!< Returns model (for categories/filtering/counters)
+
+    int addCategory(const QString& name) { return model.addCategory(name); }   //!< Adds a new category and returns its id
+    void addLine(const QString& line, const int category = 0);                  //!< Adds line (shown on next flush)
+    void flush(void);                                   //!< Flushes pending lines to view immediately
+    void setPaused(const bool paused);                  //!< Pauses/resumes updating of the view (collecting continues)
+
+    QString getText(void) const;                        //!< Returns all visible rows as text (one row per line)
+
+    const int flushInterval = 50;                       //!< Interval for updating view (ms)
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+
+signals:
+    void countersChanged(void);                         //!< Emitted after pending lines are flushed
+
+private:
+    LogModel model;
+    QTimer flushTimer;
+};
+
+#endif // LOGVIEW_H
@@ -20,6 +20,8 @@
 #include <iostream>
 #include <QtDebug>
 
+#include "Eigen/SVD"
+
 #if 0
 inline QDebug operator<<(QDebug dbg, const Eigen::Matrix3d& m)
 {
@@ -55,17 +57,65 @@ void LOSolver::init(void)
 
 bool LOSolver::setReferencePoints(const Eigen::Vector3d refPoints[3])
 {
-    this->refPoints[0] = refPoints[0];
-    this->refPoints[1] = refPoints[1];
-    this->refPoints[2] = refPoints[2];
+    return setReferencePoints(QVector<Eigen::Vector3d>({ refPoints[0], refPoints[1], refPoints[2] }));
+}
+
+bool LOSolver::setReferencePoints(const QVector<Eigen::Vector3d>& refPoints)
+{
+    this->refPoints = refPoints;
 
     return calculateReferenceBasis();
 }
 
+void LOSolver::getReferencePoints(QVector<Eigen::Vector3d>& refPoints) const
+{
+    refPoints = this->refPoints;
+}
+
 bool LOSolver::calculateReferenceBasis(void)
 {
     errorCode = ERROR_NONE;
 
+    if (refPoints.count() < minNumOfPoints)
+    {
+        refPointsValid = false;
+        errorCode = ERROR_INVALID_REFERENCE_POINTS;
+        return false;
+    }
+
+    if (refPoints.count() != 3)
+    {
+        // Basis is not needed with least-squares fitting, only check that all points don't lie on the same line
+
+        refCentroid = Eigen::Vector3d::Zero();
+
+        for (const Eigen::Vector3d& refPoint : refPoints)
+        {
+            refCentroid += refPoint;
+        }
+
+        refCentroid /= refPoints.count();
+
+        Eigen::Matrix3d scatter = Eigen::Matrix3d::Zero();
+
+        for (const Eigen::Vector3d& refPoint : refPoints)
+        {
+            scatter += (refPoint - refCentroid) * (refPoint - refCentroid).transpose();
+        }
+
+        Eigen::Vector3d singularValues = scatter.jacobiSvd().singularValues();
+
+        if ((singularValues(0) == 0) || (singularValues(1) <= singularValues(0) * 1e-12))
+        {
+            refPointsValid = false;
+            errorCode = ERROR_INVALID_REFERENCE_POINTS;
+            return false;
+        }
+
+        refPointsValid = true;
+        return true;
+    }
+
     Eigen::Vector3d vecAtoB = refPoints[1] - refPoints[0];
     Eigen::Vector3d vecAtoC = refPoints[2] - refPoints[0];
     Eigen::Vector3d vecBtoC = refPoints[2] - refPoints[1];
@@ -154,12 +204,26 @@ bool LOSolver::calculateReferenceBasis(void)
 
 bool LOSolver::setPoints(const Eigen::Vector3d points[3])
 {
-    // Error checking is done when operating with the points
+    return setPoints(QVector<Eigen::Vector3d>({ points[0], points[1], points[2] }));
+}
+
+bool LOSolver::setPoints(const QVector<Eigen::Vector3d>& points, const QVector<bool>& validity)
+{
+    // Most of the error checking is done when operating with the points
     errorCode = ERROR_NONE;
 
-    this->points[0] = points[0];
-    this->points[1] = points[1];
-    this->points[2] = points[2];
+    this->points = points;
+    this->pointValidity = validity;
+
+    if (refPointsValid)
+    {
+        if ((points.count() != refPoints.count()) ||
+                (!validity.isEmpty() && ((validity.count() != points.count()) || (validity.count(true) < minNumOfPoints))))
+        {
+            errorCode = ERROR_NOT_ENOUGH_POINTS;
+            return false;
+        }
+    }
 
     return true;
 }
@@ -172,11 +236,81 @@ bool LOSolver::getTransformMatrix(Eigen::Transform<double, 3, Eigen::Affine>& tr
         errorCode = ERROR_INVALID_REFERENCE_POINTS;
         return false;
     }
+
+    if ((points.count() != refPoints.count()) ||
+            (!pointValidity.isEmpty() && (pointValidity.count() != points.count())))
+    {
+        errorCode = ERROR_NOT_ENOUGH_POINTS;
+        return false;
+    }
+
+    errorCode = solve(points.constData(), pointValidity.isEmpty() ? nullptr : pointValidity.constData(),
+                      transform, orientationTransform_Debug);
+
+    return errorCode == ERROR_NONE;
+}
+
+void LOSolver::solveBatch(const QVector<Eigen::Vector3d>& points, const QVector<bool>& validity,
+                          const int firstEpoch, const int numOfEpochs,
+                          QVector<Eigen::Transform<double, 3, Eigen::Affine>>& transforms,
+                          QVector<ErrorCode>& errorCodes) const
+{
+    const int numOfPoints = refPoints.count();
+
+    for (int epoch = firstEpoch; epoch < firstEpoch + numOfEpochs; epoch++)
+    {
+        if (!refPointsValid)
+        {
+            errorCodes[epoch] = ERROR_INVALID_REFERENCE_POINTS;
+        }
+        else if (((epoch + 1) * numOfPoints > points.count()) ||
+                 (!validity.isEmpty() && (validity.count() != points.count())))
+        {
+            errorCodes[epoch] = ERROR_NOT_ENOUGH_POINTS;
+        }
+        else
+        {
+            errorCodes[epoch] = solve(points.constData() + epoch * numOfPoints,
+                                      validity.isEmpty() ? nullptr : validity.constData() + epoch * numOfPoints,
+                                      transforms[epoch], nullptr);
+        }
+    }
+}
+
+LOSolver::ErrorCode LOSolver::solve(const Eigen::Vector3d* points, const bool* validity,
+                                    Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                                    Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const
+{
+    int numOfValidPoints = refPoints.count();
+
+    if (validity)
+    {
+        numOfValidPoints = 0;
+
+        for (int i = 0; i < refPoints.count(); i++)
+        {
+            numOfValidPoints += validity[i] ? 1 : 0;
+        }
+    }
+
+    if (numOfValidPoints < minNumOfPoints)
+    {
+        return ERROR_NOT_ENOUGH_POINTS;
+    }
+    else if ((refPoints.count() == 3) && (numOfValidPoints == 3))
+    {
+        return solveTriangle(points, transform, orientationTransform_Debug);
+    }
     else
     {
-        errorCode = ERROR_NONE;
+        return solveLeastSquares(points, validity, transform, orientationTransform_Debug);
     }
+}
 
+LOSolver::ErrorCode LOSolver::solveTriangle(const Eigen::Vector3d* points,
+                                            Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                                            Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const
+{
     Eigen::Vector3d vecAtoB = points[1] - points[0];
     Eigen::Vector3d vecAtoC = points[2] - points[0];
     Eigen::Vector3d vecBtoC = points[2] - points[1];
@@ -196,8 +330,7 @@ bool LOSolver::getTransformMatrix(Eigen::Transform<double, 3, Eigen::Affine>& tr
             (vecZDirection.norm() == 0))
     {
         // Some of the points are either identical or lie on the same line
-        errorCode = ERROR_INVALID_POINTS;
-        return false;
+        return ERROR_INVALID_POINTS;
     }
 
     // See comments on the calculateReferenceBasis-function for an explanation on
@@ -249,7 +382,72 @@ bool LOSolver::getTransformMatrix(Eigen::Transform<double, 3, Eigen::Affine>& tr
                 0, 0, 0, 1;
     }
 
-    return true;
+    return ERROR_NONE;
+}
+
+LOSolver::ErrorCode LOSolver::solveLeastSquares(const Eigen::Vector3d* points, const bool* validity,
+                                                Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                                                Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const
+{
+    // Rigid fit minimizing the sum of squared distances between transformed reference points
+    // and points (Kabsch). Rotation is solved from the SVD of the 3x3 cross-covariance matrix
+    // of the centered point sets, so the cost is linear in the number of points.
+
+    Eigen::Vector3d subsetRefCentroid = Eigen::Vector3d::Zero();
+    Eigen::Vector3d subsetCentroid = Eigen::Vector3d::Zero();
+    int numOfValidPoints = 0;
+
+    for (int i = 0; i < refPoints.count(); i++)
+    {
+        if (!validity || validity[i])
+        {
+            subsetRefCentroid += refPoints[i];
+            subsetCentroid += points[i];
+            numOfValidPoints++;
+        }
+    }
+
+    subsetRefCentroid /= numOfValidPoints;
+    subsetCentroid /= numOfValidPoints;
+
+    Eigen::Matrix3d crossCovariance = Eigen::Matrix3d::Zero();
+
+    for (int i = 0; i < refPoints.count(); i++)
+    {
+        if (!validity || validity[i])
+        {
+            crossCovariance += (refPoints[i] - subsetRefCentroid) * (points[i] - subsetCentroid).transpose();
+        }
+    }
+
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(crossCovariance, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d singularValues = svd.singularValues();
+
+    if ((singularValues(0) == 0) || (singularValues(1) <= singularValues(0) * 1e-12))
+    {
+        // Points (or reference points of the valid ones) are either identical or lie on the same line
+        return ERROR_INVALID_POINTS;
+    }
+
+    // Correct possible reflection to a proper rotation
+    Eigen::Matrix3d correction = Eigen::Matrix3d::Identity();
+    correction(2, 2) = (svd.matrixV() * svd.matrixU().transpose()).determinant() < 0 ? -1 : 1;
+
+    Eigen::Matrix3d rotation = svd.matrixV() * correction * svd.matrixU().transpose();
+    Eigen::Vector3d origin = subsetCentroid - rotation * subsetRefCentroid;
+
+    transform.matrix().setIdentity();
+    transform.linear() = rotation;
+    transform.translation() = origin;
+
+    if (orientationTransform_Debug)
+    {
+        orientationTransform_Debug->matrix().setIdentity();
+        orientationTransform_Debug->linear() = rotation;
+        orientationTransform_Debug->translation() = subsetCentroid;
+    }
+
+    return ERROR_NONE;
 }
 
 bool LOSolver::getYawPitchRollAngles(const Eigen::Transform<double, 3, Eigen::Affine>& transform,
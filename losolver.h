@@ -18,6 +18,8 @@
 #ifndef LOSOLVER_H
 #define LOSOLVER_H
 
+#include <QVector>
+
 #include "Eigen/Geometry"
 
 class LOSolver
@@ -32,20 +34,64 @@ public:
         ERROR_INVALID_REFERENCE_POINTS = 100,
 
         ERROR_INVALID_POINTS = 200,
+        ERROR_NOT_ENOUGH_POINTS = 201,      //!< Less than minNumOfPoints valid points (or number of points differs from reference points)
 
         ERROR_NOT_KNOWN = 0xFF
     };
 
+    static const int minNumOfPoints = 3;    //!< Minimum number of (valid) points needed to solve location/orientation
+
     LOSolver();
     void init(void);
     ErrorCode getLastError(void) { return errorCode; }
 
     bool getReferencePointsValidity(void) { return refPointsValid; }
     bool setReferencePoints(const Eigen::Vector3d refPoints[3]);
+    bool setReferencePoints(const QVector<Eigen::Vector3d>& refPoints);     //!< Any number (>= minNumOfPoints) of reference points
+    void getReferencePoints(QVector<Eigen::Vector3d>& refPoints) const;
+    int getNumOfReferencePoints(void) const { return refPoints.count(); }
+
     bool setPoints(const Eigen::Vector3d points[3]);
+
+    /**
+     * @brief Sets points (in the same order as reference points)
+     * @param points Points, count must equal the number of reference points
+     * @param validity Validity of points (empty = all valid). Invalid points (like antennas without a fix) are left out of the solution
+     * @return false if count doesn't match or less than minNumOfPoints valid points
+     */
+    bool setPoints(const QVector<Eigen::Vector3d>& points, const QVector<bool>& validity = QVector<bool>());
+
+    /**
+     * @brief Calculates transform from reference points to points
+     *
+     * With three valid points (and three reference points) orientation is calculated using a basis
+     * constructed from the triangle. Otherwise rotation is a least-squares rigid fit (Kabsch)
+     * over the valid points and location is defined by their centroid.
+     * @param transform Calculated transform
+     * @param orientationTransform_Debug Basis used for orientation (at the centroid of the points)
+     * @return true if succeeded
+     */
     bool getTransformMatrix(Eigen::Transform<double, 3, Eigen::Affine>& transform,
                             Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug = nullptr);
 
+    /**
+     * @brief Solves transforms for multiple sets of points (epochs) at once
+     *
+     * Gives the same results as setPoints + getTransformMatrix for every epoch, but doesn't
+     * change the state of the solver and is therefore safe to call from multiple threads
+     * (for different ranges of epochs). Cost is linear in the number of points.
+     * @param points Points of all epochs (getNumOfReferencePoints() consecutive points per epoch)
+     * @param validity Validity of points (same layout as points, empty = all valid)
+     * @param firstEpoch First epoch to solve
+     * @param numOfEpochs Number of epochs to solve
+     * @param transforms Transforms (indexed by epoch, must have at least firstEpoch + numOfEpochs items)
+     * @param errorCodes Error codes (indexed by epoch, must have at least firstEpoch + numOfEpochs items). ERROR_NONE = transform valid
+     */
+    void solveBatch(const QVector<Eigen::Vector3d>& points, const QVector<bool>& validity,
+                    const int firstEpoch, const int numOfEpochs,
+                    QVector<Eigen::Transform<double, 3, Eigen::Affine>>& transforms,
+                    QVector<ErrorCode>& errorCodes) const;
+
     // These expect axes convention to be NED (X=North, Y=East, Z=Down)
     bool getYawPitchRollAngles(const Eigen::Transform<double, 3, Eigen::Affine>& transform, double& yaw, double& pitch, double& roll);
     static bool getYawPitchRollAngles(Eigen::Transform<double, 3, Eigen::Affine> transform, double& yaw, double& pitch, double& roll, ErrorCode& errorCode);
@@ -56,10 +102,11 @@ private:
     Eigen::Matrix3d refBasisInverse;
 
     bool refPointsValid = false;
-    Eigen::Vector3d refPoints[3];
+    QVector<Eigen::Vector3d> refPoints;
     Eigen::Vector3d refCentroid;
 
-    Eigen::Vector3d points[3];
+    QVector<Eigen::Vector3d> points;
+    QVector<bool> pointValidity;    //!< Empty = all points valid
 
     // For speed-up when checking the validity of points:
     double refDistAB;
@@ -67,6 +114,19 @@ private:
     double refDistBC;
 
     bool calculateReferenceBasis(void);
+
+    //! Solves transform for one set of points (numOfReferencePoints items, validity may be nullptr = all valid)
+    ErrorCode solve(const Eigen::Vector3d* points, const bool* validity,
+                    Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                    Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const;
+
+    ErrorCode solveTriangle(const Eigen::Vector3d* points,
+                    Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                    Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const;  //!< Three points, all valid
+
+    ErrorCode solveLeastSquares(const Eigen::Vector3d* points, const bool* validity,
+                    Eigen::Transform<double, 3, Eigen::Affine>& transform,
+                    Eigen::Transform<double, 3, Eigen::Affine>* orientationTransform_Debug) const;  //!< Rigid fit (Kabsch)
 };
 
 #endif // LOSOLVER_H
@@ -17,12 +17,40 @@
 */
 
 #include "mainwindow.h"
+#include "PostProcessing/batchrunner.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    if (BatchRunner::isBatchModeRequested(argc, argv))
+    {
+        // Batch mode doesn't show any windows -> allow running without a display
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+
+        QApplication a(argc, argv);
+        BatchRunner batchRunner;
+
+        return batchRunner.run(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
+
+    // "--load-test [report interval (s)]": Monitor load of the realtime chain (use with "sim:..."-devices)
+    QStringList arguments = a.arguments();
+    int loadTestArgIndex = arguments.indexOf("--load-test");
+
+    if (loadTestArgIndex >= 0)
+    {
+        bool ok = false;
+        int reportInterval = (loadTestArgIndex + 1 < arguments.count()) ? arguments[loadTestArgIndex + 1].toInt(&ok) : 0;
+
+        w.enableLoadTestMode((ok && (reportInterval > 0)) ? reportInterval : 10);
+    }
+
     w.show();
 
     return a.exec();
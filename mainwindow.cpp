@@ -17,10 +17,13 @@
 */
 
 #include <QSettings>
+#include <QDebug>
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "Lidar/rplidar_sdk/include/rplidar.h"
+#include "Simulation/simulationspec.h"
+#include "Simulation/simulatedlidarsource.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -51,6 +54,14 @@ MainWindow::MainWindow(QWidget *parent) :
     }
 
     essentialsForm = new EssentialsForm(parent);
+    rtcmLatencyForm = new RTCMLatencyForm(parent);
+    tracingForm = new TracingForm(parent);
+
+    rtcmForwarder = new RTCMForwarder(this);
+    rtcmForwarder->setLatencyRecorder(rtcmLatencyForm);
+
+    connect(rtcmForwarder, &RTCMForwarder::messageCountsChanged,
+                     this, &MainWindow::rtcmForwarder_MessageCountsChanged);
 
     // This way to handle multiple rover "UI-instances" isn't pretty
     // and should be refactored somehow. Not learning new Qt-tricks needed for this now
@@ -66,6 +77,7 @@ MainWindow::MainWindow(QWidget *parent) :
     roverAUIThings.pushButton_ShowMessageWindow = ui->pushButton_ShowMessageWindow_RoverA;
     roverAUIThings.pushButton_ShowRELPOSNEDWindow = ui->pushButton_ShowRELPOSNEDForm_RoverA;
     roverAUIThings.checkBox_SuspendThread = ui->checkBox_SuspendThread_RoverA;
+    roverAUIThings.lineEdit_RTCMFilter = ui->lineEdit_RTCMFilter_RoverA;
 
     roverAUIThings.label_RELPOSNEDMessageCount = ui->label_RELPOSNEDMessageCount_RoverA;
     roverAUIThings.pushButton_ClearRELPOSNEDCounter = ui->pushButton_ClearRELPOSNEDCounter_RoverA;
@@ -77,6 +89,8 @@ MainWindow::MainWindow(QWidget *parent) :
     roverAUIThings.pushButton_ClearInfoMessage = ui->pushButton_ClearInfoMessage_RoverA;
 
     roverAUIThings.essentialsForm = essentialsForm;
+    roverAUIThings.rtcmLatencyForm = rtcmLatencyForm;
+    roverAUIThings.rtcmForwarder = rtcmForwarder;
 
     rovers[0] = new MainWinRover(parent, 0, roverAUIThings);
 
@@ -90,6 +104,7 @@ MainWindow::MainWindow(QWidget *parent) :
     roverBUIThings.pushButton_ShowMessageWindow = ui->pushButton_ShowMessageWindow_RoverB;
     roverBUIThings.pushButton_ShowRELPOSNEDWindow = ui->pushButton_ShowRELPOSNEDForm_RoverB;
     roverBUIThings.checkBox_SuspendThread = ui->checkBox_SuspendThread_RoverB;
+    roverBUIThings.lineEdit_RTCMFilter = ui->lineEdit_RTCMFilter_RoverB;
 
     roverBUIThings.label_RELPOSNEDMessageCount = ui->label_RELPOSNEDMessageCount_RoverB;
     roverBUIThings.pushButton_ClearRELPOSNEDCounter = ui->pushButton_ClearRELPOSNEDCounter_RoverB;
@@ -101,6 +116,8 @@ MainWindow::MainWindow(QWidget *parent) :
     roverBUIThings.pushButton_ClearInfoMessage = ui->pushButton_ClearInfoMessage_RoverB;
 
     roverBUIThings.essentialsForm = essentialsForm;
+    roverBUIThings.rtcmLatencyForm = rtcmLatencyForm;
+    roverBUIThings.rtcmForwarder = rtcmForwarder;
 
     rovers[1] = new MainWinRover(parent, 1, roverBUIThings);
 
@@ -114,6 +131,7 @@ MainWindow::MainWindow(QWidget *parent) :
     roverCUIThings.pushButton_ShowMessageWindow = ui->pushButton_ShowMessageWindow_RoverC;
     roverCUIThings.pushButton_ShowRELPOSNEDWindow = ui->pushButton_ShowRELPOSNEDForm_RoverC;
     roverCUIThings.checkBox_SuspendThread = ui->checkBox_SuspendThread_RoverC;
+    roverCUIThings.lineEdit_RTCMFilter = ui->lineEdit_RTCMFilter_RoverC;
 
     roverCUIThings.label_RELPOSNEDMessageCount = ui->label_RELPOSNEDMessageCount_RoverC;
     roverCUIThings.pushButton_ClearRELPOSNEDCounter = ui->pushButton_ClearRELPOSNEDCounter_RoverC;
@@ -125,6 +143,8 @@ MainWindow::MainWindow(QWidget *parent) :
     roverCUIThings.pushButton_ClearInfoMessage = ui->pushButton_ClearInfoMessage_RoverC;
 
     roverCUIThings.essentialsForm = essentialsForm;
+    roverCUIThings.rtcmLatencyForm = rtcmLatencyForm;
+    roverCUIThings.rtcmForwarder = rtcmForwarder;
 
     rovers[2] = new MainWinRover(parent, 2, roverCUIThings);
 
@@ -154,12 +174,6 @@ MainWindow::MainWindow(QWidget *parent) :
     essentialsForm->connectPostProcessingSlots(postProcessingForm);
     lidarChartForm->connectRPLidarPostProcessingSlots(postProcessingForm);
 
-    connect(&ubloxDataStreamProcessor_Base_Serial, &UBloxDataStreamProcessor::rtcmMessageReceived,
-                     this, &MainWindow::ubloxProcessor_Base_rtcmMessageReceived_Serial);
-
-    connect(&ubloxDataStreamProcessor_Base_NTRIP, &UBloxDataStreamProcessor::rtcmMessageReceived,
-                     this, &MainWindow::ubloxProcessor_Base_rtcmMessageReceived_NTRIP);
-
     licencesForm = new LicensesForm(parent);
 
     QSettings settings;
@@ -205,6 +219,8 @@ MainWindow::~MainWindow()
     delete essentialsForm;
     delete postProcessingForm;
     delete licencesForm;
+    delete rtcmLatencyForm;
+    delete tracingForm;
 
     delete ui;
 }
@@ -250,6 +266,8 @@ void MainWindow::closeEvent (QCloseEvent *event)
 
     essentialsForm->close();
     postProcessingForm->close();
+    rtcmLatencyForm->close();
+    tracingForm->close();
 
     messageMonitorForm_LaserDist->close();
     messageMonitorForm_RPLidar->close();
@@ -273,6 +291,12 @@ void MainWindow::closeEvent (QCloseEvent *event)
         serialThread_LaserDist = nullptr;
     }
 
+    if (simulatedDevice_LaserDist)
+    {
+        delete simulatedDevice_LaserDist;
+        simulatedDevice_LaserDist = nullptr;
+    }
+
     if (thread_RPLidar)
     {
         thread_RPLidar->wait(5000);
@@ -286,11 +310,39 @@ void MainWindow::closeEvent (QCloseEvent *event)
             rovers[i]->serialThread->wait(5000);
             rovers[i]->serialThread = nullptr;
         }
+
+        if (rovers[i]->simulatedDevice)
+        {
+            delete rovers[i]->simulatedDevice;
+            rovers[i]->simulatedDevice = nullptr;
+        }
     }
 
     event->accept();
 }
 
+void MainWindow::enableLoadTestMode(const int reportInterval_s)
+{
+    if (loadMonitor)
+    {
+        return;
+    }
+
+    loadMonitor = new RealtimeLoadMonitor(this);
+
+    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
+    {
+        rovers[i]->extUIThings.loadMonitor = loadMonitor;
+    }
+
+    connect(&loadReportTimer, &QTimer::timeout, this, [this]()
+    {
+        qInfo().noquote() << loadMonitor->getReport();
+    });
+
+    loadReportTimer.start(reportInterval_s * 1000);
+}
+
 void MainWindow::ubloxProcessor_Rover_ubxMessageReceived(const UBXMessage& ubxMessage, const unsigned int roverId)
 {
     if (roverId < sizeof(rovers) / sizeof(rovers[0]))
@@ -329,25 +381,18 @@ void MainWindow::commThread_Base_SerialTimeout(void)
     ubloxDataStreamProcessor_Base_Serial.flushInputBuffer();
 }
 
-void MainWindow::ubloxProcessor_Base_rtcmMessageReceived_Serial(const RTCMMessage& rtcmMessage)
+void MainWindow::rtcmForwarder_MessageCountsChanged(const int count_Serial, const int count_NTRIP)
 {
-    messageCounter_RTCM_Base_Serial++;
-    ui->label_RTCMMessageCount_Base_Serial->setText(QString::number(messageCounter_RTCM_Base_Serial));
-
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
-    {
-        if (rovers[i]->serialThread)
-        {
-            rovers[i]->serialThread->addToSendQueue(rtcmMessage.rawMessage);
-        }
-    }
+    ui->label_RTCMMessageCount_Base_Serial->setText(QString::number(count_Serial));
+    ui->label_RTCMMessageCount_Base_NTRIP->setText(QString::number(count_NTRIP));
 }
 
 void MainWindow::on_pushButton_StartThread_Base_Serial_clicked()
 {
     if (!serialThread_Base)
     {
-        serialThread_Base = new SerialThread(ui->lineEdit_SerialPort_Base->text(), 20, 1, ui->spinBox_SerialSpeed_Base->value());
+        // Data is forwarded to rovers per read by rtcmForwarder -> GUI can get bigger chunks
+        serialThread_Base = new SerialThread(ui->lineEdit_SerialPort_Base->text(), 20, 256, ui->spinBox_SerialSpeed_Base->value());
         if (ui->checkBox_SuspendThread_Base_Serial->isChecked())
         {
             serialThread_Base->suspend();
@@ -370,6 +415,7 @@ void MainWindow::on_pushButton_StartThread_Base_Serial_clicked()
 
         messageMonitorForm_Base_Serial->connectSerialThreadSlots(serialThread_Base);
         essentialsForm->connectSerialThreadSlots_Base(serialThread_Base);
+        rtcmForwarder->connectSerialThreadSlots_Base(serialThread_Base);
 
         serialThread_Base->start();
 
@@ -380,8 +426,6 @@ void MainWindow::on_pushButton_StartThread_Base_Serial_clicked()
         ui->pushButton_StartThread_Base_NTRIP->setEnabled(false);
         ui->pushButton_TerminateThread_NTRIP->setEnabled(false);
 
-        messageCounter_RTCM_Base_Serial = 0;
-        ui->label_RTCMMessageCount_Base_Serial->setText(QString::number(messageCounter_RTCM_Base_Serial));
         ui->label_LastInfoMessage_Base_Serial->setText("");
         ui->label_LastWarningMessage_Base_Serial->setText("");
         ui->label_LastErrorMessage_Base_Serial->setText("");
@@ -412,6 +456,7 @@ void MainWindow::on_pushButton_TerminateThread_Base_Serial_clicked()
 
         messageMonitorForm_Base_Serial->disconnectSerialThreadSlots(serialThread_Base);
         essentialsForm->disconnectSerialThreadSlots_Base(serialThread_Base);
+        rtcmForwarder->disconnectSerialThreadSlots_Base(serialThread_Base);
 
         delete serialThread_Base;
         serialThread_Base = nullptr;
@@ -449,8 +494,7 @@ void MainWindow::on_pushButton_ShowMessageWindow_Base_Serial_clicked()
 
 void MainWindow::on_pushButton_ClearRTCMCounter_Base_Serial_clicked()
 {
-    messageCounter_RTCM_Base_Serial = 0;
-    ui->label_RTCMMessageCount_Base_Serial->setText(QString::number(messageCounter_RTCM_Base_Serial));
+    rtcmForwarder->clearMessageCount(RTCMLatencyStatistics::SOURCE_SERIAL);
 }
 
 void MainWindow::on_pushButton_ClearErrorMessage_Base_Serial_clicked()
@@ -509,6 +553,7 @@ void MainWindow::on_pushButton_StartThread_Base_NTRIP_clicked()
 
         messageMonitorForm_Base_NTRIP->connectNTRIPThreadSlots(ntripThread);
         essentialsForm->connectNTRIPThreadSlots_Base(ntripThread);
+        rtcmForwarder->connectNTRIPThreadSlots_Base(ntripThread);
 
         ntripThread->start();
 
@@ -518,8 +563,6 @@ void MainWindow::on_pushButton_StartThread_Base_NTRIP_clicked()
         ui->pushButton_StartThread_Base_NTRIP->setEnabled(false);
         ui->pushButton_TerminateThread_NTRIP->setEnabled(true);
 
-        messageCounter_RTCM_Base_NTRIP = 0;
-        ui->label_RTCMMessageCount_Base_NTRIP->setText(QString::number(messageCounter_RTCM_Base_NTRIP));
         ui->label_LastInfoMessage_Base_NTRIP->setText("");
         ui->label_LastWarningMessage_Base_NTRIP->setText("");
         ui->label_LastErrorMessage_Base_NTRIP->setText("");
@@ -541,32 +584,12 @@ void MainWindow::ntripThread_Base_WarningMessage(const QString& warningMessage)
     ui->label_LastWarningMessage_Base_NTRIP->setText(warningMessage.trimmed());
 }
 
-void MainWindow::ntripThread_Base_DataReceived(const QByteArray& data)
+void MainWindow::ntripThread_Base_DataReceived(const QByteArray& data, qint64 receiveTime)
 {
-    QElapsedTimer timer;
-
-    timer.start();
-
-    qint64 timestamp = timer.msecsSinceReference();
-
-    ubloxDataStreamProcessor_Base_NTRIP.process(data, timestamp, timestamp);
+    // Only for monitoring, rtcmForwarder forwards messages to rovers in NTRIP-thread
+    ubloxDataStreamProcessor_Base_NTRIP.process(data, receiveTime, receiveTime);
 }
 
-void MainWindow::ubloxProcessor_Base_rtcmMessageReceived_NTRIP(const RTCMMessage& rtcmMessage)
-{
-    messageCounter_RTCM_Base_NTRIP++;
-    ui->label_RTCMMessageCount_Base_NTRIP->setText(QString::number(messageCounter_RTCM_Base_NTRIP));
-
-    for (unsigned int i = 0; i < sizeof(rovers) / sizeof(rovers[0]); i++)
-    {
-        if (rovers[i]->serialThread)
-        {
-            rovers[i]->serialThread->addToSendQueue(rtcmMessage.rawMessage);
-        }
-    }
-}
-
-
 void MainWindow::ntripThread_Base_ThreadEnded(void)
 {
     if (ntripThread)
@@ -593,6 +616,7 @@ void MainWindow::ntripThread_Base_ThreadEnded(void)
 
         messageMonitorForm_Base_NTRIP->disconnectNTRIPThreadSlots(ntripThread);
         essentialsForm->disconnectNTRIPThreadSlots_Base(ntripThread);
+        rtcmForwarder->disconnectNTRIPThreadSlots_Base(ntripThread);
 
         delete ntripThread;
         ntripThread = nullptr;
@@ -614,8 +638,7 @@ void MainWindow::on_pushButton_ShowMessageWindow_NTRIP_clicked()
 
 void MainWindow::on_pushButton_ClearRTCMCounter_Base_NTRIP_clicked()
 {
-    messageCounter_RTCM_Base_NTRIP = 0;
-    ui->label_RTCMMessageCount_Base_NTRIP->setText(QString::number(messageCounter_RTCM_Base_NTRIP));
+    rtcmForwarder->clearMessageCount(RTCMLatencyStatistics::SOURCE_NTRIP);
 }
 
 void MainWindow::on_pushButton_ClearErrorMessage_Base_NTRIP_clicked()
@@ -660,6 +683,7 @@ void MainWindow::on_pushButton_TerminateThread_NTRIP_clicked()
 
         messageMonitorForm_Base_NTRIP->disconnectNTRIPThreadSlots(ntripThread);
         essentialsForm->disconnectNTRIPThreadSlots_Base(ntripThread);
+        rtcmForwarder->disconnectNTRIPThreadSlots_Base(ntripThread);
 
         delete ntripThread;
         ntripThread = nullptr;
@@ -677,7 +701,36 @@ void MainWindow::on_pushButton_StartThread_LaserDist_clicked()
 {
     if (!serialThread_LaserDist)
     {
-        serialThread_LaserDist = new LaserRangeFinder20HzV2SerialThread(ui->lineEdit_SerialPort_LaserDist->text(), ui->doubleSpinBox_DistanceOffset_LaserDist->value(), LaserRangeFinder20HzV2SerialThread::RESOLUTION_01mm);
+        QString serialPortName = ui->lineEdit_SerialPort_LaserDist->text();
+
+        if (SimulationSpec::isSimulationSpec(serialPortName))
+        {
+            QString errorString;
+
+            simulatedDevice_LaserDist = SimulatedSerialDevice::createFromSpec(serialPortName, SimulatedSerialDevice::DEVICE_LASERRANGEFINDER20HZV2, 0, errorString);
+
+            if ((!simulatedDevice_LaserDist) || (!simulatedDevice_LaserDist->openPseudoTerminal(errorString)))
+            {
+                delete simulatedDevice_LaserDist;
+                simulatedDevice_LaserDist = nullptr;
+                commThread_LaserRangeFinder20HzV2_ErrorMessage("Simulation: " + errorString);
+                return;
+            }
+
+            connect(simulatedDevice_LaserDist, &SimulatedSerialDevice::infoMessage,
+                             this, &MainWindow::commThread_LaserRangeFinder20HzV2_InfoMessage);
+
+            connect(simulatedDevice_LaserDist, &SimulatedSerialDevice::warningMessage,
+                             this, &MainWindow::commThread_LaserRangeFinder20HzV2_WarningMessage);
+
+            connect(simulatedDevice_LaserDist, &SimulatedSerialDevice::errorMessage,
+                             this, &MainWindow::commThread_LaserRangeFinder20HzV2_ErrorMessage);
+
+            simulatedDevice_LaserDist->start();
+            serialPortName = simulatedDevice_LaserDist->getPortName();
+        }
+
+        serialThread_LaserDist = new LaserRangeFinder20HzV2SerialThread(serialPortName, ui->doubleSpinBox_DistanceOffset_LaserDist->value(), LaserRangeFinder20HzV2SerialThread::RESOLUTION_01mm);
         if (ui->checkBox_SuspendThread_LaserDist->isChecked())
         {
             serialThread_LaserDist->suspend();
@@ -704,6 +757,19 @@ void MainWindow::on_pushButton_StartThread_LaserDist_clicked()
         messageMonitorForm_LaserDist->connectSerialThreadSlots(serialThread_LaserDist);
         essentialsForm->connectLaserRangeFinder20HzV2SerialThreadSlots(serialThread_LaserDist);
 
+        if (loadMonitor)
+        {
+            SimulatedSerialDevice* simulatedDevice = simulatedDevice_LaserDist;
+            std::function<qint64(void)> dropCounter = nullptr;
+
+            if (simulatedDevice)
+            {
+                dropCounter = [simulatedDevice]() { return simulatedDevice->getStatistics().numOfFramesDropped; };
+            }
+
+            loadMonitor->addChannel("Laser distances", serialThread_LaserDist, &LaserRangeFinder20HzV2SerialThread::distanceReceived, dropCounter);
+        }
+
         serialThread_LaserDist->start();
 
         ui->lineEdit_SerialPort_LaserDist->setEnabled(false);
@@ -801,9 +867,20 @@ void MainWindow::on_pushButton_TerminateThread_LaserDist_clicked()
         messageMonitorForm_LaserDist->disconnectSerialThreadSlots(serialThread_LaserDist);
         essentialsForm->disconnectLaserRangeFinder20HzV2SerialThreadSlots(serialThread_LaserDist);
 
+        if (loadMonitor)
+        {
+            loadMonitor->removeChannels("Laser distances");
+        }
+
         delete serialThread_LaserDist;
         serialThread_LaserDist = nullptr;
 
+        if (simulatedDevice_LaserDist)
+        {
+            delete simulatedDevice_LaserDist;
+            simulatedDevice_LaserDist = nullptr;
+        }
+
         ui->lineEdit_SerialPort_LaserDist->setEnabled(true);
         ui->doubleSpinBox_DistanceOffset_LaserDist->setEnabled(true);
         ui->pushButton_StartThread_LaserDist->setEnabled(true);
@@ -872,9 +949,15 @@ MainWinRover::MainWinRover(QWidget *parent, const int index, const ExtUIThings&
     connect(extUIThings.pushButton_ClearInfoMessage, &QAbstractButton::clicked,
                      this, &MainWinRover::on_pushButton_ClearInfoMessage_clicked);
 
+    connect(extUIThings.lineEdit_RTCMFilter, &QLineEdit::editingFinished,
+                     this, &MainWinRover::on_lineEdit_RTCMFilter_editingFinished);
+
     QSettings settings;
     extUIThings.lineEdit_SerialPort->setText(settings.value("SerialPort_Rover" + roverString, "\\\\.\\COM").toString());
     extUIThings.spinBox_SerialSpeed->setValue(settings.value("SerialSpeed_Rover" + roverString, "115200").toInt());
+    extUIThings.lineEdit_RTCMFilter->setText(settings.value("RTCMFilter_Rover" + roverString, "").toString());
+
+    applyRTCMFilter();
 }
 
 MainWinRover::~MainWinRover()
@@ -884,6 +967,7 @@ MainWinRover::~MainWinRover()
     QSettings settings;
     settings.setValue("SerialPort_Rover" + roverString, extUIThings.lineEdit_SerialPort->text());
     settings.setValue("SerialSpeed_Rover" + roverString, extUIThings.spinBox_SerialSpeed->value());
+    settings.setValue("RTCMFilter_Rover" + roverString, extUIThings.lineEdit_RTCMFilter->text());
 
     delete messageMonitorForm;
     delete relposnedForm;
@@ -893,7 +977,36 @@ void MainWinRover::startSerialThread(void)
 {
     if (!serialThread)
     {
-        serialThread = new SerialThread(extUIThings.lineEdit_SerialPort->text(), 20, 1, extUIThings.spinBox_SerialSpeed->value());
+        QString serialPortName = extUIThings.lineEdit_SerialPort->text();
+
+        if (SimulationSpec::isSimulationSpec(serialPortName))
+        {
+            QString errorString;
+
+            simulatedDevice = SimulatedSerialDevice::createFromSpec(serialPortName, SimulatedSerialDevice::DEVICE_UBLOX_ROVER, static_cast<unsigned int>(index), errorString);
+
+            if ((!simulatedDevice) || (!simulatedDevice->openPseudoTerminal(errorString)))
+            {
+                delete simulatedDevice;
+                simulatedDevice = nullptr;
+                commThread_ErrorMessage("Simulation: " + errorString);
+                return;
+            }
+
+            connect(simulatedDevice, &SimulatedSerialDevice::infoMessage,
+                             this, &MainWinRover::commThread_InfoMessage);
+
+            connect(simulatedDevice, &SimulatedSerialDevice::warningMessage,
+                             this, &MainWinRover::commThread_WarningMessage);
+
+            connect(simulatedDevice, &SimulatedSerialDevice::errorMessage,
+                             this, &MainWinRover::commThread_ErrorMessage);
+
+            simulatedDevice->start();
+            serialPortName = simulatedDevice->getPortName();
+        }
+
+        serialThread = new SerialThread(serialPortName, 20, 1, extUIThings.spinBox_SerialSpeed->value());
         if (extUIThings.checkBox_SuspendThread->isChecked())
         {
             serialThread->suspend();
@@ -915,6 +1028,21 @@ void MainWinRover::startSerialThread(void)
                          this, &MainWinRover::commThread_SerialTimeout);
 
         messageMonitorForm->connectSerialThreadSlots(serialThread);
+        extUIThings.rtcmLatencyForm->connectSerialThreadSlots_Rover(serialThread, index);
+        extUIThings.rtcmForwarder->setRoverSerialThread(index, serialThread);
+
+        if (extUIThings.loadMonitor)
+        {
+            SimulatedSerialDevice* device = simulatedDevice;
+            std::function<qint64(void)> dropCounter = nullptr;
+
+            if (device)
+            {
+                dropCounter = [device]() { return device->getStatistics().numOfFramesDropped; };
+            }
+
+            extUIThings.loadMonitor->addChannel("Rover " + getRoverIdentString(index) + " data", serialThread, &SerialThread::dataReceived, dropCounter);
+        }
 
         extUIThings.lineEdit_SerialPort->setEnabled(false);
         extUIThings.spinBox_SerialSpeed->setEnabled(false);
@@ -935,6 +1063,9 @@ void MainWinRover::terminateSerialThread(void)
 {
     if (serialThread)
     {
+        // No more messages from base after this
+        extUIThings.rtcmForwarder->setRoverSerialThread(index, nullptr);
+
         serialThread->requestTerminate();
         serialThread->wait(5000);
 
@@ -954,10 +1085,22 @@ void MainWinRover::terminateSerialThread(void)
                          this, &MainWinRover::commThread_SerialTimeout);
 
         messageMonitorForm->disconnectSerialThreadSlots(serialThread);
+        extUIThings.rtcmLatencyForm->disconnectSerialThreadSlots_Rover(serialThread, index);
+
+        if (extUIThings.loadMonitor)
+        {
+            extUIThings.loadMonitor->removeChannels("Rover " + getRoverIdentString(index) + " data");
+        }
 
         delete serialThread;
         serialThread = nullptr;
 
+        if (simulatedDevice)
+        {
+            delete simulatedDevice;
+            simulatedDevice = nullptr;
+        }
+
         extUIThings.lineEdit_SerialPort->setEnabled(true);
         extUIThings.spinBox_SerialSpeed->setEnabled(true);
         extUIThings.pushButton_StartThread->setEnabled(true);
@@ -1084,11 +1227,57 @@ void MainWinRover::on_pushButton_ClearInfoMessage_clicked(bool)
     extUIThings.label_LastInfoMessage->setText("");
 }
 
+void MainWinRover::on_lineEdit_RTCMFilter_editingFinished(void)
+{
+    applyRTCMFilter();
+}
+
+void MainWinRover::applyRTCMFilter(void)
+{
+    RTCMEpochBundler::Settings settings;
+    QString errorString;
+
+    if (!RTCMEpochBundler::parseSettings(extUIThings.lineEdit_RTCMFilter->text(), settings, errorString))
+    {
+        extUIThings.label_LastErrorMessage->setText("RTCM filter: " + errorString + " Previous filter still in use.");
+        return;
+    }
+
+    extUIThings.rtcmForwarder->setRoverSettings(static_cast<unsigned int>(index), settings);
+}
+
 void MainWindow::on_pushButton_StartThread_RPLidar_clicked()
 {
     if (!thread_RPLidar)
     {
-        thread_RPLidar = new RPLidarThread(ui->lineEdit_SerialPort_RPLidar->text(), ui->spinBox_SerialSpeed_RPLidar->value(), ui->spinBox_MotorPWM_RPLidar->value(), ui->comboBox_ExpressScanMode->currentIndex() - 1);
+        if (SimulationSpec::isSimulationSpec(ui->lineEdit_SerialPort_RPLidar->text()))
+        {
+            SimulatedLidarSource::Params simulationParams;
+            QString errorString;
+
+            if (!simulationParams.parse(ui->lineEdit_SerialPort_RPLidar->text(), errorString))
+            {
+                thread_RPLidar_ErrorMessage("Simulation: " + errorString);
+                return;
+            }
+
+            SimulatedLidarSource* simulatedSource = new SimulatedLidarSource(simulationParams);
+
+            if (!simulatedSource->open(errorString))
+            {
+                delete simulatedSource;
+                thread_RPLidar_ErrorMessage("Simulation: " + errorString);
+                return;
+            }
+
+            // Thread takes ownership of the source
+            thread_RPLidar = new RPLidarThread(simulatedSource);
+        }
+        else
+        {
+            thread_RPLidar = new RPLidarThread(ui->lineEdit_SerialPort_RPLidar->text(), ui->spinBox_SerialSpeed_RPLidar->value(), ui->spinBox_MotorPWM_RPLidar->value(), ui->comboBox_ExpressScanMode->currentIndex() - 1);
+        }
+
         if (ui->checkBox_SuspendThread_RPLidar->isChecked())
         {
             thread_RPLidar->suspend();
@@ -1110,6 +1299,13 @@ void MainWindow::on_pushButton_StartThread_RPLidar_clicked()
         lidarChartForm->connectRPLidarThreadSlots(thread_RPLidar);
         essentialsForm->connectRPLidarThreadSlots(thread_RPLidar);
 
+        if (loadMonitor)
+        {
+            RPLidarThread* lidarThread = thread_RPLidar;
+            loadMonitor->addChannel("Lidar rounds", lidarThread, &RPLidarThread::distanceRoundReceived,
+                                    [lidarThread]() { return lidarThread->getNumOfDroppedRounds(); });
+        }
+
         thread_RPLidar->start();
 
         ui->lineEdit_SerialPort_RPLidar->setEnabled(false);
@@ -1147,6 +1343,11 @@ void MainWindow::on_pushButton_TerminateThread_RPLidar_clicked()
         lidarChartForm->disconnectRPLidarThreadSlots(thread_RPLidar);
         essentialsForm->disconnectRPLidarThreadSlots(thread_RPLidar);
 
+        if (loadMonitor)
+        {
+            loadMonitor->removeChannels("Lidar rounds");
+        }
+
         delete thread_RPLidar;
         thread_RPLidar = nullptr;
 
@@ -1254,3 +1455,17 @@ void MainWindow::on_actionLicenses_triggered()
     licencesForm->raise();
     licencesForm->activateWindow();
 }
+
+void MainWindow::on_actionRTCMLatency_triggered()
+{
+    rtcmLatencyForm->show();
+    rtcmLatencyForm->raise();
+    rtcmLatencyForm->activateWindow();
+}
+
+void MainWindow::on_actionTracing_triggered()
+{
+    tracingForm->show();
+    tracingForm->raise();
+    tracingForm->activateWindow();
+}
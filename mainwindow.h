@@ -43,6 +43,11 @@
 #include "Lidar/rplidarmessagemonitorform.h"
 #include "Lidar/lidarchartform.h"
 #include "licensesform.h"
+#include "rtcmlatencyform.h"
+#include "tracingform.h"
+#include "rtcmforwarder.h"
+#include "Simulation/simulatedserialdevice.h"
+#include "Simulation/realtimeloadmonitor.h"
 
 class MainWinRover : public QObject
 {
@@ -61,6 +66,7 @@ public:
         QPushButton* pushButton_ShowMessageWindow = nullptr;
         QPushButton* pushButton_ShowRELPOSNEDWindow = nullptr;
         QCheckBox* checkBox_SuspendThread = nullptr;
+        QLineEdit* lineEdit_RTCMFilter = nullptr;
 
         QLabel* label_RELPOSNEDMessageCount = nullptr;
         QPushButton* pushButton_ClearRELPOSNEDCounter = nullptr;
@@ -72,6 +78,9 @@ public:
         QPushButton* pushButton_ClearInfoMessage = nullptr;
 
         EssentialsForm* essentialsForm = nullptr;
+        RTCMLatencyForm* rtcmLatencyForm = nullptr;
+        RTCMForwarder* rtcmForwarder = nullptr;
+        RealtimeLoadMonitor* loadMonitor = nullptr;
 
     };
 
@@ -86,6 +95,7 @@ public:
 
     MessageMonitorForm* messageMonitorForm = nullptr;
     SerialThread* serialThread = nullptr;
+    SimulatedSerialDevice* simulatedDevice = nullptr;   //!< Used when serial port is given as a simulation spec ("sim:...")
     UBloxDataStreamProcessor ubloxDataStreamProcessor;
     int messageCounter_RELPOSNED = 0;
     RELPOSNEDForm* relposnedForm = nullptr;
@@ -110,6 +120,10 @@ private slots:
     void on_pushButton_ClearWarningMessage_clicked(bool);
     void on_pushButton_ClearInfoMessage_clicked(bool);
     void on_pushButton_ShowRELPOSNEDWindow_clicked(bool);
+    void on_lineEdit_RTCMFilter_editingFinished(void);
+
+private:
+    void applyRTCMFilter(void);     //!< Parses RTCM filter and passes it to rtcmForwarder
 
     friend class MainWindow;
 };
@@ -131,6 +145,16 @@ public:
     explicit MainWindow(QWidget *parent = nullptr); //!< Constructor
     ~MainWindow();
 
+    /**
+     * @brief Enables load test mode
+     *
+     * Load of the realtime chain (GUI-thread latency, queued and dropped data) is monitored
+     * and reported periodically to the console. Meant to be used with simulated devices
+     * ("sim:..." as serial port name, see SimulationSpec).
+     * @param reportInterval_s Interval of reports
+     */
+    void enableLoadTestMode(const int reportInterval_s);
+
 private slots:
 
     void commThread_Base_ErrorMessage(const QString& errorMessage);
@@ -138,14 +162,14 @@ private slots:
     void commThread_Base_InfoMessage(const QString& infoMessage);
     void commThread_Base_DataReceived(const QByteArray& data, const qint64 firstCharTime, const qint64 lastCharTime, const SerialThread::DataReceivedEmitReason &);
     void commThread_Base_SerialTimeout(void);
-    void ubloxProcessor_Base_rtcmMessageReceived_Serial(const RTCMMessage&);
 
     void ntripThread_Base_ErrorMessage(const QString& errorMessage);
     void ntripThread_Base_WarningMessage(const QString& warningMessage);
     void ntripThread_Base_InfoMessage(const QString& infoMessage);
-    void ntripThread_Base_DataReceived(const QByteArray& byte);
+    void ntripThread_Base_DataReceived(const QByteArray& byte, qint64 receiveTime);
     void ntripThread_Base_ThreadEnded(void);
-    void ubloxProcessor_Base_rtcmMessageReceived_NTRIP(const RTCMMessage&);
+
+    void rtcmForwarder_MessageCountsChanged(const int count_Serial, const int count_NTRIP);
 
     void commThread_LaserRangeFinder20HzV2_ErrorMessage(const QString& errorMessage);
     void commThread_LaserRangeFinder20HzV2_WarningMessage(const QString& warningMessage);
@@ -226,6 +250,10 @@ private slots:
 
     void on_actionLicenses_triggered();
 
+    void on_actionRTCMLatency_triggered();
+
+    void on_actionTracing_triggered();
+
 signals:
     void distanceChanged(const EssentialsForm::DistanceItem&);  //!< Signal emitted when distance changes
 
@@ -238,15 +266,14 @@ private:
     MessageMonitorForm* messageMonitorForm_Base_Serial = nullptr;
     SerialThread* serialThread_Base = nullptr;
     UBloxDataStreamProcessor ubloxDataStreamProcessor_Base_Serial;
-    int messageCounter_RTCM_Base_Serial;
 
     MessageMonitorForm* messageMonitorForm_Base_NTRIP = nullptr;
     NTRIPThread* ntripThread = nullptr;
     UBloxDataStreamProcessor ubloxDataStreamProcessor_Base_NTRIP;
-    int messageCounter_RTCM_Base_NTRIP;
 
     LaserRangeFinder20HzV2MessageMonitorForm* messageMonitorForm_LaserDist = nullptr;
     LaserRangeFinder20HzV2SerialThread* serialThread_LaserDist = nullptr;
+    SimulatedSerialDevice* simulatedDevice_LaserDist = nullptr;
     int messageCounter_LaserDist_Distance;
 
     RPLidarMessageMonitorForm* messageMonitorForm_RPLidar = nullptr;
@@ -260,6 +287,14 @@ private:
 
     LicensesForm* licencesForm = nullptr;
 
+    RTCMLatencyForm* rtcmLatencyForm = nullptr;
+    TracingForm* tracingForm = nullptr;
+
+    RTCMForwarder* rtcmForwarder = nullptr;     //!< Forwards RTCM-messages from base to rovers outside of GUI-thread
+
+    RealtimeLoadMonitor* loadMonitor = nullptr; //!< Load test mode (nullptr if not enabled)
+    QTimer loadReportTimer;
+
     void closeEvent (QCloseEvent *event);
 
 };
@@ -33,6 +33,47 @@ MessageMonitorForm::MessageMonitorForm(QWidget *parent, const QString& title) :
 {
     ui->setupUi(this);
     this->setWindowTitle(title);
+
+    // Categories in the same order as LogCategory
+    ui->logView_Output->addCategory("NMEA");
+    ui->logView_Output->addCategory("UBX");
+    ui->logView_Output->addCategory("RTCM");
+    ui->logView_Output->addCategory("UBX parse errors");
+    ui->logView_Output->addCategory("NMEA parse errors");
+    ui->logView_Output->addCategory("Unidentified data");
+    ui->logView_Output->addCategory("Thread messages");
+
+    // Category checkboxes only filter what is shown, all messages are collected and counted
+    const struct
+    {
+        QCheckBox* checkBox;
+        LogCategory category;
+    } categoryCheckBoxes[] =
+    {
+        { ui->checkBox_NMEA, CATEGORY_NMEA },
+        { ui->checkBox_UBX, CATEGORY_UBX },
+        { ui->checkBox_RTCM, CATEGORY_RTCM },
+        { ui->checkBox_UBXParseErrors, CATEGORY_UBXPARSEERROR },
+        { ui->checkBox_NMEAParseErrors, CATEGORY_NMEAPARSEERROR },
+        { ui->checkBox_UnidentifiedData, CATEGORY_UNIDENTIFIEDDATA },
+    };
+
+    for (unsigned int i = 0; i < sizeof(categoryCheckBoxes) / sizeof(categoryCheckBoxes[0]); i++)
+    {
+        QCheckBox* checkBox = categoryCheckBoxes[i].checkBox;
+        LogCategory category = categoryCheckBoxes[i].category;
+
+        ui->logView_Output->getModel()->setCategoryVisible(category, checkBox->isChecked());
+
+        connect(checkBox, &QCheckBox::stateChanged, this, [=](int state)
+        {
+            ui->logView_Output->getModel()->setCategoryVisible(category, state == Qt::Checked);
+        });
+    }
+
+    ui->logView_Output->getModel()->setMaxLines(ui->spinBox_MaxLines->value());
+
+    connect(ui->logView_Output, &LogView::countersChanged, this, &MessageMonitorForm::logView_CountersChanged);
 }
 
 MessageMonitorForm::~MessageMonitorForm()
@@ -40,26 +81,45 @@ MessageMonitorForm::~MessageMonitorForm()
     delete ui;
 }
 
-void MessageMonitorForm::addLogLine(const QString& line)
+void MessageMonitorForm::addLogLine(const QString& line, const LogCategory category)
 {
-    //ui->listWidget->selectionBehavior()
+    ui->logView_Output->addLine(line, category);
+}
 
-    QTime currentTime = QTime::currentTime();
+void MessageMonitorForm::logView_CountersChanged(void)
+{
+    const LogModel* model = ui->logView_Output->getModel();
 
-    QString timeString = currentTime.toString("hh:mm:ss:zzz");
+    QString counters;
+
+    for (int i = 0; i < model->getNumOfCategories(); i++)
+    {
+        counters += model->getCategoryName(i) + ": " + QString::number(model->getCategoryCount(i)) + ", ";
+    }
+
+    counters += "dropped: " + QString::number(model->getNumOfDroppedLines());
+
+    ui->label_Counters->setText(counters);
+}
+
+void MessageMonitorForm::on_checkBox_PauseView_stateChanged(int arg1)
+{
+    ui->logView_Output->setPaused(arg1 == Qt::Checked);
+}
+
+void MessageMonitorForm::on_spinBox_MaxLines_valueChanged(int arg1)
+{
+    ui->logView_Output->getModel()->setMaxLines(arg1);
+}
 
-    ui->plainTextEdit_Output->setMaximumBlockCount(ui->spinBox_MaxLines->value());
-    ui->plainTextEdit_Output->setCenterOnScroll(ui->checkBox_PagedScroll->isChecked());
-    ui->plainTextEdit_Output->setWordWrapMode(QTextOption::NoWrap);
-    ui->plainTextEdit_Output->appendPlainText(timeString + ": " + line);
+void MessageMonitorForm::on_lineEdit_Filter_textChanged(const QString& arg1)
+{
+    ui->logView_Output->getModel()->setFilterText(arg1);
 }
 
 void MessageMonitorForm::ubloxProcessor_nmeaSentenceReceived(const NMEAMessage& nmeaSentence)
 {
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_NMEA->checkState()))
-    {
-        addLogLine(QString("NMEA: ") + nmeaSentence.rawMessage.trimmed());
-    }
+    addLogLine(QString("NMEA: ") + nmeaSentence.rawMessage.trimmed(), CATEGORY_NMEA);
 }
 
 void MessageMonitorForm::ubloxProcessor_ubxMessageReceived(const UBXMessage& ubxMessage)
@@ -83,84 +143,69 @@ void MessageMonitorForm::ubloxProcessor_ubxMessageReceived(const UBXMessage& ubx
         lastRELPOSNEDMessageEndTime = ubxMessage.messageEndTime;
     }
 
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_UBX->checkState()))
-    {
-        QString messageTypeString = "Unhandled";
-
-        if (relposned.messageDataStatus == UBXMessage::STATUS_VALID)
-        {
-            messageTypeString = "RELPOSNED";
-        }
+    QString messageTypeString = "Unhandled";
 
-        addLogLine(QString("UBX message received. Payload length: ") + QString::number(ubxMessage.payloadLength) +
-                   ", class: " + QString::number(ubxMessage.messageClass) +
-                   ", id: " + QString::number(ubxMessage.messageId) + " (" + messageTypeString + ")." + timeString);
+    if (relposned.messageDataStatus == UBXMessage::STATUS_VALID)
+    {
+        messageTypeString = "RELPOSNED";
     }
+
+    addLogLine(QString("UBX message received. Payload length: ") + QString::number(ubxMessage.payloadLength) +
+               ", class: " + QString::number(ubxMessage.messageClass) +
+               ", id: " + QString::number(ubxMessage.messageId) + " (" + messageTypeString + ")." + timeString, CATEGORY_UBX);
 }
 
 void MessageMonitorForm::ubloxProcessor_rtcmMessageReceived(const RTCMMessage& rtcmMessage)
 {
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_RTCM->checkState()))
-    {
-        addLogLine(QString("RTCM: Message type: ") + QString::number(rtcmMessage.messageType) + ", length: " + QString::number(rtcmMessage.rawMessage.size()));
-    }
+    addLogLine(QString("RTCM: Message type: ") + QString::number(rtcmMessage.messageType) + ", length: " + QString::number(rtcmMessage.rawMessage.size()), CATEGORY_RTCM);
 }
 
 
 void MessageMonitorForm::ubloxProcessor_ubxParseError(const QString& error)
 {
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_UBXParseErrors->checkState()))
-    {
-        addLogLine(QString("UBX parse error: ") + error);
-    }
+    addLogLine(QString("UBX parse error: ") + error, CATEGORY_UBXPARSEERROR);
 }
 
 void MessageMonitorForm::ubloxProcessor_nmeaParseError(const QString& error)
 {
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_NMEAParseErrors->checkState()))
-    {
-        addLogLine(QString("NMEA parse error: ") + error);
-    }
+    addLogLine(QString("NMEA parse error: ") + error, CATEGORY_NMEAPARSEERROR);
 }
 
 void MessageMonitorForm::ubloxProcessor_unidentifiedDataReceived(const QByteArray& data)
 {
-    if ((!ui->checkBox_SuspendOutput->checkState()) && (ui->checkBox_UnidentifiedData->checkState()))
-    {
-        QString dataString;
+    QString dataString;
 
-        for (int i = 0; i < data.length(); i++)
+    for (int i = 0; i < data.length(); i++)
+    {
+        if (i != 0)
         {
-            if (i != 0)
-            {
-                dataString += ", ";
-            }
-            if (!(data[i] & 0xF0))
-            {
-                dataString += "0";
-            }
-            dataString += QString::number(static_cast<unsigned char>(data[i]), 16);
+            dataString += ", ";
         }
-
-        addLogLine(QString("Unidentified data received. Num of bytes: ") + QString::number(data.length()) +
-                   ", Data(hex): " + dataString + " (as string: " + data + ").");
+        if (!(data[i] & 0xF0))
+        {
+            dataString += "0";
+        }
+        dataString += QString::number(static_cast<unsigned char>(data[i]), 16);
     }
+
+    addLogLine(QString("Unidentified data received. Num of bytes: ") + QString::number(data.length()) +
+               ", Data(hex): " + dataString + " (as string: " + data + ").", CATEGORY_UNIDENTIFIEDDATA);
 }
 
 
 void MessageMonitorForm::ErrorMessage(const QString& errorMessage)
 {
-    addLogLine(QString("Serial thread error: ") + errorMessage);
+    addLogLine(QString("Serial thread error: ") + errorMessage, CATEGORY_THREAD);
 }
 
 void MessageMonitorForm::WarningMessage(const QString& warningMessage)
 {
-    addLogLine(QString("Serial thread warning: ") + warningMessage);
+    addLogLine(QString("Serial thread warning: ") + warningMessage, CATEGORY_THREAD);
 }
 
 void MessageMonitorForm::InfoMessage(const QString& infoMessage)
 {
-    addLogLine(QString("Serial thread info: ") + infoMessage);
+    addLogLine(QString("Serial thread info: ") + infoMessage, CATEGORY_THREAD);
 }
 
 void MessageMonitorForm::serialDataReceived(const QByteArray&, qint64, qint64, const SerialThread::DataReceivedEmitReason&)
@@ -260,7 +305,7 @@ void MessageMonitorForm::disconnectUBloxDataStreamProcessorSlots(UBloxDataStream
 
 void MessageMonitorForm::on_pushButton_ClearAll_clicked()
 {
-    ui->plainTextEdit_Output->clear();
+    ui->logView_Output->getModel()->clear();
 }
 
 void MessageMonitorForm::connectNTRIPThreadSlots(NTRIPThread* ntripThread)
@@ -89,7 +89,18 @@ public:
 private:
     Ui::MessageMonitorForm *ui;
 
-    void addLogLine(const QString& line);
+    enum LogCategory
+    {
+        CATEGORY_NMEA = 0,
+        CATEGORY_UBX,
+        CATEGORY_RTCM,
+        CATEGORY_UBXPARSEERROR,
+        CATEGORY_NMEAPARSEERROR,
+        CATEGORY_UNIDENTIFIEDDATA,
+        CATEGORY_THREAD,
+    };
+
+    void addLogLine(const QString& line, const LogCategory category);
 
     qint64 lastRELPOSNEDMessageStartTime = 0;
     qint64 lastRELPOSNEDMessageEndTime = 0;
@@ -111,6 +122,10 @@ private slots:
     void serialTimeout(void);
 
     void on_pushButton_ClearAll_clicked();
+    void on_checkBox_PauseView_stateChanged(int arg1);
+    void on_spinBox_MaxLines_valueChanged(int arg1);
+    void on_lineEdit_Filter_textChanged(const QString& arg1);
+    void logView_CountersChanged(void);
 };
 
 #endif // MESSAGEMONITORFORM_H
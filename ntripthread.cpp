@@ -37,6 +37,7 @@
 #define WINDOWSVERSION
 #endif
 
+#include <QElapsedTimer>
 #include "ntripthread.h"
 #include <ctype.h>
 #include <stdio.h>
@@ -1697,7 +1698,11 @@ int NTRIPThread::rtcmDataWrite(const char *buffer, size_t size)
     QByteArray rtcmData;
     rtcmData.append(buffer, size);
 
-    emit dataReceived(rtcmData);
+    // Timestamp here (in NTRIP-thread) to include signal delivery to GUI-thread into latency
+    QElapsedTimer receiveTimer;
+    receiveTimer.start();
+
+    emit dataReceived(rtcmData, receiveTimer.msecsSinceReference());
 
     return size;
 }
@@ -91,7 +91,7 @@ signals:
     void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
     void warningMessage(const QString&);    //!< Signal for warning message (less severe than error)
     void errorMessage(const QString&);      //!< Signal for error message
-    int dataReceived(const QByteArray&);   //!< Signal that is emitted when data is received.
+    int dataReceived(const QByteArray&, qint64 receiveTime);   //!< Signal that is emitted when data is received. receiveTime is read by QElapsedTimer::msecsSinceReference()
 
     void threadEnded(void);
 };
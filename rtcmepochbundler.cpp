@@ -0,0 +1,267 @@
+/*
+    rtcmepochbundler.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmepochbundler.cpp
+ * @brief Definition for a class filtering RTCM-messages and bundling them by epoch for one rover.
+ */
+
+#include <QStringList>
+
+#include "rtcmepochbundler.h"
+
+static const int rtcmHeaderLength = 3;      // 0xD3 + 10 bits reserved/length
+
+// MSM-header: message type (12 bits), reference station id (12), epoch time (30), multiple message bit (1)
+static const int msmEpochTimeFirstBit = 24;
+static const int msmEpochTimeNumOfBits = 30;
+static const int msmMultipleMessageBit = 54;
+
+static quint32 getPayloadBits(const QByteArray& rawMessage, const int firstBit, const int numOfBits)
+{
+    quint32 value = 0;
+
+    for (int bit = firstBit; bit < firstBit + numOfBits; bit++)
+    {
+        unsigned char byte = static_cast<unsigned char>(rawMessage[rtcmHeaderLength + bit / 8]);
+        value = (value << 1) | ((byte >> (7 - (bit % 8))) & 1);
+    }
+
+    return value;
+}
+
+static bool parseMessageType(const QString& string, unsigned short& messageType)
+{
+    bool ok;
+    unsigned int value = string.toUInt(&ok);
+
+    if (!ok || (value > 4095))
+    {
+        return false;
+    }
+
+    messageType = static_cast<unsigned short>(value);
+    return true;
+}
+
+bool RTCMEpochBundler::parseSettings(const QString& text, Settings& settings, QString& errorString)
+{
+    Settings newSettings;
+
+    QString normalizedText = text.simplified();
+    normalizedText.replace(',', ' ');
+
+    const QStringList items = normalizedText.split(' ', Qt::SkipEmptyParts);
+
+    for (const QString& item : items)
+    {
+        if (item.compare("nobundle", Qt::CaseInsensitive) == 0)
+        {
+            newSettings.bundleEpochs = false;
+            continue;
+        }
+
+        bool deny = item.startsWith('!');
+        QString typeString = deny ? item.mid(1) : item;
+        int minInterval = -1;
+
+        int atIndex = typeString.indexOf('@');
+
+        if (atIndex >= 0)
+        {
+            bool ok;
+            minInterval = typeString.mid(atIndex + 1).toInt(&ok);
+
+            if (deny || !ok || (minInterval < 0))
+            {
+                errorString = "Invalid item \"" + item + "\".";
+                return false;
+            }
+
+            typeString = typeString.left(atIndex);
+        }
+
+        QStringList rangeLimits = typeString.split('-');
+        unsigned short firstType;
+        unsigned short lastType;
+
+        if ((rangeLimits.size() > 2) ||
+                !parseMessageType(rangeLimits.first(), firstType) ||
+                !parseMessageType(rangeLimits.last(), lastType) ||
+                (firstType > lastType))
+        {
+            errorString = "Invalid item \"" + item + "\".";
+            return false;
+        }
+
+        for (unsigned int messageType = firstType; messageType <= lastType; messageType++)
+        {
+            if (deny)
+            {
+                newSettings.deniedTypes.insert(static_cast<unsigned short>(messageType));
+            }
+            else if (minInterval >= 0)
+            {
+                newSettings.minIntervals[static_cast<unsigned short>(messageType)] = minInterval;
+            }
+            else
+            {
+                newSettings.allowedTypes.insert(static_cast<unsigned short>(messageType));
+            }
+        }
+    }
+
+    settings = newSettings;
+    return true;
+}
+
+bool RTCMEpochBundler::isMSM(const unsigned short messageType)
+{
+    // GPS, GLONASS, Galileo, SBAS, QZSS, BeiDou, NavIC: 10x1...10x7
+    return (messageType >= 1071) && (messageType <= 1137) &&
+            (messageType % 10 >= 1) && (messageType % 10 <= 7);
+}
+
+bool RTCMEpochBundler::getMSMEpochInfo(const QByteArray& rawMessage, quint32& epochTime, bool& multipleMessage)
+{
+    if (rawMessage.length() < rtcmHeaderLength + (msmMultipleMessageBit / 8) + 1)
+    {
+        return false;
+    }
+
+    epochTime = getPayloadBits(rawMessage, msmEpochTimeFirstBit, msmEpochTimeNumOfBits);
+    multipleMessage = getPayloadBits(rawMessage, msmMultipleMessageBit, 1) != 0;
+
+    return true;
+}
+
+void RTCMEpochBundler::setSettings(const Settings& settings)
+{
+    this->settings = settings;
+    lastForwardTimes.clear();
+}
+
+void RTCMEpochBundler::addMessage(const RTCMMessage& message, const quint64 sequenceNumber, const qint64 time, QVector<Output>& outputs)
+{
+    bool lastOfEpoch = false;
+    quint32 epochTime;
+    bool multipleMessage;
+
+    if (settings.bundleEpochs && isMSM(message.messageType) &&
+            getMSMEpochInfo(message.rawMessage, epochTime, multipleMessage))
+    {
+        unsigned short constellation = message.messageType / 10;
+
+        if (epochOpen && epochTimes.contains(constellation) && (epochTimes[constellation] != epochTime))
+        {
+            // Last message of the previous epoch was lost
+            flush(outputs);
+        }
+
+        if (!epochOpen)
+        {
+            epochOpen = true;
+            epochOpenTime = time;
+            pendingEpoch.epochStartTime = message.messageStartTime;
+        }
+
+        epochTimes[constellation] = epochTime;
+        lastOfEpoch = !multipleMessage;
+    }
+
+    if (isForwarded(message.messageType, time))
+    {
+        if (epochOpen)
+        {
+            pendingEpoch.data.append(message.rawMessage);
+            pendingEpoch.sequenceNumbers.append(sequenceNumber);
+        }
+        else
+        {
+            Output output;
+            output.data = message.rawMessage;
+            output.sequenceNumbers.append(sequenceNumber);
+            outputs.append(output);
+        }
+    }
+
+    if (lastOfEpoch)
+    {
+        flush(outputs);
+    }
+}
+
+void RTCMEpochBundler::flush(QVector<Output>& outputs)
+{
+    if (epochOpen)
+    {
+        if (!pendingEpoch.data.isEmpty())
+        {
+            outputs.append(pendingEpoch);
+        }
+
+        pendingEpoch = Output();
+        epochTimes.clear();
+        epochOpen = false;
+    }
+}
+
+void RTCMEpochBundler::flushIfOlderThan(const qint64 time, const qint64 maxAge, QVector<Output>& outputs)
+{
+    if (epochOpen && (time - epochOpenTime > maxAge))
+    {
+        flush(outputs);
+    }
+}
+
+void RTCMEpochBundler::reset(void)
+{
+    pendingEpoch = Output();
+    epochTimes.clear();
+    epochOpen = false;
+    lastForwardTimes.clear();
+}
+
+bool RTCMEpochBundler::isForwarded(const unsigned short messageType, const qint64 time)
+{
+    // Rate limited types are implicitly allowed
+    if (settings.deniedTypes.contains(messageType) ||
+            (!settings.allowedTypes.isEmpty() && !settings.allowedTypes.contains(messageType) &&
+             !settings.minIntervals.contains(messageType)))
+    {
+        return false;
+    }
+
+    QMap<unsigned short, int>::const_iterator minInterval = settings.minIntervals.constFind(messageType);
+
+    if (minInterval != settings.minIntervals.constEnd())
+    {
+        QMap<unsigned short, qint64>::const_iterator lastForwardTime = lastForwardTimes.constFind(messageType);
+
+        // 10 % tolerance so that messages sent at exactly the min interval are not dropped due to jitter
+        if ((lastForwardTime != lastForwardTimes.constEnd()) &&
+                (time - lastForwardTime.value() < minInterval.value() - minInterval.value() / 10))
+        {
+            return false;
+        }
+
+        lastForwardTimes[messageType] = time;
+    }
+
+    return true;
+}
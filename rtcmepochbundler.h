@@ -0,0 +1,134 @@
+/*
+    rtcmepochbundler.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmepochbundler.h
+ * @brief Declaration for a class filtering RTCM-messages and bundling them by epoch for one rover.
+ */
+
+#ifndef RTCMEPOCHBUNDLER_H
+#define RTCMEPOCHBUNDLER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QSet>
+#include <QMap>
+#include <QString>
+
+#include "gnssmessage.h"
+
+/**
+ * @brief Filters RTCM-messages forwarded to one rover and bundles MSM-messages of one epoch into one buffer
+ *
+ * MSM-messages are collected until a message with multiple message bit cleared
+ * (=last message of the epoch) is received. Non-MSM-messages received while an epoch
+ * is open are added to the same bundle, otherwise they are output as such.
+ * Epoch is also closed if an MSM-message of the same constellation with a different
+ * epoch time is received (last message lost) or by flush/flushIfOlderThan.
+ *
+ * Filtering is done before bundling, but epoch boundaries are tracked from all messages
+ * so that denying the last message of the epoch doesn't delay the rest.
+ *
+ * Not thread-safe.
+ */
+class RTCMEpochBundler
+{
+public:
+    /**
+     * @brief Filtering/bundling settings
+     */
+    class Settings
+    {
+    public:
+        bool bundleEpochs = true;                   //!< Bundle MSM-messages by epoch (false = every message output as such)
+        QSet<unsigned short> allowedTypes;          //!< Message types forwarded in addition to the ones in minIntervals (empty = all types not denied)
+        QSet<unsigned short> deniedTypes;           //!< Message types never forwarded
+        QMap<unsigned short, int> minIntervals;     //!< Min interval (ms) between forwarded messages of the type
+    };
+
+    /**
+     * @brief Data ready to be added to rover's send queue
+     */
+    class Output
+    {
+    public:
+        QByteArray data;                    //!< Message(s) to send
+        QVector<quint64> sequenceNumbers;   //!< Sequence numbers of the messages in data (in order)
+        qint64 epochStartTime = -1;         //!< Uptime of the first byte of the epoch's first message (-1 = single message, not an epoch)
+    };
+
+    /**
+     * @brief Parses settings from a text
+     * @param text Whitespace/comma separated items: "1074" or "1071-1077" = allow types,
+     * "!1019" or "!1041-1046" = deny types, "1005@10000" = forward type at most once per 10000 ms,
+     * "nobundle" = don't bundle epochs. Empty text = forward everything.
+     * @param settings Parsed settings (only modified if parsing succeeded)
+     * @param errorString Description of the error if parsing failed
+     * @return true if parsing succeeded
+     */
+    static bool parseSettings(const QString& text, Settings& settings, QString& errorString);
+
+    static bool isMSM(const unsigned short messageType);    //!< Returns true if messageType is an MSM-message (1071...1137)
+
+    /**
+     * @brief Reads epoch time and multiple message bit from MSM-message's header
+     * @param rawMessage Complete message (including 0xD3, length and CRC)
+     * @param epochTime Epoch time (DF004 or equivalent, format depends on constellation)
+     * @param multipleMessage Multiple message bit (true = more messages of this epoch follow)
+     * @return false if message is too short
+     */
+    static bool getMSMEpochInfo(const QByteArray& rawMessage, quint32& epochTime, bool& multipleMessage);
+
+    void setSettings(const Settings& settings);             //!< Sets settings. Clears rate limit history
+    const Settings& getSettings(void) const { return settings; }  //!< Returns current settings
+
+    /**
+     * @brief Handles one message
+     * @param message Message
+     * @param sequenceNumber Sequence number of the message (for latency statistics)
+     * @param time Current uptime (used for rate limits)
+     * @param outputs Data ready to be sent is appended here
+     */
+    void addMessage(const RTCMMessage& message, const quint64 sequenceNumber, const qint64 time, QVector<Output>& outputs);
+
+    void flush(QVector<Output>& outputs);   //!< Closes open epoch (if any) and appends it to outputs
+
+    /**
+     * @brief Closes open epoch if it was opened more than maxAge ms ago
+     * @param time Current uptime
+     * @param maxAge Max age (ms)
+     * @param outputs Closed epoch is appended here
+     */
+    void flushIfOlderThan(const qint64 time, const qint64 maxAge, QVector<Output>& outputs);
+
+    void reset(void);   //!< Discards open epoch and rate limit history
+
+private:
+    Settings settings;
+
+    bool epochOpen = false;             //!< True if MSM-messages of an epoch have been received and last one not yet
+    qint64 epochOpenTime = 0;           //!< Uptime when epoch was opened
+    QMap<unsigned short, quint32> epochTimes;   //!< Epoch times of constellations (type / 10) in open epoch
+    Output pendingEpoch;                //!< Collected messages of open epoch
+
+    QMap<unsigned short, qint64> lastForwardTimes;  //!< Uptime when message type was last forwarded (for rate limits)
+
+    bool isForwarded(const unsigned short messageType, const qint64 time);  //!< Checks filters and rate limits (updates rate limit history)
+};
+
+#endif // RTCMEPOCHBUNDLER_H
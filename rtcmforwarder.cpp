@@ -0,0 +1,283 @@
+/*
+    rtcmforwarder.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmforwarder.cpp
+ * @brief Definition for a class forwarding RTCM-messages from base to rovers outside of GUI-thread.
+ */
+
+#include <QElapsedTimer>
+
+#include "rtcmforwarder.h"
+
+RTCMForwarder::RTCMForwarder(QObject* parent) : QObject(parent)
+{
+    for (unsigned int i = 0; i < maxNumOfRovers; i++)
+    {
+        roverSerialThreads[i] = nullptr;
+    }
+
+    // Processors emit from the base's threads -> handle messages there, too
+    connect(&ubloxDataStreamProcessor_Serial, &UBloxDataStreamProcessor::rtcmMessageReceived,
+                     this, &RTCMForwarder::ubloxProcessor_rtcmMessageReceived_Serial, Qt::DirectConnection);
+
+    connect(&ubloxDataStreamProcessor_NTRIP, &UBloxDataStreamProcessor::rtcmMessageReceived,
+                     this, &RTCMForwarder::ubloxProcessor_rtcmMessageReceived_NTRIP, Qt::DirectConnection);
+
+    updateTimer.setInterval(updateInterval);
+    connect(&updateTimer, &QTimer::timeout, this, &RTCMForwarder::updateTimer_Timeout);
+    updateTimer.start();
+}
+
+void RTCMForwarder::setLatencyRecorder(RTCMLatencyRecorder* recorder)
+{
+    QMutexLocker locker(&forwardMutex);
+    latencyRecorder = recorder;
+}
+
+void RTCMForwarder::setRoverSerialThread(const unsigned int roverId, SerialThread* serialThread)
+{
+    if (roverId < maxNumOfRovers)
+    {
+        QMutexLocker locker(&forwardMutex);
+        roverSerialThreads[roverId] = serialThread;
+        roverBundlers[roverId].reset();
+    }
+}
+
+void RTCMForwarder::setRoverSettings(const unsigned int roverId, const RTCMEpochBundler::Settings& settings)
+{
+    if (roverId < maxNumOfRovers)
+    {
+        QElapsedTimer enqueueTimer;
+        enqueueTimer.start();
+
+        QMutexLocker locker(&forwardMutex);
+
+        if (roverSerialThreads[roverId])
+        {
+            // Send epoch collected with old settings
+            QVector<RTCMEpochBundler::Output> outputs;
+            roverBundlers[roverId].flush(outputs);
+            enqueueOutputs(roverId, outputs, enqueueTimer.msecsSinceReference());
+        }
+
+        roverBundlers[roverId].reset();
+        roverBundlers[roverId].setSettings(settings);
+    }
+}
+
+void RTCMForwarder::connectSerialThreadSlots_Base(SerialThread* serThread)
+{
+    ubloxDataStreamProcessor_Serial.flushInputBuffer();
+
+    connect(serThread, &SerialThread::dataRead,
+                     this, &RTCMForwarder::serialThread_DataRead, Qt::DirectConnection);
+
+    connect(serThread, &SerialThread::serialTimeout,
+                     this, &RTCMForwarder::serialThread_SerialTimeout, Qt::DirectConnection);
+
+    messageCount_Serial.storeRelease(0);
+}
+
+void RTCMForwarder::disconnectSerialThreadSlots_Base(SerialThread* serThread)
+{
+    disconnect(serThread, &SerialThread::dataRead,
+                     this, &RTCMForwarder::serialThread_DataRead);
+
+    disconnect(serThread, &SerialThread::serialTimeout,
+                     this, &RTCMForwarder::serialThread_SerialTimeout);
+}
+
+void RTCMForwarder::connectNTRIPThreadSlots_Base(NTRIPThread* ntripThread)
+{
+    ubloxDataStreamProcessor_NTRIP.flushInputBuffer();
+
+    connect(ntripThread, &NTRIPThread::dataReceived,
+                     this, &RTCMForwarder::ntripThread_DataReceived, Qt::DirectConnection);
+
+    messageCount_NTRIP.storeRelease(0);
+}
+
+void RTCMForwarder::disconnectNTRIPThreadSlots_Base(NTRIPThread* ntripThread)
+{
+    disconnect(ntripThread, &NTRIPThread::dataReceived,
+                     this, &RTCMForwarder::ntripThread_DataReceived);
+}
+
+int RTCMForwarder::getMessageCount(const RTCMLatencyStatistics::Source source) const
+{
+    switch (source)
+    {
+    case RTCMLatencyStatistics::SOURCE_SERIAL:
+        return messageCount_Serial.loadAcquire();
+    case RTCMLatencyStatistics::SOURCE_NTRIP:
+    default:
+        return messageCount_NTRIP.loadAcquire();
+    }
+}
+
+void RTCMForwarder::clearMessageCount(const RTCMLatencyStatistics::Source source)
+{
+    switch (source)
+    {
+    case RTCMLatencyStatistics::SOURCE_SERIAL:
+        messageCount_Serial.storeRelease(0);
+        break;
+    case RTCMLatencyStatistics::SOURCE_NTRIP:
+    default:
+        messageCount_NTRIP.storeRelease(0);
+        break;
+    }
+
+    emitMessageCounts();
+}
+
+void RTCMForwarder::serialThread_DataRead(const QByteArray& data, const qint64 readTime)
+{
+    ubloxDataStreamProcessor_Serial.process(data, readTime, readTime);
+}
+
+void RTCMForwarder::serialThread_SerialTimeout(void)
+{
+    ubloxDataStreamProcessor_Serial.flushInputBuffer();
+
+    // Base has stopped sending -> no more messages of the current epoch are coming
+    flushEpochs(-1);
+}
+
+void RTCMForwarder::ntripThread_DataReceived(const QByteArray& data, qint64 receiveTime)
+{
+    ubloxDataStreamProcessor_NTRIP.process(data, receiveTime, receiveTime);
+}
+
+void RTCMForwarder::ubloxProcessor_rtcmMessageReceived_Serial(const RTCMMessage& rtcmMessage)
+{
+    forwardMessage(rtcmMessage, RTCMLatencyStatistics::SOURCE_SERIAL);
+    messageCount_Serial.fetchAndAddRelease(1);
+}
+
+void RTCMForwarder::ubloxProcessor_rtcmMessageReceived_NTRIP(const RTCMMessage& rtcmMessage)
+{
+    forwardMessage(rtcmMessage, RTCMLatencyStatistics::SOURCE_NTRIP);
+    messageCount_NTRIP.fetchAndAddRelease(1);
+}
+
+void RTCMForwarder::forwardMessage(const RTCMMessage& rtcmMessage, const RTCMLatencyStatistics::Source source)
+{
+    QElapsedTimer dispatchTimer;
+    dispatchTimer.start();
+
+    qint64 dispatchTime = dispatchTimer.msecsSinceReference();
+
+    // Mutex is held while adding to the queues so that rover's SerialThread can't be deleted meanwhile
+    QMutexLocker locker(&forwardMutex);
+
+    quint64 sequenceNumber = 0;
+
+    if (latencyRecorder)
+    {
+        sequenceNumber = latencyRecorder->rtcmMessageDispatched(rtcmMessage, source, dispatchTime);
+    }
+
+    QVector<RTCMEpochBundler::Output> outputs;
+
+    for (unsigned int i = 0; i < maxNumOfRovers; i++)
+    {
+        if (roverSerialThreads[i])
+        {
+            outputs.clear();
+
+            roverBundlers[i].flushIfOlderThan(dispatchTime, maxEpochAge, outputs);
+            roverBundlers[i].addMessage(rtcmMessage, sequenceNumber, dispatchTime, outputs);
+
+            enqueueOutputs(i, outputs, dispatchTime);
+        }
+    }
+}
+
+void RTCMForwarder::enqueueOutputs(const unsigned int roverId, const QVector<RTCMEpochBundler::Output>& outputs, const qint64 enqueueTime)
+{
+    for (const RTCMEpochBundler::Output& output : outputs)
+    {
+        // Write time is reported only for the last message of the bundle (=the one completing the epoch)
+        int queueDepth = roverSerialThreads[roverId]->addToSendQueue(output.data, output.sequenceNumbers.last());
+
+        if (latencyRecorder)
+        {
+            for (const quint64 sequenceNumber : output.sequenceNumbers)
+            {
+                latencyRecorder->rtcmMessageEnqueued(sequenceNumber, roverId, enqueueTime, queueDepth);
+            }
+
+            latencyRecorder->rtcmDataEnqueued(roverId, output.data.length(), output.epochStartTime, enqueueTime);
+        }
+    }
+}
+
+void RTCMForwarder::flushEpochs(const qint64 maxAge)
+{
+    QElapsedTimer flushTimer;
+    flushTimer.start();
+
+    qint64 time = flushTimer.msecsSinceReference();
+
+    QMutexLocker locker(&forwardMutex);
+
+    QVector<RTCMEpochBundler::Output> outputs;
+
+    for (unsigned int i = 0; i < maxNumOfRovers; i++)
+    {
+        if (roverSerialThreads[i])
+        {
+            outputs.clear();
+
+            if (maxAge < 0)
+            {
+                roverBundlers[i].flush(outputs);
+            }
+            else
+            {
+                roverBundlers[i].flushIfOlderThan(time, maxAge, outputs);
+            }
+
+            enqueueOutputs(i, outputs, time);
+        }
+    }
+}
+
+void RTCMForwarder::updateTimer_Timeout(void)
+{
+    // Only matters for epochs whose last message was lost (and serial port doesn't go silent, like with NTRIP)
+    flushEpochs(maxEpochAge);
+
+    emitMessageCounts();
+}
+
+void RTCMForwarder::emitMessageCounts(void)
+{
+    int count_Serial = messageCount_Serial.loadAcquire();
+    int count_NTRIP = messageCount_NTRIP.loadAcquire();
+
+    if ((count_Serial != lastEmittedCount_Serial) || (count_NTRIP != lastEmittedCount_NTRIP))
+    {
+        lastEmittedCount_Serial = count_Serial;
+        lastEmittedCount_NTRIP = count_NTRIP;
+        emit messageCountsChanged(count_Serial, count_NTRIP);
+    }
+}
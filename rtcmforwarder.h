@@ -0,0 +1,127 @@
+/*
+    rtcmforwarder.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmforwarder.h
+ * @brief Declaration for a class forwarding RTCM-messages from base to rovers outside of GUI-thread.
+ */
+
+#ifndef RTCMFORWARDER_H
+#define RTCMFORWARDER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QTimer>
+#include <QAtomicInt>
+
+#include "serialthread.h"
+#include "ntripthread.h"
+#include "ubloxdatastreamprocessor.h"
+#include "rtcmlatencystatistics.h"
+#include "rtcmepochbundler.h"
+
+/**
+ * @brief Forwards RTCM-messages from base (serial or NTRIP) to rovers' send queues
+ *
+ * Base threads' data-signals are connected using Qt::DirectConnection, so bytes are
+ * split into messages and complete RTCM-messages are added to rovers' send queues
+ * in the thread that received them. GUI-thread is not involved in forwarding at all,
+ * it only gets message counts (messageCountsChanged) every updateInterval ms.
+ *
+ * Messages are filtered and bundled by epoch separately for each rover (RTCMEpochBundler),
+ * so that each epoch is written to the rover as one buffer.
+ * Epochs whose last message is lost are flushed when base's serial port goes silent
+ * or when they get older than maxEpochAge.
+ *
+ * Rovers' SerialThreads must be registered (setRoverSerialThread) after creation
+ * and unregistered before deletion.
+ */
+class RTCMForwarder : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const unsigned int maxNumOfRovers = 3;   //!< Max number of rovers messages can be forwarded to
+
+    explicit RTCMForwarder(QObject* parent = nullptr);  //!< Constructor
+
+    /**
+     * @brief Sets recorder used to collect latency statistics (thread-safe)
+     * @param recorder Recorder (nullptr = no statistics collected)
+     */
+    void setLatencyRecorder(RTCMLatencyRecorder* recorder);
+
+    /**
+     * @brief Sets rover's SerialThread where messages are forwarded to (thread-safe)
+     * @param roverId Rover id
+     * @param serialThread SerialThread (nullptr = no forwarding). After this function returns, previously set thread is not accessed anymore.
+     */
+    void setRoverSerialThread(const unsigned int roverId, SerialThread* serialThread);
+
+    /**
+     * @brief Sets rover's filtering/bundling settings (thread-safe)
+     * @param roverId Rover id
+     * @param settings Settings
+     */
+    void setRoverSettings(const unsigned int roverId, const RTCMEpochBundler::Settings& settings);
+
+    void connectSerialThreadSlots_Base(SerialThread* serThread);        //!< Connects base's SerialThread (Qt::DirectConnection)
+    void disconnectSerialThreadSlots_Base(SerialThread* serThread);     //!< Disconnects base's SerialThread. Thread must be stopped first
+    void connectNTRIPThreadSlots_Base(NTRIPThread* ntripThread);        //!< Connects NTRIPThread (Qt::DirectConnection)
+    void disconnectNTRIPThreadSlots_Base(NTRIPThread* ntripThread);     //!< Disconnects NTRIPThread. Thread must be stopped first
+
+    int getMessageCount(const RTCMLatencyStatistics::Source source) const;  //!< Returns number of messages forwarded from source (thread-safe)
+    void clearMessageCount(const RTCMLatencyStatistics::Source source);     //!< Clears message count of the source (thread-safe)
+
+    const int updateInterval = 100;         //!< Interval for checking changes in message counts and stale epochs (ms)
+    const qint64 maxEpochAge = 500;         //!< Max time an epoch is kept open waiting for its last message (ms)
+
+signals:
+    void messageCountsChanged(const int count_Serial, const int count_NTRIP);    //!< Emitted in GUI-thread when message count of either source has changed
+
+private slots:
+    void serialThread_DataRead(const QByteArray& data, const qint64 readTime);
+    void serialThread_SerialTimeout(void);
+    void ntripThread_DataReceived(const QByteArray& data, qint64 receiveTime);
+    void ubloxProcessor_rtcmMessageReceived_Serial(const RTCMMessage& rtcmMessage);
+    void ubloxProcessor_rtcmMessageReceived_NTRIP(const RTCMMessage& rtcmMessage);
+    void updateTimer_Timeout(void);
+
+private:
+    UBloxDataStreamProcessor ubloxDataStreamProcessor_Serial;   //!< Only accessed from base's SerialThread (while connected)
+    UBloxDataStreamProcessor ubloxDataStreamProcessor_NTRIP;    //!< Only accessed from NTRIPThread (while connected)
+
+    QMutex forwardMutex;                                //!< Protects members below
+    SerialThread* roverSerialThreads[maxNumOfRovers];   //!< Rovers' SerialThreads (nullptr = not forwarded)
+    RTCMEpochBundler roverBundlers[maxNumOfRovers];     //!< Rovers' filters/epoch bundlers
+    RTCMLatencyRecorder* latencyRecorder = nullptr;     //!< Recorder for latency statistics (nullptr = not collected)
+
+    QAtomicInt messageCount_Serial;
+    QAtomicInt messageCount_NTRIP;
+    int lastEmittedCount_Serial = -1;   //!< Only accessed from GUI-thread
+    int lastEmittedCount_NTRIP = -1;    //!< Only accessed from GUI-thread
+
+    QTimer updateTimer;
+
+    void forwardMessage(const RTCMMessage& rtcmMessage, const RTCMLatencyStatistics::Source source);   //!< Adds message to rovers' send queues and registers it for latency statistics
+    void emitMessageCounts(void);             //!< Emits messageCountsChanged if counts have changed
+    void flushEpochs(const qint64 maxAge);     //!< Sends rovers' epochs older than maxAge ms (-1 = all open epochs)
+    void enqueueOutputs(const unsigned int roverId, const QVector<RTCMEpochBundler::Output>& outputs, const qint64 enqueueTime);   //!< Adds outputs into rover's send queue. forwardMutex must be locked
+};
+
+#endif // RTCMFORWARDER_H
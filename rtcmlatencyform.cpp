@@ -0,0 +1,222 @@
+/*
+    rtcmlatencyform.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmlatencyform.cpp
+ * @brief Definition for a form that shows latencies of RTCM-messages forwarded from base to rovers.
+ */
+
+#include <QSettings>
+#include <QFile>
+#include <QTextStream>
+
+#include "rtcmlatencyform.h"
+#include "ui_rtcmlatencyform.h"
+
+RTCMLatencyForm::RTCMLatencyForm(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::RTCMLatencyForm)
+{
+    ui->setupUi(this);
+
+    connect(&updateTimer, &QTimer::timeout, this, &RTCMLatencyForm::on_updateTimerTimeout);
+
+    fileDialog_CSV.setFileMode(QFileDialog::AnyFile);
+    fileDialog_CSV.setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog_CSV.setDefaultSuffix("csv");
+
+    QStringList csvFilters;
+
+    csvFilters << "CSV-files (*.csv)"
+            << "Any files (*)";
+
+    fileDialog_CSV.setNameFilters(csvFilters);
+
+    QSettings settings;
+    fileDialog_CSV.setDirectory(QDir(settings.value("RTCMLatency_Directory_Dialog_CSV").toString()));
+}
+
+RTCMLatencyForm::~RTCMLatencyForm()
+{
+    QSettings settings;
+    settings.setValue("RTCMLatency_Directory_Dialog_CSV", fileDialog_CSV.directory().path());
+
+    delete ui;
+}
+
+quint64 RTCMLatencyForm::rtcmMessageDispatched(const RTCMMessage& message, const RTCMLatencyStatistics::Source source, const qint64 dispatchTime)
+{
+    QMutexLocker locker(&statisticsMutex);
+    return statistics.messageDispatched(message, source, dispatchTime);
+}
+
+void RTCMLatencyForm::rtcmMessageEnqueued(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const int queueDepth)
+{
+    QMutexLocker locker(&statisticsMutex);
+    statistics.messageEnqueued(sequenceNumber, roverId, enqueueTime, queueDepth);
+}
+
+void RTCMLatencyForm::rtcmDataEnqueued(const unsigned int roverId, const int bytes, const qint64 epochStartTime, const qint64 enqueueTime)
+{
+    QMutexLocker locker(&statisticsMutex);
+    statistics.dataEnqueued(roverId, bytes, epochStartTime, enqueueTime);
+}
+
+void RTCMLatencyForm::connectSerialThreadSlots_Rover(SerialThread* serThread, const unsigned int roverId)
+{
+    serialThreadConnections.insert(serThread,
+        connect(serThread, &SerialThread::queuedDataWritten,
+            this, [=](const quint64 sequenceNumber, const qint64 enqueueTime, const qint64 writeTime, const int queueDepth)
+            {
+                QMutexLocker locker(&statisticsMutex);
+                statistics.messageWritten(sequenceNumber, roverId, enqueueTime, writeTime, queueDepth);
+            }
+        )
+    );
+}
+
+void RTCMLatencyForm::disconnectSerialThreadSlots_Rover(SerialThread* serThread, const unsigned int)
+{
+    QList<QMetaObject::Connection> connections = serialThreadConnections.values(serThread);
+
+    for (int i = 0; i < connections.size(); i++)
+    {
+        disconnect(connections.at(i));
+    }
+    serialThreadConnections.remove(serThread);
+}
+
+void RTCMLatencyForm::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    updateStatistics();
+    updateTimer.start(500);
+}
+
+void RTCMLatencyForm::hideEvent(QHideEvent* event)
+{
+    updateTimer.stop();
+
+    QWidget::hideEvent(event);
+}
+
+void RTCMLatencyForm::on_updateTimerTimeout()
+{
+    updateStatistics();
+}
+
+void RTCMLatencyForm::updateStatistics(void)
+{
+    QString summary;
+    QTextStream summaryStream(&summary);
+    QString queueDepths;
+    QString messageCount;
+
+    qint64 elapsed = bytesRateTimer.isValid() ? bytesRateTimer.restart() : 0;
+
+    if (!bytesRateTimer.isValid())
+    {
+        bytesRateTimer.start();
+    }
+
+    // Widgets are updated after releasing the mutex to not block forwarding longer than necessary
+    statisticsMutex.lock();
+
+    statistics.writeSummary(summaryStream);
+    summaryStream.flush();
+
+    for (unsigned int roverId = 0; roverId < RTCMLatencyStatistics::maxNumOfRovers; roverId++)
+    {
+        if (roverId != 0)
+        {
+            queueDepths += ", ";
+        }
+
+        quint64 bytesEnqueued = statistics.getBytesEnqueued(roverId);
+        quint64 bytesPerSecond = 0;
+
+        if ((elapsed > 0) && (bytesEnqueued >= lastBytesEnqueued[roverId]))
+        {
+            bytesPerSecond = (bytesEnqueued - lastBytesEnqueued[roverId]) * 1000 / static_cast<quint64>(elapsed);
+        }
+
+        lastBytesEnqueued[roverId] = bytesEnqueued;
+
+        queueDepths += "Rover " + QString(char('A' + roverId)) + ": " +
+                QString::number(statistics.getCurrentQueueDepth(roverId)) +
+                " (max " + QString::number(statistics.getMaxQueueDepth(roverId)) + "), " +
+                QString::number(bytesPerSecond) + " B/s";
+    }
+
+    messageCount = QString::number(statistics.getNumOfMessages()) +
+            " (unmatched writes: " + QString::number(statistics.getNumOfLostRecords()) + ")";
+
+    statisticsMutex.unlock();
+
+    ui->plainTextEdit_Summary->setPlainText(summary);
+    ui->label_QueueDepths->setText(queueDepths);
+    ui->label_MessageCount->setText(messageCount);
+}
+
+void RTCMLatencyForm::on_pushButton_Clear_clicked()
+{
+    statisticsMutex.lock();
+    statistics.clear();
+    statisticsMutex.unlock();
+
+    updateStatistics();
+}
+
+void RTCMLatencyForm::on_pushButton_SaveCSV_clicked()
+{
+    if (fileDialog_CSV.exec())
+    {
+        QStringList fileNameList = fileDialog_CSV.selectedFiles();
+
+        if (fileNameList.size() != 1)
+        {
+            ui->label_LastStatus->setText("Multiple file selection not supported. CSV not saved.");
+            return;
+        }
+
+        fileDialog_CSV.setDirectory(QFileInfo(fileNameList[0]).path());
+
+        QFile csvFile(fileNameList[0]);
+
+        if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        {
+            ui->label_LastStatus->setText("Error: Can't open file \"" + fileNameList[0] + "\".");
+            return;
+        }
+
+        QTextStream csvStream(&csvFile);
+
+        // Write from a copy to not block forwarding while writing the file
+        statisticsMutex.lock();
+        RTCMLatencyStatistics statisticsCopy = statistics;
+        statisticsMutex.unlock();
+
+        statisticsCopy.writeRecordsCSV(csvStream);
+
+        csvStream.flush();
+        csvFile.close();
+
+        ui->label_LastStatus->setText("Saved \"" + QFileInfo(fileNameList[0]).fileName() + "\".");
+    }
+}
@@ -0,0 +1,89 @@
+/*
+    rtcmlatencyform.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmlatencyform.h
+ * @brief Declaration for a form that shows latencies of RTCM-messages forwarded from base to rovers.
+ */
+
+#ifndef RTCMLATENCYFORM_H
+#define RTCMLATENCYFORM_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QMultiMap>
+#include <QFileDialog>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include "serialthread.h"
+#include "rtcmlatencystatistics.h"
+
+namespace Ui {
+class RTCMLatencyForm;
+}
+
+/**
+ * @brief Form that collects and shows latencies of RTCM-messages forwarded from base to rovers.
+ *
+ * RTCMForwarder informs this form about every dispatched message (rtcmMessageDispatched)
+ * and every message added to rover's send queue (rtcmMessageEnqueued).
+ * These are called from the threads receiving base's data, so statistics are protected by a mutex.
+ * Write-times are received from rovers' SerialThreads (connectSerialThreadSlots_Rover).
+ */
+class RTCMLatencyForm : public QWidget, public RTCMLatencyRecorder
+{
+    Q_OBJECT
+
+public:
+    explicit RTCMLatencyForm(QWidget *parent = nullptr);   //!< Constructor
+    ~RTCMLatencyForm();
+
+    quint64 rtcmMessageDispatched(const RTCMMessage& message, const RTCMLatencyStatistics::Source source, const qint64 dispatchTime) override;  //!< Registers dispatched RTCM-message (thread-safe)
+    void rtcmMessageEnqueued(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const int queueDepth) override;     //!< Registers adding of the message into rover's send queue (thread-safe)
+    void rtcmDataEnqueued(const unsigned int roverId, const int bytes, const qint64 epochStartTime, const qint64 enqueueTime) override;        //!< Registers data added into rover's send queue (thread-safe)
+
+    void connectSerialThreadSlots_Rover(SerialThread* serThread, const unsigned int roverId);       //!< Connects rover's SerialThread's queuedDataWritten-signal
+    void disconnectSerialThreadSlots_Rover(SerialThread* serThread, const unsigned int roverId);    //!< Disconnects rover's SerialThread's queuedDataWritten-signal
+
+private slots:
+    void on_updateTimerTimeout();
+    void on_pushButton_Clear_clicked();
+    void on_pushButton_SaveCSV_clicked();
+
+protected:
+    void showEvent(QShowEvent* event);  //!< Starts periodic updating of statistics
+    void hideEvent(QHideEvent* event);  //!< Stops periodic updating of statistics
+
+private:
+    Ui::RTCMLatencyForm *ui;
+
+    QMutex statisticsMutex;             //!< Protects statistics
+    RTCMLatencyStatistics statistics;   //!< Collected statistics
+    QTimer updateTimer;                 //!< Timer for updating shown statistics
+    QFileDialog fileDialog_CSV;         //!< File dialog for saving CSV-file
+
+    quint64 lastBytesEnqueued[RTCMLatencyStatistics::maxNumOfRovers] = { 0, 0, 0 };    //!< Bytes enqueued at previous update (for bytes/s)
+    QElapsedTimer bytesRateTimer;       //!< Time since previous update (for bytes/s)
+
+    QMultiMap<SerialThread*, QMetaObject::Connection> serialThreadConnections;  //!< Connections to rovers' SerialThreads
+
+    void updateStatistics(void);        //!< Updates shown statistics
+};
+
+#endif // RTCMLATENCYFORM_H
@@ -0,0 +1,384 @@
+/*
+    rtcmlatencystatistics.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmlatencystatistics.cpp
+ * @brief Definitions for classes collecting latency statistics of RTCM-corrections forwarded from base to rovers.
+ */
+
+#include "rtcmlatencystatistics.h"
+
+LatencyHistogram::LatencyHistogram(const int numOfBins)
+{
+    bins.resize(numOfBins > 0 ? numOfBins : 1);
+    clear();
+}
+
+void LatencyHistogram::clear(void)
+{
+    bins.fill(0);
+    overflowCount = 0;
+    count = 0;
+    sum = 0;
+    max = -1;
+    min = -1;
+}
+
+void LatencyHistogram::addValue(const qint64 latency_ms)
+{
+    qint64 value = latency_ms;
+
+    if (value < 0)
+    {
+        // May happen if clocks are not exactly in sync (should not with QElapsedTimer), but just in case.
+        value = 0;
+    }
+
+    if (value < bins.size())
+    {
+        bins[static_cast<int>(value)]++;
+    }
+    else
+    {
+        overflowCount++;
+    }
+
+    if ((count == 0) || (value > max))
+    {
+        max = value;
+    }
+
+    if ((count == 0) || (value < min))
+    {
+        min = value;
+    }
+
+    count++;
+    sum += value;
+}
+
+double LatencyHistogram::getMean(void) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    return static_cast<double>(sum) / count;
+}
+
+qint64 LatencyHistogram::getPercentile(const double percentile) const
+{
+    if (count == 0)
+    {
+        return -1;
+    }
+
+    qint64 limit = static_cast<qint64>((percentile / 100.) * count + 0.5);
+
+    if (limit < 1)
+    {
+        limit = 1;
+    }
+    else if (limit > count)
+    {
+        limit = count;
+    }
+
+    qint64 cumulativeCount = 0;
+
+    for (int i = 0; i < bins.size(); i++)
+    {
+        cumulativeCount += bins[i];
+
+        if (cumulativeCount >= limit)
+        {
+            return i;
+        }
+    }
+
+    // In overflow bin
+    return max;
+}
+
+
+RTCMLatencyStatistics::RTCMLatencyStatistics(const int maxNumOfRecords)
+{
+    records.resize(maxNumOfRecords > 0 ? maxNumOfRecords : 1);
+}
+
+void RTCMLatencyStatistics::clear(void)
+{
+    records.fill(MessageRecord());
+
+    lastSequenceNumber = 0;
+    lostRecords = 0;
+
+    histogram_Reception.clear();
+    histogram_Dispatch.clear();
+
+    for (unsigned int i = 0; i < maxNumOfRovers; i++)
+    {
+        histograms_Queue[i].clear();
+        histograms_Total[i].clear();
+        histograms_EpochCompletion[i].clear();
+        bytesEnqueued[i] = 0;
+        currentQueueDepth[i] = 0;
+        maxQueueDepth[i] = 0;
+    }
+}
+
+quint64 RTCMLatencyStatistics::messageDispatched(const RTCMMessage& message, const Source source, const qint64 dispatchTime)
+{
+    lastSequenceNumber++;
+
+    MessageRecord& record = records[static_cast<int>(lastSequenceNumber % static_cast<quint64>(records.size()))];
+
+    record = MessageRecord();
+
+    record.sequenceNumber = lastSequenceNumber;
+    record.source = source;
+    record.messageType = message.messageType;
+    record.messageLength = message.rawMessage.length();
+    record.messageStartTime = message.messageStartTime;
+    record.messageEndTime = message.messageEndTime;
+    record.dispatchTime = dispatchTime;
+
+    histogram_Reception.addValue(message.messageEndTime - message.messageStartTime);
+    histogram_Dispatch.addValue(dispatchTime - message.messageEndTime);
+
+    return lastSequenceNumber;
+}
+
+RTCMLatencyStatistics::MessageRecord* RTCMLatencyStatistics::findRecord(const quint64 sequenceNumber)
+{
+    MessageRecord& record = records[static_cast<int>(sequenceNumber % static_cast<quint64>(records.size()))];
+
+    if (record.sequenceNumber != sequenceNumber)
+    {
+        return nullptr;
+    }
+
+    return &record;
+}
+
+void RTCMLatencyStatistics::messageEnqueued(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const int queueDepth)
+{
+    if (roverId >= maxNumOfRovers)
+    {
+        return;
+    }
+
+    currentQueueDepth[roverId] = queueDepth;
+
+    if (queueDepth > maxQueueDepth[roverId])
+    {
+        maxQueueDepth[roverId] = queueDepth;
+    }
+
+    MessageRecord* record = findRecord(sequenceNumber);
+
+    if (record)
+    {
+        record->enqueueTime[roverId] = enqueueTime;
+        record->queueDepthAtEnqueue[roverId] = queueDepth;
+    }
+}
+
+void RTCMLatencyStatistics::messageWritten(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const qint64 writeTime, const int queueDepth)
+{
+    if (roverId >= maxNumOfRovers)
+    {
+        return;
+    }
+
+    currentQueueDepth[roverId] = queueDepth;
+
+    histograms_Queue[roverId].addValue(writeTime - enqueueTime);
+
+    MessageRecord* record = findRecord(sequenceNumber);
+
+    if (record)
+    {
+        record->writeTime[roverId] = writeTime;
+        histograms_Total[roverId].addValue(writeTime - record->messageStartTime);
+    }
+    else
+    {
+        lostRecords++;
+    }
+}
+
+void RTCMLatencyStatistics::dataEnqueued(const unsigned int roverId, const int bytes, const qint64 epochStartTime, const qint64 enqueueTime)
+{
+    if (roverId >= maxNumOfRovers)
+    {
+        return;
+    }
+
+    bytesEnqueued[roverId] += static_cast<quint64>(bytes);
+
+    if (epochStartTime >= 0)
+    {
+        histograms_EpochCompletion[roverId].addValue(enqueueTime - epochStartTime);
+    }
+}
+
+const LatencyHistogram& RTCMLatencyStatistics::getEpochCompletionHistogram(const unsigned int roverId) const
+{
+    return histograms_EpochCompletion[roverId < maxNumOfRovers ? roverId : 0];
+}
+
+quint64 RTCMLatencyStatistics::getBytesEnqueued(const unsigned int roverId) const
+{
+    return roverId < maxNumOfRovers ? bytesEnqueued[roverId] : 0;
+}
+
+const LatencyHistogram& RTCMLatencyStatistics::getHistogram(const Stage stage, const unsigned int roverId) const
+{
+    unsigned int limitedRoverId = roverId < maxNumOfRovers ? roverId : 0;
+
+    switch (stage)
+    {
+    case STAGE_RECEPTION:
+        return histogram_Reception;
+    case STAGE_DISPATCH:
+        return histogram_Dispatch;
+    case STAGE_QUEUE:
+        return histograms_Queue[limitedRoverId];
+    case STAGE_TOTAL:
+    default:
+        return histograms_Total[limitedRoverId];
+    }
+}
+
+int RTCMLatencyStatistics::getCurrentQueueDepth(const unsigned int roverId) const
+{
+    return roverId < maxNumOfRovers ? currentQueueDepth[roverId] : 0;
+}
+
+int RTCMLatencyStatistics::getMaxQueueDepth(const unsigned int roverId) const
+{
+    return roverId < maxNumOfRovers ? maxQueueDepth[roverId] : 0;
+}
+
+QString RTCMLatencyStatistics::getStageName(const Stage stage)
+{
+    switch (stage)
+    {
+    case STAGE_RECEPTION:
+        return "Reception (first->last byte)";
+    case STAGE_DISPATCH:
+        return "Dispatch (last byte->send queue)";
+    case STAGE_QUEUE:
+        return "Queue (send queue->serial write)";
+    case STAGE_TOTAL:
+        return "Total (first byte->serial write)";
+    default:
+        return "Unknown";
+    }
+}
+
+void RTCMLatencyStatistics::writeSummary(QTextStream& stream) const
+{
+    stream << "Stage\tRover\tCount\tMin\tMean\tp50\tp99\tMax\n";
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        unsigned int numOfInstances = ((stage == STAGE_QUEUE) || (stage == STAGE_TOTAL)) ? maxNumOfRovers : 1;
+
+        for (unsigned int roverId = 0; roverId < numOfInstances; roverId++)
+        {
+            const LatencyHistogram& histogram = getHistogram(static_cast<Stage>(stage), roverId);
+
+            stream << getStageName(static_cast<Stage>(stage)) << "\t";
+
+            if (numOfInstances == 1)
+            {
+                stream << "-\t";
+            }
+            else
+            {
+                stream << QString(char('A' + roverId)) << "\t";
+            }
+
+            stream << histogram.getCount() << "\t"
+                   << histogram.getMin() << "\t"
+                   << QString::number(histogram.getMean(), 'f', 1) << "\t"
+                   << histogram.getPercentile(50) << "\t"
+                   << histogram.getPercentile(99) << "\t"
+                   << histogram.getMax() << "\n";
+        }
+    }
+
+    for (unsigned int roverId = 0; roverId < maxNumOfRovers; roverId++)
+    {
+        const LatencyHistogram& histogram = histograms_EpochCompletion[roverId];
+
+        stream << "Epoch (first byte->send queue)\t" << QString(char('A' + roverId)) << "\t"
+               << histogram.getCount() << "\t"
+               << histogram.getMin() << "\t"
+               << QString::number(histogram.getMean(), 'f', 1) << "\t"
+               << histogram.getPercentile(50) << "\t"
+               << histogram.getPercentile(99) << "\t"
+               << histogram.getMax() << "\n";
+    }
+}
+
+void RTCMLatencyStatistics::writeRecordsCSV(QTextStream& stream) const
+{
+    stream << "Sequence,Source,Type,Length,FirstByte,LastByte,Dispatch";
+
+    for (unsigned int roverId = 0; roverId < maxNumOfRovers; roverId++)
+    {
+        QString roverString(char('A' + roverId));
+        stream << ",Enqueue_" << roverString << ",QueueDepth_" << roverString << ",Write_" << roverString;
+    }
+
+    stream << "\n";
+
+    quint64 numOfRecords = static_cast<quint64>(records.size());
+    quint64 firstSequenceNumber = lastSequenceNumber >= numOfRecords ? lastSequenceNumber - numOfRecords + 1 : 1;
+
+    for (quint64 sequenceNumber = firstSequenceNumber; sequenceNumber <= lastSequenceNumber; sequenceNumber++)
+    {
+        const MessageRecord& record = records[static_cast<int>(sequenceNumber % numOfRecords)];
+
+        if (record.sequenceNumber != sequenceNumber)
+        {
+            continue;
+        }
+
+        stream << record.sequenceNumber << ","
+               << (record.source == SOURCE_SERIAL ? "Serial" : "NTRIP") << ","
+               << record.messageType << ","
+               << record.messageLength << ","
+               << record.messageStartTime << ","
+               << record.messageEndTime << ","
+               << record.dispatchTime;
+
+        for (unsigned int roverId = 0; roverId < maxNumOfRovers; roverId++)
+        {
+            stream << "," << record.enqueueTime[roverId]
+                   << "," << record.queueDepthAtEnqueue[roverId]
+                   << "," << record.writeTime[roverId];
+        }
+
+        stream << "\n";
+    }
+}
@@ -0,0 +1,260 @@
+/*
+    rtcmlatencystatistics.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file rtcmlatencystatistics.h
+ * @brief Declarations for classes collecting latency statistics of RTCM-corrections forwarded from base to rovers.
+ */
+
+#ifndef RTCMLATENCYSTATISTICS_H
+#define RTCMLATENCYSTATISTICS_H
+
+#include <QVector>
+#include <QTextStream>
+
+#include "gnssmessage.h"
+
+/**
+ * @brief Histogram of latencies with 1 ms bins.
+ *
+ * Latencies exceeding the range of bins are collected into an overflow bin
+ * (max-value is still tracked exactly). Percentiles are therefore accurate to 1 ms
+ * as long as they lie inside the range of bins.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Constructor
+     * @param numOfBins Number of 1 ms bins (latencies >= numOfBins ms go to overflow bin)
+     */
+    LatencyHistogram(const int numOfBins = 2000);
+
+    void clear(void);                       //!< Clears all collected values
+    void addValue(const qint64 latency_ms); //!< Adds a value (negative values are clamped to 0)
+
+    qint64 getCount(void) const { return count; }   //!< Returns number of values added
+    qint64 getMax(void) const { return max; }       //!< Returns max value added (-1 if no values)
+    qint64 getMin(void) const { return min; }       //!< Returns min value added (-1 if no values)
+    double getMean(void) const;                     //!< Returns mean of values added (0 if no values)
+
+    /**
+     * @brief Returns given percentile
+     * @param percentile Percentile (0...100)
+     * @return Percentile value (ms, upper edge of the bin). -1 if no values. If the percentile falls into overflow bin, max-value is returned
+     */
+    qint64 getPercentile(const double percentile) const;
+
+private:
+    QVector<qint64> bins;   //!< Bins for values (index = latency in ms)
+    qint64 overflowCount;   //!< Number of values that didn't fit into bins
+    qint64 count;           //!< Total number of values
+    qint64 sum;             //!< Sum of all values (for mean)
+    qint64 max;             //!< Max value
+    qint64 min;             //!< Min value
+};
+
+/**
+ * @brief Class collecting latencies of RTCM-messages through the forwarding "pipeline".
+ *
+ * Path of RTCM-message is (times are uptimes, QElapsedTimer::msecsSinceReference()):
+ * 1. First byte received (by serial thread or NTRIP-thread) = messageStartTime
+ * 2. Last byte received = messageEndTime
+ * 3. Message dispatched by UBloxDataStreamProcessor in GUI-thread and added to rovers' send queues
+ * 4. Message written to rover's serial port (by rover's SerialThread after serial silence timeout)
+ *
+ * Every dispatched message gets a sequence number that is passed to SerialThread::addToSendQueue
+ * so that write times can be matched to the messages.
+ */
+class RTCMLatencyStatistics
+{
+public:
+    static const unsigned int maxNumOfRovers = 3;   //!< Max number of rovers that can be tracked
+
+    /**
+     * @brief Source of RTCM-messages
+     */
+    enum Source
+    {
+        SOURCE_SERIAL = 0,  //!< Base's serial port
+        SOURCE_NTRIP,       //!< NTRIP-client
+    };
+
+    /**
+     * @brief Stages of the forwarding.
+     */
+    enum Stage
+    {
+        STAGE_RECEPTION = 0,    //!< First byte -> last byte of the message
+        STAGE_DISPATCH,         //!< Last byte -> message dispatched (added to rovers' send queues)
+        STAGE_QUEUE,            //!< Added to send queue -> written to rover's serial port
+        STAGE_TOTAL,            //!< First byte -> written to rover's serial port
+        STAGE_COUNT
+    };
+
+    /**
+     * @brief Timestamps of one RTCM-message
+     */
+    class MessageRecord
+    {
+    public:
+        quint64 sequenceNumber = 0;         //!< Sequence number (0 = invalid/unused record)
+        Source source = SOURCE_SERIAL;      //!< Source of the message
+        unsigned short messageType = 0;     //!< RTCM message type
+        int messageLength = 0;              //!< Length of the message (bytes)
+        qint64 messageStartTime = 0;        //!< Uptime of the first byte
+        qint64 messageEndTime = 0;          //!< Uptime of the last byte
+        qint64 dispatchTime = 0;            //!< Uptime when message was dispatched to rovers' send queues
+        qint64 enqueueTime[maxNumOfRovers] = { -1, -1, -1 };        //!< Uptime when message was added to rover's send queue (-1 = not added)
+        qint64 writeTime[maxNumOfRovers] = { -1, -1, -1 };          //!< Uptime when message was written to rover's serial port (-1 = not written (yet))
+        int queueDepthAtEnqueue[maxNumOfRovers] = { -1, -1, -1 };   //!< Rover's send queue depth after adding the message
+    };
+
+    /**
+     * @brief Constructor
+     * @param maxNumOfRecords Max number of message records kept in memory (for CSV-dump). Older ones are overwritten
+     */
+    RTCMLatencyStatistics(const int maxNumOfRecords = 10000);
+
+    void clear(void);   //!< Clears all statistics and records
+
+    /**
+     * @brief Registers dispatched RTCM-message
+     * @param message RTCM-message
+     * @param source Source of the message
+     * @param dispatchTime Uptime when message was dispatched
+     * @return Sequence number given to the message (to be passed to SerialThread::addToSendQueue)
+     */
+    quint64 messageDispatched(const RTCMMessage& message, const Source source, const qint64 dispatchTime);
+
+    /**
+     * @brief Registers adding of the message into rover's send queue
+     * @param sequenceNumber Sequence number returned by messageDispatched
+     * @param roverId Rover id
+     * @param enqueueTime Uptime when message was added to send queue
+     * @param queueDepth Queue depth after adding the message
+     */
+    void messageEnqueued(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const int queueDepth);
+
+    /**
+     * @brief Registers writing of the message into rover's serial port
+     * @param sequenceNumber Sequence number returned by messageDispatched
+     * @param roverId Rover id
+     * @param enqueueTime Uptime when message was added to send queue
+     * @param writeTime Uptime when message was written to serial port
+     * @param queueDepth Queue depth left after writing the message
+     */
+    void messageWritten(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const qint64 writeTime, const int queueDepth);
+
+    /**
+     * @brief Registers data (single message or bundled epoch) added into rover's send queue
+     * @param roverId Rover id
+     * @param bytes Number of bytes
+     * @param epochStartTime Uptime of the first byte of the epoch (-1 = single message, not an epoch)
+     * @param enqueueTime Uptime when data was added to send queue
+     */
+    void dataEnqueued(const unsigned int roverId, const int bytes, const qint64 epochStartTime, const qint64 enqueueTime);
+
+    /**
+     * @brief Returns histogram of the given stage
+     * @param stage Stage
+     * @param roverId Rover id (only used for stages STAGE_QUEUE and STAGE_TOTAL)
+     * @return Histogram
+     */
+    const LatencyHistogram& getHistogram(const Stage stage, const unsigned int roverId = 0) const;
+
+    const LatencyHistogram& getEpochCompletionHistogram(const unsigned int roverId) const;  //!< Returns histogram of epoch completion latencies (first byte of epoch -> bundle added to send queue)
+    quint64 getBytesEnqueued(const unsigned int roverId) const;  //!< Returns number of bytes added to rover's send queue
+
+    int getCurrentQueueDepth(const unsigned int roverId) const; //!< Returns last known send queue depth of the rover
+    int getMaxQueueDepth(const unsigned int roverId) const;     //!< Returns max send queue depth of the rover
+    quint64 getNumOfMessages(void) const { return lastSequenceNumber; }  //!< Returns number of messages dispatched
+    quint64 getNumOfLostRecords(void) const { return lostRecords; }     //!< Returns number of write events whose record was already overwritten
+
+    static QString getStageName(const Stage stage);  //!< Returns human readable name of the stage
+
+    /**
+     * @brief Writes summary of all stages into a text stream (one line per stage/rover)
+     * @param stream Stream to write into
+     */
+    void writeSummary(QTextStream& stream) const;
+
+    /**
+     * @brief Writes all kept message records into a text stream in CSV-format (oldest first)
+     * @param stream Stream to write into
+     */
+    void writeRecordsCSV(QTextStream& stream) const;
+
+private:
+    QVector<MessageRecord> records;             //!< Ring buffer of message records (index = sequenceNumber % size)
+    quint64 lastSequenceNumber = 0;             //!< Sequence number of last dispatched message
+    quint64 lostRecords = 0;                    //!< Number of write events whose record was already overwritten
+
+    LatencyHistogram histogram_Reception;                       //!< Histogram for STAGE_RECEPTION
+    LatencyHistogram histogram_Dispatch;                        //!< Histogram for STAGE_DISPATCH
+    LatencyHistogram histograms_Queue[maxNumOfRovers];          //!< Histograms for STAGE_QUEUE
+    LatencyHistogram histograms_Total[maxNumOfRovers];          //!< Histograms for STAGE_TOTAL
+    LatencyHistogram histograms_EpochCompletion[maxNumOfRovers];    //!< Histograms for epoch completion latencies
+
+    quint64 bytesEnqueued[maxNumOfRovers] = { 0, 0, 0 };        //!< Bytes added to send queues
+
+    int currentQueueDepth[maxNumOfRovers] = { 0, 0, 0 };        //!< Last known queue depth
+    int maxQueueDepth[maxNumOfRovers] = { 0, 0, 0 };            //!< Max queue depth
+
+    MessageRecord* findRecord(const quint64 sequenceNumber);    //!< Returns record with given sequence number or nullptr if already overwritten
+};
+
+/**
+ * @brief Interface for registering forwarded RTCM-messages into latency statistics
+ *
+ * Functions are called from the threads forwarding the messages, so implementations must be thread-safe.
+ */
+class RTCMLatencyRecorder
+{
+public:
+    virtual ~RTCMLatencyRecorder() = default;
+
+    /**
+     * @brief Registers dispatched RTCM-message
+     * @param message RTCM-message
+     * @param source Source of the message
+     * @param dispatchTime Uptime when message was dispatched (QElapsedTimer::msecsSinceReference())
+     * @return Sequence number to pass to SerialThread::addToSendQueue
+     */
+    virtual quint64 rtcmMessageDispatched(const RTCMMessage& message, const RTCMLatencyStatistics::Source source, const qint64 dispatchTime) = 0;
+
+    /**
+     * @brief Registers adding of the message into rover's send queue
+     * @param sequenceNumber Sequence number returned by rtcmMessageDispatched
+     * @param roverId Rover id
+     * @param enqueueTime Uptime when message was added to send queue
+     * @param queueDepth Queue depth after adding the message (return value of SerialThread::addToSendQueue)
+     */
+    virtual void rtcmMessageEnqueued(const quint64 sequenceNumber, const unsigned int roverId, const qint64 enqueueTime, const int queueDepth) = 0;
+
+    /**
+     * @brief Registers data (single message or bundled epoch) added into rover's send queue
+     * @param roverId Rover id
+     * @param bytes Number of bytes
+     * @param epochStartTime Uptime of the first byte of the epoch (-1 = single message, not an epoch)
+     * @param enqueueTime Uptime when data was added to send queue
+     */
+    virtual void rtcmDataEnqueued(const unsigned int roverId, const int bytes, const qint64 epochStartTime, const qint64 enqueueTime) = 0;
+};
+
+#endif // RTCMLATENCYSTATISTICS_H
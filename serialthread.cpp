@@ -24,6 +24,7 @@
 //#include <memory>
 #include <QElapsedTimer>
 #include "serialthread.h"
+#include "tracer.h"
 
 SerialThread::SerialThread(const QString& serialPortFileName,
                            const unsigned int charTimeout,
@@ -137,6 +138,7 @@ void SerialThread::run()
             if ((serialPort.bytesAvailable() != 0) ||  (serialPort.waitForReadyRead(1)))
             {
                 // Data is ready to be read
+                TRACE_ZONE("SerialThread::read");
 
                 lastByteReceivedTimer.start();
 
@@ -151,6 +153,10 @@ void SerialThread::run()
 
                 if (BytesRead > 0)
                 {
+                    TRACE_COUNT("Serial bytes read", BytesRead);
+
+                    emit dataRead(QByteArray(readBuffer, static_cast<int>(BytesRead)), lastByteReceivedTimer.msecsSinceReference());
+
                     // Bytes received -> Add them to the buffer
                     receiveBuffer.append(readBuffer, static_cast<int>(BytesRead));
 
@@ -180,10 +186,19 @@ void SerialThread::run()
                 // Send any pending data from queue
                 while(!sendQueue.isEmpty())
                 {
-                    QByteArray sendArray = sendQueue.dequeue();
+                    SendQueueItem sendItem = sendQueue.dequeue();
+                    int queueDepth = sendQueue.size();
                     sendMutex.unlock();
 
-                    serialPort.write(sendArray);
+                    serialPort.write(sendItem.data);
+
+                    if (sendItem.sequenceNumber != 0)
+                    {
+                        // Note: This is the time when data was handed to QSerialPort, not the time when the last byte left the UART
+                        QElapsedTimer writeTimer;
+                        writeTimer.start();
+                        emit queuedDataWritten(sendItem.sequenceNumber, sendItem.enqueueTime, writeTimer.msecsSinceReference(), queueDepth);
+                    }
 
                     sendMutex.lock();
                 }
@@ -228,13 +243,33 @@ void SerialThread::flushReceiveBuffer(QSerialPort* serialPort)
 }
 
 
-void SerialThread::addToSendQueue(const QByteArray& dataToSend)
+int SerialThread::addToSendQueue(const QByteArray& dataToSend, const quint64 sequenceNumber)
 {
     if (!terminateRequest)
     {
+        SendQueueItem newItem;
+        newItem.data = dataToSend;
+        newItem.sequenceNumber = sequenceNumber;
+
+        if (sequenceNumber != 0)
+        {
+            QElapsedTimer enqueueTimer;
+            enqueueTimer.start();
+            newItem.enqueueTime = enqueueTimer.msecsSinceReference();
+        }
+
         QMutexLocker locker(&sendMutex);
-        sendQueue.enqueue(dataToSend);
+        sendQueue.enqueue(newItem);
+        return sendQueue.size();
     }
+
+    return 0;
+}
+
+int SerialThread::getSendQueueDepth(void)
+{
+    QMutexLocker locker(&sendMutex);
+    return sendQueue.size();
 }
 
 void SerialThread::suspend(void)
@@ -43,8 +43,19 @@ private:
     volatile bool terminateRequest; //!< Thread requested to terminate
     volatile bool suspended;        //!< Thread suspended (=paused/in sleep)
 
+    /**
+     * @brief Item in send queue
+     */
+    class SendQueueItem
+    {
+    public:
+        QByteArray data;                //!< Data to be sent
+        quint64 sequenceNumber = 0;     //!< Sequence number given when adding the item (0 = no queuedDataWritten-signal emitted)
+        qint64 enqueueTime = 0;         //!< Uptime when item was added to the queue (QElapsedTimer::msecsSinceReference())
+    };
+
     QMutex sendMutex;               //!< Mutex for handling sending of the data through serial port
-    QQueue<QByteArray> sendQueue;   //!< Queue for data to be sent through serial port
+    QQueue<SendQueueItem> sendQueue;    //!< Queue for data to be sent through serial port
 
     QByteArray receiveBuffer;       //!< Buffer for received data
 
@@ -79,7 +90,15 @@ public:
     void requestTerminate(void);    //!< Requests thread to terminate
     void suspend(void);             //!< Requests thread to suspend. Suspend may not be immediate
     void resume(void);              //!< Requests thread to resume (from suspend). Resuming may not be immediate.
-    void addToSendQueue(const QByteArray& dataToSend);  //!< Adds dataToSend to thread's send queue. Data will be sent later.
+
+    /**
+     * @brief Adds data to thread's send queue. Data will be sent later (after charTimeout has elapsed since last received byte).
+     * @param dataToSend Data to send
+     * @param sequenceNumber If not 0, queuedDataWritten-signal is emitted with this number when data is written to the serial port (used for latency monitoring)
+     * @return Number of items in send queue after adding the data
+     */
+    int addToSendQueue(const QByteArray& dataToSend, const quint64 sequenceNumber = 0);
+    int getSendQueueDepth(void);    //!< Returns number of items currently in send queue
 
 signals:
     void infoMessage(const QString&);       //!< Signal for info-message (not warning or error)
@@ -88,7 +107,9 @@ signals:
 
     // QT's signals and slots need to be defined exactly the same way, therefore SerialThread::DataReceivedEmitReason
     void dataReceived(const QByteArray&, qint64 startTime, qint64 endTime, const SerialThread::DataReceivedEmitReason&);   //!< Signal that is emitted when data is received. Amount of bytes is limited either by maxReadDataSize or time elapses between two received bytes. Times are read by QElapsedTimer::msecsSinceReference()
+    void dataRead(const QByteArray&, qint64 readTime);    //!< Signal that is emitted (in this thread) for every read from the serial port, regardless of maxReadDataSize/charTimeout. Meant for Qt::DirectConnection-receivers that can't wait for dataReceived. readTime is read by QElapsedTimer::msecsSinceReference()
     void serialTimeout(void);               //!< Signal that is emitted when charTimeout have been elapsed after last received byte or no bytes received in charTimeout.
+    void queuedDataWritten(const quint64 sequenceNumber, const qint64 enqueueTime, const qint64 writeTime, const int queueDepth);  //!< Signal that is emitted when data added with non-zero sequenceNumber is written to the serial port. queueDepth = items left in queue. Times are read by QElapsedTimer::msecsSinceReference()
 };
 
 #endif // SERIALTHREAD_H
@@ -0,0 +1,275 @@
+/*
+    slidingwindowstatistics.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file slidingwindowstatistics.cpp
+ * @brief Definition for a class that calculates statistics over a sliding time window.
+ */
+
+#include <math.h>
+
+#include "slidingwindowstatistics.h"
+
+SlidingWindowStatistics::SlidingWindowStatistics(const int numOfAxes, const qint64 windowLength_ms,
+                                                 const qint64 maxWindowLength_ms, const int maxNumOfSamples)
+{
+    this->numOfAxes = (numOfAxes < 1) ? 1 : numOfAxes;
+    this->maxWindowLength_ms = maxWindowLength_ms;
+    this->maxNumOfSamples = (maxNumOfSamples < 1) ? 1 : maxNumOfSamples;
+    this->windowLength_ms = (windowLength_ms > maxWindowLength_ms) ? maxWindowLength_ms : windowLength_ms;
+
+    axes.resize(this->numOfAxes);
+}
+
+void SlidingWindowStatistics::clear(void)
+{
+    times.clear();
+
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        axes[axis] = Axis();
+    }
+
+    firstIndex = 0;
+    windowStartIndex = 0;
+    windowCount = 0;
+}
+
+void SlidingWindowStatistics::addToWindow(const quint64 index)
+{
+    windowCount++;
+
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        Axis& currentAxis = axes[axis];
+        double value = getValue(axis, index);
+
+        while ((!currentAxis.minQueue.empty()) && (getValue(axis, currentAxis.minQueue.back()) >= value))
+        {
+            currentAxis.minQueue.pop_back();
+        }
+        currentAxis.minQueue.push_back(index);
+
+        while ((!currentAxis.maxQueue.empty()) && (getValue(axis, currentAxis.maxQueue.back()) <= value))
+        {
+            currentAxis.maxQueue.pop_back();
+        }
+        currentAxis.maxQueue.push_back(index);
+
+        double delta = value - currentAxis.mean;
+        currentAxis.mean += delta / windowCount;
+        currentAxis.m2 += delta * (value - currentAxis.mean);
+    }
+}
+
+void SlidingWindowStatistics::removeOldestFromWindow(void)
+{
+    windowCount--;
+
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        Axis& currentAxis = axes[axis];
+        double value = getValue(axis, windowStartIndex);
+
+        if ((!currentAxis.minQueue.empty()) && (currentAxis.minQueue.front() == windowStartIndex))
+        {
+            currentAxis.minQueue.pop_front();
+        }
+
+        if ((!currentAxis.maxQueue.empty()) && (currentAxis.maxQueue.front() == windowStartIndex))
+        {
+            currentAxis.maxQueue.pop_front();
+        }
+
+        if (windowCount == 0)
+        {
+            currentAxis.mean = 0;
+            currentAxis.m2 = 0;
+        }
+        else
+        {
+            double delta = value - currentAxis.mean;
+            currentAxis.mean -= delta / windowCount;
+            currentAxis.m2 -= delta * (value - currentAxis.mean);
+
+            if (currentAxis.m2 < 0)
+            {
+                // Rounding errors
+                currentAxis.m2 = 0;
+            }
+        }
+    }
+
+    windowStartIndex++;
+}
+
+void SlidingWindowStatistics::addSample(const qint64 time_ms, const double* values)
+{
+    if ((!times.empty()) && (time_ms < times.back()))
+    {
+        // Time went backwards (replay restarted etc.)
+        clear();
+    }
+
+    times.push_back(time_ms);
+
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        axes[axis].values.push_back(values[axis]);
+    }
+
+    addToWindow(firstIndex + times.size() - 1);
+
+    while ((windowCount > 0) && (time_ms - times[windowStartIndex - firstIndex] >= windowLength_ms))
+    {
+        removeOldestFromWindow();
+    }
+
+    while ((times.size() > 1) &&
+           ((time_ms - times.front() >= maxWindowLength_ms) || (static_cast<int>(times.size()) > maxNumOfSamples)))
+    {
+        if ((windowCount > 0) && (windowStartIndex == firstIndex))
+        {
+            // Sample still in window (only possible when maxNumOfSamples is reached)
+            removeOldestFromWindow();
+        }
+
+        times.pop_front();
+
+        for (int axis = 0; axis < numOfAxes; axis++)
+        {
+            axes[axis].values.pop_front();
+        }
+
+        firstIndex++;
+    }
+}
+
+void SlidingWindowStatistics::rebuildWindow(void)
+{
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        axes[axis].minQueue.clear();
+        axes[axis].maxQueue.clear();
+        axes[axis].mean = 0;
+        axes[axis].m2 = 0;
+    }
+
+    windowCount = 0;
+
+    if (times.empty())
+    {
+        windowStartIndex = firstIndex;
+        return;
+    }
+
+    qint64 lastTime = times.back();
+    quint64 index = firstIndex + times.size() - 1;
+
+    // Find the oldest sample in the window
+    while ((index > firstIndex) && (lastTime - times[index - 1 - firstIndex] < windowLength_ms))
+    {
+        index--;
+    }
+
+    windowStartIndex = index;
+
+    for (; index < firstIndex + times.size(); index++)
+    {
+        addToWindow(index);
+    }
+}
+
+void SlidingWindowStatistics::setWindowLength(const qint64 windowLength_ms)
+{
+    qint64 newWindowLength = (windowLength_ms > maxWindowLength_ms) ? maxWindowLength_ms : windowLength_ms;
+
+    if (newWindowLength != this->windowLength_ms)
+    {
+        this->windowLength_ms = newWindowLength;
+        rebuildWindow();
+    }
+}
+
+double SlidingWindowStatistics::getMin(const int axis) const
+{
+    if ((windowCount == 0) || (axis < 0) || (axis >= numOfAxes))
+    {
+        return nan("");
+    }
+
+    return getValue(axis, axes[axis].minQueue.front());
+}
+
+double SlidingWindowStatistics::getMax(const int axis) const
+{
+    if ((windowCount == 0) || (axis < 0) || (axis >= numOfAxes))
+    {
+        return nan("");
+    }
+
+    return getValue(axis, axes[axis].maxQueue.front());
+}
+
+double SlidingWindowStatistics::getRange(const int axis) const
+{
+    if ((windowCount < 2) || (axis < 0) || (axis >= numOfAxes))
+    {
+        return 0;
+    }
+
+    return getMax(axis) - getMin(axis);
+}
+
+double SlidingWindowStatistics::getMean(const int axis) const
+{
+    if ((windowCount == 0) || (axis < 0) || (axis >= numOfAxes))
+    {
+        return nan("");
+    }
+
+    return axes[axis].mean;
+}
+
+double SlidingWindowStatistics::getVariance(const int axis) const
+{
+    if ((windowCount == 0) || (axis < 0) || (axis >= numOfAxes))
+    {
+        return nan("");
+    }
+
+    return axes[axis].m2 / windowCount;
+}
+
+double SlidingWindowStatistics::getStdDev(const int axis) const
+{
+    return sqrt(getVariance(axis));
+}
+
+double SlidingWindowStatistics::getRangeNorm(void) const
+{
+    double sumOfSquares = 0;
+
+    for (int axis = 0; axis < numOfAxes; axis++)
+    {
+        double range = getRange(axis);
+        sumOfSquares += range * range;
+    }
+
+    return sqrt(sumOfSquares);
+}
@@ -0,0 +1,111 @@
+/*
+    slidingwindowstatistics.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file slidingwindowstatistics.h
+ * @brief Declaration for a class that calculates statistics over a sliding time window.
+ */
+
+#ifndef SLIDINGWINDOWSTATISTICS_H
+#define SLIDINGWINDOWSTATISTICS_H
+
+#include <deque>
+#include <QVector>
+
+/**
+ * @brief Calculates min/max/mean/variance of one or more values ("axes") over a sliding time window
+ *
+ * Window contains samples whose age (compared to the latest sample) is less than window length.
+ * Min/max are tracked using monotonic deques and mean/variance using Welford's
+ * algorithm (with removal), so adding a sample is amortized O(1) regardless of window length.
+ *
+ * Samples are kept for maxWindowLength_ms (at most maxNumOfSamples) so that
+ * window length can be changed afterwards (changing it recalculates the window once).
+ */
+class SlidingWindowStatistics
+{
+public:
+    /**
+     * @brief Constructor
+     * @param numOfAxes Number of values per sample
+     * @param windowLength_ms Initial window length (ms)
+     * @param maxWindowLength_ms Maximum window length that can be set later
+     * @param maxNumOfSamples Maximum number of samples kept in memory
+     */
+    SlidingWindowStatistics(const int numOfAxes = 1, const qint64 windowLength_ms = 1000,
+                            const qint64 maxWindowLength_ms = 600000, const int maxNumOfSamples = 6000);
+
+    /**
+     * @brief Adds a new sample
+     * @param time_ms Time of the sample (ms). If older than previous sample, all samples are cleared first.
+     * @param values Values (numOfAxes items)
+     */
+    void addSample(const qint64 time_ms, const double* values);
+    void addSample(const qint64 time_ms, const double value) { addSample(time_ms, &value); }    //!< Adds a new sample (single axis)
+
+    void setWindowLength(const qint64 windowLength_ms);                     //!< Sets window length (limited to maxWindowLength_ms)
+    qint64 getWindowLength(void) const { return windowLength_ms; }          //!< Returns window length (ms)
+
+    void clear(void);                                                       //!< Removes all samples
+
+    int getCount(void) const { return windowCount; }                        //!< Returns number of samples in window
+    double getMin(const int axis) const;                                    //!< Returns minimum value in window (NaN if empty)
+    double getMax(const int axis) const;                                    //!< Returns maximum value in window (NaN if empty)
+    double getRange(const int axis) const;                                  //!< Returns max - min in window (0 if less than 2 samples)
+    double getMean(const int axis) const;                                   //!< Returns mean value in window (NaN if empty)
+    double getVariance(const int axis) const;                               //!< Returns (population) variance in window (NaN if empty)
+    double getStdDev(const int axis) const;                                 //!< Returns (population) standard deviation in window (NaN if empty)
+
+    /**
+     * @brief Returns Euclidean norm of per-axis ranges
+     *
+     * For NED-coordinates this is the distance between min/max coordinate values for all axes.
+     */
+    double getRangeNorm(void) const;
+
+private:
+    class Axis
+    {
+    public:
+        std::deque<double> values;      //!< Values of all kept samples
+        std::deque<quint64> minQueue;   //!< Indices of window's samples with increasing values (front = min)
+        std::deque<quint64> maxQueue;   //!< Indices of window's samples with decreasing values (front = max)
+        double mean = 0;
+        double m2 = 0;                  //!< Sum of squared differences from mean (Welford)
+    };
+
+    int numOfAxes;
+    qint64 windowLength_ms;
+    qint64 maxWindowLength_ms;
+    int maxNumOfSamples;
+
+    std::deque<qint64> times;           //!< Times of all kept samples
+    QVector<Axis> axes;
+
+    quint64 firstIndex = 0;             //!< Running index of the oldest kept sample (times.front())
+    quint64 windowStartIndex = 0;       //!< Running index of the oldest sample in window
+    int windowCount = 0;
+
+    double getValue(const int axis, const quint64 index) const { return axes[axis].values[index - firstIndex]; }
+
+    void addToWindow(const quint64 index);
+    void removeOldestFromWindow(void);
+    void rebuildWindow(void);
+};
+
+#endif // SLIDINGWINDOWSTATISTICS_H
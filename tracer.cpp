@@ -0,0 +1,570 @@
+/*
+    tracer.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tracer.cpp
+ * @brief Definition for a lightweight instrumentation layer (timed zones, counters and gauges) exportable as Chrome trace JSON.
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include <QMutex>
+#include <QHash>
+#include <QMap>
+#include <QThread>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "tracer.h"
+
+namespace
+{
+    const int eventChunkSize = 16384;   //!< Events per buffer chunk
+
+    class Event
+    {
+    public:
+        const char* name;
+        qint64 time_ns;         //!< Start time (zones) or time of change (counters/gauges)
+        qint64 value;           //!< Duration (zones, ns) or new value (counters/gauges)
+        bool isZone;
+    };
+
+    /**
+     * @brief Event buffer of one thread
+     *
+     * Only the owner thread writes events. Events are published by numOfEvents (release/acquire),
+     * so readers never see partially written ones. Chunks are added/released by the owner
+     * with registry's mutex locked, readers lock the same mutex.
+     */
+    class ThreadBuffer
+    {
+    public:
+        QString threadName;
+        int threadIndex = 0;
+        QVector<Event*> chunks;
+        QAtomicInteger<qint64> numOfEvents = 0;
+        int generation = 0;             //!< Registry's generation when buffer was (re)started. Owner only
+        bool full = false;              //!< No more chunks available. Owner only
+        bool threadFinished = false;    //!< Protected by registry's mutex
+    };
+
+    class Registry
+    {
+    public:
+        QMutex mutex;
+        QVector<ThreadBuffer*> threadBuffers;
+        QHash<QByteArray, Tracer::Counter*> counters;
+        QAtomicInt generation = 0;      //!< Incremented by clear
+        qint64 maxNumOfEvents = 2000000;
+        qint64 numOfChunksAllocated = 0;
+        QAtomicInteger<qint64> numOfDroppedEvents = 0;
+        int nextThreadIndex = 1;
+    };
+
+    class ThreadSnapshot
+    {
+    public:
+        QString threadName;
+        int threadIndex = 0;
+        QVector<Event> events;
+    };
+
+    Registry& getRegistry(void)
+    {
+        // Never deleted: threads may record events while static objects are being destroyed at exit
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    void releaseChunks(Registry& registry, ThreadBuffer* buffer)
+    {
+        for (Event* chunk : buffer->chunks)
+        {
+            delete[] chunk;
+        }
+
+        registry.numOfChunksAllocated -= buffer->chunks.count();
+        buffer->chunks.clear();
+    }
+
+    /**
+     * @brief Marks thread's buffer finished when the thread exits (buffer is released on next clear)
+     */
+    class ThreadBufferHolder
+    {
+    public:
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferHolder()
+        {
+            if (buffer)
+            {
+                QMutexLocker locker(&getRegistry().mutex);
+                buffer->threadFinished = true;
+            }
+        }
+    };
+
+    thread_local ThreadBufferHolder threadBufferHolder;
+
+    ThreadBuffer* getThreadBuffer(void)
+    {
+        if (!threadBufferHolder.buffer)
+        {
+            QThread* thread = QThread::currentThread();
+            QString name = thread->objectName();
+
+            if (name.isEmpty())
+            {
+                if (QCoreApplication::instance() && (thread == QCoreApplication::instance()->thread()))
+                {
+                    name = "GUI-thread";
+                }
+                else
+                {
+                    name = thread->metaObject()->className();
+                }
+            }
+
+            Registry& registry = getRegistry();
+            ThreadBuffer* buffer = new ThreadBuffer();
+
+            QMutexLocker locker(&registry.mutex);
+
+            buffer->threadIndex = registry.nextThreadIndex++;
+            buffer->threadName = name + " (" + QString::number(buffer->threadIndex) + ")";
+            buffer->generation = registry.generation.loadAcquire();
+            registry.threadBuffers.append(buffer);
+
+            threadBufferHolder.buffer = buffer;
+        }
+
+        return threadBufferHolder.buffer;
+    }
+
+    void recordEvent(const char* name, const qint64 time_ns, const qint64 value, const bool isZone)
+    {
+        Registry& registry = getRegistry();
+        ThreadBuffer* buffer = getThreadBuffer();
+        const int generation = registry.generation.loadAcquire();
+
+        if (buffer->generation != generation)
+        {
+            // Cleared after the previous event -> Old events can be released now (readers hold the mutex)
+            QMutexLocker locker(&registry.mutex);
+
+            releaseChunks(registry, buffer);
+            buffer->numOfEvents.storeRelease(0);
+            buffer->generation = generation;
+            buffer->full = false;
+        }
+
+        if (buffer->full)
+        {
+            registry.numOfDroppedEvents.fetchAndAddRelaxed(1);
+            return;
+        }
+
+        const qint64 index = buffer->numOfEvents.loadAcquire();
+        const int chunkIndex = static_cast<int>(index / eventChunkSize);
+
+        if (chunkIndex >= buffer->chunks.count())
+        {
+            QMutexLocker locker(&registry.mutex);
+
+            if ((registry.numOfChunksAllocated + 1) * eventChunkSize > registry.maxNumOfEvents)
+            {
+                buffer->full = true;
+                registry.numOfDroppedEvents.fetchAndAddRelaxed(1);
+                return;
+            }
+
+            buffer->chunks.append(new Event[eventChunkSize]);
+            registry.numOfChunksAllocated++;
+        }
+
+        Event& event = buffer->chunks.at(chunkIndex)[index % eventChunkSize];
+
+        event.name = name;
+        event.time_ns = time_ns;
+        event.value = value;
+        event.isZone = isZone;
+
+        buffer->numOfEvents.storeRelease(index + 1);
+    }
+
+    QVector<ThreadSnapshot> takeSnapshot(void)
+    {
+        Registry& registry = getRegistry();
+        QVector<ThreadSnapshot> snapshots;
+
+        // Events are copied so the mutex (blocking chunk allocations) is held only briefly
+        QMutexLocker locker(&registry.mutex);
+
+        const int generation = registry.generation.loadAcquire();
+
+        for (const ThreadBuffer* buffer : registry.threadBuffers)
+        {
+            const qint64 numOfEvents = buffer->numOfEvents.loadAcquire();
+
+            if ((buffer->generation != generation) || (numOfEvents == 0))
+            {
+                continue;
+            }
+
+            ThreadSnapshot snapshot;
+            snapshot.threadName = buffer->threadName;
+            snapshot.threadIndex = buffer->threadIndex;
+            snapshot.events.reserve(static_cast<int>(numOfEvents));
+
+            for (qint64 i = 0; i < numOfEvents; i++)
+            {
+                snapshot.events.append(buffer->chunks.at(static_cast<int>(i / eventChunkSize))[i % eventChunkSize]);
+            }
+
+            snapshots.append(snapshot);
+        }
+
+        return snapshots;
+    }
+
+    QString jsonEscape(const QString& string)
+    {
+        QString escaped;
+
+        for (const QChar& character : string)
+        {
+            if ((character == '"') || (character == '\\'))
+            {
+                escaped += '\\';
+                escaped += character;
+            }
+            else if (character.unicode() < 0x20)
+            {
+                escaped += QString::asprintf("\\u%04x", character.unicode());
+            }
+            else
+            {
+                escaped += character;
+            }
+        }
+
+        return escaped;
+    }
+}
+
+QAtomicInt Tracer::enabled = (qEnvironmentVariableIntValue("GNSSSTYLUS_TRACING") != 0) ? 1 : 0;
+
+Tracer::Counter::Counter(const char* name, const Type type)
+{
+    this->name = name;
+    this->type = type;
+}
+
+void Tracer::Counter::add(const qint64 delta)
+{
+    qint64 newValue = value.fetchAndAddOrdered(delta) + delta;
+
+    if (isEnabled())
+    {
+        recordCounter(name, newValue);
+    }
+}
+
+void Tracer::Counter::set(const qint64 newValue)
+{
+    value.storeRelease(newValue);
+
+    qint64 currentMax = maxValue.loadAcquire();
+
+    while ((newValue > currentMax) && (!maxValue.testAndSetOrdered(currentMax, newValue, currentMax)))
+    {
+        // currentMax updated by testAndSetOrdered -> try again
+    }
+
+    if (isEnabled())
+    {
+        recordCounter(name, newValue);
+    }
+}
+
+void Tracer::Counter::clear(void)
+{
+    value.storeRelease(0);
+    maxValue.storeRelease(0);
+}
+
+void Tracer::setEnabled(const bool enable)
+{
+    enabled.storeRelease(enable ? 1 : 0);
+}
+
+bool Tracer::isCompiledIn(void)
+{
+#ifdef GNSSSTYLUS_NO_TRACING
+    return false;
+#else
+    return true;
+#endif
+}
+
+qint64 Tracer::getTime_ns(void)
+{
+    static const QElapsedTimer timer = []()
+    {
+        QElapsedTimer startedTimer;
+        startedTimer.start();
+        return startedTimer;
+    }();
+
+    return timer.nsecsElapsed();
+}
+
+Tracer::Counter* Tracer::getCounter(const char* name, const Counter::Type type)
+{
+    Registry& registry = getRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    Counter*& counter = registry.counters[QByteArray(name)];
+
+    if (!counter)
+    {
+        counter = new Counter(name, type);
+    }
+
+    return counter;
+}
+
+void Tracer::recordZone(const char* name, const qint64 startTime_ns, const qint64 duration_ns)
+{
+    recordEvent(name, startTime_ns, duration_ns, true);
+}
+
+void Tracer::recordCounter(const char* name, const qint64 value)
+{
+    recordEvent(name, getTime_ns(), value, false);
+}
+
+void Tracer::clear(void)
+{
+    Registry& registry = getRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    registry.generation.fetchAndAddOrdered(1);
+
+    // Buffers of finished threads can be released right away (no owner to do it)
+    for (int i = registry.threadBuffers.count() - 1; i >= 0; i--)
+    {
+        ThreadBuffer* buffer = registry.threadBuffers[i];
+
+        if (buffer->threadFinished)
+        {
+            releaseChunks(registry, buffer);
+            delete buffer;
+            registry.threadBuffers.remove(i);
+        }
+    }
+
+    registry.numOfDroppedEvents.storeRelease(0);
+
+    for (Counter* counter : registry.counters)
+    {
+        counter->clear();
+    }
+}
+
+void Tracer::setMaxNumOfEvents(const qint64 maxNumOfEvents)
+{
+    Registry& registry = getRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    registry.maxNumOfEvents = maxNumOfEvents;
+}
+
+qint64 Tracer::getNumOfEvents(void)
+{
+    Registry& registry = getRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    const int generation = registry.generation.loadAcquire();
+    qint64 numOfEvents = 0;
+
+    for (const ThreadBuffer* buffer : registry.threadBuffers)
+    {
+        if (buffer->generation == generation)
+        {
+            numOfEvents += buffer->numOfEvents.loadAcquire();
+        }
+    }
+
+    return numOfEvents;
+}
+
+qint64 Tracer::getNumOfDroppedEvents(void)
+{
+    return getRegistry().numOfDroppedEvents.loadAcquire();
+}
+
+QVector<Tracer::ZoneStatistics> Tracer::getZoneStatistics(void)
+{
+    const QVector<ThreadSnapshot> snapshots = takeSnapshot();
+
+    // Grouped by name's pointer first (fast), then merged by text (same literal may exist in several translation units)
+    QHash<const char*, QVector<qint64>> durationsByPointer;
+
+    for (const ThreadSnapshot& snapshot : snapshots)
+    {
+        for (const Event& event : snapshot.events)
+        {
+            if (event.isZone)
+            {
+                durationsByPointer[event.name].append(event.value);
+            }
+        }
+    }
+
+    QMap<QString, QVector<qint64>> durationsByName;
+
+    for (auto iter = durationsByPointer.cbegin(); iter != durationsByPointer.cend(); ++iter)
+    {
+        durationsByName[QString::fromUtf8(iter.key())].append(iter.value());
+    }
+
+    QVector<ZoneStatistics> statistics;
+
+    for (auto iter = durationsByName.begin(); iter != durationsByName.end(); ++iter)
+    {
+        QVector<qint64>& durations = iter.value();
+        std::sort(durations.begin(), durations.end());
+
+        auto percentile = [&durations](const double percentile)
+        {
+            int index = static_cast<int>(ceil(percentile / 100. * durations.count())) - 1;
+            return durations[qBound(0, index, durations.count() - 1)];
+        };
+
+        ZoneStatistics zoneStatistics;
+
+        zoneStatistics.name = iter.key();
+        zoneStatistics.count = durations.count();
+        zoneStatistics.p50_ns = percentile(50);
+        zoneStatistics.p99_ns = percentile(99);
+        zoneStatistics.max_ns = durations.last();
+
+        for (const qint64 duration : durations)
+        {
+            zoneStatistics.total_ns += duration;
+        }
+
+        statistics.append(zoneStatistics);
+    }
+
+    std::sort(statistics.begin(), statistics.end(),
+              [](const ZoneStatistics& a, const ZoneStatistics& b) { return a.total_ns > b.total_ns; });
+
+    return statistics;
+}
+
+QVector<Tracer::Counter*> Tracer::getCounters(void)
+{
+    Registry& registry = getRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    QVector<Counter*> counters;
+
+    for (Counter* counter : registry.counters)
+    {
+        counters.append(counter);
+    }
+
+    std::sort(counters.begin(), counters.end(),
+              [](const Counter* a, const Counter* b) { return qstrcmp(a->getName(), b->getName()) < 0; });
+
+    return counters;
+}
+
+void Tracer::writeSummary(QTextStream& stream)
+{
+    const QVector<ZoneStatistics> zones = getZoneStatistics();
+
+    stream << QString("Zone").leftJustified(40) << QString("Count").rightJustified(10) << QString("Total (ms)").rightJustified(14)
+           << QString("p50 (us)").rightJustified(12) << QString("p99 (us)").rightJustified(12) << QString("Max (us)").rightJustified(12) << "\n";
+
+    for (const ZoneStatistics& zone : zones)
+    {
+        stream << zone.name.leftJustified(40) << QString::number(zone.count).rightJustified(10)
+               << QString::number(zone.total_ns / 1e6, 'f', 1).rightJustified(14)
+               << QString::number(zone.p50_ns / 1e3, 'f', 1).rightJustified(12)
+               << QString::number(zone.p99_ns / 1e3, 'f', 1).rightJustified(12)
+               << QString::number(zone.max_ns / 1e3, 'f', 1).rightJustified(12) << "\n";
+    }
+
+    stream << "\n";
+
+    for (const Counter* counter : getCounters())
+    {
+        stream << QString(counter->getName()).leftJustified(40) << QString::number(counter->getValue()).rightJustified(10);
+
+        if (counter->getType() == Counter::TYPE_GAUGE)
+        {
+            stream << " (max " << counter->getMaxValue() << ")";
+        }
+
+        stream << "\n";
+    }
+
+    stream << "\nEvents recorded: " << getNumOfEvents() << ", dropped: " << getNumOfDroppedEvents() << "\n";
+}
+
+void Tracer::writeChromeTrace(QTextStream& stream)
+{
+    const QVector<ThreadSnapshot> snapshots = takeSnapshot();
+    const int pid = static_cast<int>(QCoreApplication::applicationPid());
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"GNSS-Stylus\"}}";
+
+    for (const ThreadSnapshot& snapshot : snapshots)
+    {
+        const QString pidTid = ",\"pid\":" + QString::number(pid) + ",\"tid\":" + QString::number(snapshot.threadIndex);
+
+        stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\"" << pidTid << ",\"args\":{\"name\":\"" << jsonEscape(snapshot.threadName) << "\"}}";
+
+        for (const Event& event : snapshot.events)
+        {
+            stream << ",\n{\"name\":\"" << jsonEscape(QString::fromUtf8(event.name)) << "\"";
+
+            if (event.isZone)
+            {
+                stream << ",\"ph\":\"X\"" << pidTid
+                       << ",\"ts\":" << QString::number(event.time_ns / 1e3, 'f', 3)
+                       << ",\"dur\":" << QString::number(event.value / 1e3, 'f', 3) << "}";
+            }
+            else
+            {
+                stream << ",\"ph\":\"C\"" << pidTid
+                       << ",\"ts\":" << QString::number(event.time_ns / 1e3, 'f', 3)
+                       << ",\"args\":{\"value\":" << event.value << "}}";
+            }
+        }
+    }
+
+    stream << "\n]}\n";
+}
@@ -0,0 +1,186 @@
+/*
+    tracer.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tracer.h
+ * @brief Declaration for a lightweight instrumentation layer (timed zones, counters and gauges) exportable as Chrome trace JSON.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QVector>
+#include <QTextStream>
+#include <QAtomicInteger>
+
+/**
+ * @brief Lightweight instrumentation of the realtime chain and generators
+ *
+ * Use through the macros:
+ * - TRACE_ZONE(name): Times the rest of the enclosing scope.
+ * - TRACE_COUNT(name, delta): Adds delta to a named counter (for example bytes read).
+ * - TRACE_GAUGE(name, value): Sets a named gauge (for example queue depth).
+ *
+ * Names must be string literals (pointers are stored as such, not copied).
+ *
+ * Events are recorded into per-thread buffers without locking (a mutex is taken only
+ * when a thread records its first event or needs a new chunk of buffer space).
+ * Recording is disabled by default and costs one atomic load per zone then.
+ * It can be enabled from TracingForm or by setting environment variable GNSSSTYLUS_TRACING=1.
+ * Counters and gauges are always updated (one atomic operation), only their events need recording enabled.
+ *
+ * Defining GNSSSTYLUS_NO_TRACING (see GNSS-Stylus.pro) removes all instrumentation at compile time.
+ *
+ * Recorded events can be summarized (per zone count, p50, p99, max) and
+ * exported as Chrome trace JSON (chrome://tracing, https://ui.perfetto.dev).
+ */
+class Tracer
+{
+public:
+    /**
+     * @brief Named counter or gauge
+     *
+     * Created once per name (getCounter) and never deleted, so pointers can be cached.
+     */
+    class Counter
+    {
+    public:
+        enum Type
+        {
+            TYPE_COUNTER = 0,   //!< Value accumulates (add)
+            TYPE_GAUGE,         //!< Value is set (set)
+        };
+
+        Counter(const char* name, const Type type);
+
+        void add(const qint64 delta);       //!< Adds delta to the counter (thread safe)
+        void set(const qint64 value);       //!< Sets gauge's value (thread safe)
+
+        const char* getName(void) const { return name; }
+        Type getType(void) const { return type; }
+        qint64 getValue(void) const { return value.loadAcquire(); }     //!< Returns current value
+        qint64 getMaxValue(void) const { return maxValue.loadAcquire(); }   //!< Returns max value set (gauges only)
+
+        void clear(void);                   //!< Clears value (and max value)
+
+    private:
+        const char* name;
+        Type type;
+        QAtomicInteger<qint64> value = 0;
+        QAtomicInteger<qint64> maxValue = 0;
+    };
+
+    /**
+     * @brief Times a zone from construction to destruction (use TRACE_ZONE)
+     */
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char* name) : name(name), startTime_ns(isEnabled() ? getTime_ns() : -1) {}
+        ~ScopedZone()
+        {
+            if (startTime_ns >= 0)
+            {
+                recordZone(name, startTime_ns, getTime_ns() - startTime_ns);
+            }
+        }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+    private:
+        const char* name;
+        qint64 startTime_ns;
+    };
+
+    class ZoneStatistics
+    {
+    public:
+        QString name;
+        qint64 count = 0;
+        qint64 total_ns = 0;
+        qint64 p50_ns = 0;
+        qint64 p99_ns = 0;
+        qint64 max_ns = 0;
+    };
+
+    static bool isEnabled(void) { return enabled.loadAcquire() != 0; }  //!< Returns true if recording is enabled
+    static void setEnabled(const bool enable);      //!< Enables/disables recording
+    static bool isCompiledIn(void);                 //!< Returns false if GNSSSTYLUS_NO_TRACING was defined
+
+    static qint64 getTime_ns(void);                 //!< Returns time (ns) since the tracer was first used
+
+    static Counter* getCounter(const char* name, const Counter::Type type);    //!< Returns counter/gauge with given name (created if needed, thread safe)
+
+    static void recordZone(const char* name, const qint64 startTime_ns, const qint64 duration_ns);    //!< Records a zone into calling thread's buffer
+
+    /**
+     * @brief Clears recorded events and counters
+     *
+     * Buffers of running threads are released by the threads themselves when they record next time.
+     */
+    static void clear(void);
+
+    static void setMaxNumOfEvents(const qint64 maxNumOfEvents);    //!< Sets limit for events kept in memory (further events are dropped and counted)
+    static qint64 getNumOfEvents(void);             //!< Returns number of recorded events (since last clear)
+    static qint64 getNumOfDroppedEvents(void);      //!< Returns number of events dropped because of maxNumOfEvents
+
+    static QVector<ZoneStatistics> getZoneStatistics(void);    //!< Returns statistics of recorded zones (sorted by total time, descending)
+    static QVector<Counter*> getCounters(void);     //!< Returns all counters and gauges (sorted by name)
+
+    static void writeSummary(QTextStream& stream);  //!< Writes summary of zones, counters and gauges as text
+    static void writeChromeTrace(QTextStream& stream);  //!< Writes recorded events in Chrome trace event format (JSON)
+
+private:
+    static QAtomicInt enabled;
+
+    static void recordCounter(const char* name, const qint64 value);   //!< Records counter's/gauge's new value into calling thread's buffer
+};
+
+#ifndef GNSSSTYLUS_NO_TRACING
+
+#define TRACER_CONCAT_IMPL(a, b) a##b
+#define TRACER_CONCAT(a, b) TRACER_CONCAT_IMPL(a, b)
+
+//! Times the rest of the enclosing scope as a zone. Name must be a string literal
+#define TRACE_ZONE(name) Tracer::ScopedZone TRACER_CONCAT(tracerZone_, __LINE__)(name)
+
+//! Adds delta to a named counter. Name must be a string literal
+#define TRACE_COUNT(name, delta) \
+    do { \
+        static Tracer::Counter* const tracerCounter = Tracer::getCounter(name, Tracer::Counter::TYPE_COUNTER); \
+        tracerCounter->add(delta); \
+    } while (0)
+
+//! Sets a named gauge. Name must be a string literal
+#define TRACE_GAUGE(name, value) \
+    do { \
+        static Tracer::Counter* const tracerGauge = Tracer::getCounter(name, Tracer::Counter::TYPE_GAUGE); \
+        tracerGauge->set(value); \
+    } while (0)
+
+#else
+
+#define TRACE_ZONE(name) do {} while (0)
+#define TRACE_COUNT(name, delta) do { (void) (delta); } while (0)
+#define TRACE_GAUGE(name, value) do { (void) (value); } while (0)
+
+#endif // GNSSSTYLUS_NO_TRACING
+
+#endif // TRACER_H
@@ -0,0 +1,151 @@
+/*
+    tracingform.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tracingform.cpp
+ * @brief Definition for a form that controls tracing and shows a summary of traced zones, counters and gauges.
+ */
+
+#include <QSettings>
+#include <QFile>
+#include <QTextStream>
+#include <QScrollBar>
+
+#include "tracingform.h"
+#include "ui_tracingform.h"
+#include "tracer.h"
+
+TracingForm::TracingForm(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::TracingForm)
+{
+    ui->setupUi(this);
+
+    connect(&updateTimer, &QTimer::timeout, this, &TracingForm::on_updateTimerTimeout);
+
+    if (Tracer::isCompiledIn())
+    {
+        ui->checkBox_Enabled->setChecked(Tracer::isEnabled());
+    }
+    else
+    {
+        ui->checkBox_Enabled->setEnabled(false);
+        ui->checkBox_Enabled->setText("Record events (tracing disabled at compile time)");
+    }
+
+    fileDialog_Trace.setFileMode(QFileDialog::AnyFile);
+    fileDialog_Trace.setAcceptMode(QFileDialog::AcceptSave);
+    fileDialog_Trace.setDefaultSuffix("json");
+
+    QStringList traceFilters;
+
+    traceFilters << "Chrome trace files (*.json)"
+            << "Any files (*)";
+
+    fileDialog_Trace.setNameFilters(traceFilters);
+
+    QSettings settings;
+    fileDialog_Trace.setDirectory(QDir(settings.value("Tracing_Directory_Dialog_Trace").toString()));
+}
+
+TracingForm::~TracingForm()
+{
+    QSettings settings;
+    settings.setValue("Tracing_Directory_Dialog_Trace", fileDialog_Trace.directory().path());
+
+    delete ui;
+}
+
+void TracingForm::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    updateSummary();
+    updateTimer.start(1000);
+}
+
+void TracingForm::hideEvent(QHideEvent* event)
+{
+    updateTimer.stop();
+
+    QWidget::hideEvent(event);
+}
+
+void TracingForm::on_updateTimerTimeout()
+{
+    updateSummary();
+}
+
+void TracingForm::updateSummary(void)
+{
+    QString summary;
+    QTextStream summaryStream(&summary);
+
+    Tracer::writeSummary(summaryStream);
+    summaryStream.flush();
+
+    // Keep scroll position while updating
+    int scrollPosition = ui->plainTextEdit_Summary->verticalScrollBar()->value();
+    ui->plainTextEdit_Summary->setPlainText(summary);
+    ui->plainTextEdit_Summary->verticalScrollBar()->setValue(scrollPosition);
+}
+
+void TracingForm::on_checkBox_Enabled_stateChanged(int arg1)
+{
+    Tracer::setEnabled(arg1 != Qt::Unchecked);
+}
+
+void TracingForm::on_pushButton_Clear_clicked()
+{
+    Tracer::clear();
+    updateSummary();
+}
+
+void TracingForm::on_pushButton_SaveTrace_clicked()
+{
+    if (fileDialog_Trace.exec())
+    {
+        QStringList fileNameList = fileDialog_Trace.selectedFiles();
+
+        if (fileNameList.size() != 1)
+        {
+            ui->label_LastStatus->setText("Multiple file selection not supported. Trace not saved.");
+            return;
+        }
+
+        fileDialog_Trace.setDirectory(QFileInfo(fileNameList[0]).path());
+
+        QFile traceFile(fileNameList[0]);
+
+        if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        {
+            ui->label_LastStatus->setText("Error: Can't open file \"" + fileNameList[0] + "\".");
+            return;
+        }
+
+        QTextStream traceStream(&traceFile);
+
+        Tracer::writeChromeTrace(traceStream);
+
+        traceStream.flush();
+        traceFile.close();
+
+        ui->label_LastStatus->setText("Saved \"" + QFileInfo(fileNameList[0]).fileName() + "\" (" +
+                                      QString::number(Tracer::getNumOfEvents()) + " events).");
+    }
+}
@@ -0,0 +1,68 @@
+/*
+    tracingform.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file tracingform.h
+ * @brief Declaration for a form that controls tracing and shows a summary of traced zones, counters and gauges.
+ */
+
+#ifndef TRACINGFORM_H
+#define TRACINGFORM_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QFileDialog>
+
+namespace Ui {
+class TracingForm;
+}
+
+/**
+ * @brief Form that controls tracing (see Tracer) and shows a summary of it.
+ *
+ * Summary (per zone count, total time, p50, p99 and max, counters and gauges) is updated
+ * periodically while the form is shown. Recorded events can be saved as Chrome trace JSON.
+ */
+class TracingForm : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TracingForm(QWidget *parent = nullptr);   //!< Constructor
+    ~TracingForm();
+
+private slots:
+    void on_updateTimerTimeout();
+    void on_checkBox_Enabled_stateChanged(int arg1);
+    void on_pushButton_Clear_clicked();
+    void on_pushButton_SaveTrace_clicked();
+
+protected:
+    void showEvent(QShowEvent* event);  //!< Starts periodic updating of the summary
+    void hideEvent(QHideEvent* event);  //!< Stops periodic updating of the summary
+
+private:
+    Ui::TracingForm *ui;
+
+    QTimer updateTimer;                 //!< Timer for updating the summary
+    QFileDialog fileDialog_Trace;       //!< File dialog for saving trace
+
+    void updateSummary(void);           //!< Updates shown summary
+};
+
+#endif // TRACINGFORM_H
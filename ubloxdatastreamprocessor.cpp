@@ -22,6 +22,7 @@
  */
 
 #include "ubloxdatastreamprocessor.h"
+#include "tracer.h"
 
 UBloxDataStreamProcessor::UBloxDataStreamProcessor(const unsigned int maxUBXMessageLength,
                                                    const unsigned int maxNMEASentenceLenght,
@@ -168,6 +169,7 @@ void UBloxDataStreamProcessor::process(const char inbyte, qint64 byteTime)
             {
                 // Frame is formally valid
                 UBXMessage newUbxMessage(inputBuffer, firstMessageByteTime, byteTime);
+                TRACE_COUNT("UBX messages", 1);
                 emit ubxMessageReceived(newUbxMessage);
             }
         }
@@ -198,6 +200,7 @@ void UBloxDataStreamProcessor::process(const char inbyte, qint64 byteTime)
         if (inbyte == 10)
         {
             NMEAMessage newNMEAMessage(inputBuffer, firstMessageByteTime, byteTime);
+            TRACE_COUNT("NMEA sentences", 1);
             emit nmeaSentenceReceived(newNMEAMessage);
         }
         else
@@ -254,6 +257,7 @@ void UBloxDataStreamProcessor::process(const char inbyte, qint64 byteTime)
         // Now this just naively emits data without any checking
 
         RTCMMessage newRTCMMessage(inputBuffer, firstMessageByteTime, byteTime);
+        TRACE_COUNT("RTCM messages", 1);
         emit rtcmMessageReceived(newRTCMMessage);
 
         inputBuffer.clear();
@@ -264,6 +268,8 @@ void UBloxDataStreamProcessor::process(const char inbyte, qint64 byteTime)
 
 void UBloxDataStreamProcessor::process(const QByteArray& data, const qint64 firstByteTime, const qint64 lastByteTime)
 {
+    TRACE_ZONE("UBloxDataStreamProcessor::process");
+
     for (int i = 0; i < data.length(); i++)
     {
         qint64 byteTime = data.length() > 1 ? firstByteTime + (lastByteTime - firstByteTime) * i / (data.length() - 1) : lastByteTime;
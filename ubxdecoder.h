@@ -0,0 +1,365 @@
+/*
+    ubxdecoder.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ubxdecoder.h
+ * @brief Table-driven decoding of UBX-message payloads using compile-time field layouts.
+ *
+ * Every message is declared once as a MessageLayout consisting of fields
+ * (offset in payload, raw type, scale and destination member).
+ * Decoding is done straight from the payload without any branching
+ * (length, class and id are checked once before decoding in decodeMessage).
+ */
+
+#ifndef UBXDECODER_H
+#define UBXDECODER_H
+
+#include <cstring>
+#include <cstddef>
+#include <ratio>
+
+#include "gnssmessage.h"
+
+namespace UBXDecoder
+{
+
+/**
+ * @brief Reads a little-endian value from (possibly unaligned) payload.
+ * All supported platforms are little-endian, like the UBX-protocol.
+ * @param data Pointer to the first byte of the value
+ * @return Value
+ */
+template <typename RawType>
+inline RawType readRaw(const unsigned char* data)
+{
+    RawType value;
+    memcpy(&value, data, sizeof(RawType));
+    return value;
+}
+
+//! Helper to get the type of the member a member pointer points to
+template <typename MemberPointer>
+struct MemberPointerTraits;
+
+template <typename Struct, typename Member>
+struct MemberPointerTraits<Member Struct::*>
+{
+    typedef Struct StructType;      //!< Type of the struct/class containing the member
+    typedef Member MemberType;      //!< Type of the member
+};
+
+/**
+ * @brief Field copied to the member as is (only type conversion).
+ * @tparam Offset Offset of the field in payload (bytes)
+ * @tparam RawType Type of the field in payload
+ * @tparam Member Member pointer to destination
+ */
+template <size_t Offset, typename RawType, auto Member>
+struct Field
+{
+    static constexpr size_t end = Offset + sizeof(RawType);   //!< Offset of the first byte after this field
+
+    template <typename Struct>
+    static inline void decode(const unsigned char* payload, Struct& out)
+    {
+        out.*Member = static_cast<typename MemberPointerTraits<decltype(Member)>::MemberType>(readRaw<RawType>(payload + Offset));
+    }
+};
+
+/**
+ * @brief Field converted to double and scaled.
+ * @tparam Offset Offset of the field in payload (bytes)
+ * @tparam RawType Type of the field in payload
+ * @tparam Scale Scale as std::ratio (value = raw * Scale::num / Scale::den)
+ * @tparam Member Member pointer to destination
+ */
+template <size_t Offset, typename RawType, typename Scale, auto Member>
+struct ScaledField
+{
+    static constexpr size_t end = Offset + sizeof(RawType);   //!< Offset of the first byte after this field
+
+    template <typename Struct>
+    static inline void decode(const unsigned char* payload, Struct& out)
+    {
+        out.*Member = readRaw<RawType>(payload + Offset) * static_cast<double>(Scale::num) / Scale::den;
+    }
+};
+
+/**
+ * @brief Scaled field added to the member.
+ *
+ * Used for high precision parts of values (like relPosHPN in RELPOSNED).
+ * Must be listed after the field setting the "main" part of the value.
+ * @tparam Offset Offset of the field in payload (bytes)
+ * @tparam RawType Type of the field in payload
+ * @tparam Scale Scale as std::ratio (value = raw * Scale::num / Scale::den)
+ * @tparam Member Member pointer to destination
+ */
+template <size_t Offset, typename RawType, typename Scale, auto Member>
+struct AddedScaledField
+{
+    static constexpr size_t end = Offset + sizeof(RawType);   //!< Offset of the first byte after this field
+
+    template <typename Struct>
+    static inline void decode(const unsigned char* payload, Struct& out)
+    {
+        out.*Member += readRaw<RawType>(payload + Offset) * static_cast<double>(Scale::num) / Scale::den;
+    }
+};
+
+/**
+ * @brief Bit field inside a flags-field.
+ * @tparam Offset Offset of the flags-field in payload (bytes)
+ * @tparam RawType Type of the flags-field in payload
+ * @tparam Shift Index of the lowest bit
+ * @tparam Width Number of bits
+ * @tparam Member Member pointer to destination (bool, integer or enum)
+ */
+template <size_t Offset, typename RawType, unsigned int Shift, unsigned int Width, auto Member>
+struct BitField
+{
+    static_assert(Shift + Width <= sizeof(RawType) * 8, "Bit field doesn't fit into raw type");
+
+    static constexpr size_t end = Offset + sizeof(RawType);   //!< Offset of the first byte after this field
+
+    template <typename Struct>
+    static inline void decode(const unsigned char* payload, Struct& out)
+    {
+        out.*Member = static_cast<typename MemberPointerTraits<decltype(Member)>::MemberType>(
+                    (static_cast<unsigned long long>(readRaw<RawType>(payload + Offset)) >> Shift) & ((1ULL << Width) - 1));
+    }
+};
+
+/**
+ * @brief Layout of one UBX-message.
+ * @tparam MessageClass Message class
+ * @tparam MessageId Message id
+ * @tparam PayloadLength Payload length (bytes)
+ * @tparam Fields Fields (Field, ScaledField, AddedScaledField, BitField) decoded in the order given
+ */
+template <unsigned char MessageClass, unsigned char MessageId, unsigned short PayloadLength, typename... Fields>
+struct MessageLayout
+{
+    static_assert(((Fields::end <= PayloadLength) && ...), "Field outside of payload");
+
+    static constexpr unsigned char messageClass = MessageClass;     //!< Message class
+    static constexpr unsigned char messageId = MessageId;           //!< Message id
+    static constexpr unsigned short payloadLength = PayloadLength;  //!< Payload length (bytes)
+
+    /**
+     * @brief Decodes payload without any checks.
+     * @param payload Pointer to payload (must be at least PayloadLength bytes)
+     * @param out Struct to decode to
+     */
+    template <typename Struct>
+    static inline void decodePayload(const unsigned char* payload, Struct& out)
+    {
+        (Fields::decode(payload, out), ...);
+    }
+};
+
+/**
+ * @brief Checks class, id and payload length of UBX-message and decodes it using given layout.
+ * @param ubxMessage Message to decode. Must be formally valid (STATUS_VALID).
+ * @param out Struct to decode to. Not touched if decoding fails.
+ * @return STATUS_VALID if decoded, otherwise reason for failure
+ */
+template <typename Layout, typename Struct>
+inline UBXMessage::MessageDataStatus decodeMessage(const UBXMessage& ubxMessage, Struct& out)
+{
+    if (ubxMessage.messageDataStatus != UBXMessage::STATUS_VALID)
+    {
+        return ubxMessage.messageDataStatus;
+    }
+    else if (ubxMessage.messageClass != Layout::messageClass)
+    {
+        return UBXMessage::STATUS_ERROR_CAST_CLASS;
+    }
+    else if (ubxMessage.messageId != Layout::messageId)
+    {
+        return UBXMessage::STATUS_ERROR_CAST_ID;
+    }
+    else if ((ubxMessage.payloadLength != Layout::payloadLength) ||
+             (ubxMessage.rawMessage.length() < Layout::payloadLength + 8))
+    {
+        return UBXMessage::STATUS_ERROR_LENGTH;
+    }
+
+    Layout::decodePayload(reinterpret_cast<const unsigned char*>(ubxMessage.rawMessage.constData()) + 6, out);
+    return UBXMessage::STATUS_VALID;
+}
+
+typedef std::ratio<1, 100> Centi;           //!< 1e-2
+typedef std::ratio<1, 1000> Milli;          //!< 1e-3 (mm -> m)
+typedef std::ratio<1, 10000> DeciMilli;     //!< 1e-4 (0.1 mm -> m)
+typedef std::ratio<1, 100000> Deg_1e5;      //!< 1e-5 (headings)
+typedef std::ratio<1, 10000000> Deg_1e7;    //!< 1e-7 (latitudes/longitudes)
+typedef std::ratio<1, 1000000000> Deg_1e9;  //!< 1e-9 (high precision parts of latitudes/longitudes)
+
+//! Layout of UBX-NAV-RELPOSNED (decoded into UBXMessage_RELPOSNED)
+typedef MessageLayout<0x01, 0x3c, 64,
+    Field<0, unsigned char, &UBXMessage_RELPOSNED::version>,
+    Field<2, unsigned short, &UBXMessage_RELPOSNED::refStationId>,
+    Field<4, unsigned int, &UBXMessage_RELPOSNED::iTOW>,
+    ScaledField<8, int, Centi, &UBXMessage_RELPOSNED::relPosN>,
+    ScaledField<12, int, Centi, &UBXMessage_RELPOSNED::relPosE>,
+    ScaledField<16, int, Centi, &UBXMessage_RELPOSNED::relPosD>,
+    ScaledField<20, int, Centi, &UBXMessage_RELPOSNED::relPosLength>,
+    ScaledField<24, int, Deg_1e5, &UBXMessage_RELPOSNED::relPosHeading>,
+    AddedScaledField<32, signed char, DeciMilli, &UBXMessage_RELPOSNED::relPosN>,
+    AddedScaledField<33, signed char, DeciMilli, &UBXMessage_RELPOSNED::relPosE>,
+    AddedScaledField<34, signed char, DeciMilli, &UBXMessage_RELPOSNED::relPosD>,
+    AddedScaledField<35, signed char, DeciMilli, &UBXMessage_RELPOSNED::relPosLength>,
+    ScaledField<36, unsigned int, DeciMilli, &UBXMessage_RELPOSNED::accN>,
+    ScaledField<40, unsigned int, DeciMilli, &UBXMessage_RELPOSNED::accE>,
+    ScaledField<44, unsigned int, DeciMilli, &UBXMessage_RELPOSNED::accD>,
+    ScaledField<48, unsigned int, DeciMilli, &UBXMessage_RELPOSNED::accLength>,
+    ScaledField<52, unsigned int, Deg_1e5, &UBXMessage_RELPOSNED::accHeading>,
+    Field<60, unsigned int, &UBXMessage_RELPOSNED::flags>,
+    BitField<60, unsigned int, 0, 1, &UBXMessage_RELPOSNED::flag_gnssFixOK>,
+    BitField<60, unsigned int, 1, 1, &UBXMessage_RELPOSNED::flag_diffSoln>,
+    BitField<60, unsigned int, 2, 1, &UBXMessage_RELPOSNED::flag_relPosValid>,
+    BitField<60, unsigned int, 3, 2, &UBXMessage_RELPOSNED::flag_carrSoln>,
+    BitField<60, unsigned int, 5, 1, &UBXMessage_RELPOSNED::flag_isMoving>,
+    BitField<60, unsigned int, 6, 1, &UBXMessage_RELPOSNED::flag_refPosMiss>,
+    BitField<60, unsigned int, 7, 1, &UBXMessage_RELPOSNED::flag_refObsMiss>,
+    BitField<60, unsigned int, 8, 1, &UBXMessage_RELPOSNED::flag_relPosHeadingValid>
+    > Layout_NAV_RELPOSNED;
+
+/**
+ * @brief Decoded UBX-NAV-PVT (Navigation position velocity time solution).
+ */
+struct NAV_PVT
+{
+    UBXMessage_RELPOSNED::ITOW iTOW = -1;   //!< GPS time of week of the navigation epoch (ms). Negative: invalid value.
+    unsigned short year = 0;                //!< Year (UTC)
+    unsigned char month = 0;                //!< Month (UTC, 1..12)
+    unsigned char day = 0;                  //!< Day of month (UTC, 1..31)
+    unsigned char hour = 0;                 //!< Hour of day (UTC, 0..23)
+    unsigned char min = 0;                  //!< Minute of hour (UTC, 0..59)
+    unsigned char sec = 0;                  //!< Seconds of minute (UTC, 0..60)
+    unsigned char valid = 0;                //!< Validity flags
+    unsigned int tAcc = 0;                  //!< Time accuracy estimate (ns)
+    int nano = 0;                           //!< Fraction of second (ns)
+    unsigned char fixType = 0;              //!< GNSS fix type (0 = no fix ... 3 = 3D-fix, 4 = GNSS + dead reckoning, 5 = time only)
+    unsigned char flags = 0;                //!< Fix status flags
+    unsigned char flags2 = 0;               //!< Additional flags
+    unsigned char numSV = 0;                //!< Number of satellites used in solution
+    double lon = 0;                         //!< Longitude (degrees)
+    double lat = 0;                         //!< Latitude (degrees)
+    double height = 0;                      //!< Height above ellipsoid (m)
+    double hMSL = 0;                        //!< Height above mean sea level (m)
+    double hAcc = 0;                        //!< Horizontal accuracy estimate (m)
+    double vAcc = 0;                        //!< Vertical accuracy estimate (m)
+    double velN = 0;                        //!< NED north velocity (m/s)
+    double velE = 0;                        //!< NED east velocity (m/s)
+    double velD = 0;                        //!< NED down velocity (m/s)
+    double gSpeed = 0;                      //!< Ground speed (m/s)
+    double headMot = 0;                     //!< Heading of motion (degrees)
+    double sAcc = 0;                        //!< Speed accuracy estimate (m/s)
+    double headAcc = 0;                     //!< Heading accuracy estimate (degrees)
+    double pDOP = 0;                        //!< Position DOP
+    unsigned short flags3 = 0;              //!< Additional flags
+    double headVeh = 0;                     //!< Heading of vehicle (degrees)
+    double magDec = 0;                      //!< Magnetic declination (degrees)
+    double magAcc = 0;                      //!< Magnetic declination accuracy (degrees)
+
+    // Flags split to "sub-parts":
+    bool flag_gnssFixOK = false;            //!< Valid fix (i.e within DOP & accuracy masks)
+    bool flag_diffSoln = false;             //!< Differential corrections were applied
+    UBXMessage_RELPOSNED::UBXRawData_RELPOSNED_CarrierPhaseSolutionStatus flag_carrSoln = UBXMessage_RELPOSNED::NO_SOLUTION;   //!< Carrier phase range solution status
+};
+
+//! Layout of UBX-NAV-PVT
+typedef MessageLayout<0x01, 0x07, 92,
+    Field<0, unsigned int, &NAV_PVT::iTOW>,
+    Field<4, unsigned short, &NAV_PVT::year>,
+    Field<6, unsigned char, &NAV_PVT::month>,
+    Field<7, unsigned char, &NAV_PVT::day>,
+    Field<8, unsigned char, &NAV_PVT::hour>,
+    Field<9, unsigned char, &NAV_PVT::min>,
+    Field<10, unsigned char, &NAV_PVT::sec>,
+    Field<11, unsigned char, &NAV_PVT::valid>,
+    Field<12, unsigned int, &NAV_PVT::tAcc>,
+    Field<16, int, &NAV_PVT::nano>,
+    Field<20, unsigned char, &NAV_PVT::fixType>,
+    Field<21, unsigned char, &NAV_PVT::flags>,
+    Field<22, unsigned char, &NAV_PVT::flags2>,
+    Field<23, unsigned char, &NAV_PVT::numSV>,
+    ScaledField<24, int, Deg_1e7, &NAV_PVT::lon>,
+    ScaledField<28, int, Deg_1e7, &NAV_PVT::lat>,
+    ScaledField<32, int, Milli, &NAV_PVT::height>,
+    ScaledField<36, int, Milli, &NAV_PVT::hMSL>,
+    ScaledField<40, unsigned int, Milli, &NAV_PVT::hAcc>,
+    ScaledField<44, unsigned int, Milli, &NAV_PVT::vAcc>,
+    ScaledField<48, int, Milli, &NAV_PVT::velN>,
+    ScaledField<52, int, Milli, &NAV_PVT::velE>,
+    ScaledField<56, int, Milli, &NAV_PVT::velD>,
+    ScaledField<60, int, Milli, &NAV_PVT::gSpeed>,
+    ScaledField<64, int, Deg_1e5, &NAV_PVT::headMot>,
+    ScaledField<68, unsigned int, Milli, &NAV_PVT::sAcc>,
+    ScaledField<72, unsigned int, Deg_1e5, &NAV_PVT::headAcc>,
+    ScaledField<76, unsigned short, Centi, &NAV_PVT::pDOP>,
+    Field<78, unsigned short, &NAV_PVT::flags3>,
+    ScaledField<84, int, Deg_1e5, &NAV_PVT::headVeh>,
+    ScaledField<88, short, Centi, &NAV_PVT::magDec>,
+    ScaledField<90, unsigned short, Centi, &NAV_PVT::magAcc>,
+    BitField<21, unsigned char, 0, 1, &NAV_PVT::flag_gnssFixOK>,
+    BitField<21, unsigned char, 1, 1, &NAV_PVT::flag_diffSoln>,
+    BitField<21, unsigned char, 6, 2, &NAV_PVT::flag_carrSoln>
+    > Layout_NAV_PVT;
+
+/**
+ * @brief Decoded UBX-NAV-HPPOSLLH (High precision geodetic position solution).
+ *
+ * High precision parts are already summed into the values.
+ */
+struct NAV_HPPOSLLH
+{
+    unsigned char version = 0;              //!< Message version
+    UBXMessage_RELPOSNED::ITOW iTOW = -1;   //!< GPS time of week of the navigation epoch (ms). Negative: invalid value.
+    double lon = 0;                         //!< Longitude (degrees)
+    double lat = 0;                         //!< Latitude (degrees)
+    double height = 0;                      //!< Height above ellipsoid (m)
+    double hMSL = 0;                        //!< Height above mean sea level (m)
+    double hAcc = 0;                        //!< Horizontal accuracy estimate (m)
+    double vAcc = 0;                        //!< Vertical accuracy estimate (m)
+
+    bool flag_invalidLlh = true;            //!< Longitude, latitude, height and hMSL are not valid
+};
+
+//! Layout of UBX-NAV-HPPOSLLH
+typedef MessageLayout<0x01, 0x14, 36,
+    Field<0, unsigned char, &NAV_HPPOSLLH::version>,
+    BitField<3, unsigned char, 0, 1, &NAV_HPPOSLLH::flag_invalidLlh>,
+    Field<4, unsigned int, &NAV_HPPOSLLH::iTOW>,
+    ScaledField<8, int, Deg_1e7, &NAV_HPPOSLLH::lon>,
+    ScaledField<12, int, Deg_1e7, &NAV_HPPOSLLH::lat>,
+    ScaledField<16, int, Milli, &NAV_HPPOSLLH::height>,
+    ScaledField<20, int, Milli, &NAV_HPPOSLLH::hMSL>,
+    AddedScaledField<24, signed char, Deg_1e9, &NAV_HPPOSLLH::lon>,
+    AddedScaledField<25, signed char, Deg_1e9, &NAV_HPPOSLLH::lat>,
+    AddedScaledField<26, signed char, DeciMilli, &NAV_HPPOSLLH::height>,
+    AddedScaledField<27, signed char, DeciMilli, &NAV_HPPOSLLH::hMSL>,
+    ScaledField<28, unsigned int, DeciMilli, &NAV_HPPOSLLH::hAcc>,
+    ScaledField<32, unsigned int, DeciMilli, &NAV_HPPOSLLH::vAcc>
+    > Layout_NAV_HPPOSLLH;
+
+} // namespace UBXDecoder
+
+#endif // UBXDECODER_H
@@ -0,0 +1,157 @@
+/*
+    videoframewriter.cpp (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file videoframewriter.cpp
+ * @brief Definition for a class that encodes and writes video frames in worker threads.
+ */
+
+#include <QtConcurrent>
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include "videoframewriter.h"
+
+VideoFrameWriter::VideoFrameWriter(const int maxPendingFrames)
+{
+    this->maxPendingFrames = maxPendingFrames;
+
+    // Leave one core for GUI-thread
+    threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+VideoFrameWriter::~VideoFrameWriter()
+{
+    waitForFinished();
+}
+
+bool VideoFrameWriter::addFrame(const QImage& image, const QStringList& fileNames)
+{
+    if (fileNames.isEmpty())
+    {
+        return true;
+    }
+
+    if (pendingFrames.loadAcquire() >= maxPendingFrames)
+    {
+        droppedFrames.ref();
+
+        if (!lastEncodedFileName.isEmpty())
+        {
+            QFuture<bool> sourceFuture = lastEncodeFuture;
+            QString sourceFileName = lastEncodedFileName;
+
+            QtConcurrent::run(&threadPool, [=]() { return this->writeRepeatedFrames(sourceFuture, sourceFileName, fileNames); });
+        }
+        else
+        {
+            failedWrites.fetchAndAddOrdered(fileNames.count());
+        }
+
+        return false;
+    }
+
+    pendingFrames.ref();
+
+    lastEncodeFuture = QtConcurrent::run(&threadPool, [=]() { return this->writeFrame(image, fileNames); });
+    lastEncodedFileName = fileNames.first();
+
+    return true;
+}
+
+void VideoFrameWriter::waitForFinished(void)
+{
+    threadPool.waitForDone();
+}
+
+void VideoFrameWriter::resetCounters(void)
+{
+    encodedFrames.storeRelease(0);
+    droppedFrames.storeRelease(0);
+    failedWrites.storeRelease(0);
+}
+
+bool VideoFrameWriter::writeFrame(const QImage image, const QStringList fileNames)
+{
+    bool success = image.save(fileNames.first());
+
+    pendingFrames.deref();
+
+    if (!success)
+    {
+        failedWrites.fetchAndAddOrdered(fileNames.count());
+        return false;
+    }
+
+    encodedFrames.ref();
+
+    for (int i = 1; i < fileNames.count(); i++)
+    {
+        if (!linkOrCopyFile(fileNames.first(), fileNames.at(i)))
+        {
+            failedWrites.ref();
+        }
+    }
+
+    return true;
+}
+
+bool VideoFrameWriter::writeRepeatedFrames(QFuture<bool> sourceFuture, const QString sourceFileName, const QStringList fileNames)
+{
+    // Source frame was added before this -> it is either already written or being written
+    sourceFuture.waitForFinished();
+
+    if (!sourceFuture.result())
+    {
+        failedWrites.fetchAndAddOrdered(fileNames.count());
+        return false;
+    }
+
+    bool success = true;
+
+    for (int i = 0; i < fileNames.count(); i++)
+    {
+        if (!linkOrCopyFile(sourceFileName, fileNames.at(i)))
+        {
+            failedWrites.ref();
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+bool VideoFrameWriter::linkOrCopyFile(const QString& sourceFileName, const QString& destFileName)
+{
+    if (QFile::exists(destFileName))
+    {
+        QFile::remove(destFileName);
+    }
+
+#ifdef Q_OS_UNIX
+    if (link(QFile::encodeName(sourceFileName).constData(), QFile::encodeName(destFileName).constData()) == 0)
+    {
+        return true;
+    }
+#endif
+
+    return QFile::copy(sourceFileName, destFileName);
+}
@@ -0,0 +1,83 @@
+/*
+    videoframewriter.h (part of GNSS-Stylus)
+    Copyright (C) 2019-2021 Pasi Nuutinmaki (gnssstylist<at>sci<dot>fi)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file videoframewriter.h
+ * @brief Declaration for a class that encodes and writes video frames in worker threads.
+ */
+
+#ifndef VIDEOFRAMEWRITER_H
+#define VIDEOFRAMEWRITER_H
+
+#include <QImage>
+#include <QStringList>
+#include <QThreadPool>
+#include <QFuture>
+#include <QAtomicInt>
+
+/**
+ * @brief Encodes and writes video frames (image files) in worker threads.
+ *
+ * Each frame is encoded only once. If the same frame needs to be written
+ * several times (to keep video timing when data is late) the other files
+ * are created as hard links to the encoded file (or copies if linking is not possible).
+ *
+ * Number of frames waiting for encoding is limited. If the limit is reached,
+ * new frame is dropped and its files are linked to the previous accepted frame
+ * instead so that the numbering of the image sequence stays continuous.
+ */
+class VideoFrameWriter
+{
+public:
+    VideoFrameWriter(const int maxPendingFrames = 16);     //!< Constructor
+    ~VideoFrameWriter();                                    //!< Destructor. Waits until all pending frames are written
+
+    /**
+     * @brief Adds frame to be written
+     * @param image Image of the frame
+     * @param fileNames File names for this frame. Image is encoded into the first one, others are linked/copied from it
+     * @return true if frame was accepted for encoding, false if dropped
+     */
+    bool addFrame(const QImage& image, const QStringList& fileNames);
+
+    void waitForFinished(void);                             //!< Waits until all pending frames are written
+
+    int getNumOfPendingFrames(void) const { return pendingFrames.loadAcquire(); }   //!< Returns number of frames waiting for encoding
+    int getNumOfEncodedFrames(void) const { return encodedFrames.loadAcquire(); }   //!< Returns number of frames encoded
+    int getNumOfDroppedFrames(void) const { return droppedFrames.loadAcquire(); }   //!< Returns number of frames dropped because of full queue
+    int getNumOfFailedWrites(void) const { return failedWrites.loadAcquire(); }     //!< Returns number of files that could not be written
+    void resetCounters(void);                               //!< Resets encoded/dropped/failed counters
+
+private:
+    int maxPendingFrames;
+    QThreadPool threadPool;
+
+    QAtomicInt pendingFrames;
+    QAtomicInt encodedFrames;
+    QAtomicInt droppedFrames;
+    QAtomicInt failedWrites;
+
+    QFuture<bool> lastEncodeFuture;         //!< Encoding of the last accepted frame
+    QString lastEncodedFileName;            //!< File name of the last accepted frame
+
+    bool writeFrame(const QImage image, const QStringList fileNames);                                   //!< Run in worker thread
+    bool writeRepeatedFrames(QFuture<bool> sourceFuture, const QString sourceFileName, const QStringList fileNames);   //!< Run in worker thread
+    static bool linkOrCopyFile(const QString& sourceFileName, const QString& destFileName);
+};
+
+#endif // VIDEOFRAMEWRITER_H